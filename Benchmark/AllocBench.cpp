@@ -0,0 +1,265 @@
+// local includes
+#include "BenchHarness.h"
+
+// wgl includes
+#include "ReuseAllocator.h"
+
+// std includes
+#include <map>
+#include <list>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <functional>
+#include <unordered_map>
+
+namespace
+{
+
+// number of keys inserted into each container per round
+const size_t NUM_KEYS = 1 << 14;
+
+// number of insert / erase rounds per run
+const size_t NUM_ROUNDS = 8;
+
+// number of threads churning their own containers at once
+const size_t NUM_THREADS = 4;
+
+// the allocators being compared
+template < typename T > using StdAllocator = std::allocator< T >;
+template < typename T > using PoolAllocator = ReuseAllocator< T >;
+template < typename T > using CachedAllocator = ReuseAllocator< T, true >;
+
+std::vector< uint32_t > GenerateKeys( const size_t count, std::mt19937 & generator )
+{
+   std::vector< uint32_t > keys(count);
+
+   for (auto & key : keys) key = generator();
+
+   return keys;
+}
+
+// fills a list, erases the odd keys from the middle and trims
+// the front, so nodes are released in a scattered order
+template < template < typename > class A >
+uint64_t ListChurn( const std::vector< uint32_t > & keys )
+{
+   std::list< uint32_t, A< uint32_t > > list;
+
+   uint64_t checksum = 0;
+
+   for (size_t round = 0; round < NUM_ROUNDS; ++round)
+   {
+      for (const uint32_t key : keys) list.push_back(key + static_cast< uint32_t >(round));
+
+      for (auto it = list.begin(); it != list.end(); )
+      {
+         it = *it & 1 ? list.erase(it) : std::next(it);
+      }
+
+      while (list.size() > keys.size() / 4) list.pop_front();
+
+      checksum += list.size();
+   }
+
+   for (const uint32_t value : list) checksum = checksum * 31 + value;
+
+   return checksum;
+}
+
+// inserts a round of keys and erases a third of the map
+template < template < typename > class A >
+uint64_t MapChurn( const std::vector< uint32_t > & keys )
+{
+   typedef std::pair< const uint32_t, uint32_t > value_type;
+
+   std::map< uint32_t, uint32_t, std::less< uint32_t >, A< value_type > > map;
+
+   uint64_t checksum = 0;
+
+   for (size_t round = 0; round < NUM_ROUNDS; ++round)
+   {
+      for (size_t i = 0; i < keys.size(); ++i) map[keys[i] >> round] = static_cast< uint32_t >(i);
+
+      for (auto it = map.begin(); it != map.end(); )
+      {
+         it = (it->first + round) % 3 == 0 ? map.erase(it) : std::next(it);
+      }
+
+      checksum += map.size();
+   }
+
+   for (const auto & value : map) checksum = checksum * 31 + value.first + value.second;
+
+   return checksum;
+}
+
+// same as the map churn, but the bucket arrays also come from the allocator
+template < template < typename > class A >
+uint64_t UnorderedMapChurn( const std::vector< uint32_t > & keys )
+{
+   typedef std::pair< const uint32_t, uint32_t > value_type;
+
+   std::unordered_map< uint32_t, uint32_t, std::hash< uint32_t >,
+                       std::equal_to< uint32_t >, A< value_type > > map;
+
+   uint64_t checksum = 0;
+
+   for (size_t round = 0; round < NUM_ROUNDS; ++round)
+   {
+      for (size_t i = 0; i < keys.size(); ++i) map[keys[i] >> round] = static_cast< uint32_t >(i);
+
+      for (auto it = map.begin(); it != map.end(); )
+      {
+         it = (it->first + round) % 3 == 0 ? map.erase(it) : std::next(it);
+      }
+
+      checksum += map.size();
+   }
+
+   // iteration order depends on the buckets, so combine without ordering
+   for (const auto & value : map) checksum += static_cast< uint64_t >(value.first) * value.second;
+
+   return checksum;
+}
+
+// signature shared by all the churn tests
+typedef uint64_t ( * ChurnFn )( const std::vector< uint32_t > & );
+
+// runs the churn on each thread with its own keys and combines the checksums
+uint64_t RunThreads( const ChurnFn churn, const std::vector< std::vector< uint32_t > > & keys )
+{
+   std::vector< uint64_t > checksums(keys.size());
+
+   if (keys.size() == 1)
+   {
+      checksums[0] = churn(keys[0]);
+   }
+   else
+   {
+      std::vector< std::thread > threads;
+
+      for (size_t i = 0; i < keys.size(); ++i)
+      {
+         threads.emplace_back([ &, i ] ( ) { checksums[i] = churn(keys[i]); });
+      }
+
+      for (auto & thread : threads) thread.join();
+   }
+
+   uint64_t checksum = 0;
+
+   for (const uint64_t value : checksums) checksum = checksum * 31 + value;
+
+   return checksum;
+}
+
+// prints the column titles for the rows that follow
+void PrintHeader( )
+{
+   std::cout << std::left << std::setw(16) << "container"
+             << std::setw(9) << "threads"
+             << std::right
+             << std::setw(10) << "std ns"
+             << std::setw(10) << "pool ns"
+             << std::setw(11) << "cached ns"
+             << std::setw(8) << "pool"
+             << std::setw(8) << "cached" << std::endl;
+}
+
+// returns true if every block went back to the pools and every slab
+// went back to the system once the containers were destroyed
+bool PoolsReleased( )
+{
+   ReuseAllocator< char >::Trim();
+
+   const ReuseAllocatorStats stats = ReuseAllocator< char >::Stats();
+
+   return !stats.live_blocks && !stats.slabs && !stats.large_allocations;
+}
+
+// compares the allocators on one churn test and prints a row of the report.
+// returns false if the containers disagree or the pools leak blocks or slabs.
+bool Compare( const char * const pName, const ChurnFn std_churn,
+              const ChurnFn pool_churn, const ChurnFn cached_churn,
+              const std::vector< std::vector< uint32_t > > & keys )
+{
+   // first validate the results before measuring
+   const uint64_t expected = RunThreads(std_churn, keys);
+
+   bool passed = RunThreads(pool_churn, keys) == expected && PoolsReleased();
+   passed &= RunThreads(cached_churn, keys) == expected && PoolsReleased();
+
+   const auto measure = [ & ] ( const ChurnFn churn )
+   {
+      return bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(RunThreads(churn, keys)); }, 5);
+   };
+
+   // report the time per key inserted
+   const double inserts = static_cast< double >(keys.size() * NUM_KEYS * NUM_ROUNDS);
+
+   const double std_ns = measure(std_churn) / inserts;
+   const double pool_ns = measure(pool_churn) / inserts;
+   const double cached_ns = measure(cached_churn) / inserts;
+
+   passed &= PoolsReleased();
+
+   std::cout << std::left << std::setw(16) << pName
+             << std::setw(9) << keys.size()
+             << std::right << std::fixed << std::setprecision(2)
+             << std::setw(10) << std_ns
+             << std::setw(10) << pool_ns
+             << std::setw(11) << cached_ns
+             << std::setw(8) << std_ns / pool_ns
+             << std::setw(8) << std_ns / cached_ns
+             << (passed ? "" : "  FAILED") << std::endl;
+
+   return passed;
+}
+
+bool RunChurn( const size_t num_threads, std::mt19937 & generator )
+{
+   std::vector< std::vector< uint32_t > > keys;
+
+   for (size_t i = 0; i < num_threads; ++i) keys.push_back(GenerateKeys(NUM_KEYS, generator));
+
+   bool passed = true;
+
+   passed &= Compare("list", &ListChurn< StdAllocator >,
+                     &ListChurn< PoolAllocator >, &ListChurn< CachedAllocator >, keys);
+   passed &= Compare("map", &MapChurn< StdAllocator >,
+                     &MapChurn< PoolAllocator >, &MapChurn< CachedAllocator >, keys);
+   passed &= Compare("unordered_map", &UnorderedMapChurn< StdAllocator >,
+                     &UnorderedMapChurn< PoolAllocator >, &UnorderedMapChurn< CachedAllocator >, keys);
+
+   return passed;
+}
+
+} // namespace
+
+int main( const int /*argc*/, const char * const /*argv*/[] )
+{
+   std::mt19937 generator(0x5EED);
+
+   std::cout << "container churn of " << NUM_KEYS << " keys x " << NUM_ROUNDS
+             << " rounds per thread (ns per insert)" << std::endl << std::endl;
+
+   PrintHeader();
+
+   bool passed = true;
+
+   passed &= RunChurn(1, generator);
+   passed &= RunChurn(NUM_THREADS, generator);
+
+   const ReuseAllocatorStats stats = ReuseAllocator< char >::Stats();
+
+   std::cout << std::endl << "pool peak: " << stats.peak_blocks << " blocks, "
+             << stats.peak_bytes / 1024 << " KB" << std::endl;
+
+   return passed ? 0 : 1;
+}
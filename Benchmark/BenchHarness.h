@@ -0,0 +1,444 @@
+#ifndef _BENCH_HARNESS_H_
+#define _BENCH_HARNESS_H_
+
+// std includes
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <iostream>
+#include <algorithm>
+
+namespace bench
+{
+
+// keeps the optimizer from discarding a value that is otherwise unused
+template < typename T >
+inline void DoNotOptimize( const T & t )
+{
+#if defined( _MSC_VER ) && !defined( __clang__ )
+   static const void * volatile sink = nullptr;
+   sink = &t;
+#else
+   asm volatile ( "" : : "g" ( &t ) : "memory" );
+#endif
+}
+
+// runs the function for the requested number of iterations a few times
+// and returns the fastest average time in nanoseconds per iteration.
+// taking the minimum filters out interference from the rest of the system.
+template < typename Fn >
+inline double MeasureNS( const size_t iterations, Fn && fn, const size_t repetitions = 7 )
+{
+   double best_ns = std::numeric_limits< double >::max();
+
+   for (size_t rep = 0; rep < repetitions; ++rep)
+   {
+      const auto beg = std::chrono::steady_clock::now();
+
+      for (size_t i = 0; i < iterations; ++i)
+      {
+         fn(i);
+      }
+
+      const auto end = std::chrono::steady_clock::now();
+
+      const double elapsed_ns = std::chrono::duration< double, std::nano >(end - beg).count();
+
+      best_ns = std::min(best_ns, elapsed_ns / static_cast< double >(iterations));
+   }
+
+   return best_ns;
+}
+
+template < typename T > const char * TypeName( );
+template < > inline const char * TypeName< float >( ) { return "float"; }
+template < > inline const char * TypeName< double >( ) { return "double"; }
+
+// relative tolerance an optimized kernel must match its reference within.
+// without fused multiply-add contraction the results are usually identical.
+template < typename T > T Tolerance( );
+template < > inline float Tolerance< float >( ) { return 1.0e-4f; }
+template < > inline double Tolerance< double >( ) { return 1.0e-10; }
+
+// largest difference between the two arrays relative to the expected
+// magnitude... magnitudes below one are compared absolutely
+template < typename T >
+inline T RelativeError( const T * const pExpected, const T * const pActual, const size_t count )
+{
+   T max_error = 0;
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      const T magnitude = std::max(std::abs(pExpected[i]), T(1));
+
+      max_error = std::max(max_error, std::abs(pExpected[i] - pActual[i]) / magnitude);
+   }
+
+   return max_error;
+}
+
+// collects the results of a benchmark run.  every row is printed as it
+// is added and the whole run can be written out as json or csv, so runs
+// can be compared against each other or checked for regressions.
+//
+// the command line accepts:
+//    --json <file>  writes the results as json
+//    --csv <file>   writes the results as csv
+class Report
+{
+public:
+   // how the error column of a suite is measured
+   enum class Error
+   {
+      // largest difference relative to the expected magnitude
+      RELATIVE,
+      // largest absolute difference
+      MAX_ABSOLUTE,
+      // root mean square of the differences
+      RMS
+   };
+
+   // a single measured kernel
+   struct Result
+   {
+      std::string suite;
+      std::string kernel;
+      std::string type;
+      size_t      batch;
+      // names of the compared implementations, test is empty if
+      // the row measures a single implementation
+      std::string base;
+      std::string test;
+      double      base_ns;
+      double      test_ns;
+      double      error;
+      Error       error_kind;
+      bool        passed;
+   };
+
+   explicit Report( const char * const pBenchmark );
+
+   // parses the command line, returns false if it is not understood
+   bool ParseArgs( const int argc, const char * const argv[] );
+
+   // records a property of the run, such as the simd backend
+   void SetProperty( const std::string & key, const std::string & value );
+
+   // starts a new group of rows and prints the column titles.
+   // a null test name reports a single time per row.
+   void BeginSuite( const std::string & name, const char * const pBaseName, const char * const pTestName = nullptr,
+                    const Error error_kind = Error::RELATIVE );
+
+   // adds a row comparing two implementations
+   void Add( const char * const pKernel, const char * const pType, const size_t batch,
+             const double base_ns, const double test_ns, const double error, const bool passed );
+
+   // adds a row measuring a single implementation
+   void Add( const char * const pKernel, const char * const pType, const size_t batch,
+             const double ns, const double error, const bool passed );
+
+   // writes the files requested on the command line
+   bool Write( ) const;
+
+   void WriteJSON( std::ostream & stream ) const;
+   void WriteCSV( std::ostream & stream ) const;
+
+   const std::vector< Result > & Results( ) const;
+
+private:
+   // title of the error column and its key in the json and csv output
+   static const char * ErrorTitle( const Error error_kind );
+   static const char * ErrorKey( const Error error_kind );
+
+   // writes a string as a json string literal
+   static void WriteJSONString( std::ostream & stream, const std::string & string );
+
+   // writes a number, json has no representation for nan or infinity
+   static void WriteJSONNumber( std::ostream & stream, const double value );
+
+   // writes a string as a csv field
+   static void WriteCSVField( std::ostream & stream, const std::string & string );
+
+   std::string                                           mBenchmark;
+   std::vector< std::pair< std::string, std::string > >  mProperties;
+
+   // the suite rows are currently added to
+   std::string                                           mSuite;
+   std::string                                           mBase;
+   std::string                                           mTest;
+   Error                                                 mErrorKind;
+
+   std::vector< Result >                                 mResults;
+
+   // output files, empty if not requested
+   std::string                                           mJSONFile;
+   std::string                                           mCSVFile;
+
+};
+
+inline Report::Report( const char * const pBenchmark ) :
+mBenchmark  ( pBenchmark ),
+mErrorKind  ( Error::RELATIVE )
+{
+}
+
+inline bool Report::ParseArgs( const int argc, const char * const argv[] )
+{
+   for (int i = 1; i < argc; ++i)
+   {
+      const std::string arg = argv[i];
+
+      if ((arg == "--json" || arg == "--csv") && i + 1 < argc)
+      {
+         (arg == "--json" ? mJSONFile : mCSVFile) = argv[++i];
+      }
+      else
+      {
+         std::cerr << "usage: " << mBenchmark << " [--json <file>] [--csv <file>]" << std::endl;
+
+         return false;
+      }
+   }
+
+   return true;
+}
+
+inline void Report::SetProperty( const std::string & key, const std::string & value )
+{
+   mProperties.emplace_back(key, value);
+}
+
+inline void Report::BeginSuite( const std::string & name, const char * const pBaseName, const char * const pTestName,
+                                const Error error_kind )
+{
+   mSuite = name;
+   mBase = pBaseName;
+   mTest = pTestName ? pTestName : "";
+   mErrorKind = error_kind;
+
+   if (!mResults.empty()) std::cout << std::endl;
+
+   std::cout << name << std::endl
+             << std::left << std::setw(14) << "kernel"
+             << std::setw(8) << "type"
+             << std::right << std::setw(8) << "batch"
+             << std::setw(12) << mBase + " ns";
+
+   if (!mTest.empty())
+   {
+      std::cout << std::setw(12) << mTest + " ns"
+                << std::setw(10) << "speedup";
+   }
+
+   std::cout << std::setw(12) << ErrorTitle(mErrorKind) << std::endl;
+}
+
+inline void Report::Add( const char * const pKernel, const char * const pType, const size_t batch,
+                         const double base_ns, const double test_ns, const double error, const bool passed )
+{
+   const Result result = { mSuite, pKernel, pType, batch, mBase, mTest, base_ns, test_ns, error, mErrorKind, passed };
+
+   mResults.push_back(result);
+
+   std::cout << std::left << std::setw(14) << pKernel
+             << std::setw(8) << pType
+             << std::right << std::setw(8) << batch
+             << std::fixed << std::setprecision(2)
+             << std::setw(12) << base_ns;
+
+   if (!mTest.empty())
+   {
+      std::cout << std::setw(12) << test_ns
+                << std::setw(10) << base_ns / test_ns;
+   }
+
+   std::cout << std::scientific << std::setprecision(2)
+             << std::setw(12) << error
+             << std::defaultfloat
+             << (passed ? "" : "  FAILED") << std::endl;
+}
+
+inline void Report::Add( const char * const pKernel, const char * const pType, const size_t batch,
+                         const double ns, const double error, const bool passed )
+{
+   Add(pKernel, pType, batch, ns, std::numeric_limits< double >::quiet_NaN(), error, passed);
+}
+
+inline bool Report::Write( ) const
+{
+   bool written = true;
+
+   if (!mJSONFile.empty())
+   {
+      std::ofstream file(mJSONFile);
+      WriteJSON(file);
+
+      written &= file.good();
+   }
+
+   if (!mCSVFile.empty())
+   {
+      std::ofstream file(mCSVFile);
+      WriteCSV(file);
+
+      written &= file.good();
+   }
+
+   if (!written) std::cerr << "unable to write the results" << std::endl;
+
+   return written;
+}
+
+inline void Report::WriteJSON( std::ostream & stream ) const
+{
+   const auto precision = stream.precision();
+
+   stream << "{\n  \"benchmark\": ";
+   WriteJSONString(stream, mBenchmark);
+
+   for (const auto & property : mProperties)
+   {
+      stream << ",\n  ";
+      WriteJSONString(stream, property.first);
+      stream << ": ";
+      WriteJSONString(stream, property.second);
+   }
+
+   stream << ",\n  \"results\": [";
+
+   for (size_t i = 0; i < mResults.size(); ++i)
+   {
+      const Result & result = mResults[i];
+
+      stream << (i ? ",\n" : "\n") << "    { \"suite\": ";
+      WriteJSONString(stream, result.suite);
+      stream << ", \"kernel\": ";
+      WriteJSONString(stream, result.kernel);
+      stream << ", \"type\": ";
+      WriteJSONString(stream, result.type);
+      stream << ", \"batch\": " << result.batch << ", \"base\": ";
+      WriteJSONString(stream, result.base);
+      stream << ", \"base_ns\": ";
+      WriteJSONNumber(stream, result.base_ns);
+
+      if (!result.test.empty())
+      {
+         stream << ", \"test\": ";
+         WriteJSONString(stream, result.test);
+         stream << ", \"test_ns\": ";
+         WriteJSONNumber(stream, result.test_ns);
+         stream << ", \"speedup\": ";
+         WriteJSONNumber(stream, result.base_ns / result.test_ns);
+      }
+
+      stream << ", \"" << ErrorKey(result.error_kind) << "\": ";
+      WriteJSONNumber(stream, result.error);
+      stream << ", \"passed\": " << (result.passed ? "true" : "false") << " }";
+   }
+
+   stream << "\n  ]\n}\n";
+
+   stream.precision(precision);
+}
+
+inline void Report::WriteCSV( std::ostream & stream ) const
+{
+   stream << "benchmark,suite,kernel,type,batch,base,base_ns,test,test_ns,speedup,error,error_kind,passed\n";
+
+   const auto precision = stream.precision(9);
+
+   for (const Result & result : mResults)
+   {
+      WriteCSVField(stream, mBenchmark); stream << ',';
+      WriteCSVField(stream, result.suite); stream << ',';
+      WriteCSVField(stream, result.kernel); stream << ',';
+      WriteCSVField(stream, result.type); stream << ',';
+      stream << result.batch << ',';
+      WriteCSVField(stream, result.base); stream << ',';
+      stream << result.base_ns << ',';
+      WriteCSVField(stream, result.test); stream << ',';
+
+      if (!result.test.empty()) stream << result.test_ns << ',' << result.base_ns / result.test_ns;
+      else stream << ',';
+
+      stream << ',' << result.error << ',' << ErrorKey(result.error_kind) << ',' << (result.passed ? 1 : 0) << '\n';
+   }
+
+   stream.precision(precision);
+}
+
+inline const std::vector< Report::Result > & Report::Results( ) const
+{
+   return mResults;
+}
+
+inline const char * Report::ErrorTitle( const Error error_kind )
+{
+   switch (error_kind)
+   {
+   case Error::MAX_ABSOLUTE: return "max error";
+   case Error::RMS: return "rms error";
+   default: return "rel error";
+   }
+}
+
+inline const char * Report::ErrorKey( const Error error_kind )
+{
+   switch (error_kind)
+   {
+   case Error::MAX_ABSOLUTE: return "max_error";
+   case Error::RMS: return "rms_error";
+   default: return "rel_error";
+   }
+}
+
+inline void Report::WriteJSONString( std::ostream & stream, const std::string & string )
+{
+   stream << '"';
+
+   for (const char c : string)
+   {
+      if (c == '"' || c == '\\') stream << '\\';
+
+      stream << c;
+   }
+
+   stream << '"';
+}
+
+inline void Report::WriteJSONNumber( std::ostream & stream, const double value )
+{
+   if (std::isfinite(value)) stream << std::setprecision(9) << value;
+   else stream << "null";
+}
+
+inline void Report::WriteCSVField( std::ostream & stream, const std::string & string )
+{
+   if (string.find_first_of(",\"\n") == std::string::npos)
+   {
+      stream << string;
+   }
+   else
+   {
+      stream << '"';
+
+      for (const char c : string)
+      {
+         if (c == '"') stream << '"';
+
+         stream << c;
+      }
+
+      stream << '"';
+   }
+}
+
+} // namespace bench
+
+#endif // _BENCH_HARNESS_H_
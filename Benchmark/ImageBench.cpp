@@ -0,0 +1,850 @@
+// local includes
+#include "BenchHarness.h"
+
+// wgl includes
+#include "SgiImage.h"
+#include "ImageHelper.h"
+#include "BlockCompression.h"
+
+// std includes
+#include <cmath>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+namespace
+{
+
+// collects the results of all the suites
+bench::Report gReport("wingl_image_bench");
+
+// number of pixels each conversion runs over
+const size_t NUM_PIXELS = 1 << 20;
+
+// width and height of the mipmapped images
+const uint32_t MIP_SIZES[] = { 256, 1024, 2048 };
+
+// width and height of the block compressed images, the last is not a multiple of 4
+const uint32_t BLOCK_SIZES[] = { 256, 1024, 1002 };
+
+// width and height of the sgi images, the last is not a multiple of 16
+const uint32_t SGI_SIZES[] = { 256, 1024, 1001 };
+
+// the srgb transfer functions the tables are built from
+double DecodeSRGB( const double c )
+{
+   return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+}
+
+double EncodeSRGB( const double l )
+{
+   return l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+}
+
+// random 8 bit pixels with a smooth gradient underneath, so the mip levels
+// have some structure, and alpha that is zero across a quarter of the image
+std::vector< uint8_t > ConstructImage( const uint32_t width, const uint32_t height, const uint32_t components )
+{
+   std::mt19937 generator(width * 31 + components);
+   std::uniform_int_distribution< int > noise(-16, 16);
+
+   std::vector< uint8_t > pixels(static_cast< size_t >(width) * height * components);
+
+   for (uint32_t y = 0; y < height; ++y)
+   {
+      for (uint32_t x = 0; x < width; ++x)
+      {
+         uint8_t * const pPixel = pixels.data() + (static_cast< size_t >(y) * width + x) * components;
+
+         for (uint32_t c = 0; c < components; ++c)
+         {
+            const int gradient = static_cast< int >((c % 2 ? x : y) * 255 / std::max< uint32_t >(width, height));
+
+            pPixel[c] = static_cast< uint8_t >(std::min(std::max(gradient + noise(generator), 0), 255));
+         }
+
+         if (components == 4 && x < width / 2 && y < height / 2) pPixel[3] = 0;
+      }
+   }
+
+   return pixels;
+}
+
+// largest difference between two arrays of components
+template < typename T >
+double MaxDifference( const T * const pExpected, const T * const pActual, const size_t count )
+{
+   double difference = 0.0;
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      difference = std::max(difference, std::abs(static_cast< double >(pExpected[i]) - static_cast< double >(pActual[i])));
+   }
+
+   return difference;
+}
+
+// compares the conversion kernels against straightforward per component
+// versions.  the times reported are per pixel.
+bool RunConversions( )
+{
+   bool passed = true;
+
+   const std::vector< uint8_t > rgba = ConstructImage(1024, NUM_PIXELS / 1024, 4);
+
+   // adds a row for a kernel that produces an array of components
+   const auto Compare = [ & ] ( const char * const pKernel, const char * const pType, auto && reference, auto && kernel, const double tolerance,
+                            const size_t num_pixels = NUM_PIXELS )
+   {
+      const auto expected = reference();
+      const auto actual = kernel();
+
+      const double error = expected.size() == actual.size() ?
+         MaxDifference(expected.data(), actual.data(), expected.size()) : std::numeric_limits< double >::max();
+
+      const double reference_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(reference()); }, 5);
+      const double kernel_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(kernel()); }, 5);
+
+      const bool compared = error <= tolerance;
+
+      gReport.Add(pKernel, pType, num_pixels, reference_ns / num_pixels, kernel_ns / num_pixels, error, compared);
+
+      passed &= compared;
+   };
+
+   Compare("rgba to bgra", "uint8",
+   [ & ] ( )
+   {
+      std::vector< uint8_t > bgra(rgba.size());
+      for (size_t i = 0; i < rgba.size(); i += 4)
+      {
+         bgra[i + 0] = rgba[i + 2]; bgra[i + 1] = rgba[i + 1]; bgra[i + 2] = rgba[i + 0]; bgra[i + 3] = rgba[i + 3];
+      }
+      return bgra;
+   },
+   [ & ] ( )
+   {
+      std::vector< uint8_t > bgra(rgba.size());
+      ImageHelper::SwizzleRedBlue(rgba.data(), bgra.data(), NUM_PIXELS, 4);
+      return bgra;
+   }, 0.0);
+
+   Compare("rgba to rgb", "uint8",
+   [ & ] ( )
+   {
+      std::vector< uint8_t > rgb;
+      rgb.reserve(NUM_PIXELS * 3);
+      for (size_t i = 0; i < rgba.size(); i += 4) rgb.insert(rgb.end(), rgba.begin() + i, rgba.begin() + i + 3);
+      return rgb;
+   },
+   [ & ] ( )
+   {
+      std::vector< uint8_t > rgb(NUM_PIXELS * 3);
+      ImageHelper::RGBAToRGB(rgba.data(), rgb.data(), NUM_PIXELS);
+      return rgb;
+   }, 0.0);
+
+   // 16 bit components spread across the whole range
+   std::vector< uint16_t > wide(rgba.size());
+   for (size_t i = 0; i < rgba.size(); ++i) wide[i] = static_cast< uint16_t >(rgba[i] * 251 + i % 251);
+
+   Compare("16 to 8 bit", "uint16",
+   [ & ] ( )
+   {
+      std::vector< uint8_t > reduced(wide.size());
+      for (size_t i = 0; i < wide.size(); ++i) reduced[i] = static_cast< uint8_t >(std::lround(wide[i] / 257.0));
+      return reduced;
+   },
+   [ & ] ( )
+   {
+      std::vector< uint8_t > reduced(wide.size());
+      ImageHelper::Reduce16To8(wide.data(), reduced.data(), wide.size());
+      return reduced;
+   }, 0.0);
+
+   Compare("srgb decode", "uint8",
+   [ & ] ( )
+   {
+      std::vector< float > linear(rgba.size());
+      for (size_t i = 0; i < rgba.size(); ++i)
+      {
+         linear[i] = static_cast< float >(i % 4 == 3 ? rgba[i] / 255.0 : DecodeSRGB(rgba[i] / 255.0));
+      }
+      return linear;
+   },
+   [ & ] ( )
+   {
+      std::vector< float > linear(rgba.size());
+      ImageHelper::SRGBToLinear(rgba.data(), linear.data(), NUM_PIXELS, 4);
+      return linear;
+   }, 1.0e-6);
+
+   // linear values across the whole range, the table is allowed to round
+   // the other way within a hundredth of a step of the midpoint
+   std::vector< float > linear(rgba.size());
+   for (size_t i = 0; i < linear.size(); ++i) linear[i] = static_cast< float >(i % 65536) / 65535.0f;
+
+   Compare("srgb encode", "float",
+   [ & ] ( )
+   {
+      std::vector< uint8_t > srgb(linear.size());
+      for (size_t i = 0; i < linear.size(); ++i)
+      {
+         srgb[i] = static_cast< uint8_t >(std::lround((i % 4 == 3 ? linear[i] : EncodeSRGB(linear[i])) * 255.0));
+      }
+      return srgb;
+   },
+   [ & ] ( )
+   {
+      std::vector< uint8_t > srgb(linear.size());
+      ImageHelper::LinearToSRGB(linear.data(), srgb.data(), NUM_PIXELS, 4);
+      return srgb;
+   }, 1.0);
+
+   // every 8 bit component survives the trip through linear exactly
+   Compare("srgb trip", "uint8",
+   [ & ] ( )
+   {
+      std::vector< uint8_t > values(256);
+      for (size_t i = 0; i < values.size(); ++i)
+      {
+         values[i] = static_cast< uint8_t >(std::lround(EncodeSRGB(DecodeSRGB(i / 255.0)) * 255.0));
+      }
+      return values;
+   },
+   [ & ] ( )
+   {
+      std::vector< uint8_t > values(256);
+      for (size_t i = 0; i < values.size(); ++i)
+      {
+         values[i] = ImageHelper::LinearToSRGB(ImageHelper::SRGBToLinear(static_cast< uint8_t >(i)));
+      }
+      return values;
+   }, 0.0, 256);
+
+   Compare("premultiply", "uint8",
+   [ & ] ( )
+   {
+      std::vector< uint8_t > premultiplied(rgba);
+      for (size_t i = 0; i < rgba.size(); ++i)
+      {
+         if (i % 4 != 3) premultiplied[i] = static_cast< uint8_t >(std::lround(rgba[i] * rgba[i | 3] / 255.0));
+      }
+      return premultiplied;
+   },
+   [ & ] ( )
+   {
+      std::vector< uint8_t > premultiplied(rgba.size());
+      ImageHelper::PremultiplyAlpha(rgba.data(), premultiplied.data(), NUM_PIXELS);
+      return premultiplied;
+   }, 0.0);
+
+   return passed;
+}
+
+// builds the first level below the base by averaging each 2x2 block directly
+std::vector< uint8_t > AverageLevel( const std::vector< uint8_t > & pixels, const uint32_t width, const uint32_t height,
+                                     const uint32_t components, const bool srgb )
+{
+   std::vector< uint8_t > level(static_cast< size_t >(width / 2) * (height / 2) * components);
+
+   for (uint32_t y = 0; y < height / 2; ++y)
+   {
+      for (uint32_t x = 0; x < width / 2; ++x)
+      {
+         for (uint32_t c = 0; c < components; ++c)
+         {
+            double sum = 0.0;
+
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+               const uint8_t value = pixels[((y * 2 + i / 2) * static_cast< size_t >(width) + x * 2 + i % 2) * components + c];
+
+               sum += srgb && c != 3 ? DecodeSRGB(value / 255.0) : value / 255.0;
+            }
+
+            const double average = srgb && c != 3 ? EncodeSRGB(sum / 4.0) : sum / 4.0;
+
+            level[(static_cast< size_t >(y) * (width / 2) + x) * components + c] = static_cast< uint8_t >(std::lround(average * 255.0));
+         }
+      }
+   }
+
+   return level;
+}
+
+// builds full mip chains serially and across the threads.  the parallel
+// chains must match the serial ones exactly, and the first box filtered
+// level must match a direct 2x2 average.  the times reported are per pixel
+// of the base level.
+bool RunMipmaps( )
+{
+   bool passed = true;
+
+   for (const uint32_t size : MIP_SIZES)
+   {
+      const std::vector< uint8_t > rgba = ConstructImage(size, size, 4);
+      const size_t num_pixels = static_cast< size_t >(size) * size;
+
+      const auto Compare = [ & ] ( const char * const pKernel, const ImageHelper::MipFilter filter, const bool srgb, const bool alpha_weighted )
+      {
+         const auto Build = [ & ] ( const bool parallel )
+         {
+            return ImageHelper::GenerateMipmaps(rgba.data(), size, size, 4, filter, srgb, alpha_weighted, parallel);
+         };
+
+         const std::vector< ImageHelper::MipLevel > serial = Build(false);
+         const std::vector< ImageHelper::MipLevel > parallel = Build(true);
+
+         bool compared = serial.size() + 1 == ImageHelper::NumMipLevels(size, size) && serial.size() == parallel.size();
+
+         for (size_t level = 0; compared && level < serial.size(); ++level)
+         {
+            compared = serial[level].width == std::max< uint32_t >(size >> (level + 1), 1) &&
+                       serial[level].pixels == parallel[level].pixels;
+         }
+
+         double error = 0.0;
+
+         if (compared && filter == ImageHelper::MipFilter::BOX && !alpha_weighted)
+         {
+            const std::vector< uint8_t > expected = AverageLevel(rgba, size, size, 4, srgb);
+
+            error = MaxDifference(expected.data(), serial[0].pixels.data(), expected.size());
+            compared = error <= 1.0;
+         }
+
+         const double serial_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(Build(false)); }, 3);
+         const double parallel_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(Build(true)); }, 3);
+
+         gReport.Add(pKernel, "rgba8", num_pixels, serial_ns / num_pixels, parallel_ns / num_pixels, error, compared);
+
+         passed &= compared;
+      };
+
+      Compare("box", ImageHelper::MipFilter::BOX, false, false);
+      Compare("box srgb", ImageHelper::MipFilter::BOX, true, false);
+      Compare("box alpha", ImageHelper::MipFilter::BOX, true, true);
+      Compare("kaiser", ImageHelper::MipFilter::KAISER, false, false);
+      Compare("kaiser srgb", ImageHelper::MipFilter::KAISER, true, false);
+   }
+
+   // odd sizes reduce to the floor of half and a constant image stays constant
+   const uint32_t width = 37, height = 5;
+   const std::vector< uint8_t > gray(static_cast< size_t >(width) * height * 3, 77);
+
+   for (const ImageHelper::MipFilter filter : { ImageHelper::MipFilter::BOX, ImageHelper::MipFilter::KAISER })
+   {
+      const auto Build = [ & ] ( const bool parallel )
+      {
+         return ImageHelper::GenerateMipmaps(gray.data(), width, height, 3, filter, true, false, parallel);
+      };
+
+      const std::vector< ImageHelper::MipLevel > levels = Build(false);
+
+      bool constant = levels.size() == 5 && levels[0].width == 18 && levels[0].height == 2 &&
+                      levels[4].width == 1 && levels[4].height == 1;
+
+      for (const ImageHelper::MipLevel & level : levels)
+      {
+         constant &= std::all_of(level.pixels.cbegin(), level.pixels.cend(), [ ] ( const uint8_t value ) { return value == 77; });
+      }
+
+      const double serial_ns = bench::MeasureNS(100, [ & ] ( size_t ) { bench::DoNotOptimize(Build(false)); });
+      const double parallel_ns = bench::MeasureNS(100, [ & ] ( size_t ) { bench::DoNotOptimize(Build(true)); });
+
+      gReport.Add(filter == ImageHelper::MipFilter::BOX ? "box odd" : "kaiser odd", "rgb8", width * height,
+                  serial_ns / (width * height), parallel_ns / (width * height), 0.0, constant);
+
+      passed &= constant;
+   }
+
+   return passed;
+}
+
+// root mean square difference of the first components of the source pixels
+// and the rgba pixels decoded from the blocks.  the pixels decoded as
+// transparent have no color, so they are left out.
+double RootMeanSquare( const std::vector< uint8_t > & pixels, const uint32_t components,
+                       const std::vector< uint8_t > & decoded, const uint32_t compared )
+{
+   double sum = 0.0;
+   size_t num_pixels = 0;
+
+   for (size_t i = 0; i < decoded.size() / 4; ++i)
+   {
+      if (!decoded[i * 4 + 3] && compared < 4) continue;
+
+      ++num_pixels;
+
+      for (uint32_t c = 0; c < compared; ++c)
+      {
+         const double difference = static_cast< double >(pixels[i * components + c]) - decoded[i * 4 + c];
+
+         sum += difference * difference;
+      }
+   }
+
+   return num_pixels ? std::sqrt(sum / (num_pixels * compared)) : 0.0;
+}
+
+// the error of bc1 blocks with their endpoints at the corners of the bounding
+// box of the colors, the simplest encoder the principal axis fit must beat
+double BoundingBoxError( const std::vector< uint8_t > & pixels, const uint32_t width, const uint32_t height,
+                         const uint32_t components )
+{
+   const auto Expand = [ ] ( const int value, const int bits )
+   {
+      const int max = (1 << bits) - 1;
+      const int quantized = (value * max + 127) / 255;
+
+      return bits == 5 ? (quantized << 3) | (quantized >> 2) : (quantized << 2) | (quantized >> 4);
+   };
+
+   double sum = 0.0;
+
+   for (uint32_t y = 0; y < height; y += 4)
+   {
+      for (uint32_t x = 0; x < width; x += 4)
+      {
+         int low[3] = { 255, 255, 255 }, high[3] = { 0, 0, 0 };
+
+         const auto Texel = [ & ] ( const uint32_t i, const uint32_t j )
+         {
+            return pixels.data() + (static_cast< size_t >(std::min(y + i, height - 1)) * width + std::min(x + j, width - 1)) * components;
+         };
+
+         for (uint32_t t = 0; t < 16; ++t)
+         {
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+               low[c] = std::min< int >(low[c], Texel(t / 4, t % 4)[c]);
+               high[c] = std::max< int >(high[c], Texel(t / 4, t % 4)[c]);
+            }
+         }
+
+         int palette[4][3];
+
+         for (uint32_t c = 0; c < 3; ++c)
+         {
+            palette[0][c] = Expand(high[c], c == 1 ? 6 : 5);
+            palette[1][c] = Expand(low[c], c == 1 ? 6 : 5);
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+         }
+
+         for (uint32_t t = 0; t < 16; ++t)
+         {
+            if (y + t / 4 >= height || x + t % 4 >= width) continue;
+
+            int nearest = 3 * 255 * 255;
+
+            for (const auto & color : palette)
+            {
+               int distance = 0;
+
+               for (uint32_t c = 0; c < 3; ++c)
+               {
+                  distance += (Texel(t / 4, t % 4)[c] - color[c]) * (Texel(t / 4, t % 4)[c] - color[c]);
+               }
+
+               nearest = std::min(nearest, distance);
+            }
+
+            sum += nearest;
+         }
+      }
+   }
+
+   return std::sqrt(sum / (static_cast< double >(width) * height * 3));
+}
+
+// compresses images serially and across the threads.  the parallel blocks
+// must match the serial ones exactly, bc1 must beat bounding box endpoints,
+// and the single channel formats must stay within a small error.  the times
+// reported are per pixel, and the error is the root mean square per component.
+bool RunBlockCompression( )
+{
+   bool passed = true;
+
+   for (const uint32_t size : BLOCK_SIZES)
+   {
+      const std::vector< uint8_t > rgba = ConstructImage(size, size, 4);
+      const std::vector< uint8_t > rgb = ConstructImage(size, size, 3);
+      const size_t num_pixels = static_cast< size_t >(size) * size;
+
+      const auto Compare = [ & ] ( const char * const pKernel, const std::vector< uint8_t > & pixels,
+                                   const uint32_t components, const BlockCompression::Format format,
+                                   const uint32_t compared, const double max_error )
+      {
+         const auto Compress = [ & ] ( const bool parallel )
+         {
+            std::vector< uint8_t > blocks(BlockCompression::CompressedSize(format, size, size));
+
+            BlockCompression::Compress(pixels.data(), size, size, components, format, blocks.data(), parallel);
+
+            return blocks;
+         };
+
+         const std::vector< uint8_t > serial = Compress(false);
+
+         std::vector< uint8_t > decoded(num_pixels * 4);
+         BlockCompression::Decompress(serial.data(), size, size, format, decoded.data());
+
+         const double error = RootMeanSquare(pixels, components, decoded, compared);
+
+         const bool matched = serial == Compress(true) && error <= max_error;
+
+         const double serial_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(Compress(false)); }, 3);
+         const double parallel_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(Compress(true)); }, 3);
+
+         gReport.Add(pKernel, components == 4 ? "rgba8" : "rgb8", num_pixels, serial_ns / num_pixels, parallel_ns / num_pixels, error, matched);
+
+         passed &= matched;
+
+         return decoded;
+      };
+
+      Compare("bc1", rgb, 3, BlockCompression::Format::BC1, 3, BoundingBoxError(rgb, size, size, 3));
+      Compare("bc3", rgba, 4, BlockCompression::Format::BC3, 4, BoundingBoxError(rgba, size, size, 4));
+      Compare("bc4", rgb, 3, BlockCompression::Format::BC4, 1, 2.5);
+      Compare("bc5", rgb, 3, BlockCompression::Format::BC5, 2, 2.5);
+
+      // bc1 with alpha keeps the transparent quarter of the image transparent
+      const std::vector< uint8_t > decoded = Compare("bc1 alpha", rgba, 4, BlockCompression::Format::BC1, 3, 8.0);
+
+      bool transparent = true;
+
+      for (size_t i = 0; i < num_pixels; ++i)
+      {
+         transparent &= decoded[i * 4 + 3] == (rgba[i * 4 + 3] < 128 ? 0 : 255);
+      }
+
+      passed &= transparent;
+   }
+
+   return passed;
+}
+
+// compresses blocks of one color, which must come back within a step of the
+// 8 bit color.  the times reported are per pixel, and the error is the largest
+// difference of a component.
+bool RunSolidBlocks( )
+{
+   bool passed = true;
+
+   std::vector< uint8_t > solid(256 * 4 * 3);
+
+   for (size_t i = 0; i < solid.size(); ++i) solid[i] = static_cast< uint8_t >(i / 3 % 256 / 4 * 4 + i % 3 * 85);
+
+   for (const BlockCompression::Format format : { BlockCompression::Format::BC1, BlockCompression::Format::BC4 })
+   {
+      std::vector< uint8_t > blocks(BlockCompression::CompressedSize(format, 256, 4));
+      std::vector< uint8_t > decoded(256 * 4 * 4);
+
+      const uint32_t compared = format == BlockCompression::Format::BC1 ? 3 : 1;
+
+      const double ns = bench::MeasureNS(100, [ & ] ( size_t )
+      {
+         BlockCompression::Compress(solid.data(), 256, 4, 3, format, blocks.data());
+         bench::DoNotOptimize(blocks);
+      });
+
+      BlockCompression::Decompress(blocks.data(), 256, 4, format, decoded.data());
+
+      double error = 0.0;
+
+      for (size_t i = 0; i < 256 * 4; ++i)
+      {
+         for (uint32_t c = 0; c < compared; ++c)
+         {
+            error = std::max(error, std::abs(static_cast< double >(solid[i * 3 + c]) - decoded[i * 4 + c]));
+         }
+      }
+
+      const bool exact = error <= (format == BlockCompression::Format::BC1 ? 1.0 : 0.0);
+
+      gReport.Add(format == BlockCompression::Format::BC1 ? "bc1 solid" : "bc4 solid", "rgb8", 256 * 4, ns / (256 * 4), error, exact);
+
+      passed &= exact;
+   }
+
+   return passed;
+}
+
+// builds an sgi image of the planes, run length encoding the rows when rle.
+// runs of three or more bytes are repeated packets and the rest are literal.
+std::vector< uint8_t > ConstructSgiImage( const std::vector< uint8_t > & planes,
+                                          const uint32_t width,
+                                          const uint32_t height,
+                                          const uint32_t channels,
+                                          const bool rle )
+{
+   std::vector< uint8_t > file(512);
+
+   const auto Put16 = [ & ] ( const size_t offset, const uint32_t value )
+   {
+      file[offset] = static_cast< uint8_t >(value >> 8);
+      file[offset + 1] = static_cast< uint8_t >(value);
+   };
+
+   const auto Put32 = [ & ] ( const size_t offset, const uint32_t value )
+   {
+      Put16(offset, value >> 16);
+      Put16(offset + 2, value & 0xffff);
+   };
+
+   Put16(0, 474);
+   file[2] = rle ? 1 : 0;
+   file[3] = 1;
+   Put16(4, 3);
+   Put16(6, width);
+   Put16(8, height);
+   Put16(10, channels);
+   Put32(16, 255);
+
+   const size_t num_rows = static_cast< size_t >(height) * channels;
+
+   if (!rle)
+   {
+      file.resize(512 + planes.size());
+      std::copy(planes.begin(), planes.end(), file.begin() + 512);
+
+      return file;
+   }
+
+   file.resize(512 + num_rows * 8);
+
+   for (size_t row = 0; row < num_rows; ++row)
+   {
+      const uint8_t * const pRow = planes.data() + row * width;
+      const size_t start = file.size();
+
+      for (uint32_t x = 0; x < width; )
+      {
+         uint32_t run = 1;
+
+         while (x + run < width && run < 127 && pRow[x + run] == pRow[x]) ++run;
+
+         if (run >= 3)
+         {
+            file.push_back(static_cast< uint8_t >(run));
+            file.push_back(pRow[x]);
+         }
+         else
+         {
+            run = 0;
+
+            while (x + run < width && run < 127 &&
+                   !(x + run + 2 < width && pRow[x + run] == pRow[x + run + 1] && pRow[x + run] == pRow[x + run + 2]))
+            {
+               ++run;
+            }
+
+            run = std::max< uint32_t >(run, 1);
+
+            file.push_back(static_cast< uint8_t >(0x80 | run));
+            file.insert(file.end(), pRow + x, pRow + x + run);
+         }
+
+         x += run;
+      }
+
+      file.push_back(0);
+
+      Put32(512 + row * 4, static_cast< uint32_t >(start));
+      Put32(512 + (num_rows + row) * 4, static_cast< uint32_t >(file.size() - start));
+   }
+
+   return file;
+}
+
+// straightforward decode of an sgi image into rgba, one pixel at a time
+void ReadSgiReference( const std::vector< uint8_t > & file, uint8_t * const pPixels )
+{
+   const auto Get16 = [ & ] ( const size_t offset ) { return static_cast< uint32_t >(file[offset] << 8 | file[offset + 1]); };
+   const auto Get32 = [ & ] ( const size_t offset ) { return Get16(offset) << 16 | Get16(offset + 2); };
+
+   const bool rle = file[2] == 1;
+   const uint32_t width = Get16(6);
+   const uint32_t height = Get16(8);
+   const uint32_t channels = Get16(10);
+
+   std::vector< uint8_t > planes(static_cast< size_t >(width) * height * channels);
+
+   for (size_t row = 0; row < static_cast< size_t >(height) * channels; ++row)
+   {
+      uint8_t * pDst = planes.data() + row * width;
+
+      if (!rle)
+      {
+         std::copy(file.begin() + 512 + row * width, file.begin() + 512 + (row + 1) * width, pDst);
+
+         continue;
+      }
+
+      for (size_t src = Get32(512 + row * 4); file[src] & 0x7f; )
+      {
+         const uint8_t packet = file[src++];
+
+         for (uint32_t i = 0; i < (packet & 0x7fu); ++i)
+         {
+            *pDst++ = packet & 0x80 ? file[src++] : file[src];
+         }
+
+         if (!(packet & 0x80)) ++src;
+      }
+   }
+
+   const size_t plane_size = static_cast< size_t >(width) * height;
+
+   for (size_t i = 0; i < plane_size; ++i)
+   {
+      const uint8_t gray = planes[i];
+
+      pPixels[i * 4 + 0] = gray;
+      pPixels[i * 4 + 1] = channels >= 3 ? planes[plane_size + i] : gray;
+      pPixels[i * 4 + 2] = channels >= 3 ? planes[plane_size * 2 + i] : gray;
+      pPixels[i * 4 + 3] = channels == 2 ? planes[plane_size + i] : channels == 4 ? planes[plane_size * 3 + i] : 255;
+   }
+}
+
+// decodes sgi images with the shared reader and against a per pixel
+// reference, for gray, gray with alpha, rgb and rgba images stored verbatim
+// and run length encoded.  the bgra reads must be the rgba reads with red
+// and blue swapped, and reading in strips of rows must match a whole read.
+// the times reported are per pixel.
+bool RunSgiImages( )
+{
+   bool passed = true;
+
+   for (const uint32_t size : SGI_SIZES)
+   {
+      const size_t num_pixels = static_cast< size_t >(size) * size;
+
+      for (const uint32_t channels : { 1u, 2u, 3u, 4u })
+      {
+         // flat bands on the left compress into runs, noise on the right does not
+         std::vector< uint8_t > planes(num_pixels * channels);
+         std::mt19937 generator(size + channels);
+
+         for (size_t i = 0; i < planes.size(); ++i)
+         {
+            const uint32_t x = i % size;
+            const uint32_t y = i / size % size;
+            const uint32_t c = static_cast< uint32_t >(i / num_pixels);
+
+            planes[i] = static_cast< uint8_t >(x < size / 2 ? (x / 16 + y / 16) * 8 + c * 64 : generator());
+         }
+
+         for (const bool rle : { false, true })
+         {
+            const std::vector< uint8_t > file = ConstructSgiImage(planes, size, size, channels, rle);
+
+            std::vector< uint8_t > expected(num_pixels * 4);
+            std::vector< uint8_t > rgba(num_pixels * 4);
+            std::vector< uint8_t > bgra(num_pixels * 4);
+            std::vector< uint8_t > strips(num_pixels * 4);
+
+            SgiImage::Reader reader;
+
+            bool matched = reader.Open(file.data(), file.size()) && reader.IsCompressed() == rle;
+
+            if (matched)
+            {
+               ReadSgiReference(file, expected.data());
+
+               matched &= reader.ReadRows(0, size, SgiImage::Layout::RGBA, rgba.data());
+               matched &= reader.ReadRows(0, size, SgiImage::Layout::BGRA, bgra.data());
+
+               for (uint32_t row = 0; row < size; row += 64)
+               {
+                  const uint32_t num_rows = std::min< uint32_t >(64, size - row);
+
+                  matched &= reader.ReadRows(row, num_rows, SgiImage::Layout::RGBA, strips.data() + static_cast< size_t >(row) * size * 4);
+               }
+
+               for (size_t i = 0; i < num_pixels; ++i)
+               {
+                  std::swap(bgra[i * 4], bgra[i * 4 + 2]);
+               }
+            }
+
+            const double error = std::max(MaxDifference(expected.data(), rgba.data(), rgba.size()),
+                                          MaxDifference(expected.data(), bgra.data(), bgra.size()));
+
+            matched &= error == 0.0 && strips == rgba;
+
+            const double scalar_ns = bench::MeasureNS(1, [ & ] ( size_t ) { ReadSgiReference(file, expected.data()); bench::DoNotOptimize(expected); }, 3);
+            const double kernel_ns = bench::MeasureNS(1, [ & ] ( size_t ) { reader.ReadRows(0, size, SgiImage::Layout::RGBA, rgba.data()); bench::DoNotOptimize(rgba); }, 3);
+
+            const char * const pNames[] = { "bw", "bw alpha", "rgb", "rgba" };
+            const std::string kernel = std::string(pNames[channels - 1]) + (rle ? " rle" : " raw");
+
+            gReport.Add(kernel.c_str(), "rgba8", num_pixels, scalar_ns / num_pixels, kernel_ns / num_pixels, error, matched);
+
+            passed &= matched;
+         }
+      }
+   }
+
+   // damaged images are refused rather than read past their end
+   std::vector< uint8_t > planes(64 * 64 * 3, 7);
+   std::vector< uint8_t > file = ConstructSgiImage(planes, 64, 64, 3, true);
+   std::vector< uint8_t > pixels(64 * 64 * 4);
+
+   SgiImage::Reader reader;
+
+   bool refused = !reader.Open(file.data(), 600) && !reader.Open(file.data(), file.size() - 1);
+
+   // the last row repeats past the width of the image
+   file[file.size() - 3] = 0x7f;
+   refused &= !reader.Open(file.data(), file.size()) || !reader.ReadRows(0, 64, SgiImage::Layout::RGBA, pixels.data());
+
+   const double ns = bench::MeasureNS(100, [ & ] ( size_t ) { bench::DoNotOptimize(reader.Open(file.data(), file.size() - 1)); });
+
+   gReport.Add("damaged", "rgba8", 1, ns, refused ? 0.0 : 1.0, refused);
+
+   passed &= refused;
+
+   return passed;
+}
+
+} // namespace
+
+int main( const int argc, const char * const argv[] )
+{
+   if (!gReport.ParseArgs(argc, argv)) return 2;
+
+   gReport.SetProperty("hardware_threads", std::to_string(std::thread::hardware_concurrency()));
+
+   bool passed = true;
+
+   gReport.BeginSuite("image conversions (ns per pixel)", "scalar", "kernel", bench::Report::Error::MAX_ABSOLUTE);
+
+   passed &= RunConversions();
+
+   gReport.BeginSuite("mipmaps (ns per base pixel)", "serial", "parallel", bench::Report::Error::MAX_ABSOLUTE);
+
+   passed &= RunMipmaps();
+
+   gReport.BeginSuite("block compression (ns per pixel)", "serial", "parallel", bench::Report::Error::RMS);
+
+   passed &= RunBlockCompression();
+
+   gReport.BeginSuite("solid color blocks (ns per pixel)", "serial", nullptr, bench::Report::Error::MAX_ABSOLUTE);
+
+   passed &= RunSolidBlocks();
+
+   gReport.BeginSuite("sgi images (ns per pixel)", "scalar", "kernel", bench::Report::Error::MAX_ABSOLUTE);
+
+   passed &= RunSgiImages();
+
+   passed &= gReport.Write();
+
+   return passed ? 0 : 1;
+}
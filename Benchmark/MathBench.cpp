@@ -0,0 +1,844 @@
+// local includes
+#include "BenchHarness.h"
+
+// wgl includes
+#include "Affine3.h"
+#include "Matrix.h"
+#include "Quaternion.h"
+#include "MathHelper.h"
+#include "MatrixHelper.h"
+#include "MatrixKernels.h"
+#include "RigidTransform.h"
+
+// std includes
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <type_traits>
+
+namespace
+{
+
+// number of matrices each kernel walks per iteration
+const size_t BATCH_SIZE = 1024;
+
+// number of points in each batch transform... small enough
+// to stay in cache so the kernels are measured, not memory
+const size_t NUM_POINTS = 1 << 16;
+
+// number of quat pairs in each batch interpolation
+const size_t NUM_QUATS = 1 << 14;
+
+// batch sizes of the core kernels... from a batch that stays
+// in the l1 cache to one that has to stream from memory
+const size_t CORE_BATCH_SIZES[] = { 16, 1024, 65536 };
+
+// number of kernel calls in each core measurement regardless of the batch size
+const size_t CORE_CALLS = 1 << 16;
+
+// collects the results of all the suites
+bench::Report gReport("wingl_math_bench");
+
+// creates a set of well conditioned matrices... rotation, scale, and
+// translation with a small amount of noise so nothing is exactly affine
+template < typename T >
+std::vector< Matrix< T > > GenerateMatrices( const size_t count, std::mt19937 & generator )
+{
+   std::uniform_real_distribution< T > angle(T(-180), T(180));
+   std::uniform_real_distribution< T > scale(T(0.5), T(2));
+   std::uniform_real_distribution< T > offset(T(-100), T(100));
+   std::uniform_real_distribution< T > noise(T(-0.01), T(0.01));
+
+   std::vector< Matrix< T > > matrices;
+   matrices.reserve(count);
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      Matrix< T > mat =
+         Matrix< T >::Translate(offset(generator), offset(generator), offset(generator)) *
+         Matrix< T >::Rotate(angle(generator), Vector< T, 3 >(T(1), T(2), T(3)).UnitVector()) *
+         Matrix< T >::Scale(scale(generator), scale(generator), scale(generator));
+
+      for (T & t : mat.mT) t += noise(generator);
+
+      matrices.push_back(mat);
+   }
+
+   return matrices;
+}
+
+// creates a set of rigid transforms about random axes... scaled
+// by a random non uniform scale when requested
+template < typename T >
+std::vector< Matrix< T > > GenerateAffineMatrices( const size_t count, const bool scale, std::mt19937 & generator )
+{
+   std::uniform_real_distribution< T > angle(T(-180), T(180));
+   std::uniform_real_distribution< T > axis(T(-1), T(1));
+   std::uniform_real_distribution< T > scales(T(0.5), T(2));
+   std::uniform_real_distribution< T > offset(T(-100), T(100));
+
+   std::vector< Matrix< T > > matrices;
+   matrices.reserve(count);
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      const Vector< T, 3 > rotation_axis =
+         Vector< T, 3 >(axis(generator), axis(generator), axis(generator) + T(2)).UnitVector();
+
+      Matrix< T > mat =
+         Matrix< T >::Translate(offset(generator), offset(generator), offset(generator)) *
+         Matrix< T >::Rotate(angle(generator), rotation_axis);
+
+      if (scale) mat *= Matrix< T >::Scale(scales(generator), scales(generator), scales(generator));
+
+      matrices.push_back(mat);
+   }
+
+   return matrices;
+}
+
+// compares one kernel and adds a single row to the report
+// returns false if the simd result drifts from the scalar result
+template < typename T, typename ScalarFn, typename SimdFn >
+bool Compare( const char * const pName, const size_t result_size, ScalarFn && scalar, SimdFn && simd )
+{
+   std::vector< T > scalar_result(BATCH_SIZE * result_size);
+   std::vector< T > simd_result(BATCH_SIZE * result_size);
+
+   // first validate the results before measuring
+   for (size_t i = 0; i < BATCH_SIZE; ++i)
+   {
+      scalar(i, scalar_result.data() + i * result_size);
+      simd(i, simd_result.data() + i * result_size);
+   }
+
+   const T error = bench::RelativeError(scalar_result.data(), simd_result.data(), scalar_result.size());
+   const bool passed = error <= bench::Tolerance< T >();
+
+   const double scalar_ns =
+      bench::MeasureNS(BATCH_SIZE * 64, [ & ] ( const size_t i )
+      {
+         T * const pOut = scalar_result.data() + (i % BATCH_SIZE) * result_size;
+         scalar(i % BATCH_SIZE, pOut);
+         bench::DoNotOptimize(*pOut);
+      });
+
+   const double simd_ns =
+      bench::MeasureNS(BATCH_SIZE * 64, [ & ] ( const size_t i )
+      {
+         T * const pOut = simd_result.data() + (i % BATCH_SIZE) * result_size;
+         simd(i % BATCH_SIZE, pOut);
+         bench::DoNotOptimize(*pOut);
+      });
+
+   gReport.Add(pName, bench::TypeName< T >(), BATCH_SIZE, scalar_ns, simd_ns, error, passed);
+
+   return passed;
+}
+
+// compares a whole array transform against the per vertex operator.
+// gather interleaves the batch result if it is not already interleaved.
+// the times reported are per point.
+template < typename T, typename ScalarFn, typename BatchFn, typename GatherFn >
+bool CompareBatch( const char * const pName, ScalarFn && scalar, BatchFn && batch, GatherFn && gather )
+{
+   std::vector< T > scalar_result(NUM_POINTS * 3);
+   std::vector< T > batch_result(NUM_POINTS * 3);
+
+   scalar(scalar_result.data());
+   batch(batch_result.data());
+   gather(batch_result.data());
+
+   const T error = bench::RelativeError(scalar_result.data(), batch_result.data(), scalar_result.size());
+   const bool passed = error <= bench::Tolerance< T >();
+
+   const double scalar_ns =
+      bench::MeasureNS(1, [ & ] ( size_t ) { scalar(scalar_result.data()); bench::DoNotOptimize(scalar_result[0]); }, 5);
+
+   const double batch_ns =
+      bench::MeasureNS(1, [ & ] ( size_t ) { batch(batch_result.data()); bench::DoNotOptimize(batch_result[0]); }, 5);
+
+   gReport.Add(pName, bench::TypeName< T >(), NUM_POINTS, scalar_ns / NUM_POINTS, batch_ns / NUM_POINTS, error, passed);
+
+   return passed;
+}
+
+template < typename T >
+bool RunMatrixKernels( std::mt19937 & generator )
+{
+   typedef details::ScalarMatrixKernels< T > Scalar;
+   typedef details::MatrixKernels< T > Simd;
+
+   const std::vector< Matrix< T > > lhs = GenerateMatrices< T >(BATCH_SIZE, generator);
+   const std::vector< Matrix< T > > rhs = GenerateMatrices< T >(BATCH_SIZE, generator);
+
+   std::vector< Vector< T, 4 > > vecs;
+   std::uniform_real_distribution< T > component(T(-10), T(10));
+
+   for (size_t i = 0; i < BATCH_SIZE; ++i)
+   {
+      vecs.push_back(Vector< T, 4 >(component(generator), component(generator), component(generator), T(1)));
+   }
+
+   bool passed = true;
+
+   passed &= Compare< T >("multiply", 16,
+                          [ & ] ( const size_t i, T * const pOut ) { Scalar::Multiply(lhs[i].mT, rhs[i].mT, pOut); },
+                          [ & ] ( const size_t i, T * const pOut ) { Simd::Multiply(lhs[i].mT, rhs[i].mT, pOut); });
+
+   passed &= Compare< T >("transform", 4,
+                          [ & ] ( const size_t i, T * const pOut ) { Scalar::Transform(lhs[i].mT, vecs[i].mT, pOut); },
+                          [ & ] ( const size_t i, T * const pOut ) { Simd::Transform(lhs[i].mT, vecs[i].mT, pOut); });
+
+   passed &= Compare< T >("inverse", 16,
+                          [ & ] ( const size_t i, T * const pOut ) { Scalar::Inverse(lhs[i].mT, pOut); },
+                          [ & ] ( const size_t i, T * const pOut ) { Simd::Inverse(lhs[i].mT, pOut); });
+
+   passed &= Compare< T >("determinant", 1,
+                          [ & ] ( const size_t i, T * const pOut ) { *pOut = Scalar::Determinant(lhs[i].mT); },
+                          [ & ] ( const size_t i, T * const pOut ) { *pOut = Simd::Determinant(lhs[i].mT); });
+
+   return passed;
+}
+
+// converts the results of the transform types so they can be validated
+template < typename T > Matrix< T > AsMatrix( const Matrix< T > & mat ) { return mat; }
+template < typename T > Matrix< T > AsMatrix( const Affine3< T > & aff ) { return aff.ToMatrix(); }
+template < typename T > Matrix< T > AsMatrix( const RigidTransform< T > & rigid ) { return rigid.ToMatrix(); }
+template < typename T > Matrix< T > AsMatrix( const Vector< T, 3 > & point ) { return Matrix< T >::Translate(point); }
+
+// times the same operation on two transform types
+template < typename T, typename BaseFn, typename TestFn >
+bool CompareTypes( const char * const pName, BaseFn && base, TestFn && test )
+{
+   T error = 0;
+
+   for (size_t i = 0; i < BATCH_SIZE; ++i)
+   {
+      const Matrix< T > expected = AsMatrix(base(i));
+      const Matrix< T > actual = AsMatrix(test(i));
+
+      error = std::max(error, bench::RelativeError(expected.mT, actual.mT, 16));
+   }
+
+   const bool passed = error <= bench::Tolerance< T >();
+
+   const double base_ns =
+      bench::MeasureNS(BATCH_SIZE * 64, [ & ] ( const size_t i )
+      {
+         const auto result = base(i % BATCH_SIZE);
+         bench::DoNotOptimize(result);
+      });
+
+   const double test_ns =
+      bench::MeasureNS(BATCH_SIZE * 64, [ & ] ( const size_t i )
+      {
+         const auto result = test(i % BATCH_SIZE);
+         bench::DoNotOptimize(result);
+      });
+
+   gReport.Add(pName, bench::TypeName< T >(), BATCH_SIZE, base_ns, test_ns, error, passed);
+
+   return passed;
+}
+
+template < typename T >
+bool RunAffineTransforms( std::mt19937 & generator )
+{
+   const std::vector< Matrix< T > > lhs = GenerateAffineMatrices< T >(BATCH_SIZE, true, generator);
+   const std::vector< Matrix< T > > rhs = GenerateAffineMatrices< T >(BATCH_SIZE, true, generator);
+
+   std::vector< Affine3< T > > affine_lhs, affine_rhs;
+   std::vector< Vector< T, 3 > > points;
+   std::uniform_real_distribution< T > component(T(-10), T(10));
+
+   for (size_t i = 0; i < BATCH_SIZE; ++i)
+   {
+      affine_lhs.push_back(Affine3< T >(lhs[i]));
+      affine_rhs.push_back(Affine3< T >(rhs[i]));
+      points.push_back(Vector< T, 3 >(component(generator), component(generator), component(generator)));
+   }
+
+
+   bool passed = true;
+
+   passed &= CompareTypes< T >("compose",
+                               [ & ] ( const size_t i ) { return lhs[i] * rhs[i]; },
+                               [ & ] ( const size_t i ) { return affine_lhs[i] * affine_rhs[i]; });
+
+   passed &= CompareTypes< T >("inverse",
+                               [ & ] ( const size_t i ) { return lhs[i].Inverse(); },
+                               [ & ] ( const size_t i ) { return affine_lhs[i].Inverse(); });
+
+   passed &= CompareTypes< T >("point",
+                               [ & ] ( const size_t i ) { return lhs[i] * points[i]; },
+                               [ & ] ( const size_t i ) { return affine_lhs[i] * points[i]; });
+
+   return passed;
+}
+
+template < typename T >
+bool RunRigidTransforms( std::mt19937 & generator )
+{
+   const std::vector< Matrix< T > > lhs = GenerateAffineMatrices< T >(BATCH_SIZE, false, generator);
+   const std::vector< Matrix< T > > rhs = GenerateAffineMatrices< T >(BATCH_SIZE, false, generator);
+
+   std::vector< RigidTransform< T > > rigid_lhs, rigid_rhs;
+   std::vector< Vector< T, 3 > > points;
+   std::uniform_real_distribution< T > component(T(-10), T(10));
+
+   for (size_t i = 0; i < BATCH_SIZE; ++i)
+   {
+      rigid_lhs.push_back(RigidTransform< T >(lhs[i]));
+      rigid_rhs.push_back(RigidTransform< T >(rhs[i]));
+      points.push_back(Vector< T, 3 >(component(generator), component(generator), component(generator)));
+   }
+
+
+   bool passed = true;
+
+   passed &= CompareTypes< T >("compose",
+                               [ & ] ( const size_t i ) { return lhs[i] * rhs[i]; },
+                               [ & ] ( const size_t i ) { return rigid_lhs[i] * rigid_rhs[i]; });
+
+   passed &= CompareTypes< T >("inverse",
+                               [ & ] ( const size_t i ) { return lhs[i].Inverse(); },
+                               [ & ] ( const size_t i ) { return rigid_lhs[i].Inverse(); });
+
+   passed &= CompareTypes< T >("inverse orth",
+                               [ & ] ( const size_t i ) { return lhs[i].InverseFromOrthogonal(); },
+                               [ & ] ( const size_t i ) { return rigid_lhs[i].Inverse(); });
+
+   passed &= CompareTypes< T >("point",
+                               [ & ] ( const size_t i ) { return lhs[i] * points[i]; },
+                               [ & ] ( const size_t i ) { return rigid_lhs[i] * points[i]; });
+
+   return passed;
+}
+
+// quats of four separate x, y, z, w arrays
+template < typename T >
+struct QuatArrays
+{
+   QuatArrays( ) : mT ( NUM_QUATS * 4 )
+   {
+      for (size_t c = 0; c < 4; ++c) mC[c] = mT.data() + c * NUM_QUATS;
+   }
+
+   Quaternion< T > Get( const size_t i ) const
+   {
+      return Quaternion< T >(mC[0][i], mC[1][i], mC[2][i], mC[3][i]);
+   }
+
+   void Set( const size_t i, const Quaternion< T > & quat )
+   {
+      for (size_t c = 0; c < 4; ++c) mC[c][i] = quat[static_cast< uint32_t >(c)];
+   }
+
+   std::vector< T >  mT;
+   T *               mC[4];
+};
+
+// compares a batch interpolation against the per quat interpolation.
+// the error is measured against the same interpolation evaluated
+// at a higher precision.  the times reported are per pair.
+template < typename T, typename ScalarFn, typename BatchFn >
+bool CompareInterpolation( const char * const pName, const QuatArrays< T > & reference,
+                           ScalarFn && scalar, BatchFn && batch )
+{
+   QuatArrays< T > scalar_result, batch_result;
+
+   scalar(scalar_result);
+   batch(batch_result);
+
+   const T error = std::max(bench::RelativeError(reference.mT.data(), scalar_result.mT.data(), reference.mT.size()),
+                            bench::RelativeError(reference.mT.data(), batch_result.mT.data(), reference.mT.size()));
+   const bool passed = error <= bench::Tolerance< T >();
+
+   const double scalar_ns =
+      bench::MeasureNS(1, [ & ] ( size_t ) { scalar(scalar_result); bench::DoNotOptimize(scalar_result.mT[0]); }, 5);
+
+   const double batch_ns =
+      bench::MeasureNS(1, [ & ] ( size_t ) { batch(batch_result); bench::DoNotOptimize(batch_result.mT[0]); }, 5);
+
+   gReport.Add(pName, bench::TypeName< T >(), NUM_QUATS, scalar_ns / NUM_QUATS, batch_ns / NUM_QUATS, error, passed);
+
+   return passed;
+}
+
+template < typename T >
+bool RunQuaternionInterpolation( std::mt19937 & generator )
+{
+   // long double is only wider than double on some compilers
+   typedef typename std::conditional< std::is_same< T, float >::value, double, long double >::type R;
+
+   std::normal_distribution< T > component(T(0), T(1));
+   std::uniform_real_distribution< T > interpolant(T(0), T(1));
+   std::uniform_real_distribution< T > noise(T(-0.001), T(0.001));
+
+   QuatArrays< T > from, to;
+   std::vector< T > t(NUM_QUATS);
+
+   for (size_t i = 0; i < NUM_QUATS; ++i)
+   {
+      const Quaternion< T > q0 =
+         Quaternion< T >(component(generator), component(generator), component(generator), component(generator)).Normalize();
+
+      // every eighth pair is almost the same rotation, where slerp has to avoid dividing by sin(theta)
+      const Quaternion< T > q1 = i % 8 ?
+         Quaternion< T >(component(generator), component(generator), component(generator), component(generator)).Normalize() :
+         Quaternion< T >(q0.X() + noise(generator), q0.Y() + noise(generator), q0.Z() + noise(generator), q0.W()).Normalize();
+
+      from.Set(i, q0);
+      to.Set(i, q1);
+      t[i] = interpolant(generator);
+   }
+
+   // evaluates the reference results from the same inputs at the higher precision
+   const auto Reference = [ & ] ( Quaternion< R > (*pInterpolate)( const Quaternion< R > &, const Quaternion< R > &, const R & ) )
+   {
+      QuatArrays< T > reference;
+
+      for (size_t i = 0; i < NUM_QUATS; ++i)
+      {
+         const Quaternion< R > q0(R(from.mC[0][i]), R(from.mC[1][i]), R(from.mC[2][i]), R(from.mC[3][i]));
+         const Quaternion< R > q1(R(to.mC[0][i]), R(to.mC[1][i]), R(to.mC[2][i]), R(to.mC[3][i]));
+
+         const Quaternion< R > q = pInterpolate(q0, q1, R(t[i]));
+
+         reference.Set(i, Quaternion< T >(T(q.X()), T(q.Y()), T(q.Z()), T(q.W())));
+      }
+
+      return reference;
+   };
+
+   const auto PerQuat = [ & ] ( Quaternion< T > (*pInterpolate)( const Quaternion< T > &, const Quaternion< T > &, const T & ),
+                                QuatArrays< T > & out )
+   {
+      for (size_t i = 0; i < NUM_QUATS; ++i)
+      {
+         out.Set(i, pInterpolate(from.Get(i), to.Get(i), t[i]));
+      }
+   };
+
+   const T * const pFrom[] = { from.mC[0], from.mC[1], from.mC[2], from.mC[3] };
+   const T * const pTo[] = { to.mC[0], to.mC[1], to.mC[2], to.mC[3] };
+
+   bool passed = true;
+
+   passed &= CompareInterpolation< T >("slerp", Reference(&Quaternion< R >::Slerp),
+                                       [ & ] ( QuatArrays< T > & out ) { PerQuat(&Quaternion< T >::Slerp, out); },
+                                       [ & ] ( QuatArrays< T > & out ) { Quaternion< T >::SlerpBatch(pFrom, pTo, t.data(), NUM_QUATS, out.mC); });
+
+   passed &= CompareInterpolation< T >("nlerp", Reference(&Quaternion< R >::Nlerp),
+                                       [ & ] ( QuatArrays< T > & out ) { PerQuat(&Quaternion< T >::Nlerp, out); },
+                                       [ & ] ( QuatArrays< T > & out ) { Quaternion< T >::NlerpBatch(pFrom, pTo, t.data(), NUM_QUATS, out.mC); });
+
+   return passed;
+}
+
+template < typename T >
+bool RunBatchTransforms( std::mt19937 & generator )
+{
+   const Matrix< T > affine = GenerateMatrices< T >(1, generator).front();
+   const Matrix< T > affine_normal = affine.Inverse().Transpose();
+   const Matrix< T > projection = Matrix< T >::Perspective(T(45), T(1.5), T(0.1), T(1000)) * affine;
+
+   std::vector< T > points(NUM_POINTS * 3);
+   std::uniform_real_distribution< T > component(T(-100), T(100));
+
+   for (T & t : points) t = component(generator);
+
+   const T * const pPoints = points.data();
+
+   // reference path used before the batch api... one vector at a time
+   const auto PerVertex = [ pPoints ] ( const Matrix< T > & mat, const bool points, T * const pOut )
+   {
+      for (size_t i = 0; i < NUM_POINTS; ++i)
+      {
+         const T * const pIn = pPoints + i * 3;
+
+         if (points)
+         {
+            const Vector< T, 3 > v = mat * Vector< T, 3 >(pIn[0], pIn[1], pIn[2]);
+            pOut[i * 3 + 0] = v.X(); pOut[i * 3 + 1] = v.Y(); pOut[i * 3 + 2] = v.Z();
+         }
+         else
+         {
+            const Vector< T, 4 > v = mat * Vector< T, 4 >(pIn[0], pIn[1], pIn[2], T(0));
+            pOut[i * 3 + 0] = v.X(); pOut[i * 3 + 1] = v.Y(); pOut[i * 3 + 2] = v.Z();
+         }
+      }
+   };
+
+   // the separate x, y, z arrays are gathered back into triples for validation
+   std::vector< T > soa(NUM_POINTS * 3);
+   T * const pX = soa.data(), * const pY = pX + NUM_POINTS, * const pZ = pY + NUM_POINTS;
+
+   const auto Interleaved = [ ] ( T * const ) { };
+   const auto GatherSoA = [ & ] ( T * const pOut )
+   {
+      for (size_t i = 0; i < NUM_POINTS; ++i)
+      {
+         pOut[i * 3 + 0] = pX[i]; pOut[i * 3 + 1] = pY[i]; pOut[i * 3 + 2] = pZ[i];
+      }
+   };
+
+   bool passed = true;
+
+   passed &= CompareBatch< T >("points",
+                               [ & ] ( T * const pOut ) { PerVertex(affine, true, pOut); },
+                               [ & ] ( T * const pOut ) { affine.TransformPoints(pPoints, NUM_POINTS, pOut); },
+                               Interleaved);
+
+   passed &= CompareBatch< T >("points proj",
+                               [ & ] ( T * const pOut ) { PerVertex(projection, true, pOut); },
+                               [ & ] ( T * const pOut ) { projection.TransformPoints(pPoints, NUM_POINTS, pOut); },
+                               Interleaved);
+
+   passed &= CompareBatch< T >("points soa",
+                               [ & ] ( T * const pOut ) { PerVertex(affine, true, pOut); },
+                               [ & ] ( T * const ) { affine.TransformPoints(pPoints, NUM_POINTS, pX, pY, pZ); },
+                               GatherSoA);
+
+   passed &= CompareBatch< T >("points par",
+                               [ & ] ( T * const pOut ) { PerVertex(affine, true, pOut); },
+                               [ & ] ( T * const pOut ) { affine.TransformPoints(pPoints, NUM_POINTS, pOut, true); },
+                               Interleaved);
+
+   passed &= CompareBatch< T >("normals",
+                               [ & ] ( T * const pOut ) { PerVertex(affine_normal, false, pOut); },
+                               [ & ] ( T * const pOut ) { affine_normal.TransformNormals(pPoints, NUM_POINTS, pOut); },
+                               Interleaved);
+
+   return passed;
+}
+
+// determinant by gaussian elimination with partial pivoting at a higher precision
+template < typename T >
+long double ReferenceDeterminant( const Matrix< T > & mat )
+{
+   long double m[4][4];
+
+   for (size_t r = 0; r < 4; ++r)
+      for (size_t c = 0; c < 4; ++c)
+         m[r][c] = mat.mT[c * 4 + r];
+
+   long double det = 1;
+
+   for (size_t c = 0; c < 4; ++c)
+   {
+      size_t pivot = c;
+
+      for (size_t r = c + 1; r < 4; ++r)
+      {
+         if (std::abs(m[r][c]) > std::abs(m[pivot][c])) pivot = r;
+      }
+
+      if (m[pivot][c] == 0) return 0;
+
+      if (pivot != c)
+      {
+         std::swap(m[pivot], m[c]);
+         det = -det;
+      }
+
+      det *= m[c][c];
+
+      for (size_t r = c + 1; r < 4; ++r)
+      {
+         const long double scale = m[r][c] / m[c][c];
+
+         for (size_t k = c; k < 4; ++k) m[r][k] -= scale * m[c][k];
+      }
+   }
+
+   return det;
+}
+
+// largest difference of the product of two matrices from the expected
+// matrix, with the product evaluated at a higher precision
+template < typename T >
+T ProductError( const Matrix< T > & lhs, const Matrix< T > & rhs, const Matrix< T > & expected )
+{
+   long double max_error = 0;
+
+   for (size_t c = 0; c < 4; ++c)
+   {
+      for (size_t r = 0; r < 4; ++r)
+      {
+         long double product = 0;
+
+         for (size_t k = 0; k < 4; ++k)
+         {
+            product += static_cast< long double >(lhs.mT[k * 4 + r]) * rhs.mT[c * 4 + k];
+         }
+
+         const long double magnitude = std::max(std::abs(product), 1.0L);
+
+         max_error = std::max(max_error, std::abs(product - expected.mT[c * 4 + r]) / magnitude);
+      }
+   }
+
+   return static_cast< T >(max_error);
+}
+
+// largest magnitude of the elements of a matrix
+template < typename T >
+T MaxElement( const Matrix< T > & mat )
+{
+   T max_element = 0;
+
+   for (const T t : mat.mT) max_element = std::max(max_element, std::abs(t));
+
+   return max_element;
+}
+
+// tolerance of the core kernels.  the errors are measured against invariants
+// of the results, which amplify the rounding of the kernel a little.
+template < typename T > T CoreTolerance( );
+template < > float CoreTolerance< float >( ) { return 1.0e-3f; }
+template < > double CoreTolerance< double >( ) { return 1.0e-9; }
+
+// measures a kernel over each of the core batch sizes.  the kernel maps an
+// input index to a result and the error function checks the result for the
+// input it was computed from.  the times reported are per call.
+template < typename T, typename KernelFn, typename ErrorFn >
+bool MeasureCore( const char * const pName, KernelFn && kernel, ErrorFn && error )
+{
+   typedef typename std::decay< decltype(kernel(size_t(0))) >::type Result;
+
+   bool passed = true;
+
+   for (const size_t batch : CORE_BATCH_SIZES)
+   {
+      std::vector< Result > results(batch);
+
+      // first validate the results before measuring
+      T max_error = 0;
+
+      for (size_t i = 0; i < batch; ++i)
+      {
+         results[i] = kernel(i);
+         max_error = std::max(max_error, error(i, results[i]));
+      }
+
+      const bool batch_passed = max_error <= CoreTolerance< T >();
+
+      const double ns =
+         bench::MeasureNS(std::max< size_t >(CORE_CALLS / batch, 1), [ & ] ( size_t )
+         {
+            for (size_t i = 0; i < batch; ++i) results[i] = kernel(i);
+            bench::DoNotOptimize(results[0]);
+         }, 5);
+
+      gReport.Add(pName, bench::TypeName< T >(), batch, ns / batch, max_error, batch_passed);
+
+      passed &= batch_passed;
+   }
+
+   return passed;
+}
+
+// measures the public math api as an application would call it
+template < typename T >
+bool RunCoreKernels( std::mt19937 & generator )
+{
+   const size_t count = *std::max_element(std::begin(CORE_BATCH_SIZES), std::end(CORE_BATCH_SIZES));
+
+   const std::vector< Matrix< T > > lhs = GenerateMatrices< T >(count, generator);
+   const std::vector< Matrix< T > > rhs = GenerateMatrices< T >(count, generator);
+
+   std::uniform_real_distribution< T > component(T(-10), T(10));
+   std::uniform_real_distribution< T > angle(T(-170), T(170));
+   // pitch stays away from the poles where yaw and roll are ambiguous
+   std::uniform_real_distribution< T > pitch(T(-80), T(80));
+   std::uniform_real_distribution< T > fov(T(30), T(90));
+   std::uniform_real_distribution< T > aspect(T(0.5), T(2));
+   std::uniform_real_distribution< T > z_near(T(0.1), T(1));
+   std::uniform_real_distribution< T > z_far(T(10), T(1000));
+
+   std::vector< Vector< T, 3 > > a(count), b(count), eye(count), center(count), ypr(count);
+   std::vector< Vector< T, 4 > > frustums(count);
+   std::vector< Matrix< T > > yaw_pitch_roll(count), axis_angle(count);
+   std::vector< Quaternion< T > > quats(count);
+
+   const Vector< T, 3 > up(T(0), T(1), T(0));
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      a[i] = Vector< T, 3 >(component(generator), component(generator), component(generator));
+      b[i] = Vector< T, 3 >(component(generator), component(generator), component(generator));
+
+      // the view direction should not be close to the up vector
+      eye[i] = Vector< T, 3 >(component(generator), component(generator), component(generator));
+
+      do center[i] = Vector< T, 3 >(component(generator), component(generator), component(generator));
+      while (((center[i] - eye[i]).UnitVector() ^ up).Length() < T(0.1));
+
+      frustums[i] = Vector< T, 4 >(fov(generator), aspect(generator), z_near(generator), z_far(generator));
+
+      // the decomposition expects a view rotation, roll * pitch * yaw,
+      // and returns the negated yaw and pitch
+      const T y = angle(generator), p = pitch(generator), r = angle(generator);
+
+      yaw_pitch_roll[i] = Matrix< T >::Rotate(r, T(0), T(0), T(1)) *
+                          Matrix< T >::Rotate(p, T(1), T(0), T(0)) *
+                          Matrix< T >::Rotate(y, T(0), T(1), T(0));
+      ypr[i] = Vector< T, 3 >(-math::DegToRad(y), -math::DegToRad(p), math::DegToRad(r));
+
+      // quats built from an axis and angle, checked against the matrix rotation
+      const Vector< T, 3 > axis = a[i].UnitVector();
+      const T degrees = angle(generator);
+      const T half = math::DegToRad(degrees) / 2;
+
+      quats[i] = Quaternion< T >(axis.X() * std::sin(half), axis.Y() * std::sin(half), axis.Z() * std::sin(half), std::cos(half));
+      axis_angle[i] = Matrix< T >::Rotate(degrees, axis);
+   }
+
+   const Matrix< T > identity;
+
+   bool passed = true;
+
+   passed &= MeasureCore< T >("multiply",
+                              [ & ] ( const size_t i ) { return lhs[i] * rhs[i]; },
+                              [ & ] ( const size_t i, const Matrix< T > & m ) { return ProductError(lhs[i], rhs[i], m); });
+
+   passed &= MeasureCore< T >("inverse",
+                              [ & ] ( const size_t i ) { return lhs[i].Inverse(); },
+                              [ & ] ( const size_t i, const Matrix< T > & m )
+                              {
+                                 // scaled by the growth the rounding of the product can see,
+                                 // so ill conditioned matrices are not penalized
+                                 return ProductError(lhs[i], m, identity) / std::max(MaxElement(lhs[i]) * MaxElement(m), T(1));
+                              });
+
+   passed &= MeasureCore< T >("determinant",
+                              [ & ] ( const size_t i ) { return lhs[i].Determinant(); },
+                              [ & ] ( const size_t i, const T det )
+                              {
+                                 const long double expected = ReferenceDeterminant(lhs[i]);
+
+                                 return static_cast< T >(std::abs(expected - det) / std::max(std::abs(expected), 1.0L));
+                              });
+
+   passed &= MeasureCore< T >("lookat",
+                              [ & ] ( const size_t i ) { return Matrix< T >::LookAt(eye[i], center[i], up); },
+                              [ & ] ( const size_t i, const Matrix< T > & m )
+                              {
+                                 // the eye moves to the origin and the center onto the -z axis
+                                 const T distance = (center[i] - eye[i]).Length();
+                                 const Vector< T, 3 > e = m * eye[i], c = m * center[i];
+
+                                 return std::max({ e.Length(), std::abs(c.X()), std::abs(c.Y()), std::abs(c.Z() + distance) }) /
+                                        std::max(distance, T(1));
+                              });
+
+   passed &= MeasureCore< T >("perspective",
+                              [ & ] ( const size_t i )
+                              {
+                                 const Vector< T, 4 > & f = frustums[i];
+
+                                 return Matrix< T >::Perspective(f.X(), f.Y(), f.Z(), f.W());
+                              },
+                              [ & ] ( const size_t i, const Matrix< T > & m )
+                              {
+                                 // the near and far planes map to the -1 and 1 clip planes
+                                 const Vector< T, 4 > n = m * Vector< T, 4 >(T(0), T(0), -frustums[i].Z(), T(1));
+                                 const Vector< T, 4 > f = m * Vector< T, 4 >(T(0), T(0), -frustums[i].W(), T(1));
+
+                                 return std::max(std::abs(n.Z() / n.W() + 1), std::abs(f.Z() / f.W() - 1));
+                              });
+
+   passed &= MeasureCore< T >("decompose ypr",
+                              [ & ] ( const size_t i ) { return MatrixHelper::DecomposeYawPitchRoll(yaw_pitch_roll[i]); },
+                              [ & ] ( const size_t i, const Vector< T, 3 > & angles )
+                              {
+                                 return bench::RelativeError(ypr[i].mT, angles.mT, 3);
+                              });
+
+   passed &= MeasureCore< T >("normalize",
+                              [ & ] ( const size_t i ) { return a[i].UnitVector(); },
+                              [ & ] ( const size_t, const Vector< T, 3 > & v ) { return std::abs(v.Length() - 1); });
+
+   passed &= MeasureCore< T >("cross",
+                              [ & ] ( const size_t i ) { return a[i] ^ b[i]; },
+                              [ & ] ( const size_t i, const Vector< T, 3 > & c )
+                              {
+                                 // perpendicular to both inputs
+                                 const T scale = a[i].Length() * b[i].Length() * std::max(a[i].Length(), b[i].Length());
+
+                                 return std::max(std::abs(c * a[i]), std::abs(c * b[i])) / scale;
+                              });
+
+   passed &= MeasureCore< T >("quat matrix",
+                              [ & ] ( const size_t i ) { return quats[i].ToMatrix(); },
+                              [ & ] ( const size_t i, const Matrix< T > & m )
+                              {
+                                 return bench::RelativeError(axis_angle[i].mT, m.mT, 16);
+                              });
+
+   return passed;
+}
+
+} // namespace
+
+int main( const int argc, const char * const argv[] )
+{
+   if (!gReport.ParseArgs(argc, argv)) return 2;
+
+   std::mt19937 generator(0x5EED);
+
+   const char * const pBackend =
+#if defined( WGL_SIMD_AVX )
+      "avx";
+#elif defined( WGL_SIMD_SSE2 )
+      "sse2";
+#else
+      "portable";
+#endif
+
+   gReport.SetProperty("simd", pBackend);
+
+   std::cout << "simd backend: " << pBackend << std::endl << std::endl;
+
+   bool passed = true;
+
+   gReport.BeginSuite("core kernels (ns per call)", "api");
+
+   passed &= RunCoreKernels< float >(generator);
+   passed &= RunCoreKernels< double >(generator);
+
+   gReport.BeginSuite("matrix kernels (ns per call)", "scalar", "simd");
+
+   passed &= RunMatrixKernels< float >(generator);
+   passed &= RunMatrixKernels< double >(generator);
+
+   gReport.BeginSuite("batch transforms (ns per point)", "vertex", "batch");
+
+   passed &= RunBatchTransforms< float >(generator);
+   passed &= RunBatchTransforms< double >(generator);
+
+   gReport.BeginSuite("affine transforms (ns per call)", "matrix", "affine");
+
+   passed &= RunAffineTransforms< float >(generator);
+   passed &= RunAffineTransforms< double >(generator);
+
+   gReport.BeginSuite("rigid transforms (ns per call)", "matrix", "rigid");
+
+   passed &= RunRigidTransforms< float >(generator);
+   passed &= RunRigidTransforms< double >(generator);
+
+   gReport.BeginSuite("quat interpolation (ns per pair)", "quat", "batch");
+
+   passed &= RunQuaternionInterpolation< float >(generator);
+   passed &= RunQuaternionInterpolation< double >(generator);
+
+   passed &= gReport.Write();
+
+   return passed ? 0 : 1;
+}
@@ -0,0 +1,1079 @@
+// local includes
+#include "BenchHarness.h"
+
+// wgl includes
+#include "Vector.h"
+#include "MeshCache.h"
+#include "MeshCodec.h"
+#include "GeomHelper.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+
+// std includes
+#include <array>
+#include <cmath>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <tuple>
+#include <string>
+#include <fstream>
+#include <utility>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <algorithm>
+#include <filesystem>
+
+namespace
+{
+
+// collects the results of all the suites
+bench::Report gReport("wingl_mesh_bench");
+
+// approximate number of triangles in each of the scaling meshes
+const size_t SCALING_TRIANGLES[] = { 1000, 10000, 100000, 1000000, 10000000 };
+
+// reference normal builder written with the vector operator chains
+template < typename T >
+std::vector< Vector< T, 3 > > ChainNormals( const std::vector< Vector< T, 3 > > & vertices,
+                                            const std::vector< GLuint > & indices )
+{
+   std::vector< Vector< T, 3 > > normals(vertices.size(), Vector< T, 3 >(T(0), T(0), T(0)));
+
+   for (size_t i = 0; i < indices.size(); i += 3)
+   {
+      const GLuint i0 = indices[i + 0], i1 = indices[i + 1], i2 = indices[i + 2];
+
+      const Vector< T, 3 > n = ((vertices[i1] - vertices[i0]) ^ (vertices[i2] - vertices[i0])).UnitVector();
+
+      normals[i0] += n; normals[i1] += n; normals[i2] += n;
+   }
+
+   for (Vector< T, 3 > & n : normals) n.Normalize();
+
+   return normals;
+}
+
+// reference tangent builder written with the vector operator chains
+template < typename T >
+std::pair< std::vector< Vector< T, 3 > >, std::vector< Vector< T, 3 > > >
+ChainTangents( const std::vector< Vector< T, 3 > > & vertices, const std::vector< Vector< T, 3 > > & normals,
+               const std::vector< Vector< T, 2 > > & tex_coords, const std::vector< GLuint > & indices )
+{
+   std::vector< Vector< T, 3 > > tangents(vertices.size(), Vector< T, 3 >(T(0), T(0), T(0)));
+   std::vector< Vector< T, 3 > > bitangents(vertices.size());
+
+   for (size_t i = 0; i < indices.size(); i += 3)
+   {
+      const GLuint i0 = indices[i + 0], i1 = indices[i + 1], i2 = indices[i + 2];
+
+      const Vector< T, 3 > e1 = vertices[i1] - vertices[i0];
+      const Vector< T, 3 > e2 = vertices[i2] - vertices[i0];
+      const Vector< T, 2 > st1 = tex_coords[i1] - tex_coords[i0];
+      const Vector< T, 2 > st2 = tex_coords[i2] - tex_coords[i0];
+
+      const T dividend = st1.X() * st2.Y() - st2.X() * st1.Y();
+      const T det = dividend == 0 ? 1 : 1 / dividend;
+
+      Vector< T, 3 > t = (e1 * st2.Y() - e2 * st1.Y()) * det;
+
+      if (t.Length() == 0) t = e1.Length() != 0 ? e1.UnitVector() : e2.UnitVector();
+
+      tangents[i0] += t; tangents[i1] += t; tangents[i2] += t;
+   }
+
+   for (size_t i = 0; i < tangents.size(); ++i)
+   {
+      const Vector< T, 3 > & n = normals[i];
+
+      tangents[i].Normalize();
+      tangents[i] = (tangents[i] - n * (n * tangents[i])).UnitVector();
+      bitangents[i] = (n ^ tangents[i]).UnitVector();
+   }
+
+   return std::make_pair(tangents, bitangents);
+}
+
+// compares the mesh builders against the reference operator chains.
+// the times reported are per triangle.
+bool RunMeshBuilders( )
+{
+   const GeomHelper::Shape sphere = GeomHelper::ConstructSphere(256, 256);
+   const size_t num_triangles = sphere.indices.size() / 3;
+
+   typedef std::pair< std::vector< Vec3f >, std::vector< Vec3f > > Result;
+
+   const auto Flatten = [ ] ( const Result & result )
+   {
+      std::vector< float > flat;
+
+      for (const Vec3f & v : result.first) flat.insert(flat.end(), v.mT, v.mT + 3);
+      for (const Vec3f & v : result.second) flat.insert(flat.end(), v.mT, v.mT + 3);
+
+      return flat;
+   };
+
+   const auto CompareBuilder = [ & ] ( const char * const pName, auto && chain, auto && fused )
+   {
+      const std::vector< float > expected = Flatten(chain());
+      const std::vector< float > actual = Flatten(fused());
+
+      const float error = bench::RelativeError(expected.data(), actual.data(), expected.size());
+      const bool passed = expected.size() == actual.size() && error <= bench::Tolerance< float >();
+
+      const double chain_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(chain()); }, 5);
+      const double fused_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(fused()); }, 5);
+
+      gReport.Add(pName, "float", num_triangles, chain_ns / num_triangles, fused_ns / num_triangles, error, passed);
+
+      return passed;
+   };
+
+   const std::vector< Vec3f > normals = GeomHelper::ConstructNormals(sphere.vertices, sphere.indices);
+
+   bool passed = true;
+
+   passed &= CompareBuilder("normals",
+                            [ & ] ( ) { return Result(ChainNormals(sphere.vertices, sphere.indices), { }); },
+                            [ & ] ( ) { return Result(GeomHelper::ConstructNormals(sphere.vertices, sphere.indices), { }); });
+
+   passed &= CompareBuilder("tangents",
+                            [ & ] ( ) { return ChainTangents(sphere.vertices, normals, sphere.tex_coords, sphere.indices); },
+                            [ & ] ( ) { return GeomHelper::ConstructTangentsAndBitangents(sphere.vertices, normals, sphere.tex_coords, sphere.indices); });
+
+   return passed;
+}
+
+// constructs a bumpy grid of about the requested number of triangles,
+// with normals, texture coordinates, and indices in row order
+GeomHelper::Shape ConstructGrid( const size_t num_triangles )
+{
+   const size_t cells = std::max< size_t >(static_cast< size_t >(std::sqrt(num_triangles * 0.5)), 1);
+   const size_t verts = cells + 1;
+
+   GeomHelper::Shape grid;
+   grid.geom_type = GL_TRIANGLES;
+
+   grid.vertices.reserve(verts * verts);
+   grid.tex_coords.reserve(verts * verts);
+   grid.indices.reserve(cells * cells * 6);
+
+   for (size_t z = 0; z < verts; ++z)
+   {
+      for (size_t x = 0; x < verts; ++x)
+      {
+         const float s = static_cast< float >(x) / cells;
+         const float t = static_cast< float >(z) / cells;
+
+         grid.vertices.push_back(Vec3f(s, 0.05f * std::sin(s * 40.0f) * std::cos(t * 30.0f), t));
+         grid.tex_coords.push_back(Vec2f(s * 8.0f, t * 8.0f));
+      }
+   }
+
+   for (size_t z = 0; z < cells; ++z)
+   {
+      for (size_t x = 0; x < cells; ++x)
+      {
+         const GLuint i0 = static_cast< GLuint >(z * verts + x);
+         const GLuint i1 = static_cast< GLuint >(i0 + verts);
+
+         grid.indices.insert(grid.indices.end(), { i0, i1, i0 + 1, i0 + 1, i1, i1 + 1 });
+      }
+   }
+
+   grid.normals = GeomHelper::ConstructNormals(grid.vertices, grid.indices);
+
+   return grid;
+}
+
+// compares the serial and parallel mesh builders from a thousand
+// to ten million triangles.  the times reported are per triangle.
+bool RunMeshScaling( )
+{
+   bool passed = true;
+
+   for (const size_t requested : SCALING_TRIANGLES)
+   {
+      const GeomHelper::Shape grid = ConstructGrid(requested);
+      const size_t num_triangles = grid.indices.size() / 3;
+
+      // keep the largest meshes from taking over the run
+      const size_t repetitions = num_triangles > 1000000 ? 2 : 5;
+
+      const auto CompareBuilder = [ & ] ( const char * const pName, auto && build )
+      {
+         const auto expected = build(false);
+         const auto actual = build(true);
+
+         const float error =
+            bench::RelativeError(expected.data()->mT, actual.data()->mT, expected.size() * 3);
+         const bool compared = expected.size() == actual.size() && error <= bench::Tolerance< float >();
+
+         const double serial_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(build(false)); }, repetitions);
+         const double parallel_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(build(true)); }, repetitions);
+
+         gReport.Add(pName, "float", num_triangles, serial_ns / num_triangles, parallel_ns / num_triangles, error, compared);
+
+         return compared;
+      };
+
+      passed &= CompareBuilder("normals", [ & ] ( const bool parallel )
+      {
+         return GeomHelper::ConstructNormals(grid.vertices, grid.indices, parallel);
+      });
+
+      passed &= CompareBuilder("tangents", [ & ] ( const bool parallel )
+      {
+         const auto tangents_bitangents =
+            GeomHelper::ConstructTangentsAndBitangents(grid.vertices, grid.normals, grid.tex_coords, grid.indices, parallel);
+
+         // fold the bitangents in after the tangents to compare both
+         std::vector< Vec3f > flat(tangents_bitangents.first);
+         flat.insert(flat.end(), tangents_bitangents.second.cbegin(), tangents_bitangents.second.cend());
+
+         return flat;
+      });
+   }
+
+   return passed;
+}
+
+// approximate number of triangles in each of the normal repair meshes
+const size_t REPAIR_TRIANGLES[] = { 1000, 10000, 100000 };
+
+// the normals of a grid with a third of them zeroed or made nan, as the
+// models with bad normal data come in
+std::vector< Vec3f > DamageNormals( const std::vector< Vec3f > & normals )
+{
+   std::vector< Vec3f > damaged(normals);
+
+   for (size_t i = 0; i < damaged.size(); ++i)
+   {
+      if (i % 6 == 1) damaged[i] = Vec3f(0.0f, 0.0f, 0.0f);
+      if (i % 6 == 4) damaged[i] = Vec3f(std::numeric_limits< float >::quiet_NaN(), 0.0f, 0.0f);
+   }
+
+   return damaged;
+}
+
+// determines if the normal needs to be repaired, as the model import does
+bool IsBadNormal( const Vec3f & normal )
+{
+   const Vec3f norm = normal.UnitVector();
+
+   return norm.Length() == 0 || std::isnan(norm.X()) || std::isnan(norm.Y()) || std::isnan(norm.Z());
+}
+
+// the normal of the face starting at the index
+Vec3f FaceNormal( const GeomHelper::Shape & shape, const size_t index )
+{
+   const Vec3f & e0 = shape.vertices[shape.indices[index + 0]];
+   const Vec3f & e1 = shape.vertices[shape.indices[index + 1]];
+   const Vec3f & e2 = shape.vertices[shape.indices[index + 2]];
+
+   return ((e1 - e0) ^ (e2 - e0)).UnitVector();
+}
+
+// repairs the normals by searching the faces for each bad normal,
+// as the model import did before the adjacency
+void RepairNormalsSearch( const GeomHelper::Shape & shape, std::vector< Vec3f > & normals )
+{
+   for (size_t i = 0; i < normals.size(); ++i)
+   {
+      if (!IsBadNormal(normals[i])) continue;
+
+      size_t face = 0;
+
+      while (face < shape.indices.size() &&
+             shape.indices[face + 0] != i && shape.indices[face + 1] != i && shape.indices[face + 2] != i)
+      {
+         face += 3;
+      }
+
+      if (face < shape.indices.size()) normals[i] = FaceNormal(shape, face);
+   }
+}
+
+// repairs the normals from the first face of each vertex in the adjacency,
+// built the first time a bad normal is found, as the model import does
+void RepairNormalsAdjacency( const GeomHelper::Shape & shape, std::vector< Vec3f > & normals )
+{
+   GeomHelper::VertexAdjacency adjacency;
+
+   for (size_t i = 0; i < normals.size(); ++i)
+   {
+      if (!IsBadNormal(normals[i])) continue;
+
+      if (adjacency.offsets.empty())
+      {
+         adjacency = GeomHelper::ConstructVertexAdjacency(shape.indices, shape.vertices.size());
+      }
+
+      if (adjacency.offsets[i] != adjacency.offsets[i + 1])
+      {
+         normals[i] = FaceNormal(shape, adjacency.triangles[adjacency.offsets[i]] * 3);
+      }
+   }
+}
+
+// compares repairing the bad normals of a model by searching the faces
+// against looking them up in the vertex adjacency, and building all the
+// normals with and without an adjacency.  the times reported are per vertex.
+bool RunNormalRepair( )
+{
+   bool passed = true;
+
+   for (const size_t requested : REPAIR_TRIANGLES)
+   {
+      const GeomHelper::Shape grid = ConstructGrid(requested);
+      const size_t num_vertices = grid.vertices.size();
+      const std::vector< Vec3f > damaged = DamageNormals(grid.normals);
+
+      const auto Repair = [ & ] ( void (* const pRepair)( const GeomHelper::Shape &, std::vector< Vec3f > & ) )
+      {
+         std::vector< Vec3f > normals(damaged);
+         pRepair(grid, normals);
+
+         return normals;
+      };
+
+      const std::vector< Vec3f > expected = Repair(RepairNormalsSearch);
+      const std::vector< Vec3f > actual = Repair(RepairNormalsAdjacency);
+
+      // the first face of each vertex is the same either way, so the results match exactly
+      const bool repaired =
+         std::none_of(actual.cbegin(), actual.cend(), IsBadNormal) &&
+         std::memcmp(expected.data(), actual.data(), expected.size() * sizeof(Vec3f)) == 0;
+
+      // keep the quadratic search from taking over the run
+      const size_t repetitions = num_vertices > 10000 ? 1 : 5;
+
+      const double search_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(Repair(RepairNormalsSearch)); }, repetitions);
+      const double adjacency_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(Repair(RepairNormalsAdjacency)); }, 5);
+
+      gReport.Add("repair", "float", num_vertices, search_ns / num_vertices, adjacency_ns / num_vertices, 0.0, repaired);
+
+      passed &= repaired;
+
+      // the normals gathered through the adjacency sum the faces in the same order
+      const GeomHelper::VertexAdjacency adjacency = GeomHelper::ConstructVertexAdjacency(grid.indices, num_vertices);
+
+      const std::vector< Vec3f > scattered = GeomHelper::ConstructNormals(grid.vertices, grid.indices);
+      const std::vector< Vec3f > gathered = GeomHelper::ConstructNormals(grid.vertices, grid.indices, adjacency);
+
+      const bool constructed =
+         std::memcmp(scattered.data(), gathered.data(), scattered.size() * sizeof(Vec3f)) == 0;
+
+      const double scatter_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(GeomHelper::ConstructNormals(grid.vertices, grid.indices)); }, 5);
+      const double gather_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(GeomHelper::ConstructNormals(grid.vertices, grid.indices, adjacency)); }, 5);
+
+      gReport.Add("normals", "float", num_vertices, scatter_ns / num_vertices, gather_ns / num_vertices, 0.0, constructed);
+
+      passed &= constructed;
+   }
+
+   return passed;
+}
+
+// triangles as their three positions, starting from the smallest position
+// so the winding is kept, in sorted order.  triangles with repeated
+// positions are left out, since welding is allowed to remove them.
+std::vector< std::array< float, 9 > > CanonicalTriangles( const GeomHelper::Shape & shape )
+{
+   std::vector< std::array< float, 9 > > triangles;
+
+   const size_t num_indices = shape.indices.empty() ? shape.vertices.size() : shape.indices.size();
+
+   for (size_t i = 0; i + 2 < num_indices; i += 3)
+   {
+      Vec3f p[3];
+
+      for (size_t corner = 0; corner < 3; ++corner)
+      {
+         p[corner] = shape.vertices[shape.indices.empty() ? i + corner : shape.indices[i + corner]];
+      }
+
+      if (p[0] == p[1] || p[1] == p[2] || p[2] == p[0]) continue;
+
+      const auto Less = [ ] ( const Vec3f & a, const Vec3f & b )
+      {
+         return std::lexicographical_compare(a.mT, a.mT + 3, b.mT, b.mT + 3);
+      };
+
+      const size_t first = Less(p[1], p[0]) ? (Less(p[2], p[1]) ? 2 : 1) : (Less(p[2], p[0]) ? 2 : 0);
+
+      std::array< float, 9 > triangle;
+
+      for (size_t corner = 0; corner < 3; ++corner)
+      {
+         std::copy(p[(first + corner) % 3].mT, p[(first + corner) % 3].mT + 3, triangle.begin() + corner * 3);
+      }
+
+      triangles.push_back(triangle);
+   }
+
+   std::sort(triangles.begin(), triangles.end());
+
+   return triangles;
+}
+
+// runs the mesh optimizer over the generated shapes and a triangle soup.
+// the times reported are per triangle, the cache statistics are printed
+// after the suite.
+bool RunMeshOptimizer( )
+{
+   const GeomHelper::Shape grid = ConstructGrid(100000);
+
+   // the grid with every corner given its own vertex
+   GeomHelper::Shape soup;
+   soup.geom_type = GL_TRIANGLES;
+
+   for (const GLuint index : grid.indices)
+   {
+      soup.vertices.push_back(grid.vertices[index]);
+      soup.tex_coords.push_back(grid.tex_coords[index]);
+      soup.normals.push_back(grid.normals[index]);
+   }
+
+   const std::pair< const char *, GeomHelper::Shape > shapes[] =
+   {
+      { "box", GeomHelper::ConstructBox(1.0f, 1.0f, 1.0f) },
+      { "sphere", GeomHelper::ConstructSphere(256, 256) },
+      { "grid", grid },
+      { "soup", soup }
+   };
+
+   std::vector< std::pair< const char *, MeshOptimizer::OptimizeStats > > stats;
+
+   bool passed = true;
+
+   for (const auto & shape : shapes)
+   {
+      GeomHelper::Shape optimized = shape.second;
+
+      const MeshOptimizer::OptimizeStats optimize_stats = MeshOptimizer::Optimize(optimized);
+
+      const bool compared =
+         CanonicalTriangles(shape.second) == CanonicalTriangles(optimized) &&
+         optimize_stats.after.acmr <= optimize_stats.before.acmr;
+
+      const size_t num_triangles = optimize_stats.before.triangles;
+
+      const double optimize_ns = bench::MeasureNS(1, [ & ] ( size_t )
+      {
+         GeomHelper::Shape copy = shape.second;
+
+         bench::DoNotOptimize(MeshOptimizer::Optimize(copy));
+      }, 5);
+
+      gReport.Add(shape.first, "float", num_triangles, optimize_ns / num_triangles, 0.0, compared);
+
+      stats.emplace_back(shape.first, optimize_stats);
+
+      passed &= compared;
+   }
+
+   std::cout << std::endl
+             << "vertex cache (" << MeshOptimizer::VERTEX_CACHE_SIZE << " entry fifo)" << std::endl
+             << std::left << std::setw(14) << "shape"
+             << std::right << std::setw(12) << "acmr before" << std::setw(12) << "acmr after"
+             << std::setw(12) << "atvr before" << std::setw(12) << "atvr after"
+             << std::setw(10) << "welded" << std::setw(12) << "degenerate" << std::endl;
+
+   for (const auto & shape_stats : stats)
+   {
+      const MeshOptimizer::OptimizeStats & s = shape_stats.second;
+
+      std::cout << std::left << std::setw(14) << shape_stats.first
+                << std::right << std::fixed << std::setprecision(3)
+                << std::setw(12) << s.before.acmr << std::setw(12) << s.after.acmr
+                << std::setw(12) << s.before.atvr << std::setw(12) << s.after.atvr
+                << std::setw(10) << s.welded_vertices << std::setw(12) << s.degenerate_triangles
+                << std::defaultfloat << std::endl;
+   }
+
+   return passed;
+}
+
+// builds the level of detail chains of a sphere and a grid.  the times
+// reported are per source triangle, the levels are printed after the suite.
+bool RunLodChains( )
+{
+   const float RATIOS[] = { 0.5f, 0.25f, 0.125f, 0.01f };
+
+   GeomHelper::Shape sphere = GeomHelper::ConstructSphere(256, 256);
+   GeomHelper::Shape grid = ConstructGrid(100000);
+
+   MeshOptimizer::Optimize(sphere);
+   MeshOptimizer::Optimize(grid);
+
+   const std::pair< const char *, const GeomHelper::Shape * > shapes[] =
+   {
+      { "sphere", &sphere },
+      { "grid", &grid }
+   };
+
+   std::vector< std::pair< const char *, std::vector< MeshSimplifier::LodLevel > > > chains;
+
+   bool passed = true;
+
+   for (const auto & shape : shapes)
+   {
+      const std::vector< float > ratios(std::begin(RATIOS), std::end(RATIOS));
+      const std::vector< MeshSimplifier::LodLevel > chain = MeshSimplifier::ConstructLodChain(*shape.second, ratios);
+
+      const size_t num_triangles = shape.second->indices.size() / 3;
+
+      // each level reaches its target, the errors grow, and the
+      // triangles are valid and reference the source vertices
+      bool compared = chain.size() == ratios.size() + 1;
+
+      for (size_t level = 1; compared && level < chain.size(); ++level)
+      {
+         const std::vector< GLuint > & indices = chain[level].indices;
+
+         compared &= indices.size() / 3 <= num_triangles * ratios[level - 1] * 1.05 + 1;
+         compared &= chain[level].error >= chain[level - 1].error;
+
+         for (size_t i = 0; compared && i < indices.size(); i += 3)
+         {
+            compared &= indices[i + 0] < shape.second->vertices.size() &&
+                        indices[i + 1] < shape.second->vertices.size() &&
+                        indices[i + 2] < shape.second->vertices.size() &&
+                        indices[i + 0] != indices[i + 1] &&
+                        indices[i + 1] != indices[i + 2] &&
+                        indices[i + 2] != indices[i + 0];
+         }
+      }
+
+      const double chain_ns = bench::MeasureNS(1, [ & ] ( size_t )
+      {
+         bench::DoNotOptimize(MeshSimplifier::ConstructLodChain(*shape.second, ratios));
+      }, 3);
+
+      gReport.Add(shape.first, "float", num_triangles, chain_ns / num_triangles, 0.0, compared);
+
+      chains.emplace_back(shape.first, chain);
+
+      passed &= compared;
+   }
+
+   std::cout << std::endl
+             << "levels of detail" << std::endl
+             << std::left << std::setw(14) << "shape"
+             << std::right << std::setw(8) << "level" << std::setw(12) << "triangles"
+             << std::setw(12) << "error" << std::endl;
+
+   for (const auto & chain : chains)
+   {
+      for (size_t level = 0; level < chain.second.size(); ++level)
+      {
+         std::cout << std::left << std::setw(14) << chain.first
+                   << std::right << std::setw(8) << level
+                   << std::setw(12) << chain.second[level].indices.size() / 3
+                   << std::scientific << std::setprecision(2)
+                   << std::setw(12) << chain.second[level].error
+                   << std::defaultfloat << std::endl;
+      }
+   }
+
+   return passed;
+}
+
+// bytes of a shape stored as floats and 32 bit indices
+size_t ShapeSize( const GeomHelper::Shape & shape )
+{
+   return shape.indices.size() * sizeof(GLuint) +
+          shape.vertices.size() * sizeof(Vec3f) +
+          shape.tex_coords.size() * sizeof(Vec2f) +
+          shape.normals.size() * sizeof(Vec3f) +
+          shape.tangents.size() * sizeof(Vec3f) +
+          shape.bitangents.size() * sizeof(Vec3f);
+}
+
+// largest angle in radians between the matching unit vectors
+double MaxAngle( const std::vector< Vec3f > & a, const std::vector< Vec3f > & b )
+{
+   double angle = a.size() == b.size() ? 0.0 : std::numeric_limits< double >::max();
+
+   for (size_t i = 0; i < a.size() && i < b.size(); ++i)
+   {
+      const double cosine = std::min(std::max(static_cast< double >(a[i] * b[i].UnitVector()), -1.0), 1.0);
+
+      angle = std::max(angle, std::acos(cosine));
+   }
+
+   return angle;
+}
+
+struct CodecStats
+{
+   double   raw_bpv;
+   double   quantized_bpv;
+   double   compressed_bpv;
+   double   dequantize_gbs;
+   double   decompress_gbs;
+};
+
+// quantizes and compresses a sphere and a grid, checks the round trips, and
+// times decoding them back to floats.  the times reported are per vertex, the
+// sizes and the rates of each decoder in gigabytes of output per second are
+// printed after the suite.
+bool RunMeshCodec( )
+{
+   GeomHelper::Shape sphere = GeomHelper::ConstructSphere(256, 256);
+   GeomHelper::Shape grid = ConstructGrid(1000000);
+
+   for (GeomHelper::Shape * const pShape : { &sphere, &grid })
+   {
+      MeshOptimizer::Optimize(*pShape);
+
+      std::tie(pShape->tangents, pShape->bitangents) =
+         GeomHelper::ConstructTangentsAndBitangents(pShape->vertices, pShape->normals,
+                                                    pShape->tex_coords, pShape->indices);
+   }
+
+   const std::pair< const char *, const GeomHelper::Shape * > shapes[] =
+   {
+      { "sphere", &sphere },
+      { "grid", &grid }
+   };
+
+   std::vector< std::pair< const char *, CodecStats > > stats;
+
+   bool passed = true;
+
+   for (const auto & shape : shapes)
+   {
+      const GeomHelper::Shape & source = *shape.second;
+
+      const MeshCodec::QuantizedShape quantized = MeshCodec::Quantize(source);
+      const std::vector< uint8_t > compressed = MeshCodec::Compress(quantized);
+
+      // the compression is lossless
+      MeshCodec::QuantizedShape decompressed;
+
+      bool compared =
+         MeshCodec::Decompress(compressed.data(), compressed.size(), decompressed) &&
+         decompressed.geom_type == quantized.geom_type &&
+         decompressed.index_type == quantized.index_type &&
+         decompressed.indices16 == quantized.indices16 &&
+         decompressed.indices32 == quantized.indices32 &&
+         decompressed.position_offset == quantized.position_offset &&
+         decompressed.position_scale == quantized.position_scale &&
+         decompressed.vertices == quantized.vertices &&
+         decompressed.tex_coords == quantized.tex_coords &&
+         decompressed.normals == quantized.normals &&
+         decompressed.tangents == quantized.tangents &&
+         decompressed.bitangents == quantized.bitangents;
+
+      // a truncated stream is rejected
+      compared &= !MeshCodec::Decompress(compressed.data(), compressed.size() - 1, decompressed);
+
+      // as are huge counts of indices and of their coded bytes, which follow
+      // the 44 bytes of the header, without allocating for them
+      for (const size_t offset : { size_t(44), size_t(48) })
+      {
+         std::vector< uint8_t > corrupt = compressed;
+
+         const uint32_t count = 0xfffffff0u;
+         std::memcpy(&corrupt[offset], &count, sizeof(count));
+
+         compared &= !MeshCodec::Decompress(corrupt.data(), corrupt.size(), decompressed);
+      }
+
+      // the quantization stays within half a step of the bounding box
+      // for positions, a half ulp for texture coordinates, and 1e-3
+      // radians for the unit vectors
+      const GeomHelper::Shape dequantized = MeshCodec::Dequantize(quantized);
+
+      compared &= dequantized.indices == source.indices &&
+                  dequantized.vertices.size() == source.vertices.size() &&
+                  dequantized.tex_coords.size() == source.tex_coords.size();
+
+      double position_error = 0.0;
+
+      for (size_t i = 0; compared && i < source.vertices.size(); ++i)
+      {
+         for (size_t axis = 0; axis < 3; ++axis)
+         {
+            const double step = quantized.position_scale[axis];
+            const double error = std::abs(dequantized.vertices[i][axis] - source.vertices[i][axis]);
+
+            compared &= error <= step * 0.5 + 1.0e-6;
+
+            // relative to the half extent of the bounding box
+            if (step > 0.0) position_error = std::max(position_error, error / (step * 32767.0));
+         }
+      }
+
+      for (size_t i = 0; compared && i < source.tex_coords.size(); ++i)
+      {
+         for (size_t axis = 0; axis < 2; ++axis)
+         {
+            const double expected = source.tex_coords[i][axis];
+
+            compared &= std::abs(dequantized.tex_coords[i][axis] - expected) <= std::abs(expected) * (1.0 / 2048.0) + 1.0e-7;
+         }
+      }
+
+      compared &= MaxAngle(dequantized.normals, source.normals) < 1.0e-3 &&
+                  MaxAngle(dequantized.tangents, source.tangents) < 1.0e-3 &&
+                  MaxAngle(dequantized.bitangents, source.bitangents) < 1.0e-3;
+
+      const size_t num_vertices = source.vertices.size();
+
+      const double decompress_ns = bench::MeasureNS(1, [ & ] ( size_t )
+      {
+         MeshCodec::QuantizedShape restored;
+
+         bench::DoNotOptimize(MeshCodec::Decompress(compressed.data(), compressed.size(), restored));
+      }, 5);
+
+      const double dequantize_ns = bench::MeasureNS(1, [ & ] ( size_t )
+      {
+         bench::DoNotOptimize(MeshCodec::Dequantize(quantized));
+      }, 5);
+
+      gReport.Add(shape.first, "float", num_vertices,
+                  (decompress_ns + dequantize_ns) / num_vertices,
+                  position_error, compared);
+
+      const CodecStats codec_stats =
+      {
+         static_cast< double >(ShapeSize(source)) / num_vertices,
+         static_cast< double >(MeshCodec::QuantizedSize(quantized)) / num_vertices,
+         static_cast< double >(compressed.size()) / num_vertices,
+         ShapeSize(source) / dequantize_ns,
+         MeshCodec::QuantizedSize(quantized) / decompress_ns
+      };
+
+      stats.emplace_back(shape.first, codec_stats);
+
+      passed &= compared;
+   }
+
+   std::cout << std::endl
+             << "mesh codec (bytes per vertex, decoded GB/s)" << std::endl
+             << std::left << std::setw(14) << "shape"
+             << std::right << std::setw(10) << "float" << std::setw(12) << "quantized"
+             << std::setw(12) << "compressed" << std::setw(12) << "decompress"
+             << std::setw(12) << "dequantize" << std::endl;
+
+   for (const auto & shape_stats : stats)
+   {
+      const CodecStats & s = shape_stats.second;
+
+      std::cout << std::left << std::setw(14) << shape_stats.first
+                << std::right << std::fixed << std::setprecision(2)
+                << std::setw(10) << s.raw_bpv << std::setw(12) << s.quantized_bpv
+                << std::setw(12) << s.compressed_bpv << std::setw(12) << s.decompress_gbs
+                << std::setw(12) << s.dequantize_gbs
+                << std::defaultfloat << std::endl;
+   }
+
+   return passed;
+}
+
+// writes the shape as a wavefront obj, a text format that has to be parsed
+// the same way a model import does
+bool WriteObj( const std::string & filename, const GeomHelper::Shape & shape )
+{
+   std::ofstream stream(filename);
+
+   for (const Vec3f & v : shape.vertices) stream << "v " << v.X() << ' ' << v.Y() << ' ' << v.Z() << '\n';
+   for (const Vec2f & t : shape.tex_coords) stream << "vt " << t.X() << ' ' << t.Y() << '\n';
+   for (const Vec3f & n : shape.normals) stream << "vn " << n.X() << ' ' << n.Y() << ' ' << n.Z() << '\n';
+
+   for (size_t i = 0; i < shape.indices.size(); i += 3)
+   {
+      stream << 'f';
+
+      for (size_t corner = 0; corner < 3; ++corner)
+      {
+         const GLuint index = shape.indices[i + corner] + 1;
+
+         stream << ' ' << index << '/' << index << '/' << index;
+      }
+
+      stream << '\n';
+   }
+
+   return stream.good();
+}
+
+// reads back the obj from WriteObj, which shares one index across attributes
+bool ReadObj( const std::string & filename, GeomHelper::Shape & shape )
+{
+   std::ifstream stream(filename, std::ios::binary);
+   const std::string text((std::istreambuf_iterator< char >(stream)), std::istreambuf_iterator< char >());
+
+   shape = GeomHelper::Shape();
+   shape.geom_type = GL_TRIANGLES;
+
+   const char * pCur = text.c_str();
+
+   while (*pCur)
+   {
+      char * pEnd = nullptr;
+
+      if (pCur[0] == 'v' && pCur[1] == ' ')
+      {
+         const float x = std::strtof(pCur + 2, &pEnd);
+         const float y = std::strtof(pEnd, &pEnd);
+         shape.vertices.push_back(Vec3f(x, y, std::strtof(pEnd, &pEnd)));
+      }
+      else if (pCur[0] == 'v' && pCur[1] == 't')
+      {
+         const float s = std::strtof(pCur + 3, &pEnd);
+         shape.tex_coords.push_back(Vec2f(s, std::strtof(pEnd, &pEnd)));
+      }
+      else if (pCur[0] == 'v' && pCur[1] == 'n')
+      {
+         const float x = std::strtof(pCur + 3, &pEnd);
+         const float y = std::strtof(pEnd, &pEnd);
+         shape.normals.push_back(Vec3f(x, y, std::strtof(pEnd, &pEnd)));
+      }
+      else if (pCur[0] == 'f')
+      {
+         pEnd = const_cast< char * >(pCur + 1);
+
+         for (size_t corner = 0; corner < 3; ++corner)
+         {
+            shape.indices.push_back(static_cast< GLuint >(std::strtoul(pEnd, &pEnd, 10) - 1));
+
+            // the texture coordinate and normal indices are the same
+            while (*pEnd == '/' || std::isdigit(static_cast< unsigned char >(*pEnd))) ++pEnd;
+         }
+      }
+
+      pCur = std::strchr(pCur, '\n');
+
+      if (!pCur) break;
+
+      ++pCur;
+   }
+
+   return !shape.vertices.empty() && shape.vertices.size() == shape.normals.size();
+}
+
+// the mesh written to a cache, positions as floats and the rest quantized
+MeshCache::MeshSource CacheSource( const GeomHelper::Shape & shape )
+{
+   MeshCache::MeshSource source;
+
+   source.num_vertices = shape.vertices.size();
+   source.attributes =
+   {
+      { 0, 3, MeshCache::Format::FLOAT, &shape.vertices.front().X() },
+      { 2, 3, MeshCache::Format::SNORM16, &shape.normals.front().X() },
+      { 3, 2, MeshCache::Format::HALF, &shape.tex_coords.front().X() }
+   };
+   source.indices = shape.indices;
+   source.draw_ranges = { { 0, 0, static_cast< uint32_t >(shape.indices.size()) } };
+   source.materials = { "grid.png" };
+
+   return source;
+}
+
+// compares starting up from an obj, which parses the source, builds the
+// tangent frames and writes the cache, against starting up from the cache,
+// which stamps the source and maps the cache.  the cached load touches every
+// page so that the time includes reading the cache into memory.  the times
+// reported are per vertex.
+bool RunMeshCache( )
+{
+   const std::filesystem::path directory = std::filesystem::temp_directory_path();
+   const std::string source_filename = (directory / "wingl_mesh_bench.obj").string();
+   const std::string cache_filename = MeshCache::CacheFilename(source_filename.c_str());
+
+   GeomHelper::Shape grid = ConstructGrid(200000);
+   MeshOptimizer::Optimize(grid);
+
+   if (!WriteObj(source_filename, grid)) return false;
+
+   GeomHelper::Shape imported;
+
+   const auto Import = [ & ] ( )
+   {
+      MeshCache::SourceStamp stamp = { };
+
+      bool written = MeshCache::StampSource(source_filename.c_str(), stamp) &&
+                     ReadObj(source_filename, imported);
+
+      if (written)
+      {
+         std::tie(imported.tangents, imported.bitangents) =
+            GeomHelper::ConstructTangentsAndBitangents(imported.vertices, imported.normals,
+                                                       imported.tex_coords, imported.indices);
+
+         written = MeshCache::Write(cache_filename.c_str(), MeshCache::Serialize(stamp, CacheSource(imported)));
+      }
+
+      return written;
+   };
+
+   MeshCache::Mesh cached;
+
+   const auto Load = [ & ] ( )
+   {
+      MeshCache::SourceStamp stamp = { };
+
+      uint64_t sum = 0;
+
+      if (MeshCache::StampSource(source_filename.c_str(), stamp) && cached.Open(cache_filename.c_str(), stamp))
+      {
+         const uint8_t * const pVertices = static_cast< const uint8_t * >(cached.Vertices());
+
+         for (size_t offset = 0; offset < cached.NumVertices() * cached.VertexStride(); offset += 4096)
+         {
+            sum += pVertices[offset];
+         }
+      }
+
+      return sum;
+   };
+
+   bool compared = Import() && Load() && cached.IsOpen();
+
+   // the cache holds the imported mesh
+   compared &= cached.NumVertices() == grid.vertices.size() &&
+               cached.NumIndices() == grid.indices.size() &&
+               cached.IndexType() == GL_UNSIGNED_INT &&
+               cached.NumAttributes() == 3 &&
+               cached.NumDrawRanges() == 1 &&
+               cached.Materials().size() == 1 &&
+               std::string(cached.Materials().front()) == "grid.png" &&
+               std::equal(grid.indices.cbegin(), grid.indices.cend(), static_cast< const GLuint * >(cached.Indices()));
+
+   for (size_t i = 0; compared && i < cached.NumVertices(); ++i)
+   {
+      Vec3f position;
+      std::memcpy(&position.X(), static_cast< const uint8_t * >(cached.Vertices()) + i * cached.VertexStride(), sizeof(float) * 3);
+
+      compared &= position == imported.vertices[i] && (position - grid.vertices[i]).Length() < 1.0e-4f;
+   }
+
+   const size_t num_vertices = grid.vertices.size();
+
+   const double import_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(Import()); }, 3);
+   const double cached_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(Load()); }, 5);
+
+   // editing the source invalidates the cache
+   cached.Close();
+
+   std::ofstream(source_filename, std::ios::app) << "# edited\n";
+
+   MeshCache::SourceStamp stamp = { };
+
+   compared &= MeshCache::StampSource(source_filename.c_str(), stamp) &&
+               !cached.Open(cache_filename.c_str(), stamp);
+
+   // damaged caches are refused...  the table of chunks follows the 48 bytes
+   // of the header, each chunk an id, a count, an offset and a size
+   const std::vector< uint8_t > contents = MeshCache::Serialize(stamp, CacheSource(imported));
+
+   const auto ChunkOffset = [ & ] ( const uint32_t id )
+   {
+      for (size_t chunk = 48; chunk + 24 <= contents.size(); chunk += 24)
+      {
+         uint32_t chunk_id = 0;
+         uint64_t offset = 0;
+
+         std::memcpy(&chunk_id, &contents[chunk], sizeof(chunk_id));
+         std::memcpy(&offset, &contents[chunk + 8], sizeof(offset));
+
+         if (chunk_id == id) return static_cast< size_t >(offset);
+      }
+
+      return contents.size();
+   };
+
+   const auto OpenDamaged = [ & ] ( const size_t offset, const uint32_t value )
+   {
+      std::vector< uint8_t > damaged = contents;
+      std::memcpy(&damaged[offset], &value, sizeof(value));
+
+      MeshCache::Mesh mesh;
+
+      return mesh.Open(std::move(damaged), stamp);
+   };
+
+   const size_t attributes = ChunkOffset(1);
+   const size_t indices = ChunkOffset(3);
+
+   MeshCache::Mesh intact;
+
+   compared &= intact.Open(std::vector< uint8_t >(contents), stamp) &&
+               !OpenDamaged(indices, static_cast< uint32_t >(imported.vertices.size())) &&
+               !OpenDamaged(attributes + sizeof(MeshCache::Attribute) + 4, 5) &&
+               !OpenDamaged(attributes + sizeof(MeshCache::Attribute) + 8, GL_DOUBLE) &&
+               !OpenDamaged(attributes + 16, intact.VertexStride() - 4);
+
+   gReport.Add("grid", "float", num_vertices, import_ns / num_vertices, cached_ns / num_vertices, 0.0, compared);
+
+   std::cout << std::endl
+             << "startup (ms per load)" << std::endl
+             << std::left << std::setw(14) << "shape"
+             << std::right << std::setw(12) << "import" << std::setw(12) << "cached"
+             << std::setw(12) << "obj MB" << std::setw(12) << "cache MB" << std::endl
+             << std::left << std::setw(14) << "grid"
+             << std::right << std::fixed << std::setprecision(2)
+             << std::setw(12) << import_ns * 1.0e-6 << std::setw(12) << cached_ns * 1.0e-6
+             << std::setw(12) << std::filesystem::file_size(source_filename) / 1048576.0
+             << std::setw(12) << std::filesystem::file_size(cache_filename) / 1048576.0
+             << std::defaultfloat << std::endl;
+
+   std::remove(source_filename.c_str());
+   std::remove(cache_filename.c_str());
+
+   return compared;
+}
+
+} // namespace
+
+int main( const int argc, const char * const argv[] )
+{
+   if (!gReport.ParseArgs(argc, argv)) return 2;
+
+   gReport.SetProperty("hardware_threads", std::to_string(std::thread::hardware_concurrency()));
+
+   bool passed = true;
+
+   gReport.BeginSuite("mesh builders (ns per triangle)", "chain", "fused");
+
+   passed &= RunMeshBuilders();
+
+   gReport.BeginSuite("mesh builder scaling (ns per triangle)", "serial", "parallel");
+
+   passed &= RunMeshScaling();
+
+   gReport.BeginSuite("normal repair (ns per vertex)", "scan", "lookup");
+
+   passed &= RunNormalRepair();
+
+   gReport.BeginSuite("mesh optimizer (ns per triangle)", "optimize");
+
+   passed &= RunMeshOptimizer();
+
+   gReport.BeginSuite("lod chain (ns per source triangle)", "build");
+
+   passed &= RunLodChains();
+
+   gReport.BeginSuite("mesh codec (ns per vertex)", "decode");
+
+   passed &= RunMeshCodec();
+
+   gReport.BeginSuite("startup (ns per vertex)", "import", "cached");
+
+   passed &= RunMeshCache();
+
+   passed &= gReport.Write();
+
+   return passed ? 0 : 1;
+}
@@ -0,0 +1,484 @@
+// local includes
+#include "BenchHarness.h"
+
+// wgl includes
+#include "JobPool.h"
+#include "StreamRing.h"
+#include "ParticlePool.h"
+
+// std includes
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+// collects the results of all the suites
+bench::Report gReport("wingl_particle_bench");
+
+// particles in each integration, from a pool that stays in the caches
+// to ones that have to stream from memory
+const size_t INTEGRATE_SIZES[] = { 10000, 100000, 1000000, 4000000 };
+
+// particles alive in each system once it reaches a steady state
+const size_t UPDATE_SIZES[] = { 10000, 100000, 1000000 };
+
+// systems updated together, and the threads they are updated across
+const size_t NUM_SYSTEMS[] = { 10, 100, 1000, 10000 };
+const size_t NUM_THREADS[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+// jobs each thread is given, so the threads can steal from each other
+const size_t JOBS_PER_THREAD = 8;
+
+// particles streamed to the gpu each frame
+const size_t STREAM_SIZES[] = { 10000, 100000, 1000000 };
+
+// steps of a 60 hz simulation
+const float TIME_STEP = 1.0f / 60.0f;
+
+// forces acting on all the particles
+const float FORCE[3] = { 0.5f, -9.8f, 0.0f };
+const float DRAG = 0.1f;
+
+// the particle layout the pool replaces, a structure per particle
+struct Particle
+{
+   float    position[3];
+   float    velocity[3];
+   uint32_t texture_unit;
+   float    lifespan;
+};
+
+// integrates the structures one particle at a time, the same way as the pool
+void Integrate( std::vector< Particle > & particles, const float seconds )
+{
+   const float damping = 1.0f - DRAG * seconds;
+
+   for (Particle & particle : particles)
+   {
+      for (uint32_t axis = 0; axis < 3; ++axis)
+      {
+         particle.velocity[axis] = particle.velocity[axis] * damping + FORCE[axis] * seconds;
+         particle.position[axis] = particle.position[axis] + particle.velocity[axis] * seconds;
+      }
+
+      particle.lifespan = particle.lifespan - seconds;
+   }
+}
+
+// an emitter that keeps about size particles alive
+ParticleEmitter ConstructEmitter( const size_t size )
+{
+   const ParticleEmitter emitter =
+   {
+      { 1.0f, 2.0f, 3.0f },
+      { 0.0f, 10.0f, 0.0f },
+      4.0f,
+      2.0f,
+      0.5f,
+      static_cast< float >(size) / 2.0f
+   };
+
+   return emitter;
+}
+
+// indicates if two pools hold exactly the same particles
+bool Identical( const ParticlePool & a, const ParticlePool & b )
+{
+   bool identical = a.Size() == b.Size();
+
+   for (uint32_t axis = 0; identical && axis < 3; ++axis)
+   {
+      identical =
+         std::equal(a.Positions(axis), a.Positions(axis) + a.Size(), b.Positions(axis)) &&
+         std::equal(a.Velocities(axis), a.Velocities(axis) + a.Size(), b.Velocities(axis));
+   }
+
+   return identical && std::equal(a.Lifespans(), a.Lifespans() + a.Size(), b.Lifespans());
+}
+
+// integrates the pool against the structure per particle layout it replaces.
+// both start from the same particles, and after a number of steps the pool
+// must match the structures.  the times reported are per particle.
+bool RunIntegration( )
+{
+   bool passed = true;
+
+   for (const size_t size : INTEGRATE_SIZES)
+   {
+      // fills the pool in a single emission, which lives longer than the steps
+      ParticleEmitter emitter = ConstructEmitter(size);
+      emitter.rate = static_cast< float >(size);
+      emitter.lifespan = 1000.0f;
+
+      ParticlePool pool(size);
+      pool.Emit(emitter, 1.0f);
+
+      std::vector< Particle > particles(pool.Size());
+
+      for (size_t i = 0; i < particles.size(); ++i)
+      {
+         for (uint32_t axis = 0; axis < 3; ++axis)
+         {
+            particles[i].position[axis] = pool.Positions(axis)[i];
+            particles[i].velocity[axis] = pool.Velocities(axis)[i];
+         }
+
+         particles[i].texture_unit = 0;
+         particles[i].lifespan = pool.Lifespans()[i];
+      }
+
+      for (uint32_t step = 0; step < 8; ++step)
+      {
+         pool.Integrate(TIME_STEP, FORCE, DRAG);
+         Integrate(particles, TIME_STEP);
+      }
+
+      // the structures may fuse the multiply and add, so allow for rounding
+      double error = 0.0;
+
+      for (size_t i = 0; i < particles.size(); ++i)
+      {
+         for (uint32_t axis = 0; axis < 3; ++axis)
+         {
+            const double expected = particles[i].position[axis];
+
+            error = std::max(error, std::abs(expected - pool.Positions(axis)[i]) / std::max(std::abs(expected), 1.0));
+         }
+      }
+
+      const bool matched = pool.Size() == size && error <= 1e-5;
+
+      const double aos_ns = bench::MeasureNS(1, [ & ] ( size_t ) { Integrate(particles, TIME_STEP); bench::DoNotOptimize(particles); }, 5);
+      const double soa_ns = bench::MeasureNS(1, [ & ] ( size_t ) { pool.Integrate(TIME_STEP, FORCE, DRAG); bench::DoNotOptimize(pool); }, 5);
+
+      gReport.Add("integrate", "f32", size, aos_ns / size, soa_ns / size, error, matched);
+
+      passed &= matched;
+   }
+
+   return passed;
+}
+
+// runs whole updates of systems that integrate, retire and emit, serially
+// and across the threads.  the systems are run until they reach a steady
+// state, where the serial and parallel pools must hold exactly the same
+// particles, all of them still alive.  the times reported are per particle.
+bool RunUpdates( )
+{
+   bool passed = true;
+
+   for (const size_t size : UPDATE_SIZES)
+   {
+      const ParticleEmitter emitter = ConstructEmitter(size);
+
+      // the emitter keeps at most rate * (lifespan + spread) particles alive
+      const size_t capacity = static_cast< size_t >(emitter.rate * (emitter.lifespan + emitter.lifespan_spread)) + 1;
+
+      ParticlePool serial(capacity, 7);
+      ParticlePool parallel(capacity, 7);
+
+      // runs past the longest lifespan, so particles are being retired
+      const uint32_t num_steps = static_cast< uint32_t >((emitter.lifespan + emitter.lifespan_spread) / TIME_STEP) + 30;
+
+      for (uint32_t step = 0; step < num_steps; ++step)
+      {
+         serial.Update(emitter, TIME_STEP, FORCE, DRAG, false);
+         parallel.Update(emitter, TIME_STEP, FORCE, DRAG, true);
+      }
+
+      const bool alive = std::all_of(serial.Lifespans(), serial.Lifespans() + serial.Size(), [ ] ( const float lifespan ) { return lifespan > 0.0f; });
+
+      // a steady state holds about rate * lifespan particles
+      const double expected = emitter.rate * emitter.lifespan;
+      const double error = std::abs(static_cast< double >(serial.Size()) - expected) / expected;
+
+      const bool matched = Identical(serial, parallel) && alive && error <= 0.05;
+
+      const double serial_ns = bench::MeasureNS(1, [ & ] ( size_t ) { serial.Update(emitter, TIME_STEP, FORCE, DRAG, false); bench::DoNotOptimize(serial); }, 5);
+      const double parallel_ns = bench::MeasureNS(1, [ & ] ( size_t ) { parallel.Update(emitter, TIME_STEP, FORCE, DRAG, true); bench::DoNotOptimize(parallel); }, 5);
+
+      gReport.Add("update", "f32", serial.Size(), serial_ns / serial.Size(), parallel_ns / parallel.Size(), error, matched);
+
+      passed &= matched;
+   }
+
+   return passed;
+}
+
+// updates many small systems of uneven sizes, one after the other and as
+// jobs across pools of 1 to 64 threads, the way the particle system manager
+// does.  the systems updated by the jobs must match the ones updated in
+// turn exactly, and no jobs may be left counted as queued once each call
+// returns.  the times reported are per system.
+bool RunSystems( )
+{
+   bool passed = true;
+
+   for (const size_t num_systems : NUM_SYSTEMS)
+   {
+      std::vector< ParticleEmitter > emitters;
+      std::vector< ParticlePool > serial;
+      std::vector< ParticlePool > jobs;
+
+      // the systems keep between 100 and 400 particles alive
+      for (size_t i = 0; i < num_systems; ++i)
+      {
+         const ParticleEmitter emitter = ConstructEmitter(100 + i * 37 % 301);
+         const size_t capacity = static_cast< size_t >(emitter.rate * (emitter.lifespan + emitter.lifespan_spread)) + 1;
+         const uint32_t seed = static_cast< uint32_t >(i + 1);
+
+         emitters.push_back(emitter);
+         serial.emplace_back(capacity, seed);
+         jobs.emplace_back(capacity, seed);
+      }
+
+      const auto Update = [ & ] ( std::vector< ParticlePool > & systems, const size_t begin, const size_t end )
+      {
+         for (size_t i = begin; i < end; ++i)
+         {
+            systems[i].Update(emitters[i], TIME_STEP, FORCE, DRAG);
+         }
+      };
+
+      // brings the systems close to a steady state
+      for (uint32_t step = 0; step < 60; ++step)
+      {
+         Update(serial, 0, num_systems);
+         Update(jobs, 0, num_systems);
+      }
+
+      for (const size_t num_threads : NUM_THREADS)
+      {
+         JobPool pool(num_threads);
+
+         const size_t grain_size = std::max< size_t >(num_systems / (num_threads * JOBS_PER_THREAD), 1);
+
+         bool drained = true;
+
+         const auto UpdateJobs = [ & ] ( )
+         {
+            pool.ParallelFor(num_systems, grain_size,
+               [ & ] ( const size_t begin, const size_t end ) { Update(jobs, begin, end); });
+
+            drained &= pool.NumQueued() == 0;
+         };
+
+         // both sets of systems take the same steps, so they stay in lock step
+         Update(serial, 0, num_systems);
+         UpdateJobs();
+
+         bool matched = true;
+
+         for (size_t i = 0; i < num_systems; ++i)
+         {
+            matched &= Identical(serial[i], jobs[i]);
+         }
+
+         const double serial_ns = bench::MeasureNS(1, [ & ] ( size_t ) { Update(serial, 0, num_systems); bench::DoNotOptimize(serial); }, 3);
+         const double jobs_ns = bench::MeasureNS(1, [ & ] ( size_t ) { UpdateJobs(); bench::DoNotOptimize(jobs); }, 3);
+
+         const std::string kernel = std::to_string(num_threads) + " threads";
+
+         matched &= drained;
+
+         // a job that throws hands the exception to the caller and leaves the pool drained
+         bool rethrown = false;
+
+         try
+         {
+            pool.ParallelFor(num_systems, grain_size, [ ] ( const size_t begin, const size_t )
+            {
+               if (begin == 0) throw std::runtime_error("job failed");
+            });
+         }
+         catch ( const std::runtime_error & )
+         {
+            rethrown = true;
+         }
+
+         matched &= rethrown && pool.NumQueued() == 0;
+
+         gReport.Add(kernel.c_str(), "f32", num_systems, serial_ns / num_systems, jobs_ns / num_systems, 0.0, matched);
+
+         passed &= matched;
+      }
+   }
+
+   return passed;
+}
+
+// fences of a pretend gpu that finishes each frame a number of frames after
+// it was submitted, counting the waits that would have stalled the cpu
+struct FrameFences
+{
+   typedef uint64_t Fence;
+
+   struct State
+   {
+      uint64_t submitted;
+      uint64_t completed;
+      uint64_t latency;
+      size_t   stalls;
+      size_t   live;
+   };
+
+   Fence Insert( )
+   {
+      ++pState->live;
+
+      // the gpu finishes the frames submitted long enough ago
+      const Fence fence = ++pState->submitted;
+
+      if (fence > pState->latency) pState->completed = std::max(pState->completed, fence - pState->latency);
+
+      return fence;
+   }
+
+   void Wait( const Fence fence )
+   {
+      if (fence > pState->completed)
+      {
+         ++pState->stalls;
+         pState->completed = fence;
+      }
+   }
+
+   void Delete( const Fence )
+   {
+      --pState->live;
+   }
+
+   State * pState;
+};
+
+// streams the positions of the particles into a ring of regions, writing
+// them straight into the region of the frame, against copying them into a
+// staging buffer that is then copied into the buffer, the way glBufferSubData
+// copies client memory.  the ring must hand out aligned offsets within the
+// region of the frame, refuse allocations that do not fit, only wait on a
+// region while the gpu is still reading it, and release all its fences.
+// the times reported are per particle.
+bool RunStreaming( )
+{
+   bool passed = true;
+
+   for (const size_t size : STREAM_SIZES)
+   {
+      ParticlePool pool(size);
+
+      ParticleEmitter emitter = ConstructEmitter(size);
+      emitter.rate = static_cast< float >(size);
+      pool.Emit(emitter, 1.0f);
+
+      const size_t bytes = pool.Size() * 3 * sizeof(float);
+
+      // the gpu reads a frame two frames behind, so three regions never stall,
+      // while a gpu three frames behind stalls on every region once it is full
+      bool valid = true;
+      size_t stalls[2] = { };
+
+      for (const uint64_t latency : { 2, 3 })
+      {
+         FrameFences::State state = { 0, 0, latency, 0, 0 };
+
+         {
+            const FrameFences fences = { &state };
+
+            StreamRing< FrameFences > ring(bytes + 100, fences);
+
+            for (uint32_t frame = 0; frame < 12; ++frame)
+            {
+               ring.BeginRegion();
+
+               const size_t first = ring.Allocate(100, 4);
+               const size_t second = ring.Allocate(bytes, 16);
+
+               valid &=
+                  first == ring.Region() * ring.RegionSize() &&
+                  second != ring.NO_SPACE && second % 16 == 0 &&
+                  second + bytes <= (ring.Region() + 1) * ring.RegionSize() &&
+                  ring.Allocate(ring.RegionSize(), 4) == ring.NO_SPACE;
+
+               ring.EndRegion();
+            }
+         }
+
+         valid &= state.live == 0;
+
+         stalls[latency - 2] = state.stalls;
+      }
+
+      valid &= stalls[0] == 0 && stalls[1] == 12 - 3;
+
+      // a region of the ring standing in for the mapped buffer
+      std::vector< float > region(pool.Size() * 3);
+      std::vector< float > staging(pool.Size() * 3);
+
+      pool.CopyPositions(region.data());
+
+      for (size_t i = 0; i < pool.Size(); ++i)
+      {
+         for (uint32_t axis = 0; axis < 3; ++axis)
+         {
+            valid &= region[i * 3 + axis] == pool.Positions(axis)[i];
+         }
+      }
+
+      const double copy_ns = bench::MeasureNS(1, [ & ] ( size_t )
+      {
+         pool.CopyPositions(staging.data());
+         std::memcpy(region.data(), staging.data(), bytes);
+         bench::DoNotOptimize(region);
+      }, 5);
+
+      const double ring_ns = bench::MeasureNS(1, [ & ] ( size_t )
+      {
+         pool.CopyPositions(region.data());
+         bench::DoNotOptimize(region);
+      }, 5);
+
+      gReport.Add("stream", "f32x3", pool.Size(), copy_ns / pool.Size(), ring_ns / pool.Size(), 0.0, valid);
+
+      passed &= valid;
+   }
+
+   return passed;
+}
+
+} // namespace
+
+int main( const int argc, const char * const argv[] )
+{
+   if (!gReport.ParseArgs(argc, argv)) return 2;
+
+   gReport.SetProperty("hardware_threads", std::to_string(std::thread::hardware_concurrency()));
+
+   bool passed = true;
+
+   gReport.BeginSuite("particle integration (ns per particle)", "aos", "soa");
+
+   passed &= RunIntegration();
+
+   gReport.BeginSuite("particle updates (ns per particle)", "serial", "parallel");
+
+   passed &= RunUpdates();
+
+   gReport.BeginSuite("particle systems (ns per system)", "serial", "jobs");
+
+   passed &= RunSystems();
+
+   gReport.BeginSuite("particle streaming (ns per particle)", "copy", "ring");
+
+   passed &= RunStreaming();
+
+   passed &= gReport.Write();
+
+   return passed ? 0 : 1;
+}
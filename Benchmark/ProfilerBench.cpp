@@ -0,0 +1,256 @@
+// local includes
+#include "BenchHarness.h"
+
+// wgl includes
+#include "Profiler.h"
+
+// std includes
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+namespace
+{
+
+// collects the results of all the suites
+bench::Report gReport("wingl_profiler_bench");
+
+// zones recorded between the frames of the overhead suite, well within
+// what a thread buffer holds so none of them are dropped
+const size_t ZONES_PER_FRAME = 4096;
+
+// frames recorded by the bookkeeping checks
+const size_t NUM_FRAMES = 16;
+
+// threads recording into the same zone at once
+const size_t NUM_THREADS = 4;
+
+// finds the statistics of a zone, an empty name if it was never recorded
+ProfileZoneStats FindZone( const char * const pName )
+{
+   const std::vector< ProfileZoneStats > zones = Profiler::GetZoneStats();
+
+   const auto zone = std::find_if(zones.cbegin(), zones.cend(),
+      [ pName ] ( const ProfileZoneStats & stats ) { return stats.name == pName; });
+
+   return zone != zones.cend() ? *zone : ProfileZoneStats { };
+}
+
+// nanoseconds since the start of a check
+double ElapsedNS( const std::chrono::steady_clock::time_point start )
+{
+   return std::chrono::duration< double, std::nano >(std::chrono::steady_clock::now() - start).count();
+}
+
+// relative difference between the expected and measured milliseconds
+double RelativeError( const double expected_ms, const double actual_ms )
+{
+   return std::abs(actual_ms - expected_ms) / std::max(expected_ms, 1.0e-12);
+}
+
+// times an empty zone with the profiler disabled and enabled
+bool RunOverhead( )
+{
+   Profiler::Reset();
+
+   const auto Zone = [ ] ( const size_t i )
+   {
+      {
+         WGL_PROFILE_ZONE("overhead");
+         bench::DoNotOptimize(i);
+      }
+
+      // drain the buffer before it can fill, as a frame loop would
+      if (i % ZONES_PER_FRAME == ZONES_PER_FRAME - 1) WGL_PROFILE_FRAME();
+   };
+
+   Profiler::Enable(false);
+   const double disabled_ns = bench::MeasureNS(ZONES_PER_FRAME * 16, Zone);
+
+   Profiler::Enable(true);
+   const double enabled_ns = bench::MeasureNS(ZONES_PER_FRAME * 16, Zone);
+   Profiler::Enable(false);
+
+   const bool passed = Profiler::GetDroppedEvents() == 0 && FindZone("overhead").frames != 0;
+
+   gReport.Add("empty zone", "-", ZONES_PER_FRAME, disabled_ns, enabled_ns, 0.0, passed);
+
+   return passed;
+}
+
+// records zones with known ticks and checks that the totals
+// of each frame are the sums of the zones within the frame
+bool RunSums( )
+{
+   Profiler::Reset();
+   Profiler::Enable(true);
+
+   const Profiler::Tick OUTER_TICKS = 50000;
+   const Profiler::Tick INNER_TICKS = 10000;
+
+   const auto start = std::chrono::steady_clock::now();
+
+   for (size_t frame = 0; frame < NUM_FRAMES; ++frame)
+   {
+      const Profiler::Tick begin = Profiler::Now();
+
+      // two inner zones inside the outer one, recorded inner first
+      // the way the destructors of nested scopes record them
+      Profiler::Record("sums inner", begin + 100, begin + 100 + INNER_TICKS);
+      Profiler::Record("sums inner", begin + 200 + INNER_TICKS, begin + 200 + 2 * INNER_TICKS);
+      Profiler::Record("sums outer", begin, begin + OUTER_TICKS);
+
+      Profiler::EndFrame();
+   }
+
+   const double ns = ElapsedNS(start) / (NUM_FRAMES * 3);
+
+   Profiler::Enable(false);
+
+   const ProfileZoneStats outer = FindZone("sums outer");
+   const ProfileZoneStats inner = FindZone("sums inner");
+
+   const double outer_ms = Profiler::TicksToMS(OUTER_TICKS);
+   const double inner_ms = Profiler::TicksToMS(2 * INNER_TICKS);
+
+   const double error = std::max({ RelativeError(outer_ms, outer.min_ms), RelativeError(outer_ms, outer.max_ms),
+                                   RelativeError(inner_ms, inner.min_ms), RelativeError(inner_ms, inner.max_ms) });
+
+   const bool passed =
+      outer.frames == NUM_FRAMES && outer.calls == 1.0 &&
+      inner.frames == NUM_FRAMES && inner.calls == 2.0 &&
+      error < 1.0e-9;
+
+   gReport.Add("known ticks", "-", NUM_FRAMES * 3, ns, error, passed);
+
+   return passed;
+}
+
+// nests real zones around a short loop and checks that every level
+// takes no longer than the level around it, down from the frame itself
+bool RunNesting( )
+{
+   Profiler::Reset();
+   Profiler::Enable(true);
+
+   const auto start = std::chrono::steady_clock::now();
+
+   // the first frame only opens the frame timing
+   WGL_PROFILE_FRAME();
+
+   for (size_t frame = 0; frame < NUM_FRAMES; ++frame)
+   {
+      {
+         WGL_PROFILE_ZONE("nesting outer");
+
+         for (size_t i = 0; i < 3; ++i)
+         {
+            WGL_PROFILE_ZONE("nesting inner");
+
+            uint64_t sum = 0;
+            for (uint64_t j = 0; j < 20000; ++j) bench::DoNotOptimize(sum += j);
+         }
+      }
+
+      WGL_PROFILE_FRAME();
+   }
+
+   const double ns = ElapsedNS(start) / (NUM_FRAMES * 4);
+
+   Profiler::Enable(false);
+
+   const ProfileZoneStats frame = Profiler::GetFrameStats();
+   const ProfileZoneStats outer = FindZone("nesting outer");
+   const ProfileZoneStats inner = FindZone("nesting inner");
+
+   const auto Within = [ ] ( const ProfileZoneStats & inside, const ProfileZoneStats & around )
+   {
+      return inside.min_ms <= around.min_ms && inside.avg_ms <= around.avg_ms && inside.max_ms <= around.max_ms;
+   };
+
+   const bool passed =
+      frame.frames == NUM_FRAMES &&
+      outer.frames == NUM_FRAMES && outer.calls == 1.0 &&
+      inner.frames == NUM_FRAMES && inner.calls == 3.0 &&
+      inner.min_ms > 0.0 && Within(inner, outer) && Within(outer, frame);
+
+   gReport.Add("nested zones", "-", NUM_FRAMES * 4, ns, 0.0, passed);
+
+   return passed;
+}
+
+// records the same zone from several threads and checks
+// that the frame collects the zones of every thread
+bool RunThreads( )
+{
+   Profiler::Reset();
+   Profiler::Enable(true);
+
+   const Profiler::Tick ZONE_TICKS = 1000;
+
+   const auto start = std::chrono::steady_clock::now();
+
+   std::vector< std::thread > threads;
+
+   for (size_t i = 0; i < NUM_THREADS; ++i)
+   {
+      threads.emplace_back([ ] ( )
+      {
+         for (size_t zone = 0; zone < ZONES_PER_FRAME; ++zone)
+         {
+            Profiler::Record("threads", 0, ZONE_TICKS);
+         }
+      });
+   }
+
+   for (auto & thread : threads) thread.join();
+
+   // the buffers of the exited threads are still drained
+   Profiler::EndFrame();
+
+   const double ns = ElapsedNS(start) / (NUM_THREADS * ZONES_PER_FRAME);
+
+   Profiler::Enable(false);
+
+   const ProfileZoneStats zone = FindZone("threads");
+
+   const double expected_ms = Profiler::TicksToMS(ZONE_TICKS * NUM_THREADS * ZONES_PER_FRAME);
+   const double error = RelativeError(expected_ms, zone.avg_ms);
+
+   const bool passed =
+      zone.frames == 1 && zone.calls == static_cast< double >(NUM_THREADS * ZONES_PER_FRAME) &&
+      Profiler::GetDroppedEvents() == 0 && error < 1.0e-9;
+
+   gReport.Add("threads", "-", NUM_THREADS * ZONES_PER_FRAME, ns, error, passed);
+
+   return passed;
+}
+
+} // namespace
+
+int main( const int argc, const char * const argv[] )
+{
+   if (!gReport.ParseArgs(argc, argv)) return 2;
+
+   gReport.SetProperty("hardware_threads", std::to_string(std::thread::hardware_concurrency()));
+
+   bool passed = true;
+
+   gReport.BeginSuite("zone overhead (ns per zone)", "disabled", "enabled");
+
+   passed &= RunOverhead();
+
+   gReport.BeginSuite("zone bookkeeping (ns per zone)", "recorded");
+
+   passed &= RunSums();
+   passed &= RunNesting();
+   passed &= RunThreads();
+
+   passed &= gReport.Write();
+
+   return passed ? 0 : 1;
+}
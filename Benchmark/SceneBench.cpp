@@ -0,0 +1,684 @@
+// local includes
+#include "BenchHarness.h"
+
+// wgl includes
+#include "Bvh.h"
+#include "Aabb.h"
+#include "Matrix.h"
+#include "Vector.h"
+#include "Frustum.h"
+#include "FrustumCull.h"
+#include "LooseOctree.h"
+
+// std includes
+#include <cmath>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+namespace
+{
+
+// collects the results of all the suites
+bench::Report gReport("wingl_scene_bench");
+
+// instances in each scene, up to what the instancing demo reaches
+const size_t CULL_SIZES[] = { 10000, 100000, 1000000, 4000000 };
+
+// the instances are spread over a square this far out from the origin
+const float SCENE_AREA = 500.0f;
+
+// instances closer to a plane than this may be culled differently by the
+// scalar and simd tests, as the order of the arithmetic can differ
+const float PLANE_TOLERANCE = 1.0e-3f;
+
+// views the scene is culled from
+const uint32_t NUM_VIEWS = 3;
+
+// objects in each spatial index
+const size_t SPATIAL_SIZES[] = { 10000, 100000, 1000000 };
+
+// queries of each kind run against the indices, and the objects found by
+// each nearest query
+const uint32_t NUM_QUERIES = 64;
+const size_t NUM_NEAREST = 8;
+
+// a random value in [0, 1) from a xorshift generator
+float Random( uint32_t & state )
+{
+   state ^= state << 13;
+   state ^= state >> 17;
+   state ^= state << 5;
+
+   return static_cast< float >(state >> 8) / 16777216.0f;
+}
+
+// a scene of buildings and trees spread over the ground, like the instancing demo
+struct Scene
+{
+   std::vector< Vec3f >    positions;
+
+   FrustumCull::Spheres    spheres;
+   FrustumCull::Boxes      boxes;
+
+   // the world matrices that are compacted into the instance buffer
+   std::vector< Matrixf >  worlds;
+};
+
+Scene ConstructScene( const size_t size )
+{
+   Scene scene;
+   uint32_t state = 0x2545f491u;
+
+   scene.positions.reserve(size);
+   scene.worlds.reserve(size);
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      const Vec3f position((Random(state) * 2.0f - 1.0f) * SCENE_AREA,
+                           0.0f,
+                           (Random(state) * 2.0f - 1.0f) * SCENE_AREA);
+
+      // the buildings are 2 x 5 x 2 boxes standing on the ground
+      scene.positions.push_back(position);
+      scene.boxes.Add(position + Vec3f(-1.0f, 0.0f, -1.0f), position + Vec3f(1.0f, 5.0f, 1.0f));
+      scene.spheres.Add(position + Vec3f(0.0f, 2.5f, 0.0f), std::sqrt(1.0f + 6.25f + 1.0f));
+      scene.worlds.push_back(Matrixf::Translate(position));
+   }
+
+   return scene;
+}
+
+// the views the scene is culled from, looking along the ground and down on it
+Frustumf ConstructFrustum( const uint32_t view )
+{
+   Matrixf camera;
+   Matrixf perspective;
+
+   perspective.MakePerspective(45.0f, 16.0f / 9.0f, 1.0f, 1000.0f);
+
+   switch (view)
+   {
+   case 0: camera.MakeLookAt(0.0f, 2.0f, 0.0f, 0.0f, 2.0f, -1.0f, 0.0f, 1.0f, 0.0f); break;
+   case 1: camera.MakeLookAt(-400.0f, 10.0f, 300.0f, 100.0f, 0.0f, -50.0f, 0.0f, 1.0f, 0.0f); break;
+   case 2: camera.MakeLookAt(0.0f, 600.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f); break;
+   }
+
+   return Frustumf(perspective * camera);
+}
+
+// counts the instances the two visible lists disagree on, apart from those
+// the margin puts within the tolerance of a plane.  the lists must also be
+// in increasing order.
+template < typename Margin >
+size_t CountMismatches( const size_t size,
+                        const std::vector< uint32_t > & expected, const size_t num_expected,
+                        const std::vector< uint32_t > & actual, const size_t num_actual,
+                        Margin && margin )
+{
+   std::vector< uint8_t > visible(size, 0);
+
+   for (size_t i = 0; i < num_expected; ++i) visible[expected[i]] ^= 1;
+   for (size_t i = 0; i < num_actual; ++i) visible[actual[i]] ^= 1;
+
+   size_t mismatches = !std::is_sorted(actual.begin(), actual.begin() + num_actual);
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      if (visible[i]) mismatches += margin(i) > PLANE_TOLERANCE;
+   }
+
+   return mismatches;
+}
+
+// culls the spheres and boxes one instance at a time with the frustum against
+// the batched simd tests.  both must find the same instances from every view,
+// apart from any that graze a plane.  the times reported are per instance.
+bool RunCulling( )
+{
+   bool passed = true;
+
+   for (const size_t size : CULL_SIZES)
+   {
+      const Scene scene = ConstructScene(size);
+
+      std::vector< uint32_t > expected(size);
+      std::vector< uint32_t > actual(size);
+
+      size_t sphere_mismatches = 0;
+      size_t box_mismatches = 0;
+
+      double sphere_ns[2] = { };
+      double box_ns[2] = { };
+
+      for (uint32_t view = 0; view < NUM_VIEWS; ++view)
+      {
+         const Frustumf frustum = ConstructFrustum(view);
+
+         size_t num_expected = 0;
+         size_t num_actual = 0;
+
+         // the distance of a sphere or box from the nearest plane it may cross
+         const auto Margin = [ & ] ( const Vec3f & center, const float radius, const float (&extent)[3] )
+         {
+            float margin = std::numeric_limits< float >::max();
+
+            for (int plane = 0; plane < Frustumf::NUM_PLANES; ++plane)
+            {
+               const float * const pPlane = frustum.GetPlane(static_cast< Frustumf::Plane >(plane));
+
+               const float reach = radius + std::abs(pPlane[0]) * extent[0] + std::abs(pPlane[1]) * extent[1] + std::abs(pPlane[2]) * extent[2];
+
+               margin = std::min(margin, std::abs(frustum.Distance(static_cast< Frustumf::Plane >(plane), center) + reach));
+            }
+
+            return margin;
+         };
+
+         // spheres
+         const auto CullSpheresScalar = [ & ] ( )
+         {
+            num_expected = 0;
+
+            for (size_t i = 0; i < size; ++i)
+            {
+               const Vec3f center(scene.spheres.center[0][i], scene.spheres.center[1][i], scene.spheres.center[2][i]);
+
+               if (frustum.IntersectsSphere(center, scene.spheres.radius[i])) expected[num_expected++] = static_cast< uint32_t >(i);
+            }
+         };
+
+         const auto CullSpheresSimd = [ & ] ( ) { num_actual = FrustumCull::CullSpheres(frustum, scene.spheres, actual.data()); };
+
+         sphere_ns[0] += bench::MeasureNS(1, [ & ] ( size_t ) { CullSpheresScalar(); bench::DoNotOptimize(expected); }, 5);
+         sphere_ns[1] += bench::MeasureNS(1, [ & ] ( size_t ) { CullSpheresSimd(); bench::DoNotOptimize(actual); }, 5);
+
+         sphere_mismatches += CountMismatches(size, expected, num_expected, actual, num_actual,
+            [ & ] ( const size_t i )
+            {
+               const float extent[3] = { };
+
+               return Margin(Vec3f(scene.spheres.center[0][i], scene.spheres.center[1][i], scene.spheres.center[2][i]), scene.spheres.radius[i], extent);
+            });
+
+         // boxes
+         const auto CullBoxesScalar = [ & ] ( )
+         {
+            num_expected = 0;
+
+            for (size_t i = 0; i < size; ++i)
+            {
+               const Vec3f & position = scene.positions[i];
+
+               if (frustum.IntersectsBox(position + Vec3f(-1.0f, 0.0f, -1.0f), position + Vec3f(1.0f, 5.0f, 1.0f)))
+               {
+                  expected[num_expected++] = static_cast< uint32_t >(i);
+               }
+            }
+         };
+
+         const auto CullBoxesSimd = [ & ] ( ) { num_actual = FrustumCull::CullBoxes(frustum, scene.boxes, actual.data()); };
+
+         box_ns[0] += bench::MeasureNS(1, [ & ] ( size_t ) { CullBoxesScalar(); bench::DoNotOptimize(expected); }, 5);
+         box_ns[1] += bench::MeasureNS(1, [ & ] ( size_t ) { CullBoxesSimd(); bench::DoNotOptimize(actual); }, 5);
+
+         box_mismatches += CountMismatches(size, expected, num_expected, actual, num_actual,
+            [ & ] ( const size_t i )
+            {
+               const float extent[3] = { scene.boxes.extent[0][i], scene.boxes.extent[1][i], scene.boxes.extent[2][i] };
+
+               return Margin(Vec3f(scene.boxes.center[0][i], scene.boxes.center[1][i], scene.boxes.center[2][i]), 0.0f, extent);
+            });
+      }
+
+      const bool spheres_matched = sphere_mismatches == 0;
+      const bool boxes_matched = box_mismatches == 0;
+
+      gReport.Add("spheres", "f32", size, sphere_ns[0] / (NUM_VIEWS * size), sphere_ns[1] / (NUM_VIEWS * size), static_cast< double >(sphere_mismatches) / size, spheres_matched);
+      gReport.Add("boxes", "f32", size, box_ns[0] / (NUM_VIEWS * size), box_ns[1] / (NUM_VIEWS * size), static_cast< double >(box_mismatches) / size, boxes_matched);
+
+      passed &= spheres_matched && boxes_matched;
+   }
+
+   return passed;
+}
+
+// culls the boxes and compacts the world matrices of the visible instances,
+// as the demo does every frame, serially and across the threads.  both must
+// give exactly the same instance buffer.  the times reported are per instance.
+bool RunCompaction( )
+{
+   bool passed = true;
+
+   for (const size_t size : CULL_SIZES)
+   {
+      const Scene scene = ConstructScene(size);
+
+      std::vector< uint32_t > visible(size);
+      std::vector< Matrixf > serial(size);
+      std::vector< Matrixf > parallel(size);
+
+      size_t num_visible[2] = { };
+      double ns[2] = { };
+      bool identical = true;
+
+      for (uint32_t view = 0; view < NUM_VIEWS; ++view)
+      {
+         const Frustumf frustum = ConstructFrustum(view);
+
+         const auto Cull = [ & ] ( const bool threads, std::vector< Matrixf > & worlds ) -> size_t
+         {
+            const size_t count = FrustumCull::CullBoxes(frustum, scene.boxes, visible.data(), threads);
+
+            FrustumCull::Compact(scene.worlds.data(), visible.data(), count, worlds.data(), threads);
+
+            return count;
+         };
+
+         ns[0] += bench::MeasureNS(1, [ & ] ( size_t ) { num_visible[0] = Cull(false, serial); bench::DoNotOptimize(serial); }, 5);
+         ns[1] += bench::MeasureNS(1, [ & ] ( size_t ) { num_visible[1] = Cull(true, parallel); bench::DoNotOptimize(parallel); }, 5);
+
+         identical &= num_visible[0] == num_visible[1] &&
+                      std::equal(serial.begin(), serial.begin() + num_visible[0], parallel.begin());
+      }
+
+      gReport.Add("cull+compact", "f32", size, ns[0] / (NUM_VIEWS * size), ns[1] / (NUM_VIEWS * size), identical ? 0.0 : 1.0, identical);
+
+      passed &= identical;
+   }
+
+   return passed;
+}
+
+// objects of the size of buildings and a few much larger ones, the sizes a
+// loose octree keeps at different depths, spread over the scene
+std::vector< Aabbf > ConstructObjects( const size_t size, uint32_t state )
+{
+   std::vector< Aabbf > objects;
+   objects.reserve(size);
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      const Vec3f center((Random(state) * 2.0f - 1.0f) * SCENE_AREA,
+                         Random(state) * 20.0f,
+                         (Random(state) * 2.0f - 1.0f) * SCENE_AREA);
+
+      const float scale = i % 100 ? 2.5f : 25.0f;
+
+      const Vec3f extent(0.25f + Random(state) * scale,
+                         0.25f + Random(state) * scale,
+                         0.25f + Random(state) * scale);
+
+      objects.emplace_back(center - extent, center + extent);
+   }
+
+   return objects;
+}
+
+// moves every object a little, as a frame of a simulation would
+void MoveObjects( std::vector< Aabbf > & objects, uint32_t state )
+{
+   for (Aabbf & object : objects)
+   {
+      const Vec3f offset(Random(state) * 2.0f - 1.0f, 0.0f, Random(state) * 2.0f - 1.0f);
+
+      object.mMin += offset;
+      object.mMax += offset;
+   }
+}
+
+// the queries run against the indices
+struct SpatialQueries
+{
+   std::vector< Frustumf > frustums;
+
+   std::vector< Vec3f >    centers;
+   float                   radius;
+
+   std::vector< Vec3f >    origins;
+   std::vector< Vec3f >    directions;
+
+   std::vector< Vec3f >    points;
+};
+
+SpatialQueries ConstructQueries( )
+{
+   SpatialQueries queries;
+   uint32_t state = 0x1b873593u;
+
+   for (uint32_t view = 0; view < NUM_VIEWS; ++view)
+   {
+      queries.frustums.push_back(ConstructFrustum(view));
+   }
+
+   queries.radius = 10.0f;
+
+   for (uint32_t i = 0; i < NUM_QUERIES; ++i)
+   {
+      const Vec3f position((Random(state) * 2.0f - 1.0f) * SCENE_AREA,
+                           Random(state) * 20.0f,
+                           (Random(state) * 2.0f - 1.0f) * SCENE_AREA);
+
+      // rays run along the ground, looking for what a pick or a shot would hit
+      const float angle = Random(state) * 6.2831853f;
+
+      queries.centers.push_back(position);
+      queries.origins.push_back(position);
+      queries.directions.push_back(Vec3f(std::cos(angle), Random(state) * 0.2f - 0.1f, std::sin(angle)).MakeUnitVector());
+      queries.points.push_back(position);
+   }
+
+   return queries;
+}
+
+// the results of the queries, the objects found by the frustum and sphere
+// queries, the distances of the ray hits, and the
+// squared distances of the nearest objects
+struct SpatialResults
+{
+   std::vector< std::vector< uint32_t > > frustums;
+   std::vector< std::vector< uint32_t > > spheres;
+   std::vector< float >                   rays;
+   std::vector< std::vector< float > >    nearest;
+};
+
+// runs the queries by testing every object
+SpatialResults QueryObjects( const std::vector< Aabbf > & objects, const SpatialQueries & queries )
+{
+   SpatialResults results;
+
+   for (const Frustumf & frustum : queries.frustums)
+   {
+      results.frustums.emplace_back();
+
+      for (size_t i = 0; i < objects.size(); ++i)
+      {
+         if (frustum.IntersectsBox(objects[i].mMin, objects[i].mMax)) results.frustums.back().push_back(static_cast< uint32_t >(i));
+      }
+   }
+
+   for (const Vec3f & center : queries.centers)
+   {
+      results.spheres.emplace_back();
+
+      for (size_t i = 0; i < objects.size(); ++i)
+      {
+         if (objects[i].IntersectsSphere(center, queries.radius)) results.spheres.back().push_back(static_cast< uint32_t >(i));
+      }
+   }
+
+   for (size_t ray = 0; ray < queries.origins.size(); ++ray)
+   {
+      const Vec3f & direction = queries.directions[ray];
+      const Vec3f inv_direction(1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2]);
+
+      float distance = 1000.0f;
+
+      for (const Aabbf & object : objects)
+      {
+         float enter = 0.0f;
+
+         if (object.IntersectsRay(queries.origins[ray], inv_direction, distance, enter) && enter < distance) distance = enter;
+      }
+
+      results.rays.push_back(distance);
+   }
+
+   for (const Vec3f & point : queries.points)
+   {
+      std::vector< float > distances;
+      distances.reserve(objects.size());
+
+      for (const Aabbf & object : objects) distances.push_back(object.DistanceSquared(point));
+
+      const size_t k = std::min(NUM_NEAREST, distances.size());
+
+      std::partial_sort(distances.begin(), distances.begin() + k, distances.end());
+      distances.resize(k);
+
+      results.nearest.push_back(distances);
+   }
+
+   return results;
+}
+
+// runs the queries with an index
+template < typename Index >
+SpatialResults QueryIndex( const Index & index, const SpatialQueries & queries )
+{
+   SpatialResults results;
+
+   for (const Frustumf & frustum : queries.frustums)
+   {
+      results.frustums.emplace_back();
+
+      std::vector< uint32_t > & found = results.frustums.back();
+
+      index.QueryFrustum(frustum, [ & ] ( const uint32_t object ) { found.push_back(object); });
+   }
+
+   for (const Vec3f & center : queries.centers)
+   {
+      results.spheres.emplace_back();
+
+      std::vector< uint32_t > & found = results.spheres.back();
+
+      index.QuerySphere(center, queries.radius, [ & ] ( const uint32_t object ) { found.push_back(object); });
+   }
+
+   for (size_t ray = 0; ray < queries.origins.size(); ++ray)
+   {
+      float distance = 1000.0f;
+
+      index.QueryRay(queries.origins[ray], queries.directions[ray], distance);
+
+      results.rays.push_back(distance);
+   }
+
+   std::vector< uint32_t > nearest;
+
+   for (const Vec3f & point : queries.points)
+   {
+      index.QueryNearest(point, NUM_NEAREST, nearest);
+
+      results.nearest.emplace_back();
+
+      for (const uint32_t object : nearest) results.nearest.back().push_back(index.GetBox(object).DistanceSquared(point));
+   }
+
+   return results;
+}
+
+// counts the queries whose results differ...
+// the indices find objects in their own order, so the objects are sorted
+// into the increasing order they are found in by testing every object
+size_t CountMismatches( const SpatialResults & expected, SpatialResults actual )
+{
+   for (auto & found : actual.frustums) std::sort(found.begin(), found.end());
+   for (auto & found : actual.spheres) std::sort(found.begin(), found.end());
+
+   size_t mismatches = 0;
+
+   for (size_t i = 0; i < expected.frustums.size(); ++i) mismatches += expected.frustums[i] != actual.frustums[i];
+   for (size_t i = 0; i < expected.spheres.size(); ++i) mismatches += expected.spheres[i] != actual.spheres[i];
+   for (size_t i = 0; i < expected.rays.size(); ++i) mismatches += expected.rays[i] != actual.rays[i];
+   for (size_t i = 0; i < expected.nearest.size(); ++i) mismatches += expected.nearest[i] != actual.nearest[i];
+
+   return mismatches;
+}
+
+// the number of queries of each kind
+size_t NumQueries( const SpatialQueries & queries, const uint32_t kind )
+{
+   switch (kind)
+   {
+   case 0: return queries.frustums.size();
+   case 1: return queries.centers.size();
+   case 2: return queries.origins.size();
+   default: return queries.points.size();
+   }
+}
+
+// builds a bvh over the objects
+Bvhf ConstructBvh( const std::vector< Aabbf > & objects )
+{
+   Bvhf bvh;
+   bvh.Build(objects);
+
+   return bvh;
+}
+
+// inserts the objects into a loose octree over the scene, the ids match the indices
+LooseOctreef ConstructOctree( const std::vector< Aabbf > & objects )
+{
+   LooseOctreef octree(Aabbf(Vec3f(-SCENE_AREA, -SCENE_AREA, -SCENE_AREA), Vec3f(SCENE_AREA, SCENE_AREA, SCENE_AREA)));
+
+   for (const Aabbf & object : objects) octree.Insert(object);
+
+   return octree;
+}
+
+// runs each kind of query by testing every object and with the index, which
+// must find exactly the same objects.  the times reported are per query.
+template < typename Index, typename Construct >
+bool RunSpatialQueries( Construct && construct )
+{
+   static const char * const KINDS[] = { "frustum", "sphere", "ray", "nearest" };
+
+   const SpatialQueries queries = ConstructQueries();
+
+   bool passed = true;
+
+   for (const size_t size : SPATIAL_SIZES)
+   {
+      const std::vector< Aabbf > objects = ConstructObjects(size, 0x9e3779b9u);
+      const Index index = construct(objects);
+
+      const SpatialResults expected = QueryObjects(objects, queries);
+      const SpatialResults actual = QueryIndex(index, queries);
+
+      const size_t mismatches = CountMismatches(expected, actual);
+
+      for (uint32_t kind = 0; kind < 4; ++kind)
+      {
+         // only the one kind of query is kept for each timing
+         SpatialQueries timed = queries;
+
+         if (kind != 0) timed.frustums.clear();
+         if (kind != 1) timed.centers.clear();
+         if (kind != 2) timed.origins.clear(), timed.directions.clear();
+         if (kind != 3) timed.points.clear();
+
+         const double num_queries = static_cast< double >(NumQueries(queries, kind));
+
+         const double brute_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(QueryObjects(objects, timed)); }, 3);
+         const double index_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bench::DoNotOptimize(QueryIndex(index, timed)); }, 3);
+
+         gReport.Add(KINDS[kind], "f32", size, brute_ns / num_queries, index_ns / num_queries,
+                     static_cast< double >(mismatches), mismatches == 0);
+      }
+
+      passed &= mismatches == 0;
+   }
+
+   return passed;
+}
+
+// builds the indices and then moves every object, refitting the bvh and
+// moving the objects within the octree.  the queries of both must still find
+// exactly the objects that were moved.  the times reported are per object.
+bool RunSpatialUpdates( )
+{
+   const SpatialQueries queries = ConstructQueries();
+
+   bool passed = true;
+
+   for (const size_t size : SPATIAL_SIZES)
+   {
+      std::vector< Aabbf > objects = ConstructObjects(size, 0x85ebca6bu);
+
+      Bvhf bvh;
+      LooseOctreef octree = ConstructOctree(objects);
+
+      const double bvh_build_ns = bench::MeasureNS(1, [ & ] ( size_t ) { bvh = ConstructBvh(objects); bench::DoNotOptimize(bvh); }, 3);
+      const double octree_build_ns = bench::MeasureNS(1, [ & ] ( size_t ) { octree = ConstructOctree(objects); bench::DoNotOptimize(octree); }, 3);
+
+      // each repetition moves the objects again, so the timed moves are all real
+      uint32_t state = 0xc2b2ae35u;
+
+      const double bvh_move_ns = bench::MeasureNS(1, [ & ] ( size_t )
+      {
+         MoveObjects(objects, state);
+
+         for (size_t i = 0; i < objects.size(); ++i) bvh.Move(static_cast< uint32_t >(i), objects[i]);
+
+         bvh.Refit();
+      }, 3);
+
+      for (size_t i = 0; i < objects.size(); ++i) octree.Move(static_cast< uint32_t >(i), objects[i]);
+
+      const double octree_move_ns = bench::MeasureNS(1, [ & ] ( size_t )
+      {
+         MoveObjects(objects, state);
+
+         for (size_t i = 0; i < objects.size(); ++i) octree.Move(static_cast< uint32_t >(i), objects[i]);
+      }, 3);
+
+      // the moves of the octree were not applied to the bvh
+      for (size_t i = 0; i < objects.size(); ++i) bvh.Move(static_cast< uint32_t >(i), objects[i]);
+
+      bvh.Refit();
+
+      const SpatialResults expected = QueryObjects(objects, queries);
+
+      const size_t mismatches =
+         CountMismatches(expected, QueryIndex(bvh, queries)) +
+         CountMismatches(expected, QueryIndex(octree, queries)) +
+         (bvh.NumObjects() != size) + (octree.NumObjects() != size);
+
+      gReport.Add("build", "f32", size, bvh_build_ns / size, octree_build_ns / size, static_cast< double >(mismatches), mismatches == 0);
+      gReport.Add("move", "f32", size, bvh_move_ns / size, octree_move_ns / size, static_cast< double >(mismatches), mismatches == 0);
+
+      passed &= mismatches == 0;
+   }
+
+   return passed;
+}
+
+} // namespace
+
+int main( const int argc, const char * const argv[] )
+{
+   if (!gReport.ParseArgs(argc, argv)) return 2;
+
+   gReport.SetProperty("hardware_threads", std::to_string(std::thread::hardware_concurrency()));
+
+   bool passed = true;
+
+   gReport.BeginSuite("frustum culling (ns per instance)", "scalar", "simd");
+
+   passed &= RunCulling();
+
+   gReport.BeginSuite("instance compaction (ns per instance)", "serial", "parallel");
+
+   passed &= RunCompaction();
+
+   gReport.BeginSuite("bvh queries (ns per query)", "brute", "bvh");
+
+   passed &= RunSpatialQueries< Bvhf >(ConstructBvh);
+
+   gReport.BeginSuite("loose octree queries (ns per query)", "brute", "octree");
+
+   passed &= RunSpatialQueries< LooseOctreef >(ConstructOctree);
+
+   gReport.BeginSuite("spatial index updates (ns per object)", "bvh", "octree");
+
+   passed &= RunSpatialUpdates();
+
+   passed &= gReport.Write();
+
+   return passed ? 0 : 1;
+}
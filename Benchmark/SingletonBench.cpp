@@ -0,0 +1,197 @@
+// local includes
+#include "BenchHarness.h"
+
+// wgl includes
+#include "Singleton.h"
+
+// std includes
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+
+// number of threads racing into the first call
+const size_t NUM_THREADS = 16;
+
+// number of times the singleton is released and raced for again
+const size_t NUM_ROUNDS = 200;
+
+// number of hot path calls per thread once the singleton exists
+const size_t NUM_CALLS = 1 << 20;
+
+std::atomic< uint32_t > gConstructed ( 0 );
+std::atomic< uint32_t > gDestroyed ( 0 );
+
+// slow to construct, to widen the window for a racing thread
+class Contended
+{
+public:
+   template < typename T > friend class ::Singleton;
+
+   uint32_t Value( ) const { return mValue; }
+
+private:
+   Contended( ) :
+   mValue   ( 0 )
+   {
+      for (uint32_t i = 0; i < 10000; ++i) bench::DoNotOptimize(mValue += i & 1);
+
+      gConstructed.fetch_add(1);
+   }
+
+   ~Contended( )
+   {
+      gDestroyed.fetch_add(1);
+   }
+
+   uint32_t mValue;
+
+};
+
+typedef Singleton< Contended > ContendedSingleton;
+
+// records the order the singletons below are released in
+std::string gReleaseOrder;
+
+// released first regardless of the creation order
+struct Renderer { ~Renderer( ) { gReleaseOrder += 'R'; } };
+
+// uses the device from its constructor, so it has to go first
+struct Device { ~Device( ) { gReleaseOrder += 'D'; } };
+struct Cache { Cache( ) { Singleton< Device >::Instance(); } ~Cache( ) { gReleaseOrder += 'C'; } };
+
+} // namespace
+
+template < >
+struct SingletonShutdownPriority< Renderer >
+{
+   static const int VALUE = 1;
+};
+
+namespace
+{
+
+// starts all the threads at once and races them into the first call.
+// returns false if more than one instance was ever handed out.
+bool RaceFirstCall( )
+{
+   bool passed = true;
+
+   for (size_t round = 0; round < NUM_ROUNDS; ++round)
+   {
+      std::atomic< bool > start ( false );
+      std::vector< Contended * > instances(NUM_THREADS);
+      std::vector< std::thread > threads;
+
+      for (size_t i = 0; i < NUM_THREADS; ++i)
+      {
+         threads.emplace_back([ &, i ] ( )
+         {
+            while (!start.load(std::memory_order_acquire)) std::this_thread::yield();
+
+            instances[i] = ContendedSingleton::Instance();
+         });
+      }
+
+      start.store(true, std::memory_order_release);
+
+      for (auto & thread : threads) thread.join();
+
+      for (const Contended * const pInstance : instances) passed &= pInstance == instances[0];
+
+      ContendedSingleton::Release();
+   }
+
+   passed &= gConstructed.load() == NUM_ROUNDS && gDestroyed.load() == NUM_ROUNDS;
+
+   std::cout << "first call race: " << NUM_ROUNDS << " rounds x " << NUM_THREADS << " threads, "
+             << gConstructed.load() << " constructed, " << gDestroyed.load() << " destroyed"
+             << (passed ? "" : "  FAILED") << std::endl;
+
+   return passed;
+}
+
+// measures the hot path once the singleton exists
+bool HammerHotPath( )
+{
+   Contended * const pExpected = ContendedSingleton::Instance();
+
+   const double single_ns = bench::MeasureNS(NUM_CALLS, [ ] ( size_t )
+   {
+      bench::DoNotOptimize(ContendedSingleton::Instance()->Value());
+   });
+
+   // every thread calls instance as fast as it can
+   std::atomic< uint32_t > mismatches ( 0 );
+
+   const auto beg = std::chrono::steady_clock::now();
+
+   std::vector< std::thread > threads;
+
+   for (size_t i = 0; i < NUM_THREADS; ++i)
+   {
+      threads.emplace_back([ & ] ( )
+      {
+         uint32_t local_mismatches = 0;
+
+         for (size_t call = 0; call < NUM_CALLS; ++call)
+         {
+            local_mismatches += ContendedSingleton::Instance() != pExpected;
+         }
+
+         mismatches.fetch_add(local_mismatches);
+      });
+   }
+
+   for (auto & thread : threads) thread.join();
+
+   const double threaded_ns =
+      std::chrono::duration< double, std::nano >(std::chrono::steady_clock::now() - beg).count() /
+      static_cast< double >(NUM_CALLS * NUM_THREADS);
+
+   const bool passed = !mismatches.load() && gConstructed.load() == NUM_ROUNDS + 1;
+
+   std::cout << std::fixed << std::setprecision(2)
+             << "hot path: " << single_ns << " ns per call, "
+             << threaded_ns << " ns per call over " << NUM_THREADS << " threads"
+             << (passed ? "" : "  FAILED") << std::endl;
+
+   return passed;
+}
+
+// checks the ordered shutdown of dependent and prioritized singletons
+bool ShutdownOrder( )
+{
+   Singleton< Renderer >::Instance();
+   Singleton< Cache >::Instance();
+
+   ShutdownSingletons();
+
+   // the renderer has the higher priority, the cache created the device
+   // from its constructor and the contended singleton was created first
+   const bool passed = gReleaseOrder == "RCD" && gDestroyed.load() == NUM_ROUNDS + 1;
+
+   std::cout << "shutdown order: " << gReleaseOrder
+             << (passed ? "" : "  FAILED") << std::endl;
+
+   return passed;
+}
+
+} // namespace
+
+int main( const int /*argc*/, const char * const /*argv*/[] )
+{
+   bool passed = true;
+
+   passed &= RaceFirstCall();
+   passed &= HammerHotPath();
+   passed &= ShutdownOrder();
+
+   return passed ? 0 : 1;
+}
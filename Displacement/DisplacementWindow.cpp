@@ -4,6 +4,7 @@
 // wgl includes
 #include "GeomHelper.h"
 #include "ReadTexture.h"
+#include "TextureCache.h"
 
 // gl includes
 #include <GL/glew.h>
@@ -272,13 +273,23 @@ LRESULT DisplacementWindow::MessageHandler( UINT uMsg,
 
 void DisplacementWindow::GenerateTerrain( const bool reload_shaders )
 {
+   // loads a texture from its block compressed cache, which is
+   // compressed from the texture the first time it is read
+   const auto LoadCompressed = [ ] ( Texture & texture, const char * const pFilename, const BlockCompression::Format format )
+   {
+      TextureCache::Image image;
+
+      if (TextureCache::Load(pFilename, format, false, image, true)) texture.Load2D(image);
+   };
+
    // read in the visual textures
-   if (!mDirtTex) mDirtTex.Load2D(R"(.\displacement\textures\dirt.jpg)", GL_RGB, GL_COMPRESSED_RGB, true);
-   if (!mRockTex) mRockTex.Load2D(R"(.\displacement\textures\rock.jpg)", GL_RGB, GL_COMPRESSED_RGB, true);
-   if (!mSnowTex) mSnowTex.Load2D(R"(.\displacement\textures\snow.jpg)", GL_RGB, GL_COMPRESSED_RGB, true);
-   if (!mGrassTex) mGrassTex.Load2D(R"(.\displacement\textures\grass.jpg)", GL_RGB, GL_COMPRESSED_RGB, true);
-   if (!mNormalMap) mNormalMap.Load2D(R"(.\displacement\textures\normal_map.png)", GL_RGB, GL_COMPRESSED_RGB, true);
-   //if (!mNormalMap) mNormalMap.Load2D(R"(.\displacement\textures\bricks2_normal.png)", GL_RGB, GL_COMPRESSED_RGB, true);
+   if (!mDirtTex) LoadCompressed(mDirtTex, R"(.\displacement\textures\dirt.jpg)", BlockCompression::Format::BC1);
+   if (!mRockTex) LoadCompressed(mRockTex, R"(.\displacement\textures\rock.jpg)", BlockCompression::Format::BC1);
+   if (!mSnowTex) LoadCompressed(mSnowTex, R"(.\displacement\textures\snow.jpg)", BlockCompression::Format::BC1);
+   if (!mGrassTex) LoadCompressed(mGrassTex, R"(.\displacement\textures\grass.jpg)", BlockCompression::Format::BC1);
+   // the normals keep x and y in bc5, the shader rebuilds z
+   if (!mNormalMap) LoadCompressed(mNormalMap, R"(.\displacement\textures\normal_map.png)", BlockCompression::Format::BC5);
+   //if (!mNormalMap) LoadCompressed(mNormalMap, R"(.\displacement\textures\bricks2_normal.png)", BlockCompression::Format::BC5);
 
    if (!mDispMapTex)
    {
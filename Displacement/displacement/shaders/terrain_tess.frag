@@ -86,8 +86,11 @@ void main( )
    vec4 rock = texture(rock_texture, geom_in.tex_coord * 50);
    vec4 snow = texture(snow_texture, geom_in.tex_coord * 50);
 
-   // pull out the normal from the tangent space
-   vec3 normal = normalize(geom_in.tbn_matrix * (2.0f * texture(normal_map_texture, geom_in.tex_coord).xyz - 1.0f));
+   // pull out the normal from the tangent space...
+   // the normal map only stores x and y, so z is rebuilt from their length
+   vec2 normal_xy = 2.0f * texture(normal_map_texture, geom_in.tex_coord).xy - 1.0f;
+   vec3 normal_tangent = vec3(normal_xy, sqrt(max(1.0f - dot(normal_xy, normal_xy), 0.0f)));
+   vec3 normal = normalize(geom_in.tbn_matrix * normal_tangent);
 
    // something more complex can be done later to give
    // the terrain a more natural feel and look...
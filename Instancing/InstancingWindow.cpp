@@ -4,9 +4,13 @@
 #include "Vector.h"
 #include "Matrix.h"
 #include "Shaders.h"
+#include "Frustum.h"
+#include "Profiler.h"
+#include "WglAssert.h"
 #include "ReadTexture.h"
 #include "MathHelper.h"
 #include "MatrixHelper.h"
+#include "FrustumCull.h"
 
 // gl includes
 #include "GL/glew.h"
@@ -17,8 +21,12 @@
 #include <vector>
 #include <sstream>
 #include <iomanip>
+#include <iostream>
 #include <algorithm>
 
+// crt includes
+#include <math.h>
+
 // determines if the application should run wild
 #define LET_APP_RUN_WILD 1
 
@@ -32,6 +40,9 @@ mTreesFragID            ( 0 ),
 mTreesGeomID            ( 0 ),
 mNumBuildingInstances   ( 100 ),
 mNumTreeInstances       ( 100 ),
+mNumVisibleBuildings    ( 0 ),
+mNumVisibleTrees        ( 0 ),
+mCullMS                 ( 0.0 ),
 mPrevMouseX             ( 0 ),
 mPrevMouseY             ( 0 )
 {
@@ -102,6 +113,9 @@ int InstancingWindow::Run( )
    int appQuitVal = 0;
    bool bQuit = false;
 
+   // frames since the profiler statistics were last printed
+   size_t profiledFrames = 0;
+
    while (!bQuit)
    {
       // obtain the current tick count
@@ -113,7 +127,10 @@ int InstancingWindow::Run( )
       if (!bQuit)
       {
          // render the scene
-         RenderScene();
+         {
+            WGL_PROFILE_ZONE("InstancingWindow::RenderScene");
+            RenderScene();
+         }
 
          // if there is time left, then do some waiting
          if (const double deltaMS = localTimer.DeltaMS(begTick) <= MS_PER_FRAME)
@@ -128,10 +145,36 @@ int InstancingWindow::Run( )
          // construct a string to place on the title
          std::stringstream ss;
          ss << "Instancing - "
-            << "Num Buildings: " << mNumBuildingInstances
-            << " Num Trees: " << mNumTreeInstances << " - "
-            << std::fixed << std::setprecision(3) << frame_rate << " fps";
+            << "Num Buildings: " << mNumVisibleBuildings << " / " << mNumBuildingInstances
+            << " Num Trees: " << mNumVisibleTrees << " / " << mNumTreeInstances << " - "
+            << std::fixed << std::setprecision(3) << "Cull: " << mCullMS << " ms - "
+            << frame_rate << " fps";
          SetWindowText(GetHWND(), ss.str().c_str());
+
+         // close the frame for the profiler
+         WGL_PROFILE_FRAME();
+
+         // print the statistics each time the profiler history fills up
+         if (Profiler::IsEnabled() && ++profiledFrames == Profiler::HISTORY_FRAMES)
+         {
+            profiledFrames = 0;
+
+            std::vector< ProfileZoneStats > stats = Profiler::GetZoneStats();
+            stats.insert(stats.begin(), Profiler::GetFrameStats());
+
+            std::cout << std::fixed << std::setprecision(3);
+
+            for (const ProfileZoneStats & zone : stats)
+            {
+               std::cout << std::left << std::setw(40) << zone.name << std::right
+                         << " calls " << std::setw(8) << zone.calls
+                         << " avg " << std::setw(8) << zone.avg_ms
+                         << " p99 " << std::setw(8) << zone.p99_ms
+                         << " max " << std::setw(8) << zone.max_ms << " ms" << std::endl;
+            }
+
+            std::cout << std::endl;
+         }
       }
    }
 
@@ -265,6 +308,18 @@ LRESULT InstancingWindow::MessageHandler( UINT uMsg, WPARAM wParam, LPARAM lPara
    return OpenGLWindow::MessageHandler(uMsg, wParam, lParam);
 }
 
+void InstancingWindow::OnDestroy( )
+{
+   // should still have a valid context
+   WGL_ASSERT(ContextIsCurrent());
+
+   // release the instances streamed to the gpu
+   mInstanceBuffer.Destroy();
+
+   // call the base class to clean things up
+   OpenGLWindow::OnDestroy();
+}
+
 void InstancingWindow::CreateInstances( )
 {
    // create a texture object
@@ -283,14 +338,12 @@ void InstancingWindow::CreateInstances( )
    glGenerateMipmap(GL_TEXTURE_2D);
    glBindTexture(GL_TEXTURE_2D, 0);
 
-   // defines a temp hold for the instanced data
-   struct InstanceData
-   {
-      Matrixf  mWorld;
-   };
-
    // start setting up the instanced data
-   std::vector< std::vector< InstanceData > > instanceData(NUM_BUILDING_TYPES);
+   for (uint32_t i = 0; i < NUM_BUILDING_TYPES; ++i)
+   {
+      mBuildingWorlds[i].clear();
+      mBuildingBounds[i].Clear();
+   }
 
    // generate data for each instance
    for (uint32_t i = 0; i < mNumBuildingInstances; ++i)
@@ -298,14 +351,13 @@ void InstancingWindow::CreateInstances( )
       // determine an instance to generate data for
       const uint32_t instance = rand() % NUM_BUILDING_TYPES;
       // setup the instance data
-      const InstanceData data =
-      {
-         Matrixf::Translate(static_cast< float >((rand() % INSTANCE_AREA) * (rand() % 2 == 0 ? 1 : -1)),
-                            0.0f,
-                            static_cast< float >((rand() % INSTANCE_AREA) * (rand() % 2 == 0 ? 1 : -1)))  
-      };
+      const Vec3f position(static_cast< float >((rand() % INSTANCE_AREA) * (rand() % 2 == 0 ? 1 : -1)),
+                           0.0f,
+                           static_cast< float >((rand() % INSTANCE_AREA) * (rand() % 2 == 0 ? 1 : -1)));
       // add to the list of instanced data
-      instanceData[instance].push_back(data);
+      // the buildings span -1 to 1 in x and z and 0 to 5 in y
+      mBuildingWorlds[instance].push_back(Matrixf::Translate(position));
+      mBuildingBounds[instance].Add(position + Vec3f(-1.0f, 0.0f, -1.0f), position + Vec3f(1.0f, 5.0f, 1.0f));
    }
 
    // generate gl data for each object
@@ -343,9 +395,10 @@ void InstancingWindow::CreateInstances( )
       glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
 
       // create, fill, and define the world matrix transform
+      // the visible instances are streamed in each frame
       glGenBuffers(1, &instance.mWorldBufferID);
       glBindBuffer(GL_ARRAY_BUFFER, instance.mWorldBufferID);
-      glBufferData(GL_ARRAY_BUFFER, sizeof(Matrixf) * instanceData[i].size(), &instanceData[i][0], GL_STATIC_DRAW);
+      glBufferData(GL_ARRAY_BUFFER, sizeof(Matrixf) * mBuildingWorlds[i].size(), mBuildingWorlds[i].data(), GL_STREAM_DRAW);
       
       // setup all 4 vertex attribute locations
       for (GLuint j = 0; j < 4; ++j)
@@ -357,7 +410,7 @@ void InstancingWindow::CreateInstances( )
       }
 
       // define the number of instances
-      instance.mNumInstances = static_cast< GLuint >(instanceData[i].size());
+      instance.mNumInstances = static_cast< GLuint >(mBuildingWorlds[i].size());
       
       // define the instance index ids
       const uint32_t indices[] =
@@ -404,7 +457,11 @@ void InstancingWindow::CreateInstances( )
    glBindTexture(GL_TEXTURE_2D, 0);
 
    // start setting up the instanced data for the trees
-   std::vector< std::vector< Vec3f > > treeVerts(NUM_TREE_TYPES);
+   for (uint32_t i = 0; i < NUM_TREE_TYPES; ++i)
+   {
+      mTreePositions[i].clear();
+      mTreeBounds[i].Clear();
+   }
 
    // generate data for each instance
    for (uint32_t i = 0; i < mNumTreeInstances; ++i)
@@ -415,7 +472,7 @@ void InstancingWindow::CreateInstances( )
       const float x = static_cast< float >((rand() % INSTANCE_AREA) * (rand() % 2 == 0 ? 1 : -1));
       const float z = static_cast< float >((rand() % INSTANCE_AREA) * (rand() % 2 == 0 ? 1 : -1));
       // add to the list of instanced data
-      treeVerts[instance].push_back(Vec3f(x, 0.0f, z));
+      mTreePositions[instance].push_back(Vec3f(x, 0.0f, z));
    }
 
    // generate gl data for each object
@@ -427,7 +484,7 @@ void InstancingWindow::CreateInstances( )
       // create, fill, and define the vertex array data
       glGenBuffers(1, &instance.mVertBufferID);
       glBindBuffer(GL_ARRAY_BUFFER, instance.mVertBufferID);
-      glBufferData(GL_ARRAY_BUFFER, sizeof(Vec3f) * treeVerts[i].size(), &treeVerts[i][0], GL_STATIC_DRAW);
+      glBufferData(GL_ARRAY_BUFFER, sizeof(Vec3f) * mTreePositions[i].size(), mTreePositions[i].data(), GL_STREAM_DRAW);
 
       // define the size of the tree
       const float size[][2] =
@@ -437,6 +494,14 @@ void InstancingWindow::CreateInstances( )
 
       memcpy(instance.mSize, size[i], sizeof(instance.mSize));
 
+      // the tree is a billboard that stands on its position and turns about the y axis
+      const float radius = sqrtf(size[i][0] * size[i][0] * 0.25f + size[i][1] * size[i][1] * 0.25f);
+
+      for (const Vec3f & position : mTreePositions[i])
+      {
+         mTreeBounds[i].Add(position + Vec3f(0.0f, size[i][1] * 0.5f, 0.0f), radius);
+      }
+
       // reduce the width and height by one for the texture coordinates
       width -= 1; height -= 1;
 
@@ -451,7 +516,7 @@ void InstancingWindow::CreateInstances( )
       memcpy(instance.mTexCoords, coords[i], sizeof(instance.mTexCoords));
 
       // define the number of instances
-      instance.mNumInstances = static_cast< GLuint >(treeVerts[i].size());
+      instance.mNumInstances = static_cast< GLuint >(mTreePositions[i].size());
       
       // set the texture id for the instance
       instance.mTexID = treeTexID;
@@ -466,6 +531,108 @@ void InstancingWindow::CreateInstances( )
       mTreesGeomID = shader::LoadShaderFile(GL_GEOMETRY_SHADER, "trees.geom");
       shader::LinkShaders(mTreesProgID, mTreesVertID, mTreesGeomID, mTreesFragID);
    }
+
+   // any type may have all of the instances
+   mVisible.resize(std::max(mNumBuildingInstances, mNumTreeInstances));
+
+   // each frame writes all the instances at most, with room to align each type
+   const size_t frame_size =
+      sizeof(Matrixf) * mNumBuildingInstances + sizeof(Vec3f) * mNumTreeInstances +
+      INSTANCE_ALIGNMENT * (NUM_BUILDING_TYPES + NUM_TREE_TYPES);
+
+   mInstanceBuffer.Destroy();
+   mInstanceBuffer.Create(GL_ARRAY_BUFFER, frame_size);
+}
+
+void InstancingWindow::CullInstances( const Matrixf & projview )
+{
+   WGL_PROFILE_ZONE("InstancingWindow::CullInstances");
+
+   Timer timer;
+   const int64_t begTick = timer.GetCurrentTick();
+
+   const Frustumf frustum(projview);
+
+   // without the stream buffer the instances are uploaded to the buffers of each type
+   const bool streaming = mInstanceBuffer.IsCreated();
+
+   if (streaming) mInstanceBuffer.BeginFrame();
+
+   mNumVisibleBuildings = 0;
+
+   for (uint32_t i = 0; i < NUM_BUILDING_TYPES; ++i)
+   {
+      BuildingInstance & instance = mBuildingInstances[i];
+
+      const size_t num_visible = FrustumCull::CullBoxes(frustum, mBuildingBounds[i], mVisible.data(), true);
+
+      Matrixf * pWorlds = nullptr;
+      instance.mWorldOffset = 0;
+
+      if (streaming)
+      {
+         pWorlds = reinterpret_cast< Matrixf * >(
+            mInstanceBuffer.Allocate(sizeof(Matrixf) * num_visible, INSTANCE_ALIGNMENT, instance.mWorldOffset));
+      }
+      else
+      {
+         mVisibleWorlds.resize(num_visible);
+         pWorlds = mVisibleWorlds.data();
+      }
+
+      WGL_ASSERT(pWorlds || !num_visible);
+
+      FrustumCull::Compact(mBuildingWorlds[i].data(), mVisible.data(), num_visible, pWorlds, true);
+
+      if (!streaming)
+      {
+         glBindBuffer(GL_ARRAY_BUFFER, instance.mWorldBufferID);
+         glBufferData(GL_ARRAY_BUFFER, sizeof(Matrixf) * num_visible, pWorlds, GL_STREAM_DRAW);
+      }
+
+      instance.mNumVisible = static_cast< GLuint >(num_visible);
+      mNumVisibleBuildings += instance.mNumVisible;
+   }
+
+   mNumVisibleTrees = 0;
+
+   for (uint32_t i = 0; i < NUM_TREE_TYPES; ++i)
+   {
+      TreeInstance & instance = mTreeInstances[i];
+
+      const size_t num_visible = FrustumCull::CullSpheres(frustum, mTreeBounds[i], mVisible.data(), true);
+
+      Vec3f * pPositions = nullptr;
+      instance.mVertOffset = 0;
+
+      if (streaming)
+      {
+         pPositions = reinterpret_cast< Vec3f * >(
+            mInstanceBuffer.Allocate(sizeof(Vec3f) * num_visible, INSTANCE_ALIGNMENT, instance.mVertOffset));
+      }
+      else
+      {
+         mVisiblePositions.resize(num_visible);
+         pPositions = mVisiblePositions.data();
+      }
+
+      WGL_ASSERT(pPositions || !num_visible);
+
+      FrustumCull::Compact(mTreePositions[i].data(), mVisible.data(), num_visible, pPositions, true);
+
+      if (!streaming)
+      {
+         glBindBuffer(GL_ARRAY_BUFFER, instance.mVertBufferID);
+         glBufferData(GL_ARRAY_BUFFER, sizeof(Vec3f) * num_visible, pPositions, GL_STREAM_DRAW);
+      }
+
+      instance.mNumVisible = static_cast< GLuint >(num_visible);
+      mNumVisibleTrees += instance.mNumVisible;
+   }
+
+   glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+   mCullMS = timer.DeltaMS(begTick);
 }
 
 void InstancingWindow::RenderScene( )
@@ -473,6 +640,12 @@ void InstancingWindow::RenderScene( )
    // create the projview matrix
    const Matrixf projview = mPerspective * mCamera;
 
+   // find the instances to draw
+   CullInstances(projview);
+
+   // the buffer the visible instances were written to
+   const GLuint instanceBufferID = mInstanceBuffer.IsCreated() ? mInstanceBuffer.Buffer().Handle() : 0;
+
    // clear the buffers
    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -500,8 +673,19 @@ void InstancingWindow::RenderScene( )
       // setup buffered data
       glBindVertexArray(instance.mVertArrayID);
 
+      // point the world matrices at the visible instances
+      glBindBuffer(GL_ARRAY_BUFFER, instanceBufferID ? instanceBufferID : instance.mWorldBufferID);
+
+      for (GLuint j = 0; j < 4; ++j)
+      {
+         glVertexAttribPointer(2 + j, 4, GL_FLOAT, GL_FALSE, sizeof(Matrixf),
+                               reinterpret_cast< const void * >(instance.mWorldOffset + sizeof(Matrixf::type) * j * 4));
+      }
+
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+
       // draw the instanced buildings
-      glDrawElementsInstanced(GL_QUADS, instance.mIdxBufferSize, GL_UNSIGNED_INT, nullptr, instance.mNumInstances);
+      glDrawElementsInstanced(GL_QUADS, instance.mIdxBufferSize, GL_UNSIGNED_INT, nullptr, instance.mNumVisible);
 
       // unbind buffered data
       glBindVertexArray(0);
@@ -538,13 +722,13 @@ void InstancingWindow::RenderScene( )
       glActiveTexture(GL_TEXTURE0);
       glBindTexture(GL_TEXTURE_2D, instance.mTexID);
 
-      // bind the vertex data and setup the stream of data
-      glBindBuffer(GL_ARRAY_BUFFER, instance.mVertBufferID);
+      // bind the vertex data of the visible trees and setup the stream of data
+      glBindBuffer(GL_ARRAY_BUFFER, instanceBufferID ? instanceBufferID : instance.mVertBufferID);
       glEnableVertexAttribArray(0);
-      glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+      glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast< const void * >(instance.mVertOffset));
 
       // render the data
-      glDrawArrays(GL_POINTS, 0, instance.mNumInstances);
+      glDrawArrays(GL_POINTS, 0, instance.mNumVisible);
 
       // unbind the buffered data
       glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -557,6 +741,9 @@ void InstancingWindow::RenderScene( )
    // disable texturing
    glDisable(GL_TEXTURE_2D);
 
+   // the gpu may now read the instances of the frame
+   if (mInstanceBuffer.IsCreated()) mInstanceBuffer.EndFrame();
+
    // swap the buffers to display
    SwapBuffers(GetHDC());
 }
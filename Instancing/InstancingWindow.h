@@ -3,9 +3,13 @@
 
 // local includes
 #include "Matrix.h"
+#include "Vector.h"
+#include "FrustumCull.h"
 #include "OpenGLWindow.h"
+#include "StreamBuffer.h"
 
 // std includes
+#include <vector>
 #include <stdint.h>
 
 // gl incudes
@@ -35,6 +39,9 @@ protected:
    // handles messages passed by the system
    virtual LRESULT MessageHandler( UINT uMsg, WPARAM wParam, LPARAM lParam );
 
+   // called when the window is about to be destroyed
+   virtual void OnDestroy( ) override;
+
 private:
    // prohibit copy construction
    InstancingWindow( const InstancingWindow & );
@@ -44,6 +51,10 @@ private:
    // generates all the required items for rendering
    void CreateInstances( );
 
+   // culls the instances against the view and compacts
+   // the visible ones into the buffers that are drawn
+   void CullInstances( const Matrixf & projview );
+
    // renders the scene
    void RenderScene( );
 
@@ -66,6 +77,9 @@ private:
       GLuint   mTexID;
       // number of instances to render
       GLuint   mNumInstances;
+      // number of instances visible and where their world matrices start
+      GLuint   mNumVisible;
+      GLintptr mWorldOffset;
    };
 
    // defines a tree instance
@@ -81,6 +95,9 @@ private:
       float    mTexCoords[8];
       // number of instances to render
       GLuint   mNumInstances;
+      // number of instances visible and where their positions start
+      GLuint   mNumVisible;
+      GLintptr mVertOffset;
    };
 
    // defines number of instances and the area
@@ -88,6 +105,9 @@ private:
    static const uint32_t NUM_BUILDING_TYPES = 10;
    static const uint32_t NUM_TREE_TYPES = 3;
 
+   // alignment of the instances of each type in the stream buffer
+   static const size_t   INSTANCE_ALIGNMENT = 16;
+
    // shader ids
    GLuint   mBuildingsProgID;
    GLuint   mBuildingsVertID;
@@ -106,6 +126,27 @@ private:
    BuildingInstance  mBuildingInstances[NUM_BUILDING_TYPES];
    TreeInstance      mTreeInstances[NUM_TREE_TYPES];
 
+   // the world matrices and tree positions of every instance, with their bounds
+   std::vector< Matrixf >  mBuildingWorlds[NUM_BUILDING_TYPES];
+   FrustumCull::Boxes      mBuildingBounds[NUM_BUILDING_TYPES];
+   std::vector< Vec3f >    mTreePositions[NUM_TREE_TYPES];
+   FrustumCull::Spheres    mTreeBounds[NUM_TREE_TYPES];
+
+   // the indices of the visible instances of a type
+   std::vector< uint32_t > mVisible;
+
+   // the visible instances are written to the stream buffer each frame...
+   // without persistently mapped buffers they are compacted to client
+   // memory and uploaded to the buffers of each type instead
+   StreamBuffer            mInstanceBuffer;
+   std::vector< Matrixf >  mVisibleWorlds;
+   std::vector< Vec3f >    mVisiblePositions;
+
+   // the results of the last cull
+   uint32_t mNumVisibleBuildings;
+   uint32_t mNumVisibleTrees;
+   double   mCullMS;
+
    // camera / view matrix
    Matrixf  mCamera;
    Matrixf  mPerspective;
@@ -2,15 +2,25 @@
 #include <windows.h>
 
 // local includes
+#include "Profiler.h"
 #include "AllocConsole.h"
 #include "InstancingWindow.h"
 
+// crt includes
+#include <string.h>
+
 int __stdcall WinMain( HINSTANCE /*instance*/, HINSTANCE /*pinstance*/,
-                       LPSTR /*pCmdline*/, int /*show*/ )
+                       LPSTR pCmdline, int /*show*/ )
 {
    // allocate a console for the application
    AllocateDebugConsole();
 
+   // -profile records the zones and prints their statistics to the console
+   if (pCmdline && strstr(pCmdline, "-profile"))
+   {
+      Profiler::Enable(true);
+   }
+
    // create the main application window
    InstancingWindow * pWnd = new InstancingWindow();
    pWnd->Create(800, 600, "Instancing");
@@ -4,6 +4,7 @@
 // wgl includes
 #include <Timer.h>
 #include <Texture.h>
+#include <TextureCache.h>
 #include <MathHelper.h>
 #include <Quaternion.h>
 #include <MatrixHelper.h>
@@ -779,9 +780,19 @@ bool NormalMappingWindow::LoadTexture( )
    // indicates what to load
    static size_t next_texture_index = 0;
 
-   if (!mpDiffuseTex->Load2D(textures[next_texture_index][0], GL_RGB, GL_RGB8, true) ||
-       !mpHeightTex->Load2D(textures[next_texture_index][1], GL_RGB, GL_R8, true) ||
-       !mpNormalTex->Load2D(textures[next_texture_index][2], GL_RGB, GL_RGB8, true))
+   // loads a texture from its block compressed cache, which is
+   // compressed from the texture the first time it is read
+   const auto LoadCompressed = [ ] ( Texture & texture, const char * const pFilename, const BlockCompression::Format format )
+   {
+      TextureCache::Image image;
+
+      return TextureCache::Load(pFilename, format, false, image, true) && texture.Load2D(image);
+   };
+
+   // the height only needs the one channel, and the normals keep x and y with the shaders rebuilding z
+   if (!LoadCompressed(*mpDiffuseTex, textures[next_texture_index][0], BlockCompression::Format::BC1) ||
+       !LoadCompressed(*mpHeightTex, textures[next_texture_index][1], BlockCompression::Format::BC4) ||
+       !LoadCompressed(*mpNormalTex, textures[next_texture_index][2], BlockCompression::Format::BC5))
    {
       // release the textures
       mpDiffuseTex = nullptr;
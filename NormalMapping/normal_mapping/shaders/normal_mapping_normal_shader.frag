@@ -27,8 +27,8 @@ void main( )
    mat3 tbn_tangent_to_eye_space = mat3(frag_tangent, frag_bitangent, frag_normal);
 
    // obtain the normal from the texture
-   // wonder if a floating point texture would be better here?
-   vec3 sampled_normal_tangent_space = texture(normal_texture, frag_tex_coords).rgb;
+   // only x and y are stored, so z is rebuilt after they are expanded
+   vec3 sampled_normal_tangent_space = vec3(texture(normal_texture, frag_tex_coords).rg, 0.0f);
 
    // sometimes the y component is backwards, invert if requested
    if (invert_normal_texture_y_component)
@@ -37,7 +37,8 @@ void main( )
    }
 
    // component of rgb sample is in range of [0.0f, 1.0f], must convert to [-1.0f, 1.0f]
-   sampled_normal_tangent_space = sampled_normal_tangent_space * 2.0f - 1.0f;
+   sampled_normal_tangent_space.xy = sampled_normal_tangent_space.xy * 2.0f - 1.0f;
+   sampled_normal_tangent_space.z = sqrt(max(1.0f - dot(sampled_normal_tangent_space.xy, sampled_normal_tangent_space.xy), 0.0f));
    
    // convert the tangent space normal to eye space
    vec3 sampled_normal_eye_space = normalize(tbn_tangent_to_eye_space * sampled_normal_tangent_space);
@@ -3,6 +3,7 @@
 #include "WglAssert.h"
 #include "MathHelper.h"
 #include "ReadTexture.h"
+#include "MeshOptimizer.h"
 #include "OpenGLExtensions.h"
 
 // std includes
@@ -234,6 +235,9 @@ void Planet::ConstructPlanet( const double slice_deg, const double stack_deg )
                                               static_cast< uint32_t >(180.0 / stack_deg),
                                               mRadius);
 
+   // weld and reorder the sphere for the vertex cache
+   MeshOptimizer::Optimize(mSphereShape);
+
    // construct the vertex buffer
    mVertexArray.GenBuffer(GL_ARRAY_BUFFER);
    mVertexArray.Bind();
@@ -1,6 +1,7 @@
 // local includes
 #include "ProjectiveTextureWindow.h"
 #include "Timer.h"
+#include "Profiler.h"
 #include "WglAssert.h"
 #include "GeomHelper.h"
 #include "ReadTexture.h"
@@ -190,7 +191,10 @@ int ProjectiveTextureWindow::Run( )
 
       if (!bQuit)
       {
-         RenderScene();
+         {
+            WGL_PROFILE_ZONE("ProjectiveTextureWindow::RenderScene");
+            RenderScene();
+         }
 
          // if there is time left, then do some waiting
          if (const double deltaMS = localTimer.DeltaMS(begTick) <= MS_PER_FRAME)
@@ -198,6 +202,9 @@ int ProjectiveTextureWindow::Run( )
             // wait for the remainder of the time
             localTimer.Wait(static_cast< unsigned long >(MS_PER_FRAME - deltaMS));
          }
+
+         // close the frame for the profiler
+         WGL_PROFILE_FRAME();
       }
    }
 
@@ -5,10 +5,13 @@
 #include "Vector.h"
 #include "Texture.h"
 #include "WglAssert.h"
+#include "MeshCache.h"
 #include "GeomHelper.h"
 #include "ReadTexture.h"
 #include "MatrixHelper.h"
 #include "ShaderProgram.h"
+#include "TextureCache.h"
+#include "TextureLoader.h"
 #include "OpenGLExtensions.h"
 #include "FrameBufferObject.h"
 #include "VertexArrayObject.h"
@@ -25,9 +28,11 @@
 
 // std includes
 #include <map>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <memory>
+#include <future>
 #include <string>
 #include <vector>
 #include <sstream>
@@ -51,11 +56,12 @@ struct ShadowMapWindow::Renderable
    VAO      mVAO;
    VAO      mVAOEmpty;
    // vbo ids
+   // the vertex attributes are interleaved
    VBO      mVertBuf;
    VBO      mIdxBuf;
-   VBO      mTexBuf;
-   VBO      mNormBuf;
-   VBO      mClrBuf;
+   // type and size of the indices
+   GLenum   mIndexType;
+   size_t   mIndexSize;
    // texture containers
    TexturePtr     mDiffuse;
    // shader program
@@ -431,8 +437,8 @@ void ShadowMapWindow::RenderScene( )
       {
          glDrawElements(GL_TRIANGLES,
                         rbucketBeg->second.second,
-                        GL_UNSIGNED_INT,
-                        reinterpret_cast< void * >(rbucketBeg->second.first * sizeof(rbucketBeg->second.first)));
+                        mpEnterpriseE->mIndexType,
+                        reinterpret_cast< void * >(rbucketBeg->second.first * mpEnterpriseE->mIndexSize));
       }
 
       if (mpEnterpriseE->mRenderBuckets.cend() != rbucketEnd)
@@ -485,8 +491,8 @@ void ShadowMapWindow::RenderScene( )
       {
          glDrawElements(GL_TRIANGLES,
                         rbucketBeg->second.second,
-                        GL_UNSIGNED_INT,
-                        reinterpret_cast< void * >(rbucketBeg->second.first * sizeof(rbucketBeg->second.first)));
+                        mpEnterpriseE->mIndexType,
+                        reinterpret_cast< void * >(rbucketBeg->second.first * mpEnterpriseE->mIndexSize));
       }
 
       if (diffuse_tex && *diffuse_tex)
@@ -519,8 +525,8 @@ void ShadowMapWindow::RenderScene( )
          {
             glDrawElements(GL_TRIANGLES,
                            rbucketBeg->second.second,
-                           GL_UNSIGNED_INT,
-                           reinterpret_cast< void * >(rbucketBeg->second.first * sizeof(rbucketBeg->second.first)));
+                           mpEnterpriseE->mIndexType,
+                           reinterpret_cast< void * >(rbucketBeg->second.first * mpEnterpriseE->mIndexSize));
          }
 
          if (mpEnterpriseE->mRenderBuckets.cend() != rbucketEnd)
@@ -563,9 +569,6 @@ void ShadowMapWindow::GenerateSceneData( )
 {
    // release all the data
    mpEnterpriseE->mVertBuf.DeleteBuffer();
-   mpEnterpriseE->mClrBuf.DeleteBuffer();
-   mpEnterpriseE->mNormBuf.DeleteBuffer();
-   mpEnterpriseE->mTexBuf.DeleteBuffer();
    mpEnterpriseE->mVAO.DeleteArray();
    mpEnterpriseE->mIdxBuf.DeleteBuffer();
 
@@ -592,6 +595,7 @@ void ShadowMapWindow::GenerateEnterpriseE( )
    std::vector< float > tangents;
    std::vector< float > bitangents;
    std::vector< uint32_t > indices;
+   std::vector< std::string > materials;
    std::multimap< GLuint, std::pair< GLuint, GLsizei > > render_buckets;
 
    const auto GenColors = [ ] ( const size_t size, std::vector< float > & colors )
@@ -642,22 +646,78 @@ void ShadowMapWindow::GenerateEnterpriseE( )
       return model_matrix;
    };
 
-   const auto ReadTextures = [ ] ( const aiScene * const pScene,
-                                   const std::string & base_model_path,
+   // reads the diffuse texture of each material, an empty name for no texture
+   const auto ReadTextures = [ ] ( const std::vector< std::string > & materials,
                                    std::vector< std::shared_ptr< Texture > > & diffuse,
                                    std::vector< std::shared_ptr< Texture > > & height,
                                    std::vector< std::shared_ptr< Texture > > & normal )
    {
+      // this model is very incomplete in terms of the associated textures...
+      // try to load height and bump data here as well...
+      // the names of the other textures are very much the same except they have bump and norm in them...
+      const auto GetTextureNames = [ ] ( const std::string & filename ) -> std::array< std::string, 3 >
+      {
+         std::array< std::string, 3 > filenames = { filename };
+
+         // determine the offset of the 'diff' in the filename
+         const size_t diff_offset = filename.find("DIFF");
+
+         if (diff_offset != std::string::npos)
+         {
+            // construct the bump file name
+            filenames[1] = std::string(filename).replace(diff_offset, 4, "BUMP");
+
+            // construct the normal file name
+            filenames[2] = std::string(filenames[1]).insert(filenames[1].find_last_of("."), "_NORM");
+         }
+
+         return filenames;
+      };
+
+      // the diffuse textures load from their block compressed caches...
+      // start decoding all the other textures and the diffuse textures without
+      // a current cache on the loader threads, so they are read in parallel
+      // while the first ones are uploaded
+      TextureLoader loader;
+      std::map< std::string, std::future< TextureLoader::Result > > decoding;
+      std::map< std::string, std::pair< TextureCache::SourceStamp, TextureCache::Image > > compressed;
+
+      for (const std::string & material : materials)
+      {
+         const std::array< std::string, 3 > filenames = GetTextureNames(material);
+
+         for (size_t i = 0; i < filenames.size(); ++i)
+         {
+            const std::string & filename = filenames[i];
+
+            if (!filename.empty() && decoding.find(filename) == decoding.end() && compressed.find(filename) == compressed.end())
+            {
+               // the first is the diffuse texture
+               if (i == 0)
+               {
+                  auto & cache = compressed[filename];
+
+                  if (TextureCache::StampSource(filename.c_str(), cache.first) &&
+                      cache.second.Open(TextureCache::CacheFilename(filename.c_str()).c_str(), cache.first) &&
+                      cache.second.BlockFormat() == BlockCompression::Format::BC3)
+                  {
+                     continue;
+                  }
+
+                  cache.second.Close();
+               }
+
+               decoding[filename] = loader.Load(filename.c_str(), GL_RGBA);
+            }
+         }
+      }
+
       // make sure we do not load the same texture twice
       std::map< std::string, std::shared_ptr< Texture > > texture_filenames;
 
-      // iterate over all the materials collecting the diffuse texture
-      const aiMaterial * const * pBeg = pScene->mMaterials;
-      const aiMaterial * const * const pEnd = pScene->mMaterials + pScene->mNumMaterials;
-
       // an object that loads the appropriate texture
       const auto LoadTexture =
-      [ &texture_filenames ] ( const std::string & filename, const GLenum internal_format, std::vector< std::shared_ptr< Texture > > & textures )
+      [ &texture_filenames, &decoding, &compressed ] ( const std::string & filename, const GLenum internal_format, std::vector< std::shared_ptr< Texture > > & textures )
       {
          // make sure the length is valid
          if (!filename.empty())
@@ -665,14 +725,50 @@ void ShadowMapWindow::GenerateEnterpriseE( )
             // if the value has already been seen, then use that handle; otherwise create it
             const auto tex_filename = texture_filenames.find(filename);
 
-            if (texture_filenames.find(filename) != texture_filenames.end())
+            if (tex_filename != texture_filenames.end())
             {
                // already seen, so just reuse the handle
                textures.back() = tex_filename->second;
             }
             else
             {
-               if (textures.back()->Load2D(filename.c_str(), GL_RGBA, internal_format, true))
+               // wait for the texture to be decoded
+               const auto decoded = decoding.find(filename);
+               const auto cached = compressed.find(filename);
+
+               bool loaded = false;
+
+               if (cached != compressed.end())
+               {
+                  TextureCache::Image & image = cached->second.second;
+
+                  // compress the decoded texture into a new cache
+                  if (!image.IsOpen() && decoded != decoding.end() && decoded->second.valid())
+                  {
+                     const TextureLoader::Result result = decoded->second.get();
+
+                     if (result.texture.pTexture)
+                     {
+                        std::vector< uint8_t > contents =
+                           TextureCache::Serialize(cached->second.first, result.texture.pTexture.get(),
+                                                   result.texture.width, result.texture.height, 4,
+                                                   BlockCompression::Format::BC3, false, true);
+
+                        // use the contents as written, even if writing failed
+                        TextureCache::Write(TextureCache::CacheFilename(filename.c_str()).c_str(), contents);
+
+                        image.Open(std::move(contents), cached->second.first);
+                     }
+                  }
+
+                  loaded = textures.back()->Load2D(image);
+               }
+               else if (decoded != decoding.end() && decoded->second.valid())
+               {
+                  loaded = textures.back()->Load2D(decoded->second.get().texture, internal_format, true);
+               }
+
+               if (loaded)
                {
                   // obtain the handle for this texture
                   // this is currently not supported on my HD 5850 with driver version 14.4 (14.100)
@@ -685,7 +781,7 @@ void ShadowMapWindow::GenerateEnterpriseE( )
          }
       };
 
-      for (; pBeg != pEnd; ++pBeg)
+      for (const std::string & filename : materials)
       {
          // begin by inserting a null handle into the texture array
          diffuse.push_back(std::shared_ptr< Texture >(new Texture));
@@ -693,41 +789,14 @@ void ShadowMapWindow::GenerateEnterpriseE( )
          normal.push_back(std::shared_ptr< Texture >(new Texture));
 
          // if there is a diffuse texture, then set it up
-         if ((*pBeg)->GetTextureCount(aiTextureType_DIFFUSE))
+         if (!filename.empty())
          {
-            // have not found more than one texture so far
-            WGL_ASSERT((*pBeg)->GetTextureCount(aiTextureType_DIFFUSE) <= 1);
-
-            // get the texture associated with this material
-            const std::string filename = [ &pBeg, &base_model_path ] ( ) -> std::string
-            {
-               aiString filename; (*pBeg)->GetTexture(aiTextureType_DIFFUSE, 0, &filename); return base_model_path + filename.C_Str();
-            }();
-
-            // load the diffuse texture
-            LoadTexture(filename, GL_COMPRESSED_RGBA, diffuse);
-
-            // this model is very incomplete in terms of the associated textures...
-            // try to load height and bump data here as well...
-            // the names of the other textures are very much the same except they have bump and norm in them...
-
-            // determine the offset of the 'diff' in the filename
-            const size_t diff_offset = filename.find("DIFF");
-            
-            if (diff_offset != std::string::npos)
-            {
-               // construct the bump file name
-               const std::string filename_bump = std::string(filename).replace(filename.find("DIFF"), 4, "BUMP");
-
-               // load the heigt map texture
-               LoadTexture(filename_bump, GL_RGBA8, height);
+            const std::array< std::string, 3 > filenames = GetTextureNames(filename);
 
-               // construct the normal file name
-               const std::string filename_norm = std::string(filename_bump).insert(filename_bump.find_last_of("."), "_NORM");
-
-               // load the normal texture
-               LoadTexture(filename_norm, GL_RGBA8, normal);
-            }
+            // load the diffuse, height map and normal textures
+            LoadTexture(filenames[0], GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, diffuse);
+            LoadTexture(filenames[1], GL_RGBA8, height);
+            LoadTexture(filenames[2], GL_RGBA8, normal);
          }
       }
    };
@@ -750,9 +819,20 @@ void ShadowMapWindow::GenerateEnterpriseE( )
             return std::string(pFilename, pLoc ? pLoc + 1 : pFilename + std::strlen(pFilename));
          };
 
-         // start off by reading the textures
-         std::vector< std::shared_ptr< Texture > > unused_texs;
-         ReadTextures(pScene, GetBasePath(pFilename), mpEnterpriseE->mDiffuse, unused_texs, unused_texs);
+         // collect the diffuse texture of each material
+         const std::string base_model_path = GetBasePath(pFilename);
+
+         for (const aiMaterial * const * ppMat = pScene->mMaterials; ppMat != pScene->mMaterials + pScene->mNumMaterials; ++ppMat)
+         {
+            // have not found more than one texture so far
+            WGL_ASSERT((*ppMat)->GetTextureCount(aiTextureType_DIFFUSE) <= 1);
+
+            aiString filename;
+
+            materials.push_back((*ppMat)->GetTextureCount(aiTextureType_DIFFUSE) &&
+                                (*ppMat)->GetTexture(aiTextureType_DIFFUSE, 0, &filename) == aiReturn_SUCCESS ?
+                                base_model_path + filename.C_Str() : std::string());
+         }
 
          for (size_t cur_mesh = 0; cur_mesh < pScene->mNumMeshes; ++cur_mesh)
          {
@@ -804,43 +884,63 @@ void ShadowMapWindow::GenerateEnterpriseE( )
                [ &diffuse_color ] ( Vec3f & diffuse) { diffuse = Vec3f(&diffuse_color.r); });
             }
             
-            for (size_t i = 0; num_verts > i; ++i)
-            {
-               // need to translate the vertices as they may be in the wrong place...
-               const Vec3f vert = mesh_matrix * Vec3f(&((pVertices + i)->x));
-               vertices.insert(vertices.end(), vert.mT, vert.mT + 3);
-            }
+            // the batch transforms read the assimp vectors as x, y, z triples
+            static_assert(sizeof(aiVector3D) == sizeof(float) * 3, "aiVector3D must be three packed floats");
+
+            // need to translate the vertices as they may be in the wrong place...
+            const size_t vertices_offset = vertices.size();
+            vertices.resize(vertices_offset + num_verts * 3);
+            mesh_matrix.TransformPoints(&pVertices->x, num_verts, vertices.data() + vertices_offset, true);
+
+            // need to translate the normals to the correct location as they too may be in the wrong place...
+            const size_t normals_offset = normals.size();
+            normals.resize(normals_offset + num_verts * 3);
+            normal_matrix.TransformNormals(&pNormals->x, num_verts, normals.data() + normals_offset, true);
+
+            // the faces around each vertex, only built once a bad normal needs them
+            GeomHelper::VertexAdjacency adjacency;
 
             for (size_t i = 0; num_verts > i; ++i)
             {
-               // need to translate the normals to the correct location as they too may be in the wrong place...
-               Vec3f norm = Vec3f(&(normal_matrix * Vec4f((pNormals + i)->x, (pNormals + i)->y, (pNormals + i)->z, 0.0f)).X()).UnitVector();
+               float * const pNormal = normals.data() + normals_offset + i * 3;
+               Vec3f norm = Vec3f(pNormal).UnitVector();
                
                // this model has bad normal data in it, so just calculate it ourselves
                if (norm.Length() == 0 || std::isnan(norm.X()) || std::isnan(norm.Y()) || std::isnan(norm.Z()))
                {
-                  // run across the faces until a matching face is found
-                  const aiFace * const pFace =
-                     std::find_if(pCurMesh->mFaces, pCurMesh->mFaces + pCurMesh->mNumFaces,
-                     [ i ] ( const aiFace & cur_face )
+                  if (adjacency.offsets.empty())
+                  {
+                     std::vector< GLuint > mesh_indices;
+                     mesh_indices.reserve(pCurMesh->mNumFaces * 3);
+
+                     std::for_each(pCurMesh->mFaces, pCurMesh->mFaces + pCurMesh->mNumFaces,
+                     [ &mesh_indices ] ( const aiFace & cur_face )
                      {
                         // should always be three indices that make up this triangle
                         WGL_ASSERT(cur_face.mNumIndices == 3);
 
-                        return cur_face.mIndices[0] == i ||
-                               cur_face.mIndices[1] == i ||
-                               cur_face.mIndices[2] == i;
+                        mesh_indices.insert(mesh_indices.end(), cur_face.mIndices, cur_face.mIndices + 3);
                      });
 
-                  // calculate the normal based on the face indices
-                  const Vec3f e0(&(vertices[base_index * 3 + pFace->mIndices[0]]));
-                  const Vec3f e1(&(vertices[base_index * 3 + pFace->mIndices[1]]));
-                  const Vec3f e2(&(vertices[base_index * 3 + pFace->mIndices[2]]));
+                     adjacency = GeomHelper::ConstructVertexAdjacency(mesh_indices, num_verts);
+                  }
+
+                  // vertices that are not part of a face are never drawn
+                  if (adjacency.offsets[i] != adjacency.offsets[i + 1])
+                  {
+                     // calculate the normal based on the first face of the vertex
+                     const aiFace & face = pCurMesh->mFaces[adjacency.triangles[adjacency.offsets[i]]];
+                     const float * const pMeshVertices = vertices.data() + vertices_offset;
+
+                     const Vec3f e0(pMeshVertices + face.mIndices[0] * 3);
+                     const Vec3f e1(pMeshVertices + face.mIndices[1] * 3);
+                     const Vec3f e2(pMeshVertices + face.mIndices[2] * 3);
 
-                  norm = ((e1 - e0) ^ (e2 - e0)).UnitVector();
+                     norm = ((e1 - e0) ^ (e2 - e0)).UnitVector();
+                  }
                }
                
-               normals.insert(normals.end(), norm.mT, norm.mT + 3);
+               std::copy(norm.mT, norm.mT + 3, pNormal);
             }
 
             // read in all the faces for the mesh
@@ -888,7 +988,7 @@ void ShadowMapWindow::GenerateEnterpriseE( )
 
                // calculate all the vector information
                const auto tangents_bitangents =
-                  GeomHelper::ConstructTangentsAndBitangents(temp_vertices, temp_normals, temp_tex_coords, temp_indices);
+                  GeomHelper::ConstructTangentsAndBitangents(temp_vertices, temp_normals, temp_tex_coords, temp_indices, true);
 
                // add the tangents and bitangents
                tangents.insert(tangents.cend(),
@@ -914,11 +1014,65 @@ void ShadowMapWindow::GenerateEnterpriseE( )
       }
    };
 
+   // loads the model from its cache...  the model is imported and cached
+   // when there is no cache yet or the model changed since it was cached
+   const auto LoadModel = [ & ] ( const char * const pFilename ) -> MeshCache::Mesh
+   {
+      MeshCache::Mesh model;
+      MeshCache::SourceStamp stamp = { };
+
+      const std::string cache_filename = MeshCache::CacheFilename(pFilename);
+
+      if (!MeshCache::StampSource(pFilename, stamp) || !model.Open(cache_filename.c_str(), stamp))
+      {
+         ReadModel(pFilename);
+
+         // vertices size should match tangents and bitangents
+         WGL_ASSERT(vertices.size() == tangents.size());
+         WGL_ASSERT(vertices.size() == bitangents.size());
+
+         // the positions stay full precision, the rest is quantized
+         MeshCache::MeshSource source;
+         source.num_vertices = vertices.size() / 3;
+         source.attributes =
+         {
+            { 0, 3, MeshCache::Format::FLOAT, vertices.data() },
+            { 1, 3, MeshCache::Format::UNORM8, colors.data() },
+            { 2, 3, MeshCache::Format::SNORM16, normals.data() },
+            { 3, 2, MeshCache::Format::HALF, tex_coords.data() }
+         };
+         source.indices = indices;
+         source.materials = materials;
+
+         for (const auto & bucket : render_buckets)
+         {
+            const MeshCache::DrawRange range = { bucket.first, bucket.second.first, static_cast< uint32_t >(bucket.second.second) };
+
+            source.draw_ranges.push_back(range);
+         }
+
+         std::vector< uint8_t > contents = MeshCache::Serialize(stamp, source);
+
+         if (!MeshCache::Write(cache_filename.c_str(), contents))
+         {
+            PostDebugMessage(GL_DEBUG_TYPE_OTHER, 4, GL_DEBUG_SEVERITY_LOW,
+                             (std::stringstream() << "Unable to write " << cache_filename).str().c_str());
+         }
+
+         // use the contents as written, even if writing failed
+         model.Open(std::move(contents), stamp);
+      }
+
+      return model;
+   };
+
+   MeshCache::Mesh model;
+
    // read all the attributes of the model
    switch (mActiveModel)
    {
    case ActiveModel::ENTERPRISE:
-      ReadModel(R"(.\enterprise\Enterp TOS - Arena.3DS)");
+      model = LoadModel(R"(.\enterprise\Enterp TOS - Arena.3DS)");
 
       mLightProj.MakeOrtho(
          -80.0f, 80.0f,
@@ -932,7 +1086,7 @@ void ShadowMapWindow::GenerateEnterpriseE( )
       break;
 
    case ActiveModel::DEFIANT:
-      ReadModel(R"(.\DEFIANT\defiant.3ds)");
+      model = LoadModel(R"(.\DEFIANT\defiant.3ds)");
 
       mLightProj.MakeOrtho(
          -275.0f, 275.0f,
@@ -950,9 +1104,10 @@ void ShadowMapWindow::GenerateEnterpriseE( )
       break;
    }
 
-   // vertices size should match tangents and bitangents
-   WGL_ASSERT(vertices.size() == tangents.size());
-   WGL_ASSERT(vertices.size() == bitangents.size());
+   // start off by reading the textures of the materials
+   std::vector< std::shared_ptr< Texture > > unused_texs;
+   ReadTextures(std::vector< std::string >(model.Materials().cbegin(), model.Materials().cend()),
+                mpEnterpriseE->mDiffuse, unused_texs, unused_texs);
 
    // create the vao
    mpEnterpriseE->mVAO.GenArray();
@@ -966,42 +1121,36 @@ void ShadowMapWindow::GenerateEnterpriseE( )
       PostDebugMessage(GL_DEBUG_TYPE_ERROR, 2, GL_DEBUG_SEVERITY_HIGH, "Unable to generate VAO!!!");
    }
 
-   // create the vbos
+   // create the vbo straight from the cache, with the attributes interleaved
    mpEnterpriseE->mVertBuf.GenBuffer(GL_ARRAY_BUFFER);
    mpEnterpriseE->mVertBuf.Bind();
-   mpEnterpriseE->mVertBuf.BufferData(vertices.size() * sizeof(decltype(vertices.front())), &vertices.front(), GL_STATIC_DRAW);
-   mpEnterpriseE->mVertBuf.VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(decltype(vertices.front())) * 3, 0);
-   glEnableVertexAttribArray(0);
-   mpEnterpriseE->mVertBuf.Unbind();
+   mpEnterpriseE->mVertBuf.BufferData(model.NumVertices() * model.VertexStride(), model.Vertices(), GL_STATIC_DRAW);
+
+   for (const MeshCache::Attribute * pAttrib = model.Attributes(); pAttrib != model.Attributes() + model.NumAttributes(); ++pAttrib)
+   {
+      mpEnterpriseE->mVertBuf.VertexAttribPointer(pAttrib->location, pAttrib->components, pAttrib->type,
+                                                  pAttrib->normalized ? GL_TRUE : GL_FALSE,
+                                                  model.VertexStride(), pAttrib->offset);
+      glEnableVertexAttribArray(pAttrib->location);
+   }
 
-   mpEnterpriseE->mClrBuf.GenBuffer(GL_ARRAY_BUFFER);
-   mpEnterpriseE->mClrBuf.Bind();
-   mpEnterpriseE->mClrBuf.BufferData(colors.size() * sizeof(decltype(colors.front())), &colors.front(), GL_STATIC_DRAW);
-   mpEnterpriseE->mClrBuf.VertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(decltype(colors.front())) * 3, 0);
-   glEnableVertexAttribArray(1);
-   mpEnterpriseE->mClrBuf.Unbind();
-
-   mpEnterpriseE->mNormBuf.GenBuffer(GL_ARRAY_BUFFER);
-   mpEnterpriseE->mNormBuf.Bind();
-   mpEnterpriseE->mNormBuf.BufferData(normals.size() * sizeof(decltype(normals.front())), &normals.front(), GL_STATIC_DRAW);
-   mpEnterpriseE->mNormBuf.VertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(decltype(normals.front())) * 3, 0);
-   glEnableVertexAttribArray(2);
-   mpEnterpriseE->mNormBuf.Unbind();
-
-   mpEnterpriseE->mTexBuf.GenBuffer(GL_ARRAY_BUFFER);
-   mpEnterpriseE->mTexBuf.Bind();
-   mpEnterpriseE->mTexBuf.BufferData(tex_coords.size() * sizeof(decltype(tex_coords.front())), &tex_coords.front(), GL_STATIC_DRAW);
-   mpEnterpriseE->mTexBuf.VertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(decltype(tex_coords.front())) * 2, 0);
-   glEnableVertexAttribArray(3);
-   mpEnterpriseE->mTexBuf.Unbind();
+   mpEnterpriseE->mVertBuf.Unbind();
 
    // create the index buffer
    mpEnterpriseE->mIdxBuf.GenBuffer(GL_ELEMENT_ARRAY_BUFFER);
    mpEnterpriseE->mIdxBuf.Bind();
-   mpEnterpriseE->mIdxBuf.BufferData(indices.size() * sizeof(decltype(indices.front())), &indices.front(), GL_STATIC_DRAW);
+   mpEnterpriseE->mIdxBuf.BufferData(model.NumIndices() * model.IndexSize(), model.Indices(), GL_STATIC_DRAW);
+
+   mpEnterpriseE->mIndexType = model.IndexType();
+   mpEnterpriseE->mIndexSize = model.IndexSize();
 
    // make sure we save the render buckets to the model
-   mpEnterpriseE->mRenderBuckets = std::move(render_buckets);
+   for (const MeshCache::DrawRange * pRange = model.DrawRanges(); pRange != model.DrawRanges() + model.NumDrawRanges(); ++pRange)
+   {
+      mpEnterpriseE->mRenderBuckets.insert(
+         Renderable::RenderBucket::value_type(pRange->material,
+                                              Renderable::RenderBucket::mapped_type(pRange->first_index, pRange->num_indices)));
+   }
 
    // disable the vao
    mpEnterpriseE->mVAO.Unbind();
@@ -11,7 +11,9 @@ public:
             ParticleSystem( );
    virtual ~ParticleSystem( );
 
-   // updates the particles in the system
+   // updates the particles in the system...
+   // the manager updates the systems across its threads,
+   // so an update must only change the system itself
    virtual void Update( const SimFrame & simFrame ) = 0;
 
    // renders the particles in the system
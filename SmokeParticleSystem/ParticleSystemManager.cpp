@@ -1,11 +1,17 @@
 // local includes
 #include "ParticleSystemManager.h"
 
+#include "JobPool.h"
 #include "SimFrame.h"
 #include "ParticleSystem.h"
 
+// stl includes
+#include <algorithm>
+
 ParticleSystemManager::ParticleSystemManager( ) :
-FREE_INACTIVE_SYS_TIMEOUT_MS     ( 300000.0 )
+FREE_INACTIVE_SYS_TIMEOUT_MS     ( 300000.0 ),
+MAX_FREED_SYS_PER_FRAME          ( 16 ),
+UPDATE_JOBS_PER_THREAD           ( 8 )
 {
 }
 
@@ -16,92 +22,90 @@ ParticleSystemManager::~ParticleSystemManager( )
 
 void ParticleSystemManager::UpdateParticleSystems( const SimFrame & simFrame )
 {
-   ActivePartSysList::iterator itCur = mActivePartSys.begin();
-   ActivePartSysList::iterator itEnd = mActivePartSys.end();
+   // move the systems that are no longer active to the inactive list,
+   // keeping the active systems in the order they were added
+   const ActivePartSysVec::iterator itInactive =
+      std::stable_partition(mActivePartSys.begin(), mActivePartSys.end(),
+         [ ] ( ParticleSystem * pPartSys ) { return pPartSys->IsActive(); });
 
-   for (; itCur != itEnd;)
+   for (ActivePartSysVec::iterator itCur = itInactive; itCur != mActivePartSys.end(); ++itCur)
    {
-      // obtain the particle system
-      ParticleSystem * pPartSys = *itCur;
-      // make sure the particle system is active
-      if (!pPartSys->IsActive())
-      {
-         // remove the particle system
-         itCur = mActivePartSys.erase(itCur);
-         // create an inactive node
-         InactiveNode inNode =
-         {
-            simFrame.dCurTimeMS + FREE_INACTIVE_SYS_TIMEOUT_MS,
-            pPartSys
-         };
-         // add system to inactive list
-         mInactivePartSys.push_back(inNode);
-         // continue the process
-         continue;
-      }
-      else
+      // create an inactive node
+      const InactiveNode inNode =
       {
-         // update the particle system
-         pPartSys->Update(simFrame);
-      }
-
-      // increase the iterator
-      ++itCur;
+         simFrame.dCurTimeMS + FREE_INACTIVE_SYS_TIMEOUT_MS,
+         *itCur
+      };
+      // add system to inactive list
+      mInactivePartSys.push_back(inNode);
    }
+
+   mActivePartSys.erase(itInactive, mActivePartSys.end());
+
+   // the shared pool starts its threads on the first update rather than
+   // when the singleton is created during the crt initialization
+   JobPool & job_pool = JobPool::Shared();
+
+   // split the systems into several jobs per thread, so the threads that
+   // finish their systems first can steal from the ones with larger systems
+   const size_t num_systems = mActivePartSys.size();
+   const size_t grain_size =
+      std::max< size_t >(num_systems / (job_pool.NumThreads() * UPDATE_JOBS_PER_THREAD), 1);
+
+   job_pool.ParallelFor(num_systems, grain_size,
+      [ this, &simFrame ] ( const size_t begin, const size_t end )
+      {
+         for (size_t i = begin; i < end; ++i)
+         {
+            // update the particle system
+            mActivePartSys[i]->Update(simFrame);
+         }
+      });
 }
 
 void ParticleSystemManager::RenderParticleSystems( const SimFrame & simFrame )
 {
    // render all the active particle systems
-   ActivePartSysList::iterator itCur = mActivePartSys.begin();
-   ActivePartSysList::iterator itEnd = mActivePartSys.end();
-
-   for (; itCur != itEnd; ++itCur)
+   for (ParticleSystem * pPartSys : mActivePartSys)
    {
-      (*itCur)->Render(simFrame);
+      pPartSys->Render(simFrame);
    }
 
-   // remove inactive systems
-   if (!mInactivePartSys.empty())
+   // remove the inactive systems that timed out, a bounded batch per frame,
+   // in the order they became inactive
+   for (size_t freed = 0;
+        freed < MAX_FREED_SYS_PER_FRAME &&
+        !mInactivePartSys.empty() &&
+        mInactivePartSys.front().mSysTimeMS <= simFrame.dCurTimeMS;
+        ++freed)
    {
       // obtain the front system
-      InactivePartSysList::iterator itNode = mInactivePartSys.begin();;
-      // only remove one particle system per frame
-      if (itNode->mSysTimeMS <= simFrame.dCurTimeMS)
-      {
-         // release the system
-         itNode->mpPartSys->Release();
-         // delete the system
-         delete itNode->mpPartSys;
-         // remove the front from the system
-         mInactivePartSys.erase(itNode);
-      }
+      ParticleSystem * const pPartSys = mInactivePartSys.front().mpPartSys;
+      // release the system
+      pPartSys->Release();
+      // delete the system
+      delete pPartSys;
+      // remove the front from the system
+      mInactivePartSys.pop_front();
    }
 }
 
 void ParticleSystemManager::ReleaseAllParticleSystems( )
 {
+   for (ParticleSystem * pPartSys : mActivePartSys)
    {
-   ActivePartSysList::iterator itCur = mActivePartSys.begin();
-   ActivePartSysList::iterator itEnd = mActivePartSys.end();
-
-   for (; itCur != itEnd; ++itCur)
-   {
-      delete *itCur;
+      pPartSys->Release();
+      delete pPartSys;
    }
 
-   }
-
-   {
-   InactivePartSysList::iterator itCur = mInactivePartSys.begin();
-   InactivePartSysList::iterator itEnd = mInactivePartSys.begin();
-
-   for (; itCur != itEnd; ++itCur)
+   for (const InactiveNode & inNode : mInactivePartSys)
    {
-      delete itCur->mpPartSys;
+      inNode.mpPartSys->Release();
+      delete inNode.mpPartSys;
    }
 
-   }
+   mActivePartSys.clear();
+   mInactivePartSys.clear();
 }
 
 namespace CRTInit
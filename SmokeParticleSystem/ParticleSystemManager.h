@@ -3,11 +3,11 @@
 
 // local includes
 #include "Singleton.h"
-#include "ReuseAllocator.h"
 
 // stl includes
-#include <map>
-#include <list>
+#include <deque>
+#include <vector>
+#include <cstddef>
 
 // forward declarations
 class ParticleSystem;
@@ -22,7 +22,8 @@ public:
    // adds a particle system to the manager
    void  AddParticleSystem( ParticleSystem * pSystem );
 
-   // updates all the particle systems
+   // updates all the particle systems...
+   // the systems are independent, so they are updated across the threads
    void  UpdateParticleSystems( const SimFrame & simFrame );
 
    // renders all the particle systems
@@ -46,22 +47,22 @@ private:
    // private typedefs
    struct InactiveNode
    {
-      const double      mSysTimeMS;
+      double            mSysTimeMS;
       ParticleSystem *  mpPartSys;
    };
 
    // private typedefs
-   typedef std::list< ParticleSystem *, ReuseAllocator< ParticleSystem * > >
-           ActivePartSysList;
-   typedef std::list< InactiveNode, ReuseAllocator< InactiveNode > >
-           InactivePartSysList;
+   typedef std::vector< ParticleSystem * > ActivePartSysVec;
+   typedef std::deque< InactiveNode >      InactivePartSysDeque;
 
    // private member data
-   ActivePartSysList       mActivePartSys;
-   InactivePartSysList     mInactivePartSys;
+   ActivePartSysVec        mActivePartSys;
+   InactivePartSysDeque    mInactivePartSys;
 
    // const private member data
    const double         FREE_INACTIVE_SYS_TIMEOUT_MS;
+   const size_t         MAX_FREED_SYS_PER_FRAME;
+   const size_t         UPDATE_JOBS_PER_THREAD;
 
 };
 
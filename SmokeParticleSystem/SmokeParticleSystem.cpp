@@ -7,57 +7,46 @@
 #include <windows.h>
 
 // gl includes
+#include "GL/glew.h"
 #include <gl/gl.h>
 
-// std includes
-#include <fstream>
+// the smoke rises, slowed by the air, and lives for about four seconds
+static const float SMOKE_RATE = 40.0f;
+static const float SMOKE_LIFESPAN = 4.0f;
+static const float SMOKE_LIFESPAN_SPREAD = 1.0f;
+static const float SMOKE_FORCE[3] = { 0.0f, 0.6f, 0.0f };
+static const float SMOKE_DRAG = 0.5f;
 
-// templated functions
-template < class T > T SwapData16( const T & rT )
-{
-   // create a local type
-   T t;
-   // create a pointer to the reference
-   const char * pRefData = (const char *)&rT;
-   // create a pointer to the local type
-   char * pLocalData = (char *)&t;
-   // move the data to the little endian format
-   *pLocalData = *(pRefData + 1);
-   *(pLocalData + 1) = *pRefData;
-   // return the local type
-   return t;
-}
-
-template < class T > T SwapData32( const T & rT )
-{
-   // create a local type
-   T t;
-   // create a pointer to the reference
-   const char * pRefData = (const char *)&rT;
-   // create a pointer to the local type
-   char * pLocalData = (char *)&t;
-   // move the data to the little endian format
-   *pLocalData       = *(pRefData + 3);
-   *(pLocalData + 1) = *(pRefData + 2);
-   *(pLocalData + 2) = *(pRefData + 1);
-   *(pLocalData + 3) = *pRefData;
-   // return the local type
-   return t;
-}
+// the pool holds every particle that can be alive at once
+static const size_t SMOKE_CAPACITY =
+   static_cast< size_t >(SMOKE_RATE * (SMOKE_LIFESPAN + SMOKE_LIFESPAN_SPREAD)) + 1;
 
 SmokeParticleSystem::SmokeParticleSystem( ) :
 mActive           ( true ),
-mNextParticleDrop ( -1.0 )
+mParticles        ( SMOKE_CAPACITY )
 {
    // translate to the edge of the grid
    mLocalTransMat.MakeTranslation(10.0, 2.0, 0.0);
+
+   // the position follows the system as it updates
+   const ParticleEmitter emitter =
+   {
+      { 0.0f, 0.0f, 0.0f },
+      { 0.0f, 0.5f, 0.0f },
+      0.25f,
+      SMOKE_LIFESPAN,
+      SMOKE_LIFESPAN_SPREAD,
+      SMOKE_RATE
+   };
+
+   mEmitter = emitter;
 }
 
 SmokeParticleSystem::~SmokeParticleSystem( )
 {
 }
 
-void SmokeParticleSystem::Update( const SimFrame & /*simFrame*/ )
+void SmokeParticleSystem::Update( const SimFrame & simFrame )
 {
    // update the position of the system...
    // this will be controlled by the shape it is
@@ -71,9 +60,21 @@ void SmokeParticleSystem::Update( const SimFrame & /*simFrame*/ )
 
    // update the local rotation matrix
    mLocalRotMat *= yRotMat;
+
+   // the particles are born at the origin of the system in world space
+   const Matrixd world = mLocalRotMat * mLocalTransMat;
+
+   mEmitter.position[0] = static_cast< float >(world.mT[12]);
+   mEmitter.position[1] = static_cast< float >(world.mT[13]);
+   mEmitter.position[2] = static_cast< float >(world.mT[14]);
+
+   // advance the particles that are alive and emit the new ones
+   const float seconds = static_cast< float >(simFrame.dTimeDeltaMS / 1000.0);
+
+   mParticles.Update(mEmitter, seconds, SMOKE_FORCE, SMOKE_DRAG);
 }
 
-void SmokeParticleSystem::Render( const SimFrame & simFrame )
+void SmokeParticleSystem::Render( const SimFrame & /*simFrame*/ )
 {
    ////////////////////////////////////////////////////////
    // this defines the buildup of everything in sdt and osg
@@ -111,32 +112,54 @@ void SmokeParticleSystem::Render( const SimFrame & simFrame )
    // reset the color to white
    glColor3f(1.0f, 1.0f, 1.0f);
 
-   // this system will place a particle
-   // into the system every 0.25 seconds
-   if (simFrame.dCurTimeMS >= mNextParticleDrop)
-   {
-      // get the current modelview matrix
-      Matrixd mv;
-      glGetDoublev(GL_MODELVIEW_MATRIX, mv);
-
-      // add a particle to the system
-      Particle p;
-      p.dPosition[0] = static_cast< float >(mv.mT[12]);
-      p.dPosition[1] = static_cast< float >(mv.mT[13]);
-      p.dPosition[2] = static_cast< float >(mv.mT[14]);
+   ////////////////////////////////////////////////////////
+   // this defines the buildup of everything in sdt and osg
+   // before passing control off to the system
 
-      mParticles.push_back(p);
+   // restore the previous matrix
+   glPopMatrix();
 
-      // update next particle drop
-      mNextParticleDrop = simFrame.dCurTimeMS + 25.0;
-   }
+   ////////////////////////////////////////////////////////
 
    // only render if particles available
-   if (!mParticles.empty())
+   if (mParticles.Size())
    {
-      // make identity out of modelview
-      glPushMatrix();
-      glLoadIdentity();
+      // the first render creates the buffer the positions are streamed through,
+      // falling back to client memory if it cannot be created
+      if (!mRenderBuffer.IsCreated() && mRenderPositions.empty())
+      {
+         if (!mRenderBuffer.Create(GL_ARRAY_BUFFER, mParticles.Capacity() * 3 * sizeof(float)))
+         {
+            mRenderPositions.resize(mParticles.Capacity() * 3);
+         }
+      }
+
+      // the particles are in world space, so they are rendered
+      // with the modelview of the camera
+      const GLvoid * pVertices = nullptr;
+
+      if (mRenderBuffer.IsCreated())
+      {
+         // write the positions straight into the region of this frame
+         GLintptr offset = 0;
+
+         mRenderBuffer.BeginFrame();
+
+         float * const pPositions = reinterpret_cast< float * >(
+            mRenderBuffer.Allocate(mParticles.Size() * 3 * sizeof(float), sizeof(float), offset));
+
+         mParticles.CopyPositions(pPositions);
+
+         mRenderBuffer.Buffer().Bind();
+
+         pVertices = reinterpret_cast< const GLvoid * >(offset);
+      }
+      else
+      {
+         mParticles.CopyPositions(mRenderPositions.data());
+
+         pVertices = mRenderPositions.data();
+      }
 
       // enable vertex array
       glEnableClientState(GL_VERTEX_ARRAY);
@@ -144,132 +167,34 @@ void SmokeParticleSystem::Render( const SimFrame & simFrame )
       // setup vertex pointer
       glVertexPointer(3,
                       GL_FLOAT,
-                      sizeof(Particle),
-                      &(mParticles.front()));
+                      0,
+                      pVertices);
 
       // render the particles
       glDrawArrays(GL_POINTS,
                    0,
-                   static_cast< GLsizei >(mParticles.size()));
+                   static_cast< GLsizei >(mParticles.Size()));
 
       // disable vertex array
       glDisableClientState(GL_VERTEX_ARRAY);
 
-      // restore modelview matrix
-      glPopMatrix();
-   }
-
-   ////////////////////////////////////////////////////////
-   // this defines the buildup of everything in sdt and osg
-   // before passing control off to the system
-
-   // restore the previous matrix
-   glPopMatrix();
+      if (mRenderBuffer.IsCreated())
+      {
+         mRenderBuffer.Buffer().Unbind();
 
-   ////////////////////////////////////////////////////////
+         // fence the region once the draw that reads it is issued
+         mRenderBuffer.EndFrame();
+      }
+   }
 }
 
 void SmokeParticleSystem::Release( )
 {
+   // waits for the gpu to finish with the positions
+   mRenderBuffer.Destroy();
 }
 
 bool SmokeParticleSystem::IsActive( )
 {
    return mActive;
-}
-
-void SmokeParticleSystem::ReadRGBImage( const char * pFilename,
-                                        unsigned char ** pImage,
-                                        unsigned int & nWidth,
-                                        unsigned int & nHeight )
-{
-   // local structure
-   struct RGBHeader
-   {
-      short          nMagic;
-      char           nStorage;
-      char           nBpc;
-      unsigned short nDimension;
-      unsigned short nXSize;
-      unsigned short nYSize;
-      unsigned short nZSize;
-      long           nPixMin;
-      long           nPixMax;
-      char           nDummy[4];
-      char           nImageName[80];
-      long           nColorMap;
-      char           nDummy2[404];
-   };
-
-   // create a input file stream
-   std::ifstream fInputStream;
-   // open the stream
-   fInputStream.open(pFilename, std::ios_base::in | std::ios_base::binary);
-
-   // make sure the file is open
-   if (fInputStream.is_open())
-   {
-      // create a local header
-      RGBHeader rgbHeader;
-      // read the local header
-      fInputStream.read((char *)&rgbHeader, sizeof(rgbHeader));
-      // need to convert the header to little endian
-      rgbHeader.nMagic     = SwapData16(rgbHeader.nMagic);
-      rgbHeader.nDimension = SwapData16(rgbHeader.nDimension);
-      rgbHeader.nXSize     = SwapData16(rgbHeader.nXSize);
-      rgbHeader.nYSize     = SwapData16(rgbHeader.nYSize);
-      rgbHeader.nZSize     = SwapData16(rgbHeader.nZSize);
-      rgbHeader.nPixMin    = SwapData32(rgbHeader.nPixMin);
-      rgbHeader.nPixMax    = SwapData32(rgbHeader.nPixMax);
-      rgbHeader.nColorMap  = SwapData32(rgbHeader.nColorMap);
-      // dimensions of 3 or greater are valid
-      // bpc is only valid if it is a 1
-      // color map values of 0x00 are only valid
-      if (rgbHeader.nDimension >= 0x03 &&
-          rgbHeader.nBpc == 0x01       &&
-          rgbHeader.nColorMap == 0x00)
-      {
-         // determine the type of image format
-         if (rgbHeader.nStorage)
-         {
-            // not reading uncompressed rle rgb files
-         }
-         else
-         {
-            // determine the image size
-            unsigned int nImgSize = rgbHeader.nXSize * rgbHeader.nYSize;
-
-            // setup the image width and height
-            nWidth  = rgbHeader.nXSize;
-            nHeight = rgbHeader.nYSize;
-
-            // create a local image format
-            *pImage = new unsigned char[nImgSize * rgbHeader.nZSize];
-            // read in all the image data
-            fInputStream.read((char *)pImage, nImgSize * rgbHeader.nZSize);
-
-            // point to the components
-            unsigned char * pRed   = rgbHeader.nZSize >= 1 ? *pImage : NULL;
-            unsigned char * pGreen = rgbHeader.nZSize >= 2 ? *pImage + nImgSize : NULL;
-            unsigned char * pBlue  = rgbHeader.nZSize >= 3 ? *pImage + nImgSize * 2 : NULL;
-            unsigned char * pAlpha = rgbHeader.nZSize >= 4 ? *pImage + nImgSize * 3 : NULL;
-
-            // create a local pointer to the image
-            unsigned char * pTempImage = static_cast< unsigned char * >(*pImage);
-
-            // set the image data from the file
-            for (unsigned int i = 0; i < nImgSize; i++)
-            {
-               // set the image attributes
-               *(pTempImage++) = pBlue  ? *pBlue++  : 0xFF;
-               *(pTempImage++) = pGreen ? *pGreen++ : 0xFF;
-               *(pTempImage++) = pRed   ? *pRed++   : 0xFF;
-               *(pTempImage++) = pAlpha ? *pAlpha++ : 0xFF;
-            }
-         }
-      }
-
-      // close the input stream
-      fInputStream.close();
-   }
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 // local includes
 #include "Matrix.h"
+#include "ParticlePool.h"
+#include "StreamBuffer.h"
 #include "ParticleSystem.h"
 
 // stl includes
@@ -30,37 +32,25 @@ public:
    virtual bool IsActive( );
 
 private:
-   // private structs
-   // defines the particle type
-   struct Particle
-   {
-      float dPosition[3];
-      float dVelocity[3];
-      uint32_t nTextureUnit;
-      float dLifeSpan;
-   };
-
-   // private typedefs
-   typedef std::vector< Particle > ParticleVec;
-
    // prohibit copy constructor
             SmokeParticleSystem( const SmokeParticleSystem & );
    // prohibit copy operator
    SmokeParticleSystem & operator = ( const SmokeParticleSystem & );
 
-   // reads an rgb image from disk
-   void ReadRGBImage( const char * pFilename, unsigned char ** pImage,
-                      unsigned int & nWidth, unsigned int & nHeight );
-
    // private member variables
-   bool        mActive;
+   bool              mActive;
 
-   double      mNextParticleDrop;
+   Matrixd           mLocalRotMat;
+   Matrixd           mLocalTransMat;
 
-   Matrixd     mLocalRotMat;
-   Matrixd     mLocalTransMat;
+   // the particles live in world space, born at the origin of the system
+   ParticleEmitter   mEmitter;
+   ParticlePool      mParticles;
 
-   ParticleVec mParticles;
+   // the positions of the particles are streamed to the gpu each frame,
+   // or kept in client memory without persistently mapped buffers
+   StreamBuffer         mRenderBuffer;
+   std::vector< float > mRenderPositions;
 
 };
 
@@ -104,6 +104,10 @@ int SmokeParticleSystemWindow::Run( )
       }
    }
 
+   // the particle systems release gl resources,
+   // so release them while the context is still current
+   ShutdownSingletons();
+
    return appQuitVal;
 }
 
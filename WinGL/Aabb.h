@@ -0,0 +1,285 @@
+#ifndef _AABB_H_
+#define _AABB_H_
+
+// local includes
+#include "Vector.h"
+
+// std includes
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+// an axis aligned bounding box...
+// a default constructed box is empty, with its min above its max, so that
+// growing it by any point or box gives the bounds of just that point or box
+template < typename T >
+class Aabb
+{
+public:
+   // basic type of the class
+   typedef T type;
+
+   // constructors
+   Aabb( );
+   Aabb( const Vector< T, 3 > & min, const Vector< T, 3 > & max );
+
+   // the bounds of a sphere
+   static Aabb< T > FromSphere( const Vector< T, 3 > & center, const T & radius );
+
+   // indicates if the box bounds nothing
+   bool IsEmpty( ) const;
+
+   // grows the box to also bound the point or box
+   void Grow( const Vector< T, 3 > & point );
+   void Grow( const Aabb< T > & box );
+
+   // returns the center, the half extents and the area of the sides
+   Vector< T, 3 > GetCenter( ) const;
+   Vector< T, 3 > GetExtent( ) const;
+   T              GetSurfaceArea( ) const;
+
+   // indicates if the boxes overlap or the point or box is within this box
+   bool Intersects( const Aabb< T > & box ) const;
+   bool Contains( const Aabb< T > & box ) const;
+   bool Contains( const Vector< T, 3 > & point ) const;
+
+   // the squared distance from the point to the nearest point of the box,
+   // which is zero for points within the box
+   T DistanceSquared( const Vector< T, 3 > & point ) const;
+
+   // indicates if the sphere overlaps the box or the whole box is within it
+   bool IntersectsSphere( const Vector< T, 3 > & center, const T & radius ) const;
+   bool WithinSphere( const Vector< T, 3 > & center, const T & radius ) const;
+
+   // indicates if the ray enters the box before the max distance, setting the
+   // distance to where it enters...  the ray is given by its origin and the
+   // inverse of its direction, which can be infinite for axis aligned rays
+   bool IntersectsRay( const Vector< T, 3 > & origin,
+                       const Vector< T, 3 > & inv_direction,
+                       const T & max_distance,
+                       T & distance ) const;
+
+   Vector< T, 3 >    mMin;
+   Vector< T, 3 >    mMax;
+
+};
+
+template < typename T >
+inline Aabb< T >::Aabb( ) :
+mMin  ( std::numeric_limits< T >::max() ),
+mMax  ( std::numeric_limits< T >::lowest() )
+{
+}
+
+template < typename T >
+inline Aabb< T >::Aabb( const Vector< T, 3 > & min, const Vector< T, 3 > & max ) :
+mMin  ( min ),
+mMax  ( max )
+{
+}
+
+template < typename T >
+inline Aabb< T > Aabb< T >::FromSphere( const Vector< T, 3 > & center, const T & radius )
+{
+   return Aabb< T >(center - Vector< T, 3 >(radius), center + Vector< T, 3 >(radius));
+}
+
+template < typename T >
+inline bool Aabb< T >::IsEmpty( ) const
+{
+   return mMin[0] > mMax[0] || mMin[1] > mMax[1] || mMin[2] > mMax[2];
+}
+
+template < typename T >
+inline void Aabb< T >::Grow( const Vector< T, 3 > & point )
+{
+   for (int i = 0; i < 3; ++i)
+   {
+      mMin[i] = std::min(mMin[i], point[i]);
+      mMax[i] = std::max(mMax[i], point[i]);
+   }
+}
+
+template < typename T >
+inline void Aabb< T >::Grow( const Aabb< T > & box )
+{
+   for (int i = 0; i < 3; ++i)
+   {
+      mMin[i] = std::min(mMin[i], box.mMin[i]);
+      mMax[i] = std::max(mMax[i], box.mMax[i]);
+   }
+}
+
+template < typename T >
+inline Vector< T, 3 > Aabb< T >::GetCenter( ) const
+{
+   return (mMin + mMax) * static_cast< T >(0.5);
+}
+
+template < typename T >
+inline Vector< T, 3 > Aabb< T >::GetExtent( ) const
+{
+   return (mMax - mMin) * static_cast< T >(0.5);
+}
+
+template < typename T >
+inline T Aabb< T >::GetSurfaceArea( ) const
+{
+   if (IsEmpty()) return static_cast< T >(0);
+
+   const Vector< T, 3 > size = mMax - mMin;
+
+   return static_cast< T >(2) * (size[0] * size[1] + size[1] * size[2] + size[2] * size[0]);
+}
+
+template < typename T >
+inline bool Aabb< T >::Intersects( const Aabb< T > & box ) const
+{
+   return mMin[0] <= box.mMax[0] && box.mMin[0] <= mMax[0] &&
+          mMin[1] <= box.mMax[1] && box.mMin[1] <= mMax[1] &&
+          mMin[2] <= box.mMax[2] && box.mMin[2] <= mMax[2];
+}
+
+template < typename T >
+inline bool Aabb< T >::Contains( const Aabb< T > & box ) const
+{
+   return mMin[0] <= box.mMin[0] && box.mMax[0] <= mMax[0] &&
+          mMin[1] <= box.mMin[1] && box.mMax[1] <= mMax[1] &&
+          mMin[2] <= box.mMin[2] && box.mMax[2] <= mMax[2];
+}
+
+template < typename T >
+inline bool Aabb< T >::Contains( const Vector< T, 3 > & point ) const
+{
+   return mMin[0] <= point[0] && point[0] <= mMax[0] &&
+          mMin[1] <= point[1] && point[1] <= mMax[1] &&
+          mMin[2] <= point[2] && point[2] <= mMax[2];
+}
+
+template < typename T >
+inline T Aabb< T >::DistanceSquared( const Vector< T, 3 > & point ) const
+{
+   T distance = static_cast< T >(0);
+
+   for (int i = 0; i < 3; ++i)
+   {
+      const T d = std::max(std::max(mMin[i] - point[i], point[i] - mMax[i]), static_cast< T >(0));
+
+      distance += d * d;
+   }
+
+   return distance;
+}
+
+template < typename T >
+inline bool Aabb< T >::IntersectsSphere( const Vector< T, 3 > & center, const T & radius ) const
+{
+   return DistanceSquared(center) <= radius * radius;
+}
+
+template < typename T >
+inline bool Aabb< T >::WithinSphere( const Vector< T, 3 > & center, const T & radius ) const
+{
+   // the distance to the furthest corner of the box
+   T distance = static_cast< T >(0);
+
+   for (int i = 0; i < 3; ++i)
+   {
+      const T d = std::max(center[i] - mMin[i], mMax[i] - center[i]);
+
+      distance += d * d;
+   }
+
+   return distance <= radius * radius;
+}
+
+template < typename T >
+inline bool Aabb< T >::IntersectsRay( const Vector< T, 3 > & origin,
+                                      const Vector< T, 3 > & inv_direction,
+                                      const T & max_distance,
+                                      T & distance ) const
+{
+   T enter = static_cast< T >(0);
+   T leave = max_distance;
+
+   for (int i = 0; i < 3; ++i)
+   {
+      T t0 = (mMin[i] - origin[i]) * inv_direction[i];
+      T t1 = (mMax[i] - origin[i]) * inv_direction[i];
+
+      if (t0 > t1) std::swap(t0, t1);
+
+      // written so a nan from an origin on a slab of an axis aligned ray keeps the range
+      enter = t0 > enter ? t0 : enter;
+      leave = t1 < leave ? t1 : leave;
+
+      if (enter > leave) return false;
+   }
+
+   distance = enter;
+
+   return true;
+}
+
+namespace details
+{
+
+// collects the objects whose boxes are nearest a point...
+// the nearest found so far are kept in a heap with the furthest on top, so
+// a closer object replaces it once there are as many as were asked for
+template < typename T >
+class NearestBoxes
+{
+public:
+   explicit NearestBoxes( const size_t k ) :
+   mK ( k )
+   {
+      mNearest.reserve(k);
+   }
+
+   // the squared distance an object must be within to be one of the nearest
+   T Bound( ) const
+   {
+      return mNearest.size() < mK ? std::numeric_limits< T >::max() : mNearest.front().first;
+   }
+
+   void Add( const T & distance, const uint32_t object )
+   {
+      if (mNearest.size() < mK)
+      {
+         mNearest.emplace_back(distance, object);
+         std::push_heap(mNearest.begin(), mNearest.end());
+      }
+      else if (distance < mNearest.front().first)
+      {
+         std::pop_heap(mNearest.begin(), mNearest.end());
+         mNearest.back() = std::make_pair(distance, object);
+         std::push_heap(mNearest.begin(), mNearest.end());
+      }
+   }
+
+   // writes the objects, nearest first
+   void Sort( std::vector< uint32_t > & objects )
+   {
+      std::sort_heap(mNearest.begin(), mNearest.end());
+
+      objects.clear();
+
+      for (const auto & nearest : mNearest) objects.push_back(nearest.second);
+   }
+
+private:
+   const size_t                              mK;
+   std::vector< std::pair< T, uint32_t > >   mNearest;
+
+};
+
+} // namespace details
+
+// global typedefs
+typedef Aabb< float > Aabbf;
+typedef Aabb< double > Aabbd;
+
+#endif // _AABB_H_
@@ -0,0 +1,319 @@
+#ifndef _AFFINE3_H_
+#define _AFFINE3_H_
+
+// local includes
+#include "Simd.h"
+#include "Matrix.h"
+#include "Vector.h"
+#include "WglAssert.h"
+
+// std includes
+#include <algorithm>
+
+// crt includes
+#include <memory.h>
+
+// compact form of an affine Matrix< T >... the implied last row is
+// always 0, 0, 0, 1, so only the 3x3 linear part and the translation
+// are stored and the w row never has to be multiplied or divided by.
+// unlike Matrix< T > the storage is three rows of four values, with the
+// translation in the last column.  this keeps each row in one simd
+// register and matches the layout of three vec4 rows in a shader.
+template < typename T >
+class Affine3
+{
+public:
+   // basic type of the class
+   typedef T type;
+
+   // constructor / destructor
+    Affine3( );
+    Affine3( const T t[12] );
+    Affine3( const Vector< T, 3 > & col1, const Vector< T, 3 > & col2,
+             const Vector< T, 3 > & col3, const Vector< T, 3 > & translation );
+    explicit Affine3( const Matrix< T > & mat );
+
+   // operator * (post multiplication to conform to opengl)
+   Affine3< T > operator * ( const Affine3< T > & aff ) const;
+   Affine3< T > & operator *= ( const Affine3< T > & aff );
+
+   // transforms a point, which includes the translation
+   Vector< T, 3 > operator * ( const Vector< T, 3 > & point ) const;
+
+   // transforms a direction, which excludes the translation
+   Vector< T, 3 > TransformVector( const Vector< T, 3 > & vec ) const;
+
+   // operator == / !=
+   bool operator == ( const Affine3< T > & aff ) const;
+   bool operator != ( const Affine3< T > & aff ) const;
+
+   // creates an identity transform
+   void  MakeIdentity( );
+
+   // creates the basic transforms
+   static Affine3< T > Rotate( const T & degrees, const Vector< T, 3 > & vec );
+   static Affine3< T > Translate( const T & x, const T & y, const T & z );
+   static Affine3< T > Translate( const Vector< T, 3 > & vec );
+   static Affine3< T > Scale( const T & x, const T & y, const T & z );
+
+   // makes the inverse out of an
+   // assumed orthogonal linear part
+   void           MakeInverseFromOrthogonal( );
+   Affine3< T >   InverseFromOrthogonal( ) const;
+
+   // makes the inverse out of any
+   // invertible linear part
+   void           MakeInverse( );
+   Affine3< T >   Inverse( ) const;
+
+   // returns the determinant of the linear part
+   T  Determinant( ) const;
+
+   // returns the translation
+   Vector< T, 3 > GetTranslation( ) const;
+
+   // converts to the full 4x4 matrix
+   Matrix< T > ToMatrix( ) const;
+
+   // affine class should be simple and allow
+   // for easy acess to the member variables
+   T     mT[12];
+
+};
+
+template < typename T >
+inline Affine3< T >::Affine3( )
+{
+   MakeIdentity();
+}
+
+template < typename T >
+inline Affine3< T >::Affine3( const T t[12] )
+{
+   memcpy(mT, t, sizeof(mT));
+}
+
+template < typename T >
+inline Affine3< T >::Affine3( const Vector< T, 3 > & col1, const Vector< T, 3 > & col2,
+                              const Vector< T, 3 > & col3, const Vector< T, 3 > & translation )
+{
+   for (int i = 0; i < 3; ++i)
+   {
+      mT[i * 4 + 0] = col1.mT[i];
+      mT[i * 4 + 1] = col2.mT[i];
+      mT[i * 4 + 2] = col3.mT[i];
+      mT[i * 4 + 3] = translation.mT[i];
+   }
+}
+
+template < typename T >
+inline Affine3< T >::Affine3( const Matrix< T > & mat )
+{
+   // the last row is dropped, so it better be 0, 0, 0, 1
+   WGL_ASSERT(mat.IsAffine());
+
+   for (int i = 0; i < 3; ++i)
+   {
+      mT[i * 4 + 0] = mat.mT[i + 0];
+      mT[i * 4 + 1] = mat.mT[i + 4];
+      mT[i * 4 + 2] = mat.mT[i + 8];
+      mT[i * 4 + 3] = mat.mT[i + 12];
+   }
+}
+
+template < typename T >
+inline Affine3< T > Affine3< T >::operator * ( const Affine3< T > & aff ) const
+{
+   typedef simd::Vec4< T > V;
+
+   // each row of the result is a combination of the rows of the
+   // rhs, plus the translation of this row for the implied w row
+   const T w_row[] = { T(0), T(0), T(0), T(1) };
+
+   const V r0 = V::Load(aff.mT + 0);
+   const V r1 = V::Load(aff.mT + 4);
+   const V r2 = V::Load(aff.mT + 8);
+   const V r3 = V::Load(w_row);
+
+   T local_t[12];
+
+   for (int i = 0; i < 3; ++i)
+   {
+      const T * const pRow = mT + i * 4;
+
+      const V row = V::Splat(pRow[0]) * r0 + V::Splat(pRow[1]) * r1 + V::Splat(pRow[2]) * r2 + V::Splat(pRow[3]) * r3;
+
+      row.Store(local_t + i * 4);
+   }
+
+   return Affine3< T >(local_t);
+}
+
+template < typename T >
+inline Affine3< T > & Affine3< T >::operator *= ( const Affine3< T > & aff )
+{
+   *this = *this * aff;
+
+   return *this;
+}
+
+template < typename T >
+inline Vector< T, 3 > Affine3< T >::operator * ( const Vector< T, 3 > & point ) const
+{
+   const T * const pT = point.mT;
+
+   return Vector< T, 3 >(mT[0] * pT[0] + mT[1] * pT[1] + mT[2]  * pT[2] + mT[3],
+                         mT[4] * pT[0] + mT[5] * pT[1] + mT[6]  * pT[2] + mT[7],
+                         mT[8] * pT[0] + mT[9] * pT[1] + mT[10] * pT[2] + mT[11]);
+}
+
+template < typename T >
+inline Vector< T, 3 > Affine3< T >::TransformVector( const Vector< T, 3 > & vec ) const
+{
+   const T * const pT = vec.mT;
+
+   return Vector< T, 3 >(mT[0] * pT[0] + mT[1] * pT[1] + mT[2]  * pT[2],
+                         mT[4] * pT[0] + mT[5] * pT[1] + mT[6]  * pT[2],
+                         mT[8] * pT[0] + mT[9] * pT[1] + mT[10] * pT[2]);
+}
+
+template < typename T >
+inline bool Affine3< T >::operator == ( const Affine3< T > & aff ) const
+{
+   return std::equal(mT, mT + 12, aff.mT);
+}
+
+template < typename T >
+inline bool Affine3< T >::operator != ( const Affine3< T > & aff ) const
+{
+   return !(*this == aff);
+}
+
+template < typename T >
+inline void Affine3< T >::MakeIdentity( )
+{
+   memset(mT, 0x00, sizeof(mT));
+
+   mT[0] = mT[5] = mT[10] = static_cast< T >(1);
+}
+
+template < typename T >
+inline Affine3< T > Affine3< T >::Rotate( const T & degrees, const Vector< T, 3 > & vec )
+{
+   return Affine3< T >(Matrix< T >::Rotate(degrees, vec));
+}
+
+template < typename T >
+inline Affine3< T > Affine3< T >::Translate( const T & x, const T & y, const T & z )
+{
+   Affine3< T > aff;
+
+   aff.mT[3] = x; aff.mT[7] = y; aff.mT[11] = z;
+
+   return aff;
+}
+
+template < typename T >
+inline Affine3< T > Affine3< T >::Translate( const Vector< T, 3 > & vec )
+{
+   return Translate(vec.mT[0], vec.mT[1], vec.mT[2]);
+}
+
+template < typename T >
+inline Affine3< T > Affine3< T >::Scale( const T & x, const T & y, const T & z )
+{
+   Affine3< T > aff;
+
+   aff.mT[0] = x; aff.mT[5] = y; aff.mT[10] = z;
+
+   return aff;
+}
+
+template < typename T >
+inline void Affine3< T >::MakeInverseFromOrthogonal( )
+{
+   *this = InverseFromOrthogonal();
+}
+
+template < typename T >
+inline Affine3< T > Affine3< T >::InverseFromOrthogonal( ) const
+{
+   // the linear part is transposed and applied to the negated translation
+   const T local_t[] =
+   {
+      mT[0], mT[4], mT[8],  -(mT[0] * mT[3] + mT[4] * mT[7] + mT[8]  * mT[11]),
+      mT[1], mT[5], mT[9],  -(mT[1] * mT[3] + mT[5] * mT[7] + mT[9]  * mT[11]),
+      mT[2], mT[6], mT[10], -(mT[2] * mT[3] + mT[6] * mT[7] + mT[10] * mT[11])
+   };
+
+   return Affine3< T >(local_t);
+}
+
+template < typename T >
+inline void Affine3< T >::MakeInverse( )
+{
+   *this = Inverse();
+}
+
+template < typename T >
+inline Affine3< T > Affine3< T >::Inverse( ) const
+{
+   // the columns of the inverse are the cross products of the rows
+   const T c00 = mT[5] * mT[10] - mT[6] * mT[9];
+   const T c01 = mT[6] * mT[8]  - mT[4] * mT[10];
+   const T c02 = mT[4] * mT[9]  - mT[5] * mT[8];
+
+   const T det = mT[0] * c00 + mT[1] * c01 + mT[2] * c02;
+
+   // make sure there is an inverse
+   WGL_ASSERT(-0.0000000001 > det || 0.0000000001 < det);
+
+   const T one_over_det = static_cast< T >(1) / det;
+
+   T local_t[12];
+
+   local_t[0]  = c00 * one_over_det;
+   local_t[4]  = c01 * one_over_det;
+   local_t[8]  = c02 * one_over_det;
+   local_t[1]  = (mT[9] * mT[2] - mT[10] * mT[1]) * one_over_det;
+   local_t[5]  = (mT[10] * mT[0] - mT[8] * mT[2]) * one_over_det;
+   local_t[9]  = (mT[8] * mT[1] - mT[9] * mT[0]) * one_over_det;
+   local_t[2]  = (mT[1] * mT[6] - mT[2] * mT[5]) * one_over_det;
+   local_t[6]  = (mT[2] * mT[4] - mT[0] * mT[6]) * one_over_det;
+   local_t[10] = (mT[0] * mT[5] - mT[1] * mT[4]) * one_over_det;
+
+   local_t[3]  = -(local_t[0] * mT[3] + local_t[1] * mT[7] + local_t[2]  * mT[11]);
+   local_t[7]  = -(local_t[4] * mT[3] + local_t[5] * mT[7] + local_t[6]  * mT[11]);
+   local_t[11] = -(local_t[8] * mT[3] + local_t[9] * mT[7] + local_t[10] * mT[11]);
+
+   return Affine3< T >(local_t);
+}
+
+template < typename T >
+inline T Affine3< T >::Determinant( ) const
+{
+   return mT[0] * (mT[5] * mT[10] - mT[6] * mT[9]) +
+          mT[1] * (mT[6] * mT[8] - mT[4] * mT[10]) +
+          mT[2] * (mT[4] * mT[9] - mT[5] * mT[8]);
+}
+
+template < typename T >
+inline Vector< T, 3 > Affine3< T >::GetTranslation( ) const
+{
+   return Vector< T, 3 >(mT[3], mT[7], mT[11]);
+}
+
+template < typename T >
+inline Matrix< T > Affine3< T >::ToMatrix( ) const
+{
+   return Matrix< T >(mT[0], mT[4], mT[8],  static_cast< T >(0),
+                      mT[1], mT[5], mT[9],  static_cast< T >(0),
+                      mT[2], mT[6], mT[10], static_cast< T >(0),
+                      mT[3], mT[7], mT[11], static_cast< T >(1));
+}
+
+// global typedefs
+typedef Affine3< float > Affine3f;
+typedef Affine3< double > Affine3d;
+
+#endif // _AFFINE3_H_
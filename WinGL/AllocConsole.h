@@ -1,10 +1,10 @@
-#ifndef _ALLOC_CONSOLE_H_
-#define _ALLOC_CONSOLE_H_
-
-// allocates a debug console
-bool AllocateDebugConsole( );
-
-// determines if a debug console is attached
-bool DebugConsoleIsAttached( );
-
-#endif // _ALLOC_CONSOLE_H_
+#ifndef _ALLOC_CONSOLE_H_
+#define _ALLOC_CONSOLE_H_
+
+// allocates a debug console
+bool AllocateDebugConsole( );
+
+// determines if a debug console is attached
+bool DebugConsoleIsAttached( );
+
+#endif // _ALLOC_CONSOLE_H_
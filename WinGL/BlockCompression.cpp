@@ -0,0 +1,715 @@
+// local includes
+#include "BlockCompression.h"
+#include "WglAssert.h"
+#include "ParallelFor.h"
+
+// std includes
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <algorithm>
+
+namespace BlockCompression
+{
+
+namespace details
+{
+
+// minimum number of blocks handed to each thread
+const size_t BLOCK_GRAIN_SIZE = 1024;
+
+// times the color endpoints are fit again to the indices they picked
+const uint32_t NUM_COLOR_REFINEMENTS = 2;
+
+// a block of 4x4 texels, each expanded to rgba
+struct Block
+{
+   uint8_t     texels[16][4];
+};
+
+// copies the texels of the block at (x, y) in blocks, repeating
+// the last row and column of the image past its edges
+void LoadBlock( const uint8_t * const pPixels, const uint32_t width, const uint32_t height,
+                const uint32_t components, const uint32_t x, const uint32_t y, Block & block )
+{
+   for (uint32_t i = 0; i < 4; ++i)
+   {
+      const uint32_t row = std::min(y * 4 + i, height - 1);
+
+      for (uint32_t j = 0; j < 4; ++j)
+      {
+         const uint32_t column = std::min(x * 4 + j, width - 1);
+
+         const uint8_t * const pPixel = pPixels + (static_cast< size_t >(row) * width + column) * components;
+         uint8_t * const pTexel = block.texels[i * 4 + j];
+
+         pTexel[0] = pPixel[0];
+         pTexel[1] = components > 1 ? pPixel[1] : 0;
+         pTexel[2] = components > 2 ? pPixel[2] : 0;
+         pTexel[3] = components > 3 ? pPixel[3] : 255;
+      }
+   }
+}
+
+// writes the value into the block a byte at a time, lowest byte first
+template < typename T >
+inline void Store( const T value, uint8_t * const pBlock )
+{
+   for (size_t i = 0; i < sizeof(T); ++i) pBlock[i] = static_cast< uint8_t >(value >> (i * 8));
+}
+
+template < typename T >
+inline T Load( const uint8_t * const pBlock )
+{
+   T value = 0;
+
+   for (size_t i = 0; i < sizeof(T); ++i) value |= static_cast< T >(pBlock[i]) << (i * 8);
+
+   return value;
+}
+
+// expands the 5 and 6 bit components of a 5:6:5 color to 8 bits
+inline int32_t Expand5( const uint32_t value ) { return static_cast< int32_t >((value << 3) | (value >> 2)); }
+inline int32_t Expand6( const uint32_t value ) { return static_cast< int32_t >((value << 2) | (value >> 4)); }
+
+// rounds the 8 bit color to the nearest 5:6:5 color
+inline uint16_t Pack565( const float (& color)[3] )
+{
+   const auto Quantize = [ ] ( const float value, const float max ) -> uint32_t
+   {
+      return static_cast< uint32_t >(std::min(std::max(value * (max / 255.0f) + 0.5f, 0.0f), max));
+   };
+
+   return static_cast< uint16_t >((Quantize(color[0], 31.0f) << 11) | (Quantize(color[1], 63.0f) << 5) | Quantize(color[2], 31.0f));
+}
+
+// the colors a bc1 block picks from...
+// four color blocks interpolate two colors between the endpoints, and
+// three color blocks interpolate one with the fourth left transparent
+void ConstructPalette( const uint16_t c0, const uint16_t c1, const bool four_colors, int32_t (& palette)[4][3] )
+{
+   const int32_t e0[3] = { Expand5(c0 >> 11), Expand6((c0 >> 5) & 63), Expand5(c0 & 31) };
+   const int32_t e1[3] = { Expand5(c1 >> 11), Expand6((c1 >> 5) & 63), Expand5(c1 & 31) };
+
+   for (size_t i = 0; i < 3; ++i)
+   {
+      palette[0][i] = e0[i];
+      palette[1][i] = e1[i];
+
+      if (four_colors)
+      {
+         palette[2][i] = (2 * e0[i] + e1[i]) / 3;
+         palette[3][i] = (e0[i] + 2 * e1[i]) / 3;
+      }
+      else
+      {
+         palette[2][i] = (e0[i] + e1[i]) / 2;
+         palette[3][i] = 0;
+      }
+   }
+}
+
+// picks the palette color for each texel in the mask by where the texel
+// falls along the endpoints, the texels outside of it are transparent.
+// returns the squared error of the block.
+uint32_t SelectIndices( const Block & block, const uint32_t mask, const int32_t (& palette)[4][3],
+                        const uint32_t num_colors, uint32_t & indices )
+{
+   // the palette colors in order from the first endpoint to the second
+   const uint32_t FOUR_COLOR_ORDER[4] = { 0, 2, 3, 1 };
+   const uint32_t THREE_COLOR_ORDER[3] = { 0, 2, 1 };
+
+   const uint32_t * const pOrder = num_colors == 4 ? FOUR_COLOR_ORDER : THREE_COLOR_ORDER;
+
+   const int32_t direction[3] =
+   {
+      palette[1][0] - palette[0][0],
+      palette[1][1] - palette[0][1],
+      palette[1][2] - palette[0][2]
+   };
+
+   const int32_t length = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+   const float scale = length ? static_cast< float >(num_colors - 1) / length : 0.0f;
+
+   uint32_t error = 0;
+
+   indices = 0;
+
+   for (uint32_t t = 0; t < 16; ++t)
+   {
+      uint32_t index = 3;
+
+      if (mask >> t & 1)
+      {
+         const int32_t r = block.texels[t][0] - palette[0][0];
+         const int32_t g = block.texels[t][1] - palette[0][1];
+         const int32_t b = block.texels[t][2] - palette[0][2];
+
+         const float step = (r * direction[0] + g * direction[1] + b * direction[2]) * scale + 0.5f;
+
+         index = pOrder[std::min(static_cast< uint32_t >(std::max(step, 0.0f)), num_colors - 1)];
+
+         const int32_t dr = block.texels[t][0] - palette[index][0];
+         const int32_t dg = block.texels[t][1] - palette[index][1];
+         const int32_t db = block.texels[t][2] - palette[index][2];
+
+         error += static_cast< uint32_t >(dr * dr + dg * dg + db * db);
+      }
+
+      indices |= index << (t * 2);
+   }
+
+   return error;
+}
+
+// fits endpoints to the texels in the mask along their principal axis
+void FitEndpoints( const Block & block, const uint32_t mask, float (& e0)[3], float (& e1)[3] )
+{
+   float mean[3] = { };
+   float count = 0.0f;
+
+   for (uint32_t t = 0; t < 16; ++t)
+   {
+      if (mask >> t & 1)
+      {
+         for (size_t i = 0; i < 3; ++i) mean[i] += block.texels[t][i];
+
+         count += 1.0f;
+      }
+   }
+
+   for (size_t i = 0; i < 3; ++i) mean[i] /= count;
+
+   // the upper half of the covariance
+   float covariance[6] = { };
+
+   for (uint32_t t = 0; t < 16; ++t)
+   {
+      if (mask >> t & 1)
+      {
+         const float r = block.texels[t][0] - mean[0];
+         const float g = block.texels[t][1] - mean[1];
+         const float b = block.texels[t][2] - mean[2];
+
+         covariance[0] += r * r; covariance[1] += r * g; covariance[2] += r * b;
+         covariance[3] += g * g; covariance[4] += g * b; covariance[5] += b * b;
+      }
+   }
+
+   // a few power iterations find the axis closely enough for 5:6:5 endpoints
+   float axis[3] = { 1.0f, 1.0f, 1.0f };
+
+   for (size_t iteration = 0; iteration < 8; ++iteration)
+   {
+      const float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+      const float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+      const float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+
+      const float largest = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+
+      if (largest <= 0.0f) break;
+
+      axis[0] = x / largest; axis[1] = y / largest; axis[2] = z / largest;
+   }
+
+   const float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+
+   float low = 0.0f, high = 0.0f;
+
+   if (length > 0.0f)
+   {
+      for (size_t i = 0; i < 3; ++i) axis[i] /= length;
+
+      low = std::numeric_limits< float >::max();
+      high = -low;
+
+      for (uint32_t t = 0; t < 16; ++t)
+      {
+         if (mask >> t & 1)
+         {
+            const float projection =
+               (block.texels[t][0] - mean[0]) * axis[0] +
+               (block.texels[t][1] - mean[1]) * axis[1] +
+               (block.texels[t][2] - mean[2]) * axis[2];
+
+            low = std::min(low, projection);
+            high = std::max(high, projection);
+         }
+      }
+   }
+
+   for (size_t i = 0; i < 3; ++i)
+   {
+      e0[i] = mean[i] + axis[i] * high;
+      e1[i] = mean[i] + axis[i] * low;
+   }
+}
+
+// solves for the endpoints that best reproduce the texels with the picked
+// indices in the least squares sense.  returns false if they are degenerate.
+bool RefineEndpoints( const Block & block, const uint32_t mask, const uint32_t indices,
+                      const bool four_colors, float (& e0)[3], float (& e1)[3] )
+{
+   // the weight of the first endpoint for each index
+   const float FOUR_COLOR_WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+   const float THREE_COLOR_WEIGHTS[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+
+   const float * const pWeights = four_colors ? FOUR_COLOR_WEIGHTS : THREE_COLOR_WEIGHTS;
+
+   float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+   float ax[3] = { }, bx[3] = { };
+
+   for (uint32_t t = 0; t < 16; ++t)
+   {
+      if (mask >> t & 1)
+      {
+         const float a = pWeights[indices >> (t * 2) & 3];
+         const float b = 1.0f - a;
+
+         aa += a * a; ab += a * b; bb += b * b;
+
+         for (size_t i = 0; i < 3; ++i)
+         {
+            ax[i] += a * block.texels[t][i];
+            bx[i] += b * block.texels[t][i];
+         }
+      }
+   }
+
+   const float determinant = aa * bb - ab * ab;
+
+   if (std::fabs(determinant) < 1e-6f) return false;
+
+   for (size_t i = 0; i < 3; ++i)
+   {
+      e0[i] = (ax[i] * bb - bx[i] * ab) / determinant;
+      e1[i] = (bx[i] * aa - ax[i] * ab) / determinant;
+   }
+
+   return true;
+}
+
+// the pair of 5 or 6 bit endpoints whose first interpolated color is nearest
+// each 8 bit value, so a block of one color is stored almost exactly
+struct SingleColorTable
+{
+   uint8_t     endpoints[256][2];
+
+   explicit SingleColorTable( const uint32_t bits )
+   {
+      const uint32_t max = (1u << bits) - 1;
+
+      for (int32_t value = 0; value < 256; ++value)
+      {
+         int32_t nearest = std::numeric_limits< int32_t >::max();
+
+         for (uint32_t a = 0; a <= max; ++a)
+         {
+            for (uint32_t b = 0; b <= max; ++b)
+            {
+               const int32_t e0 = bits == 5 ? Expand5(a) : Expand6(a);
+               const int32_t e1 = bits == 5 ? Expand5(b) : Expand6(b);
+
+               const int32_t error = std::abs((2 * e0 + e1) / 3 - value);
+
+               if (error < nearest)
+               {
+                  nearest = error;
+                  endpoints[value][0] = static_cast< uint8_t >(a);
+                  endpoints[value][1] = static_cast< uint8_t >(b);
+               }
+            }
+         }
+      }
+   }
+};
+
+// stores a four color block of a single color with its texels on the first interpolated color
+void CompressSingleColor( const uint8_t (& color)[4], uint16_t & c0, uint16_t & c1, uint32_t & indices )
+{
+   static const SingleColorTable TABLE_5(5);
+   static const SingleColorTable TABLE_6(6);
+
+   c0 = static_cast< uint16_t >((TABLE_5.endpoints[color[0]][0] << 11) | (TABLE_6.endpoints[color[1]][0] << 5) | TABLE_5.endpoints[color[2]][0]);
+   c1 = static_cast< uint16_t >((TABLE_5.endpoints[color[0]][1] << 11) | (TABLE_6.endpoints[color[1]][1] << 5) | TABLE_5.endpoints[color[2]][1]);
+
+   indices = 0xaaaaaaaa;
+
+   // four color blocks need the first endpoint to be the larger
+   if (c0 < c1)
+   {
+      std::swap(c0, c1);
+      indices = 0xffffffff;
+   }
+   else if (c0 == c1)
+   {
+      indices = 0;
+   }
+}
+
+// compresses the colors of a bc1 block, or the color half of a bc3 block...
+// with punch through alpha, the texels under half alpha are made transparent
+void CompressColor( const Block & block, const bool punch_through, uint8_t * const pBlock )
+{
+   uint32_t opaque = 0xffff;
+
+   if (punch_through)
+   {
+      opaque = 0;
+
+      for (uint32_t t = 0; t < 16; ++t) opaque |= static_cast< uint32_t >(block.texels[t][3] >= 128) << t;
+   }
+
+   const bool four_colors = opaque == 0xffff;
+
+   // fully transparent blocks are three color blocks with only the fourth index
+   uint16_t c0 = 0, c1 = 0;
+   uint32_t indices = 0xffffffff;
+
+   bool solid = four_colors;
+
+   for (uint32_t t = 1; solid && t < 16; ++t)
+   {
+      solid = block.texels[t][0] == block.texels[0][0] &&
+              block.texels[t][1] == block.texels[0][1] &&
+              block.texels[t][2] == block.texels[0][2];
+   }
+
+   if (solid)
+   {
+      CompressSingleColor(block.texels[0], c0, c1, indices);
+   }
+   else if (opaque)
+   {
+      float e0[3], e1[3];
+      FitEndpoints(block, opaque, e0, e1);
+
+      uint32_t best_error = std::numeric_limits< uint32_t >::max();
+
+      for (uint32_t refinement = 0; refinement <= NUM_COLOR_REFINEMENTS; ++refinement)
+      {
+         uint16_t a = Pack565(e0), b = Pack565(e1);
+
+         // the order of the endpoints picks between four and three colors
+         if (four_colors ? a < b : a > b) std::swap(a, b);
+
+         int32_t palette[4][3];
+         ConstructPalette(a, b, four_colors, palette);
+
+         uint32_t candidate = 0;
+         const uint32_t error = SelectIndices(block, opaque, palette, four_colors ? 4 : 3, candidate);
+
+         if (error >= best_error) break;
+
+         best_error = error;
+         c0 = a; c1 = b; indices = candidate;
+
+         // the indices are for the endpoints as ordered, so the fit keeps that order
+         if (!error || !RefineEndpoints(block, opaque, candidate, four_colors, e0, e1)) break;
+      }
+   }
+
+   Store(c0, pBlock);
+   Store(c1, pBlock + 2);
+   Store(indices, pBlock + 4);
+}
+
+// the values a bc4 block picks from...
+// eight value blocks interpolate six values between the endpoints, and six
+// value blocks interpolate four with the last two fixed at 0 and 255
+void ConstructPalette( const uint32_t e0, const uint32_t e1, uint32_t (& palette)[8] )
+{
+   palette[0] = e0;
+   palette[1] = e1;
+
+   if (e0 > e1)
+   {
+      for (uint32_t i = 2; i < 8; ++i) palette[i] = ((8 - i) * e0 + (i - 1) * e1 + 3) / 7;
+   }
+   else
+   {
+      for (uint32_t i = 2; i < 6; ++i) palette[i] = ((6 - i) * e0 + (i - 1) * e1 + 2) / 5;
+
+      palette[6] = 0;
+      palette[7] = 255;
+   }
+}
+
+// picks the palette value for each texel by where it falls between the
+// endpoints, or at 0 or 255 in six value blocks.  returns the squared error.
+uint32_t SelectIndices( const uint8_t (& values)[16], const uint32_t (& palette)[8], uint64_t & indices )
+{
+   const int32_t e0 = static_cast< int32_t >(palette[0]);
+   const int32_t e1 = static_cast< int32_t >(palette[1]);
+
+   const bool eight_values = e0 > e1;
+   const int32_t steps = eight_values ? 7 : 5;
+   const float scale = e0 != e1 ? static_cast< float >(steps) / (e1 - e0) : 0.0f;
+
+   uint32_t error = 0;
+
+   indices = 0;
+
+   for (uint32_t t = 0; t < 16; ++t)
+   {
+      const int32_t value = values[t];
+
+      // the step from the first endpoint towards the second
+      const int32_t step = std::min(static_cast< int32_t >(std::max((value - e0) * scale + 0.5f, 0.0f)), steps);
+
+      uint64_t index = step == 0 ? 0 : step == steps ? 1 : step + 1;
+      int32_t difference = value - static_cast< int32_t >(palette[index]);
+
+      if (!eight_values)
+      {
+         // the fixed values may be nearer than the endpoints
+         const int32_t fixed = value < 128 ? value : value - 255;
+
+         if (std::abs(fixed) < std::abs(difference))
+         {
+            index = value < 128 ? 6 : 7;
+            difference = fixed;
+         }
+      }
+
+      error += static_cast< uint32_t >(difference * difference);
+      indices |= index << (t * 3);
+   }
+
+   return error;
+}
+
+// compresses a channel into a bc4 block...  the eight value block spans the
+// values, and blocks that reach 0 or 255 also try spanning the values between
+// with six values and taking the extremes from the fixed ones.
+void CompressChannel( const uint8_t (& values)[16], uint8_t * const pBlock )
+{
+   uint32_t low = 255, high = 0;
+   uint32_t inner_low = 255, inner_high = 0;
+
+   for (const uint8_t value : values)
+   {
+      low = std::min< uint32_t >(low, value);
+      high = std::max< uint32_t >(high, value);
+
+      if (value != 0 && value != 255)
+      {
+         inner_low = std::min< uint32_t >(inner_low, value);
+         inner_high = std::max< uint32_t >(inner_high, value);
+      }
+   }
+
+   uint32_t e0 = high, e1 = low;
+   uint64_t indices = 0;
+
+   if (low != high)
+   {
+      uint32_t palette[8];
+      ConstructPalette(e0, e1, palette);
+
+      uint32_t error = SelectIndices(values, palette, indices);
+
+      if (error && (low == 0 || high == 255))
+      {
+         if (inner_low > inner_high) inner_low = inner_high = low;
+
+         ConstructPalette(inner_low, inner_high, palette);
+
+         uint64_t candidate = 0;
+
+         if (SelectIndices(values, palette, candidate) < error)
+         {
+            e0 = inner_low; e1 = inner_high; indices = candidate;
+         }
+      }
+   }
+
+   pBlock[0] = static_cast< uint8_t >(e0);
+   pBlock[1] = static_cast< uint8_t >(e1);
+
+   for (size_t i = 0; i < 6; ++i) pBlock[2 + i] = static_cast< uint8_t >(indices >> (i * 8));
+}
+
+// compresses a component of the texels into a bc4 block
+void CompressChannel( const Block & block, const uint32_t component, uint8_t * const pBlock )
+{
+   uint8_t values[16];
+
+   for (uint32_t t = 0; t < 16; ++t) values[t] = block.texels[t][component];
+
+   CompressChannel(values, pBlock);
+}
+
+void DecompressColor( const uint8_t * const pBlock, const bool four_colors, Block & block )
+{
+   const uint16_t c0 = Load< uint16_t >(pBlock);
+   const uint16_t c1 = Load< uint16_t >(pBlock + 2);
+   const uint32_t indices = Load< uint32_t >(pBlock + 4);
+
+   // bc3 blocks always have four colors
+   const bool four = four_colors || c0 > c1;
+
+   int32_t palette[4][3];
+   ConstructPalette(c0, c1, four, palette);
+
+   for (uint32_t t = 0; t < 16; ++t)
+   {
+      const uint32_t index = indices >> (t * 2) & 3;
+
+      for (size_t i = 0; i < 3; ++i) block.texels[t][i] = static_cast< uint8_t >(palette[index][i]);
+
+      block.texels[t][3] = four || index != 3 ? 255 : 0;
+   }
+}
+
+void DecompressChannel( const uint8_t * const pBlock, const uint32_t component, Block & block )
+{
+   uint32_t palette[8];
+   ConstructPalette(pBlock[0], pBlock[1], palette);
+
+   uint64_t indices = 0;
+   for (size_t i = 0; i < 6; ++i) indices |= static_cast< uint64_t >(pBlock[2 + i]) << (i * 8);
+
+   for (uint32_t t = 0; t < 16; ++t)
+   {
+      block.texels[t][component] = static_cast< uint8_t >(palette[indices >> (t * 3) & 7]);
+   }
+}
+
+} // namespace details
+
+uint32_t BlockSize( const Format format )
+{
+   switch (format)
+   {
+   case Format::BC1:
+   case Format::BC4: return 8;
+   case Format::BC3:
+   case Format::BC5: return 16;
+   default: WGL_ASSERT(false); return 0;
+   }
+}
+
+size_t CompressedSize( const Format format, const uint32_t width, const uint32_t height )
+{
+   return static_cast< size_t >((width + 3) / 4) * ((height + 3) / 4) * BlockSize(format);
+}
+
+void Compress( const uint8_t * const pPixels,
+               const uint32_t width,
+               const uint32_t height,
+               const uint32_t components,
+               const Format format,
+               uint8_t * const pBlocks,
+               const bool parallel )
+{
+   WGL_ASSERT(pPixels && pBlocks && width && height);
+   WGL_ASSERT(components >= 1 && components <= 4);
+   WGL_ASSERT(components >= 3 || (format != Format::BC1 && format != Format::BC3));
+   WGL_ASSERT(components >= 2 || format != Format::BC5);
+
+   const uint32_t blocks_across = (width + 3) / 4;
+   const uint32_t blocks_down = (height + 3) / 4;
+   const uint32_t block_size = BlockSize(format);
+
+   // compresses a range of rows of blocks
+   const auto CompressRows = [ & ] ( const size_t begin, const size_t end )
+   {
+      details::Block block;
+
+      for (size_t y = begin; y < end; ++y)
+      {
+         uint8_t * pBlock = pBlocks + y * blocks_across * block_size;
+
+         for (uint32_t x = 0; x < blocks_across; ++x, pBlock += block_size)
+         {
+            details::LoadBlock(pPixels, width, height, components, x, static_cast< uint32_t >(y), block);
+
+            switch (format)
+            {
+            case Format::BC1:
+               details::CompressColor(block, components == 4, pBlock);
+               break;
+
+            case Format::BC3:
+               details::CompressChannel(block, 3, pBlock);
+               details::CompressColor(block, false, pBlock + 8);
+               break;
+
+            case Format::BC4:
+               details::CompressChannel(block, 0, pBlock);
+               break;
+
+            case Format::BC5:
+               details::CompressChannel(block, 0, pBlock);
+               details::CompressChannel(block, 1, pBlock + 8);
+               break;
+            }
+         }
+      }
+   };
+
+   if (parallel)
+   {
+      ParallelFor(blocks_down, std::max< size_t >(details::BLOCK_GRAIN_SIZE / blocks_across, 1), CompressRows);
+   }
+   else
+   {
+      CompressRows(0, blocks_down);
+   }
+}
+
+void Decompress( const uint8_t * const pBlocks,
+                 const uint32_t width,
+                 const uint32_t height,
+                 const Format format,
+                 uint8_t * const pPixels )
+{
+   WGL_ASSERT(pPixels && pBlocks && width && height);
+
+   const uint32_t blocks_across = (width + 3) / 4;
+   const uint32_t blocks_down = (height + 3) / 4;
+   const uint32_t block_size = BlockSize(format);
+
+   const uint8_t * pBlock = pBlocks;
+
+   for (uint32_t y = 0; y < blocks_down; ++y)
+   {
+      for (uint32_t x = 0; x < blocks_across; ++x, pBlock += block_size)
+      {
+         details::Block block = { };
+
+         switch (format)
+         {
+         case Format::BC1:
+            details::DecompressColor(pBlock, false, block);
+            break;
+
+         case Format::BC3:
+            details::DecompressColor(pBlock + 8, true, block);
+            details::DecompressChannel(pBlock, 3, block);
+            break;
+
+         case Format::BC4:
+         case Format::BC5:
+            details::DecompressChannel(pBlock, 0, block);
+            if (format == Format::BC5) details::DecompressChannel(pBlock + 8, 1, block);
+            for (auto & texel : block.texels) texel[3] = 255;
+            break;
+         }
+
+         // only the texels inside the image are written
+         for (uint32_t i = 0; i < 4 && y * 4 + i < height; ++i)
+         {
+            for (uint32_t j = 0; j < 4 && x * 4 + j < width; ++j)
+            {
+               uint8_t * const pPixel = pPixels + ((static_cast< size_t >(y) * 4 + i) * width + x * 4 + j) * 4;
+
+               std::copy(block.texels[i * 4 + j], block.texels[i * 4 + j] + 4, pPixel);
+            }
+         }
+      }
+   }
+}
+
+} // namespace BlockCompression
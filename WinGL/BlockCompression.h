@@ -0,0 +1,52 @@
+#ifndef _BLOCK_COMPRESSION_H_
+#define _BLOCK_COMPRESSION_H_
+
+// std includes
+#include <cstddef>
+#include <cstdint>
+
+// cpu encoders and decoders for the block compressed texture formats.  the
+// image is split into blocks of 4x4 texels, and the blocks on the right and
+// bottom edges of images that are not a multiple of 4 repeat their last texel.
+namespace BlockCompression
+{
+
+// formats of the compressed blocks
+enum class Format : uint32_t
+{
+   BC1,     // dxt1, rgb with 1 bit alpha in 8 bytes
+   BC3,     // dxt5, rgb with a bc4 alpha in 16 bytes
+   BC4,     // rgtc1, one channel in 8 bytes
+   BC5      // rgtc2, two bc4 channels in 16 bytes, for tangent space normals
+};
+
+// bytes in a block of 4x4 texels
+uint32_t BlockSize( const Format format );
+
+// bytes taken by an image compressed in the format
+size_t CompressedSize( const Format format, const uint32_t width, const uint32_t height );
+
+// compresses 8 bit pixels of 1 to 4 components...
+// bc1 and bc3 take 3 or 4 components, bc4 the first component and bc5 the
+// first two.  bc1 blocks with texels under half alpha are stored with 3
+// colors and a transparent texel.  the rows of blocks are split across the
+// hardware threads when parallel.
+void Compress( const uint8_t * const pPixels,
+               const uint32_t width,
+               const uint32_t height,
+               const uint32_t components,
+               const Format format,
+               uint8_t * const pBlocks,
+               const bool parallel = false );
+
+// decompresses the blocks into rgba pixels.  bc4 decodes to red and bc5 to
+// red and green, with the other colors 0 and the alpha 255.
+void Decompress( const uint8_t * const pBlocks,
+                 const uint32_t width,
+                 const uint32_t height,
+                 const Format format,
+                 uint8_t * const pPixels );
+
+} // namespace BlockCompression
+
+#endif // _BLOCK_COMPRESSION_H_
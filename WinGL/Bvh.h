@@ -0,0 +1,573 @@
+#ifndef _BVH_H_
+#define _BVH_H_
+
+// local includes
+#include "Aabb.h"
+#include "Vector.h"
+#include "Frustum.h"
+#include "WglAssert.h"
+
+// std includes
+#include <limits>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+// a bounding volume hierarchy over the boxes of a set of objects...
+// the tree is built once with the surface area heuristic and refit as the
+// objects move, which keeps it valid though it grows looser the further the
+// objects move from where it was built.  the nodes are stored depth first in
+// one array, a node's left child directly after it, and the boxes of the
+// objects are stored in the order of the leaves, so the queries walk memory
+// mostly forward.  objects are identified by their index in the built boxes.
+template < typename T >
+class Bvh
+{
+public:
+   // basic type of the class
+   typedef T type;
+
+   // returned by the ray queries when nothing is hit
+   static constexpr uint32_t NO_OBJECT = static_cast< uint32_t >(-1);
+
+   // most objects in a leaf
+   static constexpr uint32_t MAX_LEAF_SIZE = 4;
+
+   // constructor
+   Bvh( );
+
+   // builds the tree over the boxes, object i is bounded by boxes[i]
+   void Build( const Aabb< T > * const pBoxes, const size_t count );
+   void Build( const std::vector< Aabb< T > > & boxes ) { Build(boxes.data(), boxes.size()); }
+
+   // number of objects and nodes in the tree
+   size_t NumObjects( ) const { return mBoxes.size(); }
+   size_t NumNodes( ) const { return mNodes.size(); }
+
+   // the bounds of all the objects
+   Aabb< T > GetBounds( ) const { return mNodes.empty() ? Aabb< T >() : mNodes[0].bounds; }
+
+   // the box of an object
+   const Aabb< T > & GetBox( const uint32_t object ) const { return mBoxes[mSlots[object]]; }
+
+   // moves an object, refit must be called before the tree is queried again
+   void Move( const uint32_t object, const Aabb< T > & box ) { mBoxes[mSlots[object]] = box; }
+
+   // recomputes the bounds of the nodes from the boxes of the objects
+   void Refit( );
+
+   // calls fn(object) for each object whose box overlaps the box, sphere or frustum
+   template < typename Fn >
+   void QueryBox( const Aabb< T > & box, Fn && fn ) const;
+   template < typename Fn >
+   void QuerySphere( const Vector< T, 3 > & center, const T & radius, Fn && fn ) const;
+   template < typename Fn >
+   void QueryFrustum( const Frustum< T > & frustum, Fn && fn ) const;
+
+   // finds the nearest object along the ray within the distance, returning
+   // the object or NO_OBJECT and setting the distance to the hit...
+   // intersect(object, distance) tests an object whose box the ray enters,
+   // and when it hits the object closer than the distance it returns true
+   // and sets the distance to the hit.  the overload without intersect hits
+   // the boxes of the objects.
+   template < typename Fn >
+   uint32_t QueryRay( const Vector< T, 3 > & origin,
+                      const Vector< T, 3 > & direction,
+                      T & distance,
+                      Fn && intersect ) const;
+   uint32_t QueryRay( const Vector< T, 3 > & origin,
+                      const Vector< T, 3 > & direction,
+                      T & distance ) const;
+
+   // finds the k objects whose boxes are nearest the point, nearest first
+   void QueryNearest( const Vector< T, 3 > & point,
+                      const size_t k,
+                      std::vector< uint32_t > & objects ) const;
+
+private:
+   // a node of the tree...  a leaf holds count objects starting at first,
+   // an inner node has a count of zero, its left child follows it and its
+   // right child is at first
+   struct Node
+   {
+      Aabb< T >   bounds;
+      uint32_t    first;
+      uint32_t    count;
+   };
+
+   // bins the centroids are sorted into along an axis to find a split
+   static constexpr uint32_t NUM_BINS = 16;
+
+   // depth past which the nodes are split at the median, which bounds the
+   // depth of the tree for the fixed size stacks of the queries
+   static constexpr uint32_t MEDIAN_DEPTH = 32;
+   static constexpr uint32_t MAX_DEPTH = 64;
+
+   // builds the node for the objects in [first, first + count), returning its index
+   uint32_t BuildNode( const Aabb< T > * const pBoxes,
+                       const std::vector< Vector< T, 3 > > & centroids,
+                       const uint32_t first,
+                       const uint32_t count,
+                       const uint32_t depth );
+
+   // calls fn(object) for each object whose box passes the test, skipping
+   // the nodes whose bounds fail it...  the objects of the nodes whose bounds
+   // pass the contains test are all within the query, so are not tested
+   template < typename Test, typename Contains, typename Fn >
+   void Query( Test && test, Contains && contains, Fn && fn ) const;
+
+   std::vector< Node >        mNodes;
+
+   // the boxes in the order of the leaves, the object in each slot
+   // of the leaves, and the slot of each object
+   std::vector< Aabb< T > >   mBoxes;
+   std::vector< uint32_t >    mObjects;
+   std::vector< uint32_t >    mSlots;
+
+};
+
+template < typename T >
+inline Bvh< T >::Bvh( )
+{
+}
+
+template < typename T >
+inline void Bvh< T >::Build( const Aabb< T > * const pBoxes, const size_t count )
+{
+   WGL_ASSERT(count < NO_OBJECT);
+
+   mNodes.clear();
+   mObjects.resize(count);
+
+   std::vector< Vector< T, 3 > > centroids(count);
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      mObjects[i] = static_cast< uint32_t >(i);
+      centroids[i] = pBoxes[i].GetCenter();
+   }
+
+   if (count)
+   {
+      mNodes.reserve(2 * count / MAX_LEAF_SIZE + 1);
+
+      BuildNode(pBoxes, centroids, 0, static_cast< uint32_t >(count), 0);
+   }
+
+   mBoxes.resize(count);
+   mSlots.resize(count);
+
+   for (size_t slot = 0; slot < count; ++slot)
+   {
+      mBoxes[slot] = pBoxes[mObjects[slot]];
+      mSlots[mObjects[slot]] = static_cast< uint32_t >(slot);
+   }
+}
+
+template < typename T >
+inline uint32_t Bvh< T >::BuildNode( const Aabb< T > * const pBoxes,
+                                     const std::vector< Vector< T, 3 > > & centroids,
+                                     const uint32_t first,
+                                     const uint32_t count,
+                                     const uint32_t depth )
+{
+   const uint32_t index = static_cast< uint32_t >(mNodes.size());
+
+   mNodes.emplace_back();
+
+   Aabb< T > bounds;
+   Aabb< T > centroid_bounds;
+
+   for (uint32_t i = first; i < first + count; ++i)
+   {
+      bounds.Grow(pBoxes[mObjects[i]]);
+      centroid_bounds.Grow(centroids[mObjects[i]]);
+   }
+
+   if (count <= MAX_LEAF_SIZE)
+   {
+      mNodes[index].bounds = bounds;
+      mNodes[index].first = first;
+      mNodes[index].count = count;
+
+      return index;
+   }
+
+   uint32_t * const pFirst = mObjects.data() + first;
+   uint32_t * const pLast = pFirst + count;
+   uint32_t * pMiddle = nullptr;
+
+   // the axis the centroids are spread the furthest along
+   const Vector< T, 3 > spread = centroid_bounds.mMax - centroid_bounds.mMin;
+   const int widest = spread[0] >= spread[1] ? (spread[0] >= spread[2] ? 0 : 2) : (spread[1] >= spread[2] ? 1 : 2);
+
+   if (depth < MEDIAN_DEPTH && spread[widest] > static_cast< T >(0))
+   {
+      // finds the split between bins with the least cost, where the cost of a
+      // child is the chance a ray through the node hits it, the ratio of the
+      // surface areas, times the objects in it
+      struct Bin
+      {
+         Aabb< T >   bounds;
+         uint32_t    count;
+      };
+
+      int best_axis = -1;
+      uint32_t best_bin = 0;
+      T best_cost = std::numeric_limits< T >::max();
+
+      for (int axis = 0; axis < 3; ++axis)
+      {
+         if (spread[axis] <= static_cast< T >(0)) continue;
+
+         const T scale = static_cast< T >(NUM_BINS) / spread[axis];
+
+         Bin bins[NUM_BINS] = { };
+
+         for (const uint32_t * pObject = pFirst; pObject != pLast; ++pObject)
+         {
+            const T offset = (centroids[*pObject][axis] - centroid_bounds.mMin[axis]) * scale;
+            const uint32_t bin = std::min(static_cast< uint32_t >(offset), NUM_BINS - 1);
+
+            bins[bin].bounds.Grow(pBoxes[*pObject]);
+            ++bins[bin].count;
+         }
+
+         // the area and count of the right side of each split, swept from the right
+         T right_area[NUM_BINS] = { };
+         uint32_t right_count[NUM_BINS] = { };
+
+         Aabb< T > right;
+         uint32_t num_right = 0;
+
+         for (uint32_t bin = NUM_BINS - 1; bin > 0; --bin)
+         {
+            right.Grow(bins[bin].bounds);
+            num_right += bins[bin].count;
+
+            right_area[bin - 1] = right.GetSurfaceArea();
+            right_count[bin - 1] = num_right;
+         }
+
+         Aabb< T > left;
+         uint32_t num_left = 0;
+
+         for (uint32_t bin = 0; bin < NUM_BINS - 1; ++bin)
+         {
+            left.Grow(bins[bin].bounds);
+            num_left += bins[bin].count;
+
+            if (!num_left || !right_count[bin]) continue;
+
+            const T cost = left.GetSurfaceArea() * num_left + right_area[bin] * right_count[bin];
+
+            if (cost < best_cost)
+            {
+               best_axis = axis;
+               best_bin = bin;
+               best_cost = cost;
+            }
+         }
+      }
+
+      if (best_axis >= 0)
+      {
+         const T scale = static_cast< T >(NUM_BINS) / spread[best_axis];
+         const T min = centroid_bounds.mMin[best_axis];
+
+         pMiddle = std::partition(pFirst, pLast,
+            [ & ] ( const uint32_t object )
+            {
+               const T offset = (centroids[object][best_axis] - min) * scale;
+
+               return std::min(static_cast< uint32_t >(offset), NUM_BINS - 1) <= best_bin;
+            });
+      }
+   }
+
+   if (!pMiddle)
+   {
+      // the centroids all lie together or the tree is getting deep, so split in half
+      pMiddle = pFirst + count / 2;
+
+      std::nth_element(pFirst, pMiddle, pLast,
+         [ & ] ( const uint32_t a, const uint32_t b )
+         {
+            return centroids[a][widest] < centroids[b][widest];
+         });
+   }
+
+   const uint32_t num_left = static_cast< uint32_t >(pMiddle - pFirst);
+
+   BuildNode(pBoxes, centroids, first, num_left, depth + 1);
+
+   const uint32_t right = BuildNode(pBoxes, centroids, first + num_left, count - num_left, depth + 1);
+
+   mNodes[index].bounds = bounds;
+   mNodes[index].first = right;
+   mNodes[index].count = 0;
+
+   return index;
+}
+
+template < typename T >
+inline void Bvh< T >::Refit( )
+{
+   // the children always follow their parent, so walking back refits them first
+   for (size_t index = mNodes.size(); index-- > 0; )
+   {
+      Node & node = mNodes[index];
+
+      Aabb< T > bounds;
+
+      if (node.count)
+      {
+         for (uint32_t slot = node.first; slot < node.first + node.count; ++slot)
+         {
+            bounds.Grow(mBoxes[slot]);
+         }
+      }
+      else
+      {
+         bounds.Grow(mNodes[index + 1].bounds);
+         bounds.Grow(mNodes[node.first].bounds);
+      }
+
+      node.bounds = bounds;
+   }
+}
+
+template < typename T >
+template < typename Test, typename Contains, typename Fn >
+inline void Bvh< T >::Query( Test && test, Contains && contains, Fn && fn ) const
+{
+   if (mNodes.empty()) return;
+
+   uint32_t stack[MAX_DEPTH + 1];
+   uint32_t size = 0;
+
+   stack[size++] = 0;
+
+   while (size)
+   {
+      const uint32_t index = stack[--size];
+      const Node & node = mNodes[index];
+
+      if (!test(node.bounds)) continue;
+
+      if (contains(node.bounds))
+      {
+         // the slots of a subtree run from those of its leftmost leaf to
+         // those of its rightmost leaf
+         uint32_t leftmost = index;
+         uint32_t rightmost = index;
+
+         while (!mNodes[leftmost].count) ++leftmost;
+         while (!mNodes[rightmost].count) rightmost = mNodes[rightmost].first;
+
+         const uint32_t end = mNodes[rightmost].first + mNodes[rightmost].count;
+
+         for (uint32_t slot = mNodes[leftmost].first; slot < end; ++slot)
+         {
+            fn(mObjects[slot]);
+         }
+      }
+      else if (node.count)
+      {
+         for (uint32_t slot = node.first; slot < node.first + node.count; ++slot)
+         {
+            if (test(mBoxes[slot])) fn(mObjects[slot]);
+         }
+      }
+      else
+      {
+         stack[size++] = node.first;
+         stack[size++] = index + 1;
+      }
+   }
+}
+
+template < typename T >
+template < typename Fn >
+inline void Bvh< T >::QueryBox( const Aabb< T > & box, Fn && fn ) const
+{
+   Query([ & ] ( const Aabb< T > & bounds ) { return bounds.Intersects(box); },
+         [ & ] ( const Aabb< T > & bounds ) { return box.Contains(bounds); }, fn);
+}
+
+template < typename T >
+template < typename Fn >
+inline void Bvh< T >::QuerySphere( const Vector< T, 3 > & center, const T & radius, Fn && fn ) const
+{
+   Query([ & ] ( const Aabb< T > & bounds ) { return bounds.IntersectsSphere(center, radius); },
+         [ & ] ( const Aabb< T > & bounds ) { return bounds.WithinSphere(center, radius); }, fn);
+}
+
+template < typename T >
+template < typename Fn >
+inline void Bvh< T >::QueryFrustum( const Frustum< T > & frustum, Fn && fn ) const
+{
+   Query([ & ] ( const Aabb< T > & bounds ) { return frustum.IntersectsBox(bounds.mMin, bounds.mMax); },
+         [ & ] ( const Aabb< T > & bounds ) { return frustum.ContainsBox(bounds.mMin, bounds.mMax); }, fn);
+}
+
+template < typename T >
+template < typename Fn >
+inline uint32_t Bvh< T >::QueryRay( const Vector< T, 3 > & origin,
+                                    const Vector< T, 3 > & direction,
+                                    T & distance,
+                                    Fn && intersect ) const
+{
+   uint32_t hit = NO_OBJECT;
+
+   if (mNodes.empty()) return hit;
+
+   const Vector< T, 3 > inv_direction(static_cast< T >(1) / direction[0],
+                                      static_cast< T >(1) / direction[1],
+                                      static_cast< T >(1) / direction[2]);
+
+   // the nodes to visit and where the ray enters them
+   struct Entry
+   {
+      uint32_t    index;
+      T           enter;
+   };
+
+   Entry stack[MAX_DEPTH + 1];
+   uint32_t size = 0;
+
+   T enter = static_cast< T >(0);
+
+   if (mNodes[0].bounds.IntersectsRay(origin, inv_direction, distance, enter))
+   {
+      stack[size++] = { 0, enter };
+   }
+
+   while (size)
+   {
+      const Entry entry = stack[--size];
+
+      // a closer hit may have been found since the node was pushed
+      if (entry.enter > distance) continue;
+
+      const Node & node = mNodes[entry.index];
+
+      if (node.count)
+      {
+         for (uint32_t slot = node.first; slot < node.first + node.count; ++slot)
+         {
+            if (mBoxes[slot].IntersectsRay(origin, inv_direction, distance, enter) &&
+                intersect(mObjects[slot], distance))
+            {
+               hit = mObjects[slot];
+            }
+         }
+      }
+      else
+      {
+         // the nearer child is pushed last so it is visited first
+         Entry children[2] = { { entry.index + 1, static_cast< T >(0) }, { node.first, static_cast< T >(0) } };
+
+         const bool hits[2] =
+         {
+            mNodes[children[0].index].bounds.IntersectsRay(origin, inv_direction, distance, children[0].enter),
+            mNodes[children[1].index].bounds.IntersectsRay(origin, inv_direction, distance, children[1].enter)
+         };
+
+         const int nearer = hits[0] && hits[1] ? (children[1].enter < children[0].enter ? 1 : 0) : (hits[1] ? 1 : 0);
+
+         if (hits[nearer ^ 1]) stack[size++] = children[nearer ^ 1];
+         if (hits[nearer]) stack[size++] = children[nearer];
+      }
+   }
+
+   return hit;
+}
+
+template < typename T >
+inline uint32_t Bvh< T >::QueryRay( const Vector< T, 3 > & origin,
+                                    const Vector< T, 3 > & direction,
+                                    T & distance ) const
+{
+   const Vector< T, 3 > inv_direction(static_cast< T >(1) / direction[0],
+                                      static_cast< T >(1) / direction[1],
+                                      static_cast< T >(1) / direction[2]);
+
+   return QueryRay(origin, direction, distance,
+      [ & ] ( const uint32_t object, T & max_distance )
+      {
+         T enter = static_cast< T >(0);
+
+         if (GetBox(object).IntersectsRay(origin, inv_direction, max_distance, enter) && enter < max_distance)
+         {
+            max_distance = enter;
+
+            return true;
+         }
+
+         return false;
+      });
+}
+
+template < typename T >
+inline void Bvh< T >::QueryNearest( const Vector< T, 3 > & point,
+                                    const size_t k,
+                                    std::vector< uint32_t > & objects ) const
+{
+   objects.clear();
+
+   if (mNodes.empty() || !k) return;
+
+   details::NearestBoxes< T > nearest(k);
+
+   // the nodes to visit as a heap with the nearest on top
+   std::vector< std::pair< T, uint32_t > > nodes;
+   const auto Further = [ ] ( const std::pair< T, uint32_t > & a, const std::pair< T, uint32_t > & b ) { return a.first > b.first; };
+
+   nodes.emplace_back(mNodes[0].bounds.DistanceSquared(point), 0);
+
+   while (!nodes.empty())
+   {
+      std::pop_heap(nodes.begin(), nodes.end(), Further);
+
+      const std::pair< T, uint32_t > entry = nodes.back();
+      nodes.pop_back();
+
+      // every node left is further than the furthest of the nearest
+      if (entry.first >= nearest.Bound()) break;
+
+      const Node & node = mNodes[entry.second];
+
+      if (node.count)
+      {
+         for (uint32_t slot = node.first; slot < node.first + node.count; ++slot)
+         {
+            nearest.Add(mBoxes[slot].DistanceSquared(point), mObjects[slot]);
+         }
+      }
+      else
+      {
+         const uint32_t children[2] = { entry.second + 1, node.first };
+
+         for (const uint32_t child : children)
+         {
+            const T distance = mNodes[child].bounds.DistanceSquared(point);
+
+            if (distance < nearest.Bound())
+            {
+               nodes.emplace_back(distance, child);
+               std::push_heap(nodes.begin(), nodes.end(), Further);
+            }
+         }
+      }
+   }
+
+   nearest.Sort(objects);
+}
+
+// global typedefs
+typedef Bvh< float > Bvhf;
+typedef Bvh< double > Bvhd;
+
+#endif // _BVH_H_
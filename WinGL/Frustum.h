@@ -0,0 +1,174 @@
+#ifndef _FRUSTUM_H_
+#define _FRUSTUM_H_
+
+// local includes
+#include "Matrix.h"
+#include "Vector.h"
+
+// std includes
+#include <cmath>
+
+// the six planes that bound what a camera sees...
+// the planes are taken from the rows of the projection view matrix, so the
+// frustum is in world space.  each plane is stored as a, b, c, d with the
+// normal a, b, c of unit length pointing into the frustum, so a x + b y +
+// c z + d is the signed distance of a point from the plane.
+template < typename T >
+class Frustum
+{
+public:
+   // basic type of the class
+   typedef T type;
+
+   // the planes of the frustum
+   enum Plane
+   {
+      PLANE_LEFT,
+      PLANE_RIGHT,
+      PLANE_BOTTOM,
+      PLANE_TOP,
+      PLANE_NEAR,
+      PLANE_FAR,
+      NUM_PLANES
+   };
+
+   // constructors
+   Frustum( );
+   explicit Frustum( const Matrix< T > & projview );
+
+   // extracts the planes from a projection view matrix
+   void Extract( const Matrix< T > & projview );
+
+   // returns the a, b, c, d of a plane
+   const T * GetPlane( const Plane plane ) const { return mPlanes[plane]; }
+
+   // signed distance of a point from a plane, positive inside
+   T Distance( const Plane plane, const Vector< T, 3 > & point ) const;
+
+   // indicates if some of the sphere or box may be inside the frustum...
+   // these are conservative, a shape near a corner of the frustum can be
+   // reported as visible while being just outside of it
+   bool IntersectsSphere( const Vector< T, 3 > & center, const T & radius ) const;
+   bool IntersectsBox( const Vector< T, 3 > & min, const Vector< T, 3 > & max ) const;
+
+   // indicates if the point or all of the box is inside the frustum
+   bool Contains( const Vector< T, 3 > & point ) const;
+   bool ContainsBox( const Vector< T, 3 > & min, const Vector< T, 3 > & max ) const;
+
+private:
+   T     mPlanes[NUM_PLANES][4];
+
+};
+
+template < typename T >
+inline Frustum< T >::Frustum( )
+{
+   for (int plane = 0; plane < NUM_PLANES; ++plane)
+   {
+      mPlanes[plane][0] = mPlanes[plane][1] = mPlanes[plane][2] = mPlanes[plane][3] = static_cast< T >(0);
+   }
+}
+
+template < typename T >
+inline Frustum< T >::Frustum( const Matrix< T > & projview )
+{
+   Extract(projview);
+}
+
+template < typename T >
+inline void Frustum< T >::Extract( const Matrix< T > & projview )
+{
+   const T * const pM = projview;
+
+   // the matrix is column major, so row r is pM[r], pM[4 + r], pM[8 + r], pM[12 + r]...
+   // a point is inside when -w <= x, y, z <= w, which gives row 3 +/- rows 0 to 2
+   for (int plane = 0; plane < NUM_PLANES; ++plane)
+   {
+      const int row = plane / 2;
+      const T sign = plane % 2 ? static_cast< T >(-1) : static_cast< T >(1);
+
+      T * const pPlane = mPlanes[plane];
+
+      for (int col = 0; col < 4; ++col)
+      {
+         pPlane[col] = pM[col * 4 + 3] + sign * pM[col * 4 + row];
+      }
+
+      const T length = std::sqrt(pPlane[0] * pPlane[0] + pPlane[1] * pPlane[1] + pPlane[2] * pPlane[2]);
+
+      if (length > static_cast< T >(0))
+      {
+         for (int col = 0; col < 4; ++col)
+         {
+            pPlane[col] /= length;
+         }
+      }
+   }
+}
+
+template < typename T >
+inline T Frustum< T >::Distance( const Plane plane, const Vector< T, 3 > & point ) const
+{
+   const T * const pPlane = mPlanes[plane];
+
+   return pPlane[0] * point[0] + pPlane[1] * point[1] + pPlane[2] * point[2] + pPlane[3];
+}
+
+template < typename T >
+inline bool Frustum< T >::IntersectsSphere( const Vector< T, 3 > & center, const T & radius ) const
+{
+   for (int plane = 0; plane < NUM_PLANES; ++plane)
+   {
+      if (Distance(static_cast< Plane >(plane), center) < -radius) return false;
+   }
+
+   return true;
+}
+
+template < typename T >
+inline bool Frustum< T >::IntersectsBox( const Vector< T, 3 > & min, const Vector< T, 3 > & max ) const
+{
+   for (int plane = 0; plane < NUM_PLANES; ++plane)
+   {
+      const T * const pPlane = mPlanes[plane];
+
+      // the corner of the box furthest along the normal
+      const Vector< T, 3 > corner(pPlane[0] >= static_cast< T >(0) ? max[0] : min[0],
+                                  pPlane[1] >= static_cast< T >(0) ? max[1] : min[1],
+                                  pPlane[2] >= static_cast< T >(0) ? max[2] : min[2]);
+
+      if (Distance(static_cast< Plane >(plane), corner) < static_cast< T >(0)) return false;
+   }
+
+   return true;
+}
+
+template < typename T >
+inline bool Frustum< T >::Contains( const Vector< T, 3 > & point ) const
+{
+   return IntersectsSphere(point, static_cast< T >(0));
+}
+
+template < typename T >
+inline bool Frustum< T >::ContainsBox( const Vector< T, 3 > & min, const Vector< T, 3 > & max ) const
+{
+   for (int plane = 0; plane < NUM_PLANES; ++plane)
+   {
+      const T * const pPlane = mPlanes[plane];
+
+      // the corner of the box furthest against the normal
+      const Vector< T, 3 > corner(pPlane[0] >= static_cast< T >(0) ? min[0] : max[0],
+                                  pPlane[1] >= static_cast< T >(0) ? min[1] : max[1],
+                                  pPlane[2] >= static_cast< T >(0) ? min[2] : max[2]);
+
+      if (Distance(static_cast< Plane >(plane), corner) < static_cast< T >(0)) return false;
+   }
+
+   return true;
+}
+
+// global typedefs
+typedef Frustum< float > Frustumf;
+typedef Frustum< double > Frustumd;
+
+#endif // _FRUSTUM_H_
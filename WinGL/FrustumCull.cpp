@@ -0,0 +1,244 @@
+// local includes
+#include "FrustumCull.h"
+#include "Simd.h"
+#include "WglAssert.h"
+
+// std includes
+#include <cmath>
+#include <algorithm>
+
+namespace FrustumCull
+{
+
+namespace details
+{
+
+// instances culled as one block...  the blocks are a multiple of four
+// so each block is tested as whole vectors
+const size_t CULL_BLOCK_SIZE = 8192;
+
+// instances each thread culls at the least
+const size_t CULL_GRAIN_SIZE = 65536;
+
+// the planes of the frustum and the absolute values of their normals
+struct Planes
+{
+   float    plane[Frustumf::NUM_PLANES][4];
+   float    abs_normal[Frustumf::NUM_PLANES][3];
+
+   explicit Planes( const Frustumf & frustum )
+   {
+      for (int i = 0; i < Frustumf::NUM_PLANES; ++i)
+      {
+         const float * const pPlane = frustum.GetPlane(static_cast< Frustumf::Plane >(i));
+
+         for (int j = 0; j < 4; ++j) plane[i][j] = pPlane[j];
+         for (int j = 0; j < 3; ++j) abs_normal[i][j] = std::fabs(pPlane[j]);
+      }
+   }
+};
+
+// culls the spheres or boxes in [begin, end), writing the visible indices
+// to pVisible and returning the number written...  a sphere is a box whose
+// extent along every normal is its radius, so one kernel tests both.
+template < bool SPHERES >
+size_t Cull( const Planes & planes,
+             const float * const (&pCenter)[3],
+             const float * const (&pExtent)[3],
+             const size_t begin,
+             const size_t end,
+             uint32_t * const pVisible )
+{
+   size_t visible = 0;
+   size_t i = begin;
+
+#if defined( WGL_SIMD_SSE2 )
+
+   __m128 plane[Frustumf::NUM_PLANES][4];
+   __m128 abs_normal[Frustumf::NUM_PLANES][3];
+
+   for (int p = 0; p < Frustumf::NUM_PLANES; ++p)
+   {
+      for (int j = 0; j < 4; ++j) plane[p][j] = _mm_set1_ps(planes.plane[p][j]);
+      for (int j = 0; j < 3; ++j) abs_normal[p][j] = _mm_set1_ps(planes.abs_normal[p][j]);
+   }
+
+   const __m128 zero = _mm_setzero_ps();
+
+   for (; i + 4 <= end; i += 4)
+   {
+      const __m128 x = _mm_loadu_ps(pCenter[0] + i);
+      const __m128 y = _mm_loadu_ps(pCenter[1] + i);
+      const __m128 z = _mm_loadu_ps(pCenter[2] + i);
+
+      __m128 ex = _mm_loadu_ps(pExtent[0] + i);
+      __m128 ey = ex, ez = ex;
+
+      if (!SPHERES)
+      {
+         ey = _mm_loadu_ps(pExtent[1] + i);
+         ez = _mm_loadu_ps(pExtent[2] + i);
+      }
+
+      __m128 outside = zero;
+
+      for (int p = 0; p < Frustumf::NUM_PLANES; ++p)
+      {
+         // summed in the same order as Frustum::Distance
+         const __m128 distance =
+            _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(plane[p][0], x), _mm_mul_ps(plane[p][1], y)),
+                                  _mm_mul_ps(plane[p][2], z)), plane[p][3]);
+
+         const __m128 reach = SPHERES ? ex :
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs_normal[p][0], ex), _mm_mul_ps(abs_normal[p][1], ey)),
+                       _mm_mul_ps(abs_normal[p][2], ez));
+
+         outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, reach), zero));
+      }
+
+      // write every index and only advance past the visible ones
+      const int mask = ~_mm_movemask_ps(outside);
+
+      for (int lane = 0; lane < 4; ++lane)
+      {
+         pVisible[visible] = static_cast< uint32_t >(i + lane);
+         visible += (mask >> lane) & 1;
+      }
+   }
+
+#endif // WGL_SIMD_SSE2
+
+   for (; i < end; ++i)
+   {
+      bool inside = true;
+
+      for (int p = 0; p < Frustumf::NUM_PLANES && inside; ++p)
+      {
+         const float * const pPlane = planes.plane[p];
+
+         const float distance =
+            pPlane[0] * pCenter[0][i] + pPlane[1] * pCenter[1][i] + pPlane[2] * pCenter[2][i] + pPlane[3];
+
+         const float reach = SPHERES ? pExtent[0][i] :
+            planes.abs_normal[p][0] * pExtent[0][i] +
+            planes.abs_normal[p][1] * pExtent[1][i] +
+            planes.abs_normal[p][2] * pExtent[2][i];
+
+         inside = distance + reach >= 0.0f;
+      }
+
+      if (inside) pVisible[visible++] = static_cast< uint32_t >(i);
+   }
+
+   return visible;
+}
+
+// culls all the instances in blocks, split across the threads when parallel
+template < bool SPHERES >
+size_t Cull( const Frustumf & frustum,
+             const float * const (&pCenter)[3],
+             const float * const (&pExtent)[3],
+             const size_t count,
+             uint32_t * const pVisible,
+             const bool parallel )
+{
+   const Planes planes(frustum);
+
+   if (!parallel || count <= CULL_GRAIN_SIZE)
+   {
+      return Cull< SPHERES >(planes, pCenter, pExtent, 0, count, pVisible);
+   }
+
+   // each block writes its indices where the block starts
+   const size_t num_blocks = (count + CULL_BLOCK_SIZE - 1) / CULL_BLOCK_SIZE;
+
+   std::vector< size_t > visible(num_blocks);
+
+   ParallelFor(num_blocks, CULL_GRAIN_SIZE / CULL_BLOCK_SIZE,
+      [ & ] ( const size_t begin, const size_t end )
+      {
+         for (size_t block = begin; block < end; ++block)
+         {
+            const size_t first = block * CULL_BLOCK_SIZE;
+            const size_t last = std::min(first + CULL_BLOCK_SIZE, count);
+
+            visible[block] = Cull< SPHERES >(planes, pCenter, pExtent, first, last, pVisible + first);
+         }
+      });
+
+   // then the indices are moved down after those of the blocks before
+   size_t num_visible = visible[0];
+
+   for (size_t block = 1; block < num_blocks; ++block)
+   {
+      const uint32_t * const pBlock = pVisible + block * CULL_BLOCK_SIZE;
+
+      std::copy(pBlock, pBlock + visible[block], pVisible + num_visible);
+
+      num_visible += visible[block];
+   }
+
+   return num_visible;
+}
+
+} // namespace details
+
+void Spheres::Clear( )
+{
+   for (uint32_t axis = 0; axis < 3; ++axis) center[axis].clear();
+
+   radius.clear();
+}
+
+void Spheres::Add( const Vec3f & c, const float r )
+{
+   for (uint32_t axis = 0; axis < 3; ++axis) center[axis].push_back(c[axis]);
+
+   radius.push_back(r);
+}
+
+void Boxes::Clear( )
+{
+   for (uint32_t axis = 0; axis < 3; ++axis)
+   {
+      center[axis].clear();
+      extent[axis].clear();
+   }
+}
+
+void Boxes::Add( const Vec3f & min, const Vec3f & max )
+{
+   for (uint32_t axis = 0; axis < 3; ++axis)
+   {
+      center[axis].push_back((min[axis] + max[axis]) * 0.5f);
+      extent[axis].push_back((max[axis] - min[axis]) * 0.5f);
+   }
+}
+
+size_t CullSpheres( const Frustumf & frustum,
+                    const Spheres & spheres,
+                    uint32_t * const pVisible,
+                    const bool parallel )
+{
+   const float * const pCenter[3] = { spheres.center[0].data(), spheres.center[1].data(), spheres.center[2].data() };
+   const float * const pRadius[3] = { spheres.radius.data(), spheres.radius.data(), spheres.radius.data() };
+
+   WGL_ASSERT(spheres.center[0].size() == spheres.Size() &&
+              spheres.center[1].size() == spheres.Size() &&
+              spheres.center[2].size() == spheres.Size());
+
+   return details::Cull< true >(frustum, pCenter, pRadius, spheres.Size(), pVisible, parallel);
+}
+
+size_t CullBoxes( const Frustumf & frustum,
+                  const Boxes & boxes,
+                  uint32_t * const pVisible,
+                  const bool parallel )
+{
+   const float * const pCenter[3] = { boxes.center[0].data(), boxes.center[1].data(), boxes.center[2].data() };
+   const float * const pExtent[3] = { boxes.extent[0].data(), boxes.extent[1].data(), boxes.extent[2].data() };
+
+   return details::Cull< false >(frustum, pCenter, pExtent, boxes.Size(), pVisible, parallel);
+}
+
+} // namespace FrustumCull
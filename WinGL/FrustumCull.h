@@ -0,0 +1,102 @@
+#ifndef _FRUSTUM_CULL_H_
+#define _FRUSTUM_CULL_H_
+
+// local includes
+#include "Vector.h"
+#include "Frustum.h"
+#include "ParallelFor.h"
+
+// std includes
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// culls large sets of instances against a frustum...
+// the bounds are stored as a structure of arrays, so four instances are
+// tested against each plane at once.  the indices of the visible instances
+// are written in increasing order, and the instances can then be compacted
+// into the buffer that is drawn.  the results do not depend on the threads.
+namespace FrustumCull
+{
+
+// bounding spheres as centers and radii
+struct Spheres
+{
+   std::vector< float > center[3];
+   std::vector< float > radius;
+
+   size_t Size( ) const { return radius.size(); }
+
+   void Clear( );
+   void Add( const Vec3f & c, const float r );
+};
+
+// axis aligned bounding boxes as centers and half extents
+struct Boxes
+{
+   std::vector< float > center[3];
+   std::vector< float > extent[3];
+
+   size_t Size( ) const { return center[0].size(); }
+
+   void Clear( );
+   void Add( const Vec3f & min, const Vec3f & max );
+};
+
+// writes the indices of the spheres or boxes that intersect the frustum to
+// pVisible, which must hold an index for every one, and returns the number
+// visible.  large sets are split across the hardware threads when parallel.
+size_t CullSpheres( const Frustumf & frustum,
+                    const Spheres & spheres,
+                    uint32_t * const pVisible,
+                    const bool parallel = false );
+
+size_t CullBoxes( const Frustumf & frustum,
+                  const Boxes & boxes,
+                  uint32_t * const pVisible,
+                  const bool parallel = false );
+
+// gathers the visible instances, pDest[i] = pSource[pVisible[i]]
+template < typename T >
+void Compact( const T * const pSource,
+              const uint32_t * const pVisible,
+              const size_t num_visible,
+              T * const pDest,
+              const bool parallel = false );
+
+namespace details
+{
+
+// instances each thread compacts at the least
+const size_t COMPACT_GRAIN_SIZE = 16384;
+
+} // namespace details
+
+template < typename T >
+inline void Compact( const T * const pSource,
+                     const uint32_t * const pVisible,
+                     const size_t num_visible,
+                     T * const pDest,
+                     const bool parallel )
+{
+   const auto Gather = [ & ] ( const size_t begin, const size_t end )
+   {
+      for (size_t i = begin; i < end; ++i)
+      {
+         pDest[i] = pSource[pVisible[i]];
+      }
+   };
+
+   if (parallel)
+   {
+      ParallelFor(num_visible, details::COMPACT_GRAIN_SIZE, Gather);
+   }
+   else
+   {
+      Gather(0, num_visible);
+   }
+}
+
+} // namespace FrustumCull
+
+#endif // _FRUSTUM_CULL_H_
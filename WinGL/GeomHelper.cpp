@@ -1,56 +1,510 @@
 // local includes
 #include "GeomHelper.h"
 //#include "Matrix.h"
+#include "Simd.h"
 #include "WglAssert.h"
 #include "MathHelper.h"
+#include "ParallelFor.h"
+#include "VectorHelper.h"
 //#include "Quaternion.h"
 
 // std includes
 #include <cmath>
 #include <limits>
+#include <thread>
 #include <iterator>
 
 namespace GeomHelper
 {
 
+namespace details
+{
+
+// minimum number of faces or vertices handed to each thread when
+// the faces around the vertices are looked up in the adjacency
+const size_t ADJACENCY_GRAIN_SIZE = 16384;
+
+// determines if the index is in the range [begin, end)
+inline bool InRange( const GLuint index, const size_t begin, const size_t end )
+{
+   return static_cast< size_t >(index) - begin < end - begin;
+}
+
+// adds the face normals to the normals of the vertices in [begin, end).
+// the faces are visited in index order, so each vertex sums its face
+// normals in the same order no matter how the vertices are divided.
 template < typename T >
-std::vector< Vector< T, 3 > > ConstructNormals( const std::vector< Vector< T, 3 > > & vertices,
-                                                const std::vector< GLuint > & indices )
+void AccumulateNormals( const Vector< T, 3 > * const pVertices,
+                        const std::vector< GLuint > & indices,
+                        Vector< T, 3 > * const pNormals,
+                        const size_t begin, const size_t end )
 {
-   // resize the normals
-   std::vector< Vector< T, 3 > > normals(vertices.size(), Vector< T, 3 >(T(0), T(0), T(0)));
+   const GLuint * pIndex = indices.data();
+   const GLuint * const pIndexEnd = pIndex + (indices.size() - indices.size() % 3);
+
+   for (; pIndex != pIndexEnd; pIndex += 3)
+   {
+      // get the first three indices
+      const GLuint i0 = pIndex[0];
+      const GLuint i1 = pIndex[1];
+      const GLuint i2 = pIndex[2];
+
+      const bool owns_i0 = InRange(i0, begin, end);
+      const bool owns_i1 = InRange(i1, begin, end);
+      const bool owns_i2 = InRange(i2, begin, end);
+
+      if (owns_i0 || owns_i1 || owns_i2)
+      {
+         // construct the normal from the edge vectors
+         const Vector< T, 3 > n = VectorHelper::TriangleNormal(pVertices[i0], pVertices[i1], pVertices[i2]);
 
-   // construct the normals for all the indices
-   auto index_beg = indices.cbegin();
-   const auto index_end = indices.cend();
+         // add the normal to the normal vector
+         if (owns_i0) pNormals[i0] += n;
+         if (owns_i1) pNormals[i1] += n;
+         if (owns_i2) pNormals[i2] += n;
+      }
+   }
+}
 
-   for (; index_beg < index_end; index_beg += 3)
+// constructs the normals of the faces in [begin, end)
+template < typename T >
+void ConstructFaceNormals( const Vector< T, 3 > * const pVertices,
+                           const GLuint * const pIndices,
+                           Vector< T, 3 > * const pFaceNormals,
+                           const size_t begin, const size_t end )
+{
+   for (size_t face = begin; face < end; ++face)
+   {
+      const GLuint * const pFace = pIndices + face * 3;
+
+      pFaceNormals[face] = VectorHelper::TriangleNormal(pVertices[pFace[0]], pVertices[pFace[1]], pVertices[pFace[2]]);
+   }
+}
+
+// sums the normals or tangents of the faces around the vertices in [begin, end).
+// the faces are in index order, the same order AccumulateNormals and
+// AccumulateTangents add them in.
+template < typename T >
+void GatherFaceVectors( const VertexAdjacency & adjacency,
+                        const Vector< T, 3 > * const pFaceVectors,
+                        Vector< T, 3 > * const pVectors,
+                        const size_t begin, const size_t end )
+{
+   for (size_t vertex = begin; vertex < end; ++vertex)
+   {
+      Vector< T, 3 > sum(T(0), T(0), T(0));
+
+      for (uint32_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i)
+      {
+         sum += pFaceVectors[adjacency.triangles[i]];
+      }
+
+      pVectors[vertex] = sum;
+   }
+}
+
+// normalizes the vectors four at a time...
+// the operations match Vector::Normalize
+template < typename T >
+void NormalizeVectors( Vector< T, 3 > * const pVectors, const size_t count )
+{
+   typedef simd::Vec4< T > Vec4;
+
+   const Vec4 one = Vec4::Splat(T(1));
+
+   size_t i = 0;
+
+   for (; i + 4 <= count; i += 4)
+   {
+      // split the four vectors into their components
+      T x[4], y[4], z[4];
+
+      for (size_t lane = 0; lane < 4; ++lane)
+      {
+         x[lane] = pVectors[i + lane].mT[0];
+         y[lane] = pVectors[i + lane].mT[1];
+         z[lane] = pVectors[i + lane].mT[2];
+      }
+
+      const Vec4 vx = Vec4::Load(x);
+      const Vec4 vy = Vec4::Load(y);
+      const Vec4 vz = Vec4::Load(z);
+
+      const Vec4 one_over_length = one / Vec4::Sqrt(vx * vx + vy * vy + vz * vz);
+
+      (vx * one_over_length).Store(x);
+      (vy * one_over_length).Store(y);
+      (vz * one_over_length).Store(z);
+
+      for (size_t lane = 0; lane < 4; ++lane)
+      {
+         pVectors[i + lane] = Vector< T, 3 >(x[lane], y[lane], z[lane]);
+      }
+   }
+
+   for (; i < count; ++i)
+   {
+      pVectors[i].Normalize();
+   }
+}
+
+// constructs the tangent of a single face
+template < typename T >
+Vector< T, 3 > FaceTangent( const Vector< T, 3 > * const pVertices,
+                            const Vector< T, 2 > * const pTexCoords,
+                            const GLuint i0, const GLuint i1, const GLuint i2 )
+{
+   // just need to calculate the tangent relative to the surface of the face
+   //      1      |  t2    -t1 | | P1x   P1y   P1z |   | T | << Tangent
+   // ----------- |            | |                 | = |   |
+   // s1t2 - s2t1 | -s2     s1 | | P2x   P2y   P2z |   | B | << Bitangent
+   //
+   //          1      /                                                   \
+   // T = ----------- | t2 P1x - t1 P2x, t2 P1y - t1 P2y, t2 P1z - t1 P2z |
+   //     s1t2 - s2t1 \                                                   /
+   //
+   //          1      /                                                   \
+   // B = ----------- | s1 P2x - s2 P1x, s1 P2y - s2 P1y, s1 P2z - s2 P1z |
+   //     s1t2 - s2t1 \                                                   /
+
+   // construct the edge vectors
+   const Vector< T, 3 > e1 = pVertices[i1] - pVertices[i0];
+   const Vector< T, 3 > e2 = pVertices[i2] - pVertices[i0];
+
+   // get the edge texture coordinates
+   const T s1 = pTexCoords[i1].X() - pTexCoords[i0].X();
+   const T t1 = pTexCoords[i1].Y() - pTexCoords[i0].Y();
+   const T s2 = pTexCoords[i2].X() - pTexCoords[i0].X();
+   const T t2 = pTexCoords[i2].Y() - pTexCoords[i0].Y();
+
+   // calculate the determinat
+   const T dividend = s1 * t2 - s2 * t1;
+   const T det = dividend == 0 ? 1 : 1 / dividend;
+
+   // calculate the tangent
+   Vector< T, 3 > t(det * (t2 * e1.X() - t1 * e2.X()),
+                    det * (t2 * e1.Y() - t1 * e2.Y()),
+                    det * (t2 * e1.Z() - t1 * e2.Z()));
+
+   // compare the squared lengths to skip the square roots
+   if (t * t == 0)
+   {
+      // use one of the edges to define the tangent vector
+      if (e1 * e1 != 0)
+      {
+         t = e1.UnitVector();
+      }
+      else if (e2 * e2 != 0)
+      {
+         t = e2.UnitVector();
+      }
+      else
+      {
+         // todo: figure out what this case needs to be
+         WGL_ASSERT(false);
+
+         //// the tangent could not be calculated so take the three normals,
+         //// average them, and normalize and use that as the tangent...
+         //const Vector< T, 3 > & n0 = normals[i0];
+         //const Vector< T, 3 > & n1 = normals[i1];
+         //const Vector< T, 3 > & n2 = normals[i2];
+
+         //// average the normals
+         //const Vector< T, 3 > n_avg = (n0 + n1 + n2) * (T(1) / T(3));
+
+         //// take a vertex and create 
+
+         //// do the averaging of these vectors and rotate along the z-axis
+         //// such that a normal of 0,1,0 will have a tangent of 1,0,0...
+         //t = Matrix< T >::Rotate(T(-90), Vector< T, 3 >(0, 0, 1)) * Vector4< T >(((n0 + n1 + n2) * (T(1) / T(3))), 0);
+      }
+
+#ifdef WGL_GEOM_HELPER_REPORT_ZERO_LENGTH_TANGENT_VECTOR
+      // issue a message to the console
+      WGL_ASSERT_REPORT(false, "Creating tangent vector since tangent calculation produced zero length tangent vector");
+#endif // WGL_GEOM_HELPER_REPORT_ZERO_LENGTH_TANGENT_VECTOR
+
+      //const Vector< T, 3 > b(det * (s1 * e2.X() - s2 * e1.X()),
+      //                     det * (s1 * e2.Y() - s2 * e1.Y()),
+      //                     det * (s1 * e2.Z() - s2 * e1.Z()));
+      //
+      //// the bitangent better have a length
+      //WGL_ASSERT(b.Length() != 0);
+      //
+      //// the normals should already be normalized
+      //WGL_ASSERT(MathHelper::Equals< T >(normals[i0].Length(), 1));
+      //WGL_ASSERT(MathHelper::Equals< T >(normals[i1].Length(), 1));
+      //WGL_ASSERT(MathHelper::Equals< T >(normals[i2].Length(), 1));
+      //
+      //// add the tangent to the tangent vector
+      //tangents_bitangents.first[i0] += b ^ normals[i0];
+      //tangents_bitangents.first[i1] += b ^ normals[i1];
+      //tangents_bitangents.first[i2] += b ^ normals[i2];
+   }
+
+   // make sure the components are valid values
+   WGL_ASSERT(!std::isnan(t.X()) && !std::isnan(t.Y()) && !std::isnan(t.Z()));
+
+   return t;
+}
+
+// adds the face tangents to the tangents of the vertices in [begin, end)
+// in index order, the same as AccumulateNormals
+template < typename T >
+void AccumulateTangents( const Vector< T, 3 > * const pVertices,
+                         const Vector< T, 2 > * const pTexCoords,
+                         const std::vector< GLuint > & indices,
+                         Vector< T, 3 > * const pTangents,
+                         const size_t begin, const size_t end )
+{
+   const GLuint * pIndex = indices.data();
+   const GLuint * const pIndexEnd = pIndex + (indices.size() - indices.size() % 3);
+
+   for (; pIndex != pIndexEnd; pIndex += 3)
    {
       // get the first three indices
-      const GLuint i0 = *(index_beg + 0);
-      const GLuint i1 = *(index_beg + 1);
-      const GLuint i2 = *(index_beg + 2);
+      const GLuint i0 = pIndex[0];
+      const GLuint i1 = pIndex[1];
+      const GLuint i2 = pIndex[2];
+
+      const bool owns_i0 = InRange(i0, begin, end);
+      const bool owns_i1 = InRange(i1, begin, end);
+      const bool owns_i2 = InRange(i2, begin, end);
+
+      if (owns_i0 || owns_i1 || owns_i2)
+      {
+         const Vector< T, 3 > t = FaceTangent(pVertices, pTexCoords, i0, i1, i2);
+
+         // add the tangent to the tangent vector
+         if (owns_i0) pTangents[i0] += t;
+         if (owns_i1) pTangents[i1] += t;
+         if (owns_i2) pTangents[i2] += t;
+      }
+   }
+}
+
+// constructs the tangents of the faces in [begin, end)
+template < typename T >
+void ConstructFaceTangents( const Vector< T, 3 > * const pVertices,
+                            const Vector< T, 2 > * const pTexCoords,
+                            const GLuint * const pIndices,
+                            Vector< T, 3 > * const pFaceTangents,
+                            const size_t begin, const size_t end )
+{
+   for (size_t face = begin; face < end; ++face)
+   {
+      const GLuint * const pFace = pIndices + face * 3;
+
+      pFaceTangents[face] = FaceTangent(pVertices, pTexCoords, pFace[0], pFace[1], pFace[2]);
+   }
+}
+
+// validates the tangent space of a single vertex
+template < typename T >
+void AssertTangentSpace( const Vector< T, 3 > & t, const Vector< T, 3 > & b, const Vector< T, 3 > & n )
+{
+   // the normal should already be normalized
+   WGL_ASSERT(math::Equals< T >(n.Length(), 1));
+   // the tangent should already be normalized
+   WGL_ASSERT(math::Equals< T >(t.Length(), 1, 2 * std::numeric_limits< T >::epsilon()));
+   // the bitangent should be a unit vector
+   WGL_ASSERT(math::Equals< T >(b.Length(), 1));
+
+   static_cast< void >(t); static_cast< void >(b); static_cast< void >(n);
+}
+
+// normalizes the tangents, performs gram-schmidt to orthogonalize the
+// tangents against the normals, and constructs the bitangents, four
+// vertices at a time.  the operations match Vector::Normalize,
+// VectorHelper::Orthonormalize, and VectorHelper::UnitCross.
+template < typename T >
+void FinalizeTangents( Vector< T, 3 > * const pTangents,
+                       Vector< T, 3 > * const pBitangents,
+                       const Vector< T, 3 > * const pNormals,
+                       const size_t count )
+{
+   typedef simd::Vec4< T > Vec4;
+
+   const Vec4 one = Vec4::Splat(T(1));
+
+   size_t i = 0;
+
+   for (; i + 4 <= count; i += 4)
+   {
+      // split the four tangents and normals into their components
+      T x[4], y[4], z[4], nx[4], ny[4], nz[4];
+
+      for (size_t lane = 0; lane < 4; ++lane)
+      {
+         x[lane] = pTangents[i + lane].mT[0];
+         y[lane] = pTangents[i + lane].mT[1];
+         z[lane] = pTangents[i + lane].mT[2];
+         nx[lane] = pNormals[i + lane].mT[0];
+         ny[lane] = pNormals[i + lane].mT[1];
+         nz[lane] = pNormals[i + lane].mT[2];
+      }
+
+      Vec4 tx = Vec4::Load(x);
+      Vec4 ty = Vec4::Load(y);
+      Vec4 tz = Vec4::Load(z);
+
+      const Vec4 vnx = Vec4::Load(nx);
+      const Vec4 vny = Vec4::Load(ny);
+      const Vec4 vnz = Vec4::Load(nz);
+
+      // normalize the tangent
+      Vec4 one_over_length = one / Vec4::Sqrt(tx * tx + ty * ty + tz * tz);
+
+      tx = tx * one_over_length;
+      ty = ty * one_over_length;
+      tz = tz * one_over_length;
 
-      // construct the edge vectors
-      const Vector< T, 3 > e1 = vertices[i1] - vertices[i0];
-      const Vector< T, 3 > e2 = vertices[i2] - vertices[i0];
+      // T' = T - (N * T) * N
+      const Vec4 n_dot_t = vnx * tx + vny * ty + vnz * tz;
+
+      tx = tx - vnx * n_dot_t;
+      ty = ty - vny * n_dot_t;
+      tz = tz - vnz * n_dot_t;
+
+      one_over_length = one / Vec4::Sqrt(tx * tx + ty * ty + tz * tz);
+
+      tx = tx * one_over_length;
+      ty = ty * one_over_length;
+      tz = tz * one_over_length;
+
+      // bitangent is just n cross t
+      const Vec4 bx = vny * tz - vnz * ty;
+      const Vec4 by = vnz * tx - vnx * tz;
+      const Vec4 bz = vnx * ty - vny * tx;
+
+      one_over_length = one / Vec4::Sqrt(bx * bx + by * by + bz * bz);
+
+      tx.Store(x);
+      ty.Store(y);
+      tz.Store(z);
+
+      (bx * one_over_length).Store(nx);
+      (by * one_over_length).Store(ny);
+      (bz * one_over_length).Store(nz);
+
+      for (size_t lane = 0; lane < 4; ++lane)
+      {
+         pTangents[i + lane] = Vector< T, 3 >(x[lane], y[lane], z[lane]);
+         pBitangents[i + lane] = Vector< T, 3 >(nx[lane], ny[lane], nz[lane]);
+
+         AssertTangentSpace(pTangents[i + lane], pBitangents[i + lane], pNormals[i + lane]);
+      }
+   }
+
+   for (; i < count; ++i)
+   {
+      // normalize the tangent
+      pTangents[i].Normalize();
+
+      // perform grahm-schmidt on the normal and tangent,
+      // as the tangent may not be orthogonal to the normal
+      pTangents[i] = VectorHelper::Orthonormalize(pTangents[i], pNormals[i]);
 
-      // construct the normal
-      const Vector< T, 3 > n = (e1 ^ e2).UnitVector();
+      // bitangent is just n cross t
+      pBitangents[i] = VectorHelper::UnitCross(pNormals[i], pTangents[i]);
 
-      // add the normal to the normal vector
-      normals[i0] += n;
-      normals[i1] += n;
-      normals[i2] += n;
+      AssertTangentSpace(pTangents[i], pBitangents[i], pNormals[i]);
    }
+}
 
-   // normalize all the normals
-   auto normal_beg = normals.begin();
-   const auto normal_end = normals.end();
+} // namespace details
 
-   for (; normal_beg != normal_end; ++normal_beg)
+VertexAdjacency ConstructVertexAdjacency( const std::vector< GLuint > & indices,
+                                          const size_t num_vertices )
+{
+   // only whole triangles are listed
+   const size_t num_indices = indices.size() - indices.size() % 3;
+
+   VertexAdjacency adjacency;
+   adjacency.offsets.assign(num_vertices + 1, 0);
+   adjacency.triangles.resize(num_indices);
+
+   // count the triangles of each vertex
+   for (size_t i = 0; i < num_indices; ++i)
    {
-      normal_beg->Normalize();
+      WGL_ASSERT(indices[i] < num_vertices);
+
+      ++adjacency.offsets[indices[i] + 1];
+   }
+
+   for (size_t v = 0; v < num_vertices; ++v)
+   {
+      adjacency.offsets[v + 1] += adjacency.offsets[v];
+   }
+
+   // place each triangle in the lists of its vertices
+   std::vector< uint32_t > next(adjacency.offsets.cbegin(), adjacency.offsets.cend() - 1);
+
+   for (size_t i = 0; i < num_indices; ++i)
+   {
+      adjacency.triangles[next[indices[i]]++] = static_cast< uint32_t >(i / 3);
+   }
+
+   return adjacency;
+}
+
+template < typename T >
+std::vector< Vector< T, 3 > > ConstructNormals( const std::vector< Vector< T, 3 > > & vertices,
+                                                const std::vector< GLuint > & indices,
+                                                const bool parallel )
+{
+   // the threads each take a range of the vertices and look up their faces...
+   // a single thread is better off adding the faces to the vertices directly
+   if (parallel && vertices.size() > details::ADJACENCY_GRAIN_SIZE && std::thread::hardware_concurrency() > 1)
+   {
+      return ConstructNormals(vertices, indices, ConstructVertexAdjacency(indices, vertices.size()), true);
+   }
+
+   // resize the normals
+   std::vector< Vector< T, 3 > > normals(vertices.size(), Vector< T, 3 >(T(0), T(0), T(0)));
+
+   details::AccumulateNormals(vertices.data(), indices, normals.data(), 0, normals.size());
+   details::NormalizeVectors(normals.data(), normals.size());
+
+   return normals;
+}
+
+template < typename T >
+std::vector< Vector< T, 3 > > ConstructNormals( const std::vector< Vector< T, 3 > > & vertices,
+                                                const std::vector< GLuint > & indices,
+                                                const VertexAdjacency & adjacency,
+                                                const bool parallel )
+{
+   // the adjacency must be of these vertices
+   WGL_ASSERT(adjacency.offsets.size() == vertices.size() + 1);
+
+   const size_t num_faces = indices.size() / 3;
+
+   std::vector< Vector< T, 3 > > face_normals(num_faces);
+   std::vector< Vector< T, 3 > > normals(vertices.size());
+
+   // construct the normals of a range of the faces
+   const auto ConstructFaces = [ & ] ( const size_t begin, const size_t end )
+   {
+      details::ConstructFaceNormals(vertices.data(), indices.data(), face_normals.data(), begin, end);
+   };
+
+   // sum and normalize the normals of a range of the vertices
+   const auto Construct = [ & ] ( const size_t begin, const size_t end )
+   {
+      details::GatherFaceVectors(adjacency, face_normals.data(), normals.data(), begin, end);
+      details::NormalizeVectors(normals.data() + begin, end - begin);
+   };
+
+   if (parallel)
+   {
+      ParallelFor(num_faces, details::ADJACENCY_GRAIN_SIZE, ConstructFaces);
+      ParallelFor(normals.size(), details::ADJACENCY_GRAIN_SIZE, Construct);
+   }
+   else
+   {
+      ConstructFaces(0, num_faces);
+      Construct(0, normals.size());
    }
 
    return normals;
@@ -58,21 +512,24 @@ std::vector< Vector< T, 3 > > ConstructNormals( const std::vector< Vector< T, 3
 
 template < typename T >
 std::vector< Vector< T, 3 > > ConstructNormals( const std::vector< T > & vertices,
-                                                const std::vector< GLuint > & indices )
+                                                const std::vector< GLuint > & indices,
+                                                const bool parallel )
 {
    // there should be 3 components per point
    WGL_ASSERT(vertices.size() % 3 == 0);
 
    return ConstructNormals(std::vector< Vector< T, 3 > >(reinterpret_cast< const Vector< T, 3 > * >(&(vertices[0])),
                                                          reinterpret_cast< const Vector< T, 3 > * >(&(vertices[0]) + vertices.size())),
-                           indices);
+                           indices, parallel);
 }
 
 // floats and doubles are allowed, nothing else
-template std::vector< Vec3f > ConstructNormals< float >( const std::vector< Vec3f > &, const std::vector< GLuint > & );
-template std::vector< Vec3d > ConstructNormals< double >( const std::vector< Vec3d > &, const std::vector< GLuint > & );
-template std::vector< Vec3f > ConstructNormals< float >( const std::vector< float > &, const std::vector< GLuint > & );
-template std::vector< Vec3d > ConstructNormals< double >( const std::vector< double > &, const std::vector< GLuint > & );
+template std::vector< Vec3f > ConstructNormals< float >( const std::vector< Vec3f > &, const std::vector< GLuint > &, const bool );
+template std::vector< Vec3d > ConstructNormals< double >( const std::vector< Vec3d > &, const std::vector< GLuint > &, const bool );
+template std::vector< Vec3f > ConstructNormals< float >( const std::vector< float > &, const std::vector< GLuint > &, const bool );
+template std::vector< Vec3d > ConstructNormals< double >( const std::vector< double > &, const std::vector< GLuint > &, const bool );
+template std::vector< Vec3f > ConstructNormals< float >( const std::vector< Vec3f > &, const std::vector< GLuint > &, const VertexAdjacency &, const bool );
+template std::vector< Vec3d > ConstructNormals< double >( const std::vector< Vec3d > &, const std::vector< GLuint > &, const VertexAdjacency &, const bool );
 
 // helper function to generate the normals
 void ConstructNormals( Shape & shape )
@@ -85,155 +542,91 @@ std::pair< std::vector< Vector< T, 3 > >, std::vector< Vector< T, 3 > > >
 ConstructTangentsAndBitangents( const std::vector< Vector< T, 3 > > & vertices,
                                 const std::vector< Vector< T, 3 > > & normals,
                                 const std::vector< Vector< T, 2 > > & tex_coords,
-                                const std::vector< GLuint > & indices )
+                                const std::vector< GLuint > & indices,
+                                const bool parallel )
 {
    // there needs to be vertices and texture coords
    WGL_ASSERT(!vertices.empty());
    WGL_ASSERT(!tex_coords.empty());
    // the number of verts must match the number of tex coords
    WGL_ASSERT(vertices.size() == tex_coords.size());
+   // there must be a normal for each vertex
+   WGL_ASSERT(vertices.size() == normals.size());
+
+   // the threads each take a range of the vertices and look up their faces...
+   // a single thread is better off adding the faces to the vertices directly
+   if (parallel && vertices.size() > details::ADJACENCY_GRAIN_SIZE && std::thread::hardware_concurrency() > 1)
+   {
+      return ConstructTangentsAndBitangents(vertices, normals, tex_coords, indices,
+                                            ConstructVertexAdjacency(indices, vertices.size()), true);
+   }
 
    // resize the tangents
    std::pair< std::vector< Vector< T, 3 > >, std::vector< Vector< T, 3 > > > tangents_bitangents;
    tangents_bitangents.first.resize(vertices.size(), Vector< T, 3 >(T(0), T(0), T(0)));
    tangents_bitangents.second.resize(vertices.size(), Vector< T, 3 >(T(0), T(0), T(0)));
 
-   // construct the tangents for all the indices
-   auto index_beg = indices.cbegin();
-   const auto index_end = indices.cend();
+   details::AccumulateTangents(vertices.data(), tex_coords.data(), indices,
+                               tangents_bitangents.first.data(), 0, vertices.size());
+   details::FinalizeTangents(tangents_bitangents.first.data(), tangents_bitangents.second.data(),
+                             normals.data(), vertices.size());
 
-   for (; index_beg < index_end; index_beg += 3)
-   {
-      // just need to calculate the tangent relative to the surface of the face
-      //      1      |  t2    -t1 | | P1x   P1y   P1z |   | T | << Tangent
-      // ----------- |            | |                 | = |   |
-      // s1t2 - s2t1 | -s2     s1 | | P2x   P2y   P2z |   | B | << Bitangent
-      //
-      //          1      /                                                   \
-      // T = ----------- | t2 P1x - t1 P2x, t2 P1y - t1 P2y, t2 P1z - t1 P2z |
-      //     s1t2 - s2t1 \                                                   /
-      //
-      //          1      /                                                   \
-      // B = ----------- | s1 P2x - s2 P1x, s1 P2y - s2 P1y, s1 P2z - s2 P1z |
-      //     s1t2 - s2t1 \                                                   /
-
-      // get the first three indices
-      const GLuint i0 = *(index_beg + 0);
-      const GLuint i1 = *(index_beg + 1);
-      const GLuint i2 = *(index_beg + 2);
-
-      // construct the edge vectors
-      const Vector< T, 3 > e1 = vertices[i1] - vertices[i0];
-      const Vector< T, 3 > e2 = vertices[i2] - vertices[i0];
-
-      // get the edge texture coordinates
-      const T s1 = tex_coords[i1].X() - tex_coords[i0].X();
-      const T t1 = tex_coords[i1].Y() - tex_coords[i0].Y();
-      const T s2 = tex_coords[i2].X() - tex_coords[i0].X();
-      const T t2 = tex_coords[i2].Y() - tex_coords[i0].Y();
-
-      // calculate the determinat
-      const T dividend = s1 * t2 - s2 * t1;
-      const T det = dividend == 0 ? 1 : 1 / dividend;
-
-      // calculate the tangent
-      Vector< T, 3 > t(det * (t2 * e1.X() - t1 * e2.X()),
-                       det * (t2 * e1.Y() - t1 * e2.Y()),
-                       det * (t2 * e1.Z() - t1 * e2.Z()));
-
-      if (t.Length() == 0)
-      {
-         // use one of the edges to define the tangent vector
-         if (e1.Length() != 0)
-         {
-            t = e1.UnitVector();
-         }
-         else if (e2.Length() != 0)
-         {
-            t = e2.UnitVector();
-         }
-         else
-         {
-            // todo: figure out what this case needs to be
-            WGL_ASSERT(false);
-
-            //// the tangent could not be calculated so take the three normals,
-            //// average them, and normalize and use that as the tangent...
-            //const Vector< T, 3 > & n0 = normals[i0];
-            //const Vector< T, 3 > & n1 = normals[i1];
-            //const Vector< T, 3 > & n2 = normals[i2];
+   return tangents_bitangents;
+}
 
-            //// average the normals
-            //const Vector< T, 3 > n_avg = (n0 + n1 + n2) * (T(1) / T(3));
+template < typename T >
+std::pair< std::vector< Vector< T, 3 > >, std::vector< Vector< T, 3 > > >
+ConstructTangentsAndBitangents( const std::vector< Vector< T, 3 > > & vertices,
+                                const std::vector< Vector< T, 3 > > & normals,
+                                const std::vector< Vector< T, 2 > > & tex_coords,
+                                const std::vector< GLuint > & indices,
+                                const VertexAdjacency & adjacency,
+                                const bool parallel )
+{
+   // there needs to be vertices and texture coords
+   WGL_ASSERT(!vertices.empty());
+   WGL_ASSERT(!tex_coords.empty());
+   // the number of verts must match the number of tex coords
+   WGL_ASSERT(vertices.size() == tex_coords.size());
+   // there must be a normal for each vertex
+   WGL_ASSERT(vertices.size() == normals.size());
+   // the adjacency must be of these vertices
+   WGL_ASSERT(adjacency.offsets.size() == vertices.size() + 1);
 
-            //// take a vertex and create 
+   const size_t num_faces = indices.size() / 3;
 
-            //// do the averaging of these vectors and rotate along the z-axis
-            //// such that a normal of 0,1,0 will have a tangent of 1,0,0...
-            //t = Matrix< T >::Rotate(T(-90), Vector< T, 3 >(0, 0, 1)) * Vector4< T >(((n0 + n1 + n2) * (T(1) / T(3))), 0);
-         }
+   std::vector< Vector< T, 3 > > face_tangents(num_faces);
 
-#ifdef WGL_GEOM_HELPER_REPORT_ZERO_LENGTH_TANGENT_VECTOR
-         // issue a message to the console
-         WGL_ASSERT_REPORT(false, "Creating tangent vector since tangent calculation produced zero length tangent vector");
-#endif // WGL_GEOM_HELPER_REPORT_ZERO_LENGTH_TANGENT_VECTOR
+   // resize the tangents
+   std::pair< std::vector< Vector< T, 3 > >, std::vector< Vector< T, 3 > > > tangents_bitangents;
+   tangents_bitangents.first.resize(vertices.size());
+   tangents_bitangents.second.resize(vertices.size());
 
-         //const Vector< T, 3 > b(det * (s1 * e2.X() - s2 * e1.X()),
-         //                     det * (s1 * e2.Y() - s2 * e1.Y()),
-         //                     det * (s1 * e2.Z() - s2 * e1.Z()));
-         //
-         //// the bitangent better have a length
-         //WGL_ASSERT(b.Length() != 0);
-         //
-         //// the normals should already be normalized
-         //WGL_ASSERT(MathHelper::Equals< T >(normals[*(index_beg + 0)].Length(), 1));
-         //WGL_ASSERT(MathHelper::Equals< T >(normals[*(index_beg + 1)].Length(), 1));
-         //WGL_ASSERT(MathHelper::Equals< T >(normals[*(index_beg + 2)].Length(), 1));
-         //
-         //// add the tangent to the tangent vector
-         //tangents_bitangents.first[i0] += b ^ normals[*(index_beg + 0)];
-         //tangents_bitangents.first[i1] += b ^ normals[*(index_beg + 1)];
-         //tangents_bitangents.first[i2] += b ^ normals[*(index_beg + 2)];
-      }
+   // construct the tangents of a range of the faces
+   const auto ConstructFaces = [ & ] ( const size_t begin, const size_t end )
+   {
+      details::ConstructFaceTangents(vertices.data(), tex_coords.data(), indices.data(),
+                                     face_tangents.data(), begin, end);
+   };
 
-      // make sure the components are valid values
-      WGL_ASSERT(!std::isnan(t.X()) && !std::isnan(t.Y()) && !std::isnan(t.Z()));
+   // construct the tangents and bitangents of a range of the vertices
+   const auto Construct = [ & ] ( const size_t begin, const size_t end )
+   {
+      details::GatherFaceVectors(adjacency, face_tangents.data(), tangents_bitangents.first.data(), begin, end);
+      details::FinalizeTangents(tangents_bitangents.first.data() + begin,
+                                tangents_bitangents.second.data() + begin,
+                                normals.data() + begin, end - begin);
+   };
 
-      // add the tangent to the tangent vector
-      tangents_bitangents.first[i0] += t;
-      tangents_bitangents.first[i1] += t;
-      tangents_bitangents.first[i2] += t;
+   if (parallel)
+   {
+      ParallelFor(num_faces, details::ADJACENCY_GRAIN_SIZE, ConstructFaces);
+      ParallelFor(vertices.size(), details::ADJACENCY_GRAIN_SIZE, Construct);
    }
-
-   // normalize all the tangents and perform gram-schmidt to orthogonalize the tangent
-   auto tangent_beg = tangents_bitangents.first.begin();
-   const auto tangent_end = tangents_bitangents.first.end();
-
-   for (; tangent_beg != tangent_end; ++tangent_beg)
+   else
    {
-      // normalize the tangent
-      tangent_beg->Normalize();
-
-      // get the normal
-      const auto index_n = std::distance(tangents_bitangents.first.begin(), tangent_beg);
-      const Vector< T, 3 > & n = normals[index_n];
-
-      // the normal should already be normalized
-      WGL_ASSERT(math::Equals< T >(n.Length(), 1));
-
-      // perform grahm-schmidt on the normal and tangent,
-      // as the tangent may not be orthogonal to the normal
-      // T' = T - (N * T) * N
-      *tangent_beg = (*tangent_beg - n * (n * *tangent_beg)).UnitVector();
-
-      // the tangent should already be normalized
-      WGL_ASSERT(math::Equals< T >(tangent_beg->Length(), 1, 2 * std::numeric_limits< T >::epsilon()));
-
-      // bitangent is just n cross t
-      tangents_bitangents.second[index_n] = (n ^ *tangent_beg).UnitVector();
-
-      // the bitangent should be a unit vector
-      WGL_ASSERT(math::Equals< T >(tangents_bitangents.second[index_n].Length(), 1));
+      ConstructFaces(0, num_faces);
+      Construct(0, vertices.size());
    }
 
    return tangents_bitangents;
@@ -244,7 +637,8 @@ std::pair< std::vector< Vector< T, 3 > >, std::vector< Vector< T, 3 > > >
 ConstructTangentsAndBitangents( const std::vector< T > & vertices,
                                 const std::vector< T > & normals,
                                 const std::vector< T > & tex_coords,
-                                const std::vector< GLuint > & indices )
+                                const std::vector< GLuint > & indices,
+                                const bool parallel )
 {
    // there should be 3 components per point
    WGL_ASSERT(vertices.size() % 3 == 0);
@@ -258,22 +652,30 @@ ConstructTangentsAndBitangents( const std::vector< T > & vertices,
                                                                        reinterpret_cast< const Vector< T, 3 > * >(&(normals[0]) + normals.size())),
                                          std::vector< Vector< T, 2 > >(reinterpret_cast< const Vector< T, 2 > * >(&(tex_coords[0])),
                                                                        reinterpret_cast< const Vector< T, 2 > * >(&(tex_coords[0]) + tex_coords.size())),
-                                         indices);
+                                         indices, parallel);
 }
 
 // floats and doubles are allowed, nothing else
 template std::pair< std::vector< Vec3f >, std::vector< Vec3f > >
 ConstructTangentsAndBitangents< float >( const std::vector< Vec3f > &, const std::vector< Vec3f > &,
-                                         const std::vector< Vec2f > &, const std::vector< GLuint > & );
+                                         const std::vector< Vec2f > &, const std::vector< GLuint > &, const bool );
 template std::pair< std::vector< Vec3d >, std::vector< Vec3d > >
 ConstructTangentsAndBitangents< double >( const std::vector< Vec3d > &, const std::vector< Vec3d > &,
-                                          const std::vector< Vec2d > &, const std::vector< GLuint > & );
+                                          const std::vector< Vec2d > &, const std::vector< GLuint > &, const bool );
 template std::pair< std::vector< Vec3f >, std::vector< Vec3f > >
 ConstructTangentsAndBitangents< float >( const std::vector< float > &, const std::vector< float > &,
-                                         const std::vector< float > &, const std::vector< GLuint > & );
+                                         const std::vector< float > &, const std::vector< GLuint > &, const bool );
 template std::pair< std::vector< Vec3d >, std::vector< Vec3d > >
 ConstructTangentsAndBitangents< double >( const std::vector< double > &, const std::vector< double > &,
-                                          const std::vector< double > &, const std::vector< GLuint > & );
+                                          const std::vector< double > &, const std::vector< GLuint > &, const bool );
+template std::pair< std::vector< Vec3f >, std::vector< Vec3f > >
+ConstructTangentsAndBitangents< float >( const std::vector< Vec3f > &, const std::vector< Vec3f > &,
+                                         const std::vector< Vec2f > &, const std::vector< GLuint > &,
+                                         const VertexAdjacency &, const bool );
+template std::pair< std::vector< Vec3d >, std::vector< Vec3d > >
+ConstructTangentsAndBitangents< double >( const std::vector< Vec3d > &, const std::vector< Vec3d > &,
+                                          const std::vector< Vec2d > &, const std::vector< GLuint > &,
+                                          const VertexAdjacency &, const bool );
 
 // helper function to generate the tangents and bitangents
 void ConstructTangentsAndBitangents( Shape & shape )
@@ -29,30 +29,70 @@ struct Shape
    std::vector< Vec3f >    bitangents;
 };
 
+// structure that lists the triangles around each vertex in compressed sparse row form
+// the triangles of vertex v are triangles[offsets[v]] up to triangles[offsets[v + 1]],
+// in increasing order.  built once per mesh, it turns searches of the faces into lookups.
+struct VertexAdjacency
+{
+   std::vector< uint32_t > offsets;
+   std::vector< uint32_t > triangles;
+};
+
+// construct the triangles around each vertex
+// assumes indicies align to make triangles
+VertexAdjacency ConstructVertexAdjacency( const std::vector< GLuint > & indices,
+                                          const size_t num_vertices );
+
 // construct the normals
 // assumes indicies align to make triangles
+// parallel splits large meshes across all hardware threads...
+// the results do not depend on the number of threads
 template < typename T >
 std::vector< Vector< T, 3 > > ConstructNormals( const std::vector< Vector< T, 3 > > & vertices,
-                                                const std::vector< GLuint > & indices );
+                                                const std::vector< GLuint > & indices,
+                                                const bool parallel = false );
 template < typename T >
 std::vector< Vector< T, 3 > > ConstructNormals( const std::vector< T > & vertices,
-                                                const std::vector< GLuint > & indices );
+                                                const std::vector< GLuint > & indices,
+                                                const bool parallel = false );
+
+// construct the normals from the triangles around each vertex
+// the results match the overloads without the adjacency
+template < typename T >
+std::vector< Vector< T, 3 > > ConstructNormals( const std::vector< Vector< T, 3 > > & vertices,
+                                                const std::vector< GLuint > & indices,
+                                                const VertexAdjacency & adjacency,
+                                                const bool parallel = false );
 
 // construct the tangents and bitangents
 // assumes indicies align to make triangles
 // first = tangents, second = bitangents
+// parallel splits large meshes across all hardware threads
 template < typename T >
 std::pair< std::vector< Vector< T, 3 > >, std::vector< Vector< T, 3 > > >
 ConstructTangentsAndBitangents( const std::vector< Vector< T, 3 > > & vertices,
                                 const std::vector< Vector< T, 3 > > & normals,
                                 const std::vector< Vector< T, 2 > > & tex_coords,
-                                const std::vector< GLuint > & indices );
+                                const std::vector< GLuint > & indices,
+                                const bool parallel = false );
 template < typename T >
 std::pair< std::vector< Vector< T, 3 > >, std::vector< Vector< T, 3 > > >
 ConstructTangentsAndBitangents( const std::vector< T > & vertices,
                                 const std::vector< T > & normals,
                                 const std::vector< T > & tex_coords,
-                                const std::vector< GLuint > & indices );
+                                const std::vector< GLuint > & indices,
+                                const bool parallel = false );
+
+// construct the tangents and bitangents from the triangles around each vertex
+// the results match the overloads without the adjacency
+template < typename T >
+std::pair< std::vector< Vector< T, 3 > >, std::vector< Vector< T, 3 > > >
+ConstructTangentsAndBitangents( const std::vector< Vector< T, 3 > > & vertices,
+                                const std::vector< Vector< T, 3 > > & normals,
+                                const std::vector< Vector< T, 2 > > & tex_coords,
+                                const std::vector< GLuint > & indices,
+                                const VertexAdjacency & adjacency,
+                                const bool parallel = false );
 
 // constructs a plane
 Shape ConstructPlane( const float width, const float height );
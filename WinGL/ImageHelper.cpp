@@ -0,0 +1,635 @@
+// local includes
+#include "ImageHelper.h"
+#include "Simd.h"
+#include "WglAssert.h"
+#include "ParallelFor.h"
+
+// std includes
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+namespace ImageHelper
+{
+
+namespace details
+{
+
+// minimum number of pixels handed to each thread
+const size_t PIXEL_GRAIN_SIZE = 16384;
+
+// half width of the kaiser filter in texels of the smaller level and the
+// shape of its window, the same defaults the nvidia texture tools use
+const double KAISER_WIDTH = 3.0;
+const double KAISER_ALPHA = 4.0;
+
+// clamps the value to [0, 1], nans become 0
+inline float Saturate( const float value )
+{
+   return value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+}
+
+// rounds the value in [0, 1] to the nearest 8 bit component
+inline uint8_t EncodeUnorm8( const float value )
+{
+   return static_cast< uint8_t >(Saturate(value) * 255.0f + 0.5f);
+}
+
+// divides the product of two 8 bit components by 255, rounding to the nearest
+inline uint8_t MultiplyUnorm8( const uint32_t a, const uint32_t b )
+{
+   const uint32_t t = a * b + 128;
+
+   return static_cast< uint8_t >((t + (t >> 8)) >> 8);
+}
+
+// srgb encoded 8 bit components to linear floats
+const float * SRGBDecodeTable( )
+{
+   static const std::array< float, 256 > table = [ ] ( )
+   {
+      std::array< float, 256 > table;
+
+      for (size_t i = 0; i < table.size(); ++i)
+      {
+         const double c = i / 255.0;
+
+         table[i] = static_cast< float >(c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4));
+      }
+
+      return table;
+   }();
+
+   return table.data();
+}
+
+// linear values quantized to 16 bits to srgb encoded 8 bit components...
+// the steps are fine enough that every 8 bit component survives a round trip
+const uint8_t * SRGBEncodeTable( )
+{
+   static const std::vector< uint8_t > table = [ ] ( )
+   {
+      std::vector< uint8_t > table(65536);
+
+      for (size_t i = 0; i < table.size(); ++i)
+      {
+         const double l = i / 65535.0;
+         const double c = l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+
+         table[i] = static_cast< uint8_t >(c * 255.0 + 0.5);
+      }
+
+      return table;
+   }();
+
+   return table.data();
+}
+
+inline uint8_t EncodeSRGB( const uint8_t * const pTable, const float value )
+{
+   return pTable[static_cast< uint32_t >(Saturate(value) * 65535.0f + 0.5f)];
+}
+
+// lane that holds the alpha of pixels with the number of components, 4 if none
+inline uint32_t AlphaLane( const uint32_t components )
+{
+   return components == 2 ? 1 : components == 4 ? 3 : 4;
+}
+
+// the source texels and their weights that make up each texel of a level
+// along one axis.  every texel has the same number of taps, the extra taps
+// have no weight.
+struct FilterTaps
+{
+   size_t                  num_taps;
+   std::vector< uint32_t > sources;
+   std::vector< float >    weights;
+};
+
+// modified bessel function of the first kind of order zero
+double BesselI0( const double x )
+{
+   double sum = 1.0, term = 1.0;
+
+   for (int k = 1; k < 32 && term > sum * 1.0e-12; ++k)
+   {
+      term *= (x / (2.0 * k)) * (x / (2.0 * k));
+      sum += term;
+   }
+
+   return sum;
+}
+
+// the filter at a distance in texels of the smaller level
+double KaiserWeight( const double t )
+{
+   if (std::abs(t) >= KAISER_WIDTH) return 0.0;
+
+   const double sinc = t == 0.0 ? 1.0 : std::sin(M_PI * t) / (M_PI * t);
+   const double ratio = t / KAISER_WIDTH;
+
+   return sinc * BesselI0(KAISER_ALPHA * std::sqrt(1.0 - ratio * ratio)) / BesselI0(KAISER_ALPHA);
+}
+
+FilterTaps ConstructTaps( const uint32_t src_size, const uint32_t dst_size, const MipFilter filter )
+{
+   const double scale = static_cast< double >(src_size) / dst_size;
+   const double radius = filter == MipFilter::BOX ? scale * 0.5 : scale * KAISER_WIDTH;
+
+   std::vector< std::vector< std::pair< uint32_t, double > > > texels(dst_size);
+
+   for (uint32_t x = 0; x < dst_size; ++x)
+   {
+      const double center = (x + 0.5) * scale;
+      const int64_t first = static_cast< int64_t >(std::floor(center - radius));
+      const int64_t last = static_cast< int64_t >(std::ceil(center + radius));
+
+      double sum = 0.0;
+
+      for (int64_t s = first; s < last; ++s)
+      {
+         // the weight of the source texel is the part of it the texel covers for
+         // the box, or the filter at the center of the source texel for the kaiser
+         const double weight = filter == MipFilter::BOX ?
+            std::max(0.0, std::min< double >(s + 1, center + radius) - std::max< double >(s, center - radius)) :
+            KaiserWeight((s + 0.5 - center) / scale);
+
+         if (weight == 0.0) continue;
+
+         // the edge texels repeat past the borders of the image
+         const uint32_t source = static_cast< uint32_t >(std::min< int64_t >(std::max< int64_t >(s, 0), src_size - 1));
+
+         if (!texels[x].empty() && texels[x].back().first == source)
+         {
+            texels[x].back().second += weight;
+         }
+         else
+         {
+            texels[x].emplace_back(source, weight);
+         }
+
+         sum += weight;
+      }
+
+      for (auto & texel : texels[x]) texel.second /= sum;
+   }
+
+   FilterTaps taps;
+   taps.num_taps = 0;
+
+   for (const auto & texel : texels) taps.num_taps = std::max(taps.num_taps, texel.size());
+
+   taps.sources.resize(dst_size * taps.num_taps);
+   taps.weights.resize(dst_size * taps.num_taps, 0.0f);
+
+   for (uint32_t x = 0; x < dst_size; ++x)
+   {
+      for (size_t i = 0; i < taps.num_taps; ++i)
+      {
+         const size_t tap = x * taps.num_taps + i;
+
+         taps.sources[tap] = i < texels[x].size() ? texels[x][i].first : texels[x].back().first;
+         taps.weights[tap] = i < texels[x].size() ? static_cast< float >(texels[x][i].second) : 0.0f;
+      }
+   }
+
+   return taps;
+}
+
+// rows of the image handed to each thread
+inline size_t RowGrainSize( const uint32_t width )
+{
+   return std::max< size_t >(PIXEL_GRAIN_SIZE / std::max< uint32_t >(width, 1), 1);
+}
+
+// 8 bit components to floats in [0, 1]
+const float * UnormDecodeTable( )
+{
+   static const std::array< float, 256 > table = [ ] ( )
+   {
+      std::array< float, 256 > table;
+
+      for (size_t i = 0; i < table.size(); ++i) table[i] = i * (1.0f / 255.0f);
+
+      return table;
+   }();
+
+   return table.data();
+}
+
+// expands 8 bit pixels of C components into four linear floats per pixel,
+// the lanes past the components are zero
+template < uint32_t C >
+void DecodePixels( const uint8_t * const pSrc, float * const pDst, const size_t num_pixels,
+                   const bool srgb, const bool alpha_weighted )
+{
+   const uint32_t alpha_lane = AlphaLane(C);
+   const bool weighted = alpha_weighted && alpha_lane < 4;
+
+   // a table per component, so the pixels convert without branches
+   const float * pDecode[C];
+
+   for (uint32_t c = 0; c < C; ++c)
+   {
+      pDecode[c] = srgb && c != alpha_lane ? SRGBDecodeTable() : UnormDecodeTable();
+   }
+
+   for (size_t i = 0; i < num_pixels; ++i)
+   {
+      float pixel[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+      for (uint32_t c = 0; c < C; ++c) pixel[c] = pDecode[c][pSrc[i * C + c]];
+
+      if (weighted)
+      {
+         for (uint32_t c = 0; c < C; ++c)
+         {
+            if (c != alpha_lane) pixel[c] *= pixel[alpha_lane % 4];
+         }
+      }
+
+      std::copy(pixel, pixel + 4, pDst + i * 4);
+   }
+}
+
+// packs linear floats, four per pixel, back into 8 bit pixels of C components
+template < uint32_t C >
+void EncodePixels( const float * const pSrc, uint8_t * const pDst, const size_t num_pixels,
+                   const bool srgb, const bool alpha_weighted )
+{
+   const uint8_t * const pEncode = SRGBEncodeTable();
+   const uint32_t alpha_lane = AlphaLane(C);
+   const bool weighted = alpha_weighted && alpha_lane < 4;
+
+   for (size_t i = 0; i < num_pixels; ++i)
+   {
+      const float * const pPixel = pSrc + i * 4;
+
+      // the colors are divided back out of the alpha they were weighted by
+      const float alpha = pPixel[alpha_lane % 4];
+      const float unweight = weighted ? (alpha > 0.0f ? 1.0f / alpha : 0.0f) : 1.0f;
+
+      for (uint32_t c = 0; c < C; ++c)
+      {
+         if (c == alpha_lane)
+         {
+            pDst[i * C + c] = EncodeUnorm8(alpha);
+         }
+         else
+         {
+            pDst[i * C + c] = srgb ? EncodeSRGB(pEncode, pPixel[c] * unweight) : EncodeUnorm8(pPixel[c] * unweight);
+         }
+      }
+   }
+}
+
+typedef void (* DecodeFunc)( const uint8_t * const, float * const, const size_t, const bool, const bool );
+typedef void (* EncodeFunc)( const float * const, uint8_t * const, const size_t, const bool, const bool );
+
+// the conversions for the number of components
+const DecodeFunc DECODE_PIXELS[] = { nullptr, &DecodePixels< 1 >, &DecodePixels< 2 >, &DecodePixels< 3 >, &DecodePixels< 4 > };
+const EncodeFunc ENCODE_PIXELS[] = { nullptr, &EncodePixels< 1 >, &EncodePixels< 2 >, &EncodePixels< 3 >, &EncodePixels< 4 > };
+
+// filters a row of four floats per pixel across
+void FilterAcross( const float * const pSrc, const FilterTaps & taps,
+                   float * const pDst, const uint32_t dst_width )
+{
+   typedef simd::Vec4< float > Vec4;
+
+   const uint32_t * pSource = taps.sources.data();
+   const float * pWeight = taps.weights.data();
+
+   for (uint32_t x = 0; x < dst_width; ++x)
+   {
+      Vec4 sum = Vec4::Splat(0.0f);
+
+      for (size_t i = 0; i < taps.num_taps; ++i, ++pSource, ++pWeight)
+      {
+         sum = sum + Vec4::Load(pSrc + *pSource * 4) * Vec4::Splat(*pWeight);
+      }
+
+      sum.Store(pDst + x * 4);
+   }
+}
+
+// filters the rows [begin, end) of a level from the level above...
+// get_row(row, pScratch) returns the row of the level above as four floats per
+// pixel, converting it into the scratch row if needed.  each row of the level
+// above is filtered across once into a ring that holds every row the taps of a
+// single row reach, so the rows shared by the kaiser taps are not filtered again.
+// the results are clamped, since the kaiser lobes can push them out of range.
+template < typename GetRow >
+void FilterLevel( const GetRow & get_row, const uint32_t src_width,
+                  const FilterTaps & across, const FilterTaps & down,
+                  const uint32_t dst_width, float * const pDst,
+                  const size_t begin, const size_t end )
+{
+   typedef simd::Vec4< float > Vec4;
+
+   const size_t num_slots = down.num_taps + 1;
+   const size_t row_size = static_cast< size_t >(dst_width) * 4;
+
+   std::vector< float > scratch(static_cast< size_t >(src_width) * 4);
+   std::vector< float > ring(num_slots * row_size);
+   std::vector< int64_t > slot_rows(num_slots, -1);
+
+   for (size_t y = begin; y < end; ++y)
+   {
+      float * const pDstRow = pDst + y * row_size;
+
+      std::fill(pDstRow, pDstRow + row_size, 0.0f);
+
+      for (size_t i = 0; i < down.num_taps; ++i)
+      {
+         const size_t tap = y * down.num_taps + i;
+
+         // the padding taps add nothing
+         if (down.weights[tap] == 0.0f) continue;
+
+         const uint32_t src_row = down.sources[tap];
+         const size_t slot = src_row % num_slots;
+         float * const pFiltered = ring.data() + slot * row_size;
+
+         if (slot_rows[slot] != src_row)
+         {
+            FilterAcross(get_row(src_row, scratch.data()), across, pFiltered, dst_width);
+
+            slot_rows[slot] = src_row;
+         }
+
+         const Vec4 weight = Vec4::Splat(down.weights[tap]);
+
+         for (size_t x = 0; x < row_size; x += 4)
+         {
+            (Vec4::Load(pDstRow + x) + Vec4::Load(pFiltered + x) * weight).Store(pDstRow + x);
+         }
+      }
+
+      for (float * pValue = pDstRow; pValue != pDstRow + row_size; ++pValue)
+      {
+         *pValue = Saturate(*pValue);
+      }
+   }
+}
+
+} // namespace details
+
+void RGBAToRGB( const uint8_t * const pSrc, uint8_t * const pDst, const size_t num_pixels )
+{
+   for (size_t i = 0; i < num_pixels; ++i)
+   {
+      pDst[i * 3 + 0] = pSrc[i * 4 + 0];
+      pDst[i * 3 + 1] = pSrc[i * 4 + 1];
+      pDst[i * 3 + 2] = pSrc[i * 4 + 2];
+   }
+}
+
+void RGBToRGBA( const uint8_t * const pSrc, uint8_t * const pDst, const size_t num_pixels, const uint8_t alpha )
+{
+   for (size_t i = 0; i < num_pixels; ++i)
+   {
+      pDst[i * 4 + 0] = pSrc[i * 3 + 0];
+      pDst[i * 4 + 1] = pSrc[i * 3 + 1];
+      pDst[i * 4 + 2] = pSrc[i * 3 + 2];
+      pDst[i * 4 + 3] = alpha;
+   }
+}
+
+void SwizzleRedBlue( const uint8_t * const pSrc, uint8_t * const pDst,
+                     const size_t num_pixels, const uint32_t components )
+{
+   WGL_ASSERT(components == 3 || components == 4);
+
+   if (components == 4)
+   {
+      // a whole pixel at a time, so the compiler can vectorize the shifts
+      for (size_t i = 0; i < num_pixels; ++i)
+      {
+         const uint8_t * const pSrcPixel = pSrc + i * 4;
+         uint8_t * const pDstPixel = pDst + i * 4;
+
+         const uint8_t r = pSrcPixel[0], g = pSrcPixel[1], b = pSrcPixel[2], a = pSrcPixel[3];
+
+         pDstPixel[0] = b; pDstPixel[1] = g; pDstPixel[2] = r; pDstPixel[3] = a;
+      }
+   }
+   else
+   {
+      for (size_t i = 0; i < num_pixels; ++i)
+      {
+         const uint8_t * const pSrcPixel = pSrc + i * 3;
+         uint8_t * const pDstPixel = pDst + i * 3;
+
+         const uint8_t r = pSrcPixel[0], g = pSrcPixel[1], b = pSrcPixel[2];
+
+         pDstPixel[0] = b; pDstPixel[1] = g; pDstPixel[2] = r;
+      }
+   }
+}
+
+void Expand8To16( const uint8_t * const pSrc, uint16_t * const pDst, const size_t count )
+{
+   for (size_t i = 0; i < count; ++i)
+   {
+      pDst[i] = static_cast< uint16_t >(pSrc[i] * 257u);
+   }
+}
+
+void Reduce16To8( const uint16_t * const pSrc, uint8_t * const pDst, const size_t count )
+{
+   for (size_t i = 0; i < count; ++i)
+   {
+      // the value over 257 rounded to the nearest
+      pDst[i] = static_cast< uint8_t >((pSrc[i] * 255u + 32895u) >> 16);
+   }
+}
+
+void Unorm8ToFloat( const uint8_t * const pSrc, float * const pDst, const size_t count )
+{
+   for (size_t i = 0; i < count; ++i)
+   {
+      pDst[i] = pSrc[i] * (1.0f / 255.0f);
+   }
+}
+
+void FloatToUnorm8( const float * const pSrc, uint8_t * const pDst, const size_t count )
+{
+   for (size_t i = 0; i < count; ++i)
+   {
+      pDst[i] = details::EncodeUnorm8(pSrc[i]);
+   }
+}
+
+void SRGBToLinear( const uint8_t * const pSrc, float * const pDst,
+                   const size_t num_pixels, const uint32_t components )
+{
+   const float * const pDecode = details::SRGBDecodeTable();
+   const uint32_t alpha_lane = details::AlphaLane(components);
+
+   for (size_t i = 0; i < num_pixels * components; i += components)
+   {
+      for (uint32_t c = 0; c < components; ++c)
+      {
+         pDst[i + c] = c == alpha_lane ? pSrc[i + c] * (1.0f / 255.0f) : pDecode[pSrc[i + c]];
+      }
+   }
+}
+
+void LinearToSRGB( const float * const pSrc, uint8_t * const pDst,
+                   const size_t num_pixels, const uint32_t components )
+{
+   const uint8_t * const pEncode = details::SRGBEncodeTable();
+   const uint32_t alpha_lane = details::AlphaLane(components);
+
+   for (size_t i = 0; i < num_pixels * components; i += components)
+   {
+      for (uint32_t c = 0; c < components; ++c)
+      {
+         pDst[i + c] = c == alpha_lane ? details::EncodeUnorm8(pSrc[i + c]) : details::EncodeSRGB(pEncode, pSrc[i + c]);
+      }
+   }
+}
+
+float SRGBToLinear( const uint8_t value )
+{
+   return details::SRGBDecodeTable()[value];
+}
+
+uint8_t LinearToSRGB( const float value )
+{
+   return details::EncodeSRGB(details::SRGBEncodeTable(), value);
+}
+
+void PremultiplyAlpha( const uint8_t * const pSrc, uint8_t * const pDst,
+                       const size_t num_pixels, const bool srgb )
+{
+   const float * const pDecode = details::SRGBDecodeTable();
+   const uint8_t * const pEncode = details::SRGBEncodeTable();
+
+   for (size_t i = 0; i < num_pixels * 4; i += 4)
+   {
+      const uint8_t alpha = pSrc[i + 3];
+
+      for (size_t c = 0; c < 3; ++c)
+      {
+         pDst[i + c] = srgb ? details::EncodeSRGB(pEncode, pDecode[pSrc[i + c]] * alpha * (1.0f / 255.0f)) :
+                              details::MultiplyUnorm8(pSrc[i + c], alpha);
+      }
+
+      pDst[i + 3] = alpha;
+   }
+}
+
+void UnpremultiplyAlpha( const uint8_t * const pSrc, uint8_t * const pDst,
+                         const size_t num_pixels, const bool srgb )
+{
+   const float * const pDecode = details::SRGBDecodeTable();
+   const uint8_t * const pEncode = details::SRGBEncodeTable();
+
+   for (size_t i = 0; i < num_pixels * 4; i += 4)
+   {
+      const uint32_t alpha = pSrc[i + 3];
+
+      for (size_t c = 0; c < 3; ++c)
+      {
+         if (!alpha)
+         {
+            pDst[i + c] = 0;
+         }
+         else if (srgb)
+         {
+            pDst[i + c] = details::EncodeSRGB(pEncode, pDecode[pSrc[i + c]] * 255.0f / alpha);
+         }
+         else
+         {
+            pDst[i + c] = static_cast< uint8_t >(std::min< uint32_t >((pSrc[i + c] * 255u + alpha / 2) / alpha, 255u));
+         }
+      }
+
+      pDst[i + 3] = static_cast< uint8_t >(alpha);
+   }
+}
+
+uint32_t NumMipLevels( const uint32_t width, const uint32_t height )
+{
+   uint32_t levels = 1;
+
+   for (uint32_t size = std::max(width, height); size > 1; size >>= 1) ++levels;
+
+   return levels;
+}
+
+std::vector< MipLevel > GenerateMipmaps( const uint8_t * const pPixels,
+                                         const uint32_t width,
+                                         const uint32_t height,
+                                         const uint32_t components,
+                                         const MipFilter filter,
+                                         const bool srgb,
+                                         const bool alpha_weighted,
+                                         const bool parallel )
+{
+   WGL_ASSERT(pPixels && width && height);
+   WGL_ASSERT(components >= 1 && components <= 4);
+
+   const details::DecodeFunc Decode = details::DECODE_PIXELS[components];
+   const details::EncodeFunc Encode = details::ENCODE_PIXELS[components];
+
+   std::vector< MipLevel > levels;
+   levels.reserve(NumMipLevels(width, height) - 1);
+
+   // the level above in linear floats, four per pixel.  the base is
+   // converted a row at a time as it is filtered, so it is never expanded.
+   std::vector< float > src;
+   std::vector< float > dst;
+
+   for (uint32_t src_width = width, src_height = height; src_width > 1 || src_height > 1; )
+   {
+      const uint32_t dst_width = std::max< uint32_t >(src_width / 2, 1);
+      const uint32_t dst_height = std::max< uint32_t >(src_height / 2, 1);
+
+      const details::FilterTaps across = details::ConstructTaps(src_width, dst_width, filter);
+      const details::FilterTaps down = details::ConstructTaps(src_height, dst_height, filter);
+
+      dst.resize(static_cast< size_t >(dst_width) * dst_height * 4);
+
+      levels.push_back(MipLevel { dst_width, dst_height, std::vector< uint8_t >(static_cast< size_t >(dst_width) * dst_height * components) });
+
+      uint8_t * const pLevel = levels.back().pixels.data();
+      const bool from_base = levels.size() == 1;
+
+      // builds and packs a tile of rows of the level
+      const auto Construct = [ & ] ( const size_t begin, const size_t end )
+      {
+         const auto GetRow = [ & ] ( const uint32_t row, float * const pScratch ) -> const float *
+         {
+            if (!from_base) return src.data() + static_cast< size_t >(row) * src_width * 4;
+
+            Decode(pPixels + static_cast< size_t >(row) * src_width * components, pScratch, src_width, srgb, alpha_weighted);
+
+            return pScratch;
+         };
+
+         details::FilterLevel(GetRow, src_width, across, down, dst_width, dst.data(), begin, end);
+
+         Encode(dst.data() + begin * dst_width * 4, pLevel + begin * dst_width * components,
+                (end - begin) * dst_width, srgb, alpha_weighted);
+      };
+
+      if (parallel)
+      {
+         ParallelFor(dst_height, details::RowGrainSize(dst_width), Construct);
+      }
+      else
+      {
+         Construct(0, dst_height);
+      }
+
+      src.swap(dst);
+      src_width = dst_width;
+      src_height = dst_height;
+   }
+
+   return levels;
+}
+
+} // namespace ImageHelper
@@ -0,0 +1,90 @@
+#ifndef _IMAGE_HELPER_H_
+#define _IMAGE_HELPER_H_
+
+// std includes
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// cpu image processing for textures.  the conversions work on tightly packed
+// pixels of 8, 16 or 32 bit components, and the mipmap builder produces whole
+// mip chains off of the gl thread, so they can be baked offline or built where
+// glGenerateMipmap is not available.
+namespace ImageHelper
+{
+
+// filters that reduce one mip level into the next
+enum class MipFilter
+{
+   BOX,        // averages the pixels each texel covers
+   KAISER      // kaiser windowed sinc, sharper with less aliasing
+};
+
+// a level of a mip chain, tightly packed with the components of the base
+struct MipLevel
+{
+   uint32_t                width;
+   uint32_t                height;
+   std::vector< uint8_t >  pixels;
+};
+
+// swaps between rgba and rgb, the alpha added is the one given
+void RGBAToRGB( const uint8_t * const pSrc, uint8_t * const pDst, const size_t num_pixels );
+void RGBToRGBA( const uint8_t * const pSrc, uint8_t * const pDst, const size_t num_pixels, const uint8_t alpha = 255 );
+
+// swaps the red and blue components of 3 or 4 component pixels, so it
+// converts rgb to bgr, rgba to bgra, and back.  the source and destination
+// may be the same.
+void SwizzleRedBlue( const uint8_t * const pSrc, uint8_t * const pDst,
+                     const size_t num_pixels, const uint32_t components );
+
+// converts between 8 and 16 bit components, rounding to the nearest
+void Expand8To16( const uint8_t * const pSrc, uint16_t * const pDst, const size_t count );
+void Reduce16To8( const uint16_t * const pSrc, uint8_t * const pDst, const size_t count );
+
+// converts between 8 bit components and floats in [0, 1]...
+// the floats are clamped and rounded to the nearest
+void Unorm8ToFloat( const uint8_t * const pSrc, float * const pDst, const size_t count );
+void FloatToUnorm8( const float * const pSrc, uint8_t * const pDst, const size_t count );
+
+// converts between srgb encoded pixels and linear floats.  the alpha
+// component of 2 and 4 component pixels is linear and copied as is.
+void SRGBToLinear( const uint8_t * const pSrc, float * const pDst,
+                   const size_t num_pixels, const uint32_t components );
+void LinearToSRGB( const float * const pSrc, uint8_t * const pDst,
+                   const size_t num_pixels, const uint32_t components );
+
+// converts a single component between srgb and linear
+float SRGBToLinear( const uint8_t value );
+uint8_t LinearToSRGB( const float value );
+
+// multiplies or divides the colors of rgba pixels by their alpha...
+// srgb colors are scaled in linear space.  the source and destination may be the same.
+void PremultiplyAlpha( const uint8_t * const pSrc, uint8_t * const pDst,
+                       const size_t num_pixels, const bool srgb = false );
+void UnpremultiplyAlpha( const uint8_t * const pSrc, uint8_t * const pDst,
+                         const size_t num_pixels, const bool srgb = false );
+
+// number of levels in a full mip chain, including the base
+uint32_t NumMipLevels( const uint32_t width, const uint32_t height );
+
+// builds the levels below the base down to 1x1 from 8 bit pixels of 1 to 4
+// components.  every level is filtered from a float copy of the level above,
+// so the error does not build up through the chain.
+//
+// srgb colors are filtered in linear space.  alpha weighting keeps the colors
+// of transparent pixels from bleeding into their neighbours; a 4 component
+// base that is already premultiplied should not ask for it.  the levels are
+// split into tiles of rows across the hardware threads when parallel.
+std::vector< MipLevel > GenerateMipmaps( const uint8_t * const pPixels,
+                                         const uint32_t width,
+                                         const uint32_t height,
+                                         const uint32_t components,
+                                         const MipFilter filter = MipFilter::BOX,
+                                         const bool srgb = false,
+                                         const bool alpha_weighted = false,
+                                         const bool parallel = false );
+
+} // namespace ImageHelper
+
+#endif // _IMAGE_HELPER_H_
@@ -0,0 +1,194 @@
+// local includes
+#include "JobPool.h"
+#include "WglAssert.h"
+
+// std includes
+#include <algorithm>
+
+JobPool::JobPool( const size_t num_threads ) :
+mpFn        ( nullptr ),
+mBusy       ( false ),
+mQueued     ( 0 ),
+mRemaining  ( 0 ),
+mStop       ( false )
+{
+   const size_t threads = num_threads ? num_threads : std::max< size_t >(std::thread::hardware_concurrency(), 1);
+
+   for (size_t i = 0; i < threads; ++i)
+   {
+      mQueues.emplace_back(new Queue);
+   }
+
+   // the caller is the first thread
+   mThreads.reserve(threads - 1);
+
+   for (size_t i = 1; i < threads; ++i)
+   {
+      mThreads.emplace_back(&JobPool::Work, this, i);
+   }
+}
+
+JobPool::~JobPool( )
+{
+   {
+      std::lock_guard< std::mutex > lock(mWakeMutex);
+      mStop = true;
+   }
+
+   mWake.notify_all();
+
+   for (auto & thread : mThreads) thread.join();
+}
+
+JobPool & JobPool::Shared( )
+{
+   // started the first time it is asked for and joined at exit
+   static JobPool pool;
+
+   return pool;
+}
+
+void JobPool::ParallelFor( const size_t count,
+                           const size_t grain_size,
+                           const std::function< void ( size_t, size_t ) > & fn )
+{
+   const size_t grain = std::max< size_t >(grain_size, 1);
+   const size_t num_jobs = (count + grain - 1) / grain;
+   const size_t num_queues = mQueues.size();
+
+   bool idle = false;
+
+   if (num_jobs <= 1 || num_queues == 1 || !mBusy.compare_exchange_strong(idle, true))
+   {
+      if (count) fn(0, count);
+
+      return;
+   }
+
+   WGL_ASSERT(!mpFn);
+
+   mpFn = &fn;
+   mRemaining = num_jobs;
+
+   // each thread starts with a contiguous run of the jobs...  the jobs are
+   // counted before they can be taken, as a thread still finishing the last
+   // call may take one of them as soon as it is queued
+   for (size_t thread = 0; thread < num_queues; ++thread)
+   {
+      Queue & queue = *mQueues[thread];
+
+      std::lock_guard< std::mutex > lock(queue.mutex);
+
+      const size_t first = thread * num_jobs / num_queues;
+      const size_t last = (thread + 1) * num_jobs / num_queues;
+
+      mQueued += last - first;
+
+      for (size_t job = first; job < last; ++job)
+      {
+         const Job range = { job * grain, std::min(job * grain + grain, count) };
+
+         queue.jobs.push_back(range);
+      }
+   }
+
+   // a thread between testing for jobs and waiting holds the lock, so
+   // taking it here keeps the wake from being missed
+   {
+      std::lock_guard< std::mutex > lock(mWakeMutex);
+   }
+
+   mWake.notify_all();
+
+   RunJobs(0);
+
+   // the other threads may still be running the last jobs they took
+   {
+      std::unique_lock< std::mutex > lock(mDoneMutex);
+      mDone.wait(lock, [ this ] ( ) { return mRemaining == 0; });
+   }
+
+   mpFn = nullptr;
+
+   // hand the failure of a job to the caller
+   std::exception_ptr pError;
+   pError.swap(mpError);
+
+   mBusy = false;
+
+   if (pError) std::rethrow_exception(pError);
+}
+
+bool JobPool::TakeJob( const size_t thread, Job & job )
+{
+   const size_t num_queues = mQueues.size();
+
+   for (size_t i = 0; i < num_queues; ++i)
+   {
+      Queue & queue = *mQueues[(thread + i) % num_queues];
+
+      std::lock_guard< std::mutex > lock(queue.mutex);
+
+      if (!queue.jobs.empty())
+      {
+         // the thread works its own jobs in order and steals from the far end of the others
+         if (i == 0)
+         {
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+         }
+         else
+         {
+            job = queue.jobs.back();
+            queue.jobs.pop_back();
+         }
+
+         --mQueued;
+
+         return true;
+      }
+   }
+
+   return false;
+}
+
+void JobPool::RunJobs( const size_t thread )
+{
+   Job job = { };
+
+   while (TakeJob(thread, job))
+   {
+      // a job that throws must still be counted, or the caller waits forever
+      try
+      {
+         (*mpFn)(job.begin, job.end);
+      }
+      catch ( ... )
+      {
+         std::lock_guard< std::mutex > lock(mDoneMutex);
+
+         if (!mpError) mpError = std::current_exception();
+      }
+
+      if (--mRemaining == 0)
+      {
+         std::lock_guard< std::mutex > lock(mDoneMutex);
+         mDone.notify_one();
+      }
+   }
+}
+
+void JobPool::Work( const size_t thread )
+{
+   for (;;)
+   {
+      {
+         std::unique_lock< std::mutex > lock(mWakeMutex);
+         mWake.wait(lock, [ this ] ( ) { return mStop || mQueued > 0; });
+
+         if (mStop) return;
+      }
+
+      RunJobs(thread);
+   }
+}
@@ -0,0 +1,102 @@
+#ifndef _JOB_POOL_H_
+#define _JOB_POOL_H_
+
+// std includes
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+// a pool of worker threads that run ranges of work...
+// the threads are started once and kept waiting, and a range is split into
+// many more jobs than threads.  each thread has its own queue of jobs and
+// takes from the front of it, and a thread that runs out steals from the
+// back of the others, so uneven jobs still keep every thread busy.  the
+// calling thread works on the jobs along with the pool.
+class JobPool
+{
+public:
+   // constructor / destructor...
+   // the threads include the caller, zero uses the hardware threads
+   explicit JobPool( const size_t num_threads = 0 );
+           ~JobPool( );
+
+   // the pool shared by ParallelFor, created with the hardware threads on first use
+   static JobPool & Shared( );
+
+   // threads that run the jobs, including the caller
+   size_t NumThreads( ) const { return mQueues.size(); }
+
+   // jobs queued and not yet taken, zero whenever no jobs are being run
+   size_t NumQueued( ) const { return mQueued; }
+
+   // splits [0, count) into jobs of grain_size items and calls fn(begin, end)
+   // for each job across the threads, returning once all the jobs completed.
+   // the first exception thrown by the jobs is rethrown here once all of them completed.
+   // a call made while the pool is running the jobs of another call, such as
+   // from another thread or from inside a job, runs all of its work on the caller.
+   void ParallelFor( const size_t count,
+                     const size_t grain_size,
+                     const std::function< void ( size_t, size_t ) > & fn );
+
+private:
+   // prohibit copy construction and assignment
+   JobPool( const JobPool & );
+   JobPool & operator = ( const JobPool & );
+
+   // a range of the work
+   struct Job
+   {
+      size_t   begin;
+      size_t   end;
+   };
+
+   // the jobs of a thread, guarded by its own lock
+   struct Queue
+   {
+      std::mutex        mutex;
+      std::deque< Job > jobs;
+   };
+
+   // takes a job from the front of the thread's queue or the back of another's
+   bool TakeJob( const size_t thread, Job & job );
+
+   // runs jobs as the thread until there are none left to take
+   void RunJobs( const size_t thread );
+
+   // waits for jobs and runs them until the pool is destroyed
+   void Work( const size_t thread );
+
+   // one queue per thread, the caller's is the first
+   std::vector< std::unique_ptr< Queue > >   mQueues;
+   std::vector< std::thread >                mThreads;
+
+   // the work being run, set only by the call that holds the pool
+   const std::function< void ( size_t, size_t ) > * mpFn;
+   std::atomic< bool >     mBusy;
+
+   // jobs queued and not yet taken, and jobs not yet completed
+   std::atomic< size_t >   mQueued;
+   std::atomic< size_t >   mRemaining;
+
+   // wakes the threads when jobs are queued or the pool is destroyed
+   std::mutex              mWakeMutex;
+   std::condition_variable mWake;
+   bool                    mStop;
+
+   // wakes the caller when the last job completes
+   std::mutex              mDoneMutex;
+   std::condition_variable mDone;
+
+   // the first exception thrown by the jobs, guarded by the done lock
+   std::exception_ptr      mpError;
+
+};
+
+#endif // _JOB_POOL_H_
@@ -0,0 +1,646 @@
+#ifndef _LOOSE_OCTREE_H_
+#define _LOOSE_OCTREE_H_
+
+// local includes
+#include "Aabb.h"
+#include "Vector.h"
+#include "Frustum.h"
+#include "WglAssert.h"
+
+// std includes
+#include <limits>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+// an octree whose cells are loose, bounding twice their size...
+// an object is kept in the deepest cell there is that holds its center and
+// is at least as large as the object, which the loose bounds of the cell
+// always contain.  a cell is split once it holds more than a few objects, so
+// sparse parts of the tree stay shallow.  objects are inserted, moved and
+// removed without rebuilding anything, and a move only relinks the object
+// when it changes cells.  cells are never merged.  the boxes of the objects
+// in a cell are stored together, so walking a cell reads them in order.  the
+// cells are stored in one array with the eight children of a cell next to
+// each other, and the bounds of a cell are found from its place in the tree
+// as it is walked.
+// objects with their center outside of the tree are kept in the root.
+template < typename T >
+class LooseOctree
+{
+public:
+   // basic type of the class
+   typedef T type;
+
+   // returned by the ray queries when nothing is hit
+   static constexpr uint32_t NO_OBJECT = static_cast< uint32_t >(-1);
+
+   // deepest the cells can be below the root
+   static constexpr uint32_t MAX_DEPTH = 16;
+
+   // constructor...
+   // the tree is a cube around the bounds that is split up to depth times
+   explicit LooseOctree( const Aabb< T > & bounds, const uint32_t depth = 8 );
+
+   // number of objects and cells in the tree
+   size_t NumObjects( ) const { return mNumObjects; }
+   size_t NumNodes( ) const { return mNodes.size(); }
+
+   // removes all the objects
+   void Clear( );
+
+   // adds an object, returning its id...  ids of removed objects are reused
+   uint32_t Insert( const Aabb< T > & box );
+
+   // removes an object
+   void Remove( const uint32_t object );
+
+   // moves an object to a new box
+   void Move( const uint32_t object, const Aabb< T > & box );
+
+   // the box of an object
+   const Aabb< T > & GetBox( const uint32_t object ) const { return mNodes[mObjects[object].node].entries[mObjects[object].slot].box; }
+
+   // calls fn(object) for each object whose box overlaps the box, sphere or frustum
+   template < typename Fn >
+   void QueryBox( const Aabb< T > & box, Fn && fn ) const;
+   template < typename Fn >
+   void QuerySphere( const Vector< T, 3 > & center, const T & radius, Fn && fn ) const;
+   template < typename Fn >
+   void QueryFrustum( const Frustum< T > & frustum, Fn && fn ) const;
+
+   // finds the nearest object along the ray within the distance, returning
+   // the object or NO_OBJECT and setting the distance to the hit...
+   // intersect(object, distance) tests an object whose box the ray enters,
+   // and when it hits the object closer than the distance it returns true
+   // and sets the distance to the hit.  the overload without intersect hits
+   // the boxes of the objects.
+   template < typename Fn >
+   uint32_t QueryRay( const Vector< T, 3 > & origin,
+                      const Vector< T, 3 > & direction,
+                      T & distance,
+                      Fn && intersect ) const;
+   uint32_t QueryRay( const Vector< T, 3 > & origin,
+                      const Vector< T, 3 > & direction,
+                      T & distance ) const;
+
+   // finds the k objects whose boxes are nearest the point, nearest first
+   void QueryNearest( const Vector< T, 3 > & point,
+                      const size_t k,
+                      std::vector< uint32_t > & objects ) const;
+
+private:
+   // an object in a cell and its box
+   struct Entry
+   {
+      Aabb< T >   box;
+      uint32_t    object;
+   };
+
+   // a cell of the tree...  the children are the eight cells starting at
+   // children, or zero if the cell was never split.  count is the number of
+   // objects in the cell and in all the cells below it.
+   struct Node
+   {
+      uint32_t                parent;
+      uint32_t                children;
+      uint32_t                count;
+      std::vector< Entry >    entries;
+   };
+
+   // the cell of an object and its slot in the entries of the cell
+   struct Object
+   {
+      uint32_t    node;
+      uint32_t    slot;
+   };
+
+   // objects a cell holds before it is split
+   static constexpr uint32_t SPLIT_SIZE = 8;
+
+   // a cell being walked, with its center and half its size
+   struct Cell
+   {
+      uint32_t       node;
+      Vector< T, 3 > center;
+      T              half_size;
+      T              distance;
+   };
+
+   // the loose bounds of a cell
+   static Aabb< T > LooseBounds( const Cell & cell );
+
+   // the children of a cell
+   Cell Child( const Cell & cell, const uint32_t octant ) const;
+
+   // finds the deepest cell there is for a box, and its depth
+   Cell FindCell( const Aabb< T > & box, uint32_t & depth ) const;
+
+   // adds the object to the entries of its cell or removes it, the last
+   // entry of the cell taking its slot
+   void Link( const uint32_t object, const uint32_t node, const Aabb< T > & box );
+   void Unlink( const uint32_t object );
+
+   // links the object into its cell, splitting the cell when it holds too many
+   void Place( const uint32_t object, const Aabb< T > & box, const Cell & cell, const uint32_t depth );
+
+   // adds the children of a cell, moving down the objects that fit them
+   void Split( const Cell & cell, const uint32_t depth );
+
+   // calls fn(object) for each object whose box passes the test, skipping
+   // the cells whose loose bounds fail it...  the objects of the cells whose
+   // loose bounds pass the contains test are all within the query, so are
+   // not tested
+   template < typename Test, typename Contains, typename Fn >
+   void Query( Test && test, Contains && contains, Fn && fn ) const;
+
+   // calls fn(object) for every object in the cell and the cells below it
+   template < typename Fn >
+   void QueryAll( const uint32_t node, Fn && fn ) const;
+
+   std::vector< Node >        mNodes;
+   std::vector< Object >      mObjects;
+
+   // ids of the removed objects
+   std::vector< uint32_t >    mFree;
+
+   size_t                     mNumObjects;
+
+   // the cube of the root
+   Vector< T, 3 >             mCenter;
+   T                          mHalfSize;
+   uint32_t                   mDepth;
+
+};
+
+template < typename T >
+inline LooseOctree< T >::LooseOctree( const Aabb< T > & bounds, const uint32_t depth ) :
+mNumObjects ( 0 ),
+mCenter     ( bounds.GetCenter() ),
+mHalfSize   ( std::max(std::max(bounds.GetExtent()[0], bounds.GetExtent()[1]), bounds.GetExtent()[2]) ),
+mDepth      ( std::min(depth, MAX_DEPTH) )
+{
+   WGL_ASSERT(!bounds.IsEmpty());
+
+   Clear();
+}
+
+template < typename T >
+inline void LooseOctree< T >::Clear( )
+{
+   mNodes.assign(1, Node { NO_OBJECT, 0, 0, std::vector< Entry >() });
+   mObjects.clear();
+   mFree.clear();
+
+   mNumObjects = 0;
+}
+
+template < typename T >
+inline Aabb< T > LooseOctree< T >::LooseBounds( const Cell & cell )
+{
+   const Vector< T, 3 > loose(cell.half_size * static_cast< T >(2));
+
+   return Aabb< T >(cell.center - loose, cell.center + loose);
+}
+
+template < typename T >
+inline typename LooseOctree< T >::Cell LooseOctree< T >::Child( const Cell & cell, const uint32_t octant ) const
+{
+   const T half_size = cell.half_size * static_cast< T >(0.5);
+
+   const Cell child =
+   {
+      mNodes[cell.node].children + octant,
+      Vector< T, 3 >(cell.center[0] + (octant & 1 ? half_size : -half_size),
+                     cell.center[1] + (octant & 2 ? half_size : -half_size),
+                     cell.center[2] + (octant & 4 ? half_size : -half_size)),
+      half_size,
+      static_cast< T >(0)
+   };
+
+   return child;
+}
+
+template < typename T >
+inline typename LooseOctree< T >::Cell LooseOctree< T >::FindCell( const Aabb< T > & box, uint32_t & depth ) const
+{
+   const Vector< T, 3 > center = box.GetCenter();
+   const Vector< T, 3 > extent = box.GetExtent();
+   const T size = std::max(std::max(extent[0], extent[1]), extent[2]);
+
+   Cell cell = { 0, mCenter, mHalfSize, static_cast< T >(0) };
+
+   depth = 0;
+
+   if (!Aabb< T >(mCenter - Vector< T, 3 >(mHalfSize), mCenter + Vector< T, 3 >(mHalfSize)).Contains(center))
+   {
+      return cell;
+   }
+
+   // the object fits the loose bounds of any cell at least as large as it
+   for (; depth < mDepth && size <= cell.half_size * static_cast< T >(0.5) && mNodes[cell.node].children; ++depth)
+   {
+      const uint32_t octant =
+         (center[0] >= cell.center[0] ? 1 : 0) |
+         (center[1] >= cell.center[1] ? 2 : 0) |
+         (center[2] >= cell.center[2] ? 4 : 0);
+
+      cell = Child(cell, octant);
+   }
+
+   return cell;
+}
+
+template < typename T >
+inline void LooseOctree< T >::Link( const uint32_t object, const uint32_t node, const Aabb< T > & box )
+{
+   Object & linked = mObjects[object];
+
+   linked.node = node;
+   linked.slot = static_cast< uint32_t >(mNodes[node].entries.size());
+
+   mNodes[node].entries.push_back(Entry { box, object });
+
+   for (uint32_t parent = node; parent != NO_OBJECT; parent = mNodes[parent].parent)
+   {
+      ++mNodes[parent].count;
+   }
+}
+
+template < typename T >
+inline void LooseOctree< T >::Unlink( const uint32_t object )
+{
+   Object & linked = mObjects[object];
+   std::vector< Entry > & entries = mNodes[linked.node].entries;
+
+   entries[linked.slot] = entries.back();
+   mObjects[entries[linked.slot].object].slot = linked.slot;
+   entries.pop_back();
+
+   for (uint32_t parent = linked.node; parent != NO_OBJECT; parent = mNodes[parent].parent)
+   {
+      --mNodes[parent].count;
+   }
+
+   linked.node = NO_OBJECT;
+}
+
+template < typename T >
+inline void LooseOctree< T >::Place( const uint32_t object, const Aabb< T > & box, const Cell & cell, const uint32_t depth )
+{
+   Link(object, cell.node, box);
+
+   // without children the count is that of the objects in the cell
+   if (!mNodes[cell.node].children && mNodes[cell.node].count > SPLIT_SIZE && depth < mDepth)
+   {
+      Split(cell, depth);
+   }
+}
+
+template < typename T >
+inline void LooseOctree< T >::Split( const Cell & cell, const uint32_t depth )
+{
+   const uint32_t children = static_cast< uint32_t >(mNodes.size());
+   mNodes.resize(mNodes.size() + 8, Node { cell.node, 0, 0, std::vector< Entry >() });
+   mNodes[cell.node].children = children;
+
+   // the objects are found their cells again, which are now the children
+   // for those small enough, so they end up where an insert would put them...
+   // the entries are walked from the back, so the entry that takes the slot
+   // of one that is moved down has already been found its cell
+   for (size_t slot = mNodes[cell.node].entries.size(); slot-- > 0; )
+   {
+      const Entry entry = mNodes[cell.node].entries[slot];
+
+      uint32_t found_depth = 0;
+      const Cell found = FindCell(entry.box, found_depth);
+
+      if (found.node != cell.node)
+      {
+         Unlink(entry.object);
+         Link(entry.object, found.node, entry.box);
+      }
+   }
+
+   for (uint32_t octant = 0; octant < 8; ++octant)
+   {
+      if (mNodes[children + octant].count > SPLIT_SIZE && depth + 1 < mDepth)
+      {
+         Split(Child(cell, octant), depth + 1);
+      }
+   }
+}
+
+template < typename T >
+inline uint32_t LooseOctree< T >::Insert( const Aabb< T > & box )
+{
+   uint32_t object = 0;
+
+   if (mFree.empty())
+   {
+      object = static_cast< uint32_t >(mObjects.size());
+      mObjects.emplace_back();
+   }
+   else
+   {
+      object = mFree.back();
+      mFree.pop_back();
+   }
+
+   uint32_t depth = 0;
+   const Cell cell = FindCell(box, depth);
+
+   Place(object, box, cell, depth);
+
+   ++mNumObjects;
+
+   return object;
+}
+
+template < typename T >
+inline void LooseOctree< T >::Remove( const uint32_t object )
+{
+   WGL_ASSERT(mObjects[object].node != NO_OBJECT);
+
+   Unlink(object);
+
+   mFree.push_back(object);
+
+   --mNumObjects;
+}
+
+template < typename T >
+inline void LooseOctree< T >::Move( const uint32_t object, const Aabb< T > & box )
+{
+   WGL_ASSERT(mObjects[object].node != NO_OBJECT);
+
+   uint32_t depth = 0;
+   const Cell cell = FindCell(box, depth);
+
+   if (cell.node != mObjects[object].node)
+   {
+      Unlink(object);
+      Place(object, box, cell, depth);
+   }
+   else
+   {
+      mNodes[cell.node].entries[mObjects[object].slot].box = box;
+   }
+}
+
+template < typename T >
+template < typename Test, typename Contains, typename Fn >
+inline void LooseOctree< T >::Query( Test && test, Contains && contains, Fn && fn ) const
+{
+   // each level leaves at most seven of the children waiting
+   Cell stack[7 * MAX_DEPTH + 1];
+   uint32_t size = 0;
+
+   // the root also holds the objects outside of its bounds, so it is always walked
+   stack[size++] = { 0, mCenter, mHalfSize, static_cast< T >(0) };
+
+   while (size)
+   {
+      const Cell cell = stack[--size];
+      const Node & node = mNodes[cell.node];
+
+      for (const Entry & entry : node.entries)
+      {
+         if (test(entry.box)) fn(entry.object);
+      }
+
+      if (node.children)
+      {
+         for (uint32_t octant = 0; octant < 8; ++octant)
+         {
+            if (!mNodes[node.children + octant].count) continue;
+
+            const Cell child = Child(cell, octant);
+            const Aabb< T > bounds = LooseBounds(child);
+
+            if (contains(bounds))
+            {
+               QueryAll(child.node, fn);
+            }
+            else if (test(bounds))
+            {
+               stack[size++] = child;
+            }
+         }
+      }
+   }
+}
+
+template < typename T >
+template < typename Fn >
+inline void LooseOctree< T >::QueryAll( const uint32_t node, Fn && fn ) const
+{
+   uint32_t stack[7 * MAX_DEPTH + 1];
+   uint32_t size = 0;
+
+   stack[size++] = node;
+
+   while (size)
+   {
+      const Node & current = mNodes[stack[--size]];
+
+      for (const Entry & entry : current.entries)
+      {
+         fn(entry.object);
+      }
+
+      if (current.children)
+      {
+         for (uint32_t octant = 0; octant < 8; ++octant)
+         {
+            if (mNodes[current.children + octant].count) stack[size++] = current.children + octant;
+         }
+      }
+   }
+}
+
+template < typename T >
+template < typename Fn >
+inline void LooseOctree< T >::QueryBox( const Aabb< T > & box, Fn && fn ) const
+{
+   Query([ & ] ( const Aabb< T > & bounds ) { return bounds.Intersects(box); },
+         [ & ] ( const Aabb< T > & bounds ) { return box.Contains(bounds); }, fn);
+}
+
+template < typename T >
+template < typename Fn >
+inline void LooseOctree< T >::QuerySphere( const Vector< T, 3 > & center, const T & radius, Fn && fn ) const
+{
+   Query([ & ] ( const Aabb< T > & bounds ) { return bounds.IntersectsSphere(center, radius); },
+         [ & ] ( const Aabb< T > & bounds ) { return bounds.WithinSphere(center, radius); }, fn);
+}
+
+template < typename T >
+template < typename Fn >
+inline void LooseOctree< T >::QueryFrustum( const Frustum< T > & frustum, Fn && fn ) const
+{
+   Query([ & ] ( const Aabb< T > & bounds ) { return frustum.IntersectsBox(bounds.mMin, bounds.mMax); },
+         [ & ] ( const Aabb< T > & bounds ) { return frustum.ContainsBox(bounds.mMin, bounds.mMax); }, fn);
+}
+
+template < typename T >
+template < typename Fn >
+inline uint32_t LooseOctree< T >::QueryRay( const Vector< T, 3 > & origin,
+                                            const Vector< T, 3 > & direction,
+                                            T & distance,
+                                            Fn && intersect ) const
+{
+   uint32_t hit = NO_OBJECT;
+
+   const Vector< T, 3 > inv_direction(static_cast< T >(1) / direction[0],
+                                      static_cast< T >(1) / direction[1],
+                                      static_cast< T >(1) / direction[2]);
+
+   Cell stack[7 * MAX_DEPTH + 1];
+   uint32_t size = 0;
+
+   stack[size++] = { 0, mCenter, mHalfSize, static_cast< T >(0) };
+
+   while (size)
+   {
+      const Cell cell = stack[--size];
+
+      // a closer hit may have been found since the cell was pushed
+      if (cell.distance > distance) continue;
+
+      const Node & node = mNodes[cell.node];
+
+      T enter = static_cast< T >(0);
+
+      for (const Entry & entry : node.entries)
+      {
+         if (entry.box.IntersectsRay(origin, inv_direction, distance, enter) &&
+             intersect(entry.object, distance))
+         {
+            hit = entry.object;
+         }
+      }
+
+      if (node.children)
+      {
+         // the children the ray enters, pushed furthest first so the nearest is visited first
+         Cell children[8];
+         uint32_t num_children = 0;
+
+         for (uint32_t octant = 0; octant < 8; ++octant)
+         {
+            if (!mNodes[node.children + octant].count) continue;
+
+            Cell child = Child(cell, octant);
+
+            if (LooseBounds(child).IntersectsRay(origin, inv_direction, distance, child.distance))
+            {
+               // an insertion sort, as there are never more than eight
+               uint32_t i = num_children++;
+
+               for (; i > 0 && children[i - 1].distance < child.distance; --i)
+               {
+                  children[i] = children[i - 1];
+               }
+
+               children[i] = child;
+            }
+         }
+
+         for (uint32_t child = 0; child < num_children; ++child)
+         {
+            stack[size++] = children[child];
+         }
+      }
+   }
+
+   return hit;
+}
+
+template < typename T >
+inline uint32_t LooseOctree< T >::QueryRay( const Vector< T, 3 > & origin,
+                                            const Vector< T, 3 > & direction,
+                                            T & distance ) const
+{
+   const Vector< T, 3 > inv_direction(static_cast< T >(1) / direction[0],
+                                      static_cast< T >(1) / direction[1],
+                                      static_cast< T >(1) / direction[2]);
+
+   return QueryRay(origin, direction, distance,
+      [ & ] ( const uint32_t object, T & max_distance )
+      {
+         T enter = static_cast< T >(0);
+
+         if (GetBox(object).IntersectsRay(origin, inv_direction, max_distance, enter) && enter < max_distance)
+         {
+            max_distance = enter;
+
+            return true;
+         }
+
+         return false;
+      });
+}
+
+template < typename T >
+inline void LooseOctree< T >::QueryNearest( const Vector< T, 3 > & point,
+                                            const size_t k,
+                                            std::vector< uint32_t > & objects ) const
+{
+   objects.clear();
+
+   if (!k || !mNumObjects) return;
+
+   details::NearestBoxes< T > nearest(k);
+
+   // the cells to visit as a heap with the nearest on top
+   std::vector< Cell > cells;
+   const auto Further = [ ] ( const Cell & a, const Cell & b ) { return a.distance > b.distance; };
+
+   cells.push_back({ 0, mCenter, mHalfSize, static_cast< T >(0) });
+
+   while (!cells.empty())
+   {
+      std::pop_heap(cells.begin(), cells.end(), Further);
+
+      const Cell cell = cells.back();
+      cells.pop_back();
+
+      // every cell left is further than the furthest of the nearest
+      if (cell.distance >= nearest.Bound()) break;
+
+      const Node & node = mNodes[cell.node];
+
+      for (const Entry & entry : node.entries)
+      {
+         nearest.Add(entry.box.DistanceSquared(point), entry.object);
+      }
+
+      if (node.children)
+      {
+         for (uint32_t octant = 0; octant < 8; ++octant)
+         {
+            if (!mNodes[node.children + octant].count) continue;
+
+            Cell child = Child(cell, octant);
+
+            child.distance = LooseBounds(child).DistanceSquared(point);
+
+            if (child.distance < nearest.Bound())
+            {
+               cells.push_back(child);
+               std::push_heap(cells.begin(), cells.end(), Further);
+            }
+         }
+      }
+   }
+
+   nearest.Sort(objects);
+}
+
+// global typedefs
+typedef LooseOctree< float > LooseOctreef;
+typedef LooseOctree< double > LooseOctreed;
+
+#endif // _LOOSE_OCTREE_H_
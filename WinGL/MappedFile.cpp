@@ -0,0 +1,119 @@
+// local includes
+#include "MappedFile.h"
+
+// platform includes
+#if defined( _WIN32 )
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// std includes
+#include <utility>
+
+MappedFile::MappedFile( ) :
+mpData      ( nullptr ),
+mSize       ( 0 ),
+mpFile      ( nullptr ),
+mpMapping   ( nullptr )
+{
+}
+
+MappedFile::~MappedFile( )
+{
+   Close();
+}
+
+MappedFile::MappedFile( MappedFile && file ) :
+MappedFile()
+{
+   *this = std::move(file);
+}
+
+MappedFile & MappedFile::operator = ( MappedFile && file )
+{
+   std::swap(mpData, file.mpData);
+   std::swap(mSize, file.mSize);
+   std::swap(mpFile, file.mpFile);
+   std::swap(mpMapping, file.mpMapping);
+
+   return *this;
+}
+
+bool MappedFile::Open( const char * const pFilename )
+{
+   Close();
+
+#if defined( _WIN32 )
+
+   const HANDLE file = CreateFileA(pFilename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                   OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+   if (file == INVALID_HANDLE_VALUE) return false;
+
+   mpFile = file;
+
+   LARGE_INTEGER size = { };
+
+   if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+   {
+      mpMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+      if (mpMapping)
+      {
+         mpData = static_cast< const uint8_t * >(MapViewOfFile(mpMapping, FILE_MAP_READ, 0, 0, 0));
+         mSize = mpData ? static_cast< size_t >(size.QuadPart) : 0;
+      }
+   }
+
+#else
+
+   const int file = open(pFilename, O_RDONLY);
+
+   if (file < 0) return false;
+
+   struct stat status = { };
+
+   if (fstat(file, &status) == 0 && status.st_size > 0)
+   {
+      void * const pData = mmap(nullptr, static_cast< size_t >(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+      if (pData != MAP_FAILED)
+      {
+         mpData = static_cast< const uint8_t * >(pData);
+         mSize = static_cast< size_t >(status.st_size);
+      }
+   }
+
+   // the mapping keeps its own reference to the file
+   close(file);
+
+#endif
+
+   if (!mpData) Close();
+
+   return mpData != nullptr;
+}
+
+void MappedFile::Close( )
+{
+#if defined( _WIN32 )
+
+   if (mpData) UnmapViewOfFile(mpData);
+   if (mpMapping) CloseHandle(mpMapping);
+   if (mpFile) CloseHandle(mpFile);
+
+#else
+
+   if (mpData) munmap(const_cast< uint8_t * >(mpData), mSize);
+
+#endif
+
+   mpData = nullptr;
+   mSize = 0;
+   mpFile = nullptr;
+   mpMapping = nullptr;
+}
@@ -0,0 +1,48 @@
+#ifndef _MAPPED_FILE_H_
+#define _MAPPED_FILE_H_
+
+// std includes
+#include <cstddef>
+#include <cstdint>
+
+// a read only view of a whole file mapped into memory...
+// the pages are read in by the os as they are first touched
+class MappedFile
+{
+public:
+   // constructor / destructor
+    MappedFile( );
+   ~MappedFile( );
+
+   // only allow move construction and assignment
+   MappedFile( MappedFile && file );
+   MappedFile & operator = ( MappedFile && file );
+
+   // maps the file, releasing any file mapped before...
+   // returns false if the file cannot be opened or is empty
+   bool Open( const char * const pFilename );
+   void Close( );
+
+   // indicates if a file is mapped
+   bool IsOpen( ) const { return mpData != nullptr; }
+
+   // contents of the mapped file
+   const uint8_t * Data( ) const { return mpData; }
+   size_t Size( ) const { return mSize; }
+
+private:
+   // prohibit copy construction and assignment
+   MappedFile( const MappedFile & );
+   MappedFile & operator = ( const MappedFile & );
+
+   // start and size of the view
+   const uint8_t *   mpData;
+   size_t            mSize;
+
+   // os handles of the file and its mapping
+   void *            mpFile;
+   void *            mpMapping;
+
+};
+
+#endif // _MAPPED_FILE_H_
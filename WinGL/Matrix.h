@@ -4,6 +4,7 @@
 // std includes
 #include <limits>
 #include <complex>
+#include <type_traits>
 #include <initializer_list>
 
 // crt includes
@@ -13,6 +14,8 @@
 // local includes
 #include "Vector.h"
 #include "WglAssert.h"
+#include "ParallelFor.h"
+#include "MatrixKernels.h"
 
 template < typename T >
 class Matrix
@@ -21,36 +24,35 @@ public:
    // basic type of the class
    typedef T type;
 
-   // constructor / destructor
-    Matrix( );
-    Matrix( const T t[16] );
-    Matrix( const Matrix< T > & mat );
+   // constructors
+   // the copy constructor, copy assignment and destructor are left to the
+   // compiler so the type stays trivially copyable
+    constexpr Matrix( );
+    constexpr Matrix( const T t[16] );
     template < typename U >
-    Matrix( const Matrix< U > & mat );
-    Matrix( const Vector< T, 4 > & col1, const Vector< T, 4 > & col2,
-            const Vector< T, 4 > & col3, const Vector< T, 4 > & col4 );
+    constexpr Matrix( const Matrix< U > & mat );
+    constexpr Matrix( const Vector< T, 4 > & col1, const Vector< T, 4 > & col2,
+                      const Vector< T, 4 > & col3, const Vector< T, 4 > & col4 );
     template < typename U >
-    Matrix( const Vector< U, 4 > & col1, const Vector< U, 4 > & col2,
-            const Vector< U, 4 > & col3, const Vector< U, 4 > & col4 );
-    Matrix( const T & col1_x, const T & col1_y, const T & col1_z, const T & col1_w,
-            const T & col2_x, const T & col2_y, const T & col2_z, const T & col2_w,
-            const T & col3_x, const T & col3_y, const T & col3_z, const T & col3_w,
-            const T & col4_x, const T & col4_y, const T & col4_z, const T & col4_w );
+    constexpr Matrix( const Vector< U, 4 > & col1, const Vector< U, 4 > & col2,
+                      const Vector< U, 4 > & col3, const Vector< U, 4 > & col4 );
+    constexpr Matrix( const T & col1_x, const T & col1_y, const T & col1_z, const T & col1_w,
+                      const T & col2_x, const T & col2_y, const T & col2_z, const T & col2_w,
+                      const T & col3_x, const T & col3_y, const T & col3_z, const T & col3_w,
+                      const T & col4_x, const T & col4_y, const T & col4_z, const T & col4_w );
     template < typename U >
-    Matrix( const U & col1_x, const U & col1_y, const U & col1_z, const U & col1_w,
-            const U & col2_x, const U & col2_y, const U & col2_z, const U & col2_w,
-            const U & col3_x, const U & col3_y, const U & col3_z, const U & col3_w,
-            const U & col4_x, const U & col4_y, const U & col4_z, const U & col4_w );
+    constexpr Matrix( const U & col1_x, const U & col1_y, const U & col1_z, const U & col1_w,
+                      const U & col2_x, const U & col2_y, const U & col2_z, const U & col2_w,
+                      const U & col3_x, const U & col3_y, const U & col3_z, const U & col3_w,
+                      const U & col4_x, const U & col4_y, const U & col4_z, const U & col4_w );
     Matrix( const std::initializer_list< T > & col_list );
-   ~Matrix( );
 
    // operator =
    template < typename U >
-   Matrix< T > & operator = ( const Matrix< U > & mat );
-   Matrix< T > & operator = ( const Matrix< T > & mat );
+   constexpr Matrix< T > & operator = ( const Matrix< U > & mat );
    template < typename U >
-   Matrix< T > & operator = ( const U u[16] );
-   Matrix< T > & operator = ( const T t[16] );
+   constexpr Matrix< T > & operator = ( const U u[16] );
+   constexpr Matrix< T > & operator = ( const T t[16] );
 
    // operator *
    template < typename U >
@@ -68,28 +70,28 @@ public:
    Vector< T, 4 > operator * ( const Vector< T, 4 > & vec ) const;
 
    template < typename U >
-   Matrix< T > operator * ( const U & scaler ) const;
-   Matrix< T > operator * ( const T & scaler ) const;
+   constexpr Matrix< T > operator * ( const U & scaler ) const;
+   constexpr Matrix< T > operator * ( const T & scaler ) const;
    template < typename U >
-   Matrix< T > & operator *= ( const U & scaler );
-   Matrix< T > & operator *= ( const T & scaler );
+   constexpr Matrix< T > & operator *= ( const U & scaler );
+   constexpr Matrix< T > & operator *= ( const T & scaler );
 
    // operator ==
    template < typename U >
-   bool operator == ( const Matrix< U > & mat ) const;
-   bool operator == ( const Matrix< T > & mat ) const;
+   constexpr bool operator == ( const Matrix< U > & mat ) const;
+   constexpr bool operator == ( const Matrix< T > & mat ) const;
 
    // operator !=
    template < typename U >
-   bool operator != ( const Matrix< U > & mat ) const;
-   bool operator != ( const Matrix< T > & mat ) const;
+   constexpr bool operator != ( const Matrix< U > & mat ) const;
+   constexpr bool operator != ( const Matrix< T > & mat ) const;
 
    // operator T
    operator T * ( );
    operator const T * ( ) const;
 
    // creates an identity matrix
-   void  MakeIdentity( );
+   constexpr void  MakeIdentity( );
 
    // creates a rotation matrix
    void  MakeRotation( const T & degrees, const T & x, const T & y, const T & z );
@@ -99,45 +101,51 @@ public:
    static Matrix< T > Rotate( const T & degrees, const Vector< T, 3 > & vec );
 
    // creates a translation matrix
-   void  MakeTranslation( const T & x, const T & y, const T & z );
-   void  MakeTranslation( const Vector< T, 3 > & vec );
+   constexpr void  MakeTranslation( const T & x, const T & y, const T & z );
+   constexpr void  MakeTranslation( const Vector< T, 3 > & vec );
 
-   static Matrix< T > Translate( const T & x, const T & y, const T & z );
-   static Matrix< T > Translate( const Vector< T, 3 > & vec );
+   static constexpr Matrix< T > Translate( const T & x, const T & y, const T & z );
+   static constexpr Matrix< T > Translate( const Vector< T, 3 > & vec );
 
    // creates a scaling matrix
-   void  MakeScaling( const T & scale );
-   void  MakeScaling( const T & x, const T & y, const T & z );
-   void  MakeScaling( const Vector< T, 3 > & vec );
+   constexpr void  MakeScaling( const T & scale );
+   constexpr void  MakeScaling( const T & x, const T & y, const T & z );
+   constexpr void  MakeScaling( const Vector< T, 3 > & vec );
 
-   static Matrix< T > Scale( const T & scale );
-   static Matrix< T > Scale( const T & x, const T & y, const T & z );
-   static Matrix< T > Scale( const Vector< T, 3 > & vec );
+   static constexpr Matrix< T > Scale( const T & scale );
+   static constexpr Matrix< T > Scale( const T & x, const T & y, const T & z );
+   static constexpr Matrix< T > Scale( const Vector< T, 3 > & vec );
 
    // create a projection matrix
    template < typename U >
    void  MakeOrtho( const U & rLeft, const U & rRight,
                     const U & rBottom, const U & rTop,
                     const U & rNear, const U & rFar );
-   void  MakeOrtho( const T & rLeft, const T & rRight,
-                    const T & rBottom, const T & rTop,
-                    const T & rNear, const T & rFar );
+   constexpr void  MakeOrtho( const T & rLeft, const T & rRight,
+                              const T & rBottom, const T & rTop,
+                              const T & rNear, const T & rFar );
 
    template < typename U >
    static Matrix< U > Ortho( const U & rLeft, const U & rRight,
                              const U & rBottom, const U & rTop,
                              const U & rNear, const U & rFar );
-   static Matrix< T > Ortho( const T & rLeft, const T & rRight,
-                             const T & rBottom, const T & rTop,
-                             const T & rNear, const T & rFar );
+   static constexpr Matrix< T > Ortho( const T & rLeft, const T & rRight,
+                                       const T & rBottom, const T & rTop,
+                                       const T & rNear, const T & rFar );
 
    template < typename U >
    void  MakeFrustum( const U & rLeft, const U & rRight,
                       const U & rBottom, const U & rTop,
                       const U & rNear, const U & rFar );
-   void  MakeFrustum( const T & rLeft, const T & rRight,
-                      const T & rBottom, const T & rTop,
-                      const T & rNear, const T & rFar );
+   constexpr void  MakeFrustum( const T & rLeft, const T & rRight,
+                                const T & rBottom, const T & rTop,
+                                const T & rNear, const T & rFar );
+
+   static constexpr Matrix< T > Frustum( const T & rLeft, const T & rRight,
+                                         const T & rBottom, const T & rTop,
+                                         const T & rNear, const T & rFar );
+
+   // perspective needs std::tan, so it is only available at runtime
 
    template < typename U >
    void  MakePerspective( const U & rFOV,
@@ -236,8 +244,8 @@ public:
                             const T & width, const T & height );
 
    // transpose
-   void        MakeTranspose( );
-   Matrix< T > Transpose( ) const;
+   constexpr void        MakeTranspose( );
+   constexpr Matrix< T > Transpose( ) const;
 
    // makes the inverse out of an
    // assumed orthogonal matrix
@@ -252,61 +260,86 @@ public:
    // returns the determinant
    T  Determinant( ) const;
 
+   // returns true if the last row is 0, 0, 0, 1
+   constexpr bool  IsAffine( ) const;
+
+   // transforms count points stored as x, y, z triples back to back.
+   // the divide by w is skipped when the matrix is affine.  the results
+   // are either interleaved into pOut, which may alias pIn, or split into
+   // separate x, y, and z arrays.  parallel splits large batches across
+   // all hardware threads.
+   void  TransformPoints( const T * const pIn, const size_t count,
+                          T * const pOut, const bool parallel = false ) const;
+   void  TransformPoints( const T * const pIn, const size_t count,
+                          T * const pOutX, T * const pOutY, T * const pOutZ,
+                          const bool parallel = false ) const;
+
+   // same as the points, but only the upper 3x3 is applied... use
+   // the inverse transpose of the point matrix to transform normals
+   void  TransformNormals( const T * const pIn, const size_t count,
+                           T * const pOut, const bool parallel = false ) const;
+   void  TransformNormals( const T * const pIn, const size_t count,
+                           T * const pOutX, T * const pOutY, T * const pOutZ,
+                           const bool parallel = false ) const;
+
    // matrix class should be simple and allow
    // for easy acess to the member variables
    T     mT[16];
 
 private:
-   // internal function that computes the determinant
-   T  Determinant( Matrix< T > & inverse = Matrix< T >() );
+   // minimum number of triples handed to each thread
+   static const size_t TRANSFORM_GRAIN_SIZE = 16384;
 
+   // runs the batch kernels over the input
+   template < bool POINTS >
+   void  TransformBatch( const T * const pIn, const size_t count,
+                         const details::Vec3Stream< T > & out, const bool parallel ) const;
 
 };
 
 template < typename T >
-inline Matrix< T >::Matrix( )
-{
-   // set the identity matrix
-   MakeIdentity();
-}
-
-template < typename T >
-inline Matrix< T >::Matrix( const T t[16] )
+inline constexpr Matrix< T >::Matrix( ) :
+mT { 1, 0, 0, 0,
+     0, 1, 0, 0,
+     0, 0, 1, 0,
+     0, 0, 0, 1 }
 {
-   memcpy(mT, t, sizeof(mT));
 }
 
 template < typename T >
-inline Matrix< T >::Matrix( const Matrix< T > & mat )
+inline constexpr Matrix< T >::Matrix( const T t[16] ) :
+mT { }
 {
-   *this = mat;
+   *this = t;
 }
 
 template < typename T >
 template < typename U >
-inline Matrix< T >::Matrix( const Matrix< U > & mat )
+inline constexpr Matrix< T >::Matrix( const Matrix< U > & mat ) :
+mT { }
 {
    *this = mat;
 }
 
 template < typename T >
-inline Matrix< T >::Matrix( const Vector< T, 4 > & col1,
-                            const Vector< T, 4 > & col2,
-                            const Vector< T, 4 > & col3,
-                            const Vector< T, 4 > & col4 )
+inline constexpr Matrix< T >::Matrix( const Vector< T, 4 > & col1,
+                                      const Vector< T, 4 > & col2,
+                                      const Vector< T, 4 > & col3,
+                                      const Vector< T, 4 > & col4 ) :
+mT { col1.mT[0], col1.mT[1], col1.mT[2], col1.mT[3],
+     col2.mT[0], col2.mT[1], col2.mT[2], col2.mT[3],
+     col3.mT[0], col3.mT[1], col3.mT[2], col3.mT[3],
+     col4.mT[0], col4.mT[1], col4.mT[2], col4.mT[3] }
 {
-   memcpy(mT, col1.mT, sizeof(col1.mT));
-   memcpy(mT + 4, col2.mT, sizeof(col2.mT));
-   memcpy(mT + 8, col3.mT, sizeof(col3.mT));
-   memcpy(mT + 12, col4.mT, sizeof(col4.mT));
 }
 
 template < typename T >
 template < typename U >
-inline Matrix< T >::Matrix( const Vector< U, 4 > & col1,
-                            const Vector< U, 4 > & col2,
-                            const Vector< U, 4 > & col3,
-                            const Vector< U, 4 > & col4 )
+inline constexpr Matrix< T >::Matrix( const Vector< U, 4 > & col1,
+                                      const Vector< U, 4 > & col2,
+                                      const Vector< U, 4 > & col3,
+                                      const Vector< U, 4 > & col4 ) :
+mT { }
 {
    *this = Matrix< T >(Vector< T, 4 >(col1),
                        Vector< T, 4 >(col2),
@@ -315,23 +348,24 @@ inline Matrix< T >::Matrix( const Vector< U, 4 > & col1,
 }
 
 template < typename T >
-inline Matrix< T >::Matrix( const T & col1_x, const T & col1_y, const T & col1_z, const T & col1_w,
-                            const T & col2_x, const T & col2_y, const T & col2_z, const T & col2_w,
-                            const T & col3_x, const T & col3_y, const T & col3_z, const T & col3_w,
-                            const T & col4_x, const T & col4_y, const T & col4_z, const T & col4_w )
+inline constexpr Matrix< T >::Matrix( const T & col1_x, const T & col1_y, const T & col1_z, const T & col1_w,
+                                      const T & col2_x, const T & col2_y, const T & col2_z, const T & col2_w,
+                                      const T & col3_x, const T & col3_y, const T & col3_z, const T & col3_w,
+                                      const T & col4_x, const T & col4_y, const T & col4_z, const T & col4_w ) :
+mT { col1_x, col1_y, col1_z, col1_w,
+     col2_x, col2_y, col2_z, col2_w,
+     col3_x, col3_y, col3_z, col3_w,
+     col4_x, col4_y, col4_z, col4_w }
 {
-   mT[0] = col1_x;   mT[4] = col2_x;   mT[8]  = col3_x;   mT[12] = col4_x;
-   mT[1] = col1_y;   mT[5] = col2_y;   mT[9]  = col3_y;   mT[13] = col4_y;
-   mT[2] = col1_z;   mT[6] = col2_z;   mT[10] = col3_z;   mT[14] = col4_z;
-   mT[3] = col1_w;   mT[7] = col2_w;   mT[11] = col3_w;   mT[15] = col4_w;
 }
 
 template < typename T >
 template < typename U >
-inline Matrix< T >::Matrix( const U & col1_x, const U & col1_y, const U & col1_z, const U & col1_w,
-                            const U & col2_x, const U & col2_y, const U & col2_z, const U & col2_w,
-                            const U & col3_x, const U & col3_y, const U & col3_z, const U & col3_w,
-                            const U & col4_x, const U & col4_y, const U & col4_z, const U & col4_w )
+inline constexpr Matrix< T >::Matrix( const U & col1_x, const U & col1_y, const U & col1_z, const U & col1_w,
+                                      const U & col2_x, const U & col2_y, const U & col2_z, const U & col2_w,
+                                      const U & col3_x, const U & col3_y, const U & col3_z, const U & col3_w,
+                                      const U & col4_x, const U & col4_y, const U & col4_z, const U & col4_w ) :
+mT { }
 {
    *this = Matrix< T >(Vector< T, 4 >(col1_x, col1_y, col1_z, col1_w),
                        Vector< T, 4 >(col2_x, col2_y, col2_z, col2_w),
@@ -367,14 +401,9 @@ inline Matrix< T >::Matrix( const std::initializer_list< T > & col_list )
    }
 }
 
-template < typename T >
-inline Matrix< T >::~Matrix( )
-{
-}
-
 template < typename T >
 template < typename U >
-inline Matrix< T > & Matrix< T >::operator = ( const Matrix< U > & mat )
+inline constexpr Matrix< T > & Matrix< T >::operator = ( const Matrix< U > & mat )
 {
    for (int i = 0; i < 16; ++i)
       mT[i] = static_cast< T >(mat.mT[i]);
@@ -382,30 +411,21 @@ inline Matrix< T > & Matrix< T >::operator = ( const Matrix< U > & mat )
    return *this;
 }
 
-template < typename T >
-inline Matrix< T > & Matrix< T >::operator = ( const Matrix< T > & mat )
-{
-   if (this != &mat)
-      memcpy(mT, mat.mT, sizeof(mT));
-
-   return *this;
-}
-
 template < typename T >
 template < typename U >
-inline Matrix< T > & Matrix< T >::operator = ( const U u[16] )
+inline constexpr Matrix< T > & Matrix< T >::operator = ( const U u[16] )
 {
-   Matrix< U > localMat(u);
-
-   *this = localMat;
+   for (int i = 0; i < 16; ++i)
+      mT[i] = static_cast< T >(u[i]);
 
    return *this;
 }
 
 template < typename T >
-inline Matrix< T > & Matrix< T >::operator = ( const T t[16] )
+inline constexpr Matrix< T > & Matrix< T >::operator = ( const T t[16] )
 {
-   memcpy(mT, t, sizeof(mT));
+   for (int i = 0; i < 16; ++i)
+      mT[i] = t[i];
 
    return *this;
 }
@@ -426,36 +446,7 @@ inline Matrix< T > Matrix< T >::operator * ( const Matrix< T > & mat ) const
 
    Matrix< T > localMat;
 
-   T * lmMT = localMat.mT;
-
-   for (int i = 0; i < 4; ++i, lmMT += 4)
-   {
-      const unsigned int row = i * 4;
-      const T * const mT0 = mat.mT + row + 0;
-      const T * const mT1 = mat.mT + row + 1;
-      const T * const mT2 = mat.mT + row + 2;
-      const T * const mT3 = mat.mT + row + 3;
-
-      *(lmMT + 0) = *(mT + 0)  * *mT0 +
-                    *(mT + 4)  * *mT1 +
-                    *(mT + 8)  * *mT2 +
-                    *(mT + 12) * *mT3;
-                              
-      *(lmMT + 1) = *(mT + 1)  * *mT0 +
-                    *(mT + 5)  * *mT1 +
-                    *(mT + 9)  * *mT2 +
-                    *(mT + 13) * *mT3;
-                              
-      *(lmMT + 2) = *(mT + 2)  * *mT0 +
-                    *(mT + 6)  * *mT1 +
-                    *(mT + 10) * *mT2 +
-                    *(mT + 14) * *mT3;
-                              
-      *(lmMT + 3) = *(mT + 3)  * *mT0 +
-                    *(mT + 7)  * *mT1 +
-                    *(mT + 11) * *mT2 +
-                    *(mT + 15) * *mT3;
-   }
+   details::MatrixKernels< T >::Multiply(mT, mat.mT, localMat.mT);
 
    return localMat;
 }
@@ -507,34 +498,16 @@ inline Vector< T, 4 > Matrix< T >::operator * ( const Vector< T, 4 > & vec ) con
 {
    // note: post multiplication used to conform to opengl
 
-   const T * const pT = vec.mT;
+   Vector< T, 4 > v;
 
-   T x = *(mT + 0)  * *(pT + 0) +
-         *(mT + 4)  * *(pT + 1) +
-         *(mT + 8)  * *(pT + 2) +
-         *(mT + 12) * *(pT + 3);
+   details::MatrixKernels< T >::Transform(mT, vec.mT, v.mT);
 
-   T y = *(mT + 1)  * *(pT + 0) +
-         *(mT + 5)  * *(pT + 1) +
-         *(mT + 9)  * *(pT + 2) +
-         *(mT + 13) * *(pT + 3);
-
-   T z = *(mT + 2)  * *(pT + 0) +
-         *(mT + 6)  * *(pT + 1) +
-         *(mT + 10) * *(pT + 2) +
-         *(mT + 14) * *(pT + 3);
-
-   T w = *(mT + 3)  * *(pT + 0) +
-         *(mT + 7)  * *(pT + 1) +
-         *(mT + 11) * *(pT + 2) +
-         *(mT + 15) * *(pT + 3);
-
-   return Vector< T, 4 >(x, y, z, w);
+   return v;
 }
 
 template < typename T >
 template < typename U >
-inline Matrix< T > Matrix< T >::operator * ( const U & scaler ) const
+inline constexpr Matrix< T > Matrix< T >::operator * ( const U & scaler ) const
 {
    Matrix< T > mat(*this);
 
@@ -544,7 +517,7 @@ inline Matrix< T > Matrix< T >::operator * ( const U & scaler ) const
 }
 
 template < typename T >
-inline Matrix< T > Matrix< T >::operator * ( const T & scaler ) const
+inline constexpr Matrix< T > Matrix< T >::operator * ( const T & scaler ) const
 {
    Matrix< T > mat(*this);
 
@@ -555,15 +528,15 @@ inline Matrix< T > Matrix< T >::operator * ( const T & scaler ) const
 
 template < typename T >
 template < typename U >
-inline Matrix< T > & Matrix< T >::operator *= ( const U & scaler )
+inline constexpr Matrix< T > & Matrix< T >::operator *= ( const U & scaler )
 {
-   this *= static_cast< T >(scaler);
+   *this *= static_cast< T >(scaler);
 
    return *this;
 }
 
 template < typename T >
-inline Matrix< T > & Matrix< T >::operator *= ( const T & scaler )
+inline constexpr Matrix< T > & Matrix< T >::operator *= ( const T & scaler )
 {
    for (int i = 0; i < 16; ++i) mT[i] *= scaler;
 
@@ -584,13 +557,13 @@ inline Matrix< T >::operator const T * ( ) const
 
 template < typename T >
 template < typename U >
-inline bool Matrix< T >::operator == ( const Matrix< U > & mat ) const
+inline constexpr bool Matrix< T >::operator == ( const Matrix< U > & mat ) const
 {
    return *this == Matrix< T >(mat);
 }
 
 template < typename T >
-inline bool Matrix< T >::operator == ( const Matrix< T > & mat ) const
+inline constexpr bool Matrix< T >::operator == ( const Matrix< T > & mat ) const
 {
    // epsilon value when comparing
    const double eps = 0.0000001;
@@ -604,26 +577,21 @@ inline bool Matrix< T >::operator == ( const Matrix< T > & mat ) const
 
 template < typename T >
 template < typename U >
-inline bool Matrix< T >::operator != ( const Matrix< U > & mat ) const
+inline constexpr bool Matrix< T >::operator != ( const Matrix< U > & mat ) const
 {
    return !(*this == Matrix< T >(mat));
 }
 
 template < typename T >
-inline bool Matrix< T >::operator != ( const Matrix< T > & mat ) const
+inline constexpr bool Matrix< T >::operator != ( const Matrix< T > & mat ) const
 {
    return !(*this == mat);
 }
 
 template < typename T >
-inline void Matrix< T >::MakeIdentity( )
+inline constexpr void Matrix< T >::MakeIdentity( )
 {
-   memset(mT, 0x00, sizeof(mT));
-
-   mT[0] = 1;
-   mT[5] = 1;
-   mT[10] = 1;
-   mT[15] = 1;
+   *this = Matrix< T >();
 }
 
 template < typename T >
@@ -833,7 +801,7 @@ inline void Matrix< T >::MakeViewportMatrix( const T & x, const T & y,
 }
 
 template < typename T >
-inline void Matrix< T >::MakeTranslation( const T & x, const T & y, const T & z )
+inline constexpr void Matrix< T >::MakeTranslation( const T & x, const T & y, const T & z )
 {
    MakeIdentity();
 
@@ -843,13 +811,13 @@ inline void Matrix< T >::MakeTranslation( const T & x, const T & y, const T & z
 }
 
 template < typename T >
-inline void Matrix< T >::MakeTranslation( const Vector< T, 3 > & vec )
+inline constexpr void Matrix< T >::MakeTranslation( const Vector< T, 3 > & vec )
 {
    MakeTranslation(vec.mT[0], vec.mT[1], vec.mT[2]);
 }
 
 template < typename T >
-inline Matrix< T > Matrix< T >::Translate( const T & x, const T & y, const T & z )
+inline constexpr Matrix< T > Matrix< T >::Translate( const T & x, const T & y, const T & z )
 {
    Matrix< T > mat;
    mat.MakeTranslation(x, y, z);
@@ -858,7 +826,7 @@ inline Matrix< T > Matrix< T >::Translate( const T & x, const T & y, const T & z
 }
 
 template < typename T >
-inline Matrix< T > Matrix< T >::Translate( const Vector< T, 3 > & vec )
+inline constexpr Matrix< T > Matrix< T >::Translate( const Vector< T, 3 > & vec )
 {
    Matrix< T > mat;
    mat.MakeTranslation(vec);
@@ -867,13 +835,13 @@ inline Matrix< T > Matrix< T >::Translate( const Vector< T, 3 > & vec )
 }
 
 template < typename T >
-inline void Matrix< T >::MakeScaling( const T & scale )
+inline constexpr void Matrix< T >::MakeScaling( const T & scale )
 {
    MakeScaling(scale, scale, scale);
 }
 
 template < typename T >
-inline void Matrix< T >::MakeScaling( const T & x, const T & y, const T & z )
+inline constexpr void Matrix< T >::MakeScaling( const T & x, const T & y, const T & z )
 {
    MakeIdentity();
 
@@ -883,13 +851,13 @@ inline void Matrix< T >::MakeScaling( const T & x, const T & y, const T & z )
 }
 
 template < typename T >
-inline void Matrix< T >::MakeScaling( const Vector< T, 3 > & vec )
+inline constexpr void Matrix< T >::MakeScaling( const Vector< T, 3 > & vec )
 {
    MakeScaling(vec.mT[0], vec.mT[1], vec.mT[2]);
 }
 
 template < typename T >
-inline Matrix< T > Matrix< T >::Scale( const T & scale )
+inline constexpr Matrix< T > Matrix< T >::Scale( const T & scale )
 {
    Matrix< T > mat;
    mat.MakeScaling(scale);
@@ -898,7 +866,7 @@ inline Matrix< T > Matrix< T >::Scale( const T & scale )
 }
 
 template < typename T >
-inline Matrix< T > Matrix< T >::Scale( const T & x, const T & y, const T & z )
+inline constexpr Matrix< T > Matrix< T >::Scale( const T & x, const T & y, const T & z )
 {
    Matrix< T > mat;
    mat.MakeScaling(x, y, z);
@@ -907,7 +875,7 @@ inline Matrix< T > Matrix< T >::Scale( const T & x, const T & y, const T & z )
 }
 
 template < typename T >
-inline Matrix< T > Matrix< T >::Scale( const Vector< T, 3 > & vec )
+inline constexpr Matrix< T > Matrix< T >::Scale( const Vector< T, 3 > & vec )
 {
    Matrix< T > mat;
    mat.MakeScaling(vec);
@@ -934,9 +902,9 @@ inline void Matrix< T >::MakeOrtho( const U & rLeft, const U & rRight,
 }
 
 template < typename T >
-inline void Matrix< T >::MakeOrtho( const T & rLeft, const T & rRight,
-                                    const T & rBottom, const T & rTop,
-                                    const T & rNear, const T & rFar )
+inline constexpr void Matrix< T >::MakeOrtho( const T & rLeft, const T & rRight,
+                                              const T & rBottom, const T & rTop,
+                                              const T & rNear, const T & rFar )
 {
    const T SX = 2 / (rRight - rLeft);
    const T SY = 2 / (rTop - rBottom);
@@ -964,9 +932,9 @@ inline Matrix< U > Matrix< T >::Ortho( const U & rLeft, const U & rRight,
 }
 
 template < typename T >
-inline Matrix< T > Matrix< T >::Ortho( const T & rLeft, const T & rRight,
-                                       const T & rBottom, const T & rTop,
-                                       const T & rNear, const T & rFar )
+inline constexpr Matrix< T > Matrix< T >::Ortho( const T & rLeft, const T & rRight,
+                                                 const T & rBottom, const T & rTop,
+                                                 const T & rNear, const T & rFar )
 {
    Matrix< T > mat;
    mat.MakeOrtho(rLeft, rRight, rBottom, rTop, rNear, rFar);
@@ -993,9 +961,9 @@ inline void Matrix< T >::MakeFrustum( const U & rLeft, const U & rRight,
 }
 
 template < typename T >
-inline void Matrix< T >::MakeFrustum( const T & rLeft, const T & rRight,
-                                      const T & rBottom, const T & rTop,
-                                      const T & rNear, const T & rFar )
+inline constexpr void Matrix< T >::MakeFrustum( const T & rLeft, const T & rRight,
+                                                const T & rBottom, const T & rTop,
+                                                const T & rNear, const T & rFar )
 {
    const T SX = static_cast< T >(2.0) * rNear / (rRight - rLeft);
    const T SY = static_cast< T >(2.0) * rNear / (rTop - rBottom);
@@ -1010,6 +978,17 @@ inline void Matrix< T >::MakeFrustum( const T & rLeft, const T & rRight,
    mT[3] = 0;   mT[7] = 0;   mT[11] = -1;  mT[15] = 0;
 }
 
+template < typename T >
+inline constexpr Matrix< T > Matrix< T >::Frustum( const T & rLeft, const T & rRight,
+                                                   const T & rBottom, const T & rTop,
+                                                   const T & rNear, const T & rFar )
+{
+   Matrix< T > mat;
+   mat.MakeFrustum(rLeft, rRight, rBottom, rTop, rNear, rFar);
+
+   return mat;
+}
+
 template < typename T >
 template < typename U >
 inline void Matrix< T >::MakePerspective( const U & rFOV,
@@ -1203,7 +1182,7 @@ inline Matrix< T > Matrix< T >::LookAt( const Vector< T, 3 > & rEye,
 }
 
 template < typename T >
-inline void Matrix< T >::MakeTranspose( )
+inline constexpr void Matrix< T >::MakeTranspose( )
 {
    Matrix< T > mat(*this);
 
@@ -1214,7 +1193,7 @@ inline void Matrix< T >::MakeTranspose( )
 }
 
 template < typename T >
-inline Matrix< T > Matrix< T >::Transpose( ) const
+inline constexpr Matrix< T > Matrix< T >::Transpose( ) const
 {
    Matrix< T > mat(*this);
 
@@ -1254,14 +1233,14 @@ inline Matrix< T > Matrix< T >::InverseFromOrthogonal( ) const
 template < typename T >
 inline void Matrix< T >::MakeInverse( )
 {
-   Matrix< T > inverse(*this);
+   const Matrix< T > mat(*this);
 
-   const T det = Determinant(inverse);
+   const T det = details::MatrixKernels< T >::Inverse(mat.mT, mT);
 
    // make sure there is an inverse
    WGL_ASSERT(-0.0000000001 > det || 0.0000000001 < det);
-
-   *this = inverse;
+   // only referenced by the assert
+   static_cast< void >(det);
 }
 
 template < typename T >
@@ -1277,74 +1256,83 @@ inline Matrix< T > Matrix< T >::Inverse( ) const
 template < typename T >
 inline T Matrix< T >::Determinant( ) const
 {
-   return Determinant();
+   return details::MatrixKernels< T >::Determinant(mT);
 }
 
 template < typename T >
-inline T Matrix< T >::Determinant( Matrix< T > & inverse )
+inline constexpr bool Matrix< T >::IsAffine( ) const
 {
-   WGL_ASSERT(&inverse != this);
-
-   const T coef00 = mT[10] * mT[15] - mT[14] * mT[11];
-   const T coef02 = mT[6]  * mT[15] - mT[14] * mT[7];
-   const T coef03 = mT[6]  * mT[11] - mT[10] * mT[7];
-
-   const T coef04 = mT[9] * mT[15] - mT[13] * mT[11];
-   const T coef06 = mT[5] * mT[15] - mT[13] * mT[7];
-   const T coef07 = mT[5] * mT[11] - mT[9]  * mT[7];
-
-   const T coef08 = mT[9] * mT[14] - mT[13] * mT[10];
-   const T coef10 = mT[5] * mT[14] - mT[13] * mT[6];
-   const T coef11 = mT[5] * mT[10] - mT[9]  * mT[6];
-
-   const T coef12 = mT[8] * mT[15] - mT[12] * mT[11];
-   const T coef14 = mT[4] * mT[15] - mT[12] * mT[7];
-   const T coef15 = mT[4] * mT[11] - mT[8]  * mT[7];
-
-   const T coef16 = mT[8] * mT[14] - mT[12] * mT[10];
-   const T coef18 = mT[4] * mT[14] - mT[12] * mT[6];
-   const T coef19 = mT[4] * mT[10] - mT[8]  * mT[6];
-
-   const T coef20 = mT[8] * mT[13] - mT[12] * mT[9];
-   const T coef22 = mT[4] * mT[13] - mT[12] * mT[5];
-   const T coef23 = mT[4] * mT[9]  - mT[8]  * mT[5];
-
-   const Vector< T, 4 > fac0(coef00, coef00, coef02, coef03);
-   const Vector< T, 4 > fac1(coef04, coef04, coef06, coef07);
-   const Vector< T, 4 > fac2(coef08, coef08, coef10, coef11);
-   const Vector< T, 4 > fac3(coef12, coef12, coef14, coef15);
-   const Vector< T, 4 > fac4(coef16, coef16, coef18, coef19);
-   const Vector< T, 4 > fac5(coef20, coef20, coef22, coef23);
-   
-   const Vector< T, 4 > vec0(mT[4], mT[0], mT[0], mT[0]);
-   const Vector< T, 4 > vec1(mT[5], mT[1], mT[1], mT[1]);
-   const Vector< T, 4 > vec2(mT[6], mT[2], mT[2], mT[2]);
-   const Vector< T, 4 > vec3(mT[7], mT[3], mT[3], mT[3]);
+   return mT[3] == static_cast< T >(0) && mT[7] == static_cast< T >(0) &&
+          mT[11] == static_cast< T >(0) && mT[15] == static_cast< T >(1);
+}
 
-   const Vector< T, 4 > inv0(vec1 % fac0 - vec2 % fac1 + vec3 % fac2);
-   const Vector< T, 4 > inv1(vec0 % fac0 - vec2 % fac3 + vec3 % fac4);
-   const Vector< T, 4 > inv2(vec0 % fac1 - vec1 % fac3 + vec3 % fac5);
-   const Vector< T, 4 > inv3(vec0 % fac2 - vec1 % fac4 + vec2 % fac5);
+template < typename T >
+inline void Matrix< T >::TransformPoints( const T * const pIn, const size_t count,
+                                          T * const pOut, const bool parallel ) const
+{
+   TransformBatch< true >(pIn, count, details::Vec3Stream< T > { pOut, pOut + 1, pOut + 2, 3 }, parallel);
+}
 
-   const Vector< T, 4 > signa(T(+1), T(-1), T(+1), T(-1));
-   const Vector< T, 4 > signb(T(-1), T(+1), T(-1), T(+1));
+template < typename T >
+inline void Matrix< T >::TransformPoints( const T * const pIn, const size_t count,
+                                          T * const pOutX, T * const pOutY, T * const pOutZ,
+                                          const bool parallel ) const
+{
+   TransformBatch< true >(pIn, count, details::Vec3Stream< T > { pOutX, pOutY, pOutZ, 1 }, parallel);
+}
 
-   inverse = Matrix< T >(inv0 % signa, inv1 % signb, inv2 % signa, inv3 % signb);
+template < typename T >
+inline void Matrix< T >::TransformNormals( const T * const pIn, const size_t count,
+                                           T * const pOut, const bool parallel ) const
+{
+   TransformBatch< false >(pIn, count, details::Vec3Stream< T > { pOut, pOut + 1, pOut + 2, 3 }, parallel);
+}
 
-   const Vector< T, 4 > row0(inverse[0], inverse[4], inverse[8], inverse[12]);
-   const Vector< T, 4 > dot0(Vector< T, 4 >(mT) % row0);
+template < typename T >
+inline void Matrix< T >::TransformNormals( const T * const pIn, const size_t count,
+                                           T * const pOutX, T * const pOutY, T * const pOutZ,
+                                           const bool parallel ) const
+{
+   TransformBatch< false >(pIn, count, details::Vec3Stream< T > { pOutX, pOutY, pOutZ, 1 }, parallel);
+}
 
-   const T determinant = dot0.X() + dot0.Y() + dot0.Z() + dot0.W();
-   
-   const T one_over_determinant = static_cast< T >(1) / determinant;
+template < typename T >
+template < bool POINTS >
+inline void Matrix< T >::TransformBatch( const T * const pIn, const size_t count,
+                                         const details::Vec3Stream< T > & out, const bool parallel ) const
+{
+   const bool affine = IsAffine();
 
-   inverse *= one_over_determinant;
+   const auto Transform = [ & ] ( const size_t begin, const size_t end )
+   {
+      details::MatrixKernels< T >::template TransformBatch< POINTS >(
+         mT, pIn + begin * 3, end - begin, out.Offset(begin), affine);
+   };
 
-   return determinant;
+   if (parallel)
+   {
+      ParallelFor(count, TRANSFORM_GRAIN_SIZE, Transform);
+   }
+   else
+   {
+      Transform(0, count);
+   }
 }
 
 // global typedefs
 typedef Matrix< float > Matrixf;
 typedef Matrix< double > Matrixd;
 
+// matrices are handed to opengl and copied into uniform
+// blocks with memcpy, so they must remain plain data
+static_assert(std::is_trivially_copyable< Matrixf >::value && std::is_standard_layout< Matrixf >::value, "Matrixf must be plain data");
+static_assert(std::is_trivially_copyable< Matrixd >::value && std::is_standard_layout< Matrixd >::value, "Matrixd must be plain data");
+static_assert(sizeof(Matrixf) == sizeof(float) * 16, "Matrixf must not be padded");
+
+// the factories are usable in constant expressions
+static_assert(Matrixf().IsAffine() && Matrixf::Translate(1.0f, 2.0f, 3.0f).mT[13] == 2.0f, "translation is not constexpr");
+static_assert((Matrixd::Scale(4.0).Transpose() * 0.5).mT[5] == 2.0 && Matrixd::Scale(1.0) == Matrixd(), "scaling is not constexpr");
+static_assert(Matrixf::Ortho(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f).mT[10] == -1.0f, "ortho is not constexpr");
+static_assert(Matrixd::Frustum(-1.0, 1.0, -1.0, 1.0, 1.0, 3.0).mT[14] == -3.0, "frustum is not constexpr");
+
 #endif // _MATRIX_H_
@@ -0,0 +1,431 @@
+#ifndef _MATRIX_KERNELS_H_
+#define _MATRIX_KERNELS_H_
+
+// local includes
+#include "Simd.h"
+
+// std includes
+#include <cstddef>
+#include <type_traits>
+
+// the kernels operate on column major 4x4 arrays so they can
+// be shared by Matrix< T > and any other type storing 16 values.
+// the simd kernels evaluate every product and sum in the same
+// order as the scalar kernels, so without fused multiply-add
+// contraction both paths produce identical results.
+namespace details
+{
+
+// destination of a batch of x, y, z triples... interleaved
+// arrays use a stride of 3 and separate arrays a stride of 1
+template < typename T >
+struct Vec3Stream
+{
+   // returns the stream starting count triples further in
+   Vec3Stream Offset( const size_t count ) const
+   {
+      const size_t offset = count * stride;
+
+      return Vec3Stream { pX + offset, pY + offset, pZ + offset, stride };
+   }
+
+   T *      pX;
+   T *      pY;
+   T *      pZ;
+   size_t   stride;
+};
+
+// reference kernels used for all types without a simd backend
+template < typename T >
+struct ScalarMatrixKernels
+{
+   // out = lhs * rhs (post multiplication to conform to opengl)
+   // out must not alias either of the inputs
+   static void Multiply( const T * const pLhs, const T * const pRhs, T * const pOut )
+   {
+      for (int i = 0; i < 4; ++i)
+      {
+         const T * const pCol = pRhs + i * 4;
+         T * const pOutCol = pOut + i * 4;
+
+         pOutCol[0] = pLhs[0] * pCol[0] + pLhs[4] * pCol[1] + pLhs[8]  * pCol[2] + pLhs[12] * pCol[3];
+         pOutCol[1] = pLhs[1] * pCol[0] + pLhs[5] * pCol[1] + pLhs[9]  * pCol[2] + pLhs[13] * pCol[3];
+         pOutCol[2] = pLhs[2] * pCol[0] + pLhs[6] * pCol[1] + pLhs[10] * pCol[2] + pLhs[14] * pCol[3];
+         pOutCol[3] = pLhs[3] * pCol[0] + pLhs[7] * pCol[1] + pLhs[11] * pCol[2] + pLhs[15] * pCol[3];
+      }
+   }
+
+   // out = mat * vec
+   static void Transform( const T * const pMat, const T * const pVec, T * const pOut )
+   {
+      const T x = pMat[0] * pVec[0] + pMat[4] * pVec[1] + pMat[8]  * pVec[2] + pMat[12] * pVec[3];
+      const T y = pMat[1] * pVec[0] + pMat[5] * pVec[1] + pMat[9]  * pVec[2] + pMat[13] * pVec[3];
+      const T z = pMat[2] * pVec[0] + pMat[6] * pVec[1] + pMat[10] * pVec[2] + pMat[14] * pVec[3];
+      const T w = pMat[3] * pVec[0] + pMat[7] * pVec[1] + pMat[11] * pVec[2] + pMat[15] * pVec[3];
+
+      pOut[0] = x; pOut[1] = y; pOut[2] = z; pOut[3] = w;
+   }
+
+   // computes the inverse through the cofactors and returns the determinant
+   // the inverse is undefined if the determinant returned is zero
+   static T Inverse( const T * const pMat, T * const pOut )
+   {
+      T fac[6][4];
+      // each factor holds the 2x2 minors of the last two columns
+      // for a pair of rows... see ComputeFactor for the layout
+      ComputeFactor(pMat, 2, 3, fac[0]);
+      ComputeFactor(pMat, 1, 3, fac[1]);
+      ComputeFactor(pMat, 1, 2, fac[2]);
+      ComputeFactor(pMat, 0, 3, fac[3]);
+      ComputeFactor(pMat, 0, 2, fac[4]);
+      ComputeFactor(pMat, 0, 1, fac[5]);
+
+      const T vec[4][4] =
+      {
+         { pMat[4], pMat[0], pMat[0], pMat[0] },
+         { pMat[5], pMat[1], pMat[1], pMat[1] },
+         { pMat[6], pMat[2], pMat[2], pMat[2] },
+         { pMat[7], pMat[3], pMat[3], pMat[3] }
+      };
+
+      const T sign[2][4] =
+      {
+         { T(+1), T(-1), T(+1), T(-1) },
+         { T(-1), T(+1), T(-1), T(+1) }
+      };
+
+      for (int i = 0; i < 4; ++i)
+      {
+         pOut[0 + i]  = (vec[1][i] * fac[0][i] - vec[2][i] * fac[1][i] + vec[3][i] * fac[2][i]) * sign[0][i];
+         pOut[4 + i]  = (vec[0][i] * fac[0][i] - vec[2][i] * fac[3][i] + vec[3][i] * fac[4][i]) * sign[1][i];
+         pOut[8 + i]  = (vec[0][i] * fac[1][i] - vec[1][i] * fac[3][i] + vec[3][i] * fac[5][i]) * sign[0][i];
+         pOut[12 + i] = (vec[0][i] * fac[2][i] - vec[1][i] * fac[4][i] + vec[2][i] * fac[5][i]) * sign[1][i];
+      }
+
+      const T determinant = pMat[0] * pOut[0] + pMat[1] * pOut[4] + pMat[2] * pOut[8] + pMat[3] * pOut[12];
+
+      const T one_over_determinant = static_cast< T >(1) / determinant;
+
+      for (int i = 0; i < 16; ++i) pOut[i] *= one_over_determinant;
+
+      return determinant;
+   }
+
+   static T Determinant( const T * const pMat )
+   {
+      T inverse[16];
+
+      return Inverse(pMat, inverse);
+   }
+
+   // transforms count x, y, z triples read back to back from pIn.
+   // points add the translation and divide by w unless affine is set,
+   // vectors are only transformed by the upper 3x3 of the matrix.
+   // the output may alias the input if it is also interleaved.
+   template < bool POINTS >
+   static void TransformBatch( const T * const pMat, const T * const pIn, const size_t count,
+                               const Vec3Stream< T > & out, const bool affine )
+   {
+      for (size_t i = 0; i < count; ++i)
+      {
+         const T * const pVec = pIn + i * 3;
+
+         T x = pMat[0] * pVec[0] + pMat[4] * pVec[1] + pMat[8]  * pVec[2];
+         T y = pMat[1] * pVec[0] + pMat[5] * pVec[1] + pMat[9]  * pVec[2];
+         T z = pMat[2] * pVec[0] + pMat[6] * pVec[1] + pMat[10] * pVec[2];
+
+         if constexpr (POINTS)
+         {
+            x = x + pMat[12]; y = y + pMat[13]; z = z + pMat[14];
+
+            if (!affine)
+            {
+               const T w = pMat[3] * pVec[0] + pMat[7] * pVec[1] + pMat[11] * pVec[2] + pMat[15];
+               const T one_over_w = static_cast< T >(1) / w;
+
+               x = x * one_over_w; y = y * one_over_w; z = z * one_over_w;
+            }
+         }
+
+         const size_t offset = i * out.stride;
+
+         out.pX[offset] = x; out.pY[offset] = y; out.pZ[offset] = z;
+      }
+   }
+
+private:
+   // fac = { c2r1 * c3r2 - c3r1 * c2r2, same, c1r1 * c3r2 - c3r1 * c1r2, c1r1 * c2r2 - c2r1 * c1r2 }
+   static void ComputeFactor( const T * const pMat, const int r1, const int r2, T * const pFac )
+   {
+      const T coef0 = pMat[8 + r1] * pMat[12 + r2] - pMat[12 + r1] * pMat[8 + r2];
+      const T coef2 = pMat[4 + r1] * pMat[12 + r2] - pMat[12 + r1] * pMat[4 + r2];
+      const T coef3 = pMat[4 + r1] * pMat[8 + r2]  - pMat[8 + r1]  * pMat[4 + r2];
+
+      pFac[0] = coef0; pFac[1] = coef0; pFac[2] = coef2; pFac[3] = coef3;
+   }
+
+};
+
+// simd kernels that mirror the scalar kernels one operation at a time
+template < typename T >
+struct SimdMatrixKernels
+{
+   typedef simd::Vec4< T > V;
+
+   static void Multiply( const T * const pLhs, const T * const pRhs, T * const pOut )
+   {
+      const V c0 = V::Load(pLhs + 0);
+      const V c1 = V::Load(pLhs + 4);
+      const V c2 = V::Load(pLhs + 8);
+      const V c3 = V::Load(pLhs + 12);
+
+      // load the columns before storing so pOut may alias either input
+      V r[4];
+
+      for (int i = 0; i < 4; ++i)
+      {
+         const T * const pCol = pRhs + i * 4;
+
+         r[i] = c0 * V::Splat(pCol[0]) + c1 * V::Splat(pCol[1]) + c2 * V::Splat(pCol[2]) + c3 * V::Splat(pCol[3]);
+      }
+
+      for (int i = 0; i < 4; ++i) r[i].Store(pOut + i * 4);
+   }
+
+   static void Transform( const T * const pMat, const T * const pVec, T * const pOut )
+   {
+      const V r = V::Load(pMat + 0)  * V::Splat(pVec[0]) +
+                  V::Load(pMat + 4)  * V::Splat(pVec[1]) +
+                  V::Load(pMat + 8)  * V::Splat(pVec[2]) +
+                  V::Load(pMat + 12) * V::Splat(pVec[3]);
+
+      r.Store(pOut);
+   }
+
+   static T Inverse( const T * const pMat, T * const pOut )
+   {
+      return Inverse(pMat, pOut, std::integral_constant< bool, V::FAST_SHUFFLE >());
+   }
+
+   static T Determinant( const T * const pMat )
+   {
+      T inverse[16];
+
+      return Inverse(pMat, inverse);
+   }
+
+   template < bool POINTS >
+   static void TransformBatch( const T * const pMat, const T * const pIn, const size_t count,
+                               const Vec3Stream< T > & out, const bool affine )
+   {
+      TransformBatch< POINTS >(pMat, pIn, count, out, affine, std::integral_constant< bool, V::FAST_SHUFFLE >());
+   }
+
+private:
+   // the inverse is mostly lane shuffling... when shuffles are slow
+   // the compiler does a better job vectorizing the scalar kernel
+   static T Inverse( const T * const pMat, T * const pOut, std::false_type )
+   {
+      return ScalarMatrixKernels< T >::Inverse(pMat, pOut);
+   }
+
+   static T Inverse( const T * const pMat, T * const pOut, std::true_type )
+   {
+      const V c0 = V::Load(pMat + 0);
+      const V c1 = V::Load(pMat + 4);
+      const V c2 = V::Load(pMat + 8);
+      const V c3 = V::Load(pMat + 12);
+
+      const V fac0 = Factor< 2, 3 >(c1, c2, c3);
+      const V fac1 = Factor< 1, 3 >(c1, c2, c3);
+      const V fac2 = Factor< 1, 2 >(c1, c2, c3);
+      const V fac3 = Factor< 0, 3 >(c1, c2, c3);
+      const V fac4 = Factor< 0, 2 >(c1, c2, c3);
+      const V fac5 = Factor< 0, 1 >(c1, c2, c3);
+
+      const V vec0 = Row< 0 >(c0, c1);
+      const V vec1 = Row< 1 >(c0, c1);
+      const V vec2 = Row< 2 >(c0, c1);
+      const V vec3 = Row< 3 >(c0, c1);
+
+      const T sign_a[] = { T(+1), T(-1), T(+1), T(-1) };
+      const T sign_b[] = { T(-1), T(+1), T(-1), T(+1) };
+      const V signa = V::Load(sign_a);
+      const V signb = V::Load(sign_b);
+
+      const V inv0 = (vec1 * fac0 - vec2 * fac1 + vec3 * fac2) * signa;
+      const V inv1 = (vec0 * fac0 - vec2 * fac3 + vec3 * fac4) * signb;
+      const V inv2 = (vec0 * fac1 - vec1 * fac3 + vec3 * fac5) * signa;
+      const V inv3 = (vec0 * fac2 - vec1 * fac4 + vec2 * fac5) * signb;
+
+      // gather the first row of the inverse to compute the determinant
+      const V row0 = V::template Shuffle< 0, 2, 0, 2 >(V::template Shuffle< 0, 0, 0, 0 >(inv0, inv1),
+                                                       V::template Shuffle< 0, 0, 0, 0 >(inv2, inv3));
+
+      T dot[4];
+      (c0 * row0).Store(dot);
+
+      const T determinant = dot[0] + dot[1] + dot[2] + dot[3];
+
+      const V one_over_determinant = V::Splat(static_cast< T >(1) / determinant);
+
+      (inv0 * one_over_determinant).Store(pOut + 0);
+      (inv1 * one_over_determinant).Store(pOut + 4);
+      (inv2 * one_over_determinant).Store(pOut + 8);
+      (inv3 * one_over_determinant).Store(pOut + 12);
+
+      return determinant;
+   }
+
+   // transposing the batches into x, y, z lanes is slow without fast
+   // shuffles, so transform one triple per iteration down the columns
+   template < bool POINTS >
+   static void TransformBatch( const T * const pMat, const T * const pIn, const size_t count,
+                               const Vec3Stream< T > & out, const bool affine, std::false_type )
+   {
+      const V c0 = V::Load(pMat + 0);
+      const V c1 = V::Load(pMat + 4);
+      const V c2 = V::Load(pMat + 8);
+      const V c3 = V::Load(pMat + 12);
+
+      for (size_t i = 0; i < count; ++i)
+      {
+         const T * const pVec = pIn + i * 3;
+
+         V r = c0 * V::Splat(pVec[0]) + c1 * V::Splat(pVec[1]) + c2 * V::Splat(pVec[2]);
+
+         if constexpr (POINTS) r = r + c3;
+
+         T result[4];
+         r.Store(result);
+
+         if constexpr (POINTS)
+         {
+            if (!affine)
+            {
+               const T one_over_w = static_cast< T >(1) / result[3];
+
+               result[0] *= one_over_w; result[1] *= one_over_w; result[2] *= one_over_w;
+            }
+         }
+
+         const size_t offset = i * out.stride;
+
+         out.pX[offset] = result[0]; out.pY[offset] = result[1]; out.pZ[offset] = result[2];
+      }
+   }
+
+   // transforms four triples per iteration
+   template < bool POINTS >
+   static void TransformBatch( const T * const pMat, const T * const pIn, const size_t count,
+                               const Vec3Stream< T > & out, const bool affine, std::true_type )
+   {
+      const V m0 = V::Splat(pMat[0]), m4 = V::Splat(pMat[4]), m8  = V::Splat(pMat[8]);
+      const V m1 = V::Splat(pMat[1]), m5 = V::Splat(pMat[5]), m9  = V::Splat(pMat[9]);
+      const V m2 = V::Splat(pMat[2]), m6 = V::Splat(pMat[6]), m10 = V::Splat(pMat[10]);
+      const V m3 = V::Splat(pMat[3]), m7 = V::Splat(pMat[7]), m11 = V::Splat(pMat[11]);
+      const V m12 = V::Splat(pMat[12]), m13 = V::Splat(pMat[13]), m14 = V::Splat(pMat[14]), m15 = V::Splat(pMat[15]);
+      const V one = V::Splat(static_cast< T >(1));
+
+      // only interleaved and separate arrays are handled four at a time
+      const size_t num_blocks = out.stride == 1 || out.stride == 3 ? count / 4 : 0;
+
+      for (size_t block = 0; block < num_blocks; ++block)
+      {
+         V x, y, z;
+         LoadTriples(pIn + block * 12, x, y, z);
+
+         V rx = m0 * x + m4 * y + m8  * z;
+         V ry = m1 * x + m5 * y + m9  * z;
+         V rz = m2 * x + m6 * y + m10 * z;
+
+         if constexpr (POINTS)
+         {
+            rx = rx + m12; ry = ry + m13; rz = rz + m14;
+
+            if (!affine)
+            {
+               const V w = m3 * x + m7 * y + m11 * z + m15;
+               const V one_over_w = one / w;
+
+               rx = rx * one_over_w; ry = ry * one_over_w; rz = rz * one_over_w;
+            }
+         }
+
+         const Vec3Stream< T > block_out = out.Offset(block * 4);
+
+         if (out.stride == 1)
+         {
+            rx.Store(block_out.pX); ry.Store(block_out.pY); rz.Store(block_out.pZ);
+         }
+         else
+         {
+            StoreTriples(block_out.pX, rx, ry, rz);
+         }
+      }
+
+      // finish off any remaining triples
+      ScalarMatrixKernels< T >::template TransformBatch< POINTS >(
+         pMat, pIn + num_blocks * 12, count - num_blocks * 4, out.Offset(num_blocks * 4), affine);
+   }
+
+   // { x0 y0 z0 x1 } { y1 z1 x2 y2 } { z2 x3 y3 z3 } -> { x0 x1 x2 x3 } { y0 ... } { z0 ... }
+   static void LoadTriples( const T * const pT, V & x, V & y, V & z )
+   {
+      const V a = V::Load(pT + 0);
+      const V b = V::Load(pT + 4);
+      const V c = V::Load(pT + 8);
+
+      x = V::template Shuffle< 0, 2, 0, 2 >(V::template Shuffle< 0, 0, 3, 3 >(a, a), V::template Shuffle< 2, 2, 1, 1 >(b, c));
+      y = V::template Shuffle< 0, 2, 0, 2 >(V::template Shuffle< 1, 1, 0, 0 >(a, b), V::template Shuffle< 3, 3, 2, 2 >(b, c));
+      z = V::template Shuffle< 0, 2, 0, 2 >(V::template Shuffle< 2, 2, 1, 1 >(a, b), V::template Shuffle< 0, 0, 3, 3 >(c, c));
+   }
+
+   // inverse of LoadTriples
+   static void StoreTriples( T * const pT, const V & x, const V & y, const V & z )
+   {
+      const V a = V::template Shuffle< 0, 2, 0, 2 >(V::template Shuffle< 0, 0, 0, 0 >(x, y), V::template Shuffle< 0, 0, 1, 1 >(z, x));
+      const V b = V::template Shuffle< 0, 2, 0, 2 >(V::template Shuffle< 1, 1, 1, 1 >(y, z), V::template Shuffle< 2, 2, 2, 2 >(x, y));
+      const V c = V::template Shuffle< 0, 2, 0, 2 >(V::template Shuffle< 2, 2, 3, 3 >(z, x), V::template Shuffle< 3, 3, 3, 3 >(y, z));
+
+      a.Store(pT + 0); b.Store(pT + 4); c.Store(pT + 8);
+   }
+
+   // simd form of ScalarMatrixKernels::ComputeFactor
+   template < int R1, int R2 >
+   static V Factor( const V & c1, const V & c2, const V & c3 )
+   {
+      const V a = V::template Shuffle< R1, R1, R1, R1 >(c2, c1);
+      const V d = V::template Shuffle< R2, R2, R2, R2 >(c2, c1);
+
+      const V b_tmp = V::template Shuffle< R2, R2, R2, R2 >(c3, c2);
+      const V c_tmp = V::template Shuffle< R1, R1, R1, R1 >(c3, c2);
+
+      const V b = V::template Shuffle< 0, 0, 0, 2 >(b_tmp, b_tmp);
+      const V c = V::template Shuffle< 0, 0, 0, 2 >(c_tmp, c_tmp);
+
+      return a * b - c * d;
+   }
+
+   // { c1[r], c0[r], c0[r], c0[r] }
+   template < int R >
+   static V Row( const V & c0, const V & c1 )
+   {
+      const V tmp = V::template Shuffle< R, R, R, R >(c1, c0);
+
+      return V::template Shuffle< 0, 2, 2, 2 >(tmp, tmp);
+   }
+
+};
+
+// kernels used by Matrix< T >... resolved at compile time to
+// the simd kernels when the type has a native backend
+template < typename T >
+struct MatrixKernels :
+   std::conditional_t< simd::Vec4< T >::ACCELERATED, SimdMatrixKernels< T >, ScalarMatrixKernels< T > >
+{
+};
+
+} // namespace details
+
+#endif // _MATRIX_KERNELS_H_
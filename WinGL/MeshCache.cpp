@@ -0,0 +1,562 @@
+// local includes
+#include "MeshCache.h"
+#include "MeshCodec.h"
+#include "WglAssert.h"
+
+// std includes
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+namespace MeshCache
+{
+
+namespace details
+{
+
+// identifies a cache and the version of its layout
+const uint32_t CACHE_MAGIC = 0x4d4c4757; // 'WGLM'
+const uint32_t CACHE_VERSION = 1;
+
+// alignment of each chunk from the start of the file
+const size_t CHUNK_ALIGNMENT = 16;
+
+// the start of the file, followed by the table of chunks
+struct Header
+{
+   uint32_t    magic;
+   uint32_t    version;
+   uint64_t    source_size;
+   int64_t     source_time;
+   uint64_t    source_hash;
+   uint32_t    vertex_stride;
+   uint32_t    index_type;
+   uint32_t    num_chunks;
+   uint32_t    reserved;
+};
+
+// an entry of the table of chunks
+struct Chunk
+{
+   uint32_t    id;
+   // number of elements in the chunk
+   uint32_t    count;
+   uint64_t    offset;
+   uint64_t    size;
+};
+
+enum ChunkID : uint32_t
+{
+   ATTRIBUTES = 1,
+   VERTICES,
+   INDICES,
+   DRAW_RANGES,
+   MATERIALS
+};
+
+static_assert(sizeof(Header) == 48, "the cache header must not be padded");
+static_assert(sizeof(Chunk) == 24, "the cache chunks must not be padded");
+static_assert(sizeof(Attribute) == 20, "the cache attributes must not be padded");
+static_assert(sizeof(DrawRange) == 12, "the cache draw ranges must not be padded");
+
+// hashes the contents of a file a word at a time
+uint64_t Hash( const uint8_t * const pData, const size_t size )
+{
+   const uint64_t K0 = 0x9e3779b97f4a7c15ull;
+   const uint64_t K1 = 0xbf58476d1ce4e5b9ull;
+
+   uint64_t hash = K0 ^ size;
+
+   size_t i = 0;
+
+   for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+   {
+      uint64_t word = 0;
+      std::memcpy(&word, pData + i, sizeof(word));
+
+      hash ^= word * K1;
+      hash = ((hash << 31) | (hash >> 33)) * K0;
+   }
+
+   uint64_t tail = 0;
+   if (size > i) std::memcpy(&tail, pData + i, size - i);
+
+   hash ^= tail * K1;
+
+   // splitmix64 finalizer
+   hash = (hash ^ (hash >> 30)) * K1;
+   hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+
+   return hash ^ (hash >> 31);
+}
+
+// bytes taken by a component of each format
+uint32_t ComponentSize( const Format format )
+{
+   switch (format)
+   {
+   case Format::FLOAT:     return 4;
+   case Format::HALF:      return 2;
+   case Format::SNORM16:   return 2;
+   case Format::UNORM8:    return 1;
+   default: WGL_ASSERT(false); return 0;
+   }
+}
+
+GLenum ComponentType( const Format format )
+{
+   switch (format)
+   {
+   case Format::FLOAT:     return GL_FLOAT;
+   case Format::HALF:      return GL_HALF_FLOAT;
+   case Format::SNORM16:   return GL_SHORT;
+   case Format::UNORM8:    return GL_UNSIGNED_BYTE;
+   default: WGL_ASSERT(false); return GL_FLOAT;
+   }
+}
+
+// bytes taken by a component of a gl type, zero for the types a cache never holds
+uint32_t TypeSize( const GLenum type )
+{
+   switch (type)
+   {
+   case GL_FLOAT:          return 4;
+   case GL_HALF_FLOAT:     return 2;
+   case GL_SHORT:          return 2;
+   case GL_UNSIGNED_BYTE:  return 1;
+   default:                return 0;
+   }
+}
+
+// largest attribute location every gl implementation supports
+const uint32_t MAX_ATTRIBUTE_LOCATION = 15;
+
+// indicates if every index is below the number of vertices
+template < typename T >
+bool IndicesInRange( const void * const pIndices, const size_t num_indices, const size_t num_vertices )
+{
+   const T * const pBegin = static_cast< const T * >(pIndices);
+
+   return std::all_of(pBegin, pBegin + num_indices, [ num_vertices ] ( const T index ) { return index < num_vertices; });
+}
+
+// converts a float component to the format at pDest
+void ConvertComponent( const float value, const Format format, uint8_t * const pDest )
+{
+   switch (format)
+   {
+   case Format::FLOAT:
+      std::memcpy(pDest, &value, sizeof(value));
+      break;
+
+   case Format::HALF:
+      {
+      const uint16_t half = MeshCodec::FloatToHalf(value);
+      std::memcpy(pDest, &half, sizeof(half));
+      }
+      break;
+
+   case Format::SNORM16:
+      {
+      const int16_t snorm = static_cast< int16_t >(std::lround(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f));
+      std::memcpy(pDest, &snorm, sizeof(snorm));
+      }
+      break;
+
+   case Format::UNORM8:
+      *pDest = static_cast< uint8_t >(std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f));
+      break;
+   }
+}
+
+// appends a chunk to the file, aligned from the start of the file
+void AppendChunk( std::vector< uint8_t > & file, std::vector< Chunk > & chunks,
+                  const ChunkID id, const size_t count, const void * const pData, const size_t size )
+{
+   file.resize((file.size() + CHUNK_ALIGNMENT - 1) / CHUNK_ALIGNMENT * CHUNK_ALIGNMENT);
+
+   const Chunk chunk = { id, static_cast< uint32_t >(count), file.size(), size };
+   chunks.push_back(chunk);
+
+   if (size) file.insert(file.end(), static_cast< const uint8_t * >(pData), static_cast< const uint8_t * >(pData) + size);
+}
+
+} // namespace details
+
+bool StampSource( const char * const pFilename, SourceStamp & stamp )
+{
+   std::error_code error;
+
+   const std::filesystem::path path(pFilename);
+
+   const uintmax_t size = std::filesystem::file_size(path, error);
+   if (error) return false;
+
+   const auto time = std::filesystem::last_write_time(path, error);
+   if (error) return false;
+
+   stamp.size = static_cast< uint64_t >(size);
+   stamp.time = static_cast< int64_t >(time.time_since_epoch().count());
+   stamp.hash = details::Hash(nullptr, 0);
+
+   if (size)
+   {
+      MappedFile file;
+
+      if (!file.Open(pFilename)) return false;
+
+      stamp.hash = details::Hash(file.Data(), file.Size());
+   }
+
+   return true;
+}
+
+std::string CacheFilename( const char * const pSourceFilename )
+{
+   return std::string(pSourceFilename) + ".wglmesh";
+}
+
+std::vector< uint8_t > Serialize( const SourceStamp & source,
+                                  const MeshSource & mesh )
+{
+   // lay out the attributes with each one aligned to 4 bytes
+   std::vector< Attribute > attributes;
+   uint32_t stride = 0;
+
+   for (const AttributeSource & attribute : mesh.attributes)
+   {
+      const Attribute layout =
+      {
+         attribute.location,
+         attribute.components,
+         details::ComponentType(attribute.format),
+         attribute.format == Format::SNORM16 || attribute.format == Format::UNORM8,
+         stride
+      };
+
+      attributes.push_back(layout);
+
+      stride += (attribute.components * details::ComponentSize(attribute.format) + 3) & ~3u;
+   }
+
+   std::vector< uint8_t > vertices(mesh.num_vertices * stride, 0);
+
+   for (size_t a = 0; a < attributes.size(); ++a)
+   {
+      const AttributeSource & attribute = mesh.attributes[a];
+      const uint32_t component_size = details::ComponentSize(attribute.format);
+
+      for (size_t v = 0; v < mesh.num_vertices; ++v)
+      {
+         uint8_t * const pVertex = vertices.data() + v * stride + attributes[a].offset;
+
+         for (uint32_t c = 0; c < attribute.components; ++c)
+         {
+            details::ConvertComponent(attribute.pData[v * attribute.components + c], attribute.format,
+                                      pVertex + c * component_size);
+         }
+      }
+   }
+
+   const GLenum index_type = mesh.num_vertices <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+   const std::vector< uint16_t > indices16 =
+      index_type == GL_UNSIGNED_SHORT ?
+      std::vector< uint16_t >(mesh.indices.cbegin(), mesh.indices.cend()) :
+      std::vector< uint16_t >();
+
+   std::string materials;
+
+   for (const std::string & material : mesh.materials) materials.append(material.c_str(), material.size() + 1);
+
+   // the header and table are filled in once the chunks are placed
+   const size_t NUM_CHUNKS = 5;
+
+   std::vector< uint8_t > file(sizeof(details::Header) + NUM_CHUNKS * sizeof(details::Chunk));
+   std::vector< details::Chunk > chunks;
+
+   details::AppendChunk(file, chunks, details::ATTRIBUTES, attributes.size(),
+                        attributes.data(), attributes.size() * sizeof(Attribute));
+   details::AppendChunk(file, chunks, details::VERTICES, mesh.num_vertices,
+                        vertices.data(), vertices.size());
+
+   if (index_type == GL_UNSIGNED_SHORT)
+   {
+      details::AppendChunk(file, chunks, details::INDICES, indices16.size(),
+                           indices16.data(), indices16.size() * sizeof(uint16_t));
+   }
+   else
+   {
+      details::AppendChunk(file, chunks, details::INDICES, mesh.indices.size(),
+                           mesh.indices.data(), mesh.indices.size() * sizeof(GLuint));
+   }
+
+   details::AppendChunk(file, chunks, details::DRAW_RANGES, mesh.draw_ranges.size(),
+                        mesh.draw_ranges.data(), mesh.draw_ranges.size() * sizeof(DrawRange));
+   details::AppendChunk(file, chunks, details::MATERIALS, mesh.materials.size(),
+                        materials.data(), materials.size());
+
+   WGL_ASSERT(chunks.size() == NUM_CHUNKS);
+
+   const details::Header header =
+   {
+      details::CACHE_MAGIC, details::CACHE_VERSION,
+      source.size, source.time, source.hash,
+      stride, index_type,
+      static_cast< uint32_t >(chunks.size()), 0
+   };
+
+   std::memcpy(file.data(), &header, sizeof(header));
+   std::memcpy(file.data() + sizeof(header), chunks.data(), chunks.size() * sizeof(details::Chunk));
+
+   return file;
+}
+
+bool Write( const char * const pFilename,
+            const std::vector< uint8_t > & contents )
+{
+   // write beside the cache and then replace it
+   const std::string temp_filename = std::string(pFilename) + ".tmp";
+
+   {
+      std::ofstream stream(temp_filename, std::ios::binary | std::ios::trunc);
+
+      stream.write(reinterpret_cast< const char * >(contents.data()), static_cast< std::streamsize >(contents.size()));
+
+      if (!stream)
+      {
+         stream.close();
+         std::remove(temp_filename.c_str());
+
+         return false;
+      }
+   }
+
+   std::error_code error;
+   std::filesystem::rename(temp_filename, pFilename, error);
+
+   if (error)
+   {
+      std::remove(temp_filename.c_str());
+
+      return false;
+   }
+
+   return true;
+}
+
+Mesh::Mesh( ) :
+mpVertices     ( nullptr ),
+mNumVertices   ( 0 ),
+mVertexStride  ( 0 ),
+mpAttributes   ( nullptr ),
+mNumAttributes ( 0 ),
+mpIndices      ( nullptr ),
+mNumIndices    ( 0 ),
+mIndexType     ( GL_UNSIGNED_INT ),
+mpDrawRanges   ( nullptr ),
+mNumDrawRanges ( 0 )
+{
+}
+
+Mesh::~Mesh( )
+{
+}
+
+Mesh::Mesh( Mesh && mesh ) :
+Mesh()
+{
+   *this = std::move(mesh);
+}
+
+Mesh & Mesh::operator = ( Mesh && mesh )
+{
+   std::swap(mFile, mesh.mFile);
+   std::swap(mContents, mesh.mContents);
+   std::swap(mpVertices, mesh.mpVertices);
+   std::swap(mNumVertices, mesh.mNumVertices);
+   std::swap(mVertexStride, mesh.mVertexStride);
+   std::swap(mpAttributes, mesh.mpAttributes);
+   std::swap(mNumAttributes, mesh.mNumAttributes);
+   std::swap(mpIndices, mesh.mpIndices);
+   std::swap(mNumIndices, mesh.mNumIndices);
+   std::swap(mIndexType, mesh.mIndexType);
+   std::swap(mpDrawRanges, mesh.mpDrawRanges);
+   std::swap(mNumDrawRanges, mesh.mNumDrawRanges);
+   std::swap(mMaterials, mesh.mMaterials);
+
+   return *this;
+}
+
+bool Mesh::Open( const char * const pFilename, const SourceStamp & source )
+{
+   Close();
+
+   return mFile.Open(pFilename) && View(mFile.Data(), mFile.Size(), source);
+}
+
+bool Mesh::Open( std::vector< uint8_t > && contents, const SourceStamp & source )
+{
+   Close();
+
+   mContents = std::move(contents);
+
+   return View(mContents.data(), mContents.size(), source);
+}
+
+bool Mesh::View( const uint8_t * const pData, const size_t size, const SourceStamp & source )
+{
+   details::Header header = { };
+
+   if (size < sizeof(header)) { Close(); return false; }
+
+   std::memcpy(&header, pData, sizeof(header));
+
+   const bool current =
+      header.magic == details::CACHE_MAGIC &&
+      header.version == details::CACHE_VERSION &&
+      header.source_size == source.size &&
+      header.source_time == source.time &&
+      header.source_hash == source.hash &&
+      (header.index_type == GL_UNSIGNED_SHORT || header.index_type == GL_UNSIGNED_INT) &&
+      header.num_chunks <= (size - sizeof(header)) / sizeof(details::Chunk);
+
+   if (!current) { Close(); return false; }
+
+   mVertexStride = header.vertex_stride;
+   mIndexType = header.index_type;
+
+   const details::Chunk * const pChunks = reinterpret_cast< const details::Chunk * >(pData + sizeof(header));
+
+   // points the views at the chunks, checking that each lies in the file
+   // and holds count elements of its type
+   bool valid = true;
+   uint32_t found = 0;
+
+   for (uint32_t i = 0; i < header.num_chunks; ++i)
+   {
+      const details::Chunk & chunk = pChunks[i];
+
+      if (chunk.offset % details::CHUNK_ALIGNMENT || chunk.offset > size || chunk.size > size - chunk.offset)
+      {
+         valid = false;
+         break;
+      }
+
+      const uint8_t * const pChunk = pData + chunk.offset;
+
+      switch (chunk.id)
+      {
+      case details::ATTRIBUTES:
+         valid &= chunk.size == chunk.count * sizeof(Attribute);
+         mpAttributes = reinterpret_cast< const Attribute * >(pChunk);
+         mNumAttributes = chunk.count;
+         break;
+
+      case details::VERTICES:
+         valid &= chunk.size == static_cast< uint64_t >(chunk.count) * mVertexStride;
+         mpVertices = pChunk;
+         mNumVertices = chunk.count;
+         break;
+
+      case details::INDICES:
+         valid &= chunk.size == chunk.count * IndexSize();
+         mpIndices = pChunk;
+         mNumIndices = chunk.count;
+         break;
+
+      case details::DRAW_RANGES:
+         valid &= chunk.size == chunk.count * sizeof(DrawRange);
+         mpDrawRanges = reinterpret_cast< const DrawRange * >(pChunk);
+         mNumDrawRanges = chunk.count;
+         break;
+
+      case details::MATERIALS:
+         for (const char * pName = reinterpret_cast< const char * >(pChunk),
+                         * const pEnd = pName + chunk.size;
+              valid && mMaterials.size() < chunk.count; )
+         {
+            const char * const pNameEnd = std::find(pName, pEnd, '\0');
+
+            valid &= pNameEnd != pEnd;
+
+            mMaterials.push_back(pName);
+            pName = pNameEnd + 1;
+         }
+
+         valid &= mMaterials.size() == chunk.count;
+         break;
+
+      default:
+         // chunks from newer writers are skipped
+         continue;
+      }
+
+      found |= 1u << chunk.id;
+   }
+
+   // every chunk is required, every draw must lie within the indices and
+   // use one of the materials, and every index must name a vertex
+   const uint32_t REQUIRED =
+      (1u << details::ATTRIBUTES) | (1u << details::VERTICES) | (1u << details::INDICES) |
+      (1u << details::DRAW_RANGES) | (1u << details::MATERIALS);
+
+   valid &= found == REQUIRED;
+
+   for (size_t i = 0; valid && i < mNumDrawRanges; ++i)
+   {
+      valid &= mpDrawRanges[i].first_index <= mNumIndices &&
+               mpDrawRanges[i].num_indices <= mNumIndices - mpDrawRanges[i].first_index &&
+               mpDrawRanges[i].material < mMaterials.size();
+   }
+
+   if (valid)
+   {
+      valid = mIndexType == GL_UNSIGNED_SHORT ?
+              details::IndicesInRange< uint16_t >(mpIndices, mNumIndices, mNumVertices) :
+              details::IndicesInRange< GLuint >(mpIndices, mNumIndices, mNumVertices);
+   }
+
+   // every attribute must be one the cache could have written and lie
+   // within the vertex
+   for (size_t i = 0; valid && i < mNumAttributes; ++i)
+   {
+      const Attribute & attribute = mpAttributes[i];
+      const uint64_t attribute_size = static_cast< uint64_t >(attribute.components) * details::TypeSize(attribute.type);
+
+      valid &= attribute.location <= details::MAX_ATTRIBUTE_LOCATION &&
+               attribute.components >= 1 && attribute.components <= 4 &&
+               details::TypeSize(attribute.type) != 0 &&
+               attribute.normalized <= 1 &&
+               attribute.offset <= mVertexStride &&
+               attribute_size <= mVertexStride - attribute.offset;
+   }
+
+   if (!valid) Close();
+
+   return valid;
+}
+
+void Mesh::Close( )
+{
+   mFile.Close();
+   mContents.clear();
+
+   mpVertices = nullptr;
+   mNumVertices = 0;
+   mVertexStride = 0;
+   mpAttributes = nullptr;
+   mNumAttributes = 0;
+   mpIndices = nullptr;
+   mNumIndices = 0;
+   mIndexType = GL_UNSIGNED_INT;
+   mpDrawRanges = nullptr;
+   mNumDrawRanges = 0;
+   mMaterials.clear();
+}
+
+} // namespace MeshCache
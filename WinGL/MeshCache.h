@@ -0,0 +1,179 @@
+#ifndef _MESH_CACHE_H_
+#define _MESH_CACHE_H_
+
+// local includes
+#include "MappedFile.h"
+
+// gl includes
+#include <GL/glew.h>
+#include <GL/GL.h>
+
+// std includes
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// binary caches of imported meshes (.wglmesh).  a cache holds the vertices
+// interleaved and ready for a vertex buffer, the indices, the ranges drawn
+// per material, and the material names, all laid out as the gpu and the
+// application use them.  opening a cache maps it into memory and points at
+// its contents without parsing or copying them.
+namespace MeshCache
+{
+
+// identifies the contents of a source file...
+// a cache is only used if the stamp of its source still matches
+struct SourceStamp
+{
+   uint64_t    size;
+   int64_t     time;
+   uint64_t    hash;
+};
+
+// how an attribute is stored in the cached vertices
+enum class Format : uint32_t
+{
+   FLOAT,      // GL_FLOAT
+   HALF,       // GL_HALF_FLOAT
+   SNORM16,    // normalized GL_SHORT, for values in [-1, 1]
+   UNORM8      // normalized GL_UNSIGNED_BYTE, for values in [0, 1]
+};
+
+// an attribute of the cached vertices, as passed to glVertexAttribPointer
+struct Attribute
+{
+   uint32_t    location;
+   uint32_t    components;
+   GLenum      type;
+   uint32_t    normalized;
+   uint32_t    offset;
+};
+
+// a range of indices drawn with a material
+struct DrawRange
+{
+   uint32_t    material;
+   uint32_t    first_index;
+   uint32_t    num_indices;
+};
+
+// a float attribute of the source mesh to interleave into the cache
+struct AttributeSource
+{
+   uint32_t       location;
+   uint32_t       components;
+   Format         format;
+   // components floats per vertex
+   const float *  pData;
+};
+
+// the mesh to write to a cache
+struct MeshSource
+{
+   size_t                           num_vertices;
+   std::vector< AttributeSource >   attributes;
+   std::vector< GLuint >            indices;
+   std::vector< DrawRange >         draw_ranges;
+   std::vector< std::string >       materials;
+};
+
+// stamps the source file with its size, write time, and a hash of its
+// contents.  returns false if the file cannot be read.
+bool StampSource( const char * const pFilename, SourceStamp & stamp );
+
+// name of the cache of a source file
+std::string CacheFilename( const char * const pSourceFilename );
+
+// interleaves the mesh into the contents of a cache for the source with the
+// given stamp.  the indices are stored as 16 bits when the vertices allow.
+std::vector< uint8_t > Serialize( const SourceStamp & source,
+                                  const MeshSource & mesh );
+
+// writes the contents of a cache.  the cache is written beside its final
+// name and then moved in place, so a cache that is interrupted while
+// writing is never opened.
+bool Write( const char * const pFilename,
+            const std::vector< uint8_t > & contents );
+
+// an open cache, mapped into memory
+class Mesh
+{
+public:
+   // constructor / destructor
+    Mesh( );
+   ~Mesh( );
+
+   // only allow move construction and assignment
+   Mesh( Mesh && mesh );
+   Mesh & operator = ( Mesh && mesh );
+
+   // maps the cache.  returns false if the cache is missing, was written by
+   // another version, is damaged, or is stale for the source stamp.  a cache
+   // is damaged if its chunks do not fit the file, an attribute does not fit
+   // the vertex, or an index or draw names a vertex or material it lacks.
+   bool Open( const char * const pFilename, const SourceStamp & source );
+
+   // takes the contents of a cache from Serialize, for when the cache
+   // could not be written and the mesh is used straight from memory
+   bool Open( std::vector< uint8_t > && contents, const SourceStamp & source );
+
+   void Close( );
+
+   // indicates if a cache is open
+   bool IsOpen( ) const { return mpVertices != nullptr; }
+
+   // interleaved vertices
+   const void * Vertices( ) const { return mpVertices; }
+   size_t NumVertices( ) const { return mNumVertices; }
+   uint32_t VertexStride( ) const { return mVertexStride; }
+
+   const Attribute * Attributes( ) const { return mpAttributes; }
+   size_t NumAttributes( ) const { return mNumAttributes; }
+
+   // indices of GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+   const void * Indices( ) const { return mpIndices; }
+   size_t NumIndices( ) const { return mNumIndices; }
+   GLenum IndexType( ) const { return mIndexType; }
+   size_t IndexSize( ) const { return mIndexType == GL_UNSIGNED_SHORT ? 2 : 4; }
+
+   const DrawRange * DrawRanges( ) const { return mpDrawRanges; }
+   size_t NumDrawRanges( ) const { return mNumDrawRanges; }
+
+   // material names, pointing into the cache
+   const std::vector< const char * > & Materials( ) const { return mMaterials; }
+
+private:
+   // prohibit copy construction and assignment
+   Mesh( const Mesh & );
+   Mesh & operator = ( const Mesh & );
+
+   // points the views at the contents of the cache if they are valid
+   bool View( const uint8_t * const pData, const size_t size, const SourceStamp & source );
+
+   // the mapped cache or the contents taken in memory
+   MappedFile                    mFile;
+   std::vector< uint8_t >        mContents;
+
+   // views of the cache contents
+   const void *                  mpVertices;
+   size_t                        mNumVertices;
+   uint32_t                      mVertexStride;
+
+   const Attribute *             mpAttributes;
+   size_t                        mNumAttributes;
+
+   const void *                  mpIndices;
+   size_t                        mNumIndices;
+   GLenum                        mIndexType;
+
+   const DrawRange *             mpDrawRanges;
+   size_t                        mNumDrawRanges;
+
+   std::vector< const char * >   mMaterials;
+
+};
+
+} // namespace MeshCache
+
+#endif // _MESH_CACHE_H_
@@ -0,0 +1,763 @@
+// local includes
+#include "MeshCodec.h"
+
+// std includes
+#include <cmath>
+#include <limits>
+#include <cstring>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+
+namespace MeshCodec
+{
+
+namespace details
+{
+
+// identifies a compressed shape and the version of its layout
+const uint32_t COMPRESSED_MAGIC = 0x5a4c4757; // 'WGLZ'
+const uint32_t COMPRESSED_VERSION = 1;
+
+// attributes present in a compressed shape
+const uint32_t HAS_TEX_COORDS = 0x01;
+const uint32_t HAS_NORMALS = 0x02;
+const uint32_t HAS_TANGENTS = 0x04;
+const uint32_t HAS_BITANGENTS = 0x08;
+
+// largest magnitude of a snorm16
+const float SNORM16_MAX = 32767.0f;
+
+// the entropy coder is a byte wise rans (duda 2013) with the symbol
+// frequencies normalized to PROB_BITS and the state kept in [RANS_L, RANS_L << 8)
+const uint32_t PROB_BITS = 12;
+const uint32_t PROB_SCALE = 1u << PROB_BITS;
+const uint32_t RANS_L = 1u << 23;
+
+// most bytes a delta coded value takes, and the most bytes a stream may
+// decode to...  larger counts read from a stream are taken to be corrupt,
+// rather than trusted with an allocation
+const size_t MAX_VARINT_BYTES = 5;
+const size_t MAX_STREAM_BYTES = size_t(1) << 28;
+
+inline uint32_t BitsOf( const float value )
+{
+   uint32_t bits = 0;
+   std::memcpy(&bits, &value, sizeof(bits));
+
+   return bits;
+}
+
+inline float FloatOf( const uint32_t bits )
+{
+   float value = 0.0f;
+   std::memcpy(&value, &bits, sizeof(value));
+
+   return value;
+}
+
+inline int16_t QuantizeSnorm( const float value )
+{
+   return static_cast< int16_t >(std::lround(std::min(std::max(value, -1.0f), 1.0f) * SNORM16_MAX));
+}
+
+// encodes the vectors of an attribute that may be missing
+void EncodeOctahedral( const std::vector< Vec3f > & vectors, std::vector< int16_t > & encoded )
+{
+   encoded.resize(vectors.size() * 2);
+
+   for (size_t i = 0; i < vectors.size(); ++i)
+   {
+      MeshCodec::EncodeOctahedral(vectors[i], reinterpret_cast< int16_t (&)[2] >(encoded[i * 2]));
+   }
+}
+
+void DecodeOctahedral( const std::vector< int16_t > & encoded, std::vector< Vec3f > & vectors )
+{
+   vectors.resize(encoded.size() / 2);
+
+   for (size_t i = 0; i < vectors.size(); ++i)
+   {
+      vectors[i] = MeshCodec::DecodeOctahedral(reinterpret_cast< const int16_t (&)[2] >(encoded[i * 2]));
+   }
+}
+
+// appends the little endian bytes of a value
+template < typename T >
+void Write( std::vector< uint8_t > & bytes, const T value )
+{
+   static_assert(std::is_trivially_copyable< T >::value, "only plain values can be written");
+
+   const size_t offset = bytes.size();
+   bytes.resize(offset + sizeof(T));
+
+   std::memcpy(&bytes[offset], &value, sizeof(T));
+}
+
+// reads values from a buffer until it runs out
+class Reader
+{
+public:
+   Reader( const uint8_t * const pBegin, const uint8_t * const pEnd ) :
+   mpCur    ( pBegin ),
+   mpEnd    ( pEnd )
+   {
+   }
+
+   template < typename T >
+   bool Read( T & value )
+   {
+      if (Remaining() < sizeof(T)) return false;
+
+      std::memcpy(&value, mpCur, sizeof(T));
+      mpCur += sizeof(T);
+
+      return true;
+   }
+
+   // skips count bytes and returns where they start
+   const uint8_t * Skip( const size_t count )
+   {
+      if (Remaining() < count) return nullptr;
+
+      const uint8_t * const pBytes = mpCur;
+      mpCur += count;
+
+      return pBytes;
+   }
+
+   size_t Remaining( ) const { return static_cast< size_t >(mpEnd - mpCur); }
+
+private:
+   const uint8_t *   mpCur;
+   const uint8_t *   mpEnd;
+
+};
+
+// writes each value as the zigzagged difference from the value stride
+// elements before it, in base 128 with the high bit marking more bytes...
+// values that change slowly from vertex to vertex take a byte each
+template < typename T >
+void DeltaEncode( const std::vector< T > & values, const size_t stride, std::vector< uint8_t > & bytes )
+{
+   typedef typename std::make_unsigned< T >::type U;
+   typedef typename std::make_signed< T >::type S;
+
+   bytes.clear();
+   bytes.reserve(values.size() + values.size() / 4);
+
+   for (size_t i = 0; i < values.size(); ++i)
+   {
+      const U previous = i >= stride ? static_cast< U >(values[i - stride]) : U(0);
+      const int32_t delta = static_cast< S >(static_cast< U >(static_cast< U >(values[i]) - previous));
+
+      uint32_t zigzag = (static_cast< uint32_t >(delta) << 1) ^ static_cast< uint32_t >(delta >> 31);
+
+      while (zigzag >= 0x80)
+      {
+         bytes.push_back(static_cast< uint8_t >(zigzag | 0x80));
+         zigzag >>= 7;
+      }
+
+      bytes.push_back(static_cast< uint8_t >(zigzag));
+   }
+}
+
+template < typename T >
+bool DeltaDecode( const std::vector< uint8_t > & bytes, const size_t count, const size_t stride, std::vector< T > & values )
+{
+   typedef typename std::make_unsigned< T >::type U;
+
+   // every value takes at least a byte
+   if (count > bytes.size()) return false;
+
+   values.resize(count);
+
+   const uint8_t * pCur = bytes.data();
+   const uint8_t * const pEnd = pCur + bytes.size();
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      if (pCur == pEnd) return false;
+
+      uint32_t zigzag = *pCur++;
+
+      // most deltas fit in the first byte
+      if (zigzag & 0x80)
+      {
+         zigzag &= 0x7f;
+
+         for (uint32_t shift = 7; ; shift += 7)
+         {
+            if (pCur == pEnd || shift > 28) return false;
+
+            const uint8_t byte = *pCur++;
+
+            zigzag |= static_cast< uint32_t >(byte & 0x7f) << shift;
+
+            if (!(byte & 0x80)) break;
+         }
+      }
+
+      const uint32_t delta = (zigzag >> 1) ^ (0u - (zigzag & 1));
+      const U previous = i >= stride ? static_cast< U >(values[i - stride]) : U(0);
+
+      values[i] = static_cast< T >(static_cast< U >(previous + static_cast< U >(delta)));
+   }
+
+   return pCur == pEnd;
+}
+
+// normalizes the symbol counts to frequencies that sum to PROB_SCALE,
+// keeping every symbol that occurs at a frequency of at least 1
+void NormalizeFrequencies( const uint32_t (& counts)[256], const size_t total, uint32_t (& freqs)[256] )
+{
+   uint32_t sum = 0;
+
+   for (size_t s = 0; s < 256; ++s)
+   {
+      freqs[s] = counts[s] ?
+                 std::max(1u, static_cast< uint32_t >(static_cast< uint64_t >(counts[s]) * PROB_SCALE / total)) :
+                 0;
+
+      sum += freqs[s];
+   }
+
+   // the rounding leaves the sum short, or over if many symbols were raised to 1...
+   // the difference is taken from or given to the most frequent symbols
+   while (sum != PROB_SCALE)
+   {
+      const size_t largest = std::max_element(std::begin(freqs), std::end(freqs)) - std::begin(freqs);
+
+      if (sum < PROB_SCALE)
+      {
+         freqs[largest] += PROB_SCALE - sum;
+         sum = PROB_SCALE;
+      }
+      else
+      {
+         const uint32_t taken = std::min(sum - PROB_SCALE, freqs[largest] / 2);
+
+         freqs[largest] -= taken;
+         sum -= taken;
+      }
+   }
+}
+
+// appends the entropy coded bytes, preceded by their count and frequencies
+void EntropyEncode( const std::vector< uint8_t > & bytes, std::vector< uint8_t > & encoded )
+{
+   uint32_t counts[256] = { };
+
+   for (const uint8_t byte : bytes) ++counts[byte];
+
+   uint32_t freqs[256] = { };
+   uint32_t starts[256] = { };
+
+   if (!bytes.empty())
+   {
+      NormalizeFrequencies(counts, bytes.size(), freqs);
+   }
+
+   uint16_t num_symbols = 0;
+
+   for (size_t s = 0, start = 0; s < 256; start += freqs[s++])
+   {
+      starts[s] = static_cast< uint32_t >(start);
+
+      if (freqs[s]) ++num_symbols;
+   }
+
+   Write(encoded, static_cast< uint32_t >(bytes.size()));
+   Write(encoded, num_symbols);
+
+   for (size_t s = 0; s < 256; ++s)
+   {
+      if (freqs[s])
+      {
+         Write(encoded, static_cast< uint8_t >(s));
+         Write(encoded, static_cast< uint16_t >(freqs[s]));
+      }
+   }
+
+   // rans decodes in the reverse order it encodes, so the bytes are encoded
+   // back to front and the output is reversed at the end.  the even and odd
+   // bytes go to separate states so the decoder can overlap their latencies.
+   std::vector< uint8_t > coded;
+   coded.reserve(bytes.size() / 2 + 16);
+
+   uint32_t states[2] = { RANS_L, RANS_L };
+
+   for (size_t i = bytes.size(); i--; )
+   {
+      uint32_t & state = states[i & 1];
+
+      const uint32_t freq = freqs[bytes[i]];
+      const uint32_t state_max = ((RANS_L >> PROB_BITS) << 8) * freq;
+
+      while (state >= state_max)
+      {
+         coded.push_back(static_cast< uint8_t >(state));
+         state >>= 8;
+      }
+
+      state = ((state / freq) << PROB_BITS) + (state % freq) + starts[bytes[i]];
+   }
+
+   for (size_t s = 2; s--; )
+   {
+      for (uint32_t shift = 32; shift; ) coded.push_back(static_cast< uint8_t >(states[s] >> (shift -= 8)));
+   }
+
+   std::reverse(coded.begin(), coded.end());
+
+   Write(encoded, static_cast< uint32_t >(coded.size()));
+
+   encoded.insert(encoded.end(), coded.cbegin(), coded.cend());
+}
+
+// decodes at most max_bytes, failing on streams that claim more
+bool EntropyDecode( Reader & reader, const size_t max_bytes, std::vector< uint8_t > & bytes )
+{
+   uint32_t num_bytes = 0;
+   uint16_t num_symbols = 0;
+
+   if (!reader.Read(num_bytes) || num_bytes > max_bytes ||
+       !reader.Read(num_symbols) || num_symbols > 256)
+   {
+      return false;
+   }
+
+   uint32_t freqs[256] = { };
+   uint32_t starts[256] = { };
+   uint32_t sum = 0;
+
+   for (uint16_t i = 0; i < num_symbols; ++i)
+   {
+      uint8_t symbol = 0;
+      uint16_t freq = 0;
+
+      if (!reader.Read(symbol) || !reader.Read(freq) || freqs[symbol]) return false;
+
+      freqs[symbol] = freq;
+   }
+
+   for (size_t s = 0; s < 256; sum += freqs[s++]) starts[s] = sum;
+
+   uint32_t coded_size = 0;
+
+   if (!reader.Read(coded_size)) return false;
+
+   const uint8_t * pCoded = reader.Skip(coded_size);
+
+   if (!pCoded || (num_bytes && (sum != PROB_SCALE || coded_size < 8))) return false;
+
+   bytes.resize(num_bytes);
+
+   if (!num_bytes) return true;
+
+   // the symbol, frequency, and offset into the frequency of each slot...
+   // one lookup per byte in place of three dependent ones
+   struct Slot
+   {
+      uint16_t freq;
+      uint16_t bias;
+      uint8_t  symbol;
+   };
+
+   Slot slots[PROB_SCALE];
+
+   for (size_t s = 0; s < 256; ++s)
+   {
+      for (uint32_t slot = starts[s]; slot < starts[s] + freqs[s]; ++slot)
+      {
+         slots[slot].freq = static_cast< uint16_t >(freqs[s]);
+         slots[slot].bias = static_cast< uint16_t >(slot - starts[s]);
+         slots[slot].symbol = static_cast< uint8_t >(s);
+      }
+   }
+
+   const uint8_t * const pCodedEnd = pCoded + coded_size;
+
+   uint32_t states[2] = { };
+   std::memcpy(states, pCoded, sizeof(states));
+   pCoded += sizeof(states);
+
+   const auto Decode = [ & ] ( uint32_t & state ) -> uint8_t
+   {
+      const Slot & slot = slots[state & (PROB_SCALE - 1)];
+
+      state = slot.freq * (state >> PROB_BITS) + slot.bias;
+
+      while (state < RANS_L && pCoded != pCodedEnd)
+      {
+         state = (state << 8) | *pCoded++;
+      }
+
+      return slot.symbol;
+   };
+
+   for (uint32_t i = 0; i + 1 < num_bytes; i += 2)
+   {
+      bytes[i + 0] = Decode(states[0]);
+      bytes[i + 1] = Decode(states[1]);
+   }
+
+   if (num_bytes & 1) bytes[num_bytes - 1] = Decode(states[0]);
+
+   // a truncated or corrupt stream leaves the states short of where they started
+   return pCoded == pCodedEnd && states[0] == RANS_L && states[1] == RANS_L;
+}
+
+// delta and entropy codes an attribute, preceded by its element count
+template < typename T >
+void CompressStream( const std::vector< T > & values, const size_t stride,
+                     std::vector< uint8_t > & scratch, std::vector< uint8_t > & compressed )
+{
+   Write(compressed, static_cast< uint32_t >(values.size()));
+
+   DeltaEncode(values, stride, scratch);
+   EntropyEncode(scratch, compressed);
+}
+
+template < typename T >
+bool DecompressStream( Reader & reader, const size_t stride,
+                       std::vector< uint8_t > & scratch, std::vector< T > & values )
+{
+   uint32_t count = 0;
+
+   return reader.Read(count) &&
+          EntropyDecode(reader, std::min< size_t >(count, MAX_STREAM_BYTES / MAX_VARINT_BYTES) * MAX_VARINT_BYTES, scratch) &&
+          DeltaDecode(scratch, count, stride, values);
+}
+
+} // namespace details
+
+uint16_t FloatToHalf( const float value )
+{
+   // float_to_half_fast3_rtne (giesen)
+   const uint32_t F32_INFINITY = 255u << 23;
+   const uint32_t F16_MAX = (127u + 16u) << 23;
+   const uint32_t DENORM_MAGIC = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+   uint32_t bits = details::BitsOf(value);
+
+   const uint32_t sign = bits & 0x80000000u;
+   bits ^= sign;
+
+   uint16_t half = 0;
+
+   if (bits >= F16_MAX)
+   {
+      // nan stays nan and everything else becomes infinity
+      half = bits > F32_INFINITY ? 0x7e00 : 0x7c00;
+   }
+   else if (bits < (113u << 23))
+   {
+      // denormals are rounded by the fpu when added to the magic number
+      half = static_cast< uint16_t >(details::BitsOf(details::FloatOf(bits) + details::FloatOf(DENORM_MAGIC)) - DENORM_MAGIC);
+   }
+   else
+   {
+      const uint32_t mantissa_odd = (bits >> 13) & 1;
+
+      bits += (static_cast< uint32_t >(15 - 127) << 23) + 0xfff;
+      bits += mantissa_odd;
+
+      half = static_cast< uint16_t >(bits >> 13);
+   }
+
+   return static_cast< uint16_t >(half | (sign >> 16));
+}
+
+float HalfToFloat( const uint16_t value )
+{
+   const uint32_t SHIFTED_EXPONENT = 0x7c00u << 13;
+   const uint32_t MAGIC = 113u << 23;
+
+   uint32_t bits = (value & 0x7fffu) << 13;
+
+   const uint32_t exponent = bits & SHIFTED_EXPONENT;
+
+   bits += (127u - 15u) << 23;
+
+   if (exponent == SHIFTED_EXPONENT)
+   {
+      // infinity and nan
+      bits += (128u - 16u) << 23;
+   }
+   else if (!exponent)
+   {
+      // zero and denormals are renormalized by the fpu
+      bits += 1u << 23;
+      bits = details::BitsOf(details::FloatOf(bits) - details::FloatOf(MAGIC));
+   }
+
+   return details::FloatOf(bits | (static_cast< uint32_t >(value & 0x8000u) << 16));
+}
+
+void EncodeOctahedral( const Vec3f & vec, int16_t (& oct)[2] )
+{
+   const float l1 = std::abs(vec.X()) + std::abs(vec.Y()) + std::abs(vec.Z());
+
+   if (l1 <= 0.0f)
+   {
+      oct[0] = oct[1] = 0;
+
+      return;
+   }
+
+   float x = vec.X() / l1;
+   float y = vec.Y() / l1;
+
+   // the lower hemisphere is folded over the diagonals
+   if (vec.Z() < 0.0f)
+   {
+      const float folded_x = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+      const float folded_y = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+
+      x = folded_x;
+      y = folded_y;
+   }
+
+   oct[0] = details::QuantizeSnorm(x);
+   oct[1] = details::QuantizeSnorm(y);
+}
+
+Vec3f DecodeOctahedral( const int16_t (& oct)[2] )
+{
+   float x = oct[0] * (1.0f / details::SNORM16_MAX);
+   float y = oct[1] * (1.0f / details::SNORM16_MAX);
+
+   const float z = 1.0f - std::abs(x) - std::abs(y);
+
+   // unfolds the lower hemisphere without branching on the quadrant
+   const float t = std::max(-z, 0.0f);
+
+   x += x >= 0.0f ? -t : t;
+   y += y >= 0.0f ? -t : t;
+
+   const float scale = 1.0f / std::sqrt(x * x + y * y + z * z);
+
+   return Vec3f(x * scale, y * scale, z * scale);
+}
+
+QuantizedShape Quantize( const GeomHelper::Shape & shape )
+{
+   QuantizedShape quantized;
+
+   quantized.geom_type = shape.geom_type;
+   quantized.index_type = shape.vertices.size() <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+   if (quantized.index_type == GL_UNSIGNED_SHORT)
+   {
+      quantized.indices16.assign(shape.indices.cbegin(), shape.indices.cend());
+   }
+   else
+   {
+      quantized.indices32 = shape.indices;
+   }
+
+   // the positions are stored relative to the center of the bounding box
+   Vec3f min(std::numeric_limits< float >::max());
+   Vec3f max(std::numeric_limits< float >::lowest());
+
+   for (const Vec3f & vertex : shape.vertices)
+   {
+      for (size_t axis = 0; axis < 3; ++axis)
+      {
+         min[axis] = std::min(min[axis], vertex[axis]);
+         max[axis] = std::max(max[axis], vertex[axis]);
+      }
+   }
+
+   Vec3f inverse_scale(0.0f);
+
+   quantized.position_offset = Vec3f(0.0f);
+   quantized.position_scale = Vec3f(0.0f);
+
+   if (!shape.vertices.empty())
+   {
+      for (size_t axis = 0; axis < 3; ++axis)
+      {
+         const float half_extent = (max[axis] - min[axis]) * 0.5f;
+
+         quantized.position_offset[axis] = (max[axis] + min[axis]) * 0.5f;
+         quantized.position_scale[axis] = half_extent / details::SNORM16_MAX;
+
+         if (half_extent > 0.0f) inverse_scale[axis] = 1.0f / half_extent;
+      }
+   }
+
+   quantized.vertices.resize(shape.vertices.size() * 3);
+
+   for (size_t i = 0; i < shape.vertices.size(); ++i)
+   {
+      for (size_t axis = 0; axis < 3; ++axis)
+      {
+         quantized.vertices[i * 3 + axis] =
+            details::QuantizeSnorm((shape.vertices[i][axis] - quantized.position_offset[axis]) * inverse_scale[axis]);
+      }
+   }
+
+   quantized.tex_coords.resize(shape.tex_coords.size() * 2);
+
+   for (size_t i = 0; i < shape.tex_coords.size(); ++i)
+   {
+      quantized.tex_coords[i * 2 + 0] = FloatToHalf(shape.tex_coords[i].X());
+      quantized.tex_coords[i * 2 + 1] = FloatToHalf(shape.tex_coords[i].Y());
+   }
+
+   details::EncodeOctahedral(shape.normals, quantized.normals);
+   details::EncodeOctahedral(shape.tangents, quantized.tangents);
+   details::EncodeOctahedral(shape.bitangents, quantized.bitangents);
+
+   return quantized;
+}
+
+GeomHelper::Shape Dequantize( const QuantizedShape & shape )
+{
+   GeomHelper::Shape dequantized;
+
+   dequantized.geom_type = shape.geom_type;
+
+   if (shape.index_type == GL_UNSIGNED_SHORT)
+   {
+      dequantized.indices.assign(shape.indices16.cbegin(), shape.indices16.cend());
+   }
+   else
+   {
+      dequantized.indices = shape.indices32;
+   }
+
+   dequantized.vertices.resize(shape.vertices.size() / 3);
+
+   const float offset_x = shape.position_offset.X(), scale_x = shape.position_scale.X();
+   const float offset_y = shape.position_offset.Y(), scale_y = shape.position_scale.Y();
+   const float offset_z = shape.position_offset.Z(), scale_z = shape.position_scale.Z();
+
+   for (size_t i = 0; i < dequantized.vertices.size(); ++i)
+   {
+      const int16_t * const pVertex = &shape.vertices[i * 3];
+
+      dequantized.vertices[i] = Vec3f(offset_x + pVertex[0] * scale_x,
+                                      offset_y + pVertex[1] * scale_y,
+                                      offset_z + pVertex[2] * scale_z);
+   }
+
+   dequantized.tex_coords.resize(shape.tex_coords.size() / 2);
+
+   for (size_t i = 0; i < dequantized.tex_coords.size(); ++i)
+   {
+      dequantized.tex_coords[i] = Vec2f(HalfToFloat(shape.tex_coords[i * 2 + 0]),
+                                        HalfToFloat(shape.tex_coords[i * 2 + 1]));
+   }
+
+   details::DecodeOctahedral(shape.normals, dequantized.normals);
+   details::DecodeOctahedral(shape.tangents, dequantized.tangents);
+   details::DecodeOctahedral(shape.bitangents, dequantized.bitangents);
+
+   return dequantized;
+}
+
+size_t QuantizedSize( const QuantizedShape & shape )
+{
+   return shape.indices16.size() * sizeof(uint16_t) +
+          shape.indices32.size() * sizeof(GLuint) +
+          shape.vertices.size() * sizeof(int16_t) +
+          shape.tex_coords.size() * sizeof(uint16_t) +
+          shape.normals.size() * sizeof(int16_t) +
+          shape.tangents.size() * sizeof(int16_t) +
+          shape.bitangents.size() * sizeof(int16_t);
+}
+
+std::vector< uint8_t > Compress( const QuantizedShape & shape )
+{
+   std::vector< uint8_t > compressed;
+   std::vector< uint8_t > scratch;
+
+   const uint32_t flags =
+      (shape.tex_coords.empty() ? 0 : details::HAS_TEX_COORDS) |
+      (shape.normals.empty() ? 0 : details::HAS_NORMALS) |
+      (shape.tangents.empty() ? 0 : details::HAS_TANGENTS) |
+      (shape.bitangents.empty() ? 0 : details::HAS_BITANGENTS);
+
+   details::Write(compressed, details::COMPRESSED_MAGIC);
+   details::Write(compressed, details::COMPRESSED_VERSION);
+   details::Write(compressed, static_cast< uint32_t >(shape.geom_type));
+   details::Write(compressed, static_cast< uint32_t >(shape.index_type));
+   details::Write(compressed, flags);
+
+   for (size_t axis = 0; axis < 3; ++axis) details::Write(compressed, shape.position_offset[axis]);
+   for (size_t axis = 0; axis < 3; ++axis) details::Write(compressed, shape.position_scale[axis]);
+
+   // indices are coded against the previous index, the attributes against
+   // the same component of the previous vertex
+   if (shape.index_type == GL_UNSIGNED_SHORT)
+   {
+      details::CompressStream(shape.indices16, 1, scratch, compressed);
+   }
+   else
+   {
+      details::CompressStream(shape.indices32, 1, scratch, compressed);
+   }
+
+   details::CompressStream(shape.vertices, 3, scratch, compressed);
+
+   if (flags & details::HAS_TEX_COORDS) details::CompressStream(shape.tex_coords, 2, scratch, compressed);
+   if (flags & details::HAS_NORMALS) details::CompressStream(shape.normals, 2, scratch, compressed);
+   if (flags & details::HAS_TANGENTS) details::CompressStream(shape.tangents, 2, scratch, compressed);
+   if (flags & details::HAS_BITANGENTS) details::CompressStream(shape.bitangents, 2, scratch, compressed);
+
+   return compressed;
+}
+
+bool Decompress( const uint8_t * const pData,
+                 const size_t size,
+                 QuantizedShape & shape )
+{
+   details::Reader reader(pData, pData + size);
+
+   uint32_t magic = 0, version = 0, geom_type = 0, index_type = 0, flags = 0;
+
+   if (!reader.Read(magic) || magic != details::COMPRESSED_MAGIC ||
+       !reader.Read(version) || version != details::COMPRESSED_VERSION ||
+       !reader.Read(geom_type) || !reader.Read(index_type) || !reader.Read(flags))
+   {
+      return false;
+   }
+
+   if (index_type != GL_UNSIGNED_SHORT && index_type != GL_UNSIGNED_INT) return false;
+
+   QuantizedShape decompressed;
+
+   decompressed.geom_type = geom_type;
+   decompressed.index_type = index_type;
+
+   for (size_t axis = 0; axis < 3; ++axis) if (!reader.Read(decompressed.position_offset[axis])) return false;
+   for (size_t axis = 0; axis < 3; ++axis) if (!reader.Read(decompressed.position_scale[axis])) return false;
+
+   std::vector< uint8_t > scratch;
+
+   const bool indices_read = index_type == GL_UNSIGNED_SHORT ?
+                             details::DecompressStream(reader, 1, scratch, decompressed.indices16) :
+                             details::DecompressStream(reader, 1, scratch, decompressed.indices32);
+
+   if (!indices_read ||
+       !details::DecompressStream(reader, 3, scratch, decompressed.vertices) ||
+       ((flags & details::HAS_TEX_COORDS) && !details::DecompressStream(reader, 2, scratch, decompressed.tex_coords)) ||
+       ((flags & details::HAS_NORMALS) && !details::DecompressStream(reader, 2, scratch, decompressed.normals)) ||
+       ((flags & details::HAS_TANGENTS) && !details::DecompressStream(reader, 2, scratch, decompressed.tangents)) ||
+       ((flags & details::HAS_BITANGENTS) && !details::DecompressStream(reader, 2, scratch, decompressed.bitangents)) ||
+       reader.Remaining())
+   {
+      return false;
+   }
+
+   shape = std::move(decompressed);
+
+   return true;
+}
+
+} // namespace MeshCodec
@@ -0,0 +1,75 @@
+#ifndef _MESH_CODEC_H_
+#define _MESH_CODEC_H_
+
+// local includes
+#include "Vector.h"
+#include "GeomHelper.h"
+
+// std includes
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// compact encodings of shapes.  quantizing packs the vertex attributes into
+// 16 bit integers and halfs that the gpu can read as is, and compressing
+// adds a lossless delta and entropy coder on top for storage on disk.
+namespace MeshCodec
+{
+
+// a shape with its attributes quantized.  every attribute other than the
+// indices takes the same number of bytes per vertex as the gpu reads it.
+struct QuantizedShape
+{
+   GLenum                     geom_type;
+   // GL_UNSIGNED_SHORT when every vertex can be indexed with 16 bits,
+   // GL_UNSIGNED_INT otherwise.  only the matching indices are filled.
+   GLenum                     index_type;
+   std::vector< uint16_t >    indices16;
+   std::vector< GLuint >      indices32;
+   // 3 snorm16 per vertex relative to the bounding box...
+   // vertex = position_offset + snorm16 * position_scale, per component
+   Vec3f                      position_offset;
+   Vec3f                      position_scale;
+   std::vector< int16_t >     vertices;
+   // 2 halfs per vertex
+   std::vector< uint16_t >    tex_coords;
+   // 2 snorm16 per vertex of the octahedral projection of the unit vector
+   std::vector< int16_t >     normals;
+   std::vector< int16_t >     tangents;
+   std::vector< int16_t >     bitangents;
+};
+
+// converts between floats and halfs, rounding to the nearest even
+uint16_t FloatToHalf( const float value );
+float HalfToFloat( const uint16_t value );
+
+// converts between unit vectors and their octahedral projection in snorm16...
+// the error is under 1e-4 radians.  zero vectors decode as +z.
+void EncodeOctahedral( const Vec3f & vec, int16_t (& oct)[2] );
+Vec3f DecodeOctahedral( const int16_t (& oct)[2] );
+
+// quantizes the shape.  the positions keep 16 bits of precision across the
+// bounding box, the normals, tangents and bitangents are renormalized.
+QuantizedShape Quantize( const GeomHelper::Shape & shape );
+
+// expands the quantized shape back into floats
+GeomHelper::Shape Dequantize( const QuantizedShape & shape );
+
+// number of bytes the quantized shape takes in memory
+size_t QuantizedSize( const QuantizedShape & shape );
+
+// losslessly compresses a quantized shape for storage.  every attribute is
+// delta coded against the previous vertex and entropy coded, so shapes that
+// went through MeshOptimizer::Optimize compress the best.
+std::vector< uint8_t > Compress( const QuantizedShape & shape );
+
+// restores a quantized shape from the results of Compress.  returns false if
+// the data is truncated, corrupt, or is not a compressed shape.  the sizes
+// read from the data are checked before anything is allocated for them.
+bool Decompress( const uint8_t * const pData,
+                 const size_t size,
+                 QuantizedShape & shape );
+
+} // namespace MeshCodec
+
+#endif // _MESH_CODEC_H_
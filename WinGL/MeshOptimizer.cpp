@@ -0,0 +1,513 @@
+// local includes
+#include "MeshOptimizer.h"
+#include "WglAssert.h"
+
+// std includes
+#include <cmath>
+#include <limits>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+#include <unordered_map>
+
+namespace MeshOptimizer
+{
+
+namespace details
+{
+
+// marks a vertex that has not been assigned
+const GLuint INVALID_INDEX = std::numeric_limits< GLuint >::max();
+
+// gives a shape without indices one index per vertex
+void MakeIndexed( GeomHelper::Shape & shape )
+{
+   if (shape.indices.empty())
+   {
+      shape.indices.resize(shape.vertices.size());
+
+      std::iota(shape.indices.begin(), shape.indices.end(), GLuint(0));
+   }
+}
+
+// moves each vertex attribute to its new location...
+// attributes not provided for every vertex are left alone
+template < typename V >
+void RemapAttribute( std::vector< V > & attribute,
+                     const std::vector< GLuint > & remap,
+                     const size_t num_remapped )
+{
+   if (attribute.size() == remap.size())
+   {
+      std::vector< V > remapped(num_remapped);
+
+      for (size_t i = 0; i < remap.size(); ++i)
+      {
+         if (remap[i] != INVALID_INDEX) remapped[remap[i]] = attribute[i];
+      }
+
+      attribute.swap(remapped);
+   }
+}
+
+void RemapVertices( GeomHelper::Shape & shape,
+                    const std::vector< GLuint > & remap,
+                    const size_t num_remapped )
+{
+   RemapAttribute(shape.vertices, remap, num_remapped);
+   RemapAttribute(shape.tex_coords, remap, num_remapped);
+   RemapAttribute(shape.normals, remap, num_remapped);
+   RemapAttribute(shape.tangents, remap, num_remapped);
+   RemapAttribute(shape.bitangents, remap, num_remapped);
+}
+
+// determines if all the components are within epsilon
+template < typename T, uint32_t SIZE >
+bool Near( const Vector< T, SIZE > & a, const Vector< T, SIZE > & b, const T epsilon )
+{
+   for (uint32_t i = 0; i < SIZE; ++i)
+   {
+      if (!(std::abs(a.mT[i] - b.mT[i]) <= epsilon)) return false;
+   }
+
+   return true;
+}
+
+// determines if an attribute that may be missing is within epsilon
+template < typename V >
+bool NearAttribute( const std::vector< V > & attribute, const size_t num_vertices,
+                    const size_t a, const size_t b, const float epsilon )
+{
+   return attribute.size() != num_vertices || Near(attribute[a], attribute[b], epsilon);
+}
+
+// hashes the cell coordinates of a position...  the low bits of the
+// coordinates are often all zero, so they are mixed throughout the key
+// (splitmix64 finalizer)
+inline uint64_t CellKey( const int64_t x, const int64_t y, const int64_t z )
+{
+   uint64_t key = (static_cast< uint64_t >(x) * 73856093u) ^
+                  (static_cast< uint64_t >(y) * 19349663u) ^
+                  (static_cast< uint64_t >(z) * 0x9e3779b97f4a7c15ull);
+
+   key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ull;
+   key = (key ^ (key >> 27)) * 0x94d049bb133111ebull;
+
+   return key ^ (key >> 31);
+}
+
+// bits of a coordinate, with -0 and 0 made the same
+inline int64_t CoordinateBits( const float coordinate )
+{
+   const float normalized = coordinate + 0.0f;
+
+   uint32_t bits = 0;
+   std::memcpy(&bits, &normalized, sizeof(bits));
+
+   return bits;
+}
+
+} // namespace details
+
+VertexCacheStats AnalyzeVertexCache( const std::vector< GLuint > & indices,
+                                     const size_t num_vertices,
+                                     const uint32_t cache_size )
+{
+   VertexCacheStats stats = { 0, indices.size() / 3, 0.0, 0.0 };
+
+   // miss count at which each vertex last entered the cache...
+   // a vertex is evicted once cache_size other vertices have entered
+   std::vector< size_t > entered(num_vertices, 0);
+
+   size_t misses = 0;
+
+   for (const GLuint index : indices)
+   {
+      WGL_ASSERT(index < num_vertices);
+
+      if (!entered[index] || misses - entered[index] >= cache_size)
+      {
+         if (!entered[index]) ++stats.vertices;
+
+         entered[index] = ++misses;
+      }
+   }
+
+   if (stats.triangles) stats.acmr = static_cast< double >(misses) / stats.triangles;
+   if (stats.vertices) stats.atvr = static_cast< double >(misses) / stats.vertices;
+
+   return stats;
+}
+
+size_t WeldVertices( GeomHelper::Shape & shape, const float epsilon )
+{
+   details::MakeIndexed(shape);
+
+   const size_t num_vertices = shape.vertices.size();
+
+   // vertices are merged only if every attribute matches
+   const auto Matches = [ & ] ( const size_t a, const size_t b )
+   {
+      return details::Near(shape.vertices[a], shape.vertices[b], epsilon) &&
+             details::NearAttribute(shape.tex_coords, num_vertices, a, b, epsilon) &&
+             details::NearAttribute(shape.normals, num_vertices, a, b, epsilon) &&
+             details::NearAttribute(shape.tangents, num_vertices, a, b, epsilon) &&
+             details::NearAttribute(shape.bitangents, num_vertices, a, b, epsilon);
+   };
+
+   // the kept vertices are chained by the cells of their positions.  with
+   // an epsilon the cells are epsilon wide and a vertex looks through the
+   // neighboring cells as well, without one the cell is the exact position.
+   std::unordered_map< uint64_t, GLuint > cells;
+   std::vector< GLuint > next_in_cell(num_vertices, details::INVALID_INDEX);
+
+   cells.reserve(num_vertices);
+
+   // new index of each vertex
+   std::vector< GLuint > remap(num_vertices, details::INVALID_INDEX);
+   GLuint num_kept = 0;
+
+   for (size_t i = 0; i < num_vertices; ++i)
+   {
+      const Vec3f & position = shape.vertices[i];
+
+      int64_t cell[3] = { };
+
+      for (uint32_t axis = 0; axis < 3; ++axis)
+      {
+         cell[axis] = epsilon > 0.0f ?
+                      static_cast< int64_t >(std::floor(position.mT[axis] / epsilon)) :
+                      details::CoordinateBits(position.mT[axis]);
+      }
+
+      const int64_t reach = epsilon > 0.0f ? 1 : 0;
+
+      for (int64_t x = -reach; x <= reach && remap[i] == details::INVALID_INDEX; ++x)
+      {
+         for (int64_t y = -reach; y <= reach && remap[i] == details::INVALID_INDEX; ++y)
+         {
+            for (int64_t z = -reach; z <= reach && remap[i] == details::INVALID_INDEX; ++z)
+            {
+               const auto found = cells.find(details::CellKey(cell[0] + x, cell[1] + y, cell[2] + z));
+
+               if (found == cells.cend()) continue;
+
+               for (GLuint kept = found->second; kept != details::INVALID_INDEX; kept = next_in_cell[kept])
+               {
+                  if (Matches(kept, i))
+                  {
+                     remap[i] = remap[kept];
+
+                     break;
+                  }
+               }
+            }
+         }
+      }
+
+      if (remap[i] == details::INVALID_INDEX)
+      {
+         // keep the vertex and add it to its cell
+         auto & head = cells.emplace(details::CellKey(cell[0], cell[1], cell[2]), details::INVALID_INDEX).first->second;
+
+         next_in_cell[i] = head;
+         head = static_cast< GLuint >(i);
+
+         remap[i] = num_kept++;
+      }
+   }
+
+   // point the indices at the kept vertices and drop the collapsed triangles
+   size_t num_indices = 0;
+
+   for (size_t i = 0; i + 2 < shape.indices.size(); i += 3)
+   {
+      const GLuint i0 = remap[shape.indices[i + 0]];
+      const GLuint i1 = remap[shape.indices[i + 1]];
+      const GLuint i2 = remap[shape.indices[i + 2]];
+
+      if (i0 != i1 && i1 != i2 && i2 != i0)
+      {
+         shape.indices[num_indices++] = i0;
+         shape.indices[num_indices++] = i1;
+         shape.indices[num_indices++] = i2;
+      }
+   }
+
+   shape.indices.resize(num_indices);
+
+   // only the first vertex of each merged group moves
+   for (size_t i = 0, next = 0; i < num_vertices; ++i)
+   {
+      if (remap[i] == next) ++next;
+      else remap[i] = details::INVALID_INDEX;
+   }
+
+   details::RemapVertices(shape, remap, num_kept);
+
+   return num_vertices - num_kept;
+}
+
+void OptimizeVertexCache( std::vector< GLuint > & indices,
+                          const size_t num_vertices,
+                          const uint32_t cache_size,
+                          std::vector< size_t > * const pClusters )
+{
+   // indices must align to make triangles
+   WGL_ASSERT(indices.size() % 3 == 0);
+
+   if (pClusters) pClusters->clear();
+
+   if (indices.empty()) return;
+
+   const GeomHelper::VertexAdjacency adjacency = GeomHelper::ConstructVertexAdjacency(indices, num_vertices);
+
+   // number of triangles not yet emitted around each vertex
+   std::vector< uint32_t > live(num_vertices);
+
+   for (size_t v = 0; v < num_vertices; ++v)
+   {
+      live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+   }
+
+   // time each vertex last entered the cache, zero is never
+   std::vector< uint32_t > cache_time(num_vertices, 0);
+   uint32_t time = cache_size + 1;
+
+   std::vector< bool > emitted(indices.size() / 3, false);
+
+   // recently referenced vertices to fall back to at a dead end
+   std::vector< GLuint > dead_ends;
+   // vertices of the last fan, one of which is fanned next
+   std::vector< GLuint > candidates;
+   // first vertex that may have live triangles, when all else fails
+   size_t cursor = 0;
+
+   const auto SkipDeadEnd = [ & ] ( ) -> GLuint
+   {
+      while (!dead_ends.empty())
+      {
+         const GLuint vertex = dead_ends.back();
+         dead_ends.pop_back();
+
+         if (live[vertex]) return vertex;
+      }
+
+      for (; cursor < num_vertices; ++cursor)
+      {
+         if (live[cursor]) return static_cast< GLuint >(cursor);
+      }
+
+      return details::INVALID_INDEX;
+   };
+
+   std::vector< GLuint > reordered;
+   reordered.reserve(indices.size());
+
+   GLuint fan = SkipDeadEnd();
+   bool cold_cache = true;
+
+   while (fan != details::INVALID_INDEX)
+   {
+      // a cluster starts wherever the cache has nothing useful in it
+      if (cold_cache && pClusters) pClusters->push_back(reordered.size());
+
+      candidates.clear();
+
+      // emit all the remaining triangles around the fanning vertex
+      for (uint32_t a = adjacency.offsets[fan]; a < adjacency.offsets[fan + 1]; ++a)
+      {
+         const uint32_t triangle = adjacency.triangles[a];
+
+         if (emitted[triangle]) continue;
+
+         for (uint32_t corner = 0; corner < 3; ++corner)
+         {
+            const GLuint vertex = indices[triangle * 3 + corner];
+
+            reordered.push_back(vertex);
+            dead_ends.push_back(vertex);
+            candidates.push_back(vertex);
+
+            --live[vertex];
+
+            if (time - cache_time[vertex] > cache_size) cache_time[vertex] = time++;
+         }
+
+         emitted[triangle] = true;
+      }
+
+      // fan the candidate that will be in the cache the longest once its
+      // own triangles are emitted, or any candidate with live triangles
+      GLuint next = details::INVALID_INDEX;
+      int64_t best_priority = -1;
+
+      for (const GLuint vertex : candidates)
+      {
+         if (!live[vertex]) continue;
+
+         int64_t priority = 0;
+
+         if (time - cache_time[vertex] + 2 * live[vertex] <= cache_size)
+         {
+            priority = time - cache_time[vertex];
+         }
+
+         if (priority > best_priority)
+         {
+            best_priority = priority;
+            next = vertex;
+         }
+      }
+
+      cold_cache = false;
+
+      if (next == details::INVALID_INDEX)
+      {
+         next = SkipDeadEnd();
+
+         cold_cache = next != details::INVALID_INDEX && time - cache_time[next] > cache_size;
+      }
+
+      fan = next;
+   }
+
+   WGL_ASSERT(reordered.size() == indices.size());
+
+   indices.swap(reordered);
+}
+
+void OptimizeOverdraw( std::vector< GLuint > & indices,
+                       const std::vector< Vec3f > & vertices,
+                       const std::vector< size_t > & clusters )
+{
+   if (clusters.size() < 2) return;
+
+   struct Cluster
+   {
+      size_t   begin;
+      size_t   end;
+      Vec3f    centroid;
+      Vec3f    normal;
+      float    area;
+      float    sort_key;
+   };
+
+   std::vector< Cluster > sorted(clusters.size());
+
+   Vec3f mesh_centroid(0.0f, 0.0f, 0.0f);
+   float mesh_area = 0.0f;
+
+   // area weighted centroid and normal of each cluster
+   for (size_t c = 0; c < clusters.size(); ++c)
+   {
+      Cluster & cluster = sorted[c];
+
+      cluster.begin = clusters[c];
+      cluster.end = c + 1 < clusters.size() ? clusters[c + 1] : indices.size();
+      cluster.centroid = Vec3f(0.0f, 0.0f, 0.0f);
+      cluster.normal = Vec3f(0.0f, 0.0f, 0.0f);
+      cluster.area = 0.0f;
+
+      for (size_t i = cluster.begin; i < cluster.end; i += 3)
+      {
+         const Vec3f & p0 = vertices[indices[i + 0]];
+         const Vec3f & p1 = vertices[indices[i + 1]];
+         const Vec3f & p2 = vertices[indices[i + 2]];
+
+         // twice the area in the direction of the face
+         const Vec3f n = (p1 - p0) ^ (p2 - p0);
+         const float area = n.Length();
+
+         cluster.centroid += (p0 + p1 + p2) * (area / 3.0f);
+         cluster.normal += n;
+         cluster.area += area;
+      }
+
+      mesh_centroid += cluster.centroid;
+      mesh_area += cluster.area;
+   }
+
+   if (mesh_area > 0.0f) mesh_centroid *= 1.0f / mesh_area;
+
+   // clusters far out along their own normal are likely to be in front
+   // of the rest of the mesh from any view, so they are drawn first
+   for (Cluster & cluster : sorted)
+   {
+      cluster.sort_key = 0.0f;
+
+      if (cluster.area > 0.0f)
+      {
+         const Vec3f centroid = cluster.centroid * (1.0f / cluster.area);
+         const float normal_length = cluster.normal.Length();
+
+         if (normal_length > 0.0f)
+         {
+            cluster.sort_key = ((centroid - mesh_centroid) * cluster.normal) / normal_length;
+         }
+      }
+   }
+
+   std::stable_sort(sorted.begin(), sorted.end(),
+   [ ] ( const Cluster & a, const Cluster & b )
+   {
+      return a.sort_key > b.sort_key;
+   });
+
+   std::vector< GLuint > reordered;
+   reordered.reserve(indices.size());
+
+   for (const Cluster & cluster : sorted)
+   {
+      reordered.insert(reordered.end(), indices.cbegin() + cluster.begin, indices.cbegin() + cluster.end);
+   }
+
+   indices.swap(reordered);
+}
+
+void OptimizeVertexFetch( GeomHelper::Shape & shape )
+{
+   details::MakeIndexed(shape);
+
+   std::vector< GLuint > remap(shape.vertices.size(), details::INVALID_INDEX);
+   GLuint num_referenced = 0;
+
+   for (GLuint & index : shape.indices)
+   {
+      if (remap[index] == details::INVALID_INDEX) remap[index] = num_referenced++;
+
+      index = remap[index];
+   }
+
+   details::RemapVertices(shape, remap, num_referenced);
+}
+
+OptimizeStats Optimize( GeomHelper::Shape & shape,
+                        const float weld_epsilon,
+                        const uint32_t cache_size )
+{
+   OptimizeStats stats = { };
+
+   // only triangle lists can be reordered freely
+   if (shape.geom_type != GL_TRIANGLES || shape.vertices.empty()) return stats;
+
+   details::MakeIndexed(shape);
+
+   const size_t num_triangles = shape.indices.size() / 3;
+
+   stats.before = AnalyzeVertexCache(shape.indices, shape.vertices.size(), cache_size);
+
+   stats.welded_vertices = WeldVertices(shape, weld_epsilon);
+   stats.degenerate_triangles = num_triangles - shape.indices.size() / 3;
+
+   std::vector< size_t > clusters;
+   OptimizeVertexCache(shape.indices, shape.vertices.size(), cache_size, &clusters);
+   OptimizeOverdraw(shape.indices, shape.vertices, clusters);
+   OptimizeVertexFetch(shape);
+
+   stats.after = AnalyzeVertexCache(shape.indices, shape.vertices.size(), cache_size);
+
+   return stats;
+}
+
+} // namespace MeshOptimizer
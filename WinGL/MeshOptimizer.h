@@ -0,0 +1,86 @@
+#ifndef _MESH_OPTIMIZER_H_
+#define _MESH_OPTIMIZER_H_
+
+// local includes
+#include "Vector.h"
+#include "GeomHelper.h"
+
+// std includes
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// passes that reorder and weld indexed triangle lists for the gpu.  they
+// only change the order and the sharing of the vertices and triangles,
+// never what is drawn, and are cheap enough to run as shapes are loaded.
+namespace MeshOptimizer
+{
+
+// number of entries in the simulated post transform vertex cache...
+// a fifo of this size is a fair model of current hardware
+const uint32_t VERTEX_CACHE_SIZE = 16;
+
+// post transform vertex cache efficiency of a triangle list
+struct VertexCacheStats
+{
+   // number of distinct vertices referenced by the indices
+   size_t   vertices;
+   size_t   triangles;
+   // average cache miss ratio, vertices transformed per triangle...
+   // 3 is the worst case, 0.5 is the limit for large regular meshes
+   double   acmr;
+   // average transform to vertex ratio, vertices transformed per vertex...
+   // 1 means every vertex is transformed exactly once
+   double   atvr;
+};
+
+// results of Optimize
+struct OptimizeStats
+{
+   VertexCacheStats  before;
+   VertexCacheStats  after;
+   // vertices merged into others while welding
+   size_t            welded_vertices;
+   // triangles removed because welding collapsed them
+   size_t            degenerate_triangles;
+};
+
+// runs a fifo vertex cache of cache_size entries over the triangle list
+VertexCacheStats AnalyzeVertexCache( const std::vector< GLuint > & indices,
+                                     const size_t num_vertices,
+                                     const uint32_t cache_size = VERTEX_CACHE_SIZE );
+
+// merges vertices whose attributes all lie within epsilon of each other
+// and removes the triangles that collapse.  a shape without indices is
+// given one index per vertex first.  returns the number of vertices merged.
+size_t WeldVertices( GeomHelper::Shape & shape, const float epsilon = 0.0f );
+
+// reorders the triangles for the post transform vertex cache (tipsify,
+// sander et al. 2007).  the offsets of the first index of each cluster
+// that starts with a cold cache are written to pClusters if requested.
+void OptimizeVertexCache( std::vector< GLuint > & indices,
+                          const size_t num_vertices,
+                          const uint32_t cache_size = VERTEX_CACHE_SIZE,
+                          std::vector< size_t > * const pClusters = nullptr );
+
+// reorders the clusters from OptimizeVertexCache so that clusters facing
+// away from the center of the mesh are drawn first and occlude the rest.
+// the triangles in each cluster keep their order, so the cache efficiency
+// is left alone.
+void OptimizeOverdraw( std::vector< GLuint > & indices,
+                       const std::vector< Vec3f > & vertices,
+                       const std::vector< size_t > & clusters );
+
+// renumbers the vertices in the order the indices first reference them,
+// so vertex fetches walk memory forward.  unreferenced vertices are removed.
+void OptimizeVertexFetch( GeomHelper::Shape & shape );
+
+// welds the vertices and runs the cache, overdraw, and fetch passes.
+// only triangle lists are optimized, other shapes are left as is.
+OptimizeStats Optimize( GeomHelper::Shape & shape,
+                        const float weld_epsilon = 0.0f,
+                        const uint32_t cache_size = VERTEX_CACHE_SIZE );
+
+} // namespace MeshOptimizer
+
+#endif // _MESH_OPTIMIZER_H_
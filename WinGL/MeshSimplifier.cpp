@@ -0,0 +1,648 @@
+// local includes
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "WglAssert.h"
+
+// std includes
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+
+namespace MeshSimplifier
+{
+
+namespace details
+{
+
+// marks a vertex or position that has not been assigned
+const GLuint INVALID_INDEX = std::numeric_limits< GLuint >::max();
+
+// weight of the planes that keep border and seam vertices on their edges,
+// relative to the planes of the faces
+const double SEAM_PLANE_WEIGHT = 10.0;
+
+// smallest cosine between the normals of a face before and after a
+// collapse...  collapses that turn a face further are rejected
+const double MIN_FACE_NORMAL_DOT = 0.25;
+
+// how a position may be collapsed
+enum VertexKind
+{
+   // a single vertex surrounded by faces, collapses into any neighbor
+   VERTEX_KIND_MANIFOLD,
+   // a single vertex on an open border, collapses along the border
+   VERTEX_KIND_BORDER,
+   // two vertices on a uv or normal seam, collapse together along the seam
+   VERTEX_KIND_SEAM,
+   // corners and anything more complex, never collapses
+   VERTEX_KIND_LOCKED
+};
+
+// sum of squared distances to a set of weighted planes
+struct Quadric
+{
+   double a2, b2, c2, d2;
+   double ab, ac, ad;
+   double bc, bd;
+   double cd;
+   double weight;
+};
+
+void AddPlane( Quadric & q, const Vec3d & n, const double d, const double weight )
+{
+   const double a = n.mT[0], b = n.mT[1], c = n.mT[2];
+
+   q.a2 += weight * a * a; q.b2 += weight * b * b; q.c2 += weight * c * c; q.d2 += weight * d * d;
+   q.ab += weight * a * b; q.ac += weight * a * c; q.ad += weight * a * d;
+   q.bc += weight * b * c; q.bd += weight * b * d;
+   q.cd += weight * c * d;
+   q.weight += weight;
+}
+
+void AddQuadric( Quadric & q, const Quadric & o )
+{
+   q.a2 += o.a2; q.b2 += o.b2; q.c2 += o.c2; q.d2 += o.d2;
+   q.ab += o.ab; q.ac += o.ac; q.ad += o.ad;
+   q.bc += o.bc; q.bd += o.bd;
+   q.cd += o.cd;
+   q.weight += o.weight;
+}
+
+// weighted mean squared distance of the point to the planes
+double Evaluate( const Quadric & q, const Vec3d & p )
+{
+   const double x = p.mT[0], y = p.mT[1], z = p.mT[2];
+
+   const double error =
+      q.a2 * x * x + q.b2 * y * y + q.c2 * z * z + q.d2 +
+      2.0 * (q.ab * x * y + q.ac * x * z + q.ad * x + q.bc * y * z + q.bd * y + q.cd * z);
+
+   return q.weight > 0.0 ? std::max(error, 0.0) / q.weight : 0.0;
+}
+
+// items grouped by a key in compressed sparse row form...
+// the items of key k are [offsets[k], offsets[k + 1])
+struct Groups
+{
+   std::vector< uint32_t > offsets;
+   std::vector< uint32_t > items;
+};
+
+// groups the item numbers [0, keys.size()) by their keys
+Groups GroupBy( const std::vector< GLuint > & keys, const size_t num_keys, const size_t item_divisor = 1 )
+{
+   Groups groups;
+   groups.offsets.assign(num_keys + 1, 0);
+   groups.items.resize(keys.size());
+
+   for (const GLuint key : keys) ++groups.offsets[key + 1];
+
+   for (size_t k = 0; k < num_keys; ++k) groups.offsets[k + 1] += groups.offsets[k];
+
+   std::vector< uint32_t > next(groups.offsets.cbegin(), groups.offsets.cend() - 1);
+
+   for (size_t i = 0; i < keys.size(); ++i)
+   {
+      groups.items[next[keys[i]]++] = static_cast< uint32_t >(i / item_divisor);
+   }
+
+   return groups;
+}
+
+// exact position of a vertex
+struct PositionKey
+{
+   uint32_t bits[3];
+
+   bool operator == ( const PositionKey & key ) const
+   {
+      return bits[0] == key.bits[0] && bits[1] == key.bits[1] && bits[2] == key.bits[2];
+   }
+};
+
+struct PositionKeyHash
+{
+   size_t operator ( ) ( const PositionKey & key ) const
+   {
+      // the low bits of float coordinates are often all zero,
+      // so the bits are mixed throughout (splitmix64 finalizer)
+      uint64_t hash = (static_cast< uint64_t >(key.bits[0]) << 32 | key.bits[1]) ^
+                      (static_cast< uint64_t >(key.bits[2]) * 0x9e3779b97f4a7c15ull);
+
+      hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+      hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+
+      return static_cast< size_t >(hash ^ (hash >> 31));
+   }
+};
+
+inline Vec3d ToVec3d( const Vec3f & v )
+{
+   return Vec3d(v.mT[0], v.mT[1], v.mT[2]);
+}
+
+// state of a simplification in progress
+class Simplifier
+{
+public:
+   Simplifier( GeomHelper::Shape & shape );
+
+   // runs the collapse passes, returns the largest error
+   float Run( const size_t target_triangles, const float max_error );
+
+private:
+   // prohibit copy construction
+   Simplifier( const Simplifier & );
+   // prohibit copy operator
+   Simplifier & operator = ( const Simplifier & );
+
+   // a collapse of one position into a neighboring position
+   struct Collapse
+   {
+      GLuint   from;
+      GLuint   to;
+      double   error;
+   };
+
+   // assigns each vertex the position it shares with the others
+   void WeldPositions( );
+
+   // determines the kinds of the positions and the face and edge quadrics
+   void Classify( );
+
+   // checks the collapse and maps the vertices of from to the vertices of to...
+   // returns the number of triangles the collapse removes, or zero if it is not valid
+   size_t Validate( const Collapse & collapse, const Groups & position_triangles );
+
+   // removes the collapsed triangles and the triangles that became degenerate
+   void ApplyRemap( );
+
+   GeomHelper::Shape &           mShape;
+
+   // position of each vertex, and the location and vertices of each position
+   std::vector< GLuint >         mPositionOf;
+   std::vector< Vec3d >          mPositions;
+   Groups                        mVertices;
+
+   std::vector< VertexKind >     mKinds;
+   std::vector< Quadric >        mQuadrics;
+
+   // the vertex each vertex has been collapsed into
+   std::vector< GLuint >         mRemap;
+
+};
+
+Simplifier::Simplifier( GeomHelper::Shape & shape ) :
+mShape   ( shape )
+{
+   WeldPositions();
+   Classify();
+
+   mRemap.resize(mShape.vertices.size());
+
+   for (size_t v = 0; v < mRemap.size(); ++v) mRemap[v] = static_cast< GLuint >(v);
+}
+
+void Simplifier::WeldPositions( )
+{
+   std::unordered_map< PositionKey, GLuint, PositionKeyHash > keys;
+   keys.reserve(mShape.vertices.size());
+
+   mPositionOf.assign(mShape.vertices.size(), INVALID_INDEX);
+
+   // only the referenced vertices matter
+   std::vector< bool > referenced(mShape.vertices.size(), false);
+
+   for (const GLuint index : mShape.indices) referenced[index] = true;
+
+   for (size_t v = 0; v < mShape.vertices.size(); ++v)
+   {
+      if (!referenced[v]) continue;
+
+      PositionKey key;
+
+      for (uint32_t axis = 0; axis < 3; ++axis)
+      {
+         // -0 and 0 are the same position
+         const float coordinate = mShape.vertices[v].mT[axis] + 0.0f;
+         std::memcpy(&key.bits[axis], &coordinate, sizeof(key.bits[axis]));
+      }
+
+      const auto position = keys.emplace(key, static_cast< GLuint >(mPositions.size()));
+
+      if (position.second) mPositions.push_back(ToVec3d(mShape.vertices[v]));
+
+      mPositionOf[v] = position.first->second;
+   }
+
+   // group the vertices by their positions
+   std::vector< GLuint > positions;
+   std::vector< GLuint > vertices;
+
+   for (size_t v = 0; v < mPositionOf.size(); ++v)
+   {
+      if (mPositionOf[v] != INVALID_INDEX)
+      {
+         positions.push_back(mPositionOf[v]);
+         vertices.push_back(static_cast< GLuint >(v));
+      }
+   }
+
+   mVertices = GroupBy(positions, mPositions.size());
+
+   for (uint32_t & item : mVertices.items) item = vertices[item];
+}
+
+void Simplifier::Classify( )
+{
+   const std::vector< GLuint > & indices = mShape.indices;
+
+   // the triangles around each vertex and each position
+   std::vector< GLuint > corner_positions(indices.size());
+
+   for (size_t i = 0; i < indices.size(); ++i) corner_positions[i] = mPositionOf[indices[i]];
+
+   const Groups vertex_triangles = GroupBy(indices, mShape.vertices.size(), 3);
+   const Groups position_triangles = GroupBy(corner_positions, mPositions.size(), 3);
+
+   // determines if a triangle around b has the edge b to a
+   const auto HasEdge = [ ] ( const Groups & triangles, const std::vector< GLuint > & corners,
+                              const GLuint a, const GLuint b )
+   {
+      for (uint32_t t = triangles.offsets[b]; t < triangles.offsets[b + 1]; ++t)
+      {
+         const size_t i = triangles.items[t] * 3;
+
+         for (size_t e = 0; e < 3; ++e)
+         {
+            if (corners[i + e] == b && corners[i + (e + 1) % 3] == a) return true;
+         }
+      }
+
+      return false;
+   };
+
+   // count the edges without an opposite edge around each position and vertex
+   std::vector< uint32_t > open_position_edges(mPositions.size(), 0);
+   std::vector< uint32_t > open_vertex_edges(mShape.vertices.size(), 0);
+
+   mQuadrics.assign(mPositions.size(), Quadric());
+
+   for (size_t i = 0; i < indices.size(); i += 3)
+   {
+      const Vec3d & p0 = mPositions[mPositionOf[indices[i + 0]]];
+      const Vec3d & p1 = mPositions[mPositionOf[indices[i + 1]]];
+      const Vec3d & p2 = mPositions[mPositionOf[indices[i + 2]]];
+
+      // face plane weighted by the area
+      Vec3d normal = (p1 - p0) ^ (p2 - p0);
+      const double area = normal.Normalize() * 0.5;
+
+      if (!(area > 0.0)) continue;
+
+      for (size_t e = 0; e < 3; ++e)
+      {
+         AddPlane(mQuadrics[mPositionOf[indices[i + e]]], normal, -(normal * p0), area);
+      }
+
+      for (size_t e = 0; e < 3; ++e)
+      {
+         const GLuint a = indices[i + e], b = indices[i + (e + 1) % 3];
+         const GLuint pa = mPositionOf[a], pb = mPositionOf[b];
+
+         const bool open_position = !HasEdge(position_triangles, corner_positions, pa, pb);
+         const bool open_vertex = !HasEdge(vertex_triangles, indices, a, b);
+
+         if (open_position) { ++open_position_edges[pa]; ++open_position_edges[pb]; }
+         if (open_vertex) { ++open_vertex_edges[a]; ++open_vertex_edges[b]; }
+
+         if (open_vertex)
+         {
+            // plane through the edge perpendicular to the face, which keeps
+            // the border and seam vertices from moving off of the edge
+            const Vec3d edge = mPositions[pb] - mPositions[pa];
+
+            Vec3d edge_normal = edge ^ normal;
+            const double length = edge_normal.Normalize();
+
+            if (length > 0.0)
+            {
+               const double weight = (edge * edge) * SEAM_PLANE_WEIGHT;
+
+               AddPlane(mQuadrics[pa], edge_normal, -(edge_normal * mPositions[pa]), weight);
+               AddPlane(mQuadrics[pb], edge_normal, -(edge_normal * mPositions[pa]), weight);
+            }
+         }
+      }
+   }
+
+   mKinds.assign(mPositions.size(), VERTEX_KIND_LOCKED);
+
+   for (size_t p = 0; p < mPositions.size(); ++p)
+   {
+      const uint32_t begin = mVertices.offsets[p], end = mVertices.offsets[p + 1];
+
+      if (end - begin == 1)
+      {
+         const uint32_t open = open_vertex_edges[mVertices.items[begin]];
+
+         // open edges between positions are borders, open edges between
+         // vertices of a single position vertex end a seam
+         if (!open)
+         {
+            mKinds[p] = VERTEX_KIND_MANIFOLD;
+         }
+         else if (open == 2 && open_position_edges[p] == 2)
+         {
+            mKinds[p] = VERTEX_KIND_BORDER;
+         }
+      }
+      else if (end - begin == 2 && !open_position_edges[p])
+      {
+         // each side of the seam continues in one edge each way
+         if (open_vertex_edges[mVertices.items[begin]] == 2 &&
+             open_vertex_edges[mVertices.items[begin + 1]] == 2)
+         {
+            mKinds[p] = VERTEX_KIND_SEAM;
+         }
+      }
+   }
+}
+
+size_t Simplifier::Validate( const Collapse & collapse, const Groups & position_triangles )
+{
+   const std::vector< GLuint > & indices = mShape.indices;
+
+   const GLuint from = collapse.from, to = collapse.to;
+
+   // the vertex of to that each vertex of from moves to
+   GLuint targets[2] = { INVALID_INDEX, INVALID_INDEX };
+   // the vertices of from used by the triangles that are removed
+   GLuint shared_from[2] = { INVALID_INDEX, INVALID_INDEX };
+
+   const uint32_t from_begin = mVertices.offsets[from];
+   const uint32_t num_from = mVertices.offsets[from + 1] - from_begin;
+
+   size_t shared = 0;
+
+   for (uint32_t t = position_triangles.offsets[from]; t < position_triangles.offsets[from + 1]; ++t)
+   {
+      const size_t i = position_triangles.items[t] * 3;
+
+      GLuint vertex_from = INVALID_INDEX, vertex_to = INVALID_INDEX;
+
+      for (size_t corner = 0; corner < 3; ++corner)
+      {
+         if (mPositionOf[indices[i + corner]] == from) vertex_from = indices[i + corner];
+         if (mPositionOf[indices[i + corner]] == to) vertex_to = indices[i + corner];
+      }
+
+      if (vertex_to != INVALID_INDEX)
+      {
+         // the triangle collapses, and its vertex of to is where the vertex of from goes
+         const uint32_t slot = num_from == 2 && mVertices.items[from_begin + 1] == vertex_from ? 1 : 0;
+
+         if (targets[slot] != INVALID_INDEX && targets[slot] != vertex_to) return 0;
+
+         targets[slot] = vertex_to;
+
+         if (shared < 2) shared_from[shared] = vertex_from;
+
+         ++shared;
+      }
+      else
+      {
+         // the remaining triangles must not flip or turn too far
+         Vec3d p[3];
+
+         for (size_t corner = 0; corner < 3; ++corner)
+         {
+            p[corner] = mPositions[mPositionOf[indices[i + corner]]];
+         }
+
+         const Vec3d before = (p[1] - p[0]) ^ (p[2] - p[0]);
+
+         for (size_t corner = 0; corner < 3; ++corner)
+         {
+            if (mPositionOf[indices[i + corner]] == from) p[corner] = mPositions[to];
+         }
+
+         const Vec3d after = (p[1] - p[0]) ^ (p[2] - p[0]);
+
+         const double length = std::sqrt((before * before) * (after * after));
+
+         if (!(length > 0.0) || before * after < MIN_FACE_NORMAL_DOT * length) return 0;
+      }
+   }
+
+   switch (mKinds[from])
+   {
+   case VERTEX_KIND_MANIFOLD:
+      if (!shared) return 0;
+
+      break;
+
+   case VERTEX_KIND_BORDER:
+      // only along the border
+      if (shared != 1) return 0;
+
+      break;
+
+   case VERTEX_KIND_SEAM:
+      // only along the seam, where each side of the seam has its own triangle
+      if (shared != 2 || shared_from[0] == shared_from[1]) return 0;
+
+      break;
+
+   default:
+      return 0;
+   }
+
+   // every vertex of from needs somewhere to go
+   for (uint32_t slot = 0; slot < num_from; ++slot)
+   {
+      if (targets[slot] == INVALID_INDEX) return 0;
+
+      mRemap[mVertices.items[from_begin + slot]] = targets[slot];
+   }
+
+   return shared;
+}
+
+void Simplifier::ApplyRemap( )
+{
+   std::vector< GLuint > & indices = mShape.indices;
+
+   size_t num_indices = 0;
+
+   for (size_t i = 0; i < indices.size(); i += 3)
+   {
+      const GLuint i0 = mRemap[indices[i + 0]];
+      const GLuint i1 = mRemap[indices[i + 1]];
+      const GLuint i2 = mRemap[indices[i + 2]];
+
+      const GLuint p0 = mPositionOf[i0], p1 = mPositionOf[i1], p2 = mPositionOf[i2];
+
+      if (p0 != p1 && p1 != p2 && p2 != p0)
+      {
+         indices[num_indices++] = i0;
+         indices[num_indices++] = i1;
+         indices[num_indices++] = i2;
+      }
+   }
+
+   indices.resize(num_indices);
+}
+
+float Simplifier::Run( const size_t target_triangles, const float max_error )
+{
+   const double max_error_squared = static_cast< double >(max_error) * max_error;
+
+   double error_squared = 0.0;
+
+   size_t num_triangles = mShape.indices.size() / 3;
+
+   std::vector< Collapse > collapses;
+   std::vector< bool > locked;
+
+   while (num_triangles > target_triangles)
+   {
+      // the triangles around each position
+      std::vector< GLuint > corner_positions(mShape.indices.size());
+
+      for (size_t i = 0; i < corner_positions.size(); ++i)
+      {
+         corner_positions[i] = mPositionOf[mShape.indices[i]];
+      }
+
+      const Groups position_triangles = GroupBy(corner_positions, mPositions.size(), 3);
+
+      // the cheapest collapse of each position along its edges
+      collapses.assign(mPositions.size(), Collapse { INVALID_INDEX, INVALID_INDEX, std::numeric_limits< double >::max() });
+
+      for (size_t i = 0; i < corner_positions.size(); i += 3)
+      {
+         for (size_t e = 0; e < 6; ++e)
+         {
+            const GLuint from = corner_positions[i + e % 3];
+            const GLuint to = corner_positions[i + (e % 3 + (e < 3 ? 1 : 2)) % 3];
+
+            const VertexKind kind = mKinds[from];
+
+            // borders and seams only collapse into other borders and seams
+            if (kind == VERTEX_KIND_LOCKED ||
+                (kind == VERTEX_KIND_BORDER && mKinds[to] != VERTEX_KIND_BORDER && mKinds[to] != VERTEX_KIND_LOCKED) ||
+                (kind == VERTEX_KIND_SEAM && mKinds[to] != VERTEX_KIND_SEAM && mKinds[to] != VERTEX_KIND_LOCKED))
+            {
+               continue;
+            }
+
+            const double error = Evaluate(mQuadrics[from], mPositions[to]);
+
+            if (error < collapses[from].error)
+            {
+               collapses[from] = Collapse { from, to, error };
+            }
+         }
+      }
+
+      collapses.erase(std::remove_if(collapses.begin(), collapses.end(),
+                      [ ] ( const Collapse & collapse ) { return collapse.from == INVALID_INDEX; }),
+                      collapses.end());
+
+      std::sort(collapses.begin(), collapses.end(),
+      [ ] ( const Collapse & a, const Collapse & b )
+      {
+         return a.error < b.error;
+      });
+
+      // apply the collapses in order, skipping any that touch the neighborhood
+      // of an earlier collapse, since its checks were made against the old faces
+      locked.assign(mPositions.size(), false);
+
+      size_t num_collapsed = 0;
+
+      for (const Collapse & collapse : collapses)
+      {
+         if (num_triangles <= target_triangles || collapse.error > max_error_squared) break;
+
+         if (locked[collapse.from] || locked[collapse.to]) continue;
+
+         const size_t removed = Validate(collapse, position_triangles);
+
+         if (!removed) continue;
+
+         for (uint32_t t = position_triangles.offsets[collapse.from]; t < position_triangles.offsets[collapse.from + 1]; ++t)
+         {
+            const size_t i = position_triangles.items[t] * 3;
+
+            locked[corner_positions[i + 0]] = true;
+            locked[corner_positions[i + 1]] = true;
+            locked[corner_positions[i + 2]] = true;
+         }
+
+         AddQuadric(mQuadrics[collapse.to], mQuadrics[collapse.from]);
+
+         error_squared = std::max(error_squared, collapse.error);
+         num_triangles -= std::min(removed, num_triangles);
+
+         ++num_collapsed;
+      }
+
+      if (!num_collapsed) break;
+
+      ApplyRemap();
+
+      num_triangles = mShape.indices.size() / 3;
+   }
+
+   return static_cast< float >(std::sqrt(error_squared));
+}
+
+} // namespace details
+
+float Simplify( GeomHelper::Shape & shape,
+                const size_t target_triangles,
+                const float max_error )
+{
+   // indices must align to make triangles
+   WGL_ASSERT(shape.geom_type == GL_TRIANGLES && shape.indices.size() % 3 == 0);
+
+   if (shape.indices.size() / 3 <= target_triangles) return 0.0f;
+
+   details::Simplifier simplifier(shape);
+
+   return simplifier.Run(target_triangles, max_error);
+}
+
+std::vector< LodLevel > ConstructLodChain( const GeomHelper::Shape & shape,
+                                           const std::vector< float > & ratios )
+{
+   std::vector< LodLevel > levels;
+
+   levels.push_back(LodLevel { shape.indices, 0.0f });
+
+   const size_t num_triangles = shape.indices.size() / 3;
+
+   // only the indices of the copies change
+   GeomHelper::Shape level = shape;
+
+   for (const float ratio : ratios)
+   {
+      level.indices = shape.indices;
+
+      const size_t target = static_cast< size_t >(num_triangles * static_cast< double >(ratio));
+
+      // the error of a coarser level should never be reported as smaller
+      const float error = std::max(Simplify(level, target), levels.back().error);
+
+      MeshOptimizer::OptimizeVertexCache(level.indices, level.vertices.size());
+
+      levels.push_back(LodLevel { level.indices, error });
+   }
+
+   return levels;
+}
+
+} // namespace MeshSimplifier
@@ -0,0 +1,124 @@
+#ifndef _MESH_SIMPLIFIER_H_
+#define _MESH_SIMPLIFIER_H_
+
+// local includes
+#include "Matrix.h"
+#include "Vector.h"
+#include "GeomHelper.h"
+
+// std includes
+#include <limits>
+#include <vector>
+#include <cstddef>
+
+// forward declarations
+template < typename Policy > class Camera;
+
+// quadric error metric simplification of indexed triangle lists and the
+// level of detail chains built from it.  the simplifier only collapses
+// vertices into their neighbors and never moves or creates vertices, so
+// all the levels of a shape index into the vertices of the source shape
+// and can share its vertex buffers.
+namespace MeshSimplifier
+{
+
+// a level of detail of a shape
+struct LodLevel
+{
+   // indices into the vertices of the source shape
+   std::vector< GLuint >   indices;
+   // largest distance the surface moved from the source, in object units
+   float                   error;
+};
+
+// collapses the vertices of the triangle list into their neighbors in the
+// order of the least quadric error until at most target_triangles remain
+// or no collapse stays within max_error.  vertices on uv and normal seams
+// and on open borders are only collapsed along them, so the seams and the
+// silhouette stay intact.  the vertices are left as is.  vertices that
+// are exact duplicates of each other should be welded beforehand
+// (MeshOptimizer::WeldVertices).  returns the error in object units.
+float Simplify( GeomHelper::Shape & shape,
+                const size_t target_triangles,
+                const float max_error = std::numeric_limits< float >::max() );
+
+// builds the levels of detail of the shape.  the first level is the source
+// and each ratio adds a level with that fraction of the source triangles.
+// every level is simplified from the source, so the errors do not compound,
+// and is ordered for the vertex cache.
+std::vector< LodLevel > ConstructLodChain( const GeomHelper::Shape & shape,
+                                           const std::vector< float > & ratios = { 0.5f, 0.25f, 0.125f } );
+
+// size in pixels of an object space error at a distance from the eye
+// with an opengl projection matrix and a viewport of the given height
+template < typename T >
+T ProjectedError( const T error, const T distance,
+                  const Matrix< T > & projection,
+                  const T viewport_height );
+
+// selects the coarsest level whose error projects to no more
+// than max_pixel_error pixels at the distance from the eye
+template < typename T >
+size_t SelectLod( const std::vector< LodLevel > & levels,
+                  const T distance,
+                  const Matrix< T > & projection,
+                  const T viewport_height,
+                  const T max_pixel_error = T(1) );
+
+// selects the level for an object at the world position from the camera
+template < typename Policy >
+size_t SelectLod( const std::vector< LodLevel > & levels,
+                  const Camera< Policy > & camera,
+                  const typename Policy::vec_type & world_position,
+                  const typename Policy::type viewport_height,
+                  const typename Policy::type max_pixel_error = typename Policy::type(1) );
+
+template < typename T >
+inline T ProjectedError( const T error, const T distance,
+                         const Matrix< T > & projection,
+                         const T viewport_height )
+{
+   // a perspective projection divides by the distance, an orthographic one
+   // does not.  the distance is taken as the depth along the view direction.
+   const T w = projection.mT[15] - projection.mT[11] * distance;
+
+   return w > T(0) ?
+          error * projection.mT[5] * viewport_height * T(0.5) / w :
+          std::numeric_limits< T >::max();
+}
+
+template < typename T >
+inline size_t SelectLod( const std::vector< LodLevel > & levels,
+                         const T distance,
+                         const Matrix< T > & projection,
+                         const T viewport_height,
+                         const T max_pixel_error )
+{
+   size_t level = 0;
+
+   // the errors grow with each level
+   while (level + 1 < levels.size() &&
+          ProjectedError(static_cast< T >(levels[level + 1].error), distance,
+                         projection, viewport_height) <= max_pixel_error)
+   {
+      ++level;
+   }
+
+   return level;
+}
+
+template < typename Policy >
+inline size_t SelectLod( const std::vector< LodLevel > & levels,
+                         const Camera< Policy > & camera,
+                         const typename Policy::vec_type & world_position,
+                         const typename Policy::type viewport_height,
+                         const typename Policy::type max_pixel_error )
+{
+   const typename Policy::type distance = (world_position - camera.GetEyePosition()).Length();
+
+   return SelectLod(levels, distance, camera.GetProjectionMatrix(), viewport_height, max_pixel_error);
+}
+
+} // namespace MeshSimplifier
+
+#endif // _MESH_SIMPLIFIER_H_
@@ -0,0 +1,35 @@
+#ifndef _PARALLEL_FOR_H_
+#define _PARALLEL_FOR_H_
+
+// local includes
+#include "JobPool.h"
+
+// std includes
+#include <cstddef>
+#include <algorithm>
+#include <functional>
+
+// splits [0, count) into contiguous jobs of grain_size items and calls
+// fn(begin, end) for each job on the threads of the shared job pool.
+// the calling thread works on the jobs too and returns once all of them
+// have completed.  counts smaller than two grains run on the caller, as
+// do calls made while the shared pool is busy with another call.
+template < typename Fn >
+void ParallelFor( const size_t count, const size_t grain_size, Fn && fn )
+{
+   const size_t grain = std::max< size_t >(grain_size, 1);
+
+   if (count / grain <= 1)
+   {
+      if (count) fn(size_t(0), count);
+   }
+   else
+   {
+      const std::function< void ( size_t, size_t ) > job =
+         [ &fn ] ( const size_t begin, const size_t end ) { fn(begin, end); };
+
+      JobPool::Shared().ParallelFor(count, grain, job);
+   }
+}
+
+#endif // _PARALLEL_FOR_H_
@@ -0,0 +1,247 @@
+// local includes
+#include "ParticlePool.h"
+#include "Simd.h"
+#include "WglAssert.h"
+#include "ParallelFor.h"
+
+// std includes
+#include <cmath>
+#include <utility>
+#include <algorithm>
+
+namespace details
+{
+
+// particles each thread integrates at the least
+const size_t PARTICLE_GRAIN_SIZE = 32768;
+
+// a random value in [-1, 1] from a xorshift generator, which gives the same
+// sequence on every platform unlike the std distributions
+float RandomSigned( uint32_t & state )
+{
+   state ^= state << 13;
+   state ^= state >> 17;
+   state ^= state << 5;
+
+   return static_cast< float >(state >> 8) * (2.0f / 16777215.0f) - 1.0f;
+}
+
+// integrates the particles in [begin, end)
+void Integrate( float * const (&pPositions)[3],
+                float * const (&pVelocities)[3],
+                float * const pLifespans,
+                const size_t begin,
+                const size_t end,
+                const float seconds,
+                const float (&force)[3],
+                const float drag )
+{
+   // the drag is applied as a damping of the velocity
+   const float damping = 1.0f - drag * seconds;
+
+   size_t i = begin;
+
+#if defined( WGL_SIMD_SSE2 )
+
+   typedef simd::Vec4< float > Vec4;
+
+   const Vec4 t = Vec4::Splat(seconds);
+   const Vec4 d = Vec4::Splat(damping);
+
+   for (uint32_t axis = 0; axis < 3; ++axis)
+   {
+      const Vec4 f = Vec4::Splat(force[axis] * seconds);
+
+      float * const pP = pPositions[axis];
+      float * const pV = pVelocities[axis];
+
+      for (i = begin; i + 4 <= end; i += 4)
+      {
+         const Vec4 v = Vec4::Load(pV + i) * d + f;
+
+         v.Store(pV + i);
+         (Vec4::Load(pP + i) + v * t).Store(pP + i);
+      }
+   }
+
+   for (i = begin; i + 4 <= end; i += 4)
+   {
+      (Vec4::Load(pLifespans + i) - t).Store(pLifespans + i);
+   }
+
+#endif // WGL_SIMD_SSE2
+
+   for (; i < end; ++i)
+   {
+      for (uint32_t axis = 0; axis < 3; ++axis)
+      {
+         pVelocities[axis][i] = pVelocities[axis][i] * damping + force[axis] * seconds;
+         pPositions[axis][i] = pPositions[axis][i] + pVelocities[axis][i] * seconds;
+      }
+
+      pLifespans[i] = pLifespans[i] - seconds;
+   }
+}
+
+} // namespace details
+
+ParticlePool::ParticlePool( const size_t capacity, const uint32_t seed ) :
+mLifespans     ( capacity ),
+mCapacity      ( capacity ),
+mSize          ( 0 ),
+mEmitCarry     ( 0.0f ),
+mRandom        ( seed ? seed : 1 )
+{
+   for (uint32_t axis = 0; axis < 3; ++axis)
+   {
+      mPositions[axis].resize(capacity);
+      mVelocities[axis].resize(capacity);
+   }
+}
+
+ParticlePool::~ParticlePool( )
+{
+}
+
+ParticlePool::ParticlePool( ParticlePool && pool ) :
+ParticlePool(0)
+{
+   *this = std::move(pool);
+}
+
+ParticlePool & ParticlePool::operator = ( ParticlePool && pool )
+{
+   for (uint32_t axis = 0; axis < 3; ++axis)
+   {
+      std::swap(mPositions[axis], pool.mPositions[axis]);
+      std::swap(mVelocities[axis], pool.mVelocities[axis]);
+   }
+
+   std::swap(mLifespans, pool.mLifespans);
+   std::swap(mCapacity, pool.mCapacity);
+   std::swap(mSize, pool.mSize);
+   std::swap(mEmitCarry, pool.mEmitCarry);
+   std::swap(mRandom, pool.mRandom);
+
+   return *this;
+}
+
+void ParticlePool::Clear( )
+{
+   mSize = 0;
+   mEmitCarry = 0.0f;
+}
+
+size_t ParticlePool::Emit( const ParticleEmitter & emitter, const float seconds )
+{
+   WGL_ASSERT(seconds >= 0.0f && emitter.rate >= 0.0f);
+
+   mEmitCarry += emitter.rate * seconds;
+
+   const float born = std::floor(mEmitCarry);
+
+   mEmitCarry -= born;
+
+   const size_t count = static_cast< size_t >(born);
+   const size_t emitted = std::min(count, mCapacity - mSize);
+
+   for (size_t i = 0; i < emitted; ++i)
+   {
+      // the first particle was born the furthest into the past
+      const float age = seconds * (static_cast< float >(count - i) - 0.5f) / static_cast< float >(count);
+
+      for (uint32_t axis = 0; axis < 3; ++axis)
+      {
+         const float velocity = emitter.velocity[axis] + emitter.velocity_spread * details::RandomSigned(mRandom);
+
+         mVelocities[axis][mSize] = velocity;
+         mPositions[axis][mSize] = emitter.position[axis] + velocity * age;
+      }
+
+      mLifespans[mSize] = emitter.lifespan + emitter.lifespan_spread * details::RandomSigned(mRandom) - age;
+
+      ++mSize;
+   }
+
+   return emitted;
+}
+
+void ParticlePool::Integrate( const float seconds,
+                              const float (&force)[3],
+                              const float drag,
+                              const bool parallel )
+{
+   float * const pPositions[3] = { mPositions[0].data(), mPositions[1].data(), mPositions[2].data() };
+   float * const pVelocities[3] = { mVelocities[0].data(), mVelocities[1].data(), mVelocities[2].data() };
+   float * const pLifespans = mLifespans.data();
+
+   const auto Integrate = [ & ] ( const size_t begin, const size_t end )
+   {
+      details::Integrate(pPositions, pVelocities, pLifespans, begin, end, seconds, force, drag);
+   };
+
+   if (parallel)
+   {
+      // the chunks start on multiples of four so each thread runs whole vectors
+      const size_t num_groups = (mSize + 3) / 4;
+
+      ParallelFor(num_groups, details::PARTICLE_GRAIN_SIZE / 4,
+         [ & ] ( const size_t begin, const size_t end )
+         {
+            Integrate(begin * 4, std::min(end * 4, mSize));
+         });
+   }
+   else
+   {
+      Integrate(0, mSize);
+   }
+}
+
+size_t ParticlePool::Retire( )
+{
+   const size_t size = mSize;
+
+   for (size_t i = 0; i < mSize; )
+   {
+      if (mLifespans[i] > 0.0f)
+      {
+         ++i;
+      }
+      else
+      {
+         // the last live particle takes the place of the retired one
+         const size_t last = --mSize;
+
+         for (uint32_t axis = 0; axis < 3; ++axis)
+         {
+            mPositions[axis][i] = mPositions[axis][last];
+            mVelocities[axis][i] = mVelocities[axis][last];
+         }
+
+         mLifespans[i] = mLifespans[last];
+      }
+   }
+
+   return size - mSize;
+}
+
+void ParticlePool::Update( const ParticleEmitter & emitter,
+                           const float seconds,
+                           const float (&force)[3],
+                           const float drag,
+                           const bool parallel )
+{
+   Integrate(seconds, force, drag, parallel);
+   Retire();
+   Emit(emitter, seconds);
+}
+
+void ParticlePool::CopyPositions( float * const pPositions ) const
+{
+   for (size_t i = 0; i < mSize; ++i)
+   {
+      pPositions[i * 3 + 0] = mPositions[0][i];
+      pPositions[i * 3 + 1] = mPositions[1][i];
+      pPositions[i * 3 + 2] = mPositions[2][i];
+   }
+}
@@ -0,0 +1,105 @@
+#ifndef _PARTICLE_POOL_H_
+#define _PARTICLE_POOL_H_
+
+// std includes
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// describes where and how fast particles are born
+struct ParticleEmitter
+{
+   // position and velocity of the particles at birth
+   float    position[3];
+   float    velocity[3];
+
+   // each component of the velocity is varied by up to the spread
+   float    velocity_spread;
+
+   // seconds the particles live, varied by up to the spread
+   float    lifespan;
+   float    lifespan_spread;
+
+   // particles born each second
+   float    rate;
+};
+
+// a fixed capacity pool of particles stored as a structure of arrays...
+// each attribute is a separate array, so the integration streams through
+// them four particles at a time.  particles are retired by swapping the last
+// live particle into their place, so the live particles are always [0, Size).
+// the pool is deterministic, the same seed and the same sequence of time
+// steps always give the same particles, serial or parallel.
+class ParticlePool
+{
+public:
+   // constructor / destructor
+   explicit ParticlePool( const size_t capacity, const uint32_t seed = 1 );
+           ~ParticlePool( );
+
+   // only allow move construction and assignment
+   ParticlePool( ParticlePool && pool );
+   ParticlePool & operator = ( ParticlePool && pool );
+
+   // the most particles the pool holds and the number alive
+   size_t Capacity( ) const { return mCapacity; }
+   size_t Size( ) const { return mSize; }
+
+   // retires all the particles
+   void Clear( );
+
+   // bears the particles the emitter releases over the seconds...
+   // the fraction of a particle left over is carried to the next call, and
+   // particles that do not fit in the pool are dropped.  the particles are
+   // spread across the step as if born at an even rate.  returns the number
+   // of particles born.
+   size_t Emit( const ParticleEmitter & emitter, const float seconds );
+
+   // advances the particles by the seconds under a constant force, with the
+   // velocity damped by the drag...  v += (force - drag * v) * t, p += v * t.
+   // the particles are split across the hardware threads when parallel.
+   void Integrate( const float seconds,
+                   const float (&force)[3],
+                   const float drag,
+                   const bool parallel = false );
+
+   // retires the particles that lived out their lifespan, returning the number retired
+   size_t Retire( );
+
+   // integrates, retires the particles that expired, then emits for a whole time step
+   void Update( const ParticleEmitter & emitter,
+                const float seconds,
+                const float (&force)[3],
+                const float drag,
+                const bool parallel = false );
+
+   // the attributes of the live particles, one array per component
+   const float * Positions( const uint32_t axis ) const { return mPositions[axis].data(); }
+   const float * Velocities( const uint32_t axis ) const { return mVelocities[axis].data(); }
+   const float * Lifespans( ) const { return mLifespans.data(); }
+
+   // copies the positions of the live particles as interleaved xyz
+   void CopyPositions( float * const pPositions ) const;
+
+private:
+   // prohibit copy construction and assignment
+   ParticlePool( const ParticlePool & );
+   ParticlePool & operator = ( const ParticlePool & );
+
+   // the attributes of the particles, each sized to the capacity
+   std::vector< float > mPositions[3];
+   std::vector< float > mVelocities[3];
+   std::vector< float > mLifespans;
+
+   size_t               mCapacity;
+   size_t               mSize;
+
+   // fraction of a particle carried over to the next emission
+   float                mEmitCarry;
+
+   // state of the random numbers that vary the particles
+   uint32_t             mRandom;
+
+};
+
+#endif // _PARTICLE_POOL_H_
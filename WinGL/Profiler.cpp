@@ -0,0 +1,525 @@
+// local includes
+#include "Profiler.h"
+
+// std includes
+#include <map>
+#include <new>
+#include <mutex>
+#include <memory>
+#include <ostream>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+
+// a zone as recorded by a thread
+struct ProfileEvent
+{
+   const char *   pName;
+   Profiler::Tick begin;
+   Profiler::Tick end;
+};
+
+// a zone kept for the trace output
+struct TraceEvent
+{
+   const char *   pName;
+   uint32_t       thread;
+   Profiler::Tick begin;
+   Profiler::Tick end;
+};
+
+// single producer / single consumer ring of zones.  the owning thread
+// is the only writer and EndFrame is the only reader, so the two
+// indices are all the synchronization that is required.
+struct ThreadBuffer
+{
+   explicit ThreadBuffer( const uint32_t id ) :
+   id       ( id ),
+   write    ( 0 ),
+   read     ( 0 ),
+   retired  ( false ),
+   events   ( Profiler::THREAD_BUFFER_EVENTS )
+   {
+   }
+
+   const uint32_t                id;
+   std::atomic< uint64_t >       write;
+   std::atomic< uint64_t >       read;
+   // set once the owning thread has exited
+   std::atomic< bool >           retired;
+   std::vector< ProfileEvent >   events;
+};
+
+// per frame totals of a zone over the last HISTORY_FRAMES frames
+struct ZoneHistory
+{
+   ZoneHistory( ) :
+   frame_ticks ( 0 ),
+   frame_calls ( 0 ),
+   ticks       { },
+   calls       { },
+   stamps      { }
+   {
+   }
+
+   // accumulates the frame being collected
+   void Add( const Profiler::Tick duration )
+   {
+      frame_ticks += duration;
+      ++frame_calls;
+   }
+
+   // moves the totals of the current frame into the history
+   void Commit( const uint64_t frame )
+   {
+      if (frame_calls)
+      {
+         const size_t slot = frame % Profiler::HISTORY_FRAMES;
+
+         ticks[slot] = frame_ticks;
+         calls[slot] = frame_calls;
+         // zero marks an unused slot
+         stamps[slot] = frame + 1;
+
+         frame_ticks = 0;
+         frame_calls = 0;
+      }
+   }
+
+   Profiler::Tick frame_ticks;
+   uint32_t       frame_calls;
+
+   Profiler::Tick ticks[Profiler::HISTORY_FRAMES];
+   uint32_t       calls[Profiler::HISTORY_FRAMES];
+   uint64_t       stamps[Profiler::HISTORY_FRAMES];
+};
+
+class ProfilerState
+{
+public:
+   // the state is never destroyed, so threads exiting after
+   // the static destructors have run can still retire their buffers
+   static ProfilerState & Instance( );
+
+   ThreadBuffer * Register( );
+
+   void EndFrame( const uint32_t thread );
+
+   ProfileZoneStats FrameStats( );
+   std::vector< ProfileZoneStats > ZoneStats( );
+
+   void SetThreadName( const uint32_t thread, const char * const pName );
+   void SetTraceCapture( const bool capture );
+   void WriteChromeTrace( std::ostream & stream );
+   void Reset( );
+
+   std::atomic< uint64_t >       mDropped;
+
+   // start of the frame being collected, zero if there is none
+   std::atomic< Profiler::Tick > mFrameBegin;
+
+private:
+   ProfilerState( );
+
+   // drains the zones recorded since the last call
+   void Drain( );
+
+   ZoneHistory & Zone( const char * const pName );
+
+   ProfileZoneStats Stats( const std::string & name, const ZoneHistory & history );
+
+   std::mutex                                         mMutex;
+
+   uint32_t                                           mNextThread;
+   std::vector< std::unique_ptr< ThreadBuffer > >     mBuffers;
+   std::map< uint32_t, std::string >                  mThreadNames;
+
+   // zones are merged by name, since equal literals
+   // are not guaranteed to share an address
+   std::map< std::string, ZoneHistory >               mZones;
+   std::unordered_map< const char *, ZoneHistory * >  mZoneLookup;
+
+   ZoneHistory                                        mFrame;
+   uint64_t                                           mFrameCount;
+
+   bool                                               mCapture;
+   std::vector< TraceEvent >                          mTrace;
+
+   // start of the session, the origin of the trace output
+   const Profiler::Tick                               mStartTick;
+};
+
+// owns the registration of the calling thread
+struct ThreadSlot
+{
+   ~ThreadSlot( )
+   {
+      if (pBuffer)
+      {
+         pBuffer->retired.store(true, std::memory_order_release);
+         pBuffer = nullptr;
+      }
+   }
+
+   ThreadBuffer * pBuffer;
+};
+
+thread_local ThreadSlot tThreadSlot = { nullptr };
+
+ThreadBuffer & GetThreadBuffer( )
+{
+   if (!tThreadSlot.pBuffer)
+   {
+      tThreadSlot.pBuffer = ProfilerState::Instance().Register();
+   }
+
+   return *tThreadSlot.pBuffer;
+}
+
+// writes a string as a json string literal
+void WriteJsonString( std::ostream & stream, const char * pString )
+{
+   stream << '"';
+
+   for (; *pString; ++pString)
+   {
+      const unsigned char c = static_cast< unsigned char >(*pString);
+
+      if (c == '"' || c == '\\')
+      {
+         stream << '\\' << *pString;
+      }
+      else if (c < 0x20)
+      {
+         stream << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                << static_cast< unsigned >(c) << std::dec << std::setfill(' ');
+      }
+      else
+      {
+         stream << *pString;
+      }
+   }
+
+   stream << '"';
+}
+
+ProfilerState & ProfilerState::Instance( )
+{
+   alignas(ProfilerState) static unsigned char storage[sizeof(ProfilerState)];
+
+   static ProfilerState * const pState = new (storage) ProfilerState;
+
+   return *pState;
+}
+
+ProfilerState::ProfilerState( ) :
+mDropped       ( 0 ),
+mFrameBegin    ( 0 ),
+mNextThread    ( 1 ),
+mFrameCount    ( 0 ),
+mCapture       ( false ),
+mStartTick     ( Profiler::Now() )
+{
+}
+
+ThreadBuffer * ProfilerState::Register( )
+{
+   const std::lock_guard< std::mutex > lock(mMutex);
+
+   mBuffers.emplace_back(new ThreadBuffer(mNextThread++));
+
+   return mBuffers.back().get();
+}
+
+ZoneHistory & ProfilerState::Zone( const char * const pName )
+{
+   const auto lookup = mZoneLookup.find(pName);
+
+   if (lookup != mZoneLookup.end()) return *lookup->second;
+
+   ZoneHistory & zone = mZones[pName];
+   mZoneLookup.emplace(pName, &zone);
+
+   return zone;
+}
+
+void ProfilerState::Drain( )
+{
+   for (auto buffer = mBuffers.begin(); buffer != mBuffers.end(); )
+   {
+      ThreadBuffer & rBuffer = **buffer;
+
+      // check retirement first, so no zone can be written after the check
+      const bool retired = rBuffer.retired.load(std::memory_order_acquire);
+
+      const uint64_t read = rBuffer.read.load(std::memory_order_relaxed);
+      const uint64_t write = rBuffer.write.load(std::memory_order_acquire);
+
+      for (uint64_t i = read; i < write; ++i)
+      {
+         const ProfileEvent & event = rBuffer.events[i % Profiler::THREAD_BUFFER_EVENTS];
+
+         Zone(event.pName).Add(event.end - event.begin);
+
+         if (mCapture && mTrace.size() < Profiler::MAX_TRACE_EVENTS)
+         {
+            mTrace.push_back({ event.pName, rBuffer.id, event.begin, event.end });
+         }
+      }
+
+      rBuffer.read.store(write, std::memory_order_release);
+
+      buffer = retired ? mBuffers.erase(buffer) : std::next(buffer);
+   }
+}
+
+void ProfilerState::EndFrame( const uint32_t thread )
+{
+   const std::lock_guard< std::mutex > lock(mMutex);
+
+   Drain();
+
+   const Profiler::Tick now = Profiler::Now();
+   const Profiler::Tick begin = mFrameBegin.exchange(now, std::memory_order_relaxed);
+
+   if (begin)
+   {
+      mFrame.Add(now - begin);
+
+      if (mCapture && mTrace.size() < Profiler::MAX_TRACE_EVENTS)
+      {
+         mTrace.push_back({ "frame", thread, begin, now });
+      }
+   }
+
+   mFrame.Commit(mFrameCount);
+
+   for (auto & zone : mZones) zone.second.Commit(mFrameCount);
+
+   ++mFrameCount;
+}
+
+ProfileZoneStats ProfilerState::Stats( const std::string & name, const ZoneHistory & history )
+{
+   ProfileZoneStats stats = { name, 0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+   const double ms_per_tick = Profiler::TicksToMS(1);
+
+   // only the frames within the history window are considered
+   const uint64_t oldest = mFrameCount > Profiler::HISTORY_FRAMES ?
+                           mFrameCount - Profiler::HISTORY_FRAMES : 0;
+
+   std::vector< double > times;
+   times.reserve(Profiler::HISTORY_FRAMES);
+
+   uint64_t calls = 0;
+
+   for (size_t i = 0; i < Profiler::HISTORY_FRAMES; ++i)
+   {
+      if (history.stamps[i] > oldest)
+      {
+         times.push_back(history.ticks[i] * ms_per_tick);
+         calls += history.calls[i];
+      }
+   }
+
+   if (!times.empty())
+   {
+      std::sort(times.begin(), times.end());
+
+      double total = 0.0;
+      for (const double time : times) total += time;
+
+      // nearest rank percentile
+      const size_t p99 = (times.size() * 99 + 99) / 100 - 1;
+
+      stats.frames = times.size();
+      stats.calls = static_cast< double >(calls) / times.size();
+      stats.min_ms = times.front();
+      stats.avg_ms = total / times.size();
+      stats.p99_ms = times[p99];
+      stats.max_ms = times.back();
+   }
+
+   return stats;
+}
+
+ProfileZoneStats ProfilerState::FrameStats( )
+{
+   const std::lock_guard< std::mutex > lock(mMutex);
+
+   return Stats("frame", mFrame);
+}
+
+std::vector< ProfileZoneStats > ProfilerState::ZoneStats( )
+{
+   const std::lock_guard< std::mutex > lock(mMutex);
+
+   std::vector< ProfileZoneStats > stats;
+
+   for (const auto & zone : mZones)
+   {
+      stats.push_back(Stats(zone.first, zone.second));
+   }
+
+   return stats;
+}
+
+void ProfilerState::SetThreadName( const uint32_t thread, const char * const pName )
+{
+   const std::lock_guard< std::mutex > lock(mMutex);
+
+   mThreadNames[thread] = pName;
+}
+
+void ProfilerState::SetTraceCapture( const bool capture )
+{
+   const std::lock_guard< std::mutex > lock(mMutex);
+
+   mCapture = capture;
+}
+
+void ProfilerState::WriteChromeTrace( std::ostream & stream )
+{
+   const std::lock_guard< std::mutex > lock(mMutex);
+
+   // timestamps are in microseconds from the start of the session
+   const double us_per_tick = Profiler::TicksToMS(1) * 1000.0;
+
+   const auto flags = stream.flags();
+   const auto precision = stream.precision();
+
+   stream << std::fixed << std::setprecision(3)
+          << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+   bool first = true;
+
+   for (const auto & name : mThreadNames)
+   {
+      stream << (first ? "\n" : ",\n")
+             << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << name.first
+             << ",\"args\":{\"name\":";
+      WriteJsonString(stream, name.second.c_str());
+      stream << "}}";
+
+      first = false;
+   }
+
+   for (const auto & event : mTrace)
+   {
+      // zones recorded before the session start cannot exist,
+      // but guard against a clock that is not synchronized
+      const Profiler::Tick begin = std::max(event.begin, mStartTick);
+
+      stream << (first ? "\n" : ",\n") << "{\"name\":";
+      WriteJsonString(stream, event.pName);
+      stream << ",\"cat\":\"wgl\",\"ph\":\"X\",\"ts\":" << (begin - mStartTick) * us_per_tick
+             << ",\"dur\":" << (event.end - event.begin) * us_per_tick
+             << ",\"pid\":1,\"tid\":" << event.thread << "}";
+
+      first = false;
+   }
+
+   stream << "\n]}\n";
+
+   stream.flags(flags);
+   stream.precision(precision);
+}
+
+void ProfilerState::Reset( )
+{
+   const std::lock_guard< std::mutex > lock(mMutex);
+
+   // discard whatever the threads have recorded so far
+   Drain();
+
+   mZones.clear();
+   mZoneLookup.clear();
+   mFrame = ZoneHistory();
+   mFrameCount = 0;
+   mTrace.clear();
+   mFrameBegin.store(0, std::memory_order_relaxed);
+   mDropped.store(0, std::memory_order_relaxed);
+}
+
+} // namespace
+
+// recording is off until requested
+std::atomic< bool > Profiler::mEnabled ( false );
+
+void Profiler::Enable( const bool enable )
+{
+   mEnabled.store(enable, std::memory_order_relaxed);
+}
+
+void Profiler::Record( const char * const pName, const Tick begin, const Tick end )
+{
+   ThreadBuffer & buffer = GetThreadBuffer();
+
+   const uint64_t write = buffer.write.load(std::memory_order_relaxed);
+
+   if (write - buffer.read.load(std::memory_order_acquire) >= THREAD_BUFFER_EVENTS)
+   {
+      // the frame loop has not drained the buffer in time
+      ProfilerState::Instance().mDropped.fetch_add(1, std::memory_order_relaxed);
+   }
+   else
+   {
+      buffer.events[write % THREAD_BUFFER_EVENTS] = { pName, begin, end };
+      buffer.write.store(write + 1, std::memory_order_release);
+   }
+}
+
+void Profiler::SetThreadName( const char * const pName )
+{
+   ProfilerState::Instance().SetThreadName(GetThreadBuffer().id, pName);
+}
+
+void Profiler::EndFrame( )
+{
+   if (IsEnabled())
+   {
+      // register the thread before taking the state lock
+      const uint32_t thread = GetThreadBuffer().id;
+
+      ProfilerState::Instance().EndFrame(thread);
+   }
+   else
+   {
+      // the next enabled frame starts from scratch
+      ProfilerState::Instance().mFrameBegin.store(0, std::memory_order_relaxed);
+   }
+}
+
+ProfileZoneStats Profiler::GetFrameStats( )
+{
+   return ProfilerState::Instance().FrameStats();
+}
+
+std::vector< ProfileZoneStats > Profiler::GetZoneStats( )
+{
+   return ProfilerState::Instance().ZoneStats();
+}
+
+uint64_t Profiler::GetDroppedEvents( )
+{
+   return ProfilerState::Instance().mDropped.load(std::memory_order_relaxed);
+}
+
+void Profiler::SetTraceCapture( const bool capture )
+{
+   ProfilerState::Instance().SetTraceCapture(capture);
+}
+
+void Profiler::WriteChromeTrace( std::ostream & stream )
+{
+   ProfilerState::Instance().WriteChromeTrace(stream);
+}
+
+void Profiler::Reset( )
+{
+   ProfilerState::Instance().Reset();
+}
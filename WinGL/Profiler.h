@@ -0,0 +1,166 @@
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+// std includes
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iosfwd>
+
+// timing statistics of a zone over the frame history.
+// times are the per frame totals of the zone in milliseconds.
+struct ProfileZoneStats
+{
+   std::string    name;
+   // number of frames in the history the zone was entered
+   size_t         frames;
+   // average number of times the zone was entered per frame
+   double         calls;
+   double         min_ms;
+   double         avg_ms;
+   double         p99_ms;
+   double         max_ms;
+};
+
+// collects timed zones from any number of threads.  each thread records
+// into its own ring buffer, so recording never takes a lock.  the buffers
+// are drained on EndFrame, which is expected to be called once per frame
+// from the thread driving the frame loop.  recording is off by default
+// and a disabled zone costs a single relaxed load.
+class Profiler
+{
+public:
+   // raw timestamps from the profiling clock...
+   // the steady clock, which reads the performance counter on windows
+   typedef uint64_t  Tick;
+
+   // number of frames kept for the statistics
+   static const size_t HISTORY_FRAMES = 240;
+
+   // number of zones each thread can record between frames...
+   // zones past this are dropped and counted
+   static const size_t THREAD_BUFFER_EVENTS = 1 << 14;
+
+   // upper bound on the zones kept for the trace capture
+   static const size_t MAX_TRACE_EVENTS = 1 << 20;
+
+   // enables / disables recording
+   static void Enable( const bool enable );
+   static bool IsEnabled( );
+
+   // obtains the current time from the profiling clock
+   static Tick Now( );
+
+   // converts a span of profiling clock ticks to milliseconds
+   static double TicksToMS( const Tick ticks );
+
+   // records a completed zone for the calling thread...
+   // the name must outlive the profiler (string literals)
+   static void Record( const char * const pName, const Tick begin, const Tick end );
+
+   // names the calling thread in the trace output
+   static void SetThreadName( const char * const pName );
+
+   // drains all the thread buffers and closes the current frame
+   static void EndFrame( );
+
+   // obtains the statistics of the frame time and of each zone
+   static ProfileZoneStats GetFrameStats( );
+   static std::vector< ProfileZoneStats > GetZoneStats( );
+
+   // number of zones dropped because a thread buffer was full
+   static uint64_t GetDroppedEvents( );
+
+   // starts / stops keeping the drained zones for the trace output
+   static void SetTraceCapture( const bool capture );
+
+   // writes the captured zones in the chrome trace event format
+   // (chrome://tracing or ui.perfetto.dev)
+   static void WriteChromeTrace( std::ostream & stream );
+
+   // discards the history and the captured zones
+   static void Reset( );
+
+private:
+   // prohibit construction
+   Profiler( );
+
+   // recording state shared with the zones
+   static std::atomic< bool > mEnabled;
+
+};
+
+// times the enclosing scope when the profiler is enabled
+class ProfileZone
+{
+public:
+   // constructor / destructor
+   explicit ProfileZone( const char * const pName );
+           ~ProfileZone( );
+
+private:
+   // prohibit copy construction
+   ProfileZone( const ProfileZone & );
+   // prohibit copy operator
+   ProfileZone & operator = ( const ProfileZone & );
+
+   // null if the profiler was disabled on entry
+   const char *   mpName;
+   Profiler::Tick mBegin;
+
+};
+
+inline bool Profiler::IsEnabled( )
+{
+   return mEnabled.load(std::memory_order_relaxed);
+}
+
+inline Profiler::Tick Profiler::Now( )
+{
+   return static_cast< Tick >(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+inline double Profiler::TicksToMS( const Tick ticks )
+{
+   // the period of the clock is known at compile time, so nothing needs calibrating
+   typedef std::chrono::steady_clock::period Period;
+
+   return ticks * (1000.0 * Period::num / Period::den);
+}
+
+inline ProfileZone::ProfileZone( const char * const pName ) :
+mpName   ( nullptr ),
+mBegin   ( 0 )
+{
+   if (Profiler::IsEnabled())
+   {
+      mpName = pName;
+      mBegin = Profiler::Now();
+   }
+}
+
+inline ProfileZone::~ProfileZone( )
+{
+   if (mpName)
+   {
+      Profiler::Record(mpName, mBegin, Profiler::Now());
+   }
+}
+
+// instrumentation macros...
+// define WGL_DISABLE_PROFILER to compile them out completely
+#define WGL_PROFILE_CONCAT_IMPL( a, b ) a##b
+#define WGL_PROFILE_CONCAT( a, b ) WGL_PROFILE_CONCAT_IMPL(a, b)
+
+#if !defined( WGL_DISABLE_PROFILER )
+   #define WGL_PROFILE_ZONE( name ) \
+      const ProfileZone WGL_PROFILE_CONCAT(wglProfileZone, __LINE__) ( name )
+   #define WGL_PROFILE_FRAME( ) Profiler::EndFrame()
+#else
+   #define WGL_PROFILE_ZONE( name ) ((void)0)
+   #define WGL_PROFILE_FRAME( ) ((void)0)
+#endif // !WGL_DISABLE_PROFILER
+
+#endif // _PROFILER_H_
@@ -6,12 +6,14 @@
 #include "Vector.h"
 #include "WglAssert.h"
 #include "MathHelper.h"
+#include "QuaternionKernels.h"
 
 // std includes
 #include <cmath>
 #include <limits>
 #include <cstdint>
 #include <utility>
+#include <type_traits>
 
 template < typename T >
 class Quaternion
@@ -20,33 +22,32 @@ public:
    // public typedefs
    typedef T type;
 
-   // constructor / destructor
-    Quaternion( );
+   // constructors
+   // the copy constructor, copy assignment and destructor are left to the
+   // compiler so the type stays trivially copyable
+    constexpr Quaternion( );
     template < typename U >
-    Quaternion( const U & x, const U & y, const U & z, const U & w );
-    Quaternion( const T & x, const T & y, const T & z, const T & w );
+    constexpr Quaternion( const U & x, const U & y, const U & z, const U & w );
+    constexpr Quaternion( const T & x, const T & y, const T & z, const T & w );
     template < typename U >
-    Quaternion( const Quaternion< U > & quat );
-    Quaternion( const Quaternion< T > & quat );
+    constexpr Quaternion( const Quaternion< U > & quat );
     template < typename U >
     Quaternion( const Matrix< U > & mat );
     Quaternion( const Matrix< T > & mat );
-   ~Quaternion( );
 
    // operator =
    template < typename U >
-   Quaternion< T > & operator = ( const Quaternion< U > & quat );
-   Quaternion< T > & operator = ( const Quaternion< T > & quat );
+   constexpr Quaternion< T > & operator = ( const Quaternion< U > & quat );
 
    // operator ==
    template < typename U >
-   bool operator == ( const Quaternion< U > & quat ) const;
-   bool operator == ( const Quaternion< T > & quat ) const;
+   constexpr bool operator == ( const Quaternion< U > & quat ) const;
+   constexpr bool operator == ( const Quaternion< T > & quat ) const;
 
    // operator !=
    template < typename U >
-   bool operator != ( const Quaternion< U > & quat ) const;
-   bool operator != ( const Quaternion< T > & quat ) const;
+   constexpr bool operator != ( const Quaternion< U > & quat ) const;
+   constexpr bool operator != ( const Quaternion< T > & quat ) const;
 
    // type cast operator from one quaternion type to another
    template < typename U >
@@ -77,23 +78,23 @@ public:
 
    // operator % (multiplication)
    template < typename U >
-   Quaternion< T > operator % ( const Quaternion< U > & quat ) const;
-   Quaternion< T > operator % ( const Quaternion< T > & quat ) const;
+   constexpr Quaternion< T > operator % ( const Quaternion< U > & quat ) const;
+   constexpr Quaternion< T > operator % ( const Quaternion< T > & quat ) const;
    template < typename U >
    Quaternion< T > & operator %= ( const Quaternion< U > & quat );
    Quaternion< T > & operator %= ( const Quaternion< T > & quat );
 
    template < typename U >
-   Quaternion< T > operator % ( const Vector< U, 3 > & vec ) const;
-   Quaternion< T > operator % ( const Vector< T, 3 > & vec ) const;
+   constexpr Quaternion< T > operator % ( const Vector< U, 3 > & vec ) const;
+   constexpr Quaternion< T > operator % ( const Vector< T, 3 > & vec ) const;
    template < typename U >
    Quaternion< T > & operator %= ( const Vector< U, 3 > & vec );
    Quaternion< T > & operator %= ( const Vector< T, 3 > & vec );
 
    // operator + (addition)
    template < typename U >
-   Quaternion< T > operator + ( const Quaternion< U > & quat ) const;
-   Quaternion< T > operator + ( const Quaternion< T > & quat ) const;
+   constexpr Quaternion< T > operator + ( const Quaternion< U > & quat ) const;
+   constexpr Quaternion< T > operator + ( const Quaternion< T > & quat ) const;
    template < typename U >
    Quaternion< T > & operator + ( const Quaternion< U > & quat );
    Quaternion< T > & operator + ( const Quaternion< T > & quat );
@@ -115,26 +116,26 @@ public:
    Quaternion< T > Rotate( const Quaternion< T > & quat );
 
    // basic access to the components
-   T & X( ) { return mT[0]; }
-   T & Y( ) { return mT[1]; }
-   T & Z( ) { return mT[2]; }
-   T & W( ) { return mT[3]; }
+   constexpr T & X( ) { return mT[0]; }
+   constexpr T & Y( ) { return mT[1]; }
+   constexpr T & Z( ) { return mT[2]; }
+   constexpr T & W( ) { return mT[3]; }
 
-   const T & X( ) const { return mT[0]; }
-   const T & Y( ) const { return mT[1]; }
-   const T & Z( ) const { return mT[2]; }
-   const T & W( ) const { return mT[3]; }
+   constexpr const T & X( ) const { return mT[0]; }
+   constexpr const T & Y( ) const { return mT[1]; }
+   constexpr const T & Z( ) const { return mT[2]; }
+   constexpr const T & W( ) const { return mT[3]; }
 
-   T RealPart( ) const { return mT[3]; }
-   Vector< T, 3 > ImaginaryPart( ) const { return Vector< T, 3 >(mT[0], mT[1], mT[2]); }
+   constexpr T RealPart( ) const { return mT[3]; }
+   constexpr Vector< T, 3 > ImaginaryPart( ) const { return Vector< T, 3 >(mT[0], mT[1], mT[2]); }
 
    // normalizes the quat
    Quaternion< T > & Normalize( );
    Quaternion< T > UnitQuaternion( ) const;
 
    // calculates the conjugate
-   Quaternion< T > & Conjugate( );
-   Quaternion< T > ConjugateQuaternion( ) const;
+   constexpr Quaternion< T > & Conjugate( );
+   constexpr Quaternion< T > ConjugateQuaternion( ) const;
 
    // calculates the inverse
    Quaternion< T > & Inverse( );
@@ -143,9 +144,19 @@ public:
    // calculates the length
    T Length( ) const
    {
-      return std::sqrt(mT[0] * mT[0] + mT[1] * mT[1] + mT[2] * mT[2] + mT[3] * mT[3]);
+      return std::sqrt(Dot(*this));
    }
 
+   // calculates the four component dot product
+   constexpr T Dot( const Quaternion< T > & quat ) const
+   {
+      return mT[0] * quat.mT[0] + mT[1] * quat.mT[1] + mT[2] * quat.mT[2] + mT[3] * quat.mT[3];
+   }
+
+   // calculates the log of a unit quat and the exp of a pure quat
+   Quaternion< T > Log( ) const;
+   Quaternion< T > Exp( ) const;
+
    // static helper function to convert matrix to quat
    static Quaternion< T > ToQuaternion( const Matrix< T > & mat );
 
@@ -155,57 +166,64 @@ public:
    static Quaternion< T > Rotation( const Vector< T, 3 > & origin, const Vector< T, 3 > & destination );
    static Quaternion< T > Rotation( const Vector< T, 4 > & origin, const Vector< T, 4 > & destination );
 
+   // static helper functions to interpolate between unit quats... slerp and
+   // nlerp take the shortest path, while squad expects the keys to already be
+   // in the same hemisphere as their neighbours (see SquadControlPoint)
+   static Quaternion< T > Slerp( const Quaternion< T > & from, const Quaternion< T > & to, const T & t );
+   static Quaternion< T > Nlerp( const Quaternion< T > & from, const Quaternion< T > & to, const T & t );
+   static Quaternion< T > Squad( const Quaternion< T > & from, const Quaternion< T > & from_control,
+                                 const Quaternion< T > & to_control, const Quaternion< T > & to, const T & t );
+
+   // static helper function to create the squad control point of a key
+   static Quaternion< T > SquadControlPoint( const Quaternion< T > & previous,
+                                             const Quaternion< T > & current,
+                                             const Quaternion< T > & next );
+
+   // static helper functions to interpolate count pairs of quats stored as
+   // separate x, y, z, w arrays, with one t per pair.  the batched slerp
+   // evaluates its weights as a polynomial instead of with acos and sin.
+   static void NlerpBatch( const T * const pFrom[4], const T * const pTo[4], const T * const pT,
+                           const size_t count, T * const pOut[4] );
+   static void SlerpBatch( const T * const pFrom[4], const T * const pTo[4], const T * const pT,
+                           const size_t count, T * const pOut[4] );
+
 private:
+   // other instantiations read the components when converting
+   template < typename > friend class Quaternion;
+
+   // slerp along the path given by the signs of the quats
+   static Quaternion< T > SlerpDirect( const Quaternion< T > & from, const Quaternion< T > & to, const T & t );
+
    // components that define the quat
    T     mT[4];
 
 };
 
 template < typename T >
-Quaternion< T >::Quaternion( )
+constexpr Quaternion< T >::Quaternion( ) :
+mT { 0, 0, 0, 1 }
 {
-   mT[0] = 0;
-   mT[1] = 0;
-   mT[2] = 0;
-   mT[3] = 1;
 }
 
 template < typename T >
 template < typename U >
-Quaternion< T >::Quaternion( const U & x, const U & y, const U & z, const U & w )
+constexpr Quaternion< T >::Quaternion( const U & x, const U & y, const U & z, const U & w ) :
+mT { static_cast< T >(x), static_cast< T >(y), static_cast< T >(z), static_cast< T >(w) }
 {
-   mT[0] = x;
-   mT[1] = y;
-   mT[2] = z;
-   mT[3] = w;
 }
 
 template < typename T >
-Quaternion< T >::Quaternion( const T & x, const T & y, const T & z, const T & w )
+constexpr Quaternion< T >::Quaternion( const T & x, const T & y, const T & z, const T & w ) :
+mT { x, y, z, w }
 {
-   mT[0] = x;
-   mT[1] = y;
-   mT[2] = z;
-   mT[3] = w;
 }
 
 template < typename T >
 template < typename U >
-Quaternion< T >::Quaternion( const Quaternion< U > & quat )
-{
-   mT[0] = quat.mT[0];
-   mT[1] = quat.mT[1];
-   mT[2] = quat.mT[2];
-   mT[3] = quat.mT[3];
-}
-
-template < typename T >
-Quaternion< T >::Quaternion( const Quaternion< T > & quat )
+constexpr Quaternion< T >::Quaternion( const Quaternion< U > & quat ) :
+mT { static_cast< T >(quat.mT[0]), static_cast< T >(quat.mT[1]),
+     static_cast< T >(quat.mT[2]), static_cast< T >(quat.mT[3]) }
 {
-   mT[0] = quat.mT[0];
-   mT[1] = quat.mT[1];
-   mT[2] = quat.mT[2];
-   mT[3] = quat.mT[3];
 }
 
 template < typename T >
@@ -231,37 +249,21 @@ Quaternion< T >::Quaternion( const Matrix< T > & mat )
    mT[3] = quat.mT[3];
 }
 
-template < typename T >
-Quaternion< T >::~Quaternion( )
-{
-}
-
 template < typename T >
 template < typename U >
-Quaternion< T > & Quaternion< T >::operator = ( const Quaternion< U > & quat )
-{
-   mT[0] = quat.mT[0];
-   mT[1] = quat.mT[1];
-   mT[2] = quat.mT[2];
-   mT[3] = quat.mT[3];
-
-   return *this;
-}
-
-template < typename T >
-Quaternion< T > & Quaternion< T >::operator = ( const Quaternion< T > & quat )
+constexpr Quaternion< T > & Quaternion< T >::operator = ( const Quaternion< U > & quat )
 {
-   mT[0] = quat.mT[0];
-   mT[1] = quat.mT[1];
-   mT[2] = quat.mT[2];
-   mT[3] = quat.mT[3];
+   mT[0] = static_cast< T >(quat.mT[0]);
+   mT[1] = static_cast< T >(quat.mT[1]);
+   mT[2] = static_cast< T >(quat.mT[2]);
+   mT[3] = static_cast< T >(quat.mT[3]);
 
    return *this;
 }
 
 template < typename T >
 template < typename U >
-bool Quaternion< T >::operator == ( const Quaternion< U > & quat ) const
+constexpr bool Quaternion< T >::operator == ( const Quaternion< U > & quat ) const
 {
    return mT[0] == quat.mT[0] &&
           mT[1] == quat.mT[1] &&
@@ -270,7 +272,7 @@ bool Quaternion< T >::operator == ( const Quaternion< U > & quat ) const
 }
 
 template < typename T >
-bool Quaternion< T >::operator == ( const Quaternion< T > & quat ) const
+constexpr bool Quaternion< T >::operator == ( const Quaternion< T > & quat ) const
 {
    return mT[0] == quat.mT[0] &&
           mT[1] == quat.mT[1] &&
@@ -280,7 +282,7 @@ bool Quaternion< T >::operator == ( const Quaternion< T > & quat ) const
 
 template < typename T >
 template < typename U >
-bool Quaternion< T >::operator != ( const Quaternion< U > & quat ) const
+constexpr bool Quaternion< T >::operator != ( const Quaternion< U > & quat ) const
 {
    return mT[0] != quat.mT[0] ||
           mT[1] != quat.mT[1] ||
@@ -289,7 +291,7 @@ bool Quaternion< T >::operator != ( const Quaternion< U > & quat ) const
 }
 
 template < typename T >
-bool Quaternion< T >::operator != ( const Quaternion< T > & quat ) const
+constexpr bool Quaternion< T >::operator != ( const Quaternion< T > & quat ) const
 {
    return mT[0] != quat.mT[0] ||
           mT[1] != quat.mT[1] ||
@@ -369,18 +371,18 @@ Quaternion< T > & Quaternion< T >::operator *= ( const Quaternion< T > & quat )
 
 template < typename T >
 template < typename U >
-Quaternion< T > Quaternion< T >::operator % ( const Quaternion< U > & quat ) const
+constexpr Quaternion< T > Quaternion< T >::operator % ( const Quaternion< U > & quat ) const
 {
    const T x = mT[3] * quat.mT[0] + mT[0] * quat.mT[3] + mT[1] * quat.mT[2] - mT[2] * quat.mT[1];
    const T y = mT[3] * quat.mT[1] - mT[0] * quat.mT[2] + mT[1] * quat.mT[3] + mT[2] * quat.mT[0];
-   const T z = mT[3] * quat.mT[2] + mT[1] * quat.mT[2] - mT[2] * quat.mT[1] + mT[2] * quat.mT[3];
+   const T z = mT[3] * quat.mT[2] + mT[0] * quat.mT[1] - mT[1] * quat.mT[0] + mT[2] * quat.mT[3];
    const T w = mT[3] * quat.mT[3] - mT[0] * quat.mT[0] - mT[1] * quat.mT[1] - mT[2] * quat.mT[2];
 
    return Quaternion< T >(x, y, z, w);
 }
 
 template < typename T >
-Quaternion< T > Quaternion< T >::operator % ( const Quaternion< T > & quat ) const
+constexpr Quaternion< T > Quaternion< T >::operator % ( const Quaternion< T > & quat ) const
 {
    const T x = mT[3] * quat.mT[0] + mT[0] * quat.mT[3] + mT[1] * quat.mT[2] - mT[2] * quat.mT[1];
    const T y = mT[3] * quat.mT[1] - mT[0] * quat.mT[2] + mT[1] * quat.mT[3] + mT[2] * quat.mT[0];
@@ -409,7 +411,7 @@ Quaternion< T > & Quaternion< T >::operator %= ( const Quaternion< T > & quat )
 
 template < typename T >
 template < typename U >
-Quaternion< T > Quaternion< T >::operator + ( const Quaternion< U > & quat ) const
+constexpr Quaternion< T > Quaternion< T >::operator + ( const Quaternion< U > & quat ) const
 {
    const T x = mT[0] + quat.mT[0];
    const T y = mT[1] + quat.mT[1];
@@ -420,7 +422,7 @@ Quaternion< T > Quaternion< T >::operator + ( const Quaternion< U > & quat ) con
 }
 
 template < typename T >
-Quaternion< T > Quaternion< T >::operator + ( const Quaternion< T > & quat ) const
+constexpr Quaternion< T > Quaternion< T >::operator + ( const Quaternion< T > & quat ) const
 {
    const T x = mT[0] + quat.mT[0];
    const T y = mT[1] + quat.mT[1];
@@ -449,23 +451,23 @@ Quaternion< T > & Quaternion< T >::operator + ( const Quaternion< T > & quat )
 
 template < typename T >
 template < typename U >
-Quaternion< T > Quaternion< T >::operator % ( const Vector< U, 3 > & vec ) const
+constexpr Quaternion< T > Quaternion< T >::operator % ( const Vector< U, 3 > & vec ) const
 {
-   T x =   mT[3] * vec.mT[0] + mT[1] * vec.mT[2] - mT[2] * vec.mT[1];
-   T y =   mT[3] * vec.mT[1] - mT[0] * vec.mT[2] + mT[2] * vec.mT[0];
-   T z =   mT[3] * vec.mT[2] + mT[0] * vec.mT[1] - mT[1] * vec.mT[0];
-   T w = - mT[0] * vec.mT[0] - mT[1] * vec.mT[1] - mT[2] * vec.mT[2];
+   const T x =   mT[3] * vec.mT[0] + mT[1] * vec.mT[2] - mT[2] * vec.mT[1];
+   const T y =   mT[3] * vec.mT[1] - mT[0] * vec.mT[2] + mT[2] * vec.mT[0];
+   const T z =   mT[3] * vec.mT[2] + mT[0] * vec.mT[1] - mT[1] * vec.mT[0];
+   const T w = - mT[0] * vec.mT[0] - mT[1] * vec.mT[1] - mT[2] * vec.mT[2];
 
    return Quaternion< T >(x, y, z, w);
 }
 
 template < typename T >
-Quaternion< T > Quaternion< T >::operator % ( const Vector< T, 3 > & vec ) const
+constexpr Quaternion< T > Quaternion< T >::operator % ( const Vector< T, 3 > & vec ) const
 {
-   T x =   mT[3] * vec.mT[0] + mT[1] * vec.mT[2] - mT[2] * vec.mT[1];
-   T y =   mT[3] * vec.mT[1] - mT[0] * vec.mT[2] + mT[2] * vec.mT[0];
-   T z =   mT[3] * vec.mT[2] + mT[0] * vec.mT[1] - mT[1] * vec.mT[0];
-   T w = - mT[0] * vec.mT[0] - mT[1] * vec.mT[1] - mT[2] * vec.mT[2];
+   const T x =   mT[3] * vec.mT[0] + mT[1] * vec.mT[2] - mT[2] * vec.mT[1];
+   const T y =   mT[3] * vec.mT[1] - mT[0] * vec.mT[2] + mT[2] * vec.mT[0];
+   const T z =   mT[3] * vec.mT[2] + mT[0] * vec.mT[1] - mT[1] * vec.mT[0];
+   const T w = - mT[0] * vec.mT[0] - mT[1] * vec.mT[1] - mT[2] * vec.mT[2];
 
    return Quaternion< T >(x, y, z, w);
 }
@@ -536,7 +538,7 @@ Quaternion< T > Quaternion< T >::UnitQuaternion( ) const
 }
 
 template < typename T >
-Quaternion< T > & Quaternion< T >::Conjugate( )
+constexpr Quaternion< T > & Quaternion< T >::Conjugate( )
 {
    mT[0] *= -1;
    mT[1] *= -1;
@@ -546,7 +548,7 @@ Quaternion< T > & Quaternion< T >::Conjugate( )
 }
 
 template < typename T >
-Quaternion< T > Quaternion< T >::ConjugateQuaternion( ) const
+constexpr Quaternion< T > Quaternion< T >::ConjugateQuaternion( ) const
 {
    Quaternion< T > quat(*this);
    quat.Conjugate();
@@ -576,6 +578,27 @@ Quaternion< T > Quaternion< T >::InverseQuaternion( ) const
    return quat;
 }
 
+template < typename T >
+Quaternion< T > Quaternion< T >::Log( ) const
+{
+   // q = (v * sin(theta), cos(theta)) -> log(q) = (v * theta, 0)
+   const T sin_theta = std::sqrt(mT[0] * mT[0] + mT[1] * mT[1] + mT[2] * mT[2]);
+   const T theta = std::atan2(sin_theta, mT[3]);
+   const T scale = sin_theta > std::numeric_limits< T >::epsilon() ? theta / sin_theta : static_cast< T >(1);
+
+   return Quaternion< T >(mT[0] * scale, mT[1] * scale, mT[2] * scale, static_cast< T >(0));
+}
+
+template < typename T >
+Quaternion< T > Quaternion< T >::Exp( ) const
+{
+   // q = (v * theta, 0) -> exp(q) = (v * sin(theta), cos(theta))
+   const T theta = std::sqrt(mT[0] * mT[0] + mT[1] * mT[1] + mT[2] * mT[2]);
+   const T scale = theta > std::numeric_limits< T >::epsilon() ? std::sin(theta) / theta : static_cast< T >(1);
+
+   return Quaternion< T >(mT[0] * scale, mT[1] * scale, mT[2] * scale, std::cos(theta));
+}
+
 template < typename T >
 Quaternion< T > Quaternion< T >::ToQuaternion( const Matrix< T > & mat )
 {
@@ -623,7 +646,7 @@ Quaternion< T > Quaternion< T >::ToQuaternion( const Matrix< T > & mat )
    switch (largest_index_and_value.first)
    {
    case W_IS_LARGEST:
-      quat.mT[3] = largest_index_and_value.second;
+      quat.mT[3] = largest_value;
       quat.mT[0] = (mat.mT[6] - mat.mT[9]) * mult;
       quat.mT[1] = (mat.mT[8] - mat.mT[2]) * mult;
       quat.mT[2] = (mat.mT[1] - mat.mT[4]) * mult;
@@ -632,7 +655,7 @@ Quaternion< T > Quaternion< T >::ToQuaternion( const Matrix< T > & mat )
 
    case X_IS_LARGEST:
       quat.mT[3] = (mat.mT[6] - mat.mT[9]) * mult;
-      quat.mT[0] = largest_index_and_value.second;
+      quat.mT[0] = largest_value;
       quat.mT[1] = (mat.mT[1] + mat.mT[4]) * mult;
       quat.mT[2] = (mat.mT[8] + mat.mT[2]) * mult;
 
@@ -641,7 +664,7 @@ Quaternion< T > Quaternion< T >::ToQuaternion( const Matrix< T > & mat )
    case Y_IS_LARGEST:
       quat.mT[3] = (mat.mT[8] - mat.mT[2]) * mult;
       quat.mT[0] = (mat.mT[1] + mat.mT[4]) * mult;
-      quat.mT[1] = largest_index_and_value.second;
+      quat.mT[1] = largest_value;
       quat.mT[2] = (mat.mT[6] + mat.mT[9]) * mult;
 
       break;
@@ -650,7 +673,7 @@ Quaternion< T > Quaternion< T >::ToQuaternion( const Matrix< T > & mat )
       quat.mT[3] = (mat.mT[1] - mat.mT[4]) * mult;
       quat.mT[0] = (mat.mT[8] + mat.mT[2]) * mult;
       quat.mT[1] = (mat.mT[6] + mat.mT[9]) * mult;
-      quat.mT[2] = largest_index_and_value.second;
+      quat.mT[2] = largest_value;
 
       break;
 
@@ -742,7 +765,105 @@ Quaternion< T > Quaternion< T >::Rotation( const Vector< T, 4 > & origin, const
    return Quaternion< T >::Rotation(Vector3< T >(origin), Vector3< T >(destination));
 }
 
+template < typename T >
+Quaternion< T > Quaternion< T >::Slerp( const Quaternion< T > & from, const Quaternion< T > & to, const T & t )
+{
+   // q and -q are the same rotation, so flip the destination
+   // into the hemisphere of the origin to take the shortest path
+   return from.Dot(to) < 0 ?
+      SlerpDirect(from, Quaternion< T >(-to.mT[0], -to.mT[1], -to.mT[2], -to.mT[3]), t) :
+      SlerpDirect(from, to, t);
+}
+
+template < typename T >
+Quaternion< T > Quaternion< T >::Nlerp( const Quaternion< T > & from, const Quaternion< T > & to, const T & t )
+{
+   const T w_from = static_cast< T >(1) - t;
+   const T w_to = from.Dot(to) < 0 ? -t : t;
+
+   return Quaternion< T >(from.mT[0] * w_from + to.mT[0] * w_to,
+                          from.mT[1] * w_from + to.mT[1] * w_to,
+                          from.mT[2] * w_from + to.mT[2] * w_to,
+                          from.mT[3] * w_from + to.mT[3] * w_to).Normalize();
+}
+
+template < typename T >
+Quaternion< T > Quaternion< T >::Squad( const Quaternion< T > & from, const Quaternion< T > & from_control,
+                                        const Quaternion< T > & to_control, const Quaternion< T > & to, const T & t )
+{
+   return SlerpDirect(SlerpDirect(from, to, t),
+                      SlerpDirect(from_control, to_control, t),
+                      static_cast< T >(2) * t * (static_cast< T >(1) - t));
+}
+
+template < typename T >
+Quaternion< T > Quaternion< T >::SquadControlPoint( const Quaternion< T > & previous,
+                                                    const Quaternion< T > & current,
+                                                    const Quaternion< T > & next )
+{
+   // s = q * exp(-(log(q' * next) + log(q' * previous)) / 4)
+   const Quaternion< T > inverse = current.ConjugateQuaternion();
+
+   const Quaternion< T > log_previous = (inverse % previous).Log();
+   const Quaternion< T > log_next = (inverse % next).Log();
+
+   const T scale = static_cast< T >(-0.25);
+
+   return current % Quaternion< T >((log_previous.mT[0] + log_next.mT[0]) * scale,
+                                    (log_previous.mT[1] + log_next.mT[1]) * scale,
+                                    (log_previous.mT[2] + log_next.mT[2]) * scale,
+                                    static_cast< T >(0)).Exp();
+}
+
+template < typename T >
+void Quaternion< T >::NlerpBatch( const T * const pFrom[4], const T * const pTo[4], const T * const pT,
+                                  const size_t count, T * const pOut[4] )
+{
+   details::QuaternionKernels< T >::Nlerp(pFrom, pTo, pT, count, pOut);
+}
+
+template < typename T >
+void Quaternion< T >::SlerpBatch( const T * const pFrom[4], const T * const pTo[4], const T * const pT,
+                                  const size_t count, T * const pOut[4] )
+{
+   details::QuaternionKernels< T >::Slerp(pFrom, pTo, pT, count, pOut);
+}
+
+template < typename T >
+Quaternion< T > Quaternion< T >::SlerpDirect( const Quaternion< T > & from, const Quaternion< T > & to, const T & t )
+{
+   const T cos_theta = from.Dot(to);
+
+   T w_from = static_cast< T >(1) - t;
+   T w_to = t;
+
+   // sin(theta) goes to zero at both ends, so use the linear weights there
+   if (std::abs(cos_theta) < static_cast< T >(1) - std::numeric_limits< T >::epsilon())
+   {
+      const T theta = std::acos(cos_theta);
+      const T one_over_sin_theta = static_cast< T >(1) / std::sin(theta);
+
+      w_from = std::sin(w_from * theta) * one_over_sin_theta;
+      w_to = std::sin(t * theta) * one_over_sin_theta;
+   }
+
+   return Quaternion< T >(from.mT[0] * w_from + to.mT[0] * w_to,
+                          from.mT[1] * w_from + to.mT[1] * w_to,
+                          from.mT[2] * w_from + to.mT[2] * w_to,
+                          from.mT[3] * w_from + to.mT[3] * w_to);
+}
+
 typedef Quaternion< float >  Quatf;
 typedef Quaternion< double > Quatd;
 
+// quats are stored in animation tracks and copied into uniform
+// blocks with memcpy, so they must remain plain data
+static_assert(std::is_trivially_copyable< Quatf >::value && std::is_standard_layout< Quatf >::value, "Quatf must be plain data");
+static_assert(std::is_trivially_copyable< Quatd >::value && std::is_standard_layout< Quatd >::value, "Quatd must be plain data");
+
+// constructors and the component operators are usable in constant expressions
+static_assert(Quatf() == Quatf(0.0f, 0.0f, 0.0f, 1.0f), "default quat is not the identity");
+static_assert((Quatd(0.0, 0.0, 1.0, 0.0) % Quatd(0.0, 0.0, 1.0, 0.0)).W() == -1.0, "quat product is not constexpr");
+static_assert(Quatf(Quatd(1.0, 2.0, 3.0, 4.0)).ConjugateQuaternion().Dot(Quatf(1.0f, 0.0f, 0.0f, 0.0f)) == -1.0f, "quat conversion is not constexpr");
+
 #endif // _QUATERNION_H_
@@ -0,0 +1,200 @@
+#ifndef _QUATERNION_KERNELS_H_
+#define _QUATERNION_KERNELS_H_
+
+// local includes
+#include "Simd.h"
+
+// std includes
+#include <cstddef>
+
+// the kernels interpolate pairs of quaternions stored as separate x, y,
+// z and w arrays, so four pairs fill one simd register per component.
+// every backend of simd::Vec4 runs the same code and the last partial
+// group is padded out to four lanes.
+namespace details
+{
+
+// number of terms used to evaluate the slerp weights and the scale of
+// the last term... the scale was found numerically to minimize the max
+// error of the weights over the whole [0, 1] x [0, 1] range of cos and t
+template < typename T > struct SlerpSeries;
+
+template < >
+struct SlerpSeries< float >
+{
+   // max weight error of 7.2e-7 at 180 degrees
+   static constexpr int TERMS = 12;
+   static constexpr double ONE_PLUS_MU = 1.893716;
+};
+
+template < >
+struct SlerpSeries< double >
+{
+   // max weight error of 3.5e-12 at 180 degrees and round off below 120 degrees
+   static constexpr int TERMS = 28;
+   static constexpr double ONE_PLUS_MU = 1.949347;
+};
+
+template < typename T >
+class QuaternionKernels
+{
+public:
+   // out = nlerp(from, to, t) for count pairs of quats
+   static void Nlerp( const T * const pFrom[4], const T * const pTo[4], const T * const pT,
+                      const size_t count, T * const pOut[4] )
+   {
+      Interpolate(pFrom, pTo, pT, count, pOut, Nlerp4);
+   }
+
+   // out = slerp(from, to, t) for count pairs of unit quats
+   static void Slerp( const T * const pFrom[4], const T * const pTo[4], const T * const pT,
+                      const size_t count, T * const pOut[4] )
+   {
+      const SlerpCoefficients coefficients;
+
+      Interpolate(pFrom, pTo, pT, count, pOut,
+      [ & ] ( const V from[4], const V to[4], const V & t, V out[4] )
+      {
+         Slerp4(coefficients, from, to, t, out);
+      });
+   }
+
+private:
+   typedef simd::Vec4< T > V;
+
+   // terms of the slerp weight series, splatted once per batch
+   struct SlerpCoefficients
+   {
+      SlerpCoefficients( )
+      {
+         for (int i = 1; i <= SlerpSeries< T >::TERMS; ++i)
+         {
+            const double scale = i == SlerpSeries< T >::TERMS ? SlerpSeries< T >::ONE_PLUS_MU : 1.0;
+
+            mU[i - 1] = V::Splat(static_cast< T >(scale / (i * (2 * i + 1))));
+            mV[i - 1] = V::Splat(static_cast< T >(scale * i / (2 * i + 1)));
+         }
+      }
+
+      V  mU[SlerpSeries< T >::TERMS];
+      V  mV[SlerpSeries< T >::TERMS];
+   };
+
+   // both take the shortest path by flipping the sign of the weight
+   // of the destination if the quats are in opposite hemispheres
+   static void Nlerp4( const V from[4], const V to[4], const V & t, V out[4] )
+   {
+      const V one = V::Splat(T(1));
+
+      const V cos_theta = from[0] * to[0] + from[1] * to[1] + from[2] * to[2] + from[3] * to[3];
+
+      const V w_from = one - t;
+      const V w_to = V::CopySign(t, cos_theta);
+
+      V lerp[4];
+      for (int i = 0; i < 4; ++i) lerp[i] = from[i] * w_from + to[i] * w_to;
+
+      const V one_over_length =
+         one / V::Sqrt(lerp[0] * lerp[0] + lerp[1] * lerp[1] + lerp[2] * lerp[2] + lerp[3] * lerp[3]);
+
+      for (int i = 0; i < 4; ++i) out[i] = lerp[i] * one_over_length;
+   }
+
+   // the weights sin((1 - t) * theta) / sin(theta) and sin(t * theta) / sin(theta)
+   // are evaluated as a polynomial in cos(theta), which avoids any acos and sin
+   // and stays accurate as theta goes to zero.  see eberly, a fast and accurate
+   // algorithm for computing slerp.
+   static void Slerp4( const SlerpCoefficients & coefficients,
+                       const V from[4], const V to[4], const V & t, V out[4] )
+   {
+      const V one = V::Splat(T(1));
+
+      const V dot = from[0] * to[0] + from[1] * to[1] + from[2] * to[2] + from[3] * to[3];
+      const V sign = V::CopySign(one, dot);
+      const V cos_theta_minus_one = dot * sign - one;
+
+      const V d = one - t;
+      const V t_squared = t * t;
+      const V d_squared = d * d;
+
+      V series_t = one;
+      V series_d = one;
+
+      for (int i = SlerpSeries< T >::TERMS - 1; i >= 0; --i)
+      {
+         const V & u = coefficients.mU[i];
+         const V & v = coefficients.mV[i];
+
+         series_t = one + (u * t_squared - v) * cos_theta_minus_one * series_t;
+         series_d = one + (u * d_squared - v) * cos_theta_minus_one * series_d;
+      }
+
+      const V w_from = d * series_d;
+      const V w_to = sign * t * series_t;
+
+      for (int i = 0; i < 4; ++i) out[i] = from[i] * w_from + to[i] * w_to;
+   }
+
+   template < typename Kernel >
+   static void Interpolate( const T * const pFrom[4], const T * const pTo[4], const T * const pT,
+                            const size_t count, T * const pOut[4], Kernel kernel )
+   {
+      V from[4], to[4], out[4];
+
+      size_t i = 0;
+
+      for (; i + 4 <= count; i += 4)
+      {
+         for (int c = 0; c < 4; ++c)
+         {
+            from[c] = V::Load(pFrom[c] + i);
+            to[c] = V::Load(pTo[c] + i);
+         }
+
+         kernel(from, to, V::Load(pT + i), out);
+
+         for (int c = 0; c < 4; ++c) out[c].Store(pOut[c] + i);
+      }
+
+      if (i < count)
+      {
+         // pad the remaining pairs with identity quats
+         const size_t remaining = count - i;
+
+         T from_t[4][4] = { }, to_t[4][4] = { }, t_t[4] = { }, out_t[4][4];
+
+         for (int l = 0; l < 4; ++l) from_t[3][l] = to_t[3][l] = T(1);
+
+         for (size_t l = 0; l < remaining; ++l)
+         {
+            for (int c = 0; c < 4; ++c)
+            {
+               from_t[c][l] = pFrom[c][i + l];
+               to_t[c][l] = pTo[c][i + l];
+            }
+
+            t_t[l] = pT[i + l];
+         }
+
+         for (int c = 0; c < 4; ++c)
+         {
+            from[c] = V::Load(from_t[c]);
+            to[c] = V::Load(to_t[c]);
+         }
+
+         kernel(from, to, V::Load(t_t), out);
+
+         for (int c = 0; c < 4; ++c)
+         {
+            out[c].Store(out_t[c]);
+
+            for (size_t l = 0; l < remaining; ++l) pOut[c][i + l] = out_t[c][l];
+         }
+      }
+   }
+
+};
+
+} // namespace details
+
+#endif // _QUATERNION_KERNELS_H_
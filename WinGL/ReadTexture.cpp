@@ -1,8 +1,10 @@
 // local includes
 #include "ReadTexture.h"
+#include "SgiImage.h"
 #include "WglAssert.h"
 
 // std includes
+#include <mutex>
 #include <string>
 #include <cstring>
 #include <cstdlib>
@@ -13,6 +15,10 @@
 namespace details
 {
 
+// resil decodes into the bound image, which is global state,
+// so only one thread at a time may work with it
+std::mutex resil_mutex;
+
 // called to shutdown resil
 void ShutdownResIL( )
 {
@@ -81,38 +87,68 @@ template < > struct il_type< uint16_t > { static const ILenum type = IL_UNSIGNED
 template < > struct il_type< uint32_t > { static const ILenum type = IL_UNSIGNED_INT; };
 template < > struct il_type< float > { static const ILenum type = IL_FLOAT; };
 
-template < typename T >
-bool ReadTexture( const char * const pFilename,
-                  const GLenum format,
-                  uint32_t & width,
-                  uint32_t & height,
-                  std::shared_ptr< T > & pTexBuffer )
+namespace details
 {
-   // image library should be good to go
-   WGL_ASSERT(details::resil_inited);
 
-   bool read = false;
+// converts the gl format to the resil format
+ILenum GetILFormat( const GLenum format )
+{
+   ILenum il_format = IL_FORMAT_NOT_SUPPORTED;
 
-   // is the format supported???
-   const ILenum il_format = [ &format ] ( ) -> ILenum
+   switch (format)
    {
-      ILenum il_format = IL_FORMAT_NOT_SUPPORTED;
+   // case GL_ALPHA: il_format = IL_ALPHA;   break; << this is broken in resil
+   case GL_RGB:   il_format = IL_RGB;     break;
+   case GL_RGBA:  il_format = IL_RGBA;    break;
+   case GL_BGR:   il_format = IL_BGR;     break;
+   case GL_BGRA:  il_format = IL_BGRA;    break;
+   default: il_format = IL_FORMAT_NOT_SUPPORTED; break;
+   }
 
-      switch (format)
-      {
-      // case GL_ALPHA: il_format = IL_ALPHA;   break; << this is broken in resil
-      case GL_RGB:   il_format = IL_RGB;     break;
-      case GL_RGBA:  il_format = IL_RGBA;    break;
-      case GL_BGR:   il_format = IL_BGR;     break;
-      case GL_BGRA:  il_format = IL_BGRA;    break;
-      default: il_format = IL_FORMAT_NOT_SUPPORTED; break;
-      }
+   return il_format;
+}
+
+// determines the number of components per pixel
+uint32_t GetBpp( const GLenum format )
+{
+   uint32_t Bpp = 0;
+
+   switch (format)
+   {
+   case GL_ALPHA: Bpp = 1; break;
+   case GL_RGB:   Bpp = 3; break;
+   case GL_RGBA:  Bpp = 4; break;
+   case GL_BGR:   Bpp = 3; break;
+   case GL_BGRA:  Bpp = 4; break;
+   default:       Bpp = 0; break;
+   }
+
+   return Bpp;
+}
+
+// decodes the image that load brings into the bound resil image and copies
+// its pixels into a buffer from allocate.  holds resil for the whole decode.
+template < typename T, typename Load >
+bool ReadImage( const GLenum format,
+                const Load & load,
+                uint32_t & width,
+                uint32_t & height,
+                const std::function< std::shared_ptr< T > ( const size_t ) > & allocate,
+                std::shared_ptr< T > & pTexBuffer )
+{
+   // image library should be good to go
+   WGL_ASSERT(resil_inited);
 
-      return il_format;
-   }();
+   bool read = false;
 
-   if (il_format != IL_FORMAT_NOT_SUPPORTED)
+   // is the format supported???
+   const ILenum il_format = GetILFormat(format);
+   const uint32_t Bpp = GetBpp(format);
+
+   if (il_format != IL_FORMAT_NOT_SUPPORTED && Bpp)
    {
+      std::lock_guard< std::mutex > lock(resil_mutex);
+
       // create an image handle for reading
       const ILuint image_handle = ilGenImage();
 
@@ -120,36 +156,17 @@ bool ReadTexture( const char * const pFilename,
       ilBindImage(image_handle);
 
       // try to load the image
-      if (const ILboolean image_loaded =
-          ilLoadImage(std::wstring(pFilename, pFilename + std::strlen(pFilename)).c_str()))
+      if (load())
       {
          // get the width and height of the image
          width = static_cast< uint32_t >(ilGetInteger(IL_IMAGE_WIDTH));
          height = static_cast< uint32_t >(ilGetInteger(IL_IMAGE_HEIGHT));
 
-         // determine the number of bytes per pixel
-         const uint32_t Bpp = [ &format ] ( ) -> uint32_t
-         {
-            uint32_t Bpp = 0;
-
-            switch (format)
-            {
-            case GL_ALPHA: Bpp = 1; break;
-            case GL_RGB:   Bpp = 3; break;
-            case GL_RGBA:  Bpp = 4; break;
-            case GL_BGR:   Bpp = 3; break;
-            case GL_BGRA:  Bpp = 4; break;
-            default:       Bpp = 0; break;
-            }
-
-            return Bpp;
-         }();
-
-         if (Bpp)
-         {
-            // create buffer large enough to hold texture
-            pTexBuffer.reset(new T[width * height * Bpp]);
+         // obtain a buffer large enough to hold texture
+         pTexBuffer = allocate(width * height * Bpp);
 
+         if (pTexBuffer)
+         {
             // copy the data into the buffer
             ilCopyPixels(0, 0, 0, width, height, 1, il_format, il_type< T >::type, pTexBuffer.get());
 
@@ -165,7 +182,128 @@ bool ReadTexture( const char * const pFilename,
    return read;
 }
 
+// converts the gl format to the order the sgi reader interleaves into
+bool GetSgiLayout( const GLenum format, SgiImage::Layout & layout )
+{
+   switch (format)
+   {
+   case GL_RGB:   layout = SgiImage::Layout::RGB;  return true;
+   case GL_RGBA:  layout = SgiImage::Layout::RGBA; return true;
+   case GL_BGR:   layout = SgiImage::Layout::BGR;  return true;
+   case GL_BGRA:  layout = SgiImage::Layout::BGRA; return true;
+   default: return false;
+   }
+}
+
+// sgi images of 8 bit channels are mapped and decoded without resil, which
+// also frees the other readers from waiting on the resil lock.  other types
+// are still left to resil.
+template < typename T >
+bool ReadSgiImage( const char * const, const GLenum, uint32_t &, uint32_t &, std::shared_ptr< T > & )
+{
+   return false;
+}
+
+template < >
+bool ReadSgiImage< uint8_t >( const char * const pFilename,
+                              const GLenum format,
+                              uint32_t & width,
+                              uint32_t & height,
+                              std::shared_ptr< uint8_t > & pTexBuffer )
+{
+   SgiImage::Layout layout = SgiImage::Layout::RGBA;
+
+   return
+      SgiImage::IsSgiFilename(pFilename) &&
+      GetSgiLayout(format, layout) &&
+      SgiImage::Read(pFilename, layout, width, height, pTexBuffer);
+}
+
+template < typename T >
+bool ReadSgiImage( const void * const, const size_t, const GLenum, uint32_t &, uint32_t &,
+                   const std::function< std::shared_ptr< T > ( const size_t ) > &, std::shared_ptr< T > & )
+{
+   return false;
+}
+
+template < >
+bool ReadSgiImage< uint8_t >( const void * const pFile,
+                              const size_t size,
+                              const GLenum format,
+                              uint32_t & width,
+                              uint32_t & height,
+                              const std::function< std::shared_ptr< uint8_t > ( const size_t ) > & allocate,
+                              std::shared_ptr< uint8_t > & pTexBuffer )
+{
+   SgiImage::Layout layout = SgiImage::Layout::RGBA;
+
+   return
+      SgiImage::IsSgiImage(pFile, size) &&
+      GetSgiLayout(format, layout) &&
+      SgiImage::Read(pFile, size, layout, width, height, allocate, pTexBuffer);
+}
+
+} // namespace details
+
+template < typename T >
+bool ReadTexture( const char * const pFilename,
+                  const GLenum format,
+                  uint32_t & width,
+                  uint32_t & height,
+                  std::shared_ptr< T > & pTexBuffer )
+{
+   if (details::ReadSgiImage< T >(pFilename, format, width, height, pTexBuffer))
+   {
+      return true;
+   }
+
+   const std::wstring filename(pFilename, pFilename + std::strlen(pFilename));
+
+   return details::ReadImage< T >(format,
+      [ &filename ] ( ) { return ilLoadImage(filename.c_str()) != IL_FALSE; },
+      width, height,
+      [ ] ( const size_t size ) { return std::shared_ptr< T >(new T[size], std::default_delete< T[] >()); },
+      pTexBuffer);
+}
+
+template < typename T >
+bool ReadTexture( const char * const pFilename,
+                  const void * const pFile,
+                  const size_t size,
+                  const GLenum format,
+                  uint32_t & width,
+                  uint32_t & height,
+                  const std::function< std::shared_ptr< T > ( const size_t ) > & allocate,
+                  std::shared_ptr< T > & pTexBuffer )
+{
+   if (details::ReadSgiImage< T >(pFile, size, format, width, height, allocate, pTexBuffer))
+   {
+      return true;
+   }
+
+   const std::wstring filename(pFilename, pFilename + std::strlen(pFilename));
+
+   return details::ReadImage< T >(format,
+      [ & ] ( ) -> bool
+      {
+         // images like targa have no signature, so go by the name first
+         ILenum type = ilTypeFromExt(filename.c_str());
+
+         if (type == IL_TYPE_UNKNOWN)
+         {
+            type = ilDetermineTypeL(pFile, static_cast< ILuint >(size));
+         }
+
+         return ilLoadL(type, pFile, static_cast< ILuint >(size)) != IL_FALSE;
+      },
+      width, height, allocate, pTexBuffer);
+}
+
 template bool ReadTexture< uint8_t >( const char * const, const GLenum, uint32_t &, uint32_t &, std::shared_ptr< uint8_t > & );
 template bool ReadTexture< uint16_t >( const char * const, const GLenum, uint32_t &, uint32_t &, std::shared_ptr< uint16_t > & );
 template bool ReadTexture< uint32_t >( const char * const, const GLenum, uint32_t &, uint32_t &, std::shared_ptr< uint32_t > & );
 template bool ReadTexture< float >( const char * const, const GLenum, uint32_t &, uint32_t &, std::shared_ptr< float > & );
+template bool ReadTexture< uint8_t >( const char * const, const void * const, const size_t, const GLenum, uint32_t &, uint32_t &, const std::function< std::shared_ptr< uint8_t > ( const size_t ) > &, std::shared_ptr< uint8_t > & );
+template bool ReadTexture< uint16_t >( const char * const, const void * const, const size_t, const GLenum, uint32_t &, uint32_t &, const std::function< std::shared_ptr< uint16_t > ( const size_t ) > &, std::shared_ptr< uint16_t > & );
+template bool ReadTexture< uint32_t >( const char * const, const void * const, const size_t, const GLenum, uint32_t &, uint32_t &, const std::function< std::shared_ptr< uint32_t > ( const size_t ) > &, std::shared_ptr< uint32_t > & );
+template bool ReadTexture< float >( const char * const, const void * const, const size_t, const GLenum, uint32_t &, uint32_t &, const std::function< std::shared_ptr< float > ( const size_t ) > &, std::shared_ptr< float > & );
@@ -10,7 +10,9 @@
 
 // std includes
 #include <memory>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 
 // reads a rgb / rgba file
 // assumes RGBA and UNSIGNED BYTE
@@ -27,6 +29,7 @@ bool ReadTexture( const char * const pFilename,
                   std::shared_ptr< uint8_t > & pTexBuffer );
 
 // reads a texture file
+// the readers may be called from any thread, but resil only decodes one image at a time
 template < typename T >
 bool ReadTexture( const char * const pFilename,
                   const GLenum format,
@@ -34,6 +37,19 @@ bool ReadTexture( const char * const pFilename,
                   uint32_t & height,
                   std::shared_ptr< T > & pTexBuffer );
 
+// reads a texture from the contents of a file already in memory...
+// the filename is only used to determine the type of the image.  the pixels
+// are placed in a buffer from allocate, which is passed the number of T needed.
+template < typename T >
+bool ReadTexture( const char * const pFilename,
+                  const void * const pFile,
+                  const size_t size,
+                  const GLenum format,
+                  uint32_t & width,
+                  uint32_t & height,
+                  const std::function< std::shared_ptr< T > ( const size_t ) > & allocate,
+                  std::shared_ptr< T > & pTexBuffer );
+
 template < typename T >
 struct TextureData
 {
@@ -1,176 +1,797 @@
 #ifndef _REUSE_ALLOCATOR_H_
 #define _REUSE_ALLOCATOR_H_
 
-#ifdef _DEBUG
-#define VALIDATE_EQUAL_TO_ONE( val ) \
-   if ((val) != 1) *((int *)(0x0)) = 0;
-#else
-#define VALIDATE_EQUAL_TO_ONE( val )
-#endif
-
-template < typename T >
+// wgl includes
+#include "WglAssert.h"
+
+// std includes
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// statistics for all the reuse allocators in the process
+struct ReuseAllocatorStats
+{
+   // blocks handed out by the pools... this includes the
+   // blocks sitting in the per thread caches
+   size_t   live_blocks;
+   size_t   live_bytes;
+
+   // sum of the high water marks of each size class
+   size_t   peak_blocks;
+   size_t   peak_bytes;
+
+   // slabs currently held by the pools
+   size_t   slabs;
+
+   // allocations too large for the pools that went to operator new
+   size_t   large_allocations;
+   size_t   large_bytes;
+};
+
+namespace details
+{
+
+// a block that is not in use links to the next free block
+struct ReuseFreeBlock
+{
+   ReuseFreeBlock *  pNext;
+};
+
+// pool of blocks of a single size.  blocks are carved out of slabs that are
+// aligned to their own size, so the slab that owns a block is found by masking
+// the address of the block.  only the slabs that still have free blocks are
+// kept in a list.  when a slab becomes completely free it is returned to the
+// system, unless it is the only free slab, which is kept to absorb churn.
+class ReusePool
+{
+public:
+   // size and alignment of each slab
+   static constexpr size_t SLAB_SIZE = 64 * 1024;
+
+   // alignment of every block handed out
+   static constexpr size_t BLOCK_ALIGNMENT = 16;
+
+   // constructor
+   explicit ReusePool( const size_t block_size );
+
+   // allocates / releases a single block
+   void *   Allocate( );
+   void     Deallocate( void * const pBlock );
+
+   // allocates count blocks linked through their first word /
+   // releases a chain of blocks terminated by a null link
+   ReuseFreeBlock *  AllocateChain( const size_t count );
+   void              DeallocateChain( ReuseFreeBlock * pChain );
+
+   // returns the completely free slab to the system
+   void  Trim( );
+
+   // adds the pool statistics to stats
+   void  AccumulateStats( ReuseAllocatorStats & stats );
+
+   // size of each block
+   size_t   BlockSize( ) const { return mBlockSize; }
+
+private:
+   // prohibit copy constructor / copy operator
+   ReusePool( const ReusePool & );
+   ReusePool & operator = ( const ReusePool & );
+
+   // header placed at the start of each slab
+   struct Slab
+   {
+      // links into the list of slabs with free blocks
+      Slab *            pPrev;
+      Slab *            pNext;
+
+      // blocks released back to the slab
+      ReuseFreeBlock *  pFree;
+
+      // start of the blocks that have never been handed out
+      char *            pUnused;
+
+      // number of blocks handed out
+      size_t            live;
+   };
+
+   // size of the header rounded up to the block alignment
+   static constexpr size_t HEADER_SIZE =
+      (sizeof(Slab) + BLOCK_ALIGNMENT - 1) & ~(BLOCK_ALIGNMENT - 1);
+
+   // the pool mutex must be held for all of the following
+   void *   AllocateLocked( );
+   void     DeallocateLocked( void * const pBlock );
+
+   void     AddSlab( );
+   void     ReleaseSlab( Slab * const pSlab );
+
+   void     PushFront( Slab * const pSlab );
+   void     PushBack( Slab * const pSlab );
+   void     Unlink( Slab * const pSlab );
+
+   static Slab *  SlabOf( void * const pBlock );
+
+   // guards all the members below
+   std::mutex  mMutex;
+
+   // block layout
+   const size_t   mBlockSize;
+   const size_t   mBlocksPerSlab;
+
+   // slabs with free blocks... the completely
+   // free slab, if there is one, is at the back
+   Slab *   mpFront;
+   Slab *   mpBack;
+
+   // statistics
+   size_t   mEmptySlabs;
+   size_t   mSlabs;
+   size_t   mLiveBlocks;
+   size_t   mPeakBlocks;
+
+};
+
+// the collection of pools, one per size class
+class ReusePools
+{
+public:
+   // number of size classes and the largest pooled request...
+   // anything larger, or with stricter alignment, goes to operator new
+   static constexpr size_t NUM_SIZE_CLASSES = 12;
+   static constexpr size_t MAX_POOLED_SIZE = 1024;
+
+   // block size of each size class
+   static constexpr size_t BLOCK_SIZES[NUM_SIZE_CLASSES] =
+   {
+      16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, MAX_POOLED_SIZE
+   };
+
+   // access to the process wide pools
+   static ReusePools & Instance( );
+
+   // returns true if the request is served by the pools
+   static constexpr bool IsPooled( const size_t bytes, const size_t alignment );
+
+   // maps the requested size to its size class
+   static size_t SizeClass( const size_t bytes );
+
+   // returns the pool for the size class
+   ReusePool & Pool( const size_t size_class ) { return *reinterpret_cast< ReusePool * >(mPools + size_class * sizeof(ReusePool)); }
+
+   // allocations that bypass the pools
+   void *   AllocateLarge( const size_t bytes, const size_t alignment );
+   void     DeallocateLarge( void * const pMemory, const size_t bytes, const size_t alignment );
+
+   // returns the completely free slabs of every pool to the system
+   void  Trim( );
+
+   // returns the statistics for all the pools
+   ReuseAllocatorStats  Stats( );
+
+private:
+   // constructor
+   ReusePools( );
+
+   // prohibit copy constructor / copy operator
+   ReusePools( const ReusePools & );
+   ReusePools & operator = ( const ReusePools & );
+
+   // storage for the pools
+   alignas(ReusePool) unsigned char mPools[sizeof(ReusePool) * NUM_SIZE_CLASSES];
+
+   // large allocation statistics
+   std::atomic< size_t >   mLargeAllocations;
+   std::atomic< size_t >   mLargeBytes;
+
+};
+
+// per thread cache of blocks for each size class.  blocks move between
+// the cache and the pools in batches, so the pool mutex is taken once
+// per batch instead of once per allocation.
+class ReuseThreadCache
+{
+public:
+   // access to the cache of the calling thread
+   static ReuseThreadCache & Instance( );
+
+   // indicates if the cache of the calling thread has not been destroyed...
+   // the caches of the main thread are destroyed before its static objects,
+   // so their containers must go straight to the pools once this is false
+   static bool IsAlive( ) { return AliveFlag(); }
+
+   // allocates / releases a block of the size class
+   void *   Allocate( const size_t size_class );
+   void     Deallocate( const size_t size_class, void * const pBlock );
+
+   // returns all the cached blocks to the pools
+   void     Flush( );
+
+   // destructor
+   ~ReuseThreadCache( );
+
+private:
+   // number of blocks moved between the cache and a pool at once...
+   // a size class holds at most twice this many blocks
+   static constexpr size_t BATCH_SIZE = 32;
+
+   // constructor
+   ReuseThreadCache( );
+
+   // the flag of the calling thread cleared by the destructor, which has
+   // no destructor of its own so it can be read until the thread is gone
+   static bool & AliveFlag( );
+
+   // prohibit copy constructor / copy operator
+   ReuseThreadCache( const ReuseThreadCache & );
+   ReuseThreadCache & operator = ( const ReuseThreadCache & );
+
+   // cached blocks of each size class
+   ReuseFreeBlock *  mpBlocks[ReusePools::NUM_SIZE_CLASSES];
+   size_t            mCount[ReusePools::NUM_SIZE_CLASSES];
+
+};
+
+} // namespace details
+
+// allocator that serves node based containers (list, map, unordered_map)
+// from pools of fixed size blocks.  requests of any count are rounded up
+// to a size class, so array allocations like hash buckets are supported.
+// all the allocators share the process wide pools, so they always compare
+// equal and are safe to use from multiple threads.  THREAD_CACHE puts a
+// small cache of blocks in front of the pools for each thread, which
+// removes most of the locking at the cost of blocks parked in the caches.
+// once the cache of a thread is destroyed, its allocations go straight to
+// the pools, so containers in static objects can still free their nodes.
+template < typename T, bool THREAD_CACHE = false >
 class ReuseAllocator
 {
 public:
    // public typedefs
    typedef T                     value_type;
-   typedef int                   difference_type;
+   typedef ptrdiff_t             difference_type;
    typedef size_t                size_type;
    typedef value_type &          reference;
    typedef value_type *          pointer;
    typedef const value_type &    const_reference;
    typedef const value_type *    const_pointer;
 
+   // the allocators have no state
+   typedef std::true_type        is_always_equal;
+   typedef std::true_type        propagate_on_container_move_assignment;
+
    // public structures
    template < typename O >
    struct rebind
    {
-      typedef ReuseAllocator< O > other;
+      typedef ReuseAllocator< O, THREAD_CACHE > other;
    };
 
-   // constructor / destructor
-    ReuseAllocator( );
-    ReuseAllocator( const ReuseAllocator & allocator );
-   ~ReuseAllocator( );
+   // constructor
+    ReuseAllocator( ) noexcept { }
 
    // special constructor
    template < typename O >
-   ReuseAllocator( const ReuseAllocator< O > & allocator );
-
-   // copy operator 
-   template < typename O >
-   ReuseAllocator< T > & operator = ( const ReuseAllocator< O > & other );
+   ReuseAllocator( const ReuseAllocator< O, THREAD_CACHE > & /*allocator*/ ) noexcept { }
 
    // allocates memory
-   pointer allocate( size_type count, const void * hint = 0);
-
-   // construct object
-   void construct( pointer ptr, const_reference val );
-
-   // destroy object
-   void destroy( pointer ptr );
+   pointer allocate( size_type count, const void * hint = 0 );
 
    // deallocates memory
    void deallocate( pointer ptr, size_type count );
 
    // maximum size
-   size_type max_size( ) const;
+   size_type max_size( ) const noexcept;
 
-private:
-   // private member variables
-   void *      _front;
+   // returns the statistics for all the pools
+   static ReuseAllocatorStats Stats( );
+
+   // returns the blocks cached by the calling thread and
+   // the completely free slabs of all pools to the system
+   static void Trim( );
 
 };
 
-template < typename T >
-ReuseAllocator< T >::ReuseAllocator( ) :
-_front   ( 0 )
+template < typename T, typename U, bool THREAD_CACHE >
+inline bool operator == ( const ReuseAllocator< T, THREAD_CACHE > &, const ReuseAllocator< U, THREAD_CACHE > & )
+{
+   return true;
+}
+
+template < typename T, typename U, bool THREAD_CACHE >
+inline bool operator != ( const ReuseAllocator< T, THREAD_CACHE > &, const ReuseAllocator< U, THREAD_CACHE > & )
+{
+   return false;
+}
+
+template < typename T, bool THREAD_CACHE >
+inline typename ReuseAllocator< T, THREAD_CACHE >::pointer
+ReuseAllocator< T, THREAD_CACHE >::allocate( size_type count, const void * /*hint*/ )
+{
+   if (count > max_size())
+   {
+      throw std::bad_array_new_length();
+   }
+
+   const size_t bytes = count * sizeof(T);
+
+   if (details::ReusePools::IsPooled(bytes, alignof(T)))
+   {
+      const size_t size_class = details::ReusePools::SizeClass(bytes);
+
+      if constexpr (THREAD_CACHE)
+      {
+         if (details::ReuseThreadCache::IsAlive())
+         {
+            return static_cast< pointer >(details::ReuseThreadCache::Instance().Allocate(size_class));
+         }
+      }
+
+      return static_cast< pointer >(details::ReusePools::Instance().Pool(size_class).Allocate());
+   }
+
+   return static_cast< pointer >(details::ReusePools::Instance().AllocateLarge(bytes, alignof(T)));
+}
+
+template < typename T, bool THREAD_CACHE >
+inline void ReuseAllocator< T, THREAD_CACHE >::deallocate( pointer ptr, size_type count )
+{
+   const size_t bytes = count * sizeof(T);
+
+   if (details::ReusePools::IsPooled(bytes, alignof(T)))
+   {
+      const size_t size_class = details::ReusePools::SizeClass(bytes);
+
+      if constexpr (THREAD_CACHE)
+      {
+         if (details::ReuseThreadCache::IsAlive())
+         {
+            details::ReuseThreadCache::Instance().Deallocate(size_class, ptr);
+
+            return;
+         }
+      }
+
+      details::ReusePools::Instance().Pool(size_class).Deallocate(ptr);
+   }
+   else
+   {
+      details::ReusePools::Instance().DeallocateLarge(ptr, bytes, alignof(T));
+   }
+}
+
+template < typename T, bool THREAD_CACHE >
+inline typename ReuseAllocator< T, THREAD_CACHE >::size_type
+ReuseAllocator< T, THREAD_CACHE >::max_size( ) const noexcept
+{
+   return std::numeric_limits< size_type >::max() / sizeof(T);
+}
+
+template < typename T, bool THREAD_CACHE >
+inline ReuseAllocatorStats ReuseAllocator< T, THREAD_CACHE >::Stats( )
+{
+   return details::ReusePools::Instance().Stats();
+}
+
+template < typename T, bool THREAD_CACHE >
+inline void ReuseAllocator< T, THREAD_CACHE >::Trim( )
+{
+   if (details::ReuseThreadCache::IsAlive())
+   {
+      details::ReuseThreadCache::Instance().Flush();
+   }
+
+   details::ReusePools::Instance().Trim();
+}
+
+namespace details
+{
+
+inline ReusePool::ReusePool( const size_t block_size ) :
+mBlockSize        ( block_size ),
+mBlocksPerSlab    ( (SLAB_SIZE - HEADER_SIZE) / block_size ),
+mpFront           ( nullptr ),
+mpBack            ( nullptr ),
+mEmptySlabs       ( 0 ),
+mSlabs            ( 0 ),
+mLiveBlocks       ( 0 ),
+mPeakBlocks       ( 0 )
+{
+   WGL_ASSERT(block_size % BLOCK_ALIGNMENT == 0 && mBlocksPerSlab > 1);
+}
+
+inline void * ReusePool::Allocate( )
+{
+   std::lock_guard< std::mutex > lock(mMutex);
+
+   return AllocateLocked();
+}
+
+inline void ReusePool::Deallocate( void * const pBlock )
+{
+   std::lock_guard< std::mutex > lock(mMutex);
+
+   DeallocateLocked(pBlock);
+}
+
+inline ReuseFreeBlock * ReusePool::AllocateChain( const size_t count )
+{
+   std::lock_guard< std::mutex > lock(mMutex);
+
+   ReuseFreeBlock * pChain = nullptr;
+
+   for (size_t i = 0; i < count; ++i)
+   {
+      ReuseFreeBlock * const pBlock = static_cast< ReuseFreeBlock * >(AllocateLocked());
+
+      pBlock->pNext = pChain;
+      pChain = pBlock;
+   }
+
+   return pChain;
+}
+
+inline void ReusePool::DeallocateChain( ReuseFreeBlock * pChain )
 {
+   std::lock_guard< std::mutex > lock(mMutex);
+
+   while (pChain)
+   {
+      ReuseFreeBlock * const pNext = pChain->pNext;
+
+      DeallocateLocked(pChain);
+
+      pChain = pNext;
+   }
 }
 
-template < typename T >
-ReuseAllocator< T >::ReuseAllocator( const ReuseAllocator & allocator ) :
-_front   ( 0 )
+inline void ReusePool::Trim( )
 {
+   std::lock_guard< std::mutex > lock(mMutex);
+
+   if (mEmptySlabs)
+   {
+      WGL_ASSERT(mpBack && !mpBack->live);
+
+      Slab * const pSlab = mpBack;
+
+      Unlink(pSlab);
+      ReleaseSlab(pSlab);
+
+      mEmptySlabs = 0;
+   }
 }
 
-template < typename T >
-template < typename O >
-ReuseAllocator< T >::ReuseAllocator( const ReuseAllocator< O > & /*allocator*/ ) :
-_front   ( 0 )
+inline void ReusePool::AccumulateStats( ReuseAllocatorStats & stats )
 {
+   std::lock_guard< std::mutex > lock(mMutex);
+
+   stats.live_blocks += mLiveBlocks;
+   stats.live_bytes += mLiveBlocks * mBlockSize;
+   stats.peak_blocks += mPeakBlocks;
+   stats.peak_bytes += mPeakBlocks * mBlockSize;
+   stats.slabs += mSlabs;
 }
 
-template < typename T >
-ReuseAllocator< T >::~ReuseAllocator( )
+inline void * ReusePool::AllocateLocked( )
 {
-   while (_front)
+   if (!mpFront)
    {
-      void * next =  reinterpret_cast< void * >(
-                    *reinterpret_cast< uintptr_t * >(_front));
+      AddSlab();
+   }
 
-      ::operator delete(_front);
+   Slab * const pSlab = mpFront;
 
-      _front = next;
+   void * pBlock = pSlab->pFree;
+
+   if (pBlock)
+   {
+      pSlab->pFree = pSlab->pFree->pNext;
+   }
+   else
+   {
+      pBlock = pSlab->pUnused;
+      pSlab->pUnused += mBlockSize;
+   }
+
+   // the free slab is back in use
+   if (!pSlab->live)
+   {
+      --mEmptySlabs;
+   }
+
+   // full slabs leave the list until a block is released
+   if (++pSlab->live == mBlocksPerSlab)
+   {
+      Unlink(pSlab);
+   }
+
+   if (++mLiveBlocks > mPeakBlocks)
+   {
+      mPeakBlocks = mLiveBlocks;
    }
+
+   return pBlock;
 }
 
-template < typename T >
-template < typename O >
-ReuseAllocator< T > &
-ReuseAllocator< T >::operator = ( const ReuseAllocator< O > & other )
+inline void ReusePool::DeallocateLocked( void * const pBlock )
 {
-   return *this;
+   Slab * const pSlab = SlabOf(pBlock);
+
+   ReuseFreeBlock * const pFree = static_cast< ReuseFreeBlock * >(pBlock);
+
+   pFree->pNext = pSlab->pFree;
+   pSlab->pFree = pFree;
+
+   --mLiveBlocks;
+
+   // full slabs are preferred so the others can drain
+   if (pSlab->live-- == mBlocksPerSlab)
+   {
+      PushFront(pSlab);
+   }
+
+   if (!pSlab->live)
+   {
+      Unlink(pSlab);
+
+      if (mEmptySlabs)
+      {
+         ReleaseSlab(pSlab);
+      }
+      else
+      {
+         PushBack(pSlab);
+
+         ++mEmptySlabs;
+      }
+   }
+}
+
+inline void ReusePool::AddSlab( )
+{
+   char * const pMemory = static_cast< char * >(::operator new(SLAB_SIZE, std::align_val_t(SLAB_SIZE)));
+
+   Slab * const pSlab = reinterpret_cast< Slab * >(pMemory);
+
+   pSlab->pPrev = nullptr;
+   pSlab->pNext = nullptr;
+   pSlab->pFree = nullptr;
+   pSlab->pUnused = pMemory + HEADER_SIZE;
+   pSlab->live = 0;
+
+   PushFront(pSlab);
+
+   ++mEmptySlabs;
+   ++mSlabs;
 }
 
-template < typename T >
-typename ReuseAllocator< T >::pointer
-ReuseAllocator< T >::allocate( size_type count, const void * /*hint*/ )
+inline void ReusePool::ReleaseSlab( Slab * const pSlab )
 {
-   // make sure that the count is equal to one.
-   // if this crashes, basically this means that
-   // the container being used is allocating memory
-   // in continuous blocks (ie std::vector).
-   // this allocator does not handle this case.
-   VALIDATE_EQUAL_TO_ONE(count);
+   ::operator delete(pSlab, std::align_val_t(SLAB_SIZE));
 
-   void * mem = _front;
+   --mSlabs;
+}
+
+inline void ReusePool::PushFront( Slab * const pSlab )
+{
+   pSlab->pPrev = nullptr;
+   pSlab->pNext = mpFront;
 
-   if (!mem)
+   if (mpFront)
    {
-      const size_t size =
-         sizeof(T) >= sizeof(uintptr_t *) ?
-         sizeof(T) : sizeof(uintptr_t *);
+      mpFront->pPrev = pSlab;
+   }
+   else
+   {
+      mpBack = pSlab;
+   }
+
+   mpFront = pSlab;
+}
 
-      mem = ::operator new(size);
+inline void ReusePool::PushBack( Slab * const pSlab )
+{
+   pSlab->pPrev = mpBack;
+   pSlab->pNext = nullptr;
+
+   if (mpBack)
+   {
+      mpBack->pNext = pSlab;
    }
    else
    {
-      _front =  reinterpret_cast< void * >(
-               *reinterpret_cast< uintptr_t * >(_front));
+      mpFront = pSlab;
    }
 
-   return reinterpret_cast< pointer >(mem);
+   mpBack = pSlab;
+}
+
+inline void ReusePool::Unlink( Slab * const pSlab )
+{
+   (pSlab->pPrev ? pSlab->pPrev->pNext : mpFront) = pSlab->pNext;
+   (pSlab->pNext ? pSlab->pNext->pPrev : mpBack) = pSlab->pPrev;
+
+   pSlab->pPrev = nullptr;
+   pSlab->pNext = nullptr;
+}
+
+inline ReusePool::Slab * ReusePool::SlabOf( void * const pBlock )
+{
+   return reinterpret_cast< Slab * >(reinterpret_cast< uintptr_t >(pBlock) & ~static_cast< uintptr_t >(SLAB_SIZE - 1));
 }
 
-template < typename T >
-void ReuseAllocator< T >::construct( pointer ptr, const_reference val )
+inline ReusePools & ReusePools::Instance( )
 {
-   ::new (ptr) T(val);
+   // the pools are never destroyed, so containers that live in static
+   // objects can still release their nodes while the process shuts down
+   alignas(ReusePools) static unsigned char storage[sizeof(ReusePools)];
+
+   static ReusePools * const pPools = new (storage) ReusePools;
+
+   return *pPools;
 }
 
-template < typename T >
-void ReuseAllocator< T >::destroy( pointer ptr )
+inline constexpr bool ReusePools::IsPooled( const size_t bytes, const size_t alignment )
 {
-   ptr->~T();
+   return bytes <= MAX_POOLED_SIZE && alignment <= ReusePool::BLOCK_ALIGNMENT;
+}
+
+inline size_t ReusePools::SizeClass( const size_t bytes )
+{
+   size_t size_class = 0;
+
+   while (BLOCK_SIZES[size_class] < bytes) ++size_class;
+
+   return size_class;
 }
 
-template < typename T >
-void ReuseAllocator< T >::deallocate( pointer ptr, size_type /*count*/ )
+inline ReusePools::ReusePools( ) :
+mLargeAllocations    ( 0 ),
+mLargeBytes          ( 0 )
 {
-   if (!_front)
+   for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i)
    {
-      _front = reinterpret_cast< void * >(ptr);
+      new (mPools + i * sizeof(ReusePool)) ReusePool(BLOCK_SIZES[i]);
+   }
+}
+
+inline void * ReusePools::AllocateLarge( const size_t bytes, const size_t alignment )
+{
+   void * const pMemory = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ?
+                          ::operator new(bytes, std::align_val_t(alignment)) :
+                          ::operator new(bytes);
+
+   mLargeAllocations.fetch_add(1, std::memory_order_relaxed);
+   mLargeBytes.fetch_add(bytes, std::memory_order_relaxed);
 
-      *reinterpret_cast< uintptr_t * >(ptr) = 0;
+   return pMemory;
+}
+
+inline void ReusePools::DeallocateLarge( void * const pMemory, const size_t bytes, const size_t alignment )
+{
+   if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+   {
+      ::operator delete(pMemory, std::align_val_t(alignment));
    }
    else
    {
-      *reinterpret_cast< uintptr_t * >(ptr) =
-         reinterpret_cast< uintptr_t >(_front);
+      ::operator delete(pMemory);
+   }
+
+   mLargeAllocations.fetch_sub(1, std::memory_order_relaxed);
+   mLargeBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
 
-      _front = reinterpret_cast< void * >(ptr);
+inline void ReusePools::Trim( )
+{
+   for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i)
+   {
+      Pool(i).Trim();
    }
 }
 
-template < typename T >
-typename ReuseAllocator< T >::size_type ReuseAllocator< T >::max_size( ) const
+inline ReuseAllocatorStats ReusePools::Stats( )
 {
-#if _WIN64
-   return 0x8000000000000000 / sizeof(T);
-#elif _WIN32
-   return 0x80000000 / sizeof(T);
-#endif
+   ReuseAllocatorStats stats = { };
+
+   for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i)
+   {
+      Pool(i).AccumulateStats(stats);
+   }
+
+   stats.large_allocations = mLargeAllocations.load(std::memory_order_relaxed);
+   stats.large_bytes = mLargeBytes.load(std::memory_order_relaxed);
+
+   return stats;
+}
+
+inline ReuseThreadCache & ReuseThreadCache::Instance( )
+{
+   // the pools outlive every thread, so the cache can
+   // always return its blocks when the thread exits
+   thread_local ReuseThreadCache cache;
+
+   return cache;
 }
 
-#endif // _REUSE_ALLOCATOR_H_
\ No newline at end of file
+inline bool & ReuseThreadCache::AliveFlag( )
+{
+   thread_local bool alive = true;
+
+   return alive;
+}
+
+inline ReuseThreadCache::ReuseThreadCache( ) :
+mpBlocks    { },
+mCount      { }
+{
+}
+
+inline ReuseThreadCache::~ReuseThreadCache( )
+{
+   Flush();
+
+   AliveFlag() = false;
+}
+
+inline void * ReuseThreadCache::Allocate( const size_t size_class )
+{
+   if (!mpBlocks[size_class])
+   {
+      mpBlocks[size_class] = ReusePools::Instance().Pool(size_class).AllocateChain(BATCH_SIZE);
+      mCount[size_class] = BATCH_SIZE;
+   }
+
+   ReuseFreeBlock * const pBlock = mpBlocks[size_class];
+
+   mpBlocks[size_class] = pBlock->pNext;
+   --mCount[size_class];
+
+   return pBlock;
+}
+
+inline void ReuseThreadCache::Deallocate( const size_t size_class, void * const pBlock )
+{
+   ReuseFreeBlock * const pFree = static_cast< ReuseFreeBlock * >(pBlock);
+
+   pFree->pNext = mpBlocks[size_class];
+   mpBlocks[size_class] = pFree;
+
+   // hand a batch back once the cache holds two
+   if (++mCount[size_class] == BATCH_SIZE * 2)
+   {
+      ReuseFreeBlock * pLast = pFree;
+
+      for (size_t i = 1; i < BATCH_SIZE; ++i) pLast = pLast->pNext;
+
+      mpBlocks[size_class] = pLast->pNext;
+      mCount[size_class] = BATCH_SIZE;
+
+      pLast->pNext = nullptr;
+
+      ReusePools::Instance().Pool(size_class).DeallocateChain(pFree);
+   }
+}
+
+inline void ReuseThreadCache::Flush( )
+{
+   for (size_t i = 0; i < ReusePools::NUM_SIZE_CLASSES; ++i)
+   {
+      if (mpBlocks[i])
+      {
+         ReusePools::Instance().Pool(i).DeallocateChain(mpBlocks[i]);
+
+         mpBlocks[i] = nullptr;
+         mCount[i] = 0;
+      }
+   }
+}
+
+} // namespace details
+
+#endif // _REUSE_ALLOCATOR_H_
@@ -0,0 +1,192 @@
+#ifndef _RIGID_TRANSFORM_H_
+#define _RIGID_TRANSFORM_H_
+
+// local includes
+#include "Affine3.h"
+#include "Matrix.h"
+#include "Vector.h"
+#include "WglAssert.h"
+#include "Quaternion.h"
+
+// rotation followed by a translation... the rotation is kept as a unit
+// quaternion, so composing and inverting never leave quaternion space
+// and the rotation does not drift away from orthogonal the way a matrix
+// does.  call Normalize after many compositions to remove any rounding.
+// rotating a point through the quaternion costs more than a matrix, so
+// convert with ToAffine before transforming many points.
+template < typename T >
+class RigidTransform
+{
+public:
+   // basic type of the class
+   typedef T type;
+
+   // constructor / destructor
+    RigidTransform( );
+    RigidTransform( const Quaternion< T > & rotation, const Vector< T, 3 > & translation );
+    explicit RigidTransform( const Matrix< T > & mat );
+
+   // operator * (applies the right hand side first)
+   RigidTransform< T > operator * ( const RigidTransform< T > & rigid ) const;
+   RigidTransform< T > & operator *= ( const RigidTransform< T > & rigid );
+
+   // transforms a point, which includes the translation
+   Vector< T, 3 > operator * ( const Vector< T, 3 > & point ) const;
+
+   // transforms a direction, which excludes the translation
+   Vector< T, 3 > TransformVector( const Vector< T, 3 > & vec ) const;
+
+   // operator == / !=
+   bool operator == ( const RigidTransform< T > & rigid ) const;
+   bool operator != ( const RigidTransform< T > & rigid ) const;
+
+   // the inverse of a rigid transform is always defined
+   void                 MakeInverse( );
+   RigidTransform< T >  Inverse( ) const;
+
+   // renormalizes the rotation
+   RigidTransform< T > & Normalize( );
+
+   // converts to the other transform types
+   Matrix< T > ToMatrix( ) const;
+   Affine3< T > ToAffine( ) const;
+
+   // rigid class should be simple and allow
+   // for easy acess to the member variables
+   Quaternion< T >   mRotation;
+   Vector< T, 3 >    mTranslation;
+
+private:
+   // rotates the vector by the x, y, z, w quaternion and adds the offset
+   static Vector< T, 3 > RotateAndOffset( const T * const pQuat, const T * const pVec, const T * const pOffset );
+
+};
+
+template < typename T >
+inline RigidTransform< T >::RigidTransform( )
+{
+}
+
+template < typename T >
+inline RigidTransform< T >::RigidTransform( const Quaternion< T > & rotation, const Vector< T, 3 > & translation ) :
+mRotation      ( rotation ),
+mTranslation   ( translation )
+{
+}
+
+template < typename T >
+inline RigidTransform< T >::RigidTransform( const Matrix< T > & mat ) :
+mRotation      ( Quaternion< T >::ToQuaternion(mat) ),
+mTranslation   ( mat.mT[12], mat.mT[13], mat.mT[14] )
+{
+   // only rotations and translations can be represented
+   WGL_ASSERT(mat.IsAffine());
+}
+
+template < typename T >
+inline RigidTransform< T > RigidTransform< T >::operator * ( const RigidTransform< T > & rigid ) const
+{
+   return RigidTransform< T >(mRotation % rigid.mRotation, RotateAndOffset(mRotation, rigid.mTranslation.mT, mTranslation.mT));
+}
+
+template < typename T >
+inline RigidTransform< T > & RigidTransform< T >::operator *= ( const RigidTransform< T > & rigid )
+{
+   *this = *this * rigid;
+
+   return *this;
+}
+
+template < typename T >
+inline Vector< T, 3 > RigidTransform< T >::operator * ( const Vector< T, 3 > & point ) const
+{
+   return RotateAndOffset(mRotation, point.mT, mTranslation.mT);
+}
+
+template < typename T >
+inline Vector< T, 3 > RigidTransform< T >::TransformVector( const Vector< T, 3 > & vec ) const
+{
+   const T zero[3] = { };
+
+   return RotateAndOffset(mRotation, vec.mT, zero);
+}
+
+template < typename T >
+inline Vector< T, 3 > RigidTransform< T >::RotateAndOffset( const T * const pQuat, const T * const pVec, const T * const pOffset )
+{
+   // v' = v + w * t + u x t, where t = 2 * (u x v)
+   const T ux = pQuat[0], uy = pQuat[1], uz = pQuat[2], w = pQuat[3];
+   const T vx = pVec[0], vy = pVec[1], vz = pVec[2];
+
+   const T tx = static_cast< T >(2) * (uy * vz - uz * vy);
+   const T ty = static_cast< T >(2) * (uz * vx - ux * vz);
+   const T tz = static_cast< T >(2) * (ux * vy - uy * vx);
+
+   return Vector< T, 3 >(vx + w * tx + (uy * tz - uz * ty) + pOffset[0],
+                         vy + w * ty + (uz * tx - ux * tz) + pOffset[1],
+                         vz + w * tz + (ux * ty - uy * tx) + pOffset[2]);
+}
+
+template < typename T >
+inline bool RigidTransform< T >::operator == ( const RigidTransform< T > & rigid ) const
+{
+   return mRotation == rigid.mRotation && mTranslation == rigid.mTranslation;
+}
+
+template < typename T >
+inline bool RigidTransform< T >::operator != ( const RigidTransform< T > & rigid ) const
+{
+   return !(*this == rigid);
+}
+
+template < typename T >
+inline void RigidTransform< T >::MakeInverse( )
+{
+   *this = Inverse();
+}
+
+template < typename T >
+inline RigidTransform< T > RigidTransform< T >::Inverse( ) const
+{
+   // the conjugate of a unit quat is its inverse
+   const T conjugate[4] = { -mRotation.X(), -mRotation.Y(), -mRotation.Z(), mRotation.W() };
+
+   const T offset[3] = { -mTranslation.mT[0], -mTranslation.mT[1], -mTranslation.mT[2] };
+   const T zero[3] = { };
+
+   // -(q' * t) is the same as q' * -t
+   return RigidTransform< T >(Quaternion< T >(conjugate[0], conjugate[1], conjugate[2], conjugate[3]),
+                              RotateAndOffset(conjugate, offset, zero));
+}
+
+template < typename T >
+inline RigidTransform< T > & RigidTransform< T >::Normalize( )
+{
+   mRotation.Normalize();
+
+   return *this;
+}
+
+template < typename T >
+inline Matrix< T > RigidTransform< T >::ToMatrix( ) const
+{
+   Matrix< T > mat = mRotation.ToMatrix();
+
+   mat.mT[12] = mTranslation.mT[0];
+   mat.mT[13] = mTranslation.mT[1];
+   mat.mT[14] = mTranslation.mT[2];
+
+   return mat;
+}
+
+template < typename T >
+inline Affine3< T > RigidTransform< T >::ToAffine( ) const
+{
+   return Affine3< T >(ToMatrix());
+}
+
+// global typedefs
+typedef RigidTransform< float > RigidTransformf;
+typedef RigidTransform< double > RigidTransformd;
+
+#endif // _RIGID_TRANSFORM_H_
@@ -0,0 +1,372 @@
+// local includes
+#include "SgiImage.h"
+#include "Simd.h"
+#include "WglAssert.h"
+
+// std includes
+#include <string>
+#include <vector>
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+
+namespace SgiImage
+{
+
+namespace details
+{
+
+// identifies an sgi image
+const uint16_t SGI_MAGIC = 474;
+
+// size of the header that starts the file
+const size_t HEADER_SIZE = 512;
+
+// storage of the rows
+const uint8_t STORAGE_VERBATIM = 0;
+const uint8_t STORAGE_RLE = 1;
+
+// reads the big endian fields of the file
+uint16_t ReadBE16( const uint8_t * const pData )
+{
+   return static_cast< uint16_t >(pData[0] << 8 | pData[1]);
+}
+
+uint32_t ReadBE32( const uint8_t * const pData )
+{
+   return
+      static_cast< uint32_t >(pData[0]) << 24 |
+      static_cast< uint32_t >(pData[1]) << 16 |
+      static_cast< uint32_t >(pData[2]) << 8 |
+      static_cast< uint32_t >(pData[3]);
+}
+
+// expands a run length encoded row of a channel...
+// each packet starts with a count in the low 7 bits, followed by count
+// literal bytes when the high bit is set or one byte repeated count times
+// when it is clear.  a count of 0 ends the row.
+bool DecodeRow( const uint8_t * pSrc,
+                const uint8_t * const pSrcEnd,
+                uint8_t * pDst,
+                const uint32_t width )
+{
+   const uint8_t * const pDstEnd = pDst + width;
+
+   while (pSrc < pSrcEnd)
+   {
+      const uint8_t packet = *pSrc++;
+      const uint32_t count = packet & 0x7f;
+
+      if (!count) break;
+
+      if (count > static_cast< size_t >(pDstEnd - pDst)) return false;
+
+      if (packet & 0x80)
+      {
+         if (count > static_cast< size_t >(pSrcEnd - pSrc)) return false;
+
+         std::memcpy(pDst, pSrc, count);
+         pSrc += count;
+      }
+      else
+      {
+         if (pSrc == pSrcEnd) return false;
+
+         std::memset(pDst, *pSrc++, count);
+      }
+
+      pDst += count;
+   }
+
+   return pDst == pDstEnd;
+}
+
+// interleaves four planes into rgba ordered pixels
+void InterleaveRGBA( const uint8_t * pR,
+                     const uint8_t * pG,
+                     const uint8_t * pB,
+                     const uint8_t * pA,
+                     uint8_t * pDst,
+                     const uint32_t width )
+{
+   uint32_t x = 0;
+
+#if defined( WGL_SIMD_SSE2 )
+
+   // zips 16 pixels at a time, first pairing r with g and b with a,
+   // then pairing the rg and ba halves into whole pixels
+   for (; x + 16 <= width; x += 16, pDst += 64)
+   {
+      const __m128i r = _mm_loadu_si128(reinterpret_cast< const __m128i * >(pR + x));
+      const __m128i g = _mm_loadu_si128(reinterpret_cast< const __m128i * >(pG + x));
+      const __m128i b = _mm_loadu_si128(reinterpret_cast< const __m128i * >(pB + x));
+      const __m128i a = _mm_loadu_si128(reinterpret_cast< const __m128i * >(pA + x));
+
+      const __m128i rg_lo = _mm_unpacklo_epi8(r, g);
+      const __m128i rg_hi = _mm_unpackhi_epi8(r, g);
+      const __m128i ba_lo = _mm_unpacklo_epi8(b, a);
+      const __m128i ba_hi = _mm_unpackhi_epi8(b, a);
+
+      _mm_storeu_si128(reinterpret_cast< __m128i * >(pDst), _mm_unpacklo_epi16(rg_lo, ba_lo));
+      _mm_storeu_si128(reinterpret_cast< __m128i * >(pDst + 16), _mm_unpackhi_epi16(rg_lo, ba_lo));
+      _mm_storeu_si128(reinterpret_cast< __m128i * >(pDst + 32), _mm_unpacklo_epi16(rg_hi, ba_hi));
+      _mm_storeu_si128(reinterpret_cast< __m128i * >(pDst + 48), _mm_unpackhi_epi16(rg_hi, ba_hi));
+   }
+
+#endif // WGL_SIMD_SSE2
+
+   for (; x < width; ++x, pDst += 4)
+   {
+      pDst[0] = pR[x];
+      pDst[1] = pG[x];
+      pDst[2] = pB[x];
+      pDst[3] = pA[x];
+   }
+}
+
+// interleaves three planes into rgb ordered pixels
+void InterleaveRGB( const uint8_t * pR,
+                    const uint8_t * pG,
+                    const uint8_t * pB,
+                    uint8_t * pDst,
+                    const uint32_t width )
+{
+   for (uint32_t x = 0; x < width; ++x, pDst += 3)
+   {
+      pDst[0] = pR[x];
+      pDst[1] = pG[x];
+      pDst[2] = pB[x];
+   }
+}
+
+} // namespace details
+
+uint32_t Components( const Layout layout )
+{
+   return layout == Layout::RGBA || layout == Layout::BGRA ? 4 : 3;
+}
+
+bool IsSgiImage( const void * const pData, const size_t size )
+{
+   return
+      pData && size >= details::HEADER_SIZE &&
+      details::ReadBE16(static_cast< const uint8_t * >(pData)) == details::SGI_MAGIC;
+}
+
+bool IsSgiFilename( const char * const pFilename )
+{
+   const char * const pExtension = std::strrchr(pFilename, '.');
+
+   if (!pExtension) return false;
+
+   std::string extension(pExtension + 1);
+
+   std::transform(extension.begin(), extension.end(), extension.begin(),
+      [ ] ( const char c ) { return static_cast< char >(std::tolower(static_cast< unsigned char >(c))); });
+
+   return extension == "rgb" || extension == "rgba" || extension == "sgi" || extension == "bw";
+}
+
+Reader::Reader( ) :
+mpData      ( nullptr ),
+mSize       ( 0 ),
+mWidth      ( 0 ),
+mHeight     ( 0 ),
+mChannels   ( 0 ),
+mCompressed ( false )
+{
+}
+
+Reader::~Reader( )
+{
+}
+
+bool Reader::Open( const char * const pFilename )
+{
+   Close();
+
+   return mFile.Open(pFilename) && View(mFile.Data(), mFile.Size());
+}
+
+bool Reader::Open( const void * const pData, const size_t size )
+{
+   Close();
+
+   return View(static_cast< const uint8_t * >(pData), size);
+}
+
+bool Reader::View( const uint8_t * const pData, const size_t size )
+{
+   if (!IsSgiImage(pData, size)) { Close(); return false; }
+
+   const uint8_t storage = pData[2];
+   const uint8_t bpc = pData[3];
+   const uint16_t dimension = details::ReadBE16(pData + 4);
+   const uint32_t width = details::ReadBE16(pData + 6);
+   const uint32_t height = dimension >= 2 ? details::ReadBE16(pData + 8) : 1;
+   const uint32_t channels = dimension >= 3 ? details::ReadBE16(pData + 10) : 1;
+   const uint32_t colormap = details::ReadBE32(pData + 104);
+
+   // only 8 bit channels of plain images are read
+   const bool supported =
+      (storage == details::STORAGE_VERBATIM || storage == details::STORAGE_RLE) &&
+      bpc == 1 && dimension >= 1 && dimension <= 3 &&
+      width && height && channels >= 1 && channels <= 4 &&
+      colormap == 0;
+
+   if (!supported) { Close(); return false; }
+
+   const size_t num_rows = static_cast< size_t >(height) * channels;
+
+   if (storage == details::STORAGE_VERBATIM)
+   {
+      if ((size - details::HEADER_SIZE) / width < num_rows) { Close(); return false; }
+   }
+   else
+   {
+      // the tables of row starts and row lengths follow the header,
+      // and every row they point at must lie in the file
+      if ((size - details::HEADER_SIZE) / 8 < num_rows) { Close(); return false; }
+
+      const uint8_t * const pStarts = pData + details::HEADER_SIZE;
+      const uint8_t * const pLengths = pStarts + num_rows * 4;
+
+      for (size_t i = 0; i < num_rows; ++i)
+      {
+         const uint32_t start = details::ReadBE32(pStarts + i * 4);
+         const uint32_t length = details::ReadBE32(pLengths + i * 4);
+
+         if (start > size || length > size - start) { Close(); return false; }
+      }
+   }
+
+   mpData = pData;
+   mSize = size;
+   mWidth = width;
+   mHeight = height;
+   mChannels = channels;
+   mCompressed = storage == details::STORAGE_RLE;
+
+   return true;
+}
+
+void Reader::Close( )
+{
+   mFile.Close();
+
+   mpData = nullptr;
+   mSize = 0;
+   mWidth = 0;
+   mHeight = 0;
+   mChannels = 0;
+   mCompressed = false;
+}
+
+bool Reader::ReadRows( const uint32_t first_row,
+                       const uint32_t num_rows,
+                       const Layout layout,
+                       uint8_t * const pPixels ) const
+{
+   WGL_ASSERT(IsOpen() && pPixels);
+   WGL_ASSERT(first_row <= mHeight && num_rows <= mHeight - first_row);
+
+   const size_t row_size = static_cast< size_t >(mWidth) * Components(layout);
+   const size_t num_planes = static_cast< size_t >(mHeight) * mChannels;
+
+   // rle rows are expanded into scratch planes, and a plane of 255 stands
+   // in for the alpha of images without one
+   std::vector< uint8_t > scratch(static_cast< size_t >(mWidth) * (mCompressed ? mChannels + 1 : 1));
+   uint8_t * const pOpaque = scratch.data() + scratch.size() - mWidth;
+
+   std::fill(pOpaque, pOpaque + mWidth, 0xff);
+
+   const uint8_t * planes[4] = { };
+
+   for (uint32_t row = first_row; row < first_row + num_rows; ++row)
+   {
+      for (uint32_t c = 0; c < mChannels; ++c)
+      {
+         const size_t plane = row + static_cast< size_t >(c) * mHeight;
+
+         if (mCompressed)
+         {
+            const uint8_t * const pTables = mpData + details::HEADER_SIZE;
+            const uint32_t start = details::ReadBE32(pTables + plane * 4);
+            const uint32_t length = details::ReadBE32(pTables + (num_planes + plane) * 4);
+
+            uint8_t * const pPlane = scratch.data() + static_cast< size_t >(c) * mWidth;
+
+            if (!details::DecodeRow(mpData + start, mpData + start + length, pPlane, mWidth)) return false;
+
+            planes[c] = pPlane;
+         }
+         else
+         {
+            // verbatim rows are read straight from the mapping
+            planes[c] = mpData + details::HEADER_SIZE + plane * mWidth;
+         }
+      }
+
+      // gray is copied into each color
+      const uint8_t * const pRed = planes[0];
+      const uint8_t * const pGreen = mChannels >= 3 ? planes[1] : planes[0];
+      const uint8_t * const pBlue = mChannels >= 3 ? planes[2] : planes[0];
+      const uint8_t * const pAlpha =
+         mChannels == 2 ? planes[1] :
+         mChannels == 4 ? planes[3] : pOpaque;
+
+      uint8_t * const pDst = pPixels + (row - first_row) * row_size;
+
+      switch (layout)
+      {
+      case Layout::RGB: details::InterleaveRGB(pRed, pGreen, pBlue, pDst, mWidth); break;
+      case Layout::BGR: details::InterleaveRGB(pBlue, pGreen, pRed, pDst, mWidth); break;
+      case Layout::RGBA: details::InterleaveRGBA(pRed, pGreen, pBlue, pAlpha, pDst, mWidth); break;
+      case Layout::BGRA: details::InterleaveRGBA(pBlue, pGreen, pRed, pAlpha, pDst, mWidth); break;
+      default: WGL_ASSERT(false); return false;
+      }
+   }
+
+   return true;
+}
+
+bool Read( const void * const pData,
+           const size_t size,
+           const Layout layout,
+           uint32_t & width,
+           uint32_t & height,
+           const std::function< std::shared_ptr< uint8_t > ( const size_t ) > & allocate,
+           std::shared_ptr< uint8_t > & pPixels )
+{
+   Reader reader;
+
+   if (!reader.Open(pData, size)) return false;
+
+   std::shared_ptr< uint8_t > pBuffer =
+      allocate(static_cast< size_t >(reader.Width()) * reader.Height() * Components(layout));
+
+   if (!pBuffer || !reader.ReadRows(0, reader.Height(), layout, pBuffer.get())) return false;
+
+   width = reader.Width();
+   height = reader.Height();
+   pPixels = std::move(pBuffer);
+
+   return true;
+}
+
+bool Read( const char * const pFilename,
+           const Layout layout,
+           uint32_t & width,
+           uint32_t & height,
+           std::shared_ptr< uint8_t > & pPixels )
+{
+   MappedFile file;
+
+   return
+      file.Open(pFilename) &&
+      Read(file.Data(), file.Size(), layout, width, height,
+           [ ] ( const size_t size ) { return std::shared_ptr< uint8_t >(new uint8_t[size], std::default_delete< uint8_t[] >()); },
+           pPixels);
+}
+
+} // namespace SgiImage
@@ -0,0 +1,118 @@
+#ifndef _SGI_IMAGE_H_
+#define _SGI_IMAGE_H_
+
+// local includes
+#include "MappedFile.h"
+
+// std includes
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// reads sgi images (.rgb, .rgba, .bw, .sgi) of 8 bit channels, stored
+// verbatim or run length encoded.  the image is mapped and its channel planes
+// are interleaved into pixels a row at a time, so large images can be read
+// in strips of rows without holding the whole image.  the rows are stored
+// from the bottom up, matching the lower left origin of gl textures.
+namespace SgiImage
+{
+
+// order of the components the channels are interleaved into
+enum class Layout
+{
+   RGB,
+   BGR,
+   RGBA,
+   BGRA
+};
+
+// components in a pixel of the layout
+uint32_t Components( const Layout layout );
+
+// determines if the contents start with the header of an sgi image
+bool IsSgiImage( const void * const pData, const size_t size );
+
+// determines if the file is named like an sgi image
+bool IsSgiFilename( const char * const pFilename );
+
+// an sgi image, mapped from a file or viewing contents in memory
+class Reader
+{
+public:
+   // constructor / destructor
+    Reader( );
+   ~Reader( );
+
+   // maps the image.  returns false if the file cannot be read, is not an sgi
+   // image of 8 bit channels, or its run length tables are damaged.
+   bool Open( const char * const pFilename );
+
+   // views an image already in memory, which must outlive the reader
+   bool Open( const void * const pData, const size_t size );
+
+   void Close( );
+
+   // indicates if an image is open
+   bool IsOpen( ) const { return mpData != nullptr; }
+
+   uint32_t Width( ) const { return mWidth; }
+   uint32_t Height( ) const { return mHeight; }
+
+   // channels stored in the image...
+   // one is gray, two gray and alpha, three rgb, and four rgba
+   uint32_t Channels( ) const { return mChannels; }
+
+   // indicates if the rows are run length encoded
+   bool IsCompressed( ) const { return mCompressed; }
+
+   // decodes num_rows rows starting from first_row into tightly packed pixels
+   // of the layout.  gray is copied into each color and missing alpha is 255.
+   // returns false if a row is damaged.  rows may be read from many threads.
+   bool ReadRows( const uint32_t first_row,
+                  const uint32_t num_rows,
+                  const Layout layout,
+                  uint8_t * const pPixels ) const;
+
+private:
+   // prohibit copy construction and assignment
+   Reader( const Reader & );
+   Reader & operator = ( const Reader & );
+
+   // checks the header and tables of the image
+   bool View( const uint8_t * const pData, const size_t size );
+
+   // the mapped image
+   MappedFile        mFile;
+
+   // contents of the image
+   const uint8_t *   mpData;
+   size_t            mSize;
+
+   uint32_t          mWidth;
+   uint32_t          mHeight;
+   uint32_t          mChannels;
+   bool              mCompressed;
+
+};
+
+// reads a whole image into a buffer from allocate, which is passed the
+// number of bytes needed.  the contents must start with an sgi image.
+bool Read( const void * const pData,
+           const size_t size,
+           const Layout layout,
+           uint32_t & width,
+           uint32_t & height,
+           const std::function< std::shared_ptr< uint8_t > ( const size_t ) > & allocate,
+           std::shared_ptr< uint8_t > & pPixels );
+
+// maps and reads a whole image file
+bool Read( const char * const pFilename,
+           const Layout layout,
+           uint32_t & width,
+           uint32_t & height,
+           std::shared_ptr< uint8_t > & pPixels );
+
+} // namespace SgiImage
+
+#endif // _SGI_IMAGE_H_
@@ -0,0 +1,288 @@
+#ifndef _SIMD_H_
+#define _SIMD_H_
+
+// the simd backend is selected at compile time from the instruction
+// sets the compiler has been told it may use.  define WGL_DISABLE_SIMD
+// to force the portable backend (useful when comparing results).
+#if !defined( WGL_DISABLE_SIMD )
+   #if defined( __SSE2__ ) || defined( _M_X64 ) || (defined( _M_IX86_FP ) && _M_IX86_FP >= 2)
+      #define WGL_SIMD_SSE2 1
+   #endif
+
+   #if defined( WGL_SIMD_SSE2 ) && defined( __AVX__ )
+      #define WGL_SIMD_AVX 1
+   #endif
+#endif // !WGL_DISABLE_SIMD
+
+// std includes
+#include <cmath>
+
+// intrinsic includes
+#if defined( WGL_SIMD_SSE2 )
+#include <emmintrin.h>
+#endif // WGL_SIMD_SSE2
+
+#if defined( WGL_SIMD_AVX )
+#include <immintrin.h>
+#endif // WGL_SIMD_AVX
+
+namespace simd
+{
+
+// four lane vector used by the math kernels.  the primary template is
+// the portable backend that keeps the lanes in an array and leaves any
+// vectorization up to the compiler.  specializations below wrap the
+// native register types.  all backends share the same interface so the
+// kernels are written once.
+//
+// shuffle follows the sse convention: lanes 0 and 1 of the result are
+// selected from a and lanes 2 and 3 are selected from b.
+template < typename T >
+class Vec4
+{
+public:
+   // indicates if the type is backed by a native register
+   static constexpr bool ACCELERATED = false;
+
+   // indicates if lanes can be moved around cheaply...
+   // kernels dominated by shuffles use scalar code otherwise
+   static constexpr bool FAST_SHUFFLE = false;
+
+   // loads / stores four unaligned values
+   static Vec4 Load( const T * const pT )
+   {
+      Vec4 v;
+      v.mT[0] = pT[0]; v.mT[1] = pT[1]; v.mT[2] = pT[2]; v.mT[3] = pT[3];
+
+      return v;
+   }
+
+   void Store( T * const pT ) const
+   {
+      pT[0] = mT[0]; pT[1] = mT[1]; pT[2] = mT[2]; pT[3] = mT[3];
+   }
+
+   // replicates the value across all lanes
+   static Vec4 Splat( const T & t )
+   {
+      Vec4 v;
+      v.mT[0] = t; v.mT[1] = t; v.mT[2] = t; v.mT[3] = t;
+
+      return v;
+   }
+
+   template < int I0, int I1, int I2, int I3 >
+   static Vec4 Shuffle( const Vec4 & a, const Vec4 & b )
+   {
+      Vec4 v;
+      v.mT[0] = a.mT[I0]; v.mT[1] = a.mT[I1]; v.mT[2] = b.mT[I2]; v.mT[3] = b.mT[I3];
+
+      return v;
+   }
+
+   Vec4 operator + ( const Vec4 & v ) const
+   {
+      Vec4 r;
+      for (int i = 0; i < 4; ++i) r.mT[i] = mT[i] + v.mT[i];
+
+      return r;
+   }
+
+   Vec4 operator - ( const Vec4 & v ) const
+   {
+      Vec4 r;
+      for (int i = 0; i < 4; ++i) r.mT[i] = mT[i] - v.mT[i];
+
+      return r;
+   }
+
+   Vec4 operator * ( const Vec4 & v ) const
+   {
+      Vec4 r;
+      for (int i = 0; i < 4; ++i) r.mT[i] = mT[i] * v.mT[i];
+
+      return r;
+   }
+
+   Vec4 operator / ( const Vec4 & v ) const
+   {
+      Vec4 r;
+      for (int i = 0; i < 4; ++i) r.mT[i] = mT[i] / v.mT[i];
+
+      return r;
+   }
+
+   // returns the magnitude of a with the sign of b
+   static Vec4 CopySign( const Vec4 & a, const Vec4 & b )
+   {
+      Vec4 r;
+      for (int i = 0; i < 4; ++i) r.mT[i] = std::copysign(a.mT[i], b.mT[i]);
+
+      return r;
+   }
+
+   static Vec4 Sqrt( const Vec4 & v )
+   {
+      Vec4 r;
+      for (int i = 0; i < 4; ++i) r.mT[i] = std::sqrt(v.mT[i]);
+
+      return r;
+   }
+
+   T     mT[4];
+
+};
+
+#if defined( WGL_SIMD_SSE2 )
+
+template < >
+class Vec4< float >
+{
+public:
+   static constexpr bool ACCELERATED = true;
+   static constexpr bool FAST_SHUFFLE = true;
+
+    Vec4( ) { }
+    explicit Vec4( const __m128 v ) : mV ( v ) { }
+
+   static Vec4 Load( const float * const pT ) { return Vec4(_mm_loadu_ps(pT)); }
+   void Store( float * const pT ) const { _mm_storeu_ps(pT, mV); }
+
+   static Vec4 Splat( const float t ) { return Vec4(_mm_set1_ps(t)); }
+
+   template < int I0, int I1, int I2, int I3 >
+   static Vec4 Shuffle( const Vec4 & a, const Vec4 & b )
+   {
+      return Vec4(_mm_shuffle_ps(a.mV, b.mV, _MM_SHUFFLE(I3, I2, I1, I0)));
+   }
+
+   Vec4 operator + ( const Vec4 & v ) const { return Vec4(_mm_add_ps(mV, v.mV)); }
+   Vec4 operator - ( const Vec4 & v ) const { return Vec4(_mm_sub_ps(mV, v.mV)); }
+   Vec4 operator * ( const Vec4 & v ) const { return Vec4(_mm_mul_ps(mV, v.mV)); }
+   Vec4 operator / ( const Vec4 & v ) const { return Vec4(_mm_div_ps(mV, v.mV)); }
+
+   static Vec4 CopySign( const Vec4 & a, const Vec4 & b )
+   {
+      const __m128 sign = _mm_set1_ps(-0.0f);
+
+      return Vec4(_mm_or_ps(_mm_andnot_ps(sign, a.mV), _mm_and_ps(sign, b.mV)));
+   }
+
+   static Vec4 Sqrt( const Vec4 & v ) { return Vec4(_mm_sqrt_ps(v.mV)); }
+
+   __m128   mV;
+
+};
+
+namespace details
+{
+
+// selects two double lanes out of a pair of 128 bit halves
+template < int I0, int I1 >
+inline __m128d pick_lanes( const __m128d lo, const __m128d hi )
+{
+   return _mm_shuffle_pd(I0 < 2 ? lo : hi, I1 < 2 ? lo : hi, (I0 & 1) | ((I1 & 1) << 1));
+}
+
+} // namespace details
+
+#if defined( WGL_SIMD_AVX )
+
+template < >
+class Vec4< double >
+{
+public:
+   static constexpr bool ACCELERATED = true;
+   // most shuffles have to cross the 128 bit halves of the register
+   static constexpr bool FAST_SHUFFLE = false;
+
+    Vec4( ) { }
+    explicit Vec4( const __m256d v ) : mV ( v ) { }
+
+   static Vec4 Load( const double * const pT ) { return Vec4(_mm256_loadu_pd(pT)); }
+   void Store( double * const pT ) const { _mm256_storeu_pd(pT, mV); }
+
+   static Vec4 Splat( const double t ) { return Vec4(_mm256_set1_pd(t)); }
+
+   template < int I0, int I1, int I2, int I3 >
+   static Vec4 Shuffle( const Vec4 & a, const Vec4 & b )
+   {
+      // avx does not shuffle across the 128 bit halves,
+      // so split the registers and recombine the halves
+      const __m128d lo = details::pick_lanes< I0, I1 >(_mm256_castpd256_pd128(a.mV), _mm256_extractf128_pd(a.mV, 1));
+      const __m128d hi = details::pick_lanes< I2, I3 >(_mm256_castpd256_pd128(b.mV), _mm256_extractf128_pd(b.mV, 1));
+
+      return Vec4(_mm256_insertf128_pd(_mm256_castpd128_pd256(lo), hi, 1));
+   }
+
+   Vec4 operator + ( const Vec4 & v ) const { return Vec4(_mm256_add_pd(mV, v.mV)); }
+   Vec4 operator - ( const Vec4 & v ) const { return Vec4(_mm256_sub_pd(mV, v.mV)); }
+   Vec4 operator * ( const Vec4 & v ) const { return Vec4(_mm256_mul_pd(mV, v.mV)); }
+   Vec4 operator / ( const Vec4 & v ) const { return Vec4(_mm256_div_pd(mV, v.mV)); }
+
+   static Vec4 CopySign( const Vec4 & a, const Vec4 & b )
+   {
+      const __m256d sign = _mm256_set1_pd(-0.0);
+
+      return Vec4(_mm256_or_pd(_mm256_andnot_pd(sign, a.mV), _mm256_and_pd(sign, b.mV)));
+   }
+
+   static Vec4 Sqrt( const Vec4 & v ) { return Vec4(_mm256_sqrt_pd(v.mV)); }
+
+   __m256d  mV;
+
+};
+
+#else
+
+// four doubles held as two 128 bit halves
+template < >
+class Vec4< double >
+{
+public:
+   static constexpr bool ACCELERATED = true;
+   static constexpr bool FAST_SHUFFLE = true;
+
+    Vec4( ) { }
+    Vec4( const __m128d lo, const __m128d hi ) : mLo ( lo ), mHi ( hi ) { }
+
+   static Vec4 Load( const double * const pT ) { return Vec4(_mm_loadu_pd(pT), _mm_loadu_pd(pT + 2)); }
+   void Store( double * const pT ) const { _mm_storeu_pd(pT, mLo); _mm_storeu_pd(pT + 2, mHi); }
+
+   static Vec4 Splat( const double t ) { const __m128d v = _mm_set1_pd(t); return Vec4(v, v); }
+
+   template < int I0, int I1, int I2, int I3 >
+   static Vec4 Shuffle( const Vec4 & a, const Vec4 & b )
+   {
+      return Vec4(details::pick_lanes< I0, I1 >(a.mLo, a.mHi),
+                  details::pick_lanes< I2, I3 >(b.mLo, b.mHi));
+   }
+
+   Vec4 operator + ( const Vec4 & v ) const { return Vec4(_mm_add_pd(mLo, v.mLo), _mm_add_pd(mHi, v.mHi)); }
+   Vec4 operator - ( const Vec4 & v ) const { return Vec4(_mm_sub_pd(mLo, v.mLo), _mm_sub_pd(mHi, v.mHi)); }
+   Vec4 operator * ( const Vec4 & v ) const { return Vec4(_mm_mul_pd(mLo, v.mLo), _mm_mul_pd(mHi, v.mHi)); }
+   Vec4 operator / ( const Vec4 & v ) const { return Vec4(_mm_div_pd(mLo, v.mLo), _mm_div_pd(mHi, v.mHi)); }
+
+   static Vec4 CopySign( const Vec4 & a, const Vec4 & b )
+   {
+      const __m128d sign = _mm_set1_pd(-0.0);
+
+      return Vec4(_mm_or_pd(_mm_andnot_pd(sign, a.mLo), _mm_and_pd(sign, b.mLo)),
+                  _mm_or_pd(_mm_andnot_pd(sign, a.mHi), _mm_and_pd(sign, b.mHi)));
+   }
+
+   static Vec4 Sqrt( const Vec4 & v ) { return Vec4(_mm_sqrt_pd(v.mLo), _mm_sqrt_pd(v.mHi)); }
+
+   // lanes 0 and 1 / lanes 2 and 3
+   __m128d  mLo;
+   __m128d  mHi;
+
+};
+
+#endif // WGL_SIMD_AVX
+
+#endif // WGL_SIMD_SSE2
+
+} // namespace simd
+
+#endif // _SIMD_H_
@@ -1,14 +1,89 @@
 #ifndef _SINGLETON_H_
 #define _SINGLETON_H_
 
+// std includes
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
 // crt includes
 #include <stdlib.h>
 
+// shutdown order of a singleton relative to the others.  singletons with
+// a higher priority are released first.  singletons of equal priority are
+// released in the reverse order of their creation, so a singleton that
+// uses another one from its constructor is released before the other one.
+template < typename T >
+struct SingletonShutdownPriority
+{
+   static const int VALUE = 0;
+};
+
+// releases all the live singletons in shutdown order.  this is called
+// automatically at exit, but can be called earlier when the singletons
+// depend on resources that go away before exit (such as a gl context).
+inline void ShutdownSingletons( );
+
+namespace details
+{
+
+// keeps track of the live singletons and serializes their creation
+class SingletonRegistry
+{
+public:
+   // releases a singleton
+   typedef void ( * ReleaseFn )( );
+
+   // the registry is never destroyed, so singletons
+   // can be created and released at any point during exit
+   static SingletonRegistry & Instance( );
+
+   // guards creation and release of all the singletons...
+   // recursive since a singleton may use another from its constructor
+   std::recursive_mutex & Mutex( );
+
+   // adds / removes a singleton from the shutdown list
+   void Register( const ReleaseFn release, const int priority );
+   void Unregister( const ReleaseFn release );
+
+   // releases all the registered singletons
+   void Shutdown( );
+
+private:
+   // prohibit construction outside of instance
+   SingletonRegistry( );
+   // prohibit copy construction
+   SingletonRegistry( const SingletonRegistry & );
+   // prohibit copy operator
+   SingletonRegistry & operator = ( const SingletonRegistry & );
+
+   // at exit shutdown
+   static void AtExitCB( );
+
+   struct Entry
+   {
+      ReleaseFn   release;
+      int         priority;
+      uint64_t    order;
+   };
+
+   // private member variables
+   std::recursive_mutex    mMutex;
+   std::vector< Entry >    mEntries;
+   uint64_t                mNextOrder;
+
+};
+
+} // namespace details
+
 template < typename T >
 class Singleton
 {
 public:
-   // access the basic member
+   // access the basic member...
+   // after the first call this is a single acquire load
    static T *  Instance( );
 
    // releases the basic member
@@ -23,46 +98,161 @@ private:
    // prohibit copy operator
    Singleton & operator = ( const Singleton & );
 
-   // at exit destructor
-   static void AtExitCB( );
+   // creates the instance the first time it is requested
+   static T *  Create( );
+
+   // registry release callback
+   static void Destroy( );
 
    // private static members
-   static T *     mT;
+   static std::atomic< T * >  mT;
 
 };
 
-// allocate space for the static instance
-template < typename T > T * Singleton< T >::mT = NULL;
+// the instance is constant initialized, so it is valid
+// before any dynamic initialization requests the singleton
+template < typename T > std::atomic< T * > Singleton< T >::mT ( nullptr );
 
 template < typename T >
-T * Singleton< T >::Instance( )
+inline T * Singleton< T >::Instance( )
 {
    // validate instance
-   if (!mT)
+   T * const pT = mT.load(std::memory_order_acquire);
+
+   // return current instance
+   return pT ? pT : Create();
+}
+
+template < typename T >
+T * Singleton< T >::Create( )
+{
+   details::SingletonRegistry & registry = details::SingletonRegistry::Instance();
+
+   const std::lock_guard< std::recursive_mutex > lock(registry.Mutex());
+
+   // another thread may have won the race for the lock
+   T * pT = mT.load(std::memory_order_relaxed);
+
+   if (!pT)
    {
       // create a new instance
-      mT = new T;
-      // register for at exit callback
-      atexit(&AtExitCB);
+      pT = new T;
+      // register for the ordered shutdown
+      registry.Register(&Destroy, SingletonShutdownPriority< T >::VALUE);
+      // publish the constructed instance
+      mT.store(pT, std::memory_order_release);
    }
 
-   // return current instance
-   return mT;
+   return pT;
 }
 
 template < typename T >
 void Singleton< T >::Release( )
 {
-   AtExitCB();
+   details::SingletonRegistry & registry = details::SingletonRegistry::Instance();
+
+   const std::lock_guard< std::recursive_mutex > lock(registry.Mutex());
+
+   registry.Unregister(&Destroy);
+
+   Destroy();
 }
 
 template < typename T >
-void Singleton< T >::AtExitCB( )
+void Singleton< T >::Destroy( )
+{
+   const std::lock_guard< std::recursive_mutex > lock(details::SingletonRegistry::Instance().Mutex());
+
+   // release the instance and nullify the instance
+   delete mT.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+inline void ShutdownSingletons( )
+{
+   details::SingletonRegistry::Instance().Shutdown();
+}
+
+namespace details
+{
+
+inline SingletonRegistry & SingletonRegistry::Instance( )
+{
+   // storage for the registry that is never released
+   alignas(SingletonRegistry) static unsigned char storage[sizeof(SingletonRegistry)];
+
+   static SingletonRegistry * const pRegistry = new (storage) SingletonRegistry;
+
+   return *pRegistry;
+}
+
+inline SingletonRegistry::SingletonRegistry( ) :
+mNextOrder  ( 0 )
+{
+   // register for at exit callback
+   atexit(&AtExitCB);
+}
+
+inline std::recursive_mutex & SingletonRegistry::Mutex( )
+{
+   return mMutex;
+}
+
+inline void SingletonRegistry::Register( const ReleaseFn release, const int priority )
+{
+   const std::lock_guard< std::recursive_mutex > lock(mMutex);
+
+   const Entry entry = { release, priority, mNextOrder++ };
+
+   mEntries.push_back(entry);
+}
+
+inline void SingletonRegistry::Unregister( const ReleaseFn release )
 {
-   // release the instance
-   delete mT;
-   // nullify the instance
-   mT = NULL;
+   const std::lock_guard< std::recursive_mutex > lock(mMutex);
+
+   for (auto entry = mEntries.begin(); entry != mEntries.end(); ++entry)
+   {
+      if (entry->release == release)
+      {
+         mEntries.erase(entry);
+
+         break;
+      }
+   }
 }
 
-#endif // _SINGLETON_H_
\ No newline at end of file
+inline void SingletonRegistry::Shutdown( )
+{
+   const std::lock_guard< std::recursive_mutex > lock(mMutex);
+
+   // pick the next singleton each time, since releasing
+   // one may create or release other singletons
+   while (!mEntries.empty())
+   {
+      auto next = mEntries.begin();
+
+      for (auto entry = mEntries.begin(); entry != mEntries.end(); ++entry)
+      {
+         if (entry->priority > next->priority ||
+             (entry->priority == next->priority && entry->order > next->order))
+         {
+            next = entry;
+         }
+      }
+
+      const ReleaseFn release = next->release;
+
+      mEntries.erase(next);
+
+      release();
+   }
+}
+
+inline void SingletonRegistry::AtExitCB( )
+{
+   Instance().Shutdown();
+}
+
+} // namespace details
+
+#endif // _SINGLETON_H_
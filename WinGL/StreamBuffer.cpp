@@ -0,0 +1,110 @@
+// local includes
+#include "StreamBuffer.h"
+#include "WglAssert.h"
+
+StreamBuffer::FencePolicy::Fence StreamBuffer::FencePolicy::Insert( )
+{
+   return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void StreamBuffer::FencePolicy::Wait( Fence fence )
+{
+   // the first wait flushes the commands so the fence is sure to signal
+   GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+
+   for (;;)
+   {
+      const GLenum result = glClientWaitSync(fence, flags, 1000000000);
+
+      if (result != GL_TIMEOUT_EXPIRED) break;
+
+      flags = 0;
+   }
+}
+
+void StreamBuffer::FencePolicy::Delete( Fence fence )
+{
+   glDeleteSync(fence);
+}
+
+StreamBuffer::StreamBuffer( ) :
+mpData   ( nullptr )
+{
+}
+
+StreamBuffer::~StreamBuffer( )
+{
+   Destroy();
+}
+
+bool StreamBuffer::Create( const GLenum target, const size_t region_size )
+{
+   WGL_ASSERT(!IsCreated());
+
+   if (!glBufferStorage || !glMapBufferRange || !glFenceSync) return false;
+
+   mpRing.reset(new Ring(region_size));
+
+   // coherent, so the writes are seen by the gpu without flushing them
+   const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+   mBuffer.GenBuffer(target);
+   mBuffer.Bind();
+   mBuffer.BufferStorage(mpRing->Size(), nullptr, flags);
+
+   mpData = mBuffer.MapBufferRange(0, mpRing->Size(), flags);
+
+   mBuffer.Unbind();
+
+   if (!mpData)
+   {
+      mBuffer.DeleteBuffer();
+      mpRing.reset();
+   }
+
+   return IsCreated();
+}
+
+void StreamBuffer::Destroy( )
+{
+   if (IsCreated())
+   {
+      // the gpu may still be reading the last frames
+      mpRing->Flush();
+
+      mBuffer.Bind();
+      mBuffer.UnmapBuffer();
+      mBuffer.Unbind();
+      mBuffer.DeleteBuffer();
+
+      mpRing.reset();
+      mpData = nullptr;
+   }
+}
+
+void StreamBuffer::BeginFrame( )
+{
+   WGL_ASSERT(IsCreated());
+
+   mpRing->BeginRegion();
+}
+
+uint8_t * StreamBuffer::Allocate( const size_t size, const size_t alignment, GLintptr & offset )
+{
+   WGL_ASSERT(IsCreated());
+
+   const size_t allocated = mpRing->Allocate(size, alignment);
+
+   if (allocated == Ring::NO_SPACE) return nullptr;
+
+   offset = static_cast< GLintptr >(allocated);
+
+   return mpData + allocated;
+}
+
+void StreamBuffer::EndFrame( )
+{
+   WGL_ASSERT(IsCreated());
+
+   mpRing->EndRegion();
+}
@@ -0,0 +1,86 @@
+#ifndef _STREAM_BUFFER_H_
+#define _STREAM_BUFFER_H_
+
+// local includes
+#include "StreamRing.h"
+#include "VertexBufferObject.h"
+
+// gl includes
+#include "GL/glew.h"
+#include <GL/GL.h>
+
+// std includes
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+// a buffer that streams data to the gpu every frame without stalling...
+// the buffer is mapped once for its whole life, and each frame is written
+// straight into the next region of a triple buffered ring.  a fence guards
+// each region, so a region is only written again once the gpu is done with
+// the frame that read it last.  requires arb_buffer_storage.
+class StreamBuffer
+{
+public:
+   // fences the regions with gl sync objects
+   struct FencePolicy
+   {
+      typedef GLsync Fence;
+
+      Fence Insert( );
+      void Wait( Fence fence );
+      void Delete( Fence fence );
+   };
+
+   typedef StreamRing< FencePolicy > Ring;
+
+   // constructor / destructor...
+   // the destructor destroys the buffer, so it needs a valid gl context
+    StreamBuffer( );
+   ~StreamBuffer( );
+
+   // creates and maps a buffer for the target that holds a region of
+   // region_size bytes for each frame.  returns false if persistently
+   // mapped buffers are not supported.
+   bool Create( const GLenum target, const size_t region_size );
+
+   // waits for the gpu and deletes the buffer...
+   // must be called within a valid gl context
+   void Destroy( );
+
+   // indicates if the buffer is created
+   bool IsCreated( ) const { return mpData != nullptr; }
+
+   // begins the writes of a frame, waiting if the gpu is still reading the region
+   void BeginFrame( );
+
+   // reserves bytes of the frame to write, returning where to write them and
+   // setting offset to where they are in the buffer for the draws that read
+   // them.  returns nullptr if the region of the frame is full.
+   uint8_t * Allocate( const size_t size, const size_t alignment, GLintptr & offset );
+
+   // fences the frame after the draws that read it are issued
+   void EndFrame( );
+
+   // the buffer to bind for the draws
+   VertexBufferObject & Buffer( ) { return mBuffer; }
+
+   // size of the region of each frame
+   size_t RegionSize( ) const { return mpRing ? mpRing->RegionSize() : 0; }
+
+private:
+   // prohibit copy construction and assignment
+   StreamBuffer( const StreamBuffer & );
+   StreamBuffer & operator = ( const StreamBuffer & );
+
+   VertexBufferObject      mBuffer;
+
+   // the bookkeeping of the regions and their fences
+   std::unique_ptr< Ring > mpRing;
+
+   // the whole buffer, mapped for its life
+   uint8_t *               mpData;
+
+};
+
+#endif // _STREAM_BUFFER_H_
@@ -0,0 +1,168 @@
+#ifndef _STREAM_RING_H_
+#define _STREAM_RING_H_
+
+// wgl includes
+#include "WglAssert.h"
+
+// std includes
+#include <cstddef>
+
+// the bookkeeping of a buffer that streams data to the gpu every frame...
+// the buffer is split into regions that are written in turn, one per frame,
+// so the cpu writes one region while the gpu still reads the frames before.
+// a region is fenced once its frame is submitted, and the fence is waited on
+// before the region is written again.  the fences come from the policy, so
+// the ring can be used without a gl context.  the policy provides...
+//    typedef ... Fence;
+//    Fence Insert( );              fences the commands submitted so far
+//    void Wait( Fence fence );     blocks until the fenced commands complete
+//    void Delete( Fence fence );   releases the fence
+template < typename FencePolicy, size_t NUM_REGIONS = 3 >
+class StreamRing
+{
+public:
+   typedef typename FencePolicy::Fence Fence;
+
+   // returned by allocate when the region is full
+   static constexpr size_t NO_SPACE = static_cast< size_t >(-1);
+
+   // the regions start on multiples of the alignment
+   static constexpr size_t REGION_ALIGNMENT = 256;
+
+   // constructor / destructor
+   explicit StreamRing( const size_t region_size, const FencePolicy & policy = FencePolicy( ) );
+           ~StreamRing( );
+
+   // size of each region and of the whole ring
+   size_t RegionSize( ) const { return mRegionSize; }
+   size_t Size( ) const { return mRegionSize * NUM_REGIONS; }
+
+   // the region being written and the bytes allocated from it
+   size_t Region( ) const { return mRegion; }
+   size_t Used( ) const { return mUsed; }
+
+   // indicates if a region is being written
+   bool IsWriting( ) const { return mWriting; }
+
+   // moves on to the next region, waiting for the gpu to finish reading it
+   void BeginRegion( );
+
+   // reserves bytes in the region being written, returning their offset from
+   // the start of the ring or NO_SPACE if they do not fit.  the alignment must
+   // be a power of two no larger than the region alignment.
+   size_t Allocate( const size_t size, const size_t alignment = 16 );
+
+   // fences the region once the commands that read it have been submitted
+   void EndRegion( );
+
+   // waits for and releases all the fences
+   void Flush( );
+
+   FencePolicy & Policy( ) { return mPolicy; }
+
+private:
+   // prohibit copy construction and assignment
+   StreamRing( const StreamRing & );
+   StreamRing & operator = ( const StreamRing & );
+
+   FencePolicy    mPolicy;
+
+   size_t         mRegionSize;
+   size_t         mRegion;
+   size_t         mUsed;
+   bool           mWriting;
+
+   // the fence of each region, if it has one
+   Fence          mFences[NUM_REGIONS];
+   bool           mFenced[NUM_REGIONS];
+
+};
+
+template < typename FencePolicy, size_t NUM_REGIONS >
+inline StreamRing< FencePolicy, NUM_REGIONS >::StreamRing( const size_t region_size, const FencePolicy & policy ) :
+mPolicy        ( policy ),
+mRegionSize    ( (region_size + REGION_ALIGNMENT - 1) / REGION_ALIGNMENT * REGION_ALIGNMENT ),
+mRegion        ( NUM_REGIONS - 1 ),
+mUsed          ( 0 ),
+mWriting       ( false )
+{
+   static_assert(NUM_REGIONS >= 2, "the ring needs a region for the cpu and one for the gpu");
+
+   for (size_t i = 0; i < NUM_REGIONS; ++i)
+   {
+      mFences[i] = Fence();
+      mFenced[i] = false;
+   }
+}
+
+template < typename FencePolicy, size_t NUM_REGIONS >
+inline StreamRing< FencePolicy, NUM_REGIONS >::~StreamRing( )
+{
+   for (size_t i = 0; i < NUM_REGIONS; ++i)
+   {
+      if (mFenced[i]) mPolicy.Delete(mFences[i]);
+   }
+}
+
+template < typename FencePolicy, size_t NUM_REGIONS >
+inline void StreamRing< FencePolicy, NUM_REGIONS >::BeginRegion( )
+{
+   WGL_ASSERT(!mWriting);
+
+   mRegion = (mRegion + 1) % NUM_REGIONS;
+
+   // the gpu may still be reading the frame that last wrote the region
+   if (mFenced[mRegion])
+   {
+      mPolicy.Wait(mFences[mRegion]);
+      mPolicy.Delete(mFences[mRegion]);
+
+      mFenced[mRegion] = false;
+   }
+
+   mUsed = 0;
+   mWriting = true;
+}
+
+template < typename FencePolicy, size_t NUM_REGIONS >
+inline size_t StreamRing< FencePolicy, NUM_REGIONS >::Allocate( const size_t size, const size_t alignment )
+{
+   WGL_ASSERT(mWriting);
+   WGL_ASSERT(alignment && !(alignment & (alignment - 1)) && alignment <= REGION_ALIGNMENT);
+
+   const size_t offset = (mUsed + alignment - 1) & ~(alignment - 1);
+
+   if (offset > mRegionSize || size > mRegionSize - offset) return NO_SPACE;
+
+   mUsed = offset + size;
+
+   return mRegion * mRegionSize + offset;
+}
+
+template < typename FencePolicy, size_t NUM_REGIONS >
+inline void StreamRing< FencePolicy, NUM_REGIONS >::EndRegion( )
+{
+   WGL_ASSERT(mWriting && !mFenced[mRegion]);
+
+   mFences[mRegion] = mPolicy.Insert();
+   mFenced[mRegion] = true;
+
+   mWriting = false;
+}
+
+template < typename FencePolicy, size_t NUM_REGIONS >
+inline void StreamRing< FencePolicy, NUM_REGIONS >::Flush( )
+{
+   for (size_t i = 0; i < NUM_REGIONS; ++i)
+   {
+      if (mFenced[i])
+      {
+         mPolicy.Wait(mFences[i]);
+         mPolicy.Delete(mFences[i]);
+
+         mFenced[i] = false;
+      }
+   }
+}
+
+#endif // _STREAM_RING_H_
@@ -3,12 +3,14 @@
 
 // wgl includes
 #include "ReadTexture.h"
+#include "TextureCache.h"
 
 // gl includes
 #include <GL/wglew.h>
 
 // std includes
 #include <cmath>
+#include <vector>
 #include <cstdint>
 #include <utility>
 #include <algorithm>
@@ -377,11 +379,19 @@ bool Texture::Load2D( const char * const pFilename,
    // must happen within a valid gl context
    WGL_ASSERT(wglGetCurrentContext());
 
-   bool texture_loaded = false;
-
    // try to read the texture
-   const TextureData< uint8_t > texture_data =
-      ReadTexture< uint8_t >(pFilename, intermediate_format);
+   return Load2D(ReadTexture< uint8_t >(pFilename, intermediate_format),
+                 internal_format, generate_mipmap);
+}
+
+bool Texture::Load2D( const TextureData< uint8_t > & texture_data,
+                      const GLenum internal_format,
+                      const bool generate_mipmap )
+{
+   // must happen within a valid gl context
+   WGL_ASSERT(wglGetCurrentContext());
+
+   bool texture_loaded = false;
 
    if (texture_data.pTexture)
    {
@@ -399,6 +409,66 @@ bool Texture::Load2D( const char * const pFilename,
    return texture_loaded;
 }
 
+bool Texture::Load2D( const TextureCache::Image & image )
+{
+   // must happen within a valid gl context
+   WGL_ASSERT(wglGetCurrentContext());
+
+   bool texture_loaded = false;
+
+   if (image.IsOpen())
+   {
+      // release the current texture if there is one
+      DeleteTexture();
+
+      // generate a new texture
+      glGenTextures(1, &mTexID);
+
+      if (mTexID)
+      {
+         const std::vector< TextureCache::Level > & levels = image.Levels();
+
+         // setup some attributes
+         mTexTarget = GL_TEXTURE_2D;
+         mTexWidth = levels.front().width;
+         mTexHeight = levels.front().height;
+         mTexIFormat = image.InternalFormat();
+
+         // get the current active texture unit 0
+         const GLuint current_active_tex_unit_0 = Texture::GetCurrentTexture(mTexTarget);
+
+         // bind this texture to texture unit 0
+         Bind(GL_TEXTURE0);
+
+         // allocate the whole chain and upload the blocks of each level as they are
+         glTexStorage2D(mTexTarget, static_cast< GLsizei >(levels.size()), mTexIFormat, mTexWidth, mTexHeight);
+
+         for (size_t i = 0; i < levels.size(); ++i)
+         {
+            glCompressedTexSubImage2D(mTexTarget, static_cast< GLint >(i), 0, 0,
+                                      levels[i].width, levels[i].height, mTexIFormat,
+                                      static_cast< GLsizei >(levels[i].size), levels[i].pBlocks);
+         }
+
+         // the call to a glTexStorage makes the texture object immutable
+         mTexIsImmutable = true;
+         mTexIsMipMapped = levels.size() > 1;
+
+         // setup basic attributes
+         SetParameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+         SetParameter(GL_TEXTURE_MIN_FILTER, mTexIsMipMapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+
+         // unbind the texture and restore the previous texture unit
+         Unbind(current_active_tex_unit_0);
+
+         // texture was loaded, assuming no errors
+         texture_loaded = true;
+      }
+   }
+
+   return texture_loaded;
+}
+
 // helper structures to choose the correct function
 // this version of the compiler still does not support inline templates to a function
 #define DEFINE_TEX_PARAM_FUNC_SELECTOR( type, func ) \
@@ -8,6 +8,13 @@
 #include <GL/glew.h>
 #include <GL/GL.h>
 
+// std includes
+#include <cstdint>
+
+// forward declarations
+template < typename T > struct TextureData;
+namespace TextureCache { class Image; }
+
 // defines invalid constants used by the texture class
 extern const GLenum INVALID_TEXTURE_TARGET;
 extern const GLenum INVALID_INTERNAL_TEXTURE_FORMAT;
@@ -79,6 +86,14 @@ public:
                 const GLenum internal_format,
                 const bool generate_mipmap = false );
 
+   // loads a texture already read from a file, such as one from the texture loader
+   bool Load2D( const TextureData< uint8_t > & texture_data,
+                const GLenum internal_format,
+                const bool generate_mipmap = false );
+
+   // loads the block compressed mip chain of a texture cache
+   bool Load2D( const TextureCache::Image & image );
+
    // sets the texture parameters
    template < typename T >
    void SetParameter( const GLenum param_name, const T param_value );
@@ -0,0 +1,306 @@
+// local includes
+#include "TextureCache.h"
+#include "ImageHelper.h"
+#include "ReadTexture.h"
+#include "WglAssert.h"
+
+// std includes
+#include <cstring>
+#include <utility>
+#include <algorithm>
+
+namespace TextureCache
+{
+
+namespace details
+{
+
+// identifies a cache and the version of its layout
+const uint32_t CACHE_MAGIC = 0x544c4757; // 'WGLT'
+const uint32_t CACHE_VERSION = 1;
+
+// alignment of each level from the start of the file
+const size_t LEVEL_ALIGNMENT = 16;
+
+// the start of the file, followed by the table of levels
+struct Header
+{
+   uint32_t    magic;
+   uint32_t    version;
+   uint64_t    source_size;
+   int64_t     source_time;
+   uint64_t    source_hash;
+   uint32_t    format;
+   uint32_t    internal_format;
+   uint32_t    width;
+   uint32_t    height;
+   uint32_t    num_levels;
+   uint32_t    reserved;
+};
+
+// an entry of the table of levels
+struct LevelEntry
+{
+   uint32_t    width;
+   uint32_t    height;
+   uint64_t    offset;
+   uint64_t    size;
+};
+
+static_assert(sizeof(Header) == 56, "the cache header must not be padded");
+static_assert(sizeof(LevelEntry) == 24, "the cache levels must not be padded");
+
+// components each format compresses from
+uint32_t SourceComponents( const BlockCompression::Format format, const uint32_t components )
+{
+   switch (format)
+   {
+   case BlockCompression::Format::BC4: return 1;
+   case BlockCompression::Format::BC5: return 2;
+   default: return components;
+   }
+}
+
+} // namespace details
+
+std::string CacheFilename( const char * const pSourceFilename )
+{
+   return std::string(pSourceFilename) + ".wgltex";
+}
+
+GLenum InternalFormat( const BlockCompression::Format format, const bool srgb )
+{
+   switch (format)
+   {
+   case BlockCompression::Format::BC1: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+   case BlockCompression::Format::BC3: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+   case BlockCompression::Format::BC4: return GL_COMPRESSED_RED_RGTC1;
+   case BlockCompression::Format::BC5: return GL_COMPRESSED_RG_RGTC2;
+   default: WGL_ASSERT(false); return GL_NONE;
+   }
+}
+
+std::vector< uint8_t > Serialize( const SourceStamp & source,
+                                  const uint8_t * const pPixels,
+                                  const uint32_t width,
+                                  const uint32_t height,
+                                  const uint32_t components,
+                                  const BlockCompression::Format format,
+                                  const bool srgb,
+                                  const bool parallel )
+{
+   WGL_ASSERT(pPixels && width && height);
+
+   // the channels of single and dual channel formats are packed by themselves,
+   // so the mipmaps only filter the components that are kept
+   const uint32_t base_components = details::SourceComponents(format, components);
+
+   std::vector< uint8_t > packed;
+   const uint8_t * pBase = pPixels;
+
+   if (base_components != components)
+   {
+      WGL_ASSERT(base_components < components);
+
+      const size_t num_pixels = static_cast< size_t >(width) * height;
+
+      packed.resize(num_pixels * base_components);
+
+      for (size_t i = 0; i < num_pixels; ++i)
+      {
+         std::copy(pPixels + i * components, pPixels + i * components + base_components, packed.data() + i * base_components);
+      }
+
+      pBase = packed.data();
+   }
+
+   const bool alpha_weighted = base_components == 4 && (format == BlockCompression::Format::BC1 || format == BlockCompression::Format::BC3);
+
+   const std::vector< ImageHelper::MipLevel > mipmaps =
+      ImageHelper::GenerateMipmaps(pBase, width, height, base_components,
+                                   ImageHelper::MipFilter::BOX, srgb, alpha_weighted, parallel);
+
+   const uint32_t num_levels = static_cast< uint32_t >(mipmaps.size() + 1);
+
+   const details::Header header =
+   {
+      details::CACHE_MAGIC,
+      details::CACHE_VERSION,
+      source.size,
+      source.time,
+      source.hash,
+      static_cast< uint32_t >(format),
+      InternalFormat(format, srgb),
+      width,
+      height,
+      num_levels,
+      0
+   };
+
+   std::vector< uint8_t > file(sizeof(header) + sizeof(details::LevelEntry) * num_levels);
+   std::vector< details::LevelEntry > levels;
+
+   // compresses each level straight into the file
+   for (uint32_t level = 0; level < num_levels; ++level)
+   {
+      const uint32_t level_width = level ? mipmaps[level - 1].width : width;
+      const uint32_t level_height = level ? mipmaps[level - 1].height : height;
+      const uint8_t * const pLevel = level ? mipmaps[level - 1].pixels.data() : pBase;
+
+      const size_t offset = (file.size() + details::LEVEL_ALIGNMENT - 1) / details::LEVEL_ALIGNMENT * details::LEVEL_ALIGNMENT;
+      const size_t size = BlockCompression::CompressedSize(format, level_width, level_height);
+
+      file.resize(offset + size);
+
+      BlockCompression::Compress(pLevel, level_width, level_height, base_components, format, file.data() + offset, parallel);
+
+      const details::LevelEntry entry = { level_width, level_height, offset, size };
+      levels.push_back(entry);
+   }
+
+   std::memcpy(file.data(), &header, sizeof(header));
+   std::memcpy(file.data() + sizeof(header), levels.data(), sizeof(details::LevelEntry) * levels.size());
+
+   return file;
+}
+
+Image::Image( ) :
+mFormat           ( BlockCompression::Format::BC1 ),
+mInternalFormat   ( GL_NONE )
+{
+}
+
+Image::~Image( )
+{
+}
+
+Image::Image( Image && image ) :
+Image()
+{
+   *this = std::move(image);
+}
+
+Image & Image::operator = ( Image && image )
+{
+   std::swap(mFile, image.mFile);
+   std::swap(mContents, image.mContents);
+   std::swap(mFormat, image.mFormat);
+   std::swap(mInternalFormat, image.mInternalFormat);
+   std::swap(mLevels, image.mLevels);
+
+   return *this;
+}
+
+bool Image::Open( const char * const pFilename, const SourceStamp & source )
+{
+   Close();
+
+   return mFile.Open(pFilename) && View(mFile.Data(), mFile.Size(), source);
+}
+
+bool Image::Open( std::vector< uint8_t > && contents, const SourceStamp & source )
+{
+   Close();
+
+   mContents = std::move(contents);
+
+   return View(mContents.data(), mContents.size(), source);
+}
+
+bool Image::View( const uint8_t * const pData, const size_t size, const SourceStamp & source )
+{
+   details::Header header = { };
+
+   if (size < sizeof(header)) { Close(); return false; }
+
+   std::memcpy(&header, pData, sizeof(header));
+
+   const bool current =
+      header.magic == details::CACHE_MAGIC &&
+      header.version == details::CACHE_VERSION &&
+      header.source_size == source.size &&
+      header.source_time == source.time &&
+      header.source_hash == source.hash &&
+      header.format <= static_cast< uint32_t >(BlockCompression::Format::BC5) &&
+      header.width && header.height &&
+      header.num_levels == ImageHelper::NumMipLevels(header.width, header.height) &&
+      header.num_levels <= (size - sizeof(header)) / sizeof(details::LevelEntry);
+
+   if (!current) { Close(); return false; }
+
+   mFormat = static_cast< BlockCompression::Format >(header.format);
+   mInternalFormat = header.internal_format;
+
+   // points the levels at the blocks, checking that each lies in the file
+   // and is the size of a level of the chain
+   uint32_t width = header.width;
+   uint32_t height = header.height;
+
+   for (uint32_t i = 0; i < header.num_levels; ++i)
+   {
+      details::LevelEntry entry = { };
+      std::memcpy(&entry, pData + sizeof(header) + sizeof(entry) * i, sizeof(entry));
+
+      const bool valid =
+         entry.width == width && entry.height == height &&
+         entry.size == BlockCompression::CompressedSize(mFormat, width, height) &&
+         entry.offset % details::LEVEL_ALIGNMENT == 0 &&
+         entry.offset <= size && entry.size <= size - entry.offset;
+
+      if (!valid) { Close(); return false; }
+
+      const Level level = { width, height, pData + entry.offset, static_cast< size_t >(entry.size) };
+      mLevels.push_back(level);
+
+      width = std::max< uint32_t >(width / 2, 1);
+      height = std::max< uint32_t >(height / 2, 1);
+   }
+
+   return true;
+}
+
+void Image::Close( )
+{
+   mLevels.clear();
+   mContents.clear();
+   mFile.Close();
+
+   mInternalFormat = GL_NONE;
+}
+
+bool Load( const char * const pFilename,
+           const BlockCompression::Format format,
+           const bool srgb,
+           Image & image,
+           const bool parallel )
+{
+   SourceStamp stamp = { };
+
+   if (!StampSource(pFilename, stamp)) return false;
+
+   const std::string cache_filename = CacheFilename(pFilename);
+
+   if (image.Open(cache_filename.c_str(), stamp) &&
+       image.BlockFormat() == format &&
+       image.InternalFormat() == InternalFormat(format, srgb))
+   {
+      return true;
+   }
+
+   // a mapped cache cannot be replaced
+   image.Close();
+
+   const TextureData< uint8_t > source = ReadTexture< uint8_t >(pFilename, GL_RGBA);
+
+   if (!source.pTexture) return false;
+
+   std::vector< uint8_t > contents =
+      Serialize(stamp, source.pTexture.get(), source.width, source.height, 4, format, srgb, parallel);
+
+   // use the contents as written, even if writing failed
+   Write(cache_filename.c_str(), contents);
+
+   return image.Open(std::move(contents), stamp);
+}
+
+} // namespace TextureCache
@@ -0,0 +1,122 @@
+#ifndef _TEXTURE_CACHE_H_
+#define _TEXTURE_CACHE_H_
+
+// local includes
+#include "MeshCache.h"
+#include "MappedFile.h"
+#include "BlockCompression.h"
+
+// gl includes
+#include <GL/glew.h>
+#include <GL/GL.h>
+
+// std includes
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// binary caches of block compressed textures (.wgltex).  a cache holds the
+// whole mip chain of a texture compressed for the gpu, so loading a cached
+// texture maps the cache and hands its levels straight to gl, without
+// decoding the source image, building the mipmaps, or leaving the driver
+// to compress them.
+namespace TextureCache
+{
+
+// the caches are stamped with their source the same way as the mesh caches
+using MeshCache::SourceStamp;
+using MeshCache::StampSource;
+using MeshCache::Write;
+
+// a level of the mip chain, pointing into the cache
+struct Level
+{
+   uint32_t          width;
+   uint32_t          height;
+   const uint8_t *   pBlocks;
+   size_t            size;
+};
+
+// name of the cache of a source file
+std::string CacheFilename( const char * const pSourceFilename );
+
+// internal format of the blocks for glCompressedTexSubImage2D
+GLenum InternalFormat( const BlockCompression::Format format, const bool srgb );
+
+// builds the mip chain of the 8 bit pixels and compresses every level into
+// the contents of a cache for the source with the given stamp.  srgb colors
+// are filtered in linear space and sampled as srgb, and the colors of bc1 and
+// bc3 textures with alpha are weighted by their alpha as they are filtered.
+std::vector< uint8_t > Serialize( const SourceStamp & source,
+                                  const uint8_t * const pPixels,
+                                  const uint32_t width,
+                                  const uint32_t height,
+                                  const uint32_t components,
+                                  const BlockCompression::Format format,
+                                  const bool srgb = false,
+                                  const bool parallel = false );
+
+// an open cache, mapped into memory
+class Image
+{
+public:
+   // constructor / destructor
+    Image( );
+   ~Image( );
+
+   // only allow move construction and assignment
+   Image( Image && image );
+   Image & operator = ( Image && image );
+
+   // maps the cache.  returns false if the cache is missing, was written by
+   // another version, is damaged, or is stale for the source stamp.
+   bool Open( const char * const pFilename, const SourceStamp & source );
+
+   // takes the contents of a cache from Serialize, for when the cache
+   // could not be written and the texture is used straight from memory
+   bool Open( std::vector< uint8_t > && contents, const SourceStamp & source );
+
+   void Close( );
+
+   // indicates if a cache is open
+   bool IsOpen( ) const { return !mLevels.empty(); }
+
+   BlockCompression::Format BlockFormat( ) const { return mFormat; }
+   GLenum InternalFormat( ) const { return mInternalFormat; }
+
+   // the levels of the mip chain, from the base down to 1x1
+   const std::vector< Level > & Levels( ) const { return mLevels; }
+
+private:
+   // prohibit copy construction and assignment
+   Image( const Image & );
+   Image & operator = ( const Image & );
+
+   // points the levels at the contents of the cache if they are valid
+   bool View( const uint8_t * const pData, const size_t size, const SourceStamp & source );
+
+   // the mapped cache or the contents taken in memory
+   MappedFile                 mFile;
+   std::vector< uint8_t >     mContents;
+
+   BlockCompression::Format   mFormat;
+   GLenum                     mInternalFormat;
+
+   std::vector< Level >       mLevels;
+
+};
+
+// opens the cache of the source texture for the format, reading and
+// compressing the source into a new cache when there is no cache yet, the
+// source changed since it was cached, or it was cached in another format.
+// returns false if neither the cache nor the source can be read.
+bool Load( const char * const pFilename,
+           const BlockCompression::Format format,
+           const bool srgb,
+           Image & image,
+           const bool parallel = false );
+
+} // namespace TextureCache
+
+#endif // _TEXTURE_CACHE_H_
@@ -0,0 +1,305 @@
+// local includes
+#include "TextureLoader.h"
+#include "MappedFile.h"
+#include "WglAssert.h"
+
+// std includes
+#include <map>
+#include <utility>
+#include <algorithm>
+
+namespace details
+{
+
+// touches every page of the mapped file, so the file is read in
+// by the worker before it waits to decode with resil
+void TouchPages( const uint8_t * const pData, const size_t size )
+{
+   // volatile keeps the reads from being optimized away
+   const volatile uint8_t * const pPages = pData;
+
+   for (size_t i = 0; i < size; i += 4096) pPages[i];
+}
+
+} // namespace details
+
+// pixel buffers released by the textures, kept by size for the textures that follow
+class TextureLoader::BufferPool : public std::enable_shared_from_this< TextureLoader::BufferPool >
+{
+public:
+   // constructor / destructor
+   explicit BufferPool( const size_t max_bytes ) :
+   mBytes      ( 0 ),
+   mMaxBytes   ( max_bytes )
+   {
+   }
+
+   ~BufferPool( )
+   {
+      for (const auto & buffer : mBuffers) delete [] buffer.second;
+   }
+
+   // obtains a buffer of at least size bytes...
+   // a released buffer is reused if it is no more than twice the size.
+   // the buffer comes back to the pool once the last reference is released.
+   std::shared_ptr< uint8_t > Acquire( const size_t size )
+   {
+      uint8_t * pBuffer = nullptr;
+      size_t capacity = size;
+
+      {
+         std::lock_guard< std::mutex > lock(mMutex);
+
+         const auto buffer = mBuffers.lower_bound(size);
+
+         if (buffer != mBuffers.end() && buffer->first / 2 <= size)
+         {
+            capacity = buffer->first;
+            pBuffer = buffer->second;
+
+            mBytes -= capacity;
+            mBuffers.erase(buffer);
+         }
+      }
+
+      if (!pBuffer) pBuffer = new uint8_t[capacity];
+
+      const std::weak_ptr< BufferPool > pPool = shared_from_this();
+
+      return std::shared_ptr< uint8_t >(pBuffer,
+      [ pPool, capacity ] ( uint8_t * const pBuffer )
+      {
+         // the loader may already be gone
+         if (const std::shared_ptr< BufferPool > pool = pPool.lock())
+         {
+            pool->Release(pBuffer, capacity);
+         }
+         else
+         {
+            delete [] pBuffer;
+         }
+      });
+   }
+
+private:
+   // prohibit copy construction and assignment
+   BufferPool( const BufferPool & );
+   BufferPool & operator = ( const BufferPool & );
+
+   // keeps the buffer unless the pool is full
+   void Release( uint8_t * const pBuffer, const size_t capacity )
+   {
+      {
+         std::lock_guard< std::mutex > lock(mMutex);
+
+         if (mBytes + capacity <= mMaxBytes)
+         {
+            mBytes += capacity;
+            mBuffers.emplace(capacity, pBuffer);
+
+            return;
+         }
+      }
+
+      delete [] pBuffer;
+   }
+
+   // protects the buffers
+   std::mutex                             mMutex;
+
+   // released buffers by their capacity
+   std::multimap< size_t, uint8_t * >     mBuffers;
+   size_t                                 mBytes;
+   const size_t                           mMaxBytes;
+
+};
+
+TextureLoader::TextureLoader( const size_t num_threads,
+                              const size_t max_queued,
+                              const size_t max_pooled_bytes ) :
+mNumQueued     ( 0 ),
+mNumReading    ( 0 ),
+mMaxQueued     ( std::max< size_t >(max_queued, 1) ),
+mpBufferPool   ( std::make_shared< BufferPool >(max_pooled_bytes) ),
+mStop          ( false )
+{
+   const size_t num_workers =
+      num_threads ? num_threads : std::max< size_t >(std::thread::hardware_concurrency(), 1);
+
+   mWorkers.reserve(num_workers);
+
+   for (size_t i = 0; i < num_workers; ++i)
+   {
+      mWorkers.emplace_back(&TextureLoader::Work, this);
+   }
+}
+
+TextureLoader::~TextureLoader( )
+{
+   std::deque< Request > requests[NUM_PRIORITIES];
+
+   {
+      std::lock_guard< std::mutex > lock(mMutex);
+
+      mStop = true;
+
+      // take the textures that have not been started
+      for (size_t priority = 0; priority < NUM_PRIORITIES; ++priority)
+      {
+         requests[priority].swap(mRequests[priority]);
+      }
+
+      mNumQueued = 0;
+   }
+
+   mRequested.notify_all();
+   mDequeued.notify_all();
+
+   for (std::thread & worker : mWorkers) worker.join();
+
+   // give the textures that were not started back without pixels
+   for (auto & queue : requests)
+   {
+      for (Request & request : queue)
+      {
+         request.promise.set_value(Result { request.filename, { 0, 0, request.format, GL_UNSIGNED_BYTE, nullptr } });
+      }
+   }
+}
+
+std::future< TextureLoader::Result > TextureLoader::Load( const char * const pFilename,
+                                                          const GLenum format,
+                                                          const Priority priority,
+                                                          const Callback & callback )
+{
+   WGL_ASSERT(pFilename);
+   WGL_ASSERT(priority < NUM_PRIORITIES);
+
+   Request request;
+   request.filename = pFilename;
+   request.format = format;
+   request.callback = callback;
+
+   std::future< Result > result = request.promise.get_future();
+
+   {
+      std::unique_lock< std::mutex > lock(mMutex);
+
+      // wait for room in the queue
+      mDequeued.wait(lock, [ this ] ( ) { return mNumQueued < mMaxQueued || mStop; });
+
+      mRequests[priority].push_back(std::move(request));
+      ++mNumQueued;
+   }
+
+   mRequested.notify_one();
+
+   return result;
+}
+
+size_t TextureLoader::Dispatch( const size_t max_callbacks )
+{
+   std::vector< std::pair< Callback, Result > > callbacks;
+
+   {
+      std::lock_guard< std::mutex > lock(mMutex);
+
+      const size_t num_callbacks = std::min(max_callbacks, mCallbacks.size());
+
+      callbacks.assign(std::make_move_iterator(mCallbacks.begin()),
+                       std::make_move_iterator(mCallbacks.begin() + num_callbacks));
+
+      mCallbacks.erase(mCallbacks.begin(), mCallbacks.begin() + num_callbacks);
+   }
+
+   // the callbacks may queue more textures, so run them without the lock
+   for (const auto & callback : callbacks)
+   {
+      callback.first(callback.second);
+   }
+
+   return callbacks.size();
+}
+
+void TextureLoader::Wait( )
+{
+   std::unique_lock< std::mutex > lock(mMutex);
+
+   mFinished.wait(lock, [ this ] ( ) { return !mNumQueued && !mNumReading; });
+}
+
+size_t TextureLoader::NumPending( ) const
+{
+   std::lock_guard< std::mutex > lock(mMutex);
+
+   return mNumQueued + mNumReading;
+}
+
+void TextureLoader::Work( )
+{
+   const std::shared_ptr< BufferPool > pBufferPool = mpBufferPool;
+
+   const std::function< std::shared_ptr< uint8_t > ( const size_t ) > Allocate =
+   [ &pBufferPool ] ( const size_t size ) { return pBufferPool->Acquire(size); };
+
+   for (;;)
+   {
+      Request request;
+
+      {
+         std::unique_lock< std::mutex > lock(mMutex);
+
+         mRequested.wait(lock, [ this ] ( ) { return mNumQueued || mStop; });
+
+         if (mStop) break;
+
+         // take the oldest texture of the highest priority
+         for (size_t priority = NUM_PRIORITIES; priority--; )
+         {
+            if (!mRequests[priority].empty())
+            {
+               request = std::move(mRequests[priority].front());
+               mRequests[priority].pop_front();
+
+               break;
+            }
+         }
+
+         --mNumQueued;
+         ++mNumReading;
+      }
+
+      mDequeued.notify_one();
+
+      Result result = { request.filename, { 0, 0, request.format, GL_UNSIGNED_BYTE, nullptr } };
+
+      // the file is mapped and read in before decoding, so only the decode
+      // itself waits on the other workers
+      MappedFile file;
+
+      if (file.Open(request.filename.c_str()))
+      {
+         details::TouchPages(file.Data(), file.Size());
+
+         ReadTexture< uint8_t >(request.filename.c_str(), file.Data(), file.Size(), request.format,
+                                result.texture.width, result.texture.height, Allocate, result.texture.pTexture);
+      }
+
+      if (request.callback)
+      {
+         std::lock_guard< std::mutex > lock(mMutex);
+
+         mCallbacks.emplace_back(std::move(request.callback), result);
+      }
+
+      request.promise.set_value(std::move(result));
+
+      {
+         std::lock_guard< std::mutex > lock(mMutex);
+
+         --mNumReading;
+      }
+
+      mFinished.notify_all();
+   }
+}
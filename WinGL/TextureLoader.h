@@ -0,0 +1,131 @@
+#ifndef _TEXTURE_LOADER_H_
+#define _TEXTURE_LOADER_H_
+
+// local includes
+#include "ReadTexture.h"
+
+// gl includes
+#include "GL/glew.h"
+#include <GL/GL.h>
+
+// std includes
+#include <deque>
+#include <mutex>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <future>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <condition_variable>
+
+// reads textures on a pool of worker threads...
+// the workers read the files and decode them into pooled pixel buffers, and
+// the results come back through futures or through callbacks that run on the
+// thread that calls Dispatch.  uploading stays on the thread with the gl
+// context, so many textures can decode while the earlier ones upload.
+class TextureLoader
+{
+public:
+   // order the waiting textures are read in
+   enum Priority
+   {
+      PRIORITY_LOW,
+      PRIORITY_NORMAL,
+      PRIORITY_HIGH,
+      NUM_PRIORITIES
+   };
+
+   // a texture that has been read...
+   // the pixels are null if the texture could not be read.  the pixels go
+   // back to the pool once the last copy of the texture data is released.
+   struct Result
+   {
+      std::string                filename;
+      TextureData< uint8_t >     texture;
+   };
+
+   // called with the texture once it has been read
+   typedef std::function< void ( const Result & ) > Callback;
+
+   // constructor / destructor...
+   // zero threads starts one per hardware thread.  loads block while max_queued
+   // textures are waiting, and up to max_pooled_bytes of released pixels are
+   // kept for the textures that follow.
+   explicit TextureLoader( const size_t num_threads = 0,
+                           const size_t max_queued = 64,
+                           const size_t max_pooled_bytes = 64 * 1024 * 1024 );
+   // waits for the textures being read, the textures still waiting are
+   // given back without pixels and their callbacks are not run
+   ~TextureLoader( );
+
+   // queues the texture to be read in the format (GL_RGB, GL_RGBA, GL_BGR or
+   // GL_BGRA).  the callback is run from Dispatch once the texture is read.
+   std::future< Result > Load( const char * const pFilename,
+                               const GLenum format = GL_RGBA,
+                               const Priority priority = PRIORITY_NORMAL,
+                               const Callback & callback = Callback() );
+
+   // runs the callbacks of the textures that have been read on the calling
+   // thread, which should be the thread with the gl context to upload them.
+   // returns the number of callbacks run.
+   size_t Dispatch( const size_t max_callbacks = std::numeric_limits< size_t >::max() );
+
+   // waits until every texture queued so far has been read
+   void Wait( );
+
+   // number of textures that are waiting or being read
+   size_t NumPending( ) const;
+
+private:
+   // prohibit copy construction and assignment
+   TextureLoader( const TextureLoader & );
+   TextureLoader & operator = ( const TextureLoader & );
+
+   // pixel buffers kept for reuse
+   class BufferPool;
+
+   // a texture waiting to be read
+   struct Request
+   {
+      std::string                filename;
+      GLenum                     format;
+      Callback                   callback;
+      std::promise< Result >     promise;
+   };
+
+   // reads the waiting textures until the loader is destroyed
+   void Work( );
+
+   // protects everything below
+   mutable std::mutex                           mMutex;
+
+   // signals the workers, the threads waiting for space in the queue,
+   // and the threads waiting for the textures to be read
+   std::condition_variable                      mRequested;
+   std::condition_variable                      mDequeued;
+   std::condition_variable                      mFinished;
+
+   // textures waiting to be read, a queue per priority
+   std::deque< Request >                        mRequests[NUM_PRIORITIES];
+   size_t                                       mNumQueued;
+   size_t                                       mNumReading;
+   const size_t                                 mMaxQueued;
+
+   // textures read with callbacks waiting to be dispatched
+   std::vector< std::pair< Callback, Result > > mCallbacks;
+
+   // pixel buffers shared with the textures that are handed out
+   std::shared_ptr< BufferPool >                mpBufferPool;
+
+   // indicates the workers should stop
+   bool                                         mStop;
+
+   std::vector< std::thread >                   mWorkers;
+
+};
+
+#endif // _TEXTURE_LOADER_H_
@@ -1,17 +1,19 @@
 #ifndef _TIMER_H_
 #define _TIMER_H_
 
-// platform includes
-#include <windows.h>
-
 // std includes
 #include <ratio>
 #include <chrono>
+#include <thread>
 #include <cstdint>
 
 class Timer
 {
 public:
+   // underlying monotonic clock...
+   // ticks are counts of the clock period
+   typedef std::chrono::steady_clock   Clock;
+
    // constructor / destructor
     Timer( );
    ~Timer( );
@@ -36,25 +38,11 @@ public:
 
 private:
    // private static member variables
-   static const double  MSEC_PER_TICK;
+   static constexpr double MSEC_PER_TICK =
+      1000.0 * Clock::period::num / Clock::period::den;
 
 };
 
-namespace details
-{
-
-double GetDeltaTimeMSecPerTick( )
-{
-   uint64_t freqCPU = 0;
-   QueryPerformanceFrequency(reinterpret_cast< LARGE_INTEGER * >(&freqCPU));
-
-   return 1000.0 / freqCPU;
-}
-
-} // namespace details
-
-const double Timer::MSEC_PER_TICK = details::GetDeltaTimeMSecPerTick();
-
 inline Timer::Timer( )
 {
 }
@@ -65,10 +53,7 @@ inline Timer::~Timer( )
 
 inline int64_t Timer::GetCurrentTick( ) const
 {
-   int64_t curTick = 0;
-   QueryPerformanceCounter(reinterpret_cast< LARGE_INTEGER * >(&curTick));
-
-   return curTick;
+   return static_cast< int64_t >(Clock::now().time_since_epoch().count());
 }
 
 inline double Timer::GetCurrentTimeSec( ) const
@@ -98,7 +83,7 @@ inline double Timer::DeltaSec( const int64_t rTick ) const
 
 inline void Timer::Wait( const uint32_t nMS ) const
 {
-   Sleep(nMS);
+   std::this_thread::sleep_for(std::chrono::milliseconds(nMS));
 }
 
 template < typename T, typename P >
@@ -107,4 +92,4 @@ inline void Timer::Wait( const std::chrono::duration< T, P > duration ) const
    Wait(std::chrono::duration_cast< std::chrono::duration< uint32_t, std::milli > >(duration).count());
 }
 
-#endif // _TIMER_H_
\ No newline at end of file
+#endif // _TIMER_H_
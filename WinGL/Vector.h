@@ -15,8 +15,10 @@
 // even with the use of the enable_if_t, the compiler
 // includes all the declarations of the class interface,
 // even the ones considered an error.
+#if defined( _MSC_VER )
 #pragma warning( push )
 #pragma warning( disable : 4521 )
+#endif // _MSC_VER
 
 template < typename T, uint32_t SIZE >
 class Vector
@@ -31,88 +33,87 @@ public:
    // only support 2, 3, and 4 component vectors
    static_assert(SIZE == 2 || SIZE == 3 || SIZE == 4, "only support 2, 3, and 4 component vectors");
 
-    // constructor / destructor
-    Vector( );
-    Vector( const T & s );
-    template < typename U, typename = std::enable_if_t< SIZE == 2 > >
-    Vector( const U & x, const U & y );
-    template < typename = std::enable_if_t< SIZE == 2 > >
-    Vector( const T & x, const T & y );
-    template < typename U, typename = std::enable_if_t< SIZE == 3 > >
-    Vector( const U & x, const U & y, const U & z );
-    template < typename = std::enable_if_t< SIZE == 3 > >
-    Vector( const T & x, const T & y, const T & z );
-    template < typename U, typename = std::enable_if_t< SIZE == 4 > >
-    Vector( const U & x, const U & y, const U & z, const U & w = 1 );
-    template < typename = std::enable_if_t< SIZE == 4 > >
-    Vector( const T & x, const T & y, const T & z, const T & w = 1 );
-    template < typename U, typename = std::enable_if_t< SIZE == 4 > >
-    Vector( const Vector< U, 3 > & vec, const U & w = 1 );
-    template < typename = std::enable_if_t< SIZE == 4 > >
-    Vector( const Vector< T, 3 > & vec, const T & w = 1 );
+    // constructors
+    // the copy constructor, copy assignment and destructor are left to the
+    // compiler so the type stays trivially copyable
+    constexpr Vector( );
+    constexpr Vector( const T & s );
+    template < typename U, uint32_t S = SIZE, typename = std::enable_if_t< S == 2 > >
+    constexpr Vector( const U & x, const U & y );
+    template < uint32_t S = SIZE, typename = std::enable_if_t< S == 2 > >
+    constexpr Vector( const T & x, const T & y );
+    template < typename U, uint32_t S = SIZE, typename = std::enable_if_t< S == 3 > >
+    constexpr Vector( const U & x, const U & y, const U & z );
+    template < uint32_t S = SIZE, typename = std::enable_if_t< S == 3 > >
+    constexpr Vector( const T & x, const T & y, const T & z );
+    template < typename U, uint32_t S = SIZE, typename = std::enable_if_t< S == 4 > >
+    constexpr Vector( const U & x, const U & y, const U & z, const U & w = 1 );
+    template < uint32_t S = SIZE, typename = std::enable_if_t< S == 4 > >
+    constexpr Vector( const T & x, const T & y, const T & z, const T & w = 1 );
+    template < typename U, uint32_t S = SIZE, typename = std::enable_if_t< S == 4 > >
+    constexpr Vector( const Vector< U, 3 > & vec, const U & w = 1 );
+    template < uint32_t S = SIZE, typename = std::enable_if_t< S == 4 > >
+    constexpr Vector( const Vector< T, 3 > & vec, const T & w = 1 );
     template < typename U >
-    Vector( const Vector< U, SIZE > & vec );
-    Vector( const Vector< T, SIZE > & vec );
+    constexpr Vector( const Vector< U, SIZE > & vec );
     template < typename U >
-    Vector( const U u[SIZE] );
-    Vector( const T t[SIZE] );
-   ~Vector( );
+    constexpr Vector( const U u[SIZE] );
+    constexpr Vector( const T t[SIZE] );
 
    // operator =
    template < typename U >
-   Vector< T, SIZE > & operator = ( const Vector< U, SIZE > & vec );
-   Vector< T, SIZE > & operator = ( const Vector< T, SIZE > & vec );
+   constexpr Vector< T, SIZE > & operator = ( const Vector< U, SIZE > & vec );
    template < typename U >
-   Vector< T, SIZE > & operator = ( const U u[SIZE] );
-   Vector< T, SIZE > & operator = ( const T t[SIZE] );
+   constexpr Vector< T, SIZE > & operator = ( const U u[SIZE] );
+   constexpr Vector< T, SIZE > & operator = ( const T t[SIZE] );
 
    // scalar operator *
    template < typename U >
-   Vector< T, SIZE > operator * ( const U & u ) const;
-   Vector< T, SIZE > operator * ( const T & t ) const;
+   constexpr Vector< T, SIZE > operator * ( const U & u ) const;
+   constexpr Vector< T, SIZE > operator * ( const T & t ) const;
    template < typename U >
-   Vector< T, SIZE > & operator *= ( const U & u );
-   Vector< T, SIZE > & operator *= ( const T & t );
+   constexpr Vector< T, SIZE > & operator *= ( const U & u );
+   constexpr Vector< T, SIZE > & operator *= ( const T & t );
 
    // operator * (dot product)
    template < typename U >
-   T operator * ( const Vector< U, SIZE > & vec ) const;
-   T operator * ( const Vector< T, SIZE > & vec ) const;
+   constexpr T operator * ( const Vector< U, SIZE > & vec ) const;
+   constexpr T operator * ( const Vector< T, SIZE > & vec ) const;
    template < typename U >
-   T operator * ( const U u[SIZE] ) const;
-   T operator * ( const T t[SIZE] ) const;
+   constexpr T operator * ( const U u[SIZE] ) const;
+   constexpr T operator * ( const T t[SIZE] ) const;
 
    // operator ^ (cross product)
    template < typename U >
-   Vector< T, SIZE > operator ^ ( const Vector< U, SIZE > & vec ) const;
-   Vector< T, SIZE > operator ^ ( const Vector< T, SIZE > & vec ) const;
+   constexpr Vector< T, SIZE > operator ^ ( const Vector< U, SIZE > & vec ) const;
+   constexpr Vector< T, SIZE > operator ^ ( const Vector< T, SIZE > & vec ) const;
    template < typename U >
-   Vector< T, SIZE > & operator ^= ( const Vector< U, SIZE > & vec );
-   Vector< T, SIZE > & operator ^= ( const Vector< T, SIZE > & vec );
+   constexpr Vector< T, SIZE > & operator ^= ( const Vector< U, SIZE > & vec );
+   constexpr Vector< T, SIZE > & operator ^= ( const Vector< T, SIZE > & vec );
 
    // operator % (component multiplication)
    template < typename U >
-   Vector< T, SIZE > operator % ( const Vector< U, SIZE > & vec ) const;
-   Vector< T, SIZE > operator % ( const Vector< T, SIZE > & vec ) const;
+   constexpr Vector< T, SIZE > operator % ( const Vector< U, SIZE > & vec ) const;
+   constexpr Vector< T, SIZE > operator % ( const Vector< T, SIZE > & vec ) const;
    template < typename U >
-   Vector< T, SIZE > & operator %= ( const Vector< U, SIZE > & vec );
-   Vector< T, SIZE > & operator %= ( const Vector< T, SIZE > & vec );
+   constexpr Vector< T, SIZE > & operator %= ( const Vector< U, SIZE > & vec );
+   constexpr Vector< T, SIZE > & operator %= ( const Vector< T, SIZE > & vec );
 
    // operator -
    template < typename U >
-   Vector< T, SIZE > operator - ( const Vector< U, SIZE > & vec ) const;
-   Vector< T, SIZE > operator - ( const Vector< T, SIZE > & vec ) const;
+   constexpr Vector< T, SIZE > operator - ( const Vector< U, SIZE > & vec ) const;
+   constexpr Vector< T, SIZE > operator - ( const Vector< T, SIZE > & vec ) const;
    template < typename U >
-   Vector< T, SIZE > & operator -= ( const Vector< U, SIZE > & vec );
-   Vector< T, SIZE > & operator -= ( const Vector< T, SIZE > & vec );
+   constexpr Vector< T, SIZE > & operator -= ( const Vector< U, SIZE > & vec );
+   constexpr Vector< T, SIZE > & operator -= ( const Vector< T, SIZE > & vec );
 
    // operator +
    template < typename U >
-   Vector< T, SIZE > operator + ( const Vector< U, SIZE > & vec ) const;
-   Vector< T, SIZE > operator + ( const Vector< T, SIZE > & vec ) const;
+   constexpr Vector< T, SIZE > operator + ( const Vector< U, SIZE > & vec ) const;
+   constexpr Vector< T, SIZE > operator + ( const Vector< T, SIZE > & vec ) const;
    template < typename U >
-   Vector< T, SIZE > & operator += ( const Vector< U, SIZE > & vec );
-   Vector< T, SIZE > & operator += ( const Vector< T, SIZE > & vec );
+   constexpr Vector< T, SIZE > & operator += ( const Vector< U, SIZE > & vec );
+   constexpr Vector< T, SIZE > & operator += ( const Vector< T, SIZE > & vec );
 
    // operator ==
    template < typename U >
@@ -140,38 +141,38 @@ public:
    operator Vector< U, SIZE > ( ) const;
 
    // basic accessors into the array
-   T & X( );
-   T & Y( );
-   T & Z( );
-   T & W( );
+   constexpr T & X( );
+   constexpr T & Y( );
+   constexpr T & Z( );
+   constexpr T & W( );
 
-   const T & X( ) const;
-   const T & Y( ) const;
-   const T & Z( ) const;
-   const T & W( ) const;
+   constexpr const T & X( ) const;
+   constexpr const T & Y( ) const;
+   constexpr const T & Z( ) const;
+   constexpr const T & W( ) const;
 
    // sets the components
    template < typename U >
    void Set( const Vector< U, SIZE > & vec );
    void Set( const Vector< T, SIZE > & vec );
-   template < typename U, typename = std::enable_if_t< SIZE == 2 > >
+   template < typename U, uint32_t S = SIZE, typename = std::enable_if_t< S == 2 > >
    void Set( const U & x, const U & y );
-   template < typename = std::enable_if_t< SIZE == 2 > >
+   template < uint32_t S = SIZE, typename = std::enable_if_t< S == 2 > >
    void Set( const T & x, const T & y );
-   template < typename U, typename = std::enable_if_t< SIZE == 3 > >
+   template < typename U, uint32_t S = SIZE, typename = std::enable_if_t< S == 3 > >
    void Set( const U & x, const U & y, const U & z );
-   template < typename = std::enable_if_t< SIZE == 3 > >
+   template < uint32_t S = SIZE, typename = std::enable_if_t< S == 3 > >
    void Set( const T & x, const T & y, const T & z );
-   template < typename U, typename = std::enable_if_t< SIZE == 4 > >
+   template < typename U, uint32_t S = SIZE, typename = std::enable_if_t< S == 4 > >
    void Set( const U & x, const U & y, const U & z, const U & w = 1 );
-   template < typename = std::enable_if_t< SIZE == 2 > >
+   template < uint32_t S = SIZE, typename = std::enable_if_t< S == 4 > >
    void Set( const T & x, const T & y, const T & z, const T & w = 1 );
    template < typename U >
    void Set( const U * const pXYZ );
    void Set( const T * const pXYZ );
 
    // makes a zero vector
-   Vector< T, SIZE > &  MakeZeroVector( );
+   constexpr Vector< T, SIZE > &  MakeZeroVector( );
 
    // makes the vector a unit vector
    T  Normalize( );
@@ -182,7 +183,7 @@ public:
    T  Length( ) const;
 
    // returns the size of the vector
-   uint32_t Size( ) const;
+   constexpr uint32_t Size( ) const;
 
    // vector class should be simple and allow
    // easy access to the member variables
@@ -191,127 +192,110 @@ public:
 };
 
 template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE >::Vector( )
+inline constexpr Vector< T, SIZE >::Vector( ) :
+mT { }
 {
    MakeZeroVector();
 }
 
 template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE >::Vector( const T & s )
+inline constexpr Vector< T, SIZE >::Vector( const T & s ) :
+mT { }
 {
-   std::for_each(mT, mT + SIZE, [ &s ] ( T & t ) { t = s; });
+   for (uint32_t i = 0; i < SIZE; ++i) mT[i] = s;
 }
 
 template < typename T, uint32_t SIZE >
-template < typename U, typename >
-inline Vector< T, SIZE >::Vector( const U & x, const U & y )
+template < typename U, uint32_t S, typename >
+inline constexpr Vector< T, SIZE >::Vector( const U & x, const U & y ) :
+mT { static_cast< T >(x), static_cast< T >(y) }
 {
-   mT[0] = x; mT[1] = y;
 }
 
 template < typename T, uint32_t SIZE >
-template < typename >
-inline Vector< T, SIZE >::Vector( const T & x, const T & y )
+template < uint32_t S, typename >
+inline constexpr Vector< T, SIZE >::Vector( const T & x, const T & y ) :
+mT { x, y }
 {
-   mT[0] = x; mT[1] = y;
 }
 
 template < typename T, uint32_t SIZE >
-template < typename U, typename >
-inline Vector< T, SIZE >::Vector( const U & x, const U & y, const U & z )
+template < typename U, uint32_t S, typename >
+inline constexpr Vector< T, SIZE >::Vector( const U & x, const U & y, const U & z ) :
+mT { static_cast< T >(x), static_cast< T >(y), static_cast< T >(z) }
 {
-   mT[0] = x; mT[1] = y; mT[2] = z;
 }
 
 template < typename T, uint32_t SIZE >
-template < typename >
-inline Vector< T, SIZE >::Vector( const T & x, const T & y, const T & z )
+template < uint32_t S, typename >
+inline constexpr Vector< T, SIZE >::Vector( const T & x, const T & y, const T & z ) :
+mT { x, y, z }
 {
-   mT[0] = x; mT[1] = y; mT[2] = z;
 }
 
 template < typename T, uint32_t SIZE >
-template < typename U, typename >
-inline Vector< T, SIZE >::Vector( const U & x, const U & y, const U & z, const U & w )
+template < typename U, uint32_t S, typename >
+inline constexpr Vector< T, SIZE >::Vector( const U & x, const U & y, const U & z, const U & w ) :
+mT { static_cast< T >(x), static_cast< T >(y), static_cast< T >(z), static_cast< T >(w) }
 {
-   mT[0] = x; mT[1] = y; mT[2] = z; mT[3] = w;
 }
 
 template < typename T, uint32_t SIZE >
-template < typename >
-inline Vector< T, SIZE >::Vector( const T & x, const T & y, const T & z, const T & w )
+template < uint32_t S, typename >
+inline constexpr Vector< T, SIZE >::Vector( const T & x, const T & y, const T & z, const T & w ) :
+mT { x, y, z, w }
 {
-   mT[0] = x; mT[1] = y; mT[2] = z; mT[3] = w;
 }
 
 template < typename T, uint32_t SIZE >
-template < typename U, typename >
-inline Vector< T, SIZE >::Vector( const Vector< U, 3 > & vec, const U & w )
+template < typename U, uint32_t S, typename >
+inline constexpr Vector< T, SIZE >::Vector( const Vector< U, 3 > & vec, const U & w ) :
+mT { static_cast< T >(vec.mT[0]), static_cast< T >(vec.mT[1]), static_cast< T >(vec.mT[2]), static_cast< T >(w) }
 {
-   mT[0] = vec.mT[0]; mT[1] = vec.mT[1]; mT[2] = vec.mT[2]; mT[3] = w;
 }
 
 template < typename T, uint32_t SIZE >
-template < typename >
-inline Vector< T, SIZE >::Vector( const Vector< T, 3 > & vec, const T & w )
+template < uint32_t S, typename >
+inline constexpr Vector< T, SIZE >::Vector( const Vector< T, 3 > & vec, const T & w ) :
+mT { vec.mT[0], vec.mT[1], vec.mT[2], w }
 {
-   mT[0] = vec.mT[0]; mT[1] = vec.mT[1]; mT[2] = vec.mT[2]; mT[3] = w;
 }
 
 template < typename T, uint32_t SIZE >
 template < typename U >
-inline Vector< T, SIZE >::Vector( const Vector< U, SIZE > & vec )
+inline constexpr Vector< T, SIZE >::Vector( const Vector< U, SIZE > & vec ) :
+mT { }
 {
-   std::for_each(mT, mT + SIZE, [ this, &vec ] ( T & t ) { t = vec.mT[std::distance(mT, &t)]; });
-}
-
-template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE >::Vector( const Vector< T, SIZE > & vec )
-{
-   std::memcpy(mT, vec.mT, sizeof(mT));
+   for (uint32_t i = 0; i < SIZE; ++i) mT[i] = static_cast< T >(vec.mT[i]);
 }
 
 template < typename T, uint32_t SIZE >
 template < typename U >
-inline Vector< T, SIZE >::Vector( const U u[SIZE] )
-{
-   std::for_each(mT, mT + SIZE, [ this, &u ] ( T & t ) { t = u[std::distance(mT, &t)]; });
-}
-
-template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE >::Vector( const T t[SIZE] )
+inline constexpr Vector< T, SIZE >::Vector( const U u[SIZE] ) :
+mT { }
 {
-   std::memcpy(mT, t, sizeof(mT));
+   for (uint32_t i = 0; i < SIZE; ++i) mT[i] = static_cast< T >(u[i]);
 }
 
 template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE >::~Vector(  )
+inline constexpr Vector< T, SIZE >::Vector( const T t[SIZE] ) :
+mT { }
 {
+   for (uint32_t i = 0; i < SIZE; ++i) mT[i] = t[i];
 }
 
 template < typename T, uint32_t SIZE >
 template < typename U >
-inline Vector< T, SIZE > & Vector< T, SIZE >::operator = ( const Vector< U, SIZE > & vec )
-{
-   std::for_each(mT, mT + SIZE, [ this, &vec ] ( T & t ) { t = vec.mT[std::distance(mT, &t)]; });
-
-   return *this;
-}
-
-template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE > & Vector< T, SIZE >::operator = ( const Vector< T, SIZE > & vec )
+inline constexpr Vector< T, SIZE > & Vector< T, SIZE >::operator = ( const Vector< U, SIZE > & vec )
 {
-   if (this != &vec)
-   {
-      std::memcpy(mT, vec.mT, sizeof(mT));
-   }
+   for (uint32_t i = 0; i < SIZE; ++i) mT[i] = static_cast< T >(vec.mT[i]);
 
    return *this;
 }
 
 template < typename T, uint32_t SIZE >
 template < typename U >
-inline Vector< T, SIZE > & Vector< T, SIZE >::operator = ( const U u[SIZE] )
+inline constexpr Vector< T, SIZE > & Vector< T, SIZE >::operator = ( const U u[SIZE] )
 {
    *this = Vector< U, SIZE >(u);
 
@@ -319,7 +303,7 @@ inline Vector< T, SIZE > & Vector< T, SIZE >::operator = ( const U u[SIZE] )
 }
 
 template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE > & Vector< T, SIZE >::operator = ( const T t[SIZE] )
+inline constexpr Vector< T, SIZE > & Vector< T, SIZE >::operator = ( const T t[SIZE] )
 {
    *this = Vector< T, SIZE >(t);
 
@@ -328,79 +312,74 @@ inline Vector< T, SIZE > & Vector< T, SIZE >::operator = ( const T t[SIZE] )
 
 template < typename T, uint32_t SIZE >
 template < typename U >
-inline Vector< T, SIZE > Vector< T, SIZE >::operator * ( const U & u ) const
+inline constexpr Vector< T, SIZE > Vector< T, SIZE >::operator * ( const U & u ) const
 {
-   return Vector< T, SIZE >(*this) *= u;
+   T result[SIZE] = { };
+
+   for (uint32_t i = 0; i < SIZE; ++i) result[i] = mT[i] * u;
+
+   return Vector< T, SIZE >(result);
 }
 
 template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE > Vector< T, SIZE >::operator * ( const T & t ) const
+inline constexpr Vector< T, SIZE > Vector< T, SIZE >::operator * ( const T & t ) const
 {
-   return Vector< T, SIZE >(*this) *= t;
+   T result[SIZE] = { };
+
+   for (uint32_t i = 0; i < SIZE; ++i) result[i] = mT[i] * t;
+
+   return Vector< T, SIZE >(result);
 }
 
 template < typename T, uint32_t SIZE >
 template < typename U >
-inline Vector< T, SIZE > & Vector< T, SIZE >::operator *= ( const U & u )
+inline constexpr Vector< T, SIZE > & Vector< T, SIZE >::operator *= ( const U & u )
 {
-   std::for_each(mT, mT + SIZE, [ &u ] ( T & t ) { t *= u; });
+   for (uint32_t i = 0; i < SIZE; ++i) mT[i] *= u;
 
    return *this;
 }
 
 template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE > & Vector< T, SIZE >::operator *= ( const T & t )
+inline constexpr Vector< T, SIZE > & Vector< T, SIZE >::operator *= ( const T & t )
 {
-   std::for_each(mT, mT + SIZE, [ &t ] ( T & mt ) { mt *= t; });
+   for (uint32_t i = 0; i < SIZE; ++i) mT[i] *= t;
 
    return *this;
 }
 
 template < typename T, uint32_t SIZE >
 template < typename U >
-inline T Vector< T, SIZE >::operator * ( const Vector< U, SIZE > & vec ) const
+inline constexpr T Vector< T, SIZE >::operator * ( const Vector< U, SIZE > & vec ) const
 {
    return *this * vec.mT;
 }
 
 template < typename T, uint32_t SIZE >
-inline T Vector< T, SIZE >::operator * ( const Vector< T, SIZE > & vec ) const
+inline constexpr T Vector< T, SIZE >::operator * ( const Vector< T, SIZE > & vec ) const
 {
    return *this * vec.mT;
 }
 
 template < typename T, uint32_t SIZE >
 template < typename U >
-inline T Vector< T, SIZE >::operator * ( const U u[SIZE] ) const
+inline constexpr T Vector< T, SIZE >::operator * ( const U u[SIZE] ) const
 {
    T dot = 0;
 
-   std::for_each(mT, mT + SIZE, [ this, &u, &dot ] ( const T & t ) { dot += (t * u[std::distance(mT, &t)]); });
-   
+   for (uint32_t i = 0; i < SIZE; ++i) dot += mT[i] * u[i];
+
    return dot;
 }
 
 template < typename T, uint32_t SIZE >
-inline T Vector< T, SIZE >::operator * ( const T t[SIZE] ) const
+inline constexpr T Vector< T, SIZE >::operator * ( const T t[SIZE] ) const
 {
    T dot = 0;
 
-   std::for_each(mT, mT + SIZE, [ this, &t, &dot ] ( const T & mt ) { dot += (mt * t[std::distance(mT, &mt)]); });
-   
-   return dot;
-}
-
-template < typename T, uint32_t SIZE >
-template < typename U >
-inline Vector< T, SIZE > Vector< T, SIZE >::operator ^ ( const Vector< U, SIZE > & vec ) const
-{
-   return Vector< T, SIZE >(*this) ^= vec;
-}
+   for (uint32_t i = 0; i < SIZE; ++i) dot += mT[i] * t[i];
 
-template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE > Vector< T, SIZE >::operator ^ ( const Vector< T, SIZE > & vec ) const
-{
-   return Vector< T, SIZE >(*this) ^= vec;
+   return dot;
 }
 
 namespace details
@@ -414,7 +393,7 @@ inline Vector< T, 2 > vector_cross( const Vector< T, 2 > & lhs, const Vector< U,
 }
 
 template < typename T, typename U >
-inline Vector< T, 3 > vector_cross( const Vector< T, 3 > & lhs, const Vector< U, 3 > & rhs )
+inline constexpr Vector< T, 3 > vector_cross( const Vector< T, 3 > & lhs, const Vector< U, 3 > & rhs )
 {
    return Vector< T, 3 >((lhs.mT[1] * rhs.mT[2]) - (lhs.mT[2] * rhs.mT[1]),
                          (lhs.mT[2] * rhs.mT[0]) - (lhs.mT[0] * rhs.mT[2]),
@@ -433,7 +412,24 @@ inline Vector< T, 4 > vector_cross( const Vector< T, 4 > & lhs, const Vector< U,
 
 template < typename T, uint32_t SIZE >
 template < typename U >
-inline Vector< T, SIZE > & Vector< T, SIZE >::operator ^= ( const Vector< U, SIZE > & vec )
+inline constexpr Vector< T, SIZE > Vector< T, SIZE >::operator ^ ( const Vector< U, SIZE > & vec ) const
+{
+   static_assert(SIZE != 2, "cross product not supported for 2D vectors");
+
+   return details::vector_cross(*this, vec);
+}
+
+template < typename T, uint32_t SIZE >
+inline constexpr Vector< T, SIZE > Vector< T, SIZE >::operator ^ ( const Vector< T, SIZE > & vec ) const
+{
+   static_assert(SIZE != 2, "cross product not supported for 2D vectors");
+
+   return details::vector_cross(*this, vec);
+}
+
+template < typename T, uint32_t SIZE >
+template < typename U >
+inline constexpr Vector< T, SIZE > & Vector< T, SIZE >::operator ^= ( const Vector< U, SIZE > & vec )
 {
    static_assert(SIZE != 2, "cross product not supported for 2D vectors");
 
@@ -443,7 +439,7 @@ inline Vector< T, SIZE > & Vector< T, SIZE >::operator ^= ( const Vector< U, SIZ
 }
 
 template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE > & Vector< T, SIZE >::operator ^= ( const Vector< T, SIZE > & vec )
+inline constexpr Vector< T, SIZE > & Vector< T, SIZE >::operator ^= ( const Vector< T, SIZE > & vec )
 {
    static_assert(SIZE != 2, "cross product not supported for 2D vectors");
 
@@ -454,90 +450,114 @@ inline Vector< T, SIZE > & Vector< T, SIZE >::operator ^= ( const Vector< T, SIZ
 
 template < typename T, uint32_t SIZE >
 template < typename U >
-inline Vector< T, SIZE > Vector< T, SIZE >::operator % ( const Vector< U, SIZE > & vec ) const
+inline constexpr Vector< T, SIZE > Vector< T, SIZE >::operator % ( const Vector< U, SIZE > & vec ) const
 {
-   return Vector< T, SIZE >(*this) %= vec;
+   T result[SIZE] = { };
+
+   for (uint32_t i = 0; i < SIZE; ++i) result[i] = mT[i] * vec.mT[i];
+
+   return Vector< T, SIZE >(result);
 }
 
 template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE > Vector< T, SIZE >::operator % ( const Vector< T, SIZE > & vec ) const
+inline constexpr Vector< T, SIZE > Vector< T, SIZE >::operator % ( const Vector< T, SIZE > & vec ) const
 {
-   return Vector< T, SIZE >(*this) %= vec;
+   T result[SIZE] = { };
+
+   for (uint32_t i = 0; i < SIZE; ++i) result[i] = mT[i] * vec.mT[i];
+
+   return Vector< T, SIZE >(result);
 }
 
 template < typename T, uint32_t SIZE >
 template < typename U >
-inline Vector< T, SIZE > & Vector< T, SIZE >::operator %= ( const Vector< U, SIZE > & vec )
+inline constexpr Vector< T, SIZE > & Vector< T, SIZE >::operator %= ( const Vector< U, SIZE > & vec )
 {
-   std::for_each(mT, mT + SIZE, [ this, &vec ] ( T & t ) { t = t * vec.mT[std::distance(mT, &t)]; });
+   for (uint32_t i = 0; i < SIZE; ++i) mT[i] = mT[i] * vec.mT[i];
 
    return *this;
 }
 
 template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE > & Vector< T, SIZE >::operator %= ( const Vector< T, SIZE > & vec )
+inline constexpr Vector< T, SIZE > & Vector< T, SIZE >::operator %= ( const Vector< T, SIZE > & vec )
 {
-   std::for_each(mT, mT + SIZE, [ this, &vec ] ( T & t ) { t = t * vec.mT[std::distance(mT, &t)]; });
+   for (uint32_t i = 0; i < SIZE; ++i) mT[i] = mT[i] * vec.mT[i];
 
    return *this;
 }
 
 template < typename T, uint32_t SIZE >
 template < typename U >
-inline Vector< T, SIZE > Vector< T, SIZE >::operator - ( const Vector< U, SIZE > & vec ) const
+inline constexpr Vector< T, SIZE > Vector< T, SIZE >::operator - ( const Vector< U, SIZE > & vec ) const
 {
-   return Vector< T, SIZE >(*this) -= vec;
+   T result[SIZE] = { };
+
+   for (uint32_t i = 0; i < SIZE; ++i) result[i] = mT[i] - vec.mT[i];
+
+   return Vector< T, SIZE >(result);
 }
 
 template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE > Vector< T, SIZE >::operator - ( const Vector< T, SIZE > & vec ) const
+inline constexpr Vector< T, SIZE > Vector< T, SIZE >::operator - ( const Vector< T, SIZE > & vec ) const
 {
-   return Vector< T, SIZE >(*this) -= vec;
+   T result[SIZE] = { };
+
+   for (uint32_t i = 0; i < SIZE; ++i) result[i] = mT[i] - vec.mT[i];
+
+   return Vector< T, SIZE >(result);
 }
 
 template < typename T, uint32_t SIZE >
 template < typename U >
-inline Vector< T, SIZE > & Vector< T, SIZE >::operator -= ( const Vector< U, SIZE > & vec )
+inline constexpr Vector< T, SIZE > & Vector< T, SIZE >::operator -= ( const Vector< U, SIZE > & vec )
 {
-   std::for_each(mT, mT + SIZE, [ this, &vec ] ( T & t ) { t = t - vec.mT[std::distance(mT, &t)]; });
+   for (uint32_t i = 0; i < SIZE; ++i) mT[i] = mT[i] - vec.mT[i];
 
    return *this;
 }
 
 template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE > & Vector< T, SIZE >::operator -= ( const Vector< T, SIZE > & vec )
+inline constexpr Vector< T, SIZE > & Vector< T, SIZE >::operator -= ( const Vector< T, SIZE > & vec )
 {
-   std::for_each(mT, mT + SIZE, [ this, &vec ] ( T & t ) { t = t - vec.mT[std::distance(mT, &t)]; });
+   for (uint32_t i = 0; i < SIZE; ++i) mT[i] = mT[i] - vec.mT[i];
 
    return *this;
 }
 
 template < typename T, uint32_t SIZE >
 template < typename U >
-inline Vector< T, SIZE > Vector< T, SIZE >::operator + ( const Vector< U, SIZE > & vec ) const
+inline constexpr Vector< T, SIZE > Vector< T, SIZE >::operator + ( const Vector< U, SIZE > & vec ) const
 {
-   return Vector< T, SIZE >(*this) += vec;
+   T result[SIZE] = { };
+
+   for (uint32_t i = 0; i < SIZE; ++i) result[i] = mT[i] + vec.mT[i];
+
+   return Vector< T, SIZE >(result);
 }
 
 template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE > Vector< T, SIZE >::operator + ( const Vector< T, SIZE > & vec ) const
+inline constexpr Vector< T, SIZE > Vector< T, SIZE >::operator + ( const Vector< T, SIZE > & vec ) const
 {
-   return Vector< T, SIZE >(*this) += vec;
+   T result[SIZE] = { };
+
+   for (uint32_t i = 0; i < SIZE; ++i) result[i] = mT[i] + vec.mT[i];
+
+   return Vector< T, SIZE >(result);
 }
 
 template < typename T, uint32_t SIZE >
 template < typename U >
-inline Vector< T, SIZE > & Vector< T, SIZE >::operator += ( const Vector< U, SIZE > & vec )
+inline constexpr Vector< T, SIZE > & Vector< T, SIZE >::operator += ( const Vector< U, SIZE > & vec )
 {
-   std::for_each(mT, mT + SIZE, [ this, &vec ] ( T & t ) { t = t + vec.mT[std::distance(mT, &t)]; });
+   for (uint32_t i = 0; i < SIZE; ++i) mT[i] = mT[i] + vec.mT[i];
 
    return *this;
 }
 
 template < typename T, uint32_t SIZE >
-inline Vector< T, SIZE > & Vector< T, SIZE >::operator += ( const Vector< T, SIZE > & vec )
+inline constexpr Vector< T, SIZE > & Vector< T, SIZE >::operator += ( const Vector< T, SIZE > & vec )
 {
-   std::for_each(mT, mT + SIZE, [ this, &vec ] ( T & t ) { t = t + vec.mT[std::distance(mT, &t)]; });
+   for (uint32_t i = 0; i < SIZE; ++i) mT[i] = mT[i] + vec.mT[i];
 
    return *this;
 }
@@ -657,19 +677,19 @@ inline Vector< T, SIZE >::operator Vector< U, SIZE > ( ) const
 }
 
 template < typename T, uint32_t SIZE >
-inline T & Vector< T, SIZE >::X( )
+inline constexpr T & Vector< T, SIZE >::X( )
 {
    return mT[0];
 }
 
 template < typename T, uint32_t SIZE >
-inline T & Vector< T, SIZE >::Y( )
+inline constexpr T & Vector< T, SIZE >::Y( )
 {
    return mT[1];
 }
 
 template < typename T, uint32_t SIZE >
-inline T & Vector< T, SIZE >::Z( )
+inline constexpr T & Vector< T, SIZE >::Z( )
 {
    static_assert(SIZE == 3 || SIZE == 4, "z component not allowed for this size vector");
 
@@ -677,7 +697,7 @@ inline T & Vector< T, SIZE >::Z( )
 }
 
 template < typename T, uint32_t SIZE >
-inline T & Vector< T, SIZE >::W( )
+inline constexpr T & Vector< T, SIZE >::W( )
 {
    static_assert(SIZE == 4, "w component not allowed for this size vector");
 
@@ -685,19 +705,19 @@ inline T & Vector< T, SIZE >::W( )
 }
 
 template < typename T, uint32_t SIZE >
-inline const T & Vector< T, SIZE >::X( ) const
+inline constexpr const T & Vector< T, SIZE >::X( ) const
 {
    return mT[0];
 }
 
 template < typename T, uint32_t SIZE >
-inline const T & Vector< T, SIZE >::Y( ) const
+inline constexpr const T & Vector< T, SIZE >::Y( ) const
 {
    return mT[1];
 }
 
 template < typename T, uint32_t SIZE >
-inline const T & Vector< T, SIZE >::Z( ) const
+inline constexpr const T & Vector< T, SIZE >::Z( ) const
 {
    static_assert(SIZE == 3 || SIZE == 4, "z component not allowed for this size vector");
 
@@ -705,7 +725,7 @@ inline const T & Vector< T, SIZE >::Z( ) const
 }
 
 template < typename T, uint32_t SIZE >
-inline const T & Vector< T, SIZE >::W( ) const
+inline constexpr const T & Vector< T, SIZE >::W( ) const
 {
    static_assert(SIZE == 4, "w component not allowed for this size vector");
 
@@ -726,42 +746,42 @@ inline void Vector< T, SIZE >::Set( const Vector< T, SIZE > & vec )
 }
 
 template < typename T, uint32_t SIZE >
-template < typename U, typename >
+template < typename U, uint32_t S, typename >
 inline void Vector< T, SIZE >::Set( const U & x, const U & y )
 {
    Set(Vector< U, SIZE >(x, y));
 }
 
 template < typename T, uint32_t SIZE >
-template < typename >
+template < uint32_t S, typename >
 inline void Vector< T, SIZE >::Set( const T & x, const T & y )
 {
    Set(Vector< T, SIZE >(x, y));
 }
 
 template < typename T, uint32_t SIZE >
-template < typename U, typename >
+template < typename U, uint32_t S, typename >
 inline void Vector< T, SIZE >::Set( const U & x, const U & y, const U & z )
 {
    Set(Vector< U, SIZE >(x, y, z));
 }
 
 template < typename T, uint32_t SIZE >
-template < typename >
+template < uint32_t S, typename >
 inline void Vector< T, SIZE >::Set( const T & x, const T & y, const T & z )
 {
    Set(Vector< T, SIZE >(x, y, z));
 }
 
 template < typename T, uint32_t SIZE >
-template < typename U, typename >
+template < typename U, uint32_t S, typename >
 inline void Vector< T, SIZE >::Set( const U & x, const U & y, const U & z, const U & w )
 {
    Set(Vector< U, SIZE >(x, y, z, w));
 }
 
 template < typename T, uint32_t SIZE >
-template < typename >
+template < uint32_t S, typename >
 inline void Vector< T, SIZE >::Set( const T & x, const T & y, const T & z, const T & w )
 {
    Set(Vector< T, SIZE >(x, y, z, w));
@@ -784,19 +804,19 @@ namespace details
 {
 
 template < typename T >
-inline void zero_vector( Vector< T, 2 > & vec )
+inline constexpr void zero_vector( Vector< T, 2 > & vec )
 {
    vec.mT[0] = 0; vec.mT[1] = 0;
 }
 
 template < typename T >
-inline void zero_vector( Vector< T, 3 > & vec )
+inline constexpr void zero_vector( Vector< T, 3 > & vec )
 {
    vec.mT[0] = 0; vec.mT[1] = 0; vec.mT[2] = 0;
 }
 
 template < typename T >
-inline void zero_vector( Vector< T, 4 > & vec )
+inline constexpr void zero_vector( Vector< T, 4 > & vec )
 {
    vec.mT[0] = 0; vec.mT[1] = 0; vec.mT[2] = 0; vec.mT[3] = 1;
 }
@@ -804,7 +824,7 @@ inline void zero_vector( Vector< T, 4 > & vec )
 } // namespace details
 
 template < typename T, uint32_t SIZE >
-Vector< T, SIZE > & Vector< T, SIZE >::MakeZeroVector( )
+inline constexpr Vector< T, SIZE > & Vector< T, SIZE >::MakeZeroVector( )
 {
    details::zero_vector(*this);
 
@@ -845,13 +865,13 @@ inline T Vector< T, SIZE >::Length( ) const
 {
    T squared_sum = 0;
 
-   std::for_each(mT, mT + SIZE, [ &squared_sum ] ( const T & t ) { squared_sum += (t * t); });
+   for (uint32_t i = 0; i < SIZE; ++i) squared_sum += mT[i] * mT[i];
 
    return std::sqrt(squared_sum);
 }
 
 template < typename T, uint32_t SIZE >
-inline uint32_t Vector< T, SIZE >::Size( ) const
+inline constexpr uint32_t Vector< T, SIZE >::Size( ) const
 {
    return SIZE;
 }
@@ -870,9 +890,26 @@ using Vector3 = Vector< T, 3 >;
 template < typename T >
 using Vector4 = Vector< T, 4 >;
 
+// vectors are copied into vertex buffers and uniform blocks with memcpy,
+// so they must remain plain data with no hidden members
+static_assert(std::is_trivially_copyable< Vec2f >::value && std::is_standard_layout< Vec2f >::value, "Vec2f must be plain data");
+static_assert(std::is_trivially_copyable< Vec2d >::value && std::is_standard_layout< Vec2d >::value, "Vec2d must be plain data");
+static_assert(std::is_trivially_copyable< Vec3f >::value && std::is_standard_layout< Vec3f >::value, "Vec3f must be plain data");
+static_assert(std::is_trivially_copyable< Vec3d >::value && std::is_standard_layout< Vec3d >::value, "Vec3d must be plain data");
+static_assert(std::is_trivially_copyable< Vec4f >::value && std::is_standard_layout< Vec4f >::value, "Vec4f must be plain data");
+static_assert(std::is_trivially_copyable< Vec4d >::value && std::is_standard_layout< Vec4d >::value, "Vec4d must be plain data");
+static_assert(sizeof(Vec3f) == sizeof(float) * 3 && sizeof(Vec4d) == sizeof(double) * 4, "vectors must not be padded");
+
+// constructors and the basic operators are usable in constant expressions
+static_assert(Vec4f().W() == 1.0f && Vec3d().Z() == 0.0, "default vector is not the origin");
+static_assert((Vec3f(1.0f, 0.0f, 0.0f) ^ Vec3f(0.0f, 1.0f, 0.0f)).Z() == 1.0f, "cross product is not constexpr");
+static_assert((Vec3d(1.0, 2.0, 3.0) + Vec3d(1.0) * 2.0) * Vec3d(1.0, 0.0, 0.0) == 3.0, "vector arithmetic is not constexpr");
+
 // even with the use of the enable_if_t, the compiler
 // includes all the declarations of the class interface,
 // even the ones considered an error.
+#if defined( _MSC_VER )
 #pragma warning( pop )
+#endif // _MSC_VER
 
 #endif // _VECTOR_H_
@@ -0,0 +1,77 @@
+#ifndef _VECTOR_HELPER_H_
+#define _VECTOR_HELPER_H_
+
+// crt includes
+#include <cmath>
+
+// local includes
+#include "Vector.h"
+
+// fused forms of common vector operator chains... each one evaluates the
+// whole expression component by component in a single pass, without the
+// intermediate vectors the equivalent chain of operators would create.
+// the results match the operator chains noted with each function.
+namespace VectorHelper
+{
+
+// ((p1 - p0) ^ (p2 - p0)).UnitVector()
+template < typename T >
+inline Vector< T, 3 > TriangleNormal( const Vector< T, 3 > & p0,
+                                      const Vector< T, 3 > & p1,
+                                      const Vector< T, 3 > & p2 )
+{
+   const T e1x = p1.mT[0] - p0.mT[0], e1y = p1.mT[1] - p0.mT[1], e1z = p1.mT[2] - p0.mT[2];
+   const T e2x = p2.mT[0] - p0.mT[0], e2y = p2.mT[1] - p0.mT[1], e2z = p2.mT[2] - p0.mT[2];
+
+   const T x = e1y * e2z - e1z * e2y;
+   const T y = e1z * e2x - e1x * e2z;
+   const T z = e1x * e2y - e1y * e2x;
+
+   const T one_over_length = 1 / std::sqrt(x * x + y * y + z * z);
+
+   return Vector< T, 3 >(x * one_over_length, y * one_over_length, z * one_over_length);
+}
+
+// (a ^ b).UnitVector()
+template < typename T >
+inline Vector< T, 3 > UnitCross( const Vector< T, 3 > & a, const Vector< T, 3 > & b )
+{
+   const T x = a.mT[1] * b.mT[2] - a.mT[2] * b.mT[1];
+   const T y = a.mT[2] * b.mT[0] - a.mT[0] * b.mT[2];
+   const T z = a.mT[0] * b.mT[1] - a.mT[1] * b.mT[0];
+
+   const T one_over_length = 1 / std::sqrt(x * x + y * y + z * z);
+
+   return Vector< T, 3 >(x * one_over_length, y * one_over_length, z * one_over_length);
+}
+
+// (v - n * (n * v)).UnitVector(), which is gram-schmidt against a unit n
+template < typename T >
+inline Vector< T, 3 > Orthonormalize( const Vector< T, 3 > & v, const Vector< T, 3 > & n )
+{
+   const T n_dot_v = n.mT[0] * v.mT[0] + n.mT[1] * v.mT[1] + n.mT[2] * v.mT[2];
+
+   const T x = v.mT[0] - n.mT[0] * n_dot_v;
+   const T y = v.mT[1] - n.mT[1] * n_dot_v;
+   const T z = v.mT[2] - n.mT[2] * n_dot_v;
+
+   const T one_over_length = 1 / std::sqrt(x * x + y * y + z * z);
+
+   return Vector< T, 3 >(x * one_over_length, y * one_over_length, z * one_over_length);
+}
+
+// a * s + b * t
+template < typename T, uint32_t SIZE >
+inline Vector< T, SIZE > Combine( const Vector< T, SIZE > & a, const T & s,
+                                  const Vector< T, SIZE > & b, const T & t )
+{
+   T result[SIZE];
+
+   for (uint32_t i = 0; i < SIZE; ++i) result[i] = a.mT[i] * s + b.mT[i] * t;
+
+   return Vector< T, SIZE >(result);
+}
+
+} // namespace VectorHelper
+
+#endif // _VECTOR_HELPER_H_
@@ -204,6 +204,15 @@ uint8_t * VertexBufferObject::MapBuffer( const GLenum access )
    return static_cast< uint8_t * >(glMapBuffer(mType, access));
 }
 
+uint8_t * VertexBufferObject::MapBufferRange( const GLintptr offset,
+                                             const GLsizeiptr length,
+                                             const GLbitfield access )
+{
+   WGL_ASSERT(mBound && VertexBufferObject::GetCurrentVBO(mType) == mVBO);
+
+   return static_cast< uint8_t * >(glMapBufferRange(mType, offset, length, access));
+}
+
 void VertexBufferObject::UnmapBuffer( )
 {
    WGL_ASSERT(mBound && VertexBufferObject::GetCurrentVBO(mType) == mVBO);
@@ -68,6 +68,9 @@ public:
 
    // obtain raw pointer to gl memory
    uint8_t * MapBuffer( const GLenum access );
+   uint8_t * MapBufferRange( const GLintptr offset,
+                             const GLsizeiptr length,
+                             const GLbitfield access );
    void UnmapBuffer( );
 
    // gets the size of the buffered data
@@ -1,5 +1,6 @@
 // local includes
 #include "Window.h"
+#include "Profiler.h"
 #include "WglAssert.h"
 
 // window includes
@@ -158,6 +159,8 @@ bool Window::GetAppMessages( int & nQuitRetValue )
 
 bool Window::PeekAppMessages( int & nQuitRetValue )
 {
+   WGL_PROFILE_ZONE("Window::PeekAppMessages");
+
    MSG wndMsg;
    bool termApp = false;
 